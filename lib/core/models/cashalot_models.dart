@@ -1,6 +1,8 @@
 /// Моделі даних для роботи з Cashalot API
 /// Відповідають JSON-структурі з документації Cashalot
 
+import 'dart:typed_data';
+
 /// Базовий клас відповіді від сервера Cashalot
 class CashalotResponse {
   final String? errorCode;
@@ -8,6 +10,7 @@ class CashalotResponse {
   final String? numFiscal; // Фіскальний номер документа
   final String? qrCode; // Base64 зображення QR
   final String? visualization; // Текстовий вигляд чека
+  final Uint8List? printData; // ESC/POS байти візуалізації (нативний розбір)
   final int? shiftState; // Стан зміни: 0 - закрита, 1 - відкрита
 
   // Нові поля
@@ -23,6 +26,7 @@ class CashalotResponse {
     this.numFiscal,
     this.qrCode,
     this.visualization,
+    this.printData,
     this.shiftState,
     this.shiftOpened,
     this.serviceInput,
@@ -91,6 +95,7 @@ class CheckBodyRow {
   final double amount;
   final double price;
   final double cost; // amount * price
+  final double discount; // знижка на рядок за акціями, грн
   final String? uktzeds; // УКТЗЕД код
 
   CheckBodyRow({
@@ -98,6 +103,7 @@ class CheckBodyRow {
     required this.name,
     required this.amount,
     required this.price,
+    this.discount = 0,
     this.uktzeds,
   }) : cost = amount * price;
 
@@ -107,6 +113,9 @@ class CheckBodyRow {
     "AMOUNT": amount,
     "PRICE": price,
     "COST": cost,
+    // TODO: назва поля не звірена зі схемою чека Cashalot; знижки
+    // надходять лише з увімкненими акціями (`promo_enabled`).
+    if (discount > 0) "DISCOUNT": discount,
   };
 }
 
@@ -7,6 +7,7 @@ class FiscalResult {
   final String? qrUrl;
   final String? docNumber; // Номер чека для відображення
   final double? totalAmount; // Сума чека
+  final String? visualization; // Візуалізація чека з ПРРО (для архіву)
   final VchasnoException? error; // Помилка, якщо є
 
   FiscalResult({
@@ -15,6 +16,7 @@ class FiscalResult {
     this.qrUrl,
     this.docNumber,
     this.totalAmount,
+    this.visualization,
     this.error,
   });
 
@@ -24,6 +26,7 @@ class FiscalResult {
     String? qrUrl,
     String? docNumber,
     double? totalAmount,
+    String? visualization,
   }) {
     return FiscalResult(
       success: true,
@@ -31,6 +34,7 @@ class FiscalResult {
       qrUrl: qrUrl,
       docNumber: docNumber,
       totalAmount: totalAmount,
+      visualization: visualization,
     );
   }
 
@@ -1,3 +1,5 @@
+import 'dart:typed_data';
+
 /// Дані звіту (X або Z)
 class XReportData {
   /// Тип завдання (10 = X-звіт, 11 = Z-звіт)
@@ -12,6 +14,7 @@ class XReportData {
   final int? shiftPrevLink; // Номер попереднього Z-звіту
   final int? vacantOffNums; // Кількість доступних офлайн номерів
   final String? visualization; // Base64 рядкова візуалізація
+  final Uint8List? printData; // Готові ESC/POS байти (з нативного розбору)
   final bool isZRep; // Чи є Z-звіт
 
   final DateTime? shiftOpened; // Час відкриття зміни
@@ -70,12 +73,147 @@ class XReportData {
     this.billing,
     this.printHeader,
     this.visualization,
+    this.printData,
     this.isZRep = false,
     this.shiftOpened,
     this.serviceInput,
     this.serviceOutput,
   });
 
+  /// Звіт, розібраний нативно (канал com.virok/report або поле `report`
+  /// у відповіді COM). Мапа вже пласка й типізована, тому тут лише
+  /// розкладання по полях без обходу вкладеного JSON.
+  factory XReportData.fromNative(Map<dynamic, dynamic> map) {
+    List<T> list<T>(String key, T Function(Map<dynamic, dynamic>) build) {
+      final items = map[key] as List?;
+      if (items == null) return const [];
+      return [for (final item in items) build(item as Map<dynamic, dynamic>)];
+    }
+
+    final receipt = map['receipt'] as Map?;
+    final summary = map['summary'] as Float64List?;
+    final lastCheck = map['lastCheck'] as Map?;
+    final billing = map['billing'] as Map?;
+    final header = map['printHeader'] as Map?;
+    final shiftOpened = map['shiftOpened'] as String?;
+
+    return XReportData(
+      task: (map['task'] as num?)?.toInt() ?? 0,
+      dt: map['dt'] as String?,
+      fisid: map['fisid'] as String?,
+      cashier: map['cashier'] as String?,
+      safe: (map['safe'] as num?)?.toDouble() ?? 0.0,
+      safeStartShift: (map['safeStartShift'] as num?)?.toDouble() ?? 0.0,
+      isOffline: map['isOffline'] as bool? ?? false,
+      shiftLink: (map['shiftLink'] as num?)?.toInt(),
+      shiftPrevLink: (map['shiftPrevLink'] as num?)?.toInt(),
+      vacantOffNums: (map['vacantOffNums'] as num?)?.toInt(),
+      isZRep: map['isZRep'] as bool? ?? false,
+      shiftOpened: shiftOpened != null ? DateTime.tryParse(shiftOpened) : null,
+      serviceInput: (map['serviceInput'] as num?)?.toDouble(),
+      serviceOutput: (map['serviceOutput'] as num?)?.toDouble(),
+      receipt: receipt != null
+          ? ReceiptSummary(
+              lastDocnoP: (receipt['lastDocnoP'] as num).toInt(),
+              lastDocnoM: (receipt['lastDocnoM'] as num).toInt(),
+              count14: (receipt['count14'] as num).toInt(),
+              countP: (receipt['countP'] as num).toInt(),
+              countM: (receipt['countM'] as num).toInt(),
+            )
+          : null,
+      // Порядок як у полях SummaryData (див. native/report).
+      summary: summary != null
+          ? SummaryData(
+              baseP: summary[0],
+              baseM: summary[1],
+              taxexP: summary[2],
+              taxexM: summary[3],
+              discP: summary[4],
+              discM: summary[5],
+              calcP: summary[6],
+              calcM: summary[7],
+            )
+          : null,
+      taxes: list(
+        'taxes',
+        (t) => TaxData(
+          grCode: (t['grCode'] as num).toInt(),
+          baseSumP: (t['baseSumP'] as num).toDouble(),
+          baseSumM: (t['baseSumM'] as num).toDouble(),
+          taxName: t['taxName'] as String,
+          taxFname: t['taxFname'] as String,
+          taxLit: t['taxLit'] as String,
+          taxPercent: (t['taxPercent'] as num).toDouble(),
+          taxSumP: (t['taxSumP'] as num).toDouble(),
+          taxSumM: (t['taxSumM'] as num).toDouble(),
+        ),
+      ),
+      pays: list(
+        'pays',
+        (p) => PayData(
+          type: (p['type'] as num).toInt(),
+          name: p['name'] as String,
+          sumP: (p['sumP'] as num).toDouble(),
+          sumM: (p['sumM'] as num).toDouble(),
+        ),
+      ),
+      money: list(
+        'money',
+        (p) => MoneyData(
+          type: (p['type'] as num).toInt(),
+          name: p['name'] as String,
+          sumP: (p['sumP'] as num).toDouble(),
+          sumM: (p['sumM'] as num).toDouble(),
+        ),
+      ),
+      cash: list(
+        'cash',
+        (p) => CashData(
+          type: (p['type'] as num).toInt(),
+          name: p['name'] as String,
+          sumM: (p['sumM'] as num).toDouble(),
+        ),
+      ),
+      lastCheck: lastCheck != null
+          ? LastCheckData(
+              packnum: (lastCheck['packnum'] as num).toInt(),
+              docnum: (lastCheck['docnum'] as num).toInt(),
+              fisnum: lastCheck['fisnum'] as String,
+              packtype: (lastCheck['packtype'] as num).toInt(),
+            )
+          : null,
+      warnings: list(
+        'warnings',
+        (w) => WarningData(
+          code: (w['code'] as num).toInt(),
+          wtxt: w['wtxt'] as String,
+        ),
+      ),
+      billing: billing != null
+          ? BillingData(
+              paidDateTo: billing['paidDateTo'] as String,
+              enoughToRenewSubscription:
+                  (billing['enoughToRenewSubscription'] as num).toInt(),
+            )
+          : null,
+      printHeader: header != null
+          ? PrintHeaderData(
+              name: header['name'] as String?,
+              shopname: header['shopname'] as String?,
+              shopad: header['shopad'] as String?,
+              vatCode: header['vatCode'] as String?,
+              fisCode: header['fisCode'] as String?,
+              dt: header['dt'] as String?,
+              isOffline: header['isOffline'] as bool? ?? false,
+              fisid: header['fisid'] as String?,
+              cashier: header['cashier'] as String?,
+            )
+          : null,
+      visualization: map['visualization'] as String?,
+      printData: map['printData'] as Uint8List?,
+    );
+  }
+
   factory XReportData.fromJson(Map<String, dynamic> json) {
     // Спроба знайти info (для сумісності зі старою логікою)
     final info = json['info'] as Map<String, dynamic>? ?? json;
@@ -0,0 +1,227 @@
+import 'dart:convert';
+
+import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart';
+
+/// Чек із локального архіву.
+class ArchivedReceipt {
+  final String fiscalNumber;
+  final String rrn;
+  final DateTime createdAt;
+  final String docType;
+  final String cashier;
+  final double total;
+
+  /// Рядки: guid, code, name, barcodes, quantity, price, discount
+  final List<Map<String, dynamic>> lines;
+
+  /// Оплати: form, amount
+  final List<Map<String, dynamic>> payments;
+
+  /// Текстова візуалізація з ПРРО (лише для пошуку за фіскальним номером)
+  final String? visualization;
+
+  const ArchivedReceipt({
+    required this.fiscalNumber,
+    required this.rrn,
+    required this.createdAt,
+    required this.docType,
+    required this.cashier,
+    required this.total,
+    required this.lines,
+    required this.payments,
+    this.visualization,
+  });
+
+  factory ArchivedReceipt._fromMap(Map<dynamic, dynamic> map) =>
+      ArchivedReceipt(
+        fiscalNumber: map['fiscalNumber'] as String? ?? '',
+        rrn: map['rrn'] as String? ?? '',
+        createdAt: DateTime.fromMillisecondsSinceEpoch(
+          (map['createdMs'] as num?)?.toInt() ?? 0,
+        ),
+        docType: map['docType'] as String? ?? '',
+        cashier: map['cashier'] as String? ?? '',
+        total: (map['total'] as num?)?.toDouble() ?? 0,
+        lines: [
+          for (final line in map['lines'] as List? ?? const [])
+            Map<String, dynamic>.from(line as Map),
+        ],
+        payments: [
+          for (final payment in map['payments'] as List? ?? const [])
+            Map<String, dynamic>.from(payment as Map),
+        ],
+        visualization: map['visualization'] as String?,
+      );
+
+  /// Форма оплати першої оплати ("Готівка", "Картка", ...)
+  String? get paymentForm =>
+      payments.isEmpty ? null : payments.first['form'] as String?;
+
+  /// Рядки у формі таблиці `kkm_check_items` (як їх показує сторінка
+  /// повернень).
+  List<Map<String, dynamic>> get itemRows => [
+    for (final line in lines)
+      {
+        'product_code': line['code'] as String? ?? '',
+        'product_name': line['name'] as String? ?? '',
+        'unit': 'шт',
+        'quantity': (line['quantity'] as num? ?? 0).round(),
+        'price': (line['price'] as num? ?? 0).toDouble(),
+        'amount':
+            (line['quantity'] as num? ?? 0) * (line['price'] as num? ?? 0) -
+            (line['discount'] as num? ?? 0),
+        'seller': cashier,
+      },
+  ];
+}
+
+/// Локальний архів фіскалізованих чеків (канал `com.virok/archive`, див.
+/// native/archive).
+///
+/// Кожен фіскалізований чек дописується в лог-структурований архів на
+/// диску разом з рядками, оплатами і стисненою візуалізацією. Пошук для
+/// повернення (фіскальний номер, RRN, штрихкод, дата) і повторний друк
+/// працюють без сервера. Якщо раннер не має каналу (Android/iOS/Web), усі
+/// методи повертають null/порожній список — викликач іде в Supabase.
+class NativeReceiptArchive {
+  static const MethodChannel _channel = MethodChannel('com.virok/archive');
+
+  bool? _available;
+  Future<bool>? _opening;
+
+  /// Відкриває архів у каталозі [path] (створює за потреби).
+  Future<bool> open(String path) => _opening = _open(path);
+
+  Future<bool> _open(String path) async {
+    try {
+      final stats = await _channel.invokeMapMethod<String, dynamic>('open', {
+        'path': path,
+      });
+      _available = true;
+      debugPrint(
+        '🗄️ [ARCHIVE] Відкрито: ${stats?['receipts']} чеків, '
+        '${stats?['segments']} сегментів',
+      );
+      return true;
+    } on MissingPluginException {
+      _available = false;
+      return false;
+    } catch (e) {
+      debugPrint('❌ [ARCHIVE] Не вдалося відкрити архів: $e');
+      _available = false;
+      return false;
+    }
+  }
+
+  bool get isAvailable => _available == true;
+
+  /// Як [isAvailable], але дочікується [open], якщо той ще працює
+  /// (відкриття йде у фоні, не затримуючи перший кадр).
+  Future<bool> get ready async => _available ?? await _opening ?? false;
+
+  /// Записує фіскалізований чек. Суми — в гривнях.
+  Future<bool> put({
+    required String fiscalNumber,
+    String rrn = '',
+    DateTime? createdAt,
+    String docType = 'sale',
+    String cashier = '',
+    required double total,
+    required List<Map<String, dynamic>> lines,
+    required List<Map<String, dynamic>> payments,
+    String? visualization,
+  }) async {
+    if (!await ready) return false;
+    try {
+      await _channel.invokeMethod('put', {
+        'json': jsonEncode({
+          'fiscalNumber': fiscalNumber,
+          'rrn': rrn,
+          'createdMs': (createdAt ?? DateTime.now()).millisecondsSinceEpoch,
+          'docType': docType,
+          'cashier': cashier,
+          'total': total,
+          'lines': lines,
+          'payments': payments,
+          'visualization': visualization ?? '',
+        }),
+      });
+      return true;
+    } catch (e) {
+      debugPrint('❌ [ARCHIVE] Чек $fiscalNumber не записано: $e');
+      return false;
+    }
+  }
+
+  /// Чек з візуалізацією або null.
+  Future<ArchivedReceipt?> byFiscalNumber(String fiscalNumber) async {
+    if (!await ready) return null;
+    try {
+      final map = await _channel.invokeMapMethod<String, dynamic>(
+        'byFiscalNumber',
+        {'fiscalNumber': fiscalNumber},
+      );
+      return map == null ? null : ArchivedReceipt._fromMap(map);
+    } catch (e) {
+      debugPrint('❌ [ARCHIVE] byFiscalNumber: $e');
+      return null;
+    }
+  }
+
+  /// Чеки за RRN карткової оплати, новіші першими.
+  Future<List<ArchivedReceipt>> byRrn(String rrn, {int limit = 50}) =>
+      _list('byRrn', {'rrn': rrn, 'limit': limit});
+
+  /// Чеки з товаром за штрихкодом, новіші першими.
+  Future<List<ArchivedReceipt>> byBarcode(String barcode, {int limit = 50}) =>
+      _list('byBarcode', {'barcode': barcode, 'limit': limit});
+
+  /// Чеки за дні [from]..[to] включно (за місцевим часом).
+  Future<List<ArchivedReceipt>> byDate(
+    DateTime from,
+    DateTime to, {
+    int limit = 500,
+  }) => _list('byDate', {
+    'from': _yyyymmdd(from),
+    'to': _yyyymmdd(to),
+    'limit': limit,
+  });
+
+  /// Видаляє чеки, старші за термін зберігання, і стискає сегменти з
+  /// перезаписаними чеками. Викликати між чеками.
+  Future<void> compact() async {
+    if (!await ready) return;
+    try {
+      final result = await _channel.invokeMapMethod<String, dynamic>(
+        'compact',
+      );
+      debugPrint(
+        '🗄️ [ARCHIVE] Стиснення: видалено ${result?['expiredSegments']}, '
+        'переписано ${result?['rewrittenSegments']} сегментів, '
+        'звільнено ${result?['reclaimedBytes']} байт',
+      );
+    } catch (e) {
+      debugPrint('❌ [ARCHIVE] compact: $e');
+    }
+  }
+
+  Future<List<ArchivedReceipt>> _list(
+    String method,
+    Map<String, dynamic> args,
+  ) async {
+    if (!await ready) return const [];
+    try {
+      final list = await _channel.invokeListMethod<dynamic>(method, args);
+      return [
+        for (final map in list ?? const [])
+          ArchivedReceipt._fromMap(map as Map),
+      ];
+    } catch (e) {
+      debugPrint('❌ [ARCHIVE] $method: $e');
+      return const [];
+    }
+  }
+
+  static int _yyyymmdd(DateTime d) => d.year * 10000 + d.month * 100 + d.day;
+}
@@ -58,6 +58,7 @@ class CashalotPrroAdapter implements PrroService {
           qrUrl: response.qrCode,
           docNumber: response.numFiscal,
           totalAmount: check.checkTotal.sum,
+          visualization: response.visualization,
         );
       } else {
         return FiscalResult.failure(
@@ -124,6 +125,7 @@ class CashalotPrroAdapter implements PrroService {
       return XReportData(
         task: 10,
         visualization: response.visualization,
+        printData: response.printData,
         isZRep: false,
         shiftOpened: response.shiftOpened,
         serviceInput: response.serviceInput,
@@ -166,6 +168,7 @@ class CashalotPrroAdapter implements PrroService {
       return XReportData(
         task: 11,
         visualization: response.visualization,
+        printData: response.printData,
         isZRep: true,
       );
     } catch (e) {
@@ -1,8 +1,10 @@
+import 'dart:async';
 import 'dart:convert';
 import 'package:flutter/foundation.dart';
 import 'package:flutter/services.dart';
 import 'package:cash_register/core/models/cashalot_models.dart';
 import 'package:cash_register/core/models/prro_info.dart';
+import 'package:cash_register/core/models/x_report_data.dart';
 import 'package:cash_register/core/models/pos_result.dart';
 import 'package:cash_register/core/services/cashalot/core/cashalot_service.dart';
 import 'package:cash_register/core/models/pos_terminal.dart';
@@ -10,6 +12,64 @@ import 'package:cash_register/core/models/pos_terminal.dart';
 class CashalotComService implements CashalotService {
   static const MethodChannel _channel = MethodChannel('com.cashalot/api');
 
+  /// Зміни стану ПРРО з нативного кешу getCurrentStatus: він оновлюється у
+  /// фоні та після відкриття/закриття зміни, фіскалізації й службових
+  /// операцій.
+  static const EventChannel _statusChannel = EventChannel(
+    'com.cashalot/status',
+  );
+
+  final Map<String, CashalotResponse> _prroStates = {};
+  final StreamController<MapEntry<String, CashalotResponse>> _prroStateChanges =
+      StreamController.broadcast();
+
+  CashalotComService() {
+    _statusChannel.receiveBroadcastStream().listen(
+      (event) {
+        if (event is! Map) return;
+        final fiscalNum = event['fiscalNum'] as String?;
+        if (fiscalNum == null) return;
+        // Після зміни стану (відкриття зміни, чек) старий стан не показуємо,
+        // доки не прийде свіжий.
+        if (event['stale'] == true) {
+          _prroStates.remove(fiscalNum);
+          return;
+        }
+        final response = event['error'] != null
+            ? CashalotResponse(
+                errorCode: 'COM_ERROR',
+                errorMessage: event['error'] as String?,
+              )
+            : _parseResult(event, 'getPrroState');
+        _rememberPrroState(fiscalNum, response);
+      },
+      // Платформа без нативного кешу (Linux, тести) — лише без подій.
+      onError: (Object e) => debugPrint('⚠️ [CASHALOT_COM] Status events: $e'),
+    );
+  }
+
+  /// Останній відомий стан ПРРО: діалоги зміни показують його одразу, без
+  /// очікування пристрою. Null, якщо стану немає або він з помилкою.
+  CashalotResponse? cachedPrroState(int prroFiscalNum) =>
+      _prroStates[prroFiscalNum.toString()];
+
+  /// Стан ПРРО щоразу, коли він змінюється.
+  Stream<CashalotResponse> prroStateChanges(int prroFiscalNum) {
+    final fiscalNum = prroFiscalNum.toString();
+    return _prroStateChanges.stream
+        .where((e) => e.key == fiscalNum)
+        .map((e) => e.value);
+  }
+
+  void _rememberPrroState(String fiscalNum, CashalotResponse response) {
+    if (response.errorCode == null) {
+      _prroStates[fiscalNum] = response;
+    } else {
+      _prroStates.remove(fiscalNum);
+    }
+    _prroStateChanges.add(MapEntry(fiscalNum, response));
+  }
+
   /// Повна ініціалізація Cashalot COM-addin.
   /// Додано аргументи для ключів та паролів, бо без них COM не працює в тихому режимі.
   Future<void> initialize({
@@ -51,7 +111,9 @@ class CashalotComService implements CashalotService {
         'getCurrentStatus',
         <String, dynamic>{'fiscalNum': prroFiscalNum.toString()},
       );
-      return _parseResult(result, 'getPrroState');
+      final response = _parseResult(result, 'getPrroState');
+      _rememberPrroState(prroFiscalNum.toString(), response);
+      return response;
     } catch (e) {
       return CashalotResponse(
         errorCode: 'EXCEPTION',
@@ -324,6 +386,10 @@ class CashalotComService implements CashalotService {
 
           // Додаткові поля (за потреби)
           "GoodsType": 0, // 0 - товар, 1 - послуга
+          // Знижка за акціями на весь рядок; SumPayCheck уже без неї.
+          // TODO: звірити назву поля зі схемою ReceiptLst Cashalot — доти
+          // акції вимкнені (`promo_enabled`), і discount тут завжди 0.
+          if (item.discount > 0) "Discount": _formatMoney(item.discount),
         };
       }).toList();
 
@@ -413,8 +479,10 @@ class CashalotComService implements CashalotService {
         'closeShift',
         <String, dynamic>{'fiscalNum': prroFiscalNum.toString()},
       );
-      debugPrint('🔒 [CASHALOT_COM] closeShift result: $result');
-      return _parseResult(result, 'closeShift');
+      debugPrint(
+        '🔒 [CASHALOT_COM] closeShift success: ${result?['success']}',
+      );
+      return _parseReportResult(result, 'closeShift');
     } catch (e) {
       debugPrint('❌ [CASHALOT_COM] closeShift error: $e');
       return CashalotResponse(
@@ -431,7 +499,7 @@ class CashalotComService implements CashalotService {
         'printXReport',
         <String, dynamic>{'fiscalNum': prroFiscalNum.toString()},
       );
-      return _parseResult(result, 'printXReport');
+      return _parseReportResult(result, 'printXReport');
     } catch (e) {
       return CashalotResponse(
         errorCode: 'EXCEPTION',
@@ -574,6 +642,28 @@ class CashalotComService implements CashalotService {
     return _parseResponseData(parsedJson);
   }
 
+  /// Звіти (X/Z) раннер уже розібрав нативно (поле `report`): беремо
+  /// готові поля й байти для друку замість jsonDecode великого jsonVal.
+  CashalotResponse _parseReportResult(
+    Map<dynamic, dynamic>? result,
+    String method,
+  ) {
+    final report = result?['report'] as Map?;
+    if (result?['success'] != true || report == null) {
+      return _parseResult(result, method);
+    }
+
+    final data = XReportData.fromNative(report);
+    return CashalotResponse(
+      errorCode: null,
+      visualization: data.visualization,
+      printData: data.printData,
+      shiftOpened: data.shiftOpened,
+      serviceInput: data.serviceInput,
+      serviceOutput: data.serviceOutput,
+    );
+  }
+
   // Допоміжний метод для витягування даних
   CashalotResponse _parseResponseData(Map<String, dynamic> json) {
     final values = json['Values'];
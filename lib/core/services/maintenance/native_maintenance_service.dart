@@ -0,0 +1,152 @@
+import 'dart:async';
+
+import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart';
+
+/// Прапорець витіснення задачі обслуговування: касир повернувся до каси.
+class MaintenanceCancel {
+  bool _cancelled = false;
+
+  bool get isCancelled => _cancelled;
+}
+
+/// Задача обслуговування в Dart. true — виконана; між етапами перевіряє
+/// [MaintenanceCancel.isCancelled] і, якщо каса ожила, повертає false.
+typedef MaintenanceTask = Future<bool> Function(MaintenanceCancel cancel);
+
+/// Фонове обслуговування у простої каси (канал `com.virok/maintenance` і
+/// потік `com.virok/maintenance/events`, див. native/maintenance).
+///
+/// Раннер сам визначає простій: немає клавіш, сканів і дотиків
+/// `idleAfter` і не відкрито чек ([setCartOpen]). Тоді він по черзі
+/// запускає прострочені задачі: ущільнення архіву чеків виконує сам,
+/// решту — подією сюди. Щойно каса ожила, поточна задача отримує
+/// скасування і продовжується в наступному вікні простою. На платформах
+/// без каналу [start] повертає false і обслуговування лишається ручним.
+class NativeMaintenanceService {
+  static const MethodChannel _channel = MethodChannel(
+    'com.virok/maintenance',
+  );
+  static const EventChannel _eventChannel = EventChannel(
+    'com.virok/maintenance/events',
+  );
+
+  /// Ущільнення архіву чеків (виконує раннер, [MaintenanceTask] не треба).
+  static const String archiveCompactJob = 'archiveCompact';
+
+  final Map<String, MaintenanceTask> _tasks = {};
+  final Map<String, MaintenanceCancel> _running = {};
+  StreamSubscription<dynamic>? _events;
+  bool? _available;
+  bool? _cartOpen;
+
+  /// Реєструє задачі з інтервалами [intervals] і запускає планувальник.
+  /// Для кожної задачі, крім [archiveCompactJob], потрібна [tasks].
+  Future<bool> start({
+    required Map<String, Duration> intervals,
+    required Map<String, MaintenanceTask> tasks,
+    Duration idleAfter = const Duration(seconds: 30),
+  }) async {
+    if (_available == false) return false;
+    _tasks.addAll(tasks);
+    _events ??= _eventChannel.receiveBroadcastStream().listen(
+      _onEvent,
+      onError: (Object e) {
+        if (e is! MissingPluginException) {
+          debugPrint('❌ [MAINTENANCE] Помилка потоку подій: $e');
+        }
+      },
+    );
+    try {
+      await _channel.invokeMethod('configure', {
+        'idleAfterMs': idleAfter.inMilliseconds,
+        'jobs': {
+          for (final entry in intervals.entries)
+            entry.key: entry.value.inMilliseconds,
+        },
+      });
+      _available = true;
+      debugPrint(
+        '🧹 [MAINTENANCE] Обслуговування у простої: '
+        '${intervals.keys.join(', ')}',
+      );
+      return true;
+    } on MissingPluginException {
+      _available = false;
+      await _events?.cancel();
+      _events = null;
+      return false;
+    } catch (e) {
+      debugPrint('❌ [MAINTENANCE] Не вдалося запустити планувальник: $e');
+      return false;
+    }
+  }
+
+  /// Відкритий чек: обслуговування не починається, а те, що йде, —
+  /// витісняється.
+  Future<void> setCartOpen(bool open) async {
+    if (_available != true || _cartOpen == open) return;
+    _cartOpen = open;
+    try {
+      await _channel.invokeMethod('setCartOpen', {'open': open});
+    } catch (e) {
+      debugPrint('❌ [MAINTENANCE] setCartOpen: $e');
+    }
+  }
+
+  /// Стан планувальника: idle, cartOpen, active, slices, preemptions і
+  /// jobs (name, runs, failures, dueInMs).
+  Future<Map<String, dynamic>?> status() async {
+    if (_available != true) return null;
+    try {
+      final status = await _channel.invokeMapMethod<String, dynamic>(
+        'status',
+      );
+      return status;
+    } catch (e) {
+      debugPrint('❌ [MAINTENANCE] status: $e');
+      return null;
+    }
+  }
+
+  void _onEvent(dynamic event) {
+    if (event is! Map) return;
+    final job = event['job'] as String?;
+    if (job == null) return;
+    switch (event['action']) {
+      case 'run':
+        _run(job);
+      case 'preempt':
+        _running[job]?._cancelled = true;
+    }
+  }
+
+  Future<void> _run(String job) async {
+    if (_running.containsKey(job)) return;
+    final task = _tasks[job];
+    final cancel = MaintenanceCancel();
+    _running[job] = cancel;
+    final watch = Stopwatch()..start();
+    var result = 'failed';
+    try {
+      if (task != null && await task(cancel)) {
+        result = 'done';
+      } else if (cancel.isCancelled) {
+        result = 'aborted';
+      }
+    } catch (e) {
+      debugPrint('❌ [MAINTENANCE] $job: $e');
+      if (cancel.isCancelled) result = 'aborted';
+    } finally {
+      _running.remove(job);
+    }
+    debugPrint(
+      '🧹 [MAINTENANCE] $job: $result за ${watch.elapsedMilliseconds} мс',
+    );
+    try {
+      await _channel.invokeMethod('finished', {'job': job, 'result': result});
+    } catch (e) {
+      debugPrint('❌ [MAINTENANCE] finished $job: $e');
+    }
+  }
+}
@@ -0,0 +1,94 @@
+import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart';
+
+/// Агреговані метрики каси (затримки, лічильники збоїв) у нативному
+/// реєстрі через канал `com.virok/metrics` (див. native/metrics).
+///
+/// Раннер сам рахує затримки COM/пошуку/звітів, а Dart додає те, що видно
+/// лише тут: час від натискання "Оплатити" до фіскального чека, тривалість
+/// синхронізації, збої друку. Знімок усіх метрик періодично пишеться у файл
+/// у форматі Prometheus. Виклики не чекають відповіді; на платформах без
+/// каналу вони нічого не роблять.
+class NativeMetrics {
+  static const MethodChannel _channel = MethodChannel('com.virok/metrics');
+
+  static bool _available = true;
+
+  NativeMetrics._();
+
+  /// Починає писати знімки у [path]; [lane] додається міткою до всіх серій.
+  static Future<bool> start(
+    String path, {
+    String? lane,
+    Duration interval = const Duration(seconds: 15),
+  }) async {
+    try {
+      final ok = await _channel.invokeMethod<bool>('start', {
+        'path': path,
+        'lane': lane ?? '',
+        'intervalMs': interval.inMilliseconds,
+      });
+      if (ok == true) debugPrint('📈 [METRICS] Знімки метрик: $path');
+      return ok ?? false;
+    } on MissingPluginException {
+      _available = false;
+      return false;
+    }
+  }
+
+  static Future<void> stop() => _invoke('stop', const {});
+
+  /// Додає тривалість [elapsed] у гістограму [name] (мкс).
+  static void observe(
+    String name,
+    Duration elapsed, {
+    String help = '',
+    Map<String, String> labels = const {},
+  }) {
+    _invoke('observe', {
+      'name': name,
+      'help': help,
+      'labels': labels,
+      'valueUs': elapsed.inMicroseconds,
+    });
+  }
+
+  static void count(
+    String name, {
+    int delta = 1,
+    String help = '',
+    Map<String, String> labels = const {},
+  }) {
+    _invoke('count', {
+      'name': name,
+      'help': help,
+      'labels': labels,
+      'delta': delta,
+    });
+  }
+
+  static void gauge(
+    String name,
+    int value, {
+    String help = '',
+    Map<String, String> labels = const {},
+  }) {
+    _invoke('gauge', {
+      'name': name,
+      'help': help,
+      'labels': labels,
+      'value': value,
+    });
+  }
+
+  static Future<void> _invoke(String method, Map<String, Object> args) async {
+    if (!_available) return;
+    try {
+      await _channel.invokeMethod(method, args);
+    } on MissingPluginException {
+      _available = false;
+    } on PlatformException catch (e) {
+      debugPrint('❌ [METRICS] $method: ${e.message}');
+    }
+  }
+}
@@ -0,0 +1,198 @@
+import 'dart:convert';
+
+import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart';
+
+/// Рядок відкладеного кошика. Суми — в гривнях, маса — в кг.
+class ParkedLine {
+  final String guid;
+  final String name;
+  final String article;
+  final String category;
+  final double price;
+  final int quantity;
+  final double weight;
+  final double discount;
+
+  const ParkedLine({
+    required this.guid,
+    required this.name,
+    this.article = '',
+    this.category = '',
+    required this.price,
+    this.quantity = 1,
+    this.weight = 0,
+    this.discount = 0,
+  });
+
+  factory ParkedLine._fromMap(Map<dynamic, dynamic> map) => ParkedLine(
+    guid: map['guid'] as String? ?? '',
+    name: map['name'] as String? ?? '',
+    article: map['article'] as String? ?? '',
+    category: map['category'] as String? ?? '',
+    price: (map['price'] as num?)?.toDouble() ?? 0,
+    quantity: (map['quantity'] as num?)?.toInt() ?? 1,
+    weight: (map['weight'] as num?)?.toDouble() ?? 0,
+    discount: (map['discount'] as num?)?.toDouble() ?? 0,
+  );
+
+  Map<String, dynamic> _toJson() => {
+    'guid': guid,
+    'name': name,
+    'article': article,
+    'category': category,
+    'price': price,
+    'quantity': quantity,
+    'weight': weight,
+    'discount': discount,
+  };
+}
+
+/// Відкладений кошик; у списку ([NativeParkedCarts.list]) — без рядків.
+class ParkedCart {
+  final int id;
+  final DateTime parkedAt;
+  final String cashier;
+  final String paymentForm;
+  final double total;
+  final int lineCount;
+  final List<ParkedLine> lines;
+
+  const ParkedCart({
+    required this.id,
+    required this.parkedAt,
+    required this.cashier,
+    required this.paymentForm,
+    required this.total,
+    required this.lineCount,
+    this.lines = const [],
+  });
+
+  factory ParkedCart._fromMap(Map<dynamic, dynamic> map) {
+    final lines = [
+      for (final line in (map['lines'] as List?) ?? const [])
+        if (line is Map) ParkedLine._fromMap(line),
+    ];
+    final count = map['lines'];
+    return ParkedCart(
+      id: (map['id'] as num?)?.toInt() ?? 0,
+      parkedAt: DateTime.fromMillisecondsSinceEpoch(
+        (map['parkedMs'] as num?)?.toInt() ?? 0,
+      ),
+      cashier: map['cashier'] as String? ?? '',
+      paymentForm: map['paymentForm'] as String? ?? '',
+      total: (map['total'] as num?)?.toDouble() ?? 0,
+      lineCount: count is num ? count.toInt() : lines.length,
+      lines: lines,
+    );
+  }
+}
+
+/// Відкладені кошики каси (канал `com.virok/parked`, див. native/parking).
+///
+/// Кошик пишеться на диск у компактному бінарному вигляді до повернення з
+/// [park] і переживає перезапуск і збій живлення. Список і відновлення
+/// кошика обслуговуються з пам'яті раннера, без Supabase і без читання
+/// диска. Якщо раннер не має каналу (Android/iOS/Web), [isAvailable] —
+/// false і відкладання йде лише через kkm_checks.
+class NativeParkedCarts {
+  static const MethodChannel _channel = MethodChannel('com.virok/parked');
+
+  bool? _available;
+  Future<bool>? _opening;
+
+  /// Відкриває сховище в каталозі [path] (створює за потреби).
+  Future<bool> open(String path) => _opening = _open(path);
+
+  Future<bool> _open(String path) async {
+    try {
+      final stats = await _channel.invokeMapMethod<String, dynamic>('open', {
+        'path': path,
+      });
+      _available = true;
+      debugPrint('🅿️ [PARKED] Відкрито: ${stats?['carts']} відкладених чеків');
+      return true;
+    } on MissingPluginException {
+      _available = false;
+      return false;
+    } catch (e) {
+      debugPrint('❌ [PARKED] Не вдалося відкрити сховище: $e');
+      _available = false;
+      return false;
+    }
+  }
+
+  bool get isAvailable => _available == true;
+
+  /// Як [isAvailable], але дочікується [open], якщо той ще працює
+  /// (відкриття йде у фоні, не затримуючи перший кадр).
+  Future<bool> get ready async => _available ?? await _opening ?? false;
+
+  /// Відкладає кошик; повертає його id або null.
+  Future<int?> park({
+    required String cashier,
+    required String paymentForm,
+    required List<ParkedLine> lines,
+  }) async {
+    if (!await ready) return null;
+    try {
+      return await _channel.invokeMethod<int>('park', {
+        'json': jsonEncode({
+          'cashier': cashier,
+          'paymentForm': paymentForm,
+          'parkedMs': DateTime.now().millisecondsSinceEpoch,
+          'lines': [for (final line in lines) line._toJson()],
+        }),
+      });
+    } catch (e) {
+      debugPrint('❌ [PARKED] Кошик не відкладено: $e');
+      return null;
+    }
+  }
+
+  /// Відкладені кошики касира [cashier] (null — усіх), новіші першими.
+  Future<List<ParkedCart>> list({String? cashier}) async {
+    if (!await ready) return const [];
+    try {
+      final list = await _channel.invokeListMethod<dynamic>('list', {
+        'cashier': cashier ?? '',
+      });
+      return [
+        for (final item in list ?? const [])
+          if (item is Map) ParkedCart._fromMap(item),
+      ];
+    } catch (e) {
+      debugPrint('❌ [PARKED] list: $e');
+      return const [];
+    }
+  }
+
+  /// Кошик [id] з рядками, без вилучення зі сховища (відновлення забирає
+  /// його через [take] лише після перенесення в чек). null — кошика немає.
+  Future<ParkedCart?> get(int id) async {
+    if (!await ready) return null;
+    try {
+      final map = await _channel.invokeMapMethod<String, dynamic>('get', {
+        'id': id,
+      });
+      return map == null ? null : ParkedCart._fromMap(map);
+    } catch (e) {
+      debugPrint('❌ [PARKED] get: $e');
+      return null;
+    }
+  }
+
+  /// Забирає кошик [id] зі сховища. null — кошика вже немає.
+  Future<ParkedCart?> take(int id) async {
+    if (!await ready) return null;
+    try {
+      final map = await _channel.invokeMapMethod<String, dynamic>('take', {
+        'id': id,
+      });
+      return map == null ? null : ParkedCart._fromMap(map);
+    } catch (e) {
+      debugPrint('❌ [PARKED] take: $e');
+      return null;
+    }
+  }
+}
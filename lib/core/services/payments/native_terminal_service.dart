@@ -0,0 +1,259 @@
+import 'dart:async';
+
+import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart';
+import 'package:cash_register/core/models/pos_result.dart';
+
+/// Подія нативного драйвера термінала.
+class TerminalEvent {
+  /// connected, disconnected, state, result, slip
+  final String type;
+
+  /// id запиту (0 — подія з'єднання)
+  final int request;
+  final String method;
+
+  /// Для state: cardTapped, cardInserted, pinEntry, online...
+  final String? state;
+  final bool approved;
+
+  /// Поля відповіді термінала: responseCode, approvalCode, rrn, pan,
+  /// terminalId, receipt...
+  final Map<String, String> params;
+  final String? error;
+
+  /// Для result: від картки на терміналі до схвалення, мкс
+  final int tapToApprovalUs;
+
+  /// Для slip: від картки на терміналі до надрукованого сліпа, мкс
+  final int tapToSlipUs;
+
+  const TerminalEvent({
+    required this.type,
+    required this.request,
+    required this.method,
+    this.state,
+    this.approved = false,
+    this.params = const {},
+    this.error,
+    this.tapToApprovalUs = 0,
+    this.tapToSlipUs = 0,
+  });
+
+  factory TerminalEvent._fromMap(Map<dynamic, dynamic> map) => TerminalEvent(
+    type: map['type'] as String? ?? '',
+    request: (map['request'] as num?)?.toInt() ?? 0,
+    method: map['method'] as String? ?? '',
+    state: map['state'] as String?,
+    approved: map['approved'] as bool? ?? false,
+    params: (map['params'] as Map?)?.map(
+          (key, value) => MapEntry(key.toString(), value.toString()),
+        ) ??
+        const {},
+    error: map['error'] as String?,
+    tapToApprovalUs: (map['tapToApprovalUs'] as num?)?.toInt() ?? 0,
+    tapToSlipUs: (map['tapToSlipUs'] as num?)?.toInt() ?? 0,
+  );
+}
+
+/// Банківський термінал через нативний драйвер (канал `com.virok/terminal`
+/// і потік подій `com.virok/terminal/events`, див. native/terminal).
+///
+/// На відміну від `TerminalPaymentService`, що чекає на відповідь Device
+/// Manager одним довгим HTTP-запитом, драйвер тримає одне з'єднання з
+/// терміналом і звітує про кожен етап оплати ([purchase] з `onState`).
+/// Сліп схваленої оплати драйвер друкує сам, щойно прийшло схвалення, —
+/// каса його вже не друкує. Без каналу або без `terminal_host` [isRunning]
+/// лишається false і оплата йде старим шляхом.
+class NativeTerminalService {
+  static const MethodChannel _channel = MethodChannel('com.virok/terminal');
+  static const EventChannel _eventChannel = EventChannel(
+    'com.virok/terminal/events',
+  );
+
+  bool? _available;
+  bool _running = false;
+  Stream<TerminalEvent>? _events;
+
+  bool get isRunning => _running;
+
+  /// Усі події термінала (підписка на нативний потік — при першому слухачі).
+  Stream<TerminalEvent> get events => _events ??= _eventChannel
+      .receiveBroadcastStream()
+      .where((event) => event is Map)
+      .map((event) => TerminalEvent._fromMap(event as Map))
+      .map((event) {
+        if (event.type == 'disconnected') {
+          debugPrint('⚠️ [TERMINAL] Термінал відключився: ${event.error}');
+        } else if (event.type == 'slip') {
+          if (event.error != null) {
+            debugPrint('❌ [TERMINAL] Сліп не надруковано: ${event.error}');
+          } else {
+            debugPrint(
+              '🧾 [TERMINAL] Сліп надруковано за '
+              '${event.tapToSlipUs ~/ 1000} мс від картки',
+            );
+          }
+        }
+        return event;
+      })
+      .asBroadcastStream();
+
+  /// З'єднується з терміналом [host]:[port]. Якщо задано [printerHost],
+  /// сліп схваленої оплати друкується там у [slipCopies] копіях.
+  Future<bool> start({
+    required String host,
+    int port = 2000,
+    String? printerHost,
+    int printerPort = 9100,
+    int slipCopies = 2,
+  }) async {
+    if (_available == false) return false;
+    try {
+      // Підписка до з'єднання: подія connected не загубиться.
+      events.listen((_) {});
+      await _channel.invokeMethod('start', {
+        'host': host,
+        'port': port,
+        'printerHost': printerHost ?? '',
+        'printerPort': printerPort,
+        'slipCopies': slipCopies,
+      });
+      _available = true;
+      _running = true;
+      debugPrint('💳 [TERMINAL] Термінал $host:$port');
+      return true;
+    } on MissingPluginException {
+      _available = false;
+      return false;
+    } on PlatformException catch (e) {
+      _available = true;
+      _running = false;
+      debugPrint('❌ [TERMINAL] Немає з\'єднання з $host:$port: ${e.message}');
+      return false;
+    }
+  }
+
+  Future<void> stop() async {
+    if (_available != true) return;
+    try {
+      await _channel.invokeMethod('stop');
+    } catch (e) {
+      debugPrint('❌ [TERMINAL] Помилка зупинки драйвера: $e');
+    }
+    _running = false;
+  }
+
+  /// Оплата карткою на суму [amount]. [onState] отримує проміжні стани
+  /// (cardTapped, pinEntry, online...) одразу, як їх надіслав термінал.
+  Future<PosTransactionResult> purchase({
+    required double amount,
+    void Function(String state)? onState,
+    Duration timeout = const Duration(minutes: 2),
+  }) => _pay(
+    'Purchase',
+    {'amount': amount.toStringAsFixed(2)},
+    onState,
+    timeout,
+  );
+
+  /// Повернення на картку за [rrn] оригінальної оплати.
+  Future<PosTransactionResult> refund({
+    required double amount,
+    required String rrn,
+    void Function(String state)? onState,
+    Duration timeout = const Duration(minutes: 2),
+  }) => _pay(
+    'Refund',
+    {'amount': amount.toStringAsFixed(2), 'rrn': rrn},
+    onState,
+    timeout,
+  );
+
+  /// Перериває запит [request], доки покупець не приклав картку.
+  Future<bool> cancel(int request) async {
+    if (!_running) return false;
+    try {
+      return await _channel.invokeMethod<bool>('cancel', {
+            'request': request,
+          }) ??
+          false;
+    } catch (e) {
+      debugPrint('❌ [TERMINAL] Не вдалося перервати запит: $e');
+      return false;
+    }
+  }
+
+  Future<PosTransactionResult> _pay(
+    String method,
+    Map<String, String> params,
+    void Function(String state)? onState,
+    Duration timeout,
+  ) async {
+    if (!_running) {
+      return const PosTransactionResult(
+        isSuccess: false,
+        errorMessage: 'Термінал не підключено',
+      );
+    }
+    // Події можуть прийти раніше, ніж submit поверне id: буферизуємо їх.
+    final early = <TerminalEvent>[];
+    final done = Completer<TerminalEvent>();
+    int? request;
+    void handle(TerminalEvent event) {
+      if (event.type == 'state' && event.state != null) {
+        debugPrint('💳 [TERMINAL] $method: ${event.state}');
+        onState?.call(event.state!);
+      } else if (event.type == 'result' && !done.isCompleted) {
+        done.complete(event);
+      }
+    }
+
+    final subscription = events.listen((event) {
+      if (request == null) {
+        early.add(event);
+      } else if (event.request == request) {
+        handle(event);
+      }
+    });
+    try {
+      request = await _channel.invokeMethod<int>('submit', {
+        'method': method,
+        'params': params,
+        'timeoutMs': timeout.inMilliseconds,
+      });
+      early.where((e) => e.request == request).forEach(handle);
+      early.clear();
+      final result = await done.future;
+      if (!result.approved) {
+        debugPrint('❌ [TERMINAL] $method: ${result.error}');
+        return PosTransactionResult(
+          isSuccess: false,
+          errorMessage: result.error ?? 'Операцію відхилено',
+        );
+      }
+      debugPrint(
+        '✅ [TERMINAL] $method схвалено за '
+        '${result.tapToApprovalUs ~/ 1000} мс від картки',
+      );
+      final p = result.params;
+      return PosTransactionResult(
+        isSuccess: true,
+        rrn: p['rrn'],
+        authCode: p['approvalCode'],
+        terminalId: p['terminalId'],
+        cardPan: p['pan'],
+        paymentSystem: p['paymentSystem'],
+        acquireName: p['bankName'],
+        transactionDate: p['date'],
+      );
+    } on PlatformException catch (e) {
+      return PosTransactionResult(
+        isSuccess: false,
+        errorMessage: e.message ?? 'Термінал не підключено',
+      );
+    } finally {
+      await subscription.cancel();
+    }
+  }
+}
@@ -0,0 +1,191 @@
+import 'dart:ffi';
+import 'dart:isolate';
+
+import 'package:ffi/ffi.dart';
+import 'package:flutter/foundation.dart';
+
+import '../store/native_catalogue_store.dart';
+
+final class _VirokPriceSnapshot extends Opaque {}
+
+typedef _SnapshotNative =
+    Pointer<_VirokPriceSnapshot> Function(
+      Pointer<Void> store,
+      Pointer<Pointer<Utf8>> error,
+    );
+typedef _SnapshotDart =
+    Pointer<_VirokPriceSnapshot> Function(
+      Pointer<Void> store,
+      Pointer<Pointer<Utf8>> error,
+    );
+typedef _SizeNative = Int64 Function(Pointer<_VirokPriceSnapshot>);
+typedef _SizeDart = int Function(Pointer<_VirokPriceSnapshot>);
+typedef _PrintNative =
+    Int64 Function(
+      Pointer<Void> store,
+      Pointer<Void> before,
+      Pointer<Utf8> host,
+      Int32 port,
+      Int32 width,
+      Int32 copies,
+      Pointer<Double> firstLabelMs,
+      Pointer<Pointer<Utf8>> error,
+    );
+typedef _PrintDart =
+    int Function(
+      Pointer<Void> store,
+      Pointer<Void> before,
+      Pointer<Utf8> host,
+      int port,
+      int width,
+      int copies,
+      Pointer<Double> firstLabelMs,
+      Pointer<Pointer<Utf8>> error,
+    );
+typedef _FreeNative = Void Function(Pointer<Void>);
+typedef _FreeDart = void Function(Pointer<Void>);
+
+NativeFinalizer? _finalizer;
+
+/// Ціни каталогу до синхронізації (native/store/price_labels.h).
+/// Синхронізація номенклатури завжди повна, тож змінені ціни —
+/// різниця цього знімка і таблиці після неї.
+class PriceSnapshot implements Finalizable {
+  final Pointer<_VirokPriceSnapshot> _handle;
+
+  /// Кількість товарів у знімку; 0 — каталог був порожній.
+  final int length;
+
+  PriceSnapshot._(this._handle, this.length) {
+    _finalizer!.attach(this, _handle.cast(), externalSize: length * 48);
+  }
+
+  /// Знімає ціни з nomenclatura.db сховища [store] у фоновому ізоляті.
+  /// null — нативної бібліотеки немає або читання не вдалося.
+  static Future<PriceSnapshot?> take(NativeCatalogueStore store) async {
+    final library = NativeCatalogueStore.library;
+    if (library == null) return null;
+    _finalizer ??= NativeFinalizer(
+      library.lookup<NativeFunction<_FreeNative>>(
+        'virok_prices_snapshot_free',
+      ),
+    );
+    final storeAddress = store.address;
+    final (address, error) = await Isolate.run(() => _takeIn(storeAddress));
+    if (address == 0) {
+      debugPrint('❌ [LABELS] Знімок цін не вдався: $error');
+      return null;
+    }
+    final handle = Pointer<_VirokPriceSnapshot>.fromAddress(address);
+    final size = library.lookupFunction<_SizeNative, _SizeDart>(
+      'virok_prices_snapshot_size',
+      isLeaf: true,
+    );
+    return PriceSnapshot._(handle, size(handle));
+  }
+
+  static (int, String?) _takeIn(int storeAddress) {
+    final library = NativeCatalogueStore.library!;
+    final snapshot = library.lookupFunction<_SnapshotNative, _SnapshotDart>(
+      'virok_prices_snapshot',
+    );
+    final free = library.lookupFunction<_FreeNative, _FreeDart>(
+      'virok_ffi_free',
+    );
+    final error = calloc<Pointer<Utf8>>();
+    try {
+      final handle = snapshot(Pointer.fromAddress(storeAddress), error);
+      if (handle != nullptr) return (handle.address, null);
+      final message = error.value == nullptr ? '' : error.value.toDartString();
+      if (error.value != nullptr) free(error.value.cast());
+      return (0, message);
+    } finally {
+      calloc.free(error);
+    }
+  }
+}
+
+/// Пакетний друк цінників (native/printing/label_batch.h): етикетки
+/// товарів зі зміненою ціною верстаються на всіх ядрах і йдуть на
+/// мережевий принтер (RAW) одним потоком, поки верстаються наступні, —
+/// перша етикетка виходить за мілісекунди, а не після верстки всього
+/// пакета (label_batch_bench).
+class NativeLabelPrinter {
+  /// Друкує цінники товарів, чия ціна в [store] відрізняється від
+  /// [before] або яких у ньому не було. Повертає кількість цінників
+  /// (0 — змін немає) або null, якщо нативної бібліотеки немає чи друк
+  /// не вдався.
+  static Future<int?> printChanged(
+    NativeCatalogueStore store,
+    PriceSnapshot before, {
+    required String host,
+    int port = 9100,
+    int width = 32,
+    int copies = 1,
+  }) async {
+    if (NativeCatalogueStore.library == null) return null;
+    final storeAddress = store.address;
+    final beforeAddress = before._handle.address;
+    final (count, firstLabelMs, error) = await Isolate.run(
+      () => _printIn(
+        storeAddress,
+        beforeAddress,
+        host,
+        port,
+        width,
+        copies,
+      ),
+    );
+    if (count < 0) {
+      debugPrint('❌ [LABELS] Цінники не надруковано ($host:$port): $error');
+      return null;
+    }
+    if (count > 0) {
+      debugPrint(
+        '🏷️ [LABELS] $count цінників на $host:$port, перший — за '
+        '${firstLabelMs.toStringAsFixed(1)} мс',
+      );
+    }
+    return count;
+  }
+
+  static (int, double, String?) _printIn(
+    int storeAddress,
+    int beforeAddress,
+    String host,
+    int port,
+    int width,
+    int copies,
+  ) {
+    final library = NativeCatalogueStore.library!;
+    final print = library.lookupFunction<_PrintNative, _PrintDart>(
+      'virok_labels_print_changed',
+    );
+    final free = library.lookupFunction<_FreeNative, _FreeDart>(
+      'virok_ffi_free',
+    );
+    final nativeHost = host.toNativeUtf8();
+    final firstLabelMs = calloc<Double>();
+    final error = calloc<Pointer<Utf8>>();
+    try {
+      final count = print(
+        Pointer.fromAddress(storeAddress),
+        Pointer.fromAddress(beforeAddress),
+        nativeHost,
+        port,
+        width,
+        copies,
+        firstLabelMs,
+        error,
+      );
+      if (count >= 0) return (count, firstLabelMs.value, null);
+      final message = error.value == nullptr ? '' : error.value.toDartString();
+      if (error.value != nullptr) free(error.value.cast());
+      return (-1, 0.0, message);
+    } finally {
+      malloc.free(nativeHost);
+      calloc.free(firstLabelMs);
+      calloc.free(error);
+    }
+  }
+}
@@ -6,6 +6,8 @@ import 'package:enough_convert/enough_convert.dart';
 import 'package:get_it/get_it.dart';
 import 'package:cash_register/core/services/storage/storage_service.dart';
 import 'package:cash_register/core/config/vchasno_config.dart';
+import 'package:cash_register/core/services/metrics/native_metrics.dart';
+import 'package:cash_register/core/services/trace/native_trace.dart';
 
 class RawPrinterService {
   final StorageService _storageService;
@@ -33,12 +35,16 @@ class RawPrinterService {
   /// Друкує візуалізацію (X-звіт, Z-звіт, Чек) з поля visualization
   ///
   /// Якщо [printerIp] або [port] не передані, бере їх з SharedPreferences.
+  /// Якщо є [printData] (звіт розібрано нативно), байти відправляються як є,
+  /// без повторного декодування Base64 і перекодування в CP1251.
   Future<void> printVisualization({
     required String? visualizationBase64,
+    Uint8List? printData,
     String? printerIp,
     int? port,
   }) async {
-    if (visualizationBase64 == null || visualizationBase64.isEmpty) {
+    if ((visualizationBase64 == null || visualizationBase64.isEmpty) &&
+        printData == null) {
       debugPrint("⚠️ [PRINTER] Немає даних для друку");
       return;
     }
@@ -57,35 +63,54 @@ class RawPrinterService {
         "🖨️ [PRINTER] Друкуємо візуалізацію на $targetIp:$targetPort",
       );
 
-      final socket = await Socket.connect(
-        targetIp,
-        targetPort,
-        timeout: const Duration(seconds: 5),
+      final socket = await NativeTrace.span(
+        'print',
+        'connect',
+        () => Socket.connect(
+          targetIp,
+          targetPort,
+          timeout: const Duration(seconds: 5),
+        ),
       );
 
-      List<int> bytesToSend = [];
+      if (printData != null) {
+        // Вже містить ініціалізацію, текст у CP1251 і відрізку.
+        socket.add(printData);
+      } else {
+        List<int> bytesToSend = [];
 
-      // Ініціалізація + Code Page 17 (PC866/Win1251)
-      bytesToSend.addAll([0x1B, 0x40, 0x1B, 0x74, 17]);
+        // Ініціалізація + Code Page 17 (PC866/Win1251)
+        bytesToSend.addAll([0x1B, 0x40, 0x1B, 0x74, 17]);
 
-      // Декодування Base64 -> UTF-8 -> Windows-1251
-      String cleanBase64 = visualizationBase64.replaceAll(RegExp(r'\s+'), '');
-      List<int> utf8Bytes = base64.decode(cleanBase64);
-      String decodedText = utf8.decode(utf8Bytes);
+        // Декодування Base64 -> UTF-8 -> Windows-1251
+        String cleanBase64 = visualizationBase64!.replaceAll(
+          RegExp(r'\s+'),
+          '',
+        );
+        List<int> utf8Bytes = base64.decode(cleanBase64);
+        String decodedText = utf8.decode(utf8Bytes);
 
-      final codec = const Windows1251Codec(allowInvalid: true);
-      bytesToSend.addAll(codec.encode(decodedText));
+        final codec = const Windows1251Codec(allowInvalid: true);
+        bytesToSend.addAll(codec.encode(decodedText));
 
-      // Footer: Feed & Cut
-      bytesToSend.addAll([0x1B, 0x64, 0x04, 0x1D, 0x56, 0x42, 0x00]);
+        // Footer: Feed & Cut
+        bytesToSend.addAll([0x1B, 0x64, 0x04, 0x1D, 0x56, 0x42, 0x00]);
 
-      socket.add(Uint8List.fromList(bytesToSend));
-      await socket.flush();
-      await socket.close();
+        socket.add(Uint8List.fromList(bytesToSend));
+      }
+      await NativeTrace.span('print', 'visualization', () async {
+        await socket.flush();
+        await socket.close();
+      });
 
       debugPrint("✅ [PRINTER] Друк успішний!");
     } catch (e) {
       debugPrint("❌ [PRINTER] Помилка: $e");
+      NativeMetrics.count(
+        'virok_print_failures_total',
+        help: 'Failed raw prints to the receipt printer',
+        labels: {'kind': 'visualization'},
+      );
       rethrow;
     }
   }
@@ -111,10 +136,14 @@ class RawPrinterService {
     try {
       debugPrint("🖨️ [PRINTER] Друкуємо сліп на $targetIp:$targetPort");
 
-      final socket = await Socket.connect(
-        targetIp,
-        targetPort,
-        timeout: const Duration(seconds: 5),
+      final socket = await NativeTrace.span(
+        'print',
+        'connect',
+        () => Socket.connect(
+          targetIp,
+          targetPort,
+          timeout: const Duration(seconds: 5),
+        ),
       );
 
       List<int> bytesToSend = [];
@@ -134,10 +163,17 @@ class RawPrinterService {
       ]); // Feed + Cut
 
       socket.add(Uint8List.fromList(bytesToSend));
-      await socket.flush();
-      await socket.close();
+      await NativeTrace.span('print', 'bankSlip', () async {
+        await socket.flush();
+        await socket.close();
+      });
     } catch (e) {
       debugPrint("❌ [PRINTER] Помилка друку сліпа: $e");
+      NativeMetrics.count(
+        'virok_print_failures_total',
+        help: 'Failed raw prints to the receipt printer',
+        labels: {'kind': 'bankSlip'},
+      );
       rethrow;
     }
   }
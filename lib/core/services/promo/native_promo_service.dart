@@ -0,0 +1,133 @@
+import 'dart:convert';
+
+import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart';
+import 'package:supabase_flutter/supabase_flutter.dart';
+
+/// Знижки рядків після зміни кошика.
+class PromoUpdate {
+  /// Нова знижка (грн, на весь рядок) для рядків, у яких вона змінилася
+  final Map<String, double> changed;
+
+  /// Сума знижок чека
+  final double total;
+
+  const PromoUpdate({required this.changed, required this.total});
+
+  factory PromoUpdate._fromMap(Map<String, dynamic> map) => PromoUpdate(
+    changed: (map['changed'] as Map).map(
+      (guid, discount) =>
+          MapEntry(guid as String, (discount as num).toDouble()),
+    ),
+    total: (map['total'] as num?)?.toDouble() ?? 0,
+  );
+}
+
+/// Акції та знижки поточного чека (канал `com.virok/promo`, див.
+/// native/promo).
+///
+/// Правила акцій завантажуються з таблиці `promo_rules` у нативний рушій,
+/// який на кожне сканування переоцінює лише правила, що стосуються
+/// зміненого рядка, і повертає знижки рядків, які змінилися. Якщо раннер не
+/// має каналу (Android/iOS/Web), усі методи повертають null — чек
+/// проводиться без знижок.
+class NativePromoService {
+  static const MethodChannel _channel = MethodChannel('com.virok/promo');
+
+  /// Як часто підтягувати змінені правила (лише між чеками)
+  static const Duration _rulesTtl = Duration(minutes: 15);
+
+  final SupabaseClient _client;
+
+  bool? _available;
+  DateTime? _loadedAt;
+  Future<bool>? _loading;
+
+  NativePromoService(this._client);
+
+  /// Завантажує правила, якщо їх ще немає або вони застаріли.
+  Future<bool> ensureRules() {
+    return _loading ??= _loadRules().whenComplete(() => _loading = null);
+  }
+
+  Future<bool> _loadRules() async {
+    if (_available == false) return false;
+    final loadedAt = _loadedAt;
+    if (loadedAt != null && DateTime.now().difference(loadedAt) < _rulesTtl) {
+      return true;
+    }
+
+    try {
+      final rows = await _client
+          .schema('virok_cashier')
+          .from('promo_rules')
+          .select('rule')
+          .eq('active', true);
+      final rules = rows.map((row) => row['rule']).toList();
+
+      final result = await _channel.invokeMapMethod<String, dynamic>(
+        'loadRules',
+        {'json': jsonEncode(rules)},
+      );
+      _available = true;
+      _loadedAt = DateTime.now();
+      debugPrint('🏷️ [PROMO] Завантажено акцій: ${result?['rules']}');
+      return true;
+    } on MissingPluginException {
+      _available = false;
+      return false;
+    } on PlatformException catch (e) {
+      // Некоректні правила: нативний рушій лишає попередній набір
+      debugPrint('❌ [PROMO] Правила відхилено: ${e.message}');
+      _loadedAt = DateTime.now();
+      return _available ??= true;
+    } catch (e) {
+      debugPrint('❌ [PROMO] Помилка завантаження правил: $e');
+      return _available ?? false;
+    }
+  }
+
+  /// Додає або змінює рядок чека.
+  Future<PromoUpdate?> setLine({
+    required String guid,
+    required String category,
+    required double price,
+    required num quantity,
+  }) async {
+    if (!await ensureRules()) return null;
+    return _update('setLine', {
+      'guid': guid,
+      'category': category,
+      'price': price,
+      'quantity': quantity.toDouble(),
+    });
+  }
+
+  Future<PromoUpdate?> removeLine(String guid) async {
+    if (_available != true) return null;
+    return _update('removeLine', {'guid': guid});
+  }
+
+  /// Новий чек: кошик рушія очищується, правила оновлюються за потреби.
+  Future<void> clear() async {
+    if (_available != true) return;
+    try {
+      await _channel.invokeMethod('clear');
+    } catch (e) {
+      debugPrint('❌ [PROMO] Помилка очищення кошика: $e');
+    }
+  }
+
+  Future<PromoUpdate?> _update(String method, Map<String, dynamic> args) async {
+    try {
+      final result = await _channel.invokeMapMethod<String, dynamic>(
+        method,
+        args,
+      );
+      return result == null ? null : PromoUpdate._fromMap(result);
+    } catch (e) {
+      debugPrint('❌ [PROMO] $method: $e');
+      return null;
+    }
+  }
+}
@@ -13,6 +13,8 @@ import 'package:cash_register/core/models/fiscal_result.dart';
 import 'package:cash_register/core/models/x_report_data.dart';
 import 'package:cash_register/core/models/prro_info.dart';
 import 'package:cash_register/core/services/printing/raw_printer_service.dart';
+import 'package:cash_register/core/services/report/native_report_decoder.dart';
+import 'package:cash_register/core/services/trace/native_trace.dart';
 
 class VchasnoService implements PrroService {
   String? _lastCheckTag; // Для відстеження останнього чека
@@ -119,21 +121,25 @@ class VchasnoService implements PrroService {
       debugPrint("📤 [VCHASNO] JSON Body: $requestJson");
 
       // Відправка з таймаутом
-      final response = await http
-          .post(
-            Uri.parse(VchasnoConfig.baseUrl),
-            headers: {'Content-Type': 'application/json'},
-            body: requestJson,
-          )
-          .timeout(
-            const Duration(seconds: 30),
-            onTimeout: () {
-              throw TimeoutException(
-                'Таймаут з\'єднання з Device Manager',
-                const Duration(seconds: 30),
-              );
-            },
-          );
+      final response = await NativeTrace.span(
+        'vchasno',
+        'printSale',
+        () => http
+            .post(
+              Uri.parse(VchasnoConfig.baseUrl),
+              headers: {'Content-Type': 'application/json'},
+              body: requestJson,
+            )
+            .timeout(
+              const Duration(seconds: 30),
+              onTimeout: () {
+                throw TimeoutException(
+                  'Таймаут з\'єднання з Device Manager',
+                  const Duration(seconds: 30),
+                );
+              },
+            ),
+      );
 
       final jsonResp = jsonDecode(response.body) as Map<String, dynamic>;
       debugPrint("📥 [VCHASNO] Response: $jsonResp");
@@ -329,13 +335,17 @@ class VchasnoService implements PrroService {
         },
       };
 
-      final response = await http
-          .post(
-            Uri.parse(VchasnoConfig.baseUrl),
-            headers: {'Content-Type': 'application/json'},
-            body: jsonEncode(body),
-          )
-          .timeout(const Duration(seconds: 10));
+      final response = await NativeTrace.span(
+        'vchasno',
+        'checkLastCheck',
+        () => http
+            .post(
+              Uri.parse(VchasnoConfig.baseUrl),
+              headers: {'Content-Type': 'application/json'},
+              body: jsonEncode(body),
+            )
+            .timeout(const Duration(seconds: 10)),
+      );
 
       final jsonResp = jsonDecode(response.body) as Map<String, dynamic>;
       final res = jsonResp['res'] as int? ?? -1;
@@ -376,13 +386,25 @@ class VchasnoService implements PrroService {
 
       debugPrint("📡 [VCHASNO] Requesting X-Report...");
 
-      final response = await http
-          .post(
-            Uri.parse(VchasnoConfig.baseUrl),
-            headers: {'Content-Type': 'application/json'},
-            body: jsonEncode(body),
-          )
-          .timeout(const Duration(seconds: 30));
+      final response = await NativeTrace.span(
+        'vchasno',
+        'xReport',
+        () => http
+            .post(
+              Uri.parse(VchasnoConfig.baseUrl),
+              headers: {'Content-Type': 'application/json'},
+              body: jsonEncode(body),
+            )
+            .timeout(const Duration(seconds: 30)),
+      );
+
+      // Великий Z-звіт розбираємо нативно: без дерева JSON на UI-ізоляті
+      // і з готовими байтами для друку.
+      final decoded = await const NativeReportDecoder().decode(response.body);
+      if (decoded != null && decoded.res == 0) {
+        debugPrint("✅ [VCHASNO] X-Report parsed natively");
+        return decoded.report;
+      }
 
       final jsonResp = jsonDecode(response.body) as Map<String, dynamic>;
       debugPrint("📥 [VCHASNO] X-Report Response: $jsonResp");
@@ -430,13 +452,25 @@ class VchasnoService implements PrroService {
 
       debugPrint("📡 [VCHASNO] Requesting Z-Report...");
 
-      final response = await http
-          .post(
-            Uri.parse(VchasnoConfig.baseUrl),
-            headers: {'Content-Type': 'application/json'},
-            body: jsonEncode(body),
-          )
-          .timeout(const Duration(seconds: 30));
+      final response = await NativeTrace.span(
+        'vchasno',
+        'zReport',
+        () => http
+            .post(
+              Uri.parse(VchasnoConfig.baseUrl),
+              headers: {'Content-Type': 'application/json'},
+              body: jsonEncode(body),
+            )
+            .timeout(const Duration(seconds: 30)),
+      );
+
+      // Великий Z-звіт розбираємо нативно: без дерева JSON на UI-ізоляті
+      // і з готовими байтами для друку.
+      final decoded = await const NativeReportDecoder().decode(response.body);
+      if (decoded != null && decoded.res == 0) {
+        debugPrint("✅ [VCHASNO] Z-Report parsed natively");
+        return decoded.report;
+      }
 
       final jsonResp = jsonDecode(response.body) as Map<String, dynamic>;
       debugPrint("📥 [VCHASNO] Z-Report Response: $jsonResp");
@@ -493,13 +527,17 @@ class VchasnoService implements PrroService {
 
       debugPrint("📡 [VCHASNO] Sending Task $taskType...");
 
-      final response = await http
-          .post(
-            Uri.parse(VchasnoConfig.baseUrl),
-            headers: {'Content-Type': 'application/json'},
-            body: jsonEncode(body),
-          )
-          .timeout(const Duration(seconds: 30));
+      final response = await NativeTrace.span(
+        'vchasno',
+        'task',
+        () => http
+            .post(
+              Uri.parse(VchasnoConfig.baseUrl),
+              headers: {'Content-Type': 'application/json'},
+              body: jsonEncode(body),
+            )
+            .timeout(const Duration(seconds: 30)),
+      );
 
       final jsonResp = jsonDecode(response.body) as Map<String, dynamic>;
       debugPrint("📥 [VCHASNO] Task $taskType Response: $jsonResp");
@@ -558,10 +596,14 @@ class VchasnoService implements PrroService {
 
       debugPrint("📡 [VCHASNO] Service Task $fiscalTask (${amount} UAH)...");
 
-      final response = await http.post(
-        Uri.parse(VchasnoConfig.baseUrl),
-        headers: {'Content-Type': 'application/json'},
-        body: jsonEncode(body),
+      final response = await NativeTrace.span(
+        'vchasno',
+        'serviceTask',
+        () => http.post(
+          Uri.parse(VchasnoConfig.baseUrl),
+          headers: {'Content-Type': 'application/json'},
+          body: jsonEncode(body),
+        ),
       );
 
       final jsonResp = jsonDecode(response.body);
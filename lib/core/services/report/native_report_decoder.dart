@@ -0,0 +1,42 @@
+import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart';
+import 'package:cash_register/core/models/x_report_data.dart';
+
+/// Розбір відповідей X/Z-звітів у нативному коді (канал `com.virok/report`,
+/// див. native/report).
+///
+/// JSON розбирається потоковим парсером поза UI-ізолятом, а візуалізація
+/// одразу перетворюється на ESC/POS байти ([XReportData.printData]).
+/// На платформах без каналу [decode] повертає null, і викликач
+/// використовує [XReportData.fromJson].
+class NativeReportDecoder {
+  static const MethodChannel _channel = MethodChannel('com.virok/report');
+
+  static bool? _available;
+
+  const NativeReportDecoder();
+
+  /// Розбирає сиру відповідь пристрою. Повертає null, якщо нативний
+  /// розбір недоступний або JSON некоректний.
+  Future<({int? res, XReportData report})?> decode(String json) async {
+    if (_available == false) return null;
+
+    try {
+      final map = await _channel.invokeMapMethod<String, dynamic>('decode', {
+        'json': json,
+      });
+      _available = true;
+      if (map == null) return null;
+      return (
+        res: (map['res'] as num?)?.toInt(),
+        report: XReportData.fromNative(map),
+      );
+    } on MissingPluginException {
+      _available = false;
+      return null;
+    } on PlatformException catch (e) {
+      debugPrint('❌ [REPORT] Помилка розбору звіту: ${e.message}');
+      return null;
+    }
+  }
+}
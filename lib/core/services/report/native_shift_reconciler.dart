@@ -0,0 +1,226 @@
+import 'dart:convert';
+
+import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart';
+import 'package:cash_register/core/models/x_report_data.dart';
+
+/// Оборот за формою оплати (продажі мінус повернення), грн.
+class ReconciledForm {
+  final String form;
+  final double device;
+  final double server;
+  final double till;
+
+  const ReconciledForm({
+    required this.form,
+    required this.device,
+    required this.server,
+    required this.till,
+  });
+
+  bool get matches => device == server && server == till;
+}
+
+/// База податкової групи (продажі мінус повернення), грн.
+class ReconciledTax {
+  final String group;
+  final double device;
+  final double server;
+
+  /// false — kkm_checks не мають розбивки за групами, звіряти нема з чим.
+  final bool serverKnown;
+
+  const ReconciledTax({
+    required this.group,
+    required this.device,
+    required this.server,
+    required this.serverKnown,
+  });
+
+  bool get matches => !serverKnown || device == server;
+}
+
+/// Розбіжність окремого чека між kkm_checks і архівом каси.
+class CheckDiscrepancy {
+  /// missingOnServer, missingInArchive, amountMismatch, formMismatch,
+  /// rrnMismatch, duplicateNumber, duplicateRrn
+  final String kind;
+  final String? number;
+  final String? rrn;
+  final double serverAmount;
+  final double tillAmount;
+  final String? serverForm;
+  final String? tillForm;
+
+  const CheckDiscrepancy({
+    required this.kind,
+    this.number,
+    this.rrn,
+    this.serverAmount = 0,
+    this.tillAmount = 0,
+    this.serverForm,
+    this.tillForm,
+  });
+}
+
+/// Звірка зміни перед Z-звітом: X-звіт пристрою, kkm_checks на сервері,
+/// архів чеків каси і готівка в шухляді.
+class ShiftReconciliation {
+  final bool balanced;
+  final List<ReconciledForm> forms;
+  final List<ReconciledTax> taxes;
+  final List<CheckDiscrepancy> checks;
+  final int deviceSales;
+  final int deviceRefunds;
+  final int serverSales;
+  final int serverRefunds;
+  final int tillSales;
+  final int tillRefunds;
+
+  /// Залишок готівки за X-звітом і перераховане касиром (null — не
+  /// перераховано).
+  final double cashExpected;
+  final double? cashCounted;
+  final Duration elapsed;
+
+  const ShiftReconciliation({
+    required this.balanced,
+    required this.forms,
+    required this.taxes,
+    required this.checks,
+    required this.deviceSales,
+    required this.deviceRefunds,
+    required this.serverSales,
+    required this.serverRefunds,
+    required this.tillSales,
+    required this.tillRefunds,
+    required this.cashExpected,
+    this.cashCounted,
+    required this.elapsed,
+  });
+
+  /// Нативний звіт: суми в копійках.
+  factory ShiftReconciliation._fromNative(Map<dynamic, dynamic> map) {
+    double uah(Object? kopecks) => ((kopecks as int?) ?? 0) / 100;
+    List<T> list<T>(String key, T Function(Map<dynamic, dynamic>) build) {
+      final items = map[key] as List?;
+      if (items == null) return const [];
+      return [for (final item in items) build(item as Map<dynamic, dynamic>)];
+    }
+
+    final counted = map['cashCounted'] as int?;
+    return ShiftReconciliation(
+      balanced: map['balanced'] as bool? ?? false,
+      forms: list(
+        'forms',
+        (f) => ReconciledForm(
+          form: f['form'] as String? ?? '',
+          device: uah(f['device']),
+          server: uah(f['server']),
+          till: uah(f['till']),
+        ),
+      ),
+      taxes: list(
+        'taxes',
+        (t) => ReconciledTax(
+          group: t['group'] as String? ?? '',
+          device: uah(t['device']),
+          server: uah(t['server']),
+          serverKnown: t['serverKnown'] as bool? ?? false,
+        ),
+      ),
+      checks: list(
+        'checks',
+        (c) => CheckDiscrepancy(
+          kind: c['kind'] as String? ?? '',
+          number: c['number'] as String?,
+          rrn: c['rrn'] as String?,
+          serverAmount: uah(c['serverAmount']),
+          tillAmount: uah(c['tillAmount']),
+          serverForm: c['serverForm'] as String?,
+          tillForm: c['tillForm'] as String?,
+        ),
+      ),
+      deviceSales: map['deviceSales'] as int? ?? 0,
+      deviceRefunds: map['deviceRefunds'] as int? ?? 0,
+      serverSales: map['serverSales'] as int? ?? 0,
+      serverRefunds: map['serverRefunds'] as int? ?? 0,
+      tillSales: map['tillSales'] as int? ?? 0,
+      tillRefunds: map['tillRefunds'] as int? ?? 0,
+      cashExpected: uah(map['cashExpected']),
+      cashCounted: counted != null ? counted / 100 : null,
+      elapsed: Duration(microseconds: map['elapsedUs'] as int? ?? 0),
+    );
+  }
+}
+
+/// Звірка зміни в нативному коді (метод `reconcile` каналу
+/// `com.virok/report`, див. native/reconcile).
+///
+/// Рядки kkm_checks розбираються й з'єднуються з архівом каси (за
+/// фіскальним номером, далі за RRN) паралельно, у копійках, без
+/// округлень double. На платформах без каналу [reconcile] повертає null.
+class NativeShiftReconciler {
+  static const MethodChannel _channel = MethodChannel('com.virok/report');
+
+  static bool? _available;
+
+  const NativeShiftReconciler();
+
+  /// [serverChecks] — рядки kkm_checks зміни як їх повернув Supabase;
+  /// [drawerCounted] — готівка, перерахована в шухляді.
+  Future<ShiftReconciliation?> reconcile({
+    required XReportData report,
+    required List<Map<String, dynamic>> serverChecks,
+    required DateTime shiftOpened,
+    double? drawerCounted,
+  }) async {
+    if (_available == false) return null;
+
+    try {
+      final map = await _channel.invokeMapMethod<String, dynamic>(
+        'reconcile',
+        {
+          'report': {
+            'safe': report.safe,
+            'countP': report.receipt?.countP ?? 0,
+            'countM': report.receipt?.countM ?? 0,
+            'pays': [
+              for (final pay in report.pays)
+                {'name': pay.name, 'sumP': pay.sumP, 'sumM': pay.sumM},
+            ],
+            'taxes': [
+              for (final tax in report.taxes)
+                {
+                  'grCode': tax.grCode,
+                  'taxLit': tax.taxLit,
+                  'baseSumP': tax.baseSumP,
+                  'baseSumM': tax.baseSumM,
+                },
+            ],
+          },
+          // Один рядок JSON замість тисяч мап через кодек каналу.
+          'checks': jsonEncode(serverChecks),
+          'shiftOpenedMs': shiftOpened.millisecondsSinceEpoch,
+          if (drawerCounted != null) 'drawer': drawerCounted,
+        },
+      );
+      _available = true;
+      if (map == null) return null;
+      final result = ShiftReconciliation._fromNative(map);
+      final summary = result.balanced
+          ? 'зміна зійшлася'
+          : 'розбіжностей у чеках: ${result.checks.length}';
+      debugPrint(
+        '🧮 [RECONCILE] $summary, ${result.elapsed.inMilliseconds} мс',
+      );
+      return result;
+    } on MissingPluginException {
+      _available = false;
+      return null;
+    } on PlatformException catch (e) {
+      debugPrint('❌ [RECONCILE] Помилка звірки зміни: ${e.message}');
+      return null;
+    }
+  }
+}
@@ -0,0 +1,140 @@
+import 'dart:async';
+
+import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart';
+
+/// Подія торгових ваг.
+class ScaleEvent {
+  /// connected, disconnected, weight, stable, removed
+  final String type;
+
+  /// Маса нетто, г
+  final int grams;
+
+  /// Для stable: від моменту, коли маса встановилася, до події, мкс
+  final int settleUs;
+
+  /// Для stable: від моменту, коли товар поклали, до події, мкс
+  final int loadUs;
+
+  final String? error;
+
+  const ScaleEvent({
+    required this.type,
+    required this.grams,
+    this.settleUs = 0,
+    this.loadUs = 0,
+    this.error,
+  });
+
+  double get kilograms => grams / 1000;
+
+  factory ScaleEvent._fromMap(Map<dynamic, dynamic> map) => ScaleEvent(
+    type: map['type'] as String? ?? '',
+    grams: (map['grams'] as num?)?.toInt() ?? 0,
+    settleUs: (map['settleUs'] as num?)?.toInt() ?? 0,
+    loadUs: (map['loadUs'] as num?)?.toInt() ?? 0,
+    error: map['error'] as String?,
+  );
+}
+
+/// Одиниця виміру вагового товару (ціна за кілограм).
+bool isWeighedUnit(String unitName) {
+  final unit = unitName.trim().toLowerCase();
+  return unit == 'кг' || unit == 'kg';
+}
+
+/// Торгові ваги на COM-порту (канал `com.virok/scale` і потік подій
+/// `com.virok/scale/events`, див. native/scale).
+///
+/// Нативний драйвер читає ваги в окремому потоці й сам визначає, коли маса
+/// встановилася: [stableWeights] видає її одразу, без опитування з Dart.
+/// Якщо раннер не має каналу (Android/iOS/Web) або ваги не налаштовано,
+/// [isRunning] лишається false і вагові товари додаються як штучні.
+class NativeScaleService {
+  static const MethodChannel _channel = MethodChannel('com.virok/scale');
+  static const EventChannel _eventChannel = EventChannel(
+    'com.virok/scale/events',
+  );
+
+  bool? _available;
+  bool _running = false;
+  Stream<ScaleEvent>? _events;
+
+  bool get isRunning => _running;
+
+  /// Усі події ваг (підписка на нативний потік — при першому слухачі).
+  Stream<ScaleEvent> get events => _events ??= _eventChannel
+      .receiveBroadcastStream()
+      .where((event) => event is Map)
+      .map((event) => ScaleEvent._fromMap(event as Map))
+      .map((event) {
+        if (event.type == 'disconnected') {
+          debugPrint('⚠️ [SCALE] Ваги відключилися: ${event.error}');
+        } else if (event.type == 'stable') {
+          debugPrint(
+            '⚖️ [SCALE] ${event.kilograms.toStringAsFixed(3)} кг '
+            '(виявлено за ${event.settleUs ~/ 1000} мс після '
+            'встановлення, ${event.loadUs ~/ 1000} мс від початку)',
+          );
+        }
+        return event;
+      })
+      .asBroadcastStream();
+
+  /// Маса, що встановилася, кг.
+  Stream<double> get stableWeights =>
+      events.where((e) => e.type == 'stable').map((e) => e.kilograms);
+
+  /// Маса, що вже встановилася і лежить на платформі, кг; null — немає
+  /// (порожньо, маса ще змінюється або ваги не працюють). Товар, який
+  /// поклали до вибору в каталозі, не дасть нової події [stableWeights].
+  Future<double?> currentStableWeight() async {
+    if (!_running) return null;
+    try {
+      final grams = await _channel.invokeMethod<int>('stableWeight');
+      return grams == null ? null : grams / 1000;
+    } catch (e) {
+      debugPrint('❌ [SCALE] stableWeight: $e');
+      return null;
+    }
+  }
+
+  /// Відкриває порт ваг. [protocol]: cas, mt-sics або toledo-8217.
+  Future<bool> start({
+    required String port,
+    int baud = 9600,
+    String protocol = 'cas',
+  }) async {
+    if (_available == false) return false;
+    try {
+      await _channel.invokeMethod('start', {
+        'port': port,
+        'baud': baud,
+        'protocol': protocol,
+      });
+      _available = true;
+      _running = true;
+      debugPrint('⚖️ [SCALE] Ваги на $port ($protocol, $baud бод)');
+      return true;
+    } on MissingPluginException {
+      _available = false;
+      return false;
+    } on PlatformException catch (e) {
+      _available = true;
+      _running = false;
+      debugPrint('❌ [SCALE] Не вдалося відкрити $port: ${e.message}');
+      return false;
+    }
+  }
+
+  Future<void> stop() async {
+    if (_available != true) return;
+    try {
+      await _channel.invokeMethod('stop');
+    } catch (e) {
+      debugPrint('❌ [SCALE] Помилка зупинки ваг: $e');
+    }
+    _running = false;
+  }
+}
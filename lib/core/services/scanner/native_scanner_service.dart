@@ -0,0 +1,115 @@
+import 'dart:async';
+
+import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart';
+import 'package:flutter/widgets.dart';
+
+/// Сканер штрихкодів у режимі клавіатури (канал `com.virok/scanner` і потік
+/// `com.virok/scanner/events`, див. native/scanner).
+///
+/// Раннер розпізнає сплеск клавіш сканера за темпом і завершувачем ще до
+/// Flutter: символи коду не потрапляють у текстові поля (жодних
+/// перебудов і дебаунсу пошуку на кожен символ), а [barcodes] отримує код
+/// цілим. Набір касира проходить як і раніше, із затримкою до ~30 мс.
+/// На платформах без каналу [barcodes] просто нічого не видає.
+class NativeScannerService {
+  static const MethodChannel _channel = MethodChannel('com.virok/scanner');
+  static const EventChannel _eventChannel = EventChannel(
+    'com.virok/scanner/events',
+  );
+
+  bool? _available;
+  Stream<String>? _barcodes;
+
+  /// Зчитані штрихкоди (підписка на нативний потік — при першому слухачі).
+  Stream<String> get barcodes => _barcodes ??= _eventChannel
+      .receiveBroadcastStream()
+      .where((event) => event is Map && event['barcode'] is String)
+      .map((event) {
+        final map = event as Map;
+        final burstUs = (map['burstUs'] as num?)?.toInt() ?? 0;
+        debugPrint(
+          '🔖 [SCANNER] ${map['barcode']} '
+          '(сплеск ${(burstUs / 1000).toStringAsFixed(1)} мс)',
+        );
+        return map['barcode'] as String;
+      })
+      .handleError((Object e) {
+        if (e is! MissingPluginException) {
+          debugPrint('❌ [SCANNER] Помилка потоку сканера: $e');
+        }
+      })
+      .asBroadcastStream();
+
+  /// Налаштування розпізнавання. [prefix] — символ, яким сканер починає
+  /// код (порожній — без префікса); [suffix] — завершувач ('\r' — Enter,
+  /// '\t' — Tab, порожній — код закінчується паузою).
+  Future<void> configure({
+    bool? enabled,
+    int? maxGapMs,
+    int? minLength,
+    String? prefix,
+    String? suffix,
+  }) async {
+    if (_available == false) return;
+    try {
+      await _channel.invokeMethod('configure', {
+        if (enabled != null) 'enabled': enabled,
+        if (maxGapMs != null) 'maxGapMs': maxGapMs,
+        if (minLength != null) 'minLength': minLength,
+        if (prefix != null) 'prefix': prefix,
+        if (suffix != null) 'suffix': suffix,
+      });
+      _available = true;
+    } on MissingPluginException {
+      _available = false;
+    } catch (e) {
+      debugPrint('❌ [SCANNER] Не вдалося налаштувати сканер: $e');
+    }
+  }
+
+  /// Пише потік клавіш у [path] (формат native/test/data/scanner/*.keys),
+  /// щоб підібрати налаштування під конкретний сканер. null — зупинити.
+  Future<bool> record(String? path) async {
+    if (_available == false) return false;
+    try {
+      await _channel.invokeMethod('record', {'path': path ?? ''});
+      _available = true;
+      return true;
+    } on MissingPluginException {
+      _available = false;
+      return false;
+    } on PlatformException catch (e) {
+      debugPrint('❌ [SCANNER] Запис клавіш: ${e.message}');
+      return false;
+    }
+  }
+
+  /// Вставляє [barcode] у текстове поле з фокусом замість виділення — так,
+  /// як його надрукував би сканер без розпізнавання сплеску. Для сторінок,
+  /// що не обробляють [barcodes] самі. false — поля з фокусом немає.
+  static bool typeIntoFocusedField(String barcode) {
+    final context = FocusManager.instance.primaryFocus?.context;
+    final editable = context?.findAncestorStateOfType<EditableTextState>();
+    if (editable == null || editable.widget.readOnly) return false;
+    final value = editable.textEditingValue;
+    final selection = value.selection.isValid
+        ? value.selection
+        : TextSelection.collapsed(offset: value.text.length);
+    final text = value.text.replaceRange(
+      selection.start,
+      selection.end,
+      barcode,
+    );
+    editable.userUpdateTextEditingValue(
+      TextEditingValue(
+        text: text,
+        selection: TextSelection.collapsed(
+          offset: selection.start + barcode.length,
+        ),
+      ),
+      SelectionChangedCause.keyboard,
+    );
+    return true;
+  }
+}
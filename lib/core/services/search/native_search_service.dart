@@ -0,0 +1,174 @@
+import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart';
+import 'package:cash_register/features/nomenclatura/data/datasources/nomenclatura_local_data_source.dart';
+import 'package:cash_register/features/nomenclatura/domain/entities/nomenclatura.dart';
+
+/// Інкрементальний пошук по локальному каталогу через нативну сесію
+/// (канал `com.virok/search`, див. native/search).
+///
+/// Кожне натискання клавіші звужує попередній набір кандидатів у C++,
+/// Backspace бере вже пораховану множину з кешу сесії, тому дебаунс не
+/// потрібен. Якщо раннер не має каналу (Android/iOS/Web), [openSession]
+/// повертає null і віджети використовують звичайний [SearchNomenclatura].
+///
+/// Кілька кас на одній машині ділять індекс через спільну пам'ять
+/// (native/catalogue): публікує каса з найсвіжішою синхронізацією, решта
+/// лише відображають його.
+class NativeSearchService {
+  static const MethodChannel _channel = MethodChannel('com.virok/search');
+
+  /// Скільки останніх вимірів тримати для перцентилів
+  static const int _latencyWindow = 500;
+
+  final NomenclaturaLocalDataSource _localDataSource;
+
+  bool? _available;
+  DateTime? _indexedSync;
+  Future<bool>? _loading;
+  final List<int> _latenciesUs = [];
+  int _samplesSinceReport = 0;
+
+  NativeSearchService(this._localDataSource);
+
+  /// Завантажує ключі пошуку в нативний індекс, якщо каталог змінився
+  /// з моменту останнього завантаження (за часом останньої синхронізації).
+  Future<bool> ensureIndex() {
+    return _loading ??= _loadIndex().whenComplete(() => _loading = null);
+  }
+
+  Future<bool> _loadIndex() async {
+    if (_available == false) return false;
+
+    try {
+      final lastSync = await _localDataSource.getLastSync();
+      if (_available == true && lastSync == _indexedSync) return true;
+
+      // Версія каталогу для інших кас на цій машині — час синхронізації.
+      // Якщо інша каса вже опублікувала не старіший каталог, ключі з
+      // SQLite навіть не читаємо.
+      final version = lastSync?.millisecondsSinceEpoch ?? 0;
+      if (version > 0) {
+        final shared = await _channel.invokeMethod<int>('attachShared', {
+          'version': version,
+        });
+        if (shared != null && shared >= 0) {
+          _available = true;
+          _indexedSync = lastSync;
+          debugPrint('🔎 [SEARCH] Спільний каталог: $shared товарів');
+          return true;
+        }
+      }
+
+      final keys = await _localDataSource.getSearchKeys();
+      final count = await _channel.invokeMethod<int>('loadIndex', {
+        'ids': keys.guids,
+        'keys': keys.keys,
+        // Категорії — для розкладання по шардах великих каталогів.
+        'groups': keys.groups,
+        'version': version,
+      });
+
+      _available = true;
+      _indexedSync = lastSync;
+      debugPrint('🔎 [SEARCH] Нативний індекс: $count товарів');
+      return true;
+    } on MissingPluginException {
+      _available = false;
+      return false;
+    } catch (e) {
+      debugPrint('❌ [SEARCH] Помилка завантаження індексу: $e');
+      return false;
+    }
+  }
+
+  /// Відкриває нову сесію (одна на поле пошуку) або null, якщо нативний
+  /// пошук недоступний на цій платформі.
+  Future<NativeSearchSession?> openSession() async {
+    if (!await ensureIndex()) return null;
+    final id = await _channel.invokeMethod<int>('openSession');
+    if (id == null) return null;
+    return NativeSearchSession._(this, id);
+  }
+
+  /// Перцентиль затримки "натискання -> результати" (мкс) по останніх
+  /// [_latencyWindow] запитах.
+  int latencyPercentileUs(double percentile) {
+    if (_latenciesUs.isEmpty) return 0;
+    final sorted = List<int>.of(_latenciesUs)..sort();
+    final rank = ((percentile / 100) * (sorted.length - 1)).round();
+    return sorted[rank];
+  }
+
+  void _recordLatency(int micros) {
+    _latenciesUs.add(micros);
+    if (_latenciesUs.length > _latencyWindow) _latenciesUs.removeAt(0);
+
+    if (++_samplesSinceReport >= 100) {
+      _samplesSinceReport = 0;
+      debugPrint(
+        '🔎 [SEARCH] keystroke->results: '
+        'p50=${latencyPercentileUs(50)}us p99=${latencyPercentileUs(99)}us',
+      );
+    }
+  }
+}
+
+/// Сесія пошуку одного поля вводу. Відповіді на застарілі запити
+/// (користувач уже надрукував наступний символ) відкидаються.
+class NativeSearchSession {
+  final NativeSearchService _service;
+  final int _id;
+  int _sequence = 0;
+  bool _closed = false;
+  String _lastQuery = '';
+
+  /// Чи є ще результати після останньої сторінки
+  bool hasMore = false;
+
+  NativeSearchSession._(this._service, this._id);
+
+  /// Оновлює запит і повертає першу сторінку, або null, якщо відповідь
+  /// застаріла.
+  Future<List<Nomenclatura>?> update(String query, {int limit = 100}) async {
+    // Новий запит з порожнього поля — гарна нагода підхопити свіжий
+    // каталог після синхронізації (під час набору індекс не змінюємо).
+    if (_lastQuery.isEmpty) await _service.ensureIndex();
+    _lastQuery = query;
+    return _fetch('query', {'query': query, 'limit': limit});
+  }
+
+  /// Наступна сторінка поточного запиту (прокрутка результатів).
+  Future<List<Nomenclatura>?> more({int limit = 100}) {
+    return _fetch('more', {'limit': limit});
+  }
+
+  Future<List<Nomenclatura>?> _fetch(
+    String method,
+    Map<String, dynamic> args,
+  ) async {
+    if (_closed) return null;
+    final sequence = ++_sequence;
+    final stopwatch = Stopwatch()..start();
+
+    final page = await NativeSearchService._channel
+        .invokeMapMethod<String, dynamic>(method, {'session': _id, ...args});
+    if (sequence != _sequence || page == null) return null;
+
+    final ids = (page['ids'] as List).cast<String>();
+    final models = await _service._localDataSource
+        .getCachedNomenclaturaByGuids(ids);
+    if (sequence != _sequence) return null;
+
+    hasMore = page['exhausted'] != true;
+    _service._recordLatency(stopwatch.elapsedMicroseconds);
+    return models.map((model) => model.toEntity()).toList();
+  }
+
+  Future<void> close() async {
+    if (_closed) return;
+    _closed = true;
+    await NativeSearchService._channel.invokeMethod('closeSession', {
+      'session': _id,
+    });
+  }
+}
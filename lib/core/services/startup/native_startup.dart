@@ -0,0 +1,135 @@
+import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart';
+
+/// Результат однієї задачі нативного прогріву (каталог, налаштування,
+/// фіскальний пристрій).
+class PrewarmHandle {
+  /// pending / running / ready / failed
+  final String state;
+  final Duration elapsed;
+  final Map<String, String> values;
+  final String? error;
+
+  const PrewarmHandle({
+    required this.state,
+    required this.elapsed,
+    required this.values,
+    this.error,
+  });
+
+  bool get isReady => state == 'ready';
+  bool get isDone => state == 'ready' || state == 'failed';
+
+  factory PrewarmHandle.fromMap(Map<dynamic, dynamic> map) {
+    final values = map['values'] as Map<dynamic, dynamic>? ?? const {};
+    return PrewarmHandle(
+      state: map['state'] as String? ?? 'pending',
+      elapsed: Duration(microseconds: map['elapsedUs'] as int? ?? 0),
+      values: values.map((k, v) => MapEntry(k as String, v as String)),
+      error: map['error'] as String?,
+    );
+  }
+}
+
+/// Хронологія запуску і результати прогріву, який раннер починає ще до
+/// створення двигуна Flutter (канал `com.virok/startup`, див. native/startup).
+///
+/// Поки двигун стартує, раннер паралельно читає nomenclatura.db у кеш ОС,
+/// розбирає налаштування Cashalot і (Windows) завантажує COM-сервер; Dart
+/// забирає готові результати через [prewarmed]. Позначки [mark] разом з
+/// позначками раннера дають час до готовності каси. На платформах без
+/// каналу всі виклики нічого не роблять, а [prewarmed] повертає null.
+class NativeStartup {
+  static const MethodChannel _channel = MethodChannel('com.virok/startup');
+
+  /// Скільки чекати незавершений прогрів, перш ніж робити все по-старому.
+  static const Duration _prewarmTimeout = Duration(seconds: 2);
+
+  static bool _available = true;
+  static Future<Map<String, PrewarmHandle>>? _prewarm;
+  static bool _interactive = false;
+
+  NativeStartup._();
+
+  /// Позначка етапу запуску (повторна з тим самим ім'ям ігнорується).
+  static Future<void> mark(String name) async {
+    if (!_available) return;
+    try {
+      await _channel.invokeMethod<int>('mark', {'name': name});
+    } on MissingPluginException {
+      _available = false;
+    }
+  }
+
+  /// Каса готова приймати введення: ставить позначку `interactive` і
+  /// виводить усю хронологію запуску.
+  static Future<void> markInteractive() async {
+    if (_interactive || !_available) return;
+    _interactive = true;
+    await mark('interactive');
+
+    final marks = await timeline();
+    if (marks.isEmpty) return;
+    final lines = StringBuffer('⏱️ [STARTUP] Хронологія запуску:');
+    var previous = 0;
+    for (final m in marks) {
+      lines.write(
+        '\n  +${(m.us / 1000).toStringAsFixed(1)} ms  ${m.name}'
+        ' (+${((m.us - previous) / 1000).toStringAsFixed(1)} ms)',
+      );
+      previous = m.us;
+    }
+    debugPrint(lines.toString());
+  }
+
+  /// Усі позначки з часом від старту процесу (мкс).
+  static Future<List<({String name, int us})>> timeline() async {
+    if (!_available) return const [];
+    try {
+      final list = await _channel.invokeListMethod<dynamic>('timeline');
+      return [
+        for (final m in list ?? const [])
+          (name: m['name'] as String, us: m['us'] as int),
+      ];
+    } on MissingPluginException {
+      _available = false;
+      return const [];
+    }
+  }
+
+  /// Результат задачі прогріву [name] або null, якщо прогріву немає
+  /// (інша платформа) чи задача не завершилася за [_prewarmTimeout].
+  static Future<PrewarmHandle?> prewarmed(String name) async {
+    final handle = (await (_prewarm ??= _waitPrewarm()))[name];
+    return handle != null && handle.isDone ? handle : null;
+  }
+
+  static Future<Map<String, PrewarmHandle>> _waitPrewarm() async {
+    final deadline = DateTime.now().add(_prewarmTimeout);
+    while (_available) {
+      try {
+        final map = await _channel.invokeMapMethod<String, dynamic>('prewarm');
+        final handles = {
+          for (final e in (map ?? const {}).entries)
+            e.key: PrewarmHandle.fromMap(e.value as Map<dynamic, dynamic>),
+        };
+        final done = handles.values.every((h) => h.isDone);
+        if (done || DateTime.now().isAfter(deadline)) {
+          for (final e in handles.entries) {
+            debugPrint(
+              '⏱️ [STARTUP] prewarm ${e.key}: ${e.value.state} '
+              '${e.value.elapsed.inMilliseconds} ms'
+              '${e.value.error != null ? ' (${e.value.error})' : ''}',
+            );
+          }
+          return handles;
+        }
+      } on MissingPluginException {
+        _available = false;
+        break;
+      }
+      await Future<void>.delayed(const Duration(milliseconds: 20));
+    }
+    return const {};
+  }
+}
@@ -0,0 +1,287 @@
+import 'dart:convert';
+import 'dart:ffi';
+import 'dart:isolate';
+
+import 'package:cash_register/features/nomenclatura/data/models/nomenclatura_model.dart';
+import 'package:ffi/ffi.dart';
+import 'package:flutter/foundation.dart';
+
+import 'native_catalogue_store.dart';
+
+final class _VirokCatalogue extends Opaque {}
+
+typedef _LoadNative =
+    Pointer<_VirokCatalogue> Function(
+      Pointer<Void> store,
+      Pointer<Pointer<Utf8>> error,
+    );
+typedef _LoadDart =
+    Pointer<_VirokCatalogue> Function(
+      Pointer<Void> store,
+      Pointer<Pointer<Utf8>> error,
+    );
+typedef _CountNative = Int64 Function(Pointer<_VirokCatalogue>);
+typedef _CountDart = int Function(Pointer<_VirokCatalogue>);
+typedef _TextNative =
+    Int32 Function(
+      Pointer<_VirokCatalogue>,
+      Int64 row,
+      Int32 field,
+      Pointer<Uint8> out,
+      Int32 capacity,
+    );
+typedef _TextDart =
+    int Function(
+      Pointer<_VirokCatalogue>,
+      int row,
+      int field,
+      Pointer<Uint8> out,
+      int capacity,
+    );
+typedef _PriceNative = Double Function(Pointer<_VirokCatalogue>, Int64 row);
+typedef _PriceDart = double Function(Pointer<_VirokCatalogue>, int row);
+typedef _FlagNative = Int32 Function(Pointer<_VirokCatalogue>, Int64 row);
+typedef _FlagDart = int Function(Pointer<_VirokCatalogue>, int row);
+typedef _CreatedNative =
+    Int64 Function(Pointer<_VirokCatalogue>, Int64 row, Pointer<Int32> utc);
+typedef _CreatedDart =
+    int Function(Pointer<_VirokCatalogue>, int row, Pointer<Int32> utc);
+typedef _FindNative =
+    Int64 Function(Pointer<_VirokCatalogue>, Pointer<Utf8> guid);
+typedef _FindDart = int Function(Pointer<_VirokCatalogue>, Pointer<Utf8> guid);
+typedef _FreeNative = Void Function(Pointer<Void>);
+typedef _FreeDart = void Function(Pointer<Void>);
+
+// Поля virok_catalogue_text (VirokCatalogueField у catalogue_ffi.h).
+const _guid = 0;
+const _name = 1;
+const _article = 2;
+const _unitName = 3;
+const _unitGuid = 4;
+const _parentGuid = 5;
+const _description = 6;
+const _barcodes = 7;
+const _searchName = 8;
+
+/// Функції virok_catalogue_* одного ізолята. Читання полів — короткі
+/// виклики без колбеків, тож вони leaf (без переходу стану ізолята).
+class _Api {
+  final _CountDart size;
+  final _CountDart bytes;
+  final _TextDart text;
+  final _PriceDart price;
+  final _FlagDart isFolder;
+  final _CreatedDart createdAt;
+  final _FindDart find;
+  final NativeFinalizer finalizer;
+
+  /// Буфер для тексту полів; росте під найдовше поле.
+  Pointer<Uint8> buffer = malloc<Uint8>(256);
+  int capacity = 256;
+  final Pointer<Int32> utc = malloc<Int32>();
+
+  _Api(DynamicLibrary library)
+    : size = library.lookupFunction<_CountNative, _CountDart>(
+        'virok_catalogue_size',
+        isLeaf: true,
+      ),
+      bytes = library.lookupFunction<_CountNative, _CountDart>(
+        'virok_catalogue_bytes',
+        isLeaf: true,
+      ),
+      text = library.lookupFunction<_TextNative, _TextDart>(
+        'virok_catalogue_text',
+        isLeaf: true,
+      ),
+      price = library.lookupFunction<_PriceNative, _PriceDart>(
+        'virok_catalogue_price',
+        isLeaf: true,
+      ),
+      isFolder = library.lookupFunction<_FlagNative, _FlagDart>(
+        'virok_catalogue_is_folder',
+        isLeaf: true,
+      ),
+      createdAt = library.lookupFunction<_CreatedNative, _CreatedDart>(
+        'virok_catalogue_created_at',
+        isLeaf: true,
+      ),
+      find = library.lookupFunction<_FindNative, _FindDart>(
+        'virok_catalogue_find',
+        isLeaf: true,
+      ),
+      finalizer = NativeFinalizer(
+        library.lookup<NativeFunction<_FreeNative>>('virok_catalogue_free'),
+      );
+
+  static _Api? _instance;
+
+  static _Api? get instance {
+    if (_instance != null) return _instance;
+    final library = NativeCatalogueStore.library;
+    if (library == null) return null;
+    return _instance = _Api(library);
+  }
+}
+
+/// Каталог у нативній пам'яті для кас з малим обсягом RAM (див.
+/// native/catalogue/compact_catalogue.h).
+///
+/// Замість `List<NomenclaturaModel>` — близько десяти об'єктів і 600+
+/// байтів купи Dart на товар, які збирач сміття старого покоління
+/// перебирає при кожному повному проході, — Dart тримає один вказівник.
+/// GUID лежать 16 байтами, одиниці й батьківські групи — словниками,
+/// назви — з префіксним кодуванням, штрихкоди — упакованими числами:
+/// близько 80 байтів на товар (compact_catalogue_bench).
+///
+/// Товари віддаються ручками [CompactItem], що декодують поля при
+/// зверненні. Каталог незмінний: після синхронізації завантажується
+/// новий, а пам'ять старого звільняється, коли зникне остання ручка.
+class CompactCatalogue implements Finalizable {
+  final Pointer<_VirokCatalogue> _handle;
+  final _Api _api;
+
+  /// Кількість товарів (разом із папками), у порядку ORDER BY name.
+  final int length;
+
+  CompactCatalogue._(this._handle, this._api) : length = _api.size(_handle) {
+    _api.finalizer.attach(this, _handle.cast(), externalSize: bytes);
+  }
+
+  /// Будує каталог з nomenclatura.db сховища [store] у фоновому ізоляті
+  /// (сотні мілісекунд на 100 тис. товарів; пошук і синхронізація в цей
+  /// час не блокуються). null — нативної бібліотеки немає або читання
+  /// не вдалося.
+  static Future<CompactCatalogue?> load(NativeCatalogueStore store) async {
+    final api = _Api.instance;
+    if (api == null) return null;
+    final storeAddress = store.address;
+    final (address, error) = await Isolate.run(() => _loadIn(storeAddress));
+    if (address == 0) {
+      debugPrint('❌ [CATALOGUE] Компактний каталог не побудовано: $error');
+      return null;
+    }
+    final catalogue = CompactCatalogue._(Pointer.fromAddress(address), api);
+    debugPrint(
+      '🗜️ [CATALOGUE] ${catalogue.length} товарів, '
+      '${(catalogue.bytes / 1e6).toStringAsFixed(1)} МБ '
+      '(${catalogue.bytesPerItem.toStringAsFixed(0)} Б/товар)',
+    );
+    return catalogue;
+  }
+
+  static (int, String?) _loadIn(int storeAddress) {
+    final library = NativeCatalogueStore.library!;
+    final load = library.lookupFunction<_LoadNative, _LoadDart>(
+      'virok_catalogue_load',
+    );
+    final free = library.lookupFunction<_FreeNative, _FreeDart>(
+      'virok_ffi_free',
+    );
+    final error = calloc<Pointer<Utf8>>();
+    try {
+      final handle = load(Pointer.fromAddress(storeAddress), error);
+      if (handle != nullptr) return (handle.address, null);
+      final message = error.value == nullptr ? '' : error.value.toDartString();
+      if (error.value != nullptr) free(error.value.cast());
+      return (0, message);
+    } finally {
+      calloc.free(error);
+    }
+  }
+
+  /// Пам'ять каталогу в нативній купі, байтів.
+  int get bytes => _api.bytes(_handle);
+
+  double get bytesPerItem => length == 0 ? 0 : bytes / length;
+
+  CompactItem operator [](int index) {
+    RangeError.checkValidIndex(index, this, 'index', length);
+    return CompactItem._(this, index);
+  }
+
+  /// Ручки всіх товарів; створюються під час перебору.
+  Iterable<CompactItem> get items =>
+      Iterable.generate(length, (i) => CompactItem._(this, i));
+
+  /// Товар за GUID (двійковий пошук у нативній пам'яті) або null.
+  CompactItem? byGuid(String guid) {
+    final nativeGuid = guid.toNativeUtf8();
+    try {
+      final row = _api.find(_handle, nativeGuid);
+      return row < 0 ? null : CompactItem._(this, row);
+    } finally {
+      malloc.free(nativeGuid);
+    }
+  }
+
+  String? _text(int row, int field) {
+    final api = _api;
+    var size = api.text(_handle, row, field, api.buffer, api.capacity);
+    if (size < 0) return null;
+    if (size > api.capacity) {
+      malloc.free(api.buffer);
+      api.capacity = size;
+      api.buffer = malloc<Uint8>(size);
+      size = api.text(_handle, row, field, api.buffer, api.capacity);
+    }
+    return utf8.decode(api.buffer.asTypedList(size));
+  }
+}
+
+/// Ручка товару [CompactCatalogue]: лише каталог і номер рядка. Кожне
+/// звернення до поля декодує його з нативної пам'яті, тож ручки не варто
+/// тримати замість моделей там, де поля читаються в циклі, — для цього
+/// є [toModel].
+class CompactItem {
+  final CompactCatalogue catalogue;
+  final int index;
+
+  const CompactItem._(this.catalogue, this.index);
+
+  String get guid => catalogue._text(index, _guid)!;
+  String get name => catalogue._text(index, _name)!;
+  String get article => catalogue._text(index, _article)!;
+  String get unitName => catalogue._text(index, _unitName)!;
+  String get unitGuid => catalogue._text(index, _unitGuid)!;
+  String? get parentGuid => catalogue._text(index, _parentGuid);
+  String? get description => catalogue._text(index, _description);
+  String get barcodes => catalogue._text(index, _barcodes)!;
+  String get searchName => catalogue._text(index, _searchName)!;
+
+  double get price => catalogue._api.price(catalogue._handle, index);
+
+  bool get isFolder => catalogue._api.isFolder(catalogue._handle, index) == 1;
+
+  /// Як `DateTime.parse(created_at)`: без зсуву в рядку — місцевий час.
+  DateTime get createdAt {
+    final api = catalogue._api;
+    final us = api.createdAt(catalogue._handle, index, api.utc);
+    final time = DateTime.fromMicrosecondsSinceEpoch(us, isUtc: true);
+    if (api.utc.value == 1) return time;
+    return DateTime(
+      time.year,
+      time.month,
+      time.day,
+      time.hour,
+      time.minute,
+      time.second,
+      time.millisecond,
+      time.microsecond,
+    );
+  }
+
+  NomenclaturaModel toModel() => NomenclaturaModel(
+    guid: guid,
+    createdAt: createdAt,
+    name: name,
+    article: article,
+    unitName: unitName,
+    unitGuid: unitGuid,
+    isFolder: isFolder,
+    parentGuid: parentGuid,
+    description: description,
+    barcodes: barcodes,
+    prices: price,
+    searchName: searchName,
+  );
+}
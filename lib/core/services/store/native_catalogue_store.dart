@@ -0,0 +1,304 @@
+import 'dart:async';
+import 'dart:convert';
+import 'dart:ffi';
+import 'dart:io';
+import 'dart:isolate';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+import 'package:flutter/foundation.dart';
+
+typedef _ReplyNative = Void Function(Int64 request, Int32 ok, Pointer<Utf8>);
+
+final class _VirokStore extends Opaque {}
+
+typedef _OpenNative =
+    Pointer<_VirokStore> Function(
+      Pointer<Utf8> path,
+      Int32 readers,
+      Pointer<NativeFunction<_ReplyNative>> callback,
+      Pointer<Pointer<Utf8>> error,
+    );
+typedef _OpenDart =
+    Pointer<_VirokStore> Function(
+      Pointer<Utf8> path,
+      int readers,
+      Pointer<NativeFunction<_ReplyNative>> callback,
+      Pointer<Pointer<Utf8>> error,
+    );
+typedef _ReadNative =
+    Void Function(
+      Pointer<_VirokStore>,
+      Int64 request,
+      Pointer<Utf8> sql,
+      Pointer<Utf8> params,
+    );
+typedef _ReadDart =
+    void Function(
+      Pointer<_VirokStore>,
+      int request,
+      Pointer<Utf8> sql,
+      Pointer<Utf8> params,
+    );
+typedef _WriteNative =
+    Void Function(Pointer<_VirokStore>, Int64 request, Pointer<Utf8> batches);
+typedef _WriteDart =
+    void Function(Pointer<_VirokStore>, int request, Pointer<Utf8> batches);
+typedef _ImportNative =
+    Void Function(
+      Pointer<_VirokStore>,
+      Int64 request,
+      Pointer<Uint8> data,
+      Int64 size,
+      Int32 replace,
+    );
+typedef _ImportDart =
+    void Function(
+      Pointer<_VirokStore>,
+      int request,
+      Pointer<Uint8> data,
+      int size,
+      int replace,
+    );
+typedef _MaintainNative =
+    Void Function(Pointer<_VirokStore>, Int64 request, Int32 vacuumPages);
+typedef _MaintainDart =
+    void Function(Pointer<_VirokStore>, int request, int vacuumPages);
+typedef _CloseNative = Void Function(Pointer<_VirokStore>);
+typedef _CloseDart = void Function(Pointer<_VirokStore>);
+typedef _FreeNative = Void Function(Pointer<Void>);
+typedef _FreeDart = void Function(Pointer<Void>);
+
+/// Оператор запису з наборами параметрів (порожній [rows] — виконати раз).
+typedef StoreBatch = ({String sql, List<List<Object?>> rows});
+
+/// Сховище nomenclatura.db у нативній бібліотеці virok_ffi (див.
+/// native/store, native/ffi/store_ffi.h).
+///
+/// База в режимі WAL: записи синхронізації виконує окремий потік-писач
+/// однією транзакцією, а пошук іде через пул з'єднань лише для читання й
+/// не чекає, поки синхронізація завершиться. Виклики не блокують UI:
+/// відповідь приходить через [NativeCallable.listener].
+///
+/// Доступне на Windows і Linux, якщо раннер зібрано з SQLite; інакше
+/// [open] повертає null і викликач лишається на sqflite. Одну базу не
+/// можна відкривати одночасно тут і через sqflite (дві копії SQLite в
+/// одному процесі не бачать блокувань одна одної).
+class NativeCatalogueStore {
+  final Pointer<_VirokStore> _handle;
+  final NativeCallable<_ReplyNative> _callback;
+  final _ReadDart _read;
+  final _WriteDart _write;
+  final _ImportDart _import;
+  final _MaintainDart _maintain;
+  final _CloseDart _close;
+  final Map<int, Completer<Map<String, dynamic>>> _pending;
+  int _nextRequest = 1;
+
+  NativeCatalogueStore._(
+    this._handle,
+    this._callback,
+    this._pending,
+    DynamicLibrary library,
+  ) : _read = library.lookupFunction<_ReadNative, _ReadDart>(
+        'virok_store_read',
+      ),
+      _write = library.lookupFunction<_WriteNative, _WriteDart>(
+        'virok_store_write',
+      ),
+      _import = library.lookupFunction<_ImportNative, _ImportDart>(
+        'virok_store_import',
+      ),
+      _maintain = library.lookupFunction<_MaintainNative, _MaintainDart>(
+        'virok_store_maintain',
+      ),
+      _close = library.lookupFunction<_CloseNative, _CloseDart>(
+        'virok_store_close',
+      );
+
+  static DynamicLibrary? _library;
+
+  /// Бібліотека virok_ffi для інших частин C API (див.
+  /// compact_catalogue.dart) або null, якщо її немає.
+  static DynamicLibrary? get library => _load();
+
+  /// Адреса нативного сховища для інших частин C API; дійсна до [close].
+  /// Числом, щоб її можна було передати в інший ізолят.
+  int get address => _handle.address;
+
+  static DynamicLibrary? _load() {
+    if (_library != null) return _library;
+    try {
+      if (Platform.isWindows) {
+        _library = DynamicLibrary.open('virok_ffi.dll');
+      } else if (Platform.isLinux) {
+        final dir = File(Platform.resolvedExecutable).parent.path;
+        _library = DynamicLibrary.open('$dir/lib/libvirok_ffi.so');
+      }
+    } on ArgumentError catch (e) {
+      debugPrint('ℹ️ [STORE] virok_ffi недоступна: $e');
+    }
+    return _library;
+  }
+
+  /// Відкриває базу з [readers] з'єднаннями для читання або повертає
+  /// null, якщо нативної бібліотеки немає чи базу не вдалося відкрити.
+  static NativeCatalogueStore? open(String path, {int readers = 3}) {
+    final library = _load();
+    if (library == null) return null;
+
+    final openStore = library.lookupFunction<_OpenNative, _OpenDart>(
+      'virok_store_open',
+    );
+    final free = library.lookupFunction<_FreeNative, _FreeDart>(
+      'virok_ffi_free',
+    );
+    final pending = <int, Completer<Map<String, dynamic>>>{};
+    final callback = NativeCallable<_ReplyNative>.listener((
+      int request,
+      int ok,
+      Pointer<Utf8> json,
+    ) {
+      final text = json == nullptr ? '' : json.toDartString();
+      free(json.cast());
+      final completer = pending.remove(request);
+      if (completer == null) return;
+      if (ok == 1) {
+        completer.complete(jsonDecode(text) as Map<String, dynamic>);
+      } else {
+        completer.completeError(StoreException(text));
+      }
+    });
+
+    final nativePath = path.toNativeUtf8();
+    final error = calloc<Pointer<Utf8>>();
+    try {
+      final handle = openStore(
+        nativePath,
+        readers,
+        callback.nativeFunction,
+        error,
+      );
+      if (handle == nullptr) {
+        final message = error.value == nullptr
+            ? ''
+            : error.value.toDartString();
+        if (error.value != nullptr) free(error.value.cast());
+        debugPrint('❌ [STORE] Не вдалося відкрити $path: $message');
+        callback.close();
+        return null;
+      }
+      debugPrint('🗃️ [STORE] Відкрито $path (WAL, читачів: $readers)');
+      return NativeCatalogueStore._(handle, callback, pending, library);
+    } finally {
+      malloc.free(nativePath);
+      calloc.free(error);
+    }
+  }
+
+  /// SELECT; рядки в тому ж вигляді, що `Database.rawQuery` у sqflite.
+  Future<List<Map<String, Object?>>> rawQuery(
+    String sql, [
+    List<Object?> args = const [],
+  ]) async {
+    final request = _nextRequest++;
+    final completer = Completer<Map<String, dynamic>>();
+    _pending[request] = completer;
+
+    final nativeSql = sql.toNativeUtf8();
+    final nativeArgs = jsonEncode(args).toNativeUtf8();
+    try {
+      _read(_handle, request, nativeSql, nativeArgs);
+    } finally {
+      malloc.free(nativeSql);
+      malloc.free(nativeArgs);
+    }
+
+    final result = await completer.future;
+    final columns = (result['columns'] as List).cast<String>();
+    return [
+      for (final row in result['rows'] as List)
+        {
+          for (var i = 0; i < columns.length; i++)
+            columns[i]: (row as List)[i] as Object?,
+        },
+    ];
+  }
+
+  /// Пакет операторів в одній транзакції потоком-писачем; повертає
+  /// кількість змінених рядків. Великі пакети кодуються поза UI-ізолятом.
+  Future<int> write(List<StoreBatch> batches) async {
+    final payload = [
+      for (final batch in batches) {'sql': batch.sql, 'rows': batch.rows},
+    ];
+    final rows = batches.fold<int>(0, (n, b) => n + b.rows.length);
+    final json = rows > 1000
+        ? await Isolate.run(() => jsonEncode(payload))
+        : jsonEncode(payload);
+
+    final request = _nextRequest++;
+    final completer = Completer<Map<String, dynamic>>();
+    _pending[request] = completer;
+    final nativeJson = json.toNativeUtf8();
+    try {
+      _write(_handle, request, nativeJson);
+    } finally {
+      malloc.free(nativeJson);
+    }
+    final result = await completer.future;
+    return (result['changes'] as num).toInt();
+  }
+
+  /// Файл каталогу .vkc (native/catalogue/catalogue_codec.h) прямо в
+  /// таблицю nomenclatura однією транзакцією, без моделей і JSON у Dart;
+  /// [replace] — спершу очистити таблицю. Повертає кількість змінених
+  /// рядків; пошкоджений файл — [StoreException].
+  Future<int> importPacked(Uint8List bytes, {bool replace = false}) async {
+    final request = _nextRequest++;
+    final completer = Completer<Map<String, dynamic>>();
+    _pending[request] = completer;
+    final data = malloc<Uint8>(bytes.isEmpty ? 1 : bytes.length);
+    try {
+      data.asTypedList(bytes.length).setAll(0, bytes);
+      _import(_handle, request, data, bytes.length, replace ? 1 : 0);
+    } finally {
+      malloc.free(data);
+    }
+    final result = await completer.future;
+    return (result['changes'] as num).toInt();
+  }
+
+  /// Обслуговування бази у простої каси: checkpoint журналу WAL, до
+  /// [vacuumPages] вільних сторінок назад ОС і PRAGMA optimize. Повертає
+  /// wal_frames, checkpointed_frames і freelist_pages.
+  Future<Map<String, int>> maintain({int vacuumPages = 256}) async {
+    final request = _nextRequest++;
+    final completer = Completer<Map<String, dynamic>>();
+    _pending[request] = completer;
+    _maintain(_handle, request, vacuumPages);
+    final result = await completer.future;
+    final columns = (result['columns'] as List).cast<String>();
+    final row = (result['rows'] as List).first as List;
+    return {
+      for (var i = 0; i < columns.length; i++)
+        columns[i]: (row[i] as num).toInt(),
+    };
+  }
+
+  /// Дочікується поставлених запитів і закриває базу.
+  void close() {
+    _close(_handle);
+    // Відповіді, вже поставлені в чергу ізолята, ще прийдуть через
+    // listener, тож колбек закриваємо після них.
+    Future.delayed(Duration.zero, _callback.close);
+  }
+}
+
+class StoreException implements Exception {
+  final String message;
+
+  const StoreException(this.message);
+
+  @override
+  String toString() => 'StoreException: $message';
+}
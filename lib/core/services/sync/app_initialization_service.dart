@@ -1,3 +1,4 @@
+import 'dart:async';
 import 'package:cash_register/core/widgets/notificarion_toast/view.dart';
 import 'package:flutter/material.dart';
 import 'package:get_it/get_it.dart';
@@ -23,6 +24,19 @@ import 'package:cash_register/core/di/prro_injection.dart';
 import 'package:cash_register/core/config/cashalot_config.dart';
 import 'package:cash_register/features/home/presentation/bloc/home_bloc.dart';
 import 'package:cash_register/core/services/cashalot/com/cashalot_com_service.dart';
+import 'package:cash_register/core/services/search/native_search_service.dart';
+import 'package:cash_register/core/services/promo/native_promo_service.dart';
+import 'package:cash_register/core/services/archive/native_receipt_archive.dart';
+import 'package:cash_register/core/services/parking/native_parked_carts.dart';
+import 'package:cash_register/core/services/maintenance/native_maintenance_service.dart';
+import 'package:cash_register/core/services/payments/native_terminal_service.dart';
+import 'package:cash_register/core/services/printing/native_label_printer.dart';
+import 'package:cash_register/core/services/scale/native_scale_service.dart';
+import 'package:cash_register/core/services/scanner/native_scanner_service.dart';
+import 'package:cash_register/core/services/metrics/native_metrics.dart';
+import 'package:cash_register/core/services/startup/native_startup.dart';
+import 'package:cash_register/core/services/trace/native_trace.dart';
+import 'package:path_provider/path_provider.dart';
 import 'dart:io';
 
 class AppInitializationService {
@@ -38,6 +52,9 @@ class AppInitializationService {
       _sl.registerLazySingleton<NomenclaturaRemoteDataSource>(
         () => NomenclaturaRemoteDataSourceImpl(
           supabaseClient: Supabase.instance.client,
+          // Стовпцевий пакет каталогу (.vkc) замість JSON, якщо задано
+          packedCatalogueUrl: () =>
+              _sl<StorageService>().getString('catalogue_pack_url'),
         ),
       );
 
@@ -75,6 +92,38 @@ class AppInitializationService {
         () => GetSubcategories(_sl<NomenclaturaRepository>()),
       );
 
+      // Інкрементальний пошук по мірі введення (нативна сесія в раннері)
+      _sl.registerLazySingleton(
+        () => NativeSearchService(_sl<NomenclaturaLocalDataSource>()),
+      );
+
+      // Акції та знижки з перерахунком на кожне сканування (native/promo).
+      // Лише з `promo_enabled`: поле знижки рядка в чеках Cashalot ще не
+      // звірене зі схемою, тож за замовчуванням чек іде без знижок.
+      if (await _sl<StorageService>().getBool('promo_enabled') == true) {
+        _sl.registerLazySingleton(
+          () => NativePromoService(Supabase.instance.client),
+        );
+      }
+
+      // Локальний архів чеків для повернень і повторного друку
+      _sl.registerLazySingleton(() => NativeReceiptArchive());
+
+      // Відкладені кошики, що переживають перезапуск каси
+      _sl.registerLazySingleton(() => NativeParkedCarts());
+
+      // Торгові ваги (маса вагових товарів)
+      _sl.registerLazySingleton(() => NativeScaleService());
+
+      // Банківський термінал: стани оплати подіями, сліп одразу
+      _sl.registerLazySingleton(() => NativeTerminalService());
+
+      // Сканер штрихкодів: код цілим, без посимвольного набору
+      _sl.registerLazySingleton(() => NativeScannerService());
+
+      // Обслуговування у простої каси (синхронізація, індекс, база, архів)
+      _sl.registerLazySingleton(() => NativeMaintenanceService());
+
       // Реєстрація sync service
       // Реєструємо RealtimeService (відключено тимчасово)
       // _sl.registerLazySingleton<RealtimeService>(
@@ -147,12 +196,247 @@ class AppInitializationService {
         defaultPrroFiscalNum: prroFiscalNum,
       );
 
+      // Траса — до решти старту, щоб її покрити (без trace_enabled це
+      // одне читання налаштувань).
+      await _startTraceIfEnabled();
+      _warmCatalogue();
+      unawaited(_startPeripherals());
+
       _isInitialized = true;
     } catch (e) {
       throw Exception('Failed to initialize dependencies: $e');
     }
   }
 
+  /// Сторож, метрики, архів, відкладені кошики, обладнання й
+  /// обслуговування першому екрану не потрібні: стартують паралельно у
+  /// фоні, не затримуючи перший кадр (інакше губиться виграш prewarm).
+  /// Архів і відкладені кошики до кінця відкриття чекають самі (`ready`).
+  static Future<void> _startPeripherals() async {
+    try {
+      await Future.wait([
+        _startWatchdog(),
+        _startMetrics(lane: CashalotConfig.defaultPrroFiscalNum),
+        _openReceiptArchive(),
+        _openParkedCarts(),
+        _startScale(),
+        _startTerminal(),
+        _configureScanner(),
+      ]);
+    } catch (e) {
+      debugPrint('⚠️ [INIT] Обладнання запущено не повністю: $e');
+    }
+    // Ущільнення архіву — лише після його відкриття.
+    try {
+      await _startMaintenance();
+    } catch (e) {
+      debugPrint('⚠️ [MAINTENANCE] Не вдалося запустити обслуговування: $e');
+    }
+  }
+
+  /// Вмикає запис траси операцій, якщо в налаштуваннях є `trace_enabled`.
+  /// Кожен запуск пише окремий файл у <app support>/traces.
+  static Future<void> _startTraceIfEnabled() async {
+    final enabled = await _sl<StorageService>().getBool('trace_enabled');
+    if (enabled != true) return;
+
+    try {
+      final supportDir = await getApplicationSupportDirectory();
+      final dir = Directory('${supportDir.path}/traces');
+      await dir.create(recursive: true);
+      final stamp = DateTime.now().millisecondsSinceEpoch;
+      await NativeTrace.start('${dir.path}/trace_$stamp.json');
+    } catch (e) {
+      debugPrint('⚠️ [TRACE] Не вдалося увімкнути трасування: $e');
+    }
+  }
+
+  /// Сторож зависань потоку платформи: журнал <app support>/watchdog/
+  /// stalls.log. Бюджет — `watchdog_budget_ms` (250 за замовчуванням);
+  /// `watchdog_enabled` = false вимикає.
+  static Future<void> _startWatchdog() async {
+    final storage = _sl<StorageService>();
+    if (await storage.getBool('watchdog_enabled') == false) return;
+
+    try {
+      final supportDir = await getApplicationSupportDirectory();
+      final dir = Directory('${supportDir.path}/watchdog');
+      await dir.create(recursive: true);
+      final budgetMs = await storage.getInt('watchdog_budget_ms') ?? 250;
+      await NativeTrace.startWatchdog(
+        '${dir.path}/stalls.log',
+        budget: Duration(milliseconds: budgetMs),
+      );
+    } catch (e) {
+      debugPrint('⚠️ [TRACE] Не вдалося запустити сторожа зависань: $e');
+    }
+  }
+
+  /// Знімки метрик каси (<app support>/metrics/virok.prom) для моніторингу.
+  static Future<void> _startMetrics({required String lane}) async {
+    try {
+      final supportDir = await getApplicationSupportDirectory();
+      final dir = Directory('${supportDir.path}/metrics');
+      await dir.create(recursive: true);
+      await NativeMetrics.start('${dir.path}/virok.prom', lane: lane);
+    } catch (e) {
+      debugPrint('⚠️ [METRICS] Не вдалося увімкнути метрики: $e');
+    }
+  }
+
+  /// Ваги, якщо в налаштуваннях є `scale_port` (COM3, /dev/ttyUSB0);
+  /// протокол — `scale_protocol` (cas за замовчуванням), швидкість —
+  /// `scale_baud`.
+  static Future<void> _startScale() async {
+    final storage = _sl<StorageService>();
+    final port = await storage.getString('scale_port');
+    if (port == null || port.isEmpty) return;
+    await _sl<NativeScaleService>().start(
+      port: port,
+      protocol: await storage.getString('scale_protocol') ?? 'cas',
+      baud: await storage.getInt('scale_baud') ?? 9600,
+    );
+  }
+
+  /// Банківський термінал, якщо в налаштуваннях є `terminal_host`
+  /// (порт — `terminal_port`, 2000 за замовчуванням). Сліп друкується на
+  /// принтер чеків (`printer_ip`, `printer_port`) у `terminal_slip_copies`
+  /// копіях.
+  static Future<void> _startTerminal() async {
+    final storage = _sl<StorageService>();
+    final host = await storage.getString('terminal_host');
+    if (host == null || host.isEmpty) return;
+    await _sl<NativeTerminalService>().start(
+      host: host,
+      port: await storage.getInt('terminal_port') ?? 2000,
+      printerHost: await storage.getString('printer_ip'),
+      printerPort: await storage.getInt('printer_port') ?? 9100,
+      slipCopies: await storage.getInt('terminal_slip_copies') ?? 2,
+    );
+  }
+
+  /// Сканер штрихкодів: `scanner_prefix` і `scanner_suffix` — якщо сканер
+  /// запрограмовано на інші префікс і завершувач, ніж без префікса й Enter.
+  static Future<void> _configureScanner() async {
+    final storage = _sl<StorageService>();
+    final prefix = await storage.getString('scanner_prefix');
+    final suffix = await storage.getString('scanner_suffix');
+    if (prefix == null && suffix == null) return;
+    await _sl<NativeScannerService>().configure(
+      prefix: prefix,
+      suffix: suffix,
+    );
+  }
+
+  /// Архів фіскалізованих чеків (<app support>/receipts).
+  static Future<void> _openReceiptArchive() async {
+    try {
+      final supportDir = await getApplicationSupportDirectory();
+      await _sl<NativeReceiptArchive>().open('${supportDir.path}/receipts');
+    } catch (e) {
+      debugPrint('⚠️ [ARCHIVE] Не вдалося відкрити архів чеків: $e');
+    }
+  }
+
+  /// Відкладені кошики (<app support>/parked).
+  static Future<void> _openParkedCarts() async {
+    try {
+      final supportDir = await getApplicationSupportDirectory();
+      await _sl<NativeParkedCarts>().open('${supportDir.path}/parked');
+    } catch (e) {
+      debugPrint('⚠️ [PARKED] Не вдалося відкрити відкладені чеки: $e');
+    }
+  }
+
+  /// Якщо раннер уже підтягнув nomenclatura.db у кеш ОС, одразу будуємо
+  /// нативний індекс пошуку — перший пошук на касі не чекає завантаження.
+  ///
+  /// `compact_catalogue` у налаштуваннях (каси з малим обсягом RAM) —
+  /// одразу будуємо й компактний каталог: товари за GUID віддаються з
+  /// нативної пам'яті без моделей у купі Dart.
+  static void _warmCatalogue() {
+    NativeStartup.prewarmed('catalogue').then((catalogue) async {
+      if (catalogue?.values['exists'] != 'true') return;
+      _sl<NativeSearchService>().ensureIndex();
+      if (await _sl<StorageService>().getBool('compact_catalogue') == true) {
+        await _sl<NomenclaturaLocalDataSource>().getCompactCatalogue();
+      }
+    });
+  }
+
+  /// Фонове обслуговування, коли каса простоює (`maintenance_idle_seconds`,
+  /// 30 с за замовчуванням): дельта-синхронізація номенклатури, оновлення
+  /// нативного індексу пошуку, checkpoint і повернення вільних сторінок
+  /// nomenclatura.db, ущільнення архіву чеків.
+  static Future<void> _startMaintenance() async {
+    final idleSeconds =
+        await _sl<StorageService>().getInt('maintenance_idle_seconds') ?? 30;
+    await _sl<NativeMaintenanceService>().start(
+      idleAfter: Duration(seconds: idleSeconds),
+      intervals: const {
+        'deltaSync': Duration(minutes: 15),
+        'searchIndex': Duration(minutes: 15),
+        'storeMaintain': Duration(hours: 1),
+        NativeMaintenanceService.archiveCompactJob: Duration(hours: 6),
+      },
+      tasks: {
+        'deltaSync': (cancel) async {
+          final labelHost = await _labelPrinterHost();
+          final before = labelHost == null
+              ? null
+              : await _sl<NomenclaturaLocalDataSource>().snapshotPrices();
+          final result = await _sl<NomenclaturaRepository>().syncWithServer();
+          if (result.isRight() && labelHost != null && before != null) {
+            await _printPriceLabels(labelHost, before);
+          }
+          return result.isRight();
+        },
+        // Перечитує ключі, лише якщо каталог змінився після синхронізації.
+        'searchIndex': (cancel) => _sl<NativeSearchService>().ensureIndex(),
+        'storeMaintain': (cancel) async {
+          final stats = await _sl<NomenclaturaLocalDataSource>()
+              .maintainStore();
+          if (stats != null) {
+            debugPrint('🧹 [MAINTENANCE] nomenclatura.db: $stats');
+          }
+          return true;
+        },
+      },
+    );
+  }
+
+  /// Принтер цінників, якщо `price_labels_enabled`: `label_printer_ip`
+  /// або чековий `printer_ip`.
+  static Future<String?> _labelPrinterHost() async {
+    final storage = _sl<StorageService>();
+    if (await storage.getBool('price_labels_enabled') != true) return null;
+    final host =
+        await storage.getString('label_printer_ip') ??
+        await storage.getString('printer_ip');
+    return host == null || host.isEmpty ? null : host;
+  }
+
+  /// Цінники товарів, чия ціна змінилась за синхронізацію; порт —
+  /// `label_printer_port` (9100), ширина стрічки — `label_width` (32
+  /// знаки для 58 мм, 48 для 80 мм).
+  static Future<void> _printPriceLabels(
+    String host,
+    PriceSnapshot before,
+  ) async {
+    // Перша синхронізація: змін немає, весь каталог не друкуємо.
+    if (before.length == 0) return;
+    final storage = _sl<StorageService>();
+    await _sl<NomenclaturaLocalDataSource>().printPriceLabels(
+      before,
+      host: host,
+      port:
+          await storage.getInt('label_printer_port') ??
+          await storage.getInt('printer_port') ??
+          9100,
+      width: await storage.getInt('label_width') ?? 32,
+    );
+  }
+
   /// Результат ініціалізації програми
   static Future<AppInitResult> checkDataAndInitialize() async {
     try {
@@ -247,28 +531,47 @@ class AppInitializationService {
 
     final storageService = _sl<StorageService>();
 
+    // Раннер уже прочитав налаштування під час старту двигуна (див.
+    // NativeStartup); без прогріву читаємо їх тут, як і раніше.
+    final prewarmed = await NativeStartup.prewarmed('config');
+    final config = prewarmed?.isReady == true ? prewarmed!.values : null;
+
     // Шлях до Cashalot з налаштувань або значення за замовчуванням
-    final cashalotPathFromSettings = await storageService
-        .getCashalotFolderPath();
+    final cashalotPathFromSettings = config != null
+        ? config['cashalot_folder_path']
+        : await storageService.getCashalotFolderPath();
     final cashalotPath = cashalotPathFromSettings ?? r'D:\Cashalot';
 
-    final keyPathFromFile = await storageService
-        .getCashalotKeyPath(); // Тут повний шлях до файлу
     final password = await storageService.getCashalotKeyPassword();
 
-    // !!! ВИПРАВЛЕННЯ !!!
-    // Якщо шлях вказує на файл, беремо його батьківську папку
-    String directoryPath = keyPathFromFile ?? '';
-
-    if (directoryPath.isNotEmpty) {
-      final file = File(directoryPath);
-      // Перевіряємо, чи це файл, чи вже папка
-      if (await file.exists()) {
-        // Це файл?
-        directoryPath = file.parent.path; // Беремо папку: D:\test_cashalot_keys
+    String directoryPath;
+    if (config != null) {
+      directoryPath = config['cashalot_key_dir'] ?? '';
+    } else {
+      final keyPathFromFile = await storageService
+          .getCashalotKeyPath(); // Тут повний шлях до файлу
+
+      // !!! ВИПРАВЛЕННЯ !!!
+      // Якщо шлях вказує на файл, беремо його батьківську папку
+      directoryPath = keyPathFromFile ?? '';
+
+      if (directoryPath.isNotEmpty) {
+        final file = File(directoryPath);
+        // Перевіряємо, чи це файл, чи вже папка
+        if (await file.exists()) {
+          // Це файл?
+          directoryPath = file.parent.path; // Беремо папку: D:\test_cashalot_keys
+        }
       }
     }
 
+    final fiscal = await NativeStartup.prewarmed('fiscal');
+    if (fiscal != null && !fiscal.isReady) {
+      debugPrint(
+        '⚠️ [CASHALOT_COM] COM-сервер не завантажився: ${fiscal.error}',
+      );
+    }
+
     debugPrint('🔑 Шлях до Cashalot: $cashalotPath');
     debugPrint('🔑 Шлях до ключів (DIR): $directoryPath');
 
@@ -2,6 +2,7 @@ import 'package:dartz/dartz.dart';
 import 'package:connectivity_plus/connectivity_plus.dart';
 import 'package:cash_register/features/nomenclatura/domain/repositories/nomenclatura_repository.dart';
 import 'package:cash_register/core/error/failures.dart';
+import 'package:cash_register/core/services/metrics/native_metrics.dart';
 // import 'realtime_service.dart';
 
 enum SyncStatus {
@@ -147,6 +148,20 @@ class DataSyncServiceImpl implements DataSyncService {
   @override
   Future<Either<Failure, void>> syncAllData({
     void Function(String message, double progress)? onProgress,
+  }) async {
+    final watch = Stopwatch()..start();
+    final result = await _syncAllData(onProgress: onProgress);
+    NativeMetrics.observe(
+      'virok_sync_duration_microseconds',
+      watch.elapsed,
+      help: 'Full catalogue sync duration',
+      labels: {'result': result.isRight() ? 'ok' : 'error'},
+    );
+    return result;
+  }
+
+  Future<Either<Failure, void>> _syncAllData({
+    void Function(String message, double progress)? onProgress,
   }) async {
     try {
       onProgress?.call('Початок синхронізації...', 0.0);
@@ -0,0 +1,166 @@
+import 'dart:async';
+import 'dart:typed_data';
+import 'package:flutter/foundation.dart';
+import 'package:flutter/services.dart';
+
+/// Трасування операцій (фіскалізація, оплата, друк) у файл Chrome trace
+/// через канал `com.virok/trace` (див. native/trace).
+///
+/// Нативні спани раннера (COM-виклики, пошук, розбір звітів) і спани з
+/// Dart ([span]) потрапляють в одну трасу, яку можна відкрити в
+/// chrome://tracing або ui.perfetto.dev. Спани Dart накопичуються і
+/// відправляються пачками, щоб не додавати виклик каналу на кожну операцію.
+/// Поки трасування не запущене, [span] лише викликає [body].
+class NativeTrace {
+  static const MethodChannel _channel = MethodChannel('com.virok/trace');
+
+  /// Як часто відправляти накопичені спани в раннер
+  static const Duration _sendInterval = Duration(milliseconds: 200);
+
+  /// Більше спанів між відправками не тримаємо (решта відкидається)
+  static const int _maxPending = 4096;
+
+  static bool _enabled = false;
+  static Timer? _timer;
+  static final Stopwatch _clock = Stopwatch()..start();
+
+  static final List<String> _categories = [];
+  static final List<String> _names = [];
+  static final List<int> _durationsUs = [];
+  static final List<int> _endsUs = [];
+
+  NativeTrace._();
+
+  static bool get enabled => _enabled;
+
+  /// Починає запис траси у файл [path] (перезаписується).
+  /// Повертає false, якщо раннер не має каналу або файл не відкрився.
+  static Future<bool> start(String path) async {
+    try {
+      final ok =
+          await _channel.invokeMethod<bool>('start', {'path': path}) ?? false;
+      _enabled = ok;
+      if (ok) {
+        _timer?.cancel();
+        _timer = Timer.periodic(_sendInterval, (_) => _send());
+        debugPrint('🧭 [TRACE] Запис траси: $path');
+      }
+      return ok;
+    } on MissingPluginException {
+      return false;
+    }
+  }
+
+  /// Дописує накопичені спани і закриває файл траси.
+  static Future<void> stop() async {
+    if (!_enabled) return;
+    _timer?.cancel();
+    _timer = null;
+    await _send();
+    _enabled = false;
+    try {
+      await _channel.invokeMethod('stop');
+    } on MissingPluginException {
+      // Раннер без каналу — нічого закривати.
+    }
+  }
+
+  /// Запускає сторожа зависань потоку платформи (див. native/watchdog):
+  /// якщо цикл подій раннера не відповідає довше за [budget], у [path]
+  /// пишеться, який виклик каналу чи нативна операція виконувались і
+  /// стек потоку. Журнал ротується (path.1 ... path.3). Повертає false,
+  /// якщо раннер без сторожа або пороги некоректні.
+  static Future<bool> startWatchdog(
+    String path, {
+    Duration budget = const Duration(milliseconds: 250),
+    Duration interval = const Duration(milliseconds: 100),
+  }) async {
+    try {
+      final ok =
+          await _channel.invokeMethod<bool>('watchdog', {
+            'path': path,
+            'budgetMs': budget.inMilliseconds,
+            'intervalMs': interval.inMilliseconds,
+          }) ??
+          false;
+      if (ok) {
+        debugPrint(
+          '🐕 [TRACE] Сторож зависань: ${budget.inMilliseconds} мс, $path',
+        );
+      }
+      return ok;
+    } on MissingPluginException {
+      return false;
+    }
+  }
+
+  static Future<void> stopWatchdog() async {
+    try {
+      await _channel.invokeMethod('watchdog', {'enabled': false});
+    } on MissingPluginException {
+      // Раннер без сторожа.
+    }
+  }
+
+  /// Лічильники сторожа і останнє зависання (`last`: spans, stack,
+  /// durationMs) або null, якщо раннер без сторожа.
+  static Future<Map<String, dynamic>?> watchdogStatus() async {
+    try {
+      return await _channel.invokeMapMethod<String, dynamic>(
+        'watchdogStatus',
+      );
+    } on MissingPluginException {
+      return null;
+    }
+  }
+
+  /// Виконує [body] і записує його тривалість як спан [category]/[name].
+  static Future<T> span<T>(
+    String category,
+    String name,
+    Future<T> Function() body,
+  ) async {
+    if (!_enabled) return body();
+    final startUs = _clock.elapsedMicroseconds;
+    try {
+      return await body();
+    } finally {
+      _record(category, name, startUs, _clock.elapsedMicroseconds);
+    }
+  }
+
+  static void _record(String category, String name, int startUs, int endUs) {
+    if (_names.length >= _maxPending) return;
+    _categories.add(category);
+    _names.add(name);
+    _durationsUs.add(endUs - startUs);
+    _endsUs.add(endUs);
+  }
+
+  static Future<void> _send() async {
+    if (_names.isEmpty) return;
+
+    // Годинники Dart і раннера різні, тому передаємо "вік" спану:
+    // скільки мікросекунд тому він завершився.
+    final nowUs = _clock.elapsedMicroseconds;
+    final args = {
+      'categories': List<String>.of(_categories),
+      'names': List<String>.of(_names),
+      'durationsUs': Int64List.fromList(_durationsUs),
+      'agesUs': Int64List.fromList([for (final end in _endsUs) nowUs - end]),
+    };
+    _categories.clear();
+    _names.clear();
+    _durationsUs.clear();
+    _endsUs.clear();
+
+    try {
+      await _channel.invokeMethod('spans', args);
+    } on MissingPluginException {
+      _enabled = false;
+      _timer?.cancel();
+    } on PlatformException catch (e) {
+      debugPrint('❌ [TRACE] Не вдалося передати спани: ${e.message}');
+    }
+  }
+}
@@ -1,4 +1,5 @@
 import 'package:supabase_flutter/supabase_flutter.dart';
+import 'package:cash_register/core/services/trace/native_trace.dart';
 
 class CheckRemoteDataSource {
   final SupabaseClient client;
@@ -12,24 +13,29 @@ class CheckRemoteDataSource {
     String? paymentForm,
     String? status, 
     String? rrn,
-      
+    String? documentNumber,
   }) async {
     final nowUtc = DateTime.now().toIso8601String();
-    final row = await client
-        .schema('virok_cashier')
-        .from('kkm_checks')
-        .insert({
-          'document_date': nowUtc,
-          'kkm_cash_register': seller,
-          'document_type': 'Чек ККМ',
-          if (status != null) 'status': status,
-          'kkm_check_number': _generateCheckNumber(),
-          if (amount != null) 'amount': amount,
-          if (paymentForm != null) 'payment_form': paymentForm,
-          "RRN": rrn,
-        })
-        .select()
-        .single();
+    final row = await NativeTrace.span(
+      'supabase',
+      'createCheck',
+      () => client
+          .schema('virok_cashier')
+          .from('kkm_checks')
+          .insert({
+            'document_date': nowUtc,
+            'kkm_cash_register': seller,
+            'document_type': 'Чек ККМ',
+            if (status != null) 'status': status,
+            'kkm_check_number': _generateCheckNumber(),
+            if (amount != null) 'amount': amount,
+            if (paymentForm != null) 'payment_form': paymentForm,
+            "RRN": rrn,
+            if (documentNumber != null) 'document_number': documentNumber,
+          })
+          .select()
+          .single(),
+    );
     return row['id'] as int;
   }
 
@@ -39,7 +45,11 @@ class CheckRemoteDataSource {
 
   Future<void> insertCheckItems(int checkId, List<Map<String, dynamic>> items) {
     final rows = items.map((it) => {...it, 'check_id': checkId}).toList();
-    return client.schema('virok_cashier').from('kkm_check_items').insert(rows);
+    return NativeTrace.span(
+      'supabase',
+      'insertCheckItems',
+      () => client.schema('virok_cashier').from('kkm_check_items').insert(rows),
+    );
   }
 
   /// Пошук чека за фіскальним номером (document_number)
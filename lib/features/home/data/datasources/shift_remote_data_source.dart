@@ -139,6 +139,26 @@ class ShiftRemoteDataSource {
     return {'cash': salesCash, 'cashless': salesCashless};
   }
 
+  /// Fiscalised and parked checks of the current user since [openedAt],
+  /// with the columns the native shift reconciliation reads.
+  Future<List<Map<String, dynamic>>> getShiftChecks(DateTime openedAt) async {
+    final login = await StorageService().getUserEmail();
+    if (login == null || login.isEmpty) {
+      throw Exception('Не знайдено логін');
+    }
+
+    final rows = await client
+        .schema('virok_cashier')
+        .from('kkm_checks')
+        .select(
+          'document_number, kkm_check_number, amount, payment_form, status, '
+          'RRN, document_type',
+        )
+        .eq('kkm_cash_register', login)
+        .gte('document_date', openedAt.toIso8601String());
+    return rows.cast<Map<String, dynamic>>();
+  }
+
   /// Closes a shift with the specified closing amount and sales data
   Future<Map<String, dynamic>> closeShift({
     required int shiftId,
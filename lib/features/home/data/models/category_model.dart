@@ -12,6 +12,7 @@ class CategoryModel {
   final String? parentId;
   final bool isFolder;
   final String? article;
+  final String unitName;
 
   const CategoryModel({
     required this.id,
@@ -24,6 +25,7 @@ class CategoryModel {
     this.parentId,
     required this.isFolder,
     this.article,
+    this.unitName = '',
   });
 
   /// Створює CategoryModel з Nomenclatura entity
@@ -46,6 +48,7 @@ class CategoryModel {
       parentId: nomenclatura.parentGuid,
       isFolder: nomenclatura.isFolder,
       article: nomenclatura.article,
+      unitName: nomenclatura.unitName,
     );
   }
 
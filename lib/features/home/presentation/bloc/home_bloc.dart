@@ -1,3 +1,5 @@
+import 'dart:async';
+
 import 'package:bloc/bloc.dart';
 import 'package:equatable/equatable.dart';
 import 'package:flutter/foundation.dart';
@@ -8,6 +10,7 @@ import '../../../../core/models/cashalot_models.dart';
 import '../../../../core/models/vchasno_errors.dart';
 import '../../../../core/models/fiscal_result.dart';
 import '../../../../core/models/x_report_data.dart';
+import '../../../../core/services/payments/native_terminal_service.dart';
 import '../../../../core/services/payments/terminal_payment_service.dart';
 import '../../data/datasources/shift_remote_data_source.dart';
 import '../../data/datasources/check_remote_data_source.dart';
@@ -17,6 +20,15 @@ import '../../../../core/models/prro_info.dart';
 import '../../../../core/models/pos_result.dart';
 import '../../../../core/models/pos_terminal.dart';
 import '../../../../core/services/cashalot/com/cashalot_com_service.dart';
+import '../../../../core/services/metrics/native_metrics.dart';
+import '../../../../core/services/promo/native_promo_service.dart';
+import '../../../../core/services/report/native_shift_reconciler.dart';
+import '../../../../core/services/archive/native_receipt_archive.dart';
+import '../../../../core/services/maintenance/native_maintenance_service.dart';
+import '../../../../core/services/parking/native_parked_carts.dart';
+import '../../../../core/services/scale/native_scale_service.dart';
+import '../../../../core/services/scanner/native_scanner_service.dart';
+import '../../../nomenclatura/data/datasources/nomenclatura_local_data_source.dart';
 
 part 'home_event.dart';
 part 'home_state.dart';
@@ -33,9 +45,66 @@ class HomeBloc extends Bloc<HomeEvent, HomeViewState> {
     Supabase.instance.client,
   );
 
-  HomeBloc({required this.storageService, PrroService? prroService})
-    : prroService = prroService ?? GetIt.instance<PrroService>(),
-      super(const HomeViewState()) {
+  final NativePromoService? promoService;
+  final NativeReceiptArchive? receiptArchive;
+  final NativeScaleService? scaleService;
+  final NativeScannerService? scannerService;
+  final NativeMaintenanceService? maintenanceService;
+  final NativeTerminalService? terminalService;
+  final NativeParkedCarts? parkedCarts;
+  StreamSubscription<double>? _scaleSubscription;
+  StreamSubscription<String>? _scannerSubscription;
+  // Остання встановлена маса вже пішла в рядок: поки товар лежить на
+  // вагах, наступний ваговий товар чекає нової маси, а не бере ту саму
+  bool _scaleWeightUsed = false;
+
+  HomeBloc({
+    required this.storageService,
+    PrroService? prroService,
+    NativePromoService? promoService,
+    NativeReceiptArchive? receiptArchive,
+    NativeScaleService? scaleService,
+    NativeScannerService? scannerService,
+    NativeMaintenanceService? maintenanceService,
+    NativeTerminalService? terminalService,
+    NativeParkedCarts? parkedCarts,
+  }) : prroService = prroService ?? GetIt.instance<PrroService>(),
+       promoService =
+           promoService ??
+           (GetIt.instance.isRegistered<NativePromoService>()
+               ? GetIt.instance<NativePromoService>()
+               : null),
+       receiptArchive =
+           receiptArchive ??
+           (GetIt.instance.isRegistered<NativeReceiptArchive>()
+               ? GetIt.instance<NativeReceiptArchive>()
+               : null),
+       scaleService =
+           scaleService ??
+           (GetIt.instance.isRegistered<NativeScaleService>()
+               ? GetIt.instance<NativeScaleService>()
+               : null),
+       scannerService =
+           scannerService ??
+           (GetIt.instance.isRegistered<NativeScannerService>()
+               ? GetIt.instance<NativeScannerService>()
+               : null),
+       maintenanceService =
+           maintenanceService ??
+           (GetIt.instance.isRegistered<NativeMaintenanceService>()
+               ? GetIt.instance<NativeMaintenanceService>()
+               : null),
+       terminalService =
+           terminalService ??
+           (GetIt.instance.isRegistered<NativeTerminalService>()
+               ? GetIt.instance<NativeTerminalService>()
+               : null),
+       parkedCarts =
+           parkedCarts ??
+           (GetIt.instance.isRegistered<NativeParkedCarts>()
+               ? GetIt.instance<NativeParkedCarts>()
+               : null),
+       super(const HomeViewState()) {
     on<CheckUserLoginStatus>(_onCheckUserLoginStatus);
     on<LogoutUser>(_onLogoutUser);
     on<ToggleSidebarCollapsed>(_onToggleSidebarCollapsed);
@@ -48,12 +117,15 @@ class HomeBloc extends Bloc<HomeEvent, HomeViewState> {
     on<CheckoutEvent>(_onCheckout);
     on<SetPaymentForm>(_onSetPaymentForm);
     on<PutOffCheckEvent>(_onPutOffCheck);
+    on<LoadParkedCarts>(_onLoadParkedCarts);
+    on<ResumeParkedCart>(_onResumeParkedCart);
     on<SetSearchResults>(_onSetSearchResults);
     on<ClearSearchResults>(_onClearSearchResults);
     on<NavigateToPage>(_onNavigateToPage);
     on<OpenCashalotShift>(_onOpenCashalotShift);
     on<GetAvailablePrrosInfo>(_onGetAvailablePrrosInfo);
     on<CloseCashalotShift>(_onCloseCashalotShift);
+    on<ReconcileShiftEvent>(_onReconcileShift);
     on<ServiceDepositEvent>(_onServiceDeposit);
     on<ServiceIssueEvent>(_onServiceIssue);
     on<XReportEvent>(_onXReport);
@@ -62,6 +134,35 @@ class HomeBloc extends Bloc<HomeEvent, HomeViewState> {
     on<ReturnCheckEvent>(_onReturnCheck);
     on<ShiftClosedEvent>(_onShiftClosed);
     on<GetKkmCheckEvent>(_onGetKkmCheck);
+    on<ScaleWeightSettled>(_onScaleWeightSettled);
+    on<CancelWeighing>(_onCancelWeighing);
+    on<BarcodeScanned>(_onBarcodeScanned);
+
+    // Маса з ваг приходить подією, щойно встановилася
+    _scaleSubscription = this.scaleService?.stableWeights.listen(
+      (kilograms) => add(ScaleWeightSettled(kilograms)),
+    );
+    _scannerSubscription = this.scannerService?.barcodes.listen(
+      (barcode) => add(BarcodeScanned(barcode)),
+    );
+  }
+
+  @override
+  void onChange(Change<HomeViewState> change) {
+    super.onChange(change);
+    // Відкритий чек тримає фонове обслуговування (синхронізацію, індекси)
+    // подалі від продажу, навіть якщо касир відійшов.
+    final open = change.nextState.cart.isNotEmpty;
+    if (open != change.currentState.cart.isNotEmpty) {
+      maintenanceService?.setCartOpen(open);
+    }
+  }
+
+  @override
+  Future<void> close() async {
+    await _scaleSubscription?.cancel();
+    await _scannerSubscription?.cancel();
+    return super.close();
   }
 
   /// Публічний метод для тестового депозиту (для використання з інших модулів)
@@ -210,43 +311,190 @@ class HomeBloc extends Bloc<HomeEvent, HomeViewState> {
     }
   }
 
-  void _onAddToCart(AddToCart event, Emitter<HomeViewState> emit) {
+  Future<void> _onAddToCart(
+    AddToCart event,
+    Emitter<HomeViewState> emit,
+  ) async {
+    if (event.weighed && (scaleService?.isRunning ?? false)) {
+      final pending = CartItem(
+        guid: event.guid,
+        name: event.name,
+        article: event.article,
+        price: event.price,
+        category: event.category,
+      );
+      // Товар поклали на ваги ще до вибору: маса вже встановилася, і
+      // нової події не буде — беремо її з драйвера одразу
+      if (!_scaleWeightUsed) {
+        final kilograms = await scaleService!.currentStableWeight();
+        if (kilograms != null && kilograms > 0) {
+          await _addWeighed(pending, kilograms, emit);
+          return;
+        }
+      }
+      // Інакше рядок з'явиться з масою, що встановиться (див.
+      // _onScaleWeightSettled), або касир скасує очікування
+      emit(state.copyWith(weighingItem: pending));
+      return;
+    }
+
     final existingIndex = state.cart.indexWhere((c) => c.guid == event.guid);
+    final CartItem line;
     if (existingIndex >= 0) {
       final updated = List<CartItem>.from(state.cart);
       final current = updated[existingIndex];
-      updated[existingIndex] = current.copyWith(quantity: current.quantity + 1);
+      line = current.copyWith(quantity: current.quantity + 1);
+      updated[existingIndex] = line;
       emit(state.copyWith(cart: updated));
     } else {
-      final updated = List<CartItem>.from(state.cart)
-        ..add(
-          CartItem(
-            guid: event.guid,
-            name: event.name,
-            article: event.article,
-            price: event.price,
-            quantity: 1,
-          ),
-        );
+      line = CartItem(
+        guid: event.guid,
+        name: event.name,
+        article: event.article,
+        price: event.price,
+        quantity: 1,
+        category: event.category,
+      );
+      final updated = List<CartItem>.from(state.cart)..add(line);
       emit(state.copyWith(cart: updated));
     }
+    await _applyPromo(
+      promoService?.setLine(
+        guid: line.guid,
+        category: line.category,
+        price: line.price,
+        quantity: line.amount,
+      ),
+      emit,
+    );
   }
 
-  void _onRemoveFromCart(RemoveFromCart event, Emitter<HomeViewState> emit) {
+  Future<void> _onBarcodeScanned(
+    BarcodeScanned event,
+    Emitter<HomeViewState> emit,
+  ) async {
+    // Код у кошик додається лише з каталогу; повернення слухає сканер
+    // саме, а на решті сторінок код іде в поле з фокусом, як і без
+    // розпізнавання сплеску
+    if (state.currentPage != '/menu') {
+      if (state.currentPage != '/return' &&
+          !NativeScannerService.typeIntoFocusedField(event.barcode)) {
+        debugPrint('⚠️ [SCANNER] ${event.barcode}: немає поля для коду');
+      }
+      return;
+    }
+    if (!GetIt.instance.isRegistered<NomenclaturaLocalDataSource>()) return;
+    try {
+      final item = await GetIt.instance<NomenclaturaLocalDataSource>()
+          .searchByBarcode(event.barcode);
+      if (item == null) {
+        debugPrint(
+          '⚠️ [SCANNER] Товар зі штрихкодом ${event.barcode} не знайдено',
+        );
+        return;
+      }
+      add(
+        AddToCart(
+          guid: item.guid,
+          name: item.name,
+          article: item.article,
+          price: item.prices,
+          category: item.parentGuid ?? '',
+          weighed: isWeighedUnit(item.unitName),
+        ),
+      );
+    } catch (e) {
+      debugPrint('❌ [SCANNER] Пошук за штрихкодом: $e');
+    }
+  }
+
+  Future<void> _onScaleWeightSettled(
+    ScaleWeightSettled event,
+    Emitter<HomeViewState> emit,
+  ) async {
+    final pending = state.weighingItem;
+    if (event.kilograms <= 0) return;
+    if (pending == null) {
+      // Нова маса без товару, що її чекає: її візьме наступний ваговий
+      _scaleWeightUsed = false;
+      return;
+    }
+    await _addWeighed(pending, event.kilograms, emit);
+  }
+
+  void _onCancelWeighing(CancelWeighing event, Emitter<HomeViewState> emit) {
+    if (state.weighingItem == null) return;
+    emit(state.copyWith(clearWeighingItem: true));
+  }
+
+  /// Додає ваговий товар [pending] з масою [kilograms] у кошик.
+  Future<void> _addWeighed(
+    CartItem pending,
+    double kilograms,
+    Emitter<HomeViewState> emit,
+  ) async {
+    _scaleWeightUsed = true;
+    final updated = List<CartItem>.from(state.cart);
+    final existingIndex = updated.indexWhere((c) => c.guid == pending.guid);
+    final CartItem line;
+    if (existingIndex >= 0) {
+      // Той самий товар зважили ще раз: маси додаються
+      final current = updated[existingIndex];
+      final weight = current.weight + kilograms;
+      line = current.copyWith(
+        weight: double.parse(weight.toStringAsFixed(3)),
+      );
+      updated[existingIndex] = line;
+    } else {
+      line = pending.copyWith(weight: kilograms);
+      updated.add(line);
+    }
+    emit(state.copyWith(cart: updated, clearWeighingItem: true));
+    await _applyPromo(
+      promoService?.setLine(
+        guid: line.guid,
+        category: line.category,
+        price: line.price,
+        quantity: line.amount,
+      ),
+      emit,
+    );
+  }
+
+  Future<void> _onRemoveFromCart(
+    RemoveFromCart event,
+    Emitter<HomeViewState> emit,
+  ) async {
     final updated = state.cart.where((c) => c.guid != event.guid).toList();
     emit(state.copyWith(cart: updated));
+    await _applyPromo(promoService?.removeLine(event.guid), emit);
+  }
+
+  /// Переносить у кошик знижки рядків, перераховані нативним рушієм акцій.
+  /// Кошик уже показано без очікування: знижки доходять наступним станом.
+  Future<void> _applyPromo(
+    Future<PromoUpdate?>? pending,
+    Emitter<HomeViewState> emit,
+  ) async {
+    final update = await pending;
+    if (update == null || update.changed.isEmpty || emit.isDone) return;
+    final updated = state.cart.map((item) {
+      final discount = update.changed[item.guid];
+      return discount == null ? item : item.copyWith(discount: discount);
+    }).toList();
+    emit(state.copyWith(cart: updated));
   }
 
-  void _onUpdateCartItemQuantity(
+  Future<void> _onUpdateCartItemQuantity(
     UpdateCartItemQuantity event,
     Emitter<HomeViewState> emit,
-  ) {
+  ) async {
     print('Updating cart item quantity: ${event.guid} -> ${event.quantity}');
 
     if (event.quantity <= 0) {
       // Якщо кількість 0 або менше, видаляємо товар з кошика
       print('Removing item from cart (quantity <= 0)');
-      _onRemoveFromCart(RemoveFromCart(guid: event.guid), emit);
+      await _onRemoveFromCart(RemoveFromCart(guid: event.guid), emit);
       return;
     }
 
@@ -262,6 +510,19 @@ class HomeBloc extends Bloc<HomeEvent, HomeViewState> {
 
     emit(state.copyWith(cart: updatedCart));
     print('Cart updated, new cart length: ${updatedCart.length}');
+
+    final index = updatedCart.indexWhere((c) => c.guid == event.guid);
+    if (index < 0) return;
+    final line = updatedCart[index];
+    await _applyPromo(
+      promoService?.setLine(
+        guid: line.guid,
+        category: line.category,
+        price: line.price,
+        quantity: line.amount,
+      ),
+      emit,
+    );
   }
 
   void _onSetPaymentForm(SetPaymentForm event, Emitter<HomeViewState> emit) {
@@ -525,6 +786,8 @@ class HomeBloc extends Bloc<HomeEvent, HomeViewState> {
     CheckoutEvent event,
     Emitter<HomeViewState> emit,
   ) async {
+    // Від натискання "Оплатити" до фіскального чека (разом з оплатою карткою)
+    final saleWatch = Stopwatch()..start();
     try {
       // 1. Блокуємо інтерфейс
       emit(state.copyWith(status: HomeStatus.loading));
@@ -542,11 +805,8 @@ class HomeBloc extends Bloc<HomeEvent, HomeViewState> {
       final prroFiscalNum = await _getActivePrroFiscalNum();
       debugPrint('📋 [CHECKOUT] ПРРО: $prroFiscalNum, Касир: $cashierName');
 
-      // 3. Рахуємо загальну суму
-      final totalSum = state.cart.fold(
-        0.0,
-        (sum, item) => sum + (item.price * item.quantity),
-      );
+      // 3. Рахуємо загальну суму (зі знижками за акціями)
+      final totalSum = state.cart.fold(0.0, (sum, item) => sum + item.total);
 
       // 4. Етап Оплати (Банківський термінал)
       // Якщо оплата карткою - спочатку знімаємо гроші через POS, прив'язаний у Cashalot
@@ -573,8 +833,9 @@ class HomeBloc extends Bloc<HomeEvent, HomeViewState> {
             (item) => CheckBodyRow(
               code: item.article.isNotEmpty ? item.article : item.guid,
               name: item.name,
-              amount: item.quantity.toDouble(),
+              amount: item.amount,
               price: item.price,
+              discount: item.discount,
               // cost розрахується автоматично або в PrroService
             ),
           )
@@ -607,8 +868,23 @@ class HomeBloc extends Bloc<HomeEvent, HomeViewState> {
       debugPrint(
         '✅ [CHECKOUT] Чек фіскалізовано! Номер: ${fiscalResult.docNumber}',
       );
+      NativeMetrics.observe(
+        'virok_sale_to_receipt_microseconds',
+        saleWatch.elapsed,
+        help: 'Checkout start to fiscal receipt',
+        labels: {'payment': cardResult != null ? 'card' : 'cash'},
+      );
+
+      // 6. Локальний архів (повернення і повторний друк без сервера)
+      await _archiveReceipt(
+        payload: payload,
+        fiscalNumber: fiscalResult.docNumber,
+        rrn: cardResult?.rrn ?? '',
+        visualization: fiscalResult.visualization,
+        cart: state.cart,
+      );
 
-      // 6. Збереження в БД (Supabase)
+      // 7. Збереження в БД (Supabase)
       await _saveCheckToDatabase(
         cart: state.cart,
         totalSum: totalSum,
@@ -618,7 +894,8 @@ class HomeBloc extends Bloc<HomeEvent, HomeViewState> {
         rrn: cardResult?.rrn ?? '',
       );
 
-      // 7. Успішне завершення
+      // 8. Успішне завершення
+      await promoService?.clear();
       emit(
         state.copyWith(
           cart: const [], // Очищаємо кошик
@@ -629,6 +906,10 @@ class HomeBloc extends Bloc<HomeEvent, HomeViewState> {
       );
     } catch (e) {
       debugPrint('❌ [CHECKOUT ERROR] $e');
+      NativeMetrics.count(
+        'virok_checkout_failures_total',
+        help: 'Checkouts that ended with an error',
+      );
       emit(
         state.copyWith(
           status: HomeStatus.error,
@@ -644,11 +925,40 @@ class HomeBloc extends Bloc<HomeEvent, HomeViewState> {
   /// 2. Обирає термінал за замовчуванням (або перший у списку).
   /// 3. Виконує оплату (поки що MOCK, тут має бути реальний виклик до банківського драйвера).
   /// 4. Повертає результат оплати або null, якщо вже емічено помилку.
+  ///
+  /// Якщо запущено нативний драйвер термінала ([terminalService]), оплата
+  /// йде через нього: етапи потрапляють у `terminalState`, а сліп драйвер
+  /// друкує сам одразу після схвалення.
   Future<PosTransactionResult?> _processCardPayment({
     required double amount,
     required int prroFiscalNum,
     required Emitter<HomeViewState> emit,
   }) async {
+    final terminal = terminalService;
+    if (terminal != null && terminal.isRunning) {
+      debugPrint('💰 Сума до сплати: $amount');
+      // Діалог оплати з'являється одразу, ще до першого етапу від термінала
+      emit(state.copyWith(terminalState: 'awaitingCard'));
+      final result = await terminal.purchase(
+        amount: amount,
+        onState: (terminalState) {
+          if (!emit.isDone) emit(state.copyWith(terminalState: terminalState));
+        },
+      );
+      if (!result.isSuccess) {
+        emit(
+          state.copyWith(
+            status: HomeStatus.error,
+            errorMessage: 'Оплата не пройшла: ${result.errorMessage}',
+            clearTerminalState: true,
+          ),
+        );
+        return null;
+      }
+      emit(state.copyWith(clearTerminalState: true));
+      return result;
+    }
+
     try {
       final cashalotCom = GetIt.instance<CashalotComService>();
 
@@ -754,6 +1064,68 @@ class HomeBloc extends Bloc<HomeEvent, HomeViewState> {
   // _printBankSlips наразі не використовується в COM‑сценарії та видалений,
   // щоб уникнути попереджень лінтера.
 
+  /// Записує фіскалізований чек у локальний архів. Для продажу рядки
+  /// доповнюються GUID і штрихкодами з локальної номенклатури (пошук
+  /// повернення за штрихкодом).
+  Future<void> _archiveReceipt({
+    required CheckPayload payload,
+    required String? fiscalNumber,
+    String rrn = '',
+    String? visualization,
+    String docType = 'sale',
+    List<CartItem> cart = const [],
+  }) async {
+    final archive = receiptArchive;
+    if (archive == null || !await archive.ready) return;
+    if (fiscalNumber == null || fiscalNumber.isEmpty) return;
+
+    try {
+      final barcodes = <String, List<String>>{};
+      if (cart.isNotEmpty &&
+          GetIt.instance.isRegistered<NomenclaturaLocalDataSource>()) {
+        final items = await GetIt.instance<NomenclaturaLocalDataSource>()
+            .getCachedNomenclaturaByGuids([for (final c in cart) c.guid]);
+        for (final item in items) {
+          barcodes[item.guid] = [
+            for (final b in item.barcodes.split(','))
+              if (b.trim().isNotEmpty) b.trim(),
+          ];
+        }
+      }
+
+      final body = payload.checkBody;
+      await archive.put(
+        fiscalNumber: fiscalNumber,
+        rrn: rrn,
+        docType: docType,
+        cashier: payload.checkHead.cashier,
+        total: payload.checkTotal.sum,
+        lines: [
+          for (var i = 0; i < body.length; i++)
+            {
+              'guid': i < cart.length ? cart[i].guid : '',
+              'code': body[i].code,
+              'name': body[i].name,
+              'barcodes': i < cart.length
+                  ? barcodes[cart[i].guid] ?? const <String>[]
+                  : const <String>[],
+              'quantity': body[i].amount,
+              'price': body[i].price,
+              'discount': body[i].discount,
+            },
+        ],
+        payments: [
+          for (final pay in payload.checkPay)
+            {'form': pay.payFormNm, 'amount': pay.sum},
+        ],
+        visualization: visualization,
+      );
+    } catch (e) {
+      // Чек уже фіскалізовано: архів лише прискорює пошук
+      debugPrint('⚠️ [ARCHIVE] Чек $fiscalNumber не заархівовано: $e');
+    }
+  }
+
   // Допоміжний метод для збереження в БД
   Future<void> _saveCheckToDatabase({
     required List<CartItem> cart,
@@ -769,6 +1141,8 @@ class HomeBloc extends Bloc<HomeEvent, HomeViewState> {
         paymentForm: paymentForm,
         seller: state.user?.email ?? '',
         rrn: rrn,
+        // Фіскальний номер: за ним звірка зміни з'єднує чек з архівом каси
+        documentNumber: fiscalNumber,
         // status: 'Fiscalized', // Можна додати статус
       );
 
@@ -778,10 +1152,10 @@ class HomeBloc extends Bloc<HomeEvent, HomeViewState> {
               'check_id': checkId,
               'product_code': c.article.isNotEmpty ? c.article : c.guid,
               'product_name': c.name,
-              'unit': 'шт',
-              'quantity': c.quantity,
+              'unit': c.isWeighed ? 'кг' : 'шт',
+              'quantity': c.amount,
               'price': c.price,
-              'amount': c.quantity * c.price,
+              'amount': c.total,
               'seller': cashierName,
             },
           )
@@ -805,35 +1179,70 @@ class HomeBloc extends Bloc<HomeEvent, HomeViewState> {
       }
 
       final items = state.cart.map((c) {
-        final amount = c.quantity * c.price;
+        final gross = c.amount * c.price;
         return {
           'product_code': c.article.isNotEmpty ? c.article : c.guid,
           'product_name': c.name,
-          'unit': 'шт',
-          'quantity': c.quantity,
+          'unit': c.isWeighed ? 'кг' : 'шт',
+          'quantity': c.amount,
           'price': c.price,
-          'discount_percent': 0,
-          'amount': amount,
+          'discount_percent': gross > 0
+              ? double.parse((c.discount / gross * 100).toStringAsFixed(2))
+              : 0,
+          'amount': c.total,
           'seller': seller,
         };
       }).toList();
 
       final totalAmount = state.cart.fold<double>(
         0.0,
-        (sum, item) => sum + (item.price * item.quantity),
+        (sum, item) => sum + item.total,
       );
 
-      final checkId = await checkRemoteDataSource.createCheck(
-        amount: totalAmount,
+      // Спершу на диск каси: відкладений чек не залежить від мережі
+      final parkedId = await parkedCarts?.park(
+        cashier: seller,
         paymentForm: state.paymentForm,
-        seller: state.user?.email ?? '',
-        status: 'Чек відкладений',
+        lines: [
+          for (final c in state.cart)
+            ParkedLine(
+              guid: c.guid,
+              name: c.name,
+              article: c.article,
+              category: c.category,
+              price: c.price,
+              quantity: c.quantity,
+              weight: c.weight,
+              discount: c.discount,
+            ),
+        ],
       );
 
-      await checkRemoteDataSource.insertCheckItems(checkId, items);
+      try {
+        final checkId = await checkRemoteDataSource.createCheck(
+          amount: totalAmount,
+          paymentForm: state.paymentForm,
+          seller: state.user?.email ?? '',
+          status: 'Чек відкладений',
+        );
+
+        await checkRemoteDataSource.insertCheckItems(checkId, items);
+      } catch (e) {
+        if (parkedId == null) rethrow;
+        debugPrint('⚠️ [PARKED] Чек $parkedId не записано в kkm_checks: $e');
+      }
 
       // Очистити кошик після успішного проведення чеку
-      emit(state.copyWith(cart: const [], status: HomeStatus.putOffCheck));
+      await promoService?.clear();
+      emit(
+        state.copyWith(
+          cart: const [],
+          status: HomeStatus.putOffCheck,
+          parkedCarts: parkedId == null
+              ? null
+              : await parkedCarts!.list(cashier: seller),
+        ),
+      );
     } catch (e) {
       emit(
         state.copyWith(status: HomeStatus.error, errorMessage: e.toString()),
@@ -841,6 +1250,118 @@ class HomeBloc extends Bloc<HomeEvent, HomeViewState> {
     }
   }
 
+  Future<void> _onLoadParkedCarts(
+    LoadParkedCarts event,
+    Emitter<HomeViewState> emit,
+  ) async {
+    final service = parkedCarts;
+    if (service == null || !service.isAvailable) return;
+    final seller = await storageService.getUserEmail() ?? '';
+    emit(state.copyWith(parkedCarts: await service.list(cashier: seller)));
+  }
+
+  Future<void> _onResumeParkedCart(
+    ResumeParkedCart event,
+    Emitter<HomeViewState> emit,
+  ) async {
+    final service = parkedCarts;
+    if (service == null) return;
+    if (state.cart.isNotEmpty) {
+      emit(
+        state.copyWith(
+          status: HomeStatus.error,
+          errorMessage: 'Спершу проведіть або відкладіть поточний чек',
+        ),
+      );
+      return;
+    }
+    // Кошик лишається в журналі, доки його рядки не перенесено в чек:
+    // збій посеред відновлення не губить відкладений чек.
+    final parked = await service.get(event.id);
+    if (parked == null) {
+      // Чек уже відновили (інша вкладка або повторне натискання)
+      add(const LoadParkedCarts());
+      return;
+    }
+
+    // Ціни могли змінитися, поки чек лежав: усі рядки одним запитом
+    final prices = <String, double>{};
+    if (GetIt.instance.isRegistered<NomenclaturaLocalDataSource>()) {
+      try {
+        final items = await GetIt.instance<NomenclaturaLocalDataSource>()
+            .getCachedNomenclaturaByGuids([
+              for (final line in parked.lines) line.guid,
+            ]);
+        for (final item in items) {
+          prices[item.guid] = item.prices;
+        }
+      } catch (e) {
+        debugPrint('⚠️ [PARKED] Ціни не перевірено, лишаються старі: $e');
+      }
+    }
+
+    final repriced = <String>[];
+    final cart = [
+      for (final line in parked.lines)
+        CartItem(
+          guid: line.guid,
+          name: line.name,
+          article: line.article,
+          price: prices[line.guid] ?? line.price,
+          quantity: line.quantity,
+          category: line.category,
+          weight: line.weight,
+        ),
+    ];
+    for (final line in parked.lines) {
+      final price = prices[line.guid];
+      if (price != null && price != line.price) repriced.add(line.name);
+    }
+    if (repriced.isNotEmpty) {
+      debugPrint('🅿️ [PARKED] Нові ціни: ${repriced.join(', ')}');
+    }
+
+    emit(
+      state.copyWith(
+        status: HomeStatus.loggedIn,
+        cart: cart,
+        paymentForm: parked.paymentForm.isNotEmpty ? parked.paymentForm : null,
+        parkedCarts: state.parkedCarts
+            .where((c) => c.id != parked.id)
+            .toList(),
+        repricedItems: repriced,
+      ),
+    );
+    if (await service.take(parked.id) == null) {
+      // Той самий кошик відновили паралельно (повторне натискання): чек
+      // лишається в одному місці.
+      emit(
+        state.copyWith(
+          cart: const [],
+          repricedItems: const [],
+          status: HomeStatus.error,
+          errorMessage: 'Відкладений чек уже відновлено або недоступний',
+        ),
+      );
+      add(const LoadParkedCarts());
+      return;
+    }
+
+    // Знижки — за поточними правилами акцій, як для нового чека
+    await promoService?.clear();
+    for (final line in cart) {
+      await _applyPromo(
+        promoService?.setLine(
+          guid: line.guid,
+          category: line.category,
+          price: line.price,
+          quantity: line.amount,
+        ),
+        emit,
+      );
+    }
+  }
+
   void _onSetSearchResults(
     SetSearchResults event,
     Emitter<HomeViewState> emit,
@@ -914,6 +1435,62 @@ class HomeBloc extends Bloc<HomeEvent, HomeViewState> {
     }
   }
 
+  /// Звірка зміни перед Z-звітом: свіжий X-звіт пристрою, чеки зміни з
+  /// kkm_checks і локальний архів каси зводяться нативно; результат — у
+  /// `reconciliation` для показу менеджеру.
+  Future<void> _onReconcileShift(
+    ReconcileShiftEvent event,
+    Emitter<HomeViewState> emit,
+  ) async {
+    try {
+      emit(
+        state.copyWith(status: HomeStatus.loading, clearReconciliation: true),
+      );
+      XReportData? report;
+      List<Map<String, dynamic>> serverChecks;
+      var openedAt = state.openedShiftAt;
+      if (openedAt != null) {
+        // Час відкриття відомий — X-звіт і чеки сервера запитуємо разом
+        final results = await Future.wait<Object?>([
+          prroService.printXReport(),
+          shiftRemoteDataSource.getShiftChecks(openedAt),
+        ]);
+        report = results[0] as XReportData?;
+        serverChecks = results[1] as List<Map<String, dynamic>>;
+        if (report == null) throw Exception('Не вдалося отримати X-звіт');
+      } else {
+        report = await prroService.printXReport();
+        if (report == null) throw Exception('Не вдалося отримати X-звіт');
+        // Без часу відкриття в звірку потрапили б чеки попередньої зміни
+        openedAt = report.shiftOpened;
+        if (openedAt == null) {
+          throw Exception('Невідомий час відкриття зміни — звірка неможлива');
+        }
+        serverChecks = await shiftRemoteDataSource.getShiftChecks(openedAt);
+      }
+      final reconciliation = await const NativeShiftReconciler().reconcile(
+        report: report,
+        serverChecks: serverChecks,
+        shiftOpened: openedAt,
+        drawerCounted: event.drawerCounted,
+      );
+      if (reconciliation == null) {
+        throw Exception('Звірка зміни недоступна на цій платформі');
+      }
+      emit(
+        state.copyWith(
+          status: HomeStatus.loggedIn,
+          reconciliation: reconciliation,
+        ),
+      );
+    } catch (e) {
+      debugPrint('❌ [RECONCILE] Помилка: $e');
+      emit(
+        state.copyWith(status: HomeStatus.error, errorMessage: e.toString()),
+      );
+    }
+  }
+
   /// Закриття зміни через VchasnoService (Z-звіт)
   Future<void> _onCloseCashalotShift(
     CloseCashalotShift event,
@@ -1213,6 +1790,12 @@ class HomeBloc extends Bloc<HomeEvent, HomeViewState> {
           docNumber: fiscalRes.data?['docNumber']?.toString(),
           totalAmount: event.totalSum,
         );
+        await _archiveReceipt(
+          payload: event.checkPayload,
+          fiscalNumber: returnResult.docNumber,
+          rrn: terminalResult?.rrn ?? '',
+          docType: 'return',
+        );
 
         emit(
           state.copyWith(
@@ -1244,7 +1827,8 @@ class HomeBloc extends Bloc<HomeEvent, HomeViewState> {
     }
   }
 
-  /// Пошук чека в Supabase за фіскальним номером (document_number)
+  /// Пошук чека за фіскальним номером: спершу локальний архів, потім
+  /// Supabase (document_number)
   Future<void> _onGetKkmCheck(
     GetKkmCheckEvent event,
     Emitter<HomeViewState> emit,
@@ -1264,6 +1848,27 @@ class HomeBloc extends Bloc<HomeEvent, HomeViewState> {
         ),
       );
 
+      final archived = await receiptArchive?.byFiscalNumber(
+        event.fiscalNumber.trim(),
+      );
+      if (archived != null) {
+        debugPrint(
+          '✅ [KKM_CHECK] Знайдено в локальному архіві: '
+          'payment_form=${archived.paymentForm}, amount=${archived.total}',
+        );
+        emit(
+          state.copyWith(
+            status: HomeStatus.kkmSearchSuccess,
+            kkmPaymentForm: archived.paymentForm,
+            kkmRrn: archived.rrn.isEmpty ? null : archived.rrn,
+            kkmAmount: archived.total,
+            kkmItems: archived.itemRows,
+            kkmFiscalNumber: archived.fiscalNumber,
+          ),
+        );
+        return;
+      }
+
       final row = await checkRemoteDataSource.getCheckByFiscalNumber(
         event.fiscalNumber.trim(),
       );
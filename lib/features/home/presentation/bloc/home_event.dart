@@ -36,16 +36,45 @@ final class AddToCart extends HomeEvent {
   final String name;
   final String article;
   final double price;
+  final String category; // guid групи каталогу, якщо відомий
+  final bool weighed; // ціна за кг: кількість береться з ваг
 
   const AddToCart({
     required this.guid,
     required this.name,
     required this.article,
     required this.price,
+    this.category = '',
+    this.weighed = false,
   });
 
   @override
-  List<Object> get props => [guid, name, article, price];
+  List<Object> get props => [guid, name, article, price, category, weighed];
+}
+
+/// Ваги повідомили масу, що встановилася.
+final class ScaleWeightSettled extends HomeEvent {
+  final double kilograms;
+
+  const ScaleWeightSettled(this.kilograms);
+
+  @override
+  List<Object> get props => [kilograms];
+}
+
+/// Касир передумав зважувати: ваговий товар більше не чекає маси.
+final class CancelWeighing extends HomeEvent {
+  const CancelWeighing();
+}
+
+/// Сканер зчитав штрихкод (див. NativeScannerService).
+final class BarcodeScanned extends HomeEvent {
+  final String barcode;
+
+  const BarcodeScanned(this.barcode);
+
+  @override
+  List<Object> get props => [barcode];
 }
 
 final class RemoveFromCart extends HomeEvent {
@@ -88,6 +117,21 @@ final class PutOffCheckEvent extends HomeEvent {
   const PutOffCheckEvent();
 }
 
+/// Оновлює список відкладених кошиків поточного касира
+final class LoadParkedCarts extends HomeEvent {
+  const LoadParkedCarts();
+}
+
+/// Повертає відкладений кошик у чек за цінами поточного каталогу
+final class ResumeParkedCart extends HomeEvent {
+  final int id;
+
+  const ResumeParkedCart(this.id);
+
+  @override
+  List<Object> get props => [id];
+}
+
 final class SetSearchResults extends HomeEvent {
   final List<dynamic> results;
 
@@ -134,6 +178,17 @@ final class GetAvailablePrrosInfo extends HomeEvent {
   List<Object> get props => [prroFiscalNum ?? 0];
 }
 
+/// Звірка зміни перед Z-звітом: X-звіт, kkm_checks і архів каси
+/// (див. NativeShiftReconciler). [drawerCounted] — готівка в шухляді.
+final class ReconcileShiftEvent extends HomeEvent {
+  final double? drawerCounted;
+
+  const ReconcileShiftEvent({this.drawerCounted});
+
+  @override
+  List<Object> get props => [drawerCounted ?? -1];
+}
+
 /// Закриття зміни через CashalotService
 final class CloseCashalotShift extends HomeEvent {
   final int? prroFiscalNum;
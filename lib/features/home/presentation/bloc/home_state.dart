@@ -39,6 +39,12 @@ class HomeViewState extends Equatable {
   final String? kkmFiscalNumber;
   final double? kkmAmount;
   final List<Map<String, dynamic>> kkmItems;
+  final CartItem? weighingItem; // ваговий товар, що чекає маси з ваг
+  final String? terminalState; // етап оплати на терміналі (cardTapped, ...)
+  final ShiftReconciliation? reconciliation; // звірка зміни перед Z-звітом
+  final List<ParkedCart> parkedCarts; // відкладені кошики касира
+  // Товари відновленого кошика, ціна яких змінилась у каталозі
+  final List<String> repricedItems;
 
   const HomeViewState({
     this.status = HomeStatus.initial,
@@ -61,6 +67,11 @@ class HomeViewState extends Equatable {
     this.kkmAmount,
     this.kkmFiscalNumber,
     this.kkmItems = const [],
+    this.weighingItem,
+    this.terminalState,
+    this.reconciliation,
+    this.parkedCarts = const [],
+    this.repricedItems = const [],
   });
 
   HomeViewState copyWith({
@@ -84,6 +95,11 @@ class HomeViewState extends Equatable {
     double? kkmAmount,
     String? kkmFiscalNumber,
     List<Map<String, dynamic>>? kkmItems,
+    CartItem? weighingItem,
+    String? terminalState,
+    ShiftReconciliation? reconciliation,
+    List<ParkedCart>? parkedCarts,
+    List<String>? repricedItems,
     // Спеціальні прапорці для явного встановлення null
     bool clearOpenedShiftAt = false,
     bool clearXReportData = false,
@@ -91,6 +107,9 @@ class HomeViewState extends Equatable {
     bool clearVchasnoError = false,
     bool clearReturnResult = false,
     bool clearKkmCheck = false,
+    bool clearWeighingItem = false,
+    bool clearTerminalState = false,
+    bool clearReconciliation = false,
   }) {
     return HomeViewState(
       status: status ?? this.status,
@@ -125,6 +144,17 @@ class HomeViewState extends Equatable {
           ? null
           : (kkmFiscalNumber ?? this.kkmFiscalNumber),
       kkmItems: clearKkmCheck ? [] : (kkmItems ?? this.kkmItems),
+      weighingItem: clearWeighingItem
+          ? null
+          : (weighingItem ?? this.weighingItem),
+      terminalState: clearTerminalState
+          ? null
+          : (terminalState ?? this.terminalState),
+      reconciliation: clearReconciliation
+          ? null
+          : (reconciliation ?? this.reconciliation),
+      parkedCarts: parkedCarts ?? this.parkedCarts,
+      repricedItems: repricedItems ?? this.repricedItems,
     );
   }
 
@@ -150,6 +180,11 @@ class HomeViewState extends Equatable {
     kkmAmount,
     kkmItems,
     kkmFiscalNumber,
+    weighingItem,
+    terminalState,
+    reconciliation,
+    parkedCarts,
+    repricedItems,
   ];
 }
 
@@ -159,6 +194,9 @@ class CartItem extends Equatable {
   final String article;
   final double price;
   final int quantity;
+  final String category; // guid групи каталогу (для акцій на категорію)
+  final double discount; // знижка за акціями на весь рядок, грн
+  final double weight; // маса з ваг, кг (0 — штучний товар)
 
   const CartItem({
     required this.guid,
@@ -166,22 +204,48 @@ class CartItem extends Equatable {
     required this.article,
     required this.price,
     this.quantity = 1,
+    this.category = '',
+    this.discount = 0,
+    this.weight = 0,
   });
 
+  bool get isWeighed => weight > 0;
+
+  /// Кількість у чеку: маса для вагового товару, штуки — для решти
+  double get amount => isWeighed ? weight : quantity.toDouble();
+
+  /// Сума рядка до сплати (з урахуванням знижки)
+  double get total => price * amount - discount;
+
   CartItem copyWith({
     String? guid,
     String? name,
     String? article,
     double? price,
     int? quantity,
+    String? category,
+    double? discount,
+    double? weight,
   }) => CartItem(
     guid: guid ?? this.guid,
     name: name ?? this.name,
     article: article ?? this.article,
     price: price ?? this.price,
     quantity: quantity ?? this.quantity,
+    category: category ?? this.category,
+    discount: discount ?? this.discount,
+    weight: weight ?? this.weight,
   );
 
   @override
-  List<Object> get props => [guid, name, article, price, quantity];
+  List<Object> get props => [
+    guid,
+    name,
+    article,
+    price,
+    quantity,
+    category,
+    discount,
+    weight,
+  ];
 }
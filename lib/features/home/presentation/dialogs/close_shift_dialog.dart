@@ -7,6 +7,7 @@ import 'package:intl/intl.dart';
 import 'package:supabase_flutter/supabase_flutter.dart';
 import '../../../../core/services/cashalot/com/cashalot_com_service.dart';
 import '../../../../core/services/prro/prro_service.dart';
+import '../../../../core/services/report/native_shift_reconciler.dart';
 import '../../../../core/services/storage/storage_service.dart';
 import '../../../../core/widgets/notificarion_toast/toast_manager.dart';
 import '../../../../core/widgets/notificarion_toast/toast_type.dart';
@@ -14,7 +15,7 @@ import '../../data/datasources/shift_remote_data_source.dart';
 import '../bloc/home_bloc.dart';
 
 /// Етапи закриття зміни
-enum _CloseShiftStep { loading, serviceIssue, closing }
+enum _CloseShiftStep { loading, serviceIssue, reconciling, mismatch, closing }
 
 /// [rootContext] must be a context that is under the [HomeBloc] provider.
 Future<void> showCloseShiftDialog(
@@ -59,6 +60,12 @@ class _CloseShiftContentState extends State<_CloseShiftContent> {
   _CloseShiftStep _currentStep = _CloseShiftStep.loading;
   String? _prroError;
 
+  // Звірка перед Z-звітом: розбіжності (або помилка звірки) показуються
+  // до закриття, і касир закриває зміну лише явним підтвердженням.
+  ShiftReconciliation? _reconciliation;
+  String? _reconcileError;
+  double _issueAmount = 0.0;
+
   @override
   void initState() {
     super.initState();
@@ -158,6 +165,24 @@ class _CloseShiftContentState extends State<_CloseShiftContent> {
             ),
           ],
         );
+      case _CloseShiftStep.reconciling:
+        return const Text(
+          'Звірка зміни...',
+          style: TextStyle(color: Colors.white),
+        );
+      case _CloseShiftStep.mismatch:
+        return const Row(
+          children: [
+            Icon(Icons.report_problem_outlined, color: Colors.orange),
+            SizedBox(width: 8),
+            Expanded(
+              child: Text(
+                'Зміна не зійшлася',
+                style: TextStyle(color: Colors.white),
+              ),
+            ),
+          ],
+        );
       case _CloseShiftStep.closing:
         return Row(
           children: [
@@ -314,6 +339,27 @@ class _CloseShiftContentState extends State<_CloseShiftContent> {
           ),
         );
 
+      case _CloseShiftStep.reconciling:
+        return const SizedBox(
+          height: 100,
+          child: Center(
+            child: Column(
+              mainAxisSize: MainAxisSize.min,
+              children: [
+                CircularProgressIndicator(color: Colors.white),
+                SizedBox(height: 16),
+                Text(
+                  'X-звіт, чеки на сервері й архів каси...',
+                  style: TextStyle(color: Colors.white70),
+                ),
+              ],
+            ),
+          ),
+        );
+
+      case _CloseShiftStep.mismatch:
+        return _buildMismatch();
+
       case _CloseShiftStep.closing:
         return const SizedBox(
           height: 100,
@@ -334,6 +380,112 @@ class _CloseShiftContentState extends State<_CloseShiftContent> {
     }
   }
 
+  /// Розбіжності звірки: обороти за формами, кількість чеків, готівка і
+  /// окремі чеки.
+  Widget _buildMismatch() {
+    final r = _reconciliation;
+    return SizedBox(
+      width: 520,
+      child: SingleChildScrollView(
+        child: Column(
+          mainAxisSize: MainAxisSize.min,
+          crossAxisAlignment: CrossAxisAlignment.start,
+          children: [
+            Text(
+              r == null
+                  ? 'Не вдалося звірити зміну: $_reconcileError'
+                  : 'Дані пристрою, сервера й каси відрізняються. '
+                        'Перевірте їх перед Z-звітом.',
+              style: const TextStyle(color: Colors.orange, fontSize: 13),
+            ),
+            if (r != null) ...[
+              const SizedBox(height: 12),
+              for (final form in r.forms.where((f) => !f.matches))
+                _buildInfoRow(
+                  form.form,
+                  'ПРРО ${form.device.toStringAsFixed(2)} / '
+                  'сервер ${form.server.toStringAsFixed(2)} / '
+                  'каса ${form.till.toStringAsFixed(2)}',
+                  valueColor: Colors.orangeAccent,
+                ),
+              for (final tax in r.taxes.where((t) => !t.matches))
+                _buildInfoRow(
+                  'Група ${tax.group}',
+                  'ПРРО ${tax.device.toStringAsFixed(2)} / '
+                  'сервер ${tax.server.toStringAsFixed(2)}',
+                  valueColor: Colors.orangeAccent,
+                ),
+              if (r.deviceSales != r.serverSales ||
+                  r.serverSales != r.tillSales ||
+                  r.deviceRefunds != r.serverRefunds ||
+                  r.serverRefunds != r.tillRefunds)
+                _buildInfoRow(
+                  'Чеків (продаж/повернення)',
+                  'ПРРО ${r.deviceSales}/${r.deviceRefunds} · '
+                  'сервер ${r.serverSales}/${r.serverRefunds} · '
+                  'каса ${r.tillSales}/${r.tillRefunds}',
+                  valueColor: Colors.orangeAccent,
+                ),
+              if (r.cashCounted != null && r.cashCounted != r.cashExpected)
+                _buildInfoRow(
+                  'Готівка в шухляді',
+                  '${r.cashCounted!.toStringAsFixed(2)} з '
+                  '${r.cashExpected.toStringAsFixed(2)} грн',
+                  valueColor: Colors.orangeAccent,
+                ),
+              if (r.checks.isNotEmpty) ...[
+                const Divider(color: Colors.white24, height: 16),
+                for (final check in r.checks)
+                  _buildInfoRow(
+                    '${_discrepancyLabel(check.kind)} '
+                    '${check.number ?? check.rrn ?? ''}',
+                    _discrepancyAmounts(check),
+                    valueColor: Colors.orangeAccent,
+                  ),
+              ],
+            ],
+          ],
+        ),
+      ),
+    );
+  }
+
+  static String _discrepancyLabel(String kind) {
+    switch (kind) {
+      case 'missingOnServer':
+        return 'Немає на сервері';
+      case 'missingInArchive':
+        return 'Немає в касі';
+      case 'amountMismatch':
+        return 'Інша сума';
+      case 'formMismatch':
+        return 'Інша форма оплати';
+      case 'rrnMismatch':
+        return 'Інший RRN';
+      case 'duplicateNumber':
+        return 'Дубль номера';
+      case 'duplicateRrn':
+        return 'Дубль RRN';
+      default:
+        return kind;
+    }
+  }
+
+  static String _discrepancyAmounts(CheckDiscrepancy check) {
+    switch (check.kind) {
+      case 'missingOnServer':
+        return '${check.tillAmount.toStringAsFixed(2)} грн';
+      case 'formMismatch':
+        return 'сервер ${check.serverForm ?? '—'} / '
+            'каса ${check.tillForm ?? '—'}';
+      case 'rrnMismatch':
+        return check.rrn ?? '';
+      default:
+        return 'сервер ${check.serverAmount.toStringAsFixed(2)} / '
+            'каса ${check.tillAmount.toStringAsFixed(2)}';
+    }
+  }
+
   Widget _buildInfoRow(
     String label,
     String value, {
@@ -392,6 +544,33 @@ class _CloseShiftContentState extends State<_CloseShiftContent> {
           ),
         ];
 
+      case _CloseShiftStep.reconciling:
+        return [];
+
+      case _CloseShiftStep.mismatch:
+        return [
+          TextButton(
+            onPressed: () => Navigator.of(context).pop(),
+            child: const Text(
+              'Скасувати',
+              style: TextStyle(color: Colors.white),
+            ),
+          ),
+          TextButton(
+            onPressed: _reconcileAndClose,
+            child: const Text('Звірити ще раз'),
+          ),
+          ElevatedButton.icon(
+            onPressed: _closeShift,
+            icon: const Icon(Icons.lock_outline, color: Colors.white),
+            label: const Text(
+              'Закрити зміну попри розбіжності',
+              style: TextStyle(color: Colors.white),
+            ),
+            style: ElevatedButton.styleFrom(backgroundColor: Colors.orange),
+          ),
+        ];
+
       case _CloseShiftStep.closing:
         return [];
     }
@@ -414,6 +593,50 @@ class _CloseShiftContentState extends State<_CloseShiftContent> {
       return;
     }
 
+    _issueAmount = issueAmount;
+    await _reconcileAndClose();
+  }
+
+  /// Звіряє зміну через HomeBloc (ReconcileShiftEvent) і закриває її
+  /// одразу лише тоді, коли все зійшлося; інакше показує розбіжності.
+  Future<void> _reconcileAndClose() async {
+    if (!widget.rootContext.mounted) return;
+    setState(() {
+      _currentStep = _CloseShiftStep.reconciling;
+      _reconciliation = null;
+      _reconcileError = null;
+    });
+
+    final homeBloc = widget.rootContext.read<HomeBloc>();
+    // Підписка до події: перший стан після неї — loading без звірки.
+    final done = homeBloc.stream.firstWhere(
+      (s) => s.reconciliation != null || s.status == HomeStatus.error,
+    );
+    homeBloc.add(const ReconcileShiftEvent());
+    try {
+      final result = await done.timeout(const Duration(minutes: 2));
+      _reconciliation = result.reconciliation;
+      _reconcileError = result.reconciliation == null
+          ? result.errorMessage
+          : null;
+    } catch (e) {
+      _reconcileError = e.toString();
+    }
+    if (!mounted) return;
+
+    if (_reconciliation?.balanced == true) {
+      await _closeShift();
+      return;
+    }
+    debugPrint(
+      '⚠️ [CLOSE_SHIFT_DIALOG] Зміна не зійшлася: '
+      '${_reconcileError ?? '${_reconciliation!.checks.length} чеків'}',
+    );
+    setState(() => _currentStep = _CloseShiftStep.mismatch);
+  }
+
+  Future<void> _closeShift() async {
+    final issueAmount = _issueAmount;
     try {
       // Показуємо стан закриття
       setState(() {
@@ -0,0 +1,114 @@
+import 'package:flutter/material.dart';
+import 'package:flutter_bloc/flutter_bloc.dart';
+import 'package:intl/intl.dart';
+import '../../../../core/services/parking/native_parked_carts.dart';
+import '../bloc/home_bloc.dart';
+
+/// Відкладені чеки касира: список із пам'яті раннера і відновлення
+/// вибраного в кошик.
+///
+/// [rootContext] must be a context that is under the [HomeBloc] provider.
+Future<void> showParkedCartsDialog(BuildContext rootContext) async {
+  final homeBloc = rootContext.read<HomeBloc>();
+  homeBloc.add(const LoadParkedCarts());
+  await showDialog(
+    context: rootContext,
+    builder: (ctx) {
+      return BlocProvider.value(
+        value: homeBloc,
+        child: BlocBuilder<HomeBloc, HomeViewState>(
+          buildWhen: (prev, curr) => prev.parkedCarts != curr.parkedCarts,
+          builder: (context, state) {
+            return AlertDialog(
+              backgroundColor: const Color(0xFF2A2A2A),
+              title: const Text(
+                'Відкладені чеки',
+                style: TextStyle(color: Colors.white),
+              ),
+              content: SizedBox(
+                width: 450,
+                child: state.parkedCarts.isEmpty
+                    ? const Text(
+                        'Відкладених чеків немає',
+                        style: TextStyle(color: Colors.white70),
+                      )
+                    : ListView.separated(
+                        shrinkWrap: true,
+                        itemCount: state.parkedCarts.length,
+                        separatorBuilder: (_, __) =>
+                            const Divider(color: Colors.white24, height: 1),
+                        itemBuilder: (context, index) => _ParkedCartTile(
+                          cart: state.parkedCarts[index],
+                          onResume: () {
+                            Navigator.of(ctx).pop();
+                            homeBloc.add(
+                              ResumeParkedCart(state.parkedCarts[index].id),
+                            );
+                          },
+                        ),
+                      ),
+              ),
+              actions: [
+                TextButton(
+                  onPressed: () => Navigator.of(ctx).pop(),
+                  child: const Text(
+                    'Закрити',
+                    style: TextStyle(color: Colors.white),
+                  ),
+                ),
+              ],
+            );
+          },
+        ),
+      );
+    },
+  );
+}
+
+class _ParkedCartTile extends StatelessWidget {
+  final ParkedCart cart;
+  final VoidCallback onResume;
+
+  const _ParkedCartTile({required this.cart, required this.onResume});
+
+  @override
+  Widget build(BuildContext context) {
+    final subtitle = [
+      '${cart.lineCount} поз.',
+      if (cart.paymentForm.isNotEmpty) cart.paymentForm,
+    ].join(' · ');
+    return ListTile(
+      contentPadding: EdgeInsets.zero,
+      leading: const Icon(Icons.pause_circle_outline, color: Colors.white54),
+      title: Text(
+        DateFormat('dd.MM HH:mm').format(cart.parkedAt),
+        style: const TextStyle(color: Colors.white),
+      ),
+      subtitle: Text(
+        subtitle,
+        style: const TextStyle(color: Colors.white54, fontSize: 12),
+      ),
+      trailing: Row(
+        mainAxisSize: MainAxisSize.min,
+        children: [
+          Text(
+            '${cart.total.toStringAsFixed(2)} грн',
+            style: const TextStyle(
+              color: Colors.white,
+              fontWeight: FontWeight.bold,
+            ),
+          ),
+          const SizedBox(width: 12),
+          ElevatedButton(
+            onPressed: onResume,
+            style: ElevatedButton.styleFrom(backgroundColor: Colors.grey[300]),
+            child: const Text(
+              'Відновити',
+              style: TextStyle(color: Colors.black),
+            ),
+          ),
+        ],
+      ),
+    );
+  }
+}
@@ -0,0 +1,94 @@
+import 'package:flutter/material.dart';
+import 'package:flutter_bloc/flutter_bloc.dart';
+import '../bloc/home_bloc.dart';
+
+/// Оплата карткою на терміналі: етап з `terminalState`, поки драйвер
+/// термінала веде оплату. Діалог закривається сам, щойно етап скинуто
+/// (оплату схвалено або відхилено).
+///
+/// [rootContext] must be a context that is under the [HomeBloc] provider.
+Future<void> showTerminalPaymentDialog(BuildContext rootContext) async {
+  final homeBloc = rootContext.read<HomeBloc>();
+  var closed = false;
+  void close(BuildContext ctx) {
+    if (closed) return;
+    closed = true;
+    Navigator.of(ctx).pop();
+  }
+
+  await showDialog(
+    context: rootContext,
+    barrierDismissible: false,
+    builder: (ctx) {
+      return BlocProvider.value(
+        value: homeBloc,
+        child: BlocConsumer<HomeBloc, HomeViewState>(
+          listenWhen: (prev, curr) =>
+              prev.terminalState != null && curr.terminalState == null,
+          listener: (context, state) => close(ctx),
+          buildWhen: (prev, curr) =>
+              curr.terminalState != null &&
+              prev.terminalState != curr.terminalState,
+          builder: (context, state) {
+            final stage = state.terminalState;
+            if (stage == null) {
+              // Оплата завершилася раніше, ніж діалог устиг підписатися
+              WidgetsBinding.instance.addPostFrameCallback((_) => close(ctx));
+            }
+            return AlertDialog(
+              backgroundColor: const Color(0xFF2A2A2A),
+              title: const Row(
+                children: [
+                  Icon(Icons.credit_card, color: Colors.blue),
+                  SizedBox(width: 8),
+                  Text(
+                    'Оплата карткою',
+                    style: TextStyle(color: Colors.white),
+                  ),
+                ],
+              ),
+              content: SizedBox(
+                width: 360,
+                height: 100,
+                child: Center(
+                  child: Column(
+                    mainAxisSize: MainAxisSize.min,
+                    children: [
+                      const CircularProgressIndicator(color: Colors.white),
+                      const SizedBox(height: 16),
+                      Text(
+                        terminalStageLabel(stage),
+                        textAlign: TextAlign.center,
+                        style: const TextStyle(color: Colors.white70),
+                      ),
+                    ],
+                  ),
+                ),
+              ),
+            );
+          },
+        ),
+      );
+    },
+  );
+}
+
+/// Етап оплати (msgType термінала) для касира.
+String terminalStageLabel(String? stage) {
+  switch (stage) {
+    case null:
+    case 'awaitingCard':
+      return 'Прикладіть або вставте картку';
+    case 'cardTapped':
+    case 'cardInserted':
+    case 'cardSwiped':
+    case 'cardRead':
+      return 'Картку зчитано';
+    case 'pinEntry':
+      return 'Покупець вводить PIN';
+    case 'online':
+      return 'Авторизація в банку...';
+    default:
+      return stage;
+  }
+}
@@ -159,7 +159,8 @@ class _XReportDialogState extends State<XReportDialog> {
 
     try {
       await rawPrinterService.printVisualization(
-        visualizationBase64: widget.reportData.visualization!,
+        visualizationBase64: widget.reportData.visualization,
+        printData: widget.reportData.printData,
       );
 
       if (!mounted) return;
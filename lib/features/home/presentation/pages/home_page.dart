@@ -3,6 +3,7 @@ import 'package:flutter_bloc/flutter_bloc.dart';
 import 'package:get_it/get_it.dart';
 import '../../../../core/services/storage/storage_service.dart';
 import '../../../../core/services/prro/prro_service.dart';
+import '../../../../core/services/startup/native_startup.dart';
 import '../bloc/home_bloc.dart';
 import '../widgets/navigation/sidebar_navigation.dart';
 import '../widgets/pages/page_content.dart';
@@ -17,6 +18,7 @@ import '../../../../core/widgets/notificarion_toast/view.dart';
 import '../dialogs/close_prev_shift_dialog.dart';
 import '../dialogs/vchasno_error_dialog.dart';
 import '../dialogs/order_success_dialog.dart';
+import '../dialogs/terminal_payment_dialog.dart';
 import '../dialogs/x_report_dialog.dart';
 import '../../../login/presentation/pages/login_page.dart';
 
@@ -30,6 +32,15 @@ class HomePage extends StatefulWidget {
 class _HomePageState extends State<HomePage> {
   bool _openShiftPromptShown = false;
 
+  @override
+  void initState() {
+    super.initState();
+    // Перший кадр головного екрана — каса готова до роботи (time-to-interactive)
+    WidgetsBinding.instance.addPostFrameCallback(
+      (_) => NativeStartup.markInteractive(),
+    );
+  }
+
   @override
   Widget build(BuildContext context) {
     return BlocProvider(
@@ -66,6 +77,27 @@ class _HomePageState extends State<HomePage> {
               });
             },
           ),
+          // 3. Оплата на терміналі почалася (terminalState: null -> етап)
+          BlocListener<HomeBloc, HomeViewState>(
+            listenWhen: (prev, curr) =>
+                prev.terminalState == null && curr.terminalState != null,
+            listener: (context, state) => showTerminalPaymentDialog(context),
+          ),
+          // 4. Відновлений відкладений чек, у якому змінилися ціни
+          BlocListener<HomeBloc, HomeViewState>(
+            listenWhen: (prev, curr) =>
+                prev.repricedItems != curr.repricedItems &&
+                curr.repricedItems.isNotEmpty,
+            listener: (context, state) {
+              ToastManager.show(
+                context,
+                type: ToastType.warning,
+                title: 'Ціни змінилися, поки чек був відкладений',
+                message: state.repricedItems.join(', '),
+                duration: const Duration(seconds: 6),
+              );
+            },
+          ),
         ],
         child: BlocBuilder<HomeBloc, HomeViewState>(
           builder: (context, state) {
@@ -10,6 +10,7 @@ class CartItemsList extends StatelessWidget {
   @override
   Widget build(BuildContext context) {
     final cart = context.select((HomeBloc b) => b.state.cart);
+    final weighing = context.select((HomeBloc b) => b.state.weighingItem);
     return Container(
       padding: const EdgeInsets.all(20),
       child: Column(
@@ -27,6 +28,10 @@ class CartItemsList extends StatelessWidget {
             ],
           ),
           const SizedBox(height: 20),
+          if (weighing != null) ...[
+            _WeighingBanner(item: weighing),
+            const SizedBox(height: 12),
+          ],
           Expanded(
             child: cart.isEmpty
                 ? Center(
@@ -65,6 +70,43 @@ class CartItemsList extends StatelessWidget {
   }
 }
 
+/// Ваговий товар чекає, поки маса на вагах встановиться.
+class _WeighingBanner extends StatelessWidget {
+  final CartItem item;
+
+  const _WeighingBanner({required this.item});
+
+  @override
+  Widget build(BuildContext context) {
+    return Container(
+      padding: const EdgeInsets.symmetric(horizontal: 12, vertical: 8),
+      decoration: BoxDecoration(
+        color: Colors.blue.withOpacity(0.1),
+        borderRadius: BorderRadius.circular(8),
+        border: Border.all(color: Colors.blue.withOpacity(0.3)),
+      ),
+      child: Row(
+        children: [
+          const Icon(Icons.scale, color: Colors.blue, size: 20),
+          const SizedBox(width: 8),
+          Expanded(
+            child: Text(
+              'Покладіть на ваги: ${item.name}',
+              style: const TextStyle(color: Colors.white, fontSize: 13),
+              overflow: TextOverflow.ellipsis,
+            ),
+          ),
+          TextButton(
+            onPressed: () =>
+                context.read<HomeBloc>().add(const CancelWeighing()),
+            child: const Text('Скасувати'),
+          ),
+        ],
+      ),
+    );
+  }
+}
+
 class _CartItemWidget extends StatefulWidget {
   final CartItem item;
 
@@ -125,108 +167,125 @@ class _CartItemWidgetState extends State<_CartItemWidget> {
                 '${widget.item.price.toStringAsFixed(2)} грн',
                 style: const TextStyle(color: Colors.white70, fontSize: 12),
               ),
+              if (widget.item.discount > 0)
+                Text(
+                  'Знижка −${widget.item.discount.toStringAsFixed(2)} грн',
+                  style: const TextStyle(color: Colors.greenAccent, fontSize: 12),
+                ),
             ],
           ),
         ),
         const SizedBox(width: 8),
-        // Кнопка мінус
-        IconButton(
-          onPressed: () {
-            final newQuantity = widget.item.quantity - 1;
-            context.read<HomeBloc>().add(
-              UpdateCartItemQuantity(
-                guid: widget.item.guid,
-                quantity: newQuantity,
-              ),
-            );
-            _quantityController.text = newQuantity.toString();
-          },
-          icon: const Icon(Icons.remove, color: Colors.white70, size: 18),
-          tooltip: 'Зменшити кількість',
-          padding: EdgeInsets.zero,
-          constraints: const BoxConstraints(minWidth: 32, minHeight: 32),
-        ),
-        // Поле для введення кількості
-        Container(
-          width: 50,
-          height: 32,
-          decoration: BoxDecoration(
-            color: Colors.transparent,
-            borderRadius: BorderRadius.circular(4),
-            border: Border.all(color: Colors.transparent),
-            // border: Border.all(color: Colors.white.withOpacity(0.2)),
-          ),
-          child: TextField(
-            controller: _quantityController,
-            textAlign: TextAlign.center,
-
-            style: const TextStyle(color: Colors.white, fontSize: 14),
-            keyboardType: TextInputType.number,
-            decoration: InputDecoration(
-              focusedBorder: OutlineInputBorder(
-                borderSide: BorderSide(width: 0, color: Colors.transparent),
-              ),
-              disabledBorder: OutlineInputBorder(
-                borderSide: BorderSide(width: 0, color: Colors.transparent),
-              ),
-              enabledBorder: OutlineInputBorder(
-                borderSide: BorderSide(width: 0, color: Colors.transparent),
-              ),
-              border: OutlineInputBorder(
-                borderSide: BorderSide(width: 0, color: Colors.transparent),
-              ),
-              contentPadding: EdgeInsets.symmetric(vertical: 0),
+        if (widget.item.isWeighed)
+          // Маса з ваг: змінити її можна лише перезважуванням
+          SizedBox(
+            width: 114,
+            child: Text(
+              '${widget.item.weight.toStringAsFixed(3)} кг',
+              textAlign: TextAlign.center,
+              style: const TextStyle(color: Colors.white, fontSize: 14),
             ),
-            inputFormatters: [
-              FilteringTextInputFormatter.digitsOnly, // ← тільки цифри
-            ],
-            focusNode: _quantityFocusNode,
-            onChanged: (value) {
-              final quantity = int.tryParse(value) ?? 1;
+          )
+        else ...[
+          // Кнопка мінус
+          IconButton(
+            onPressed: () {
+              final newQuantity = widget.item.quantity - 1;
               context.read<HomeBloc>().add(
                 UpdateCartItemQuantity(
                   guid: widget.item.guid,
-                  quantity: quantity,
+                  quantity: newQuantity,
                 ),
               );
+              _quantityController.text = newQuantity.toString();
             },
-            onSubmitted: (value) {
-              final quantity = int.tryParse(value) ?? 1;
-              context.read<HomeBloc>().add(
-                UpdateCartItemQuantity(
-                  guid: widget.item.guid,
-                  quantity: quantity,
+            icon: const Icon(Icons.remove, color: Colors.white70, size: 18),
+            tooltip: 'Зменшити кількість',
+            padding: EdgeInsets.zero,
+            constraints: const BoxConstraints(minWidth: 32, minHeight: 32),
+          ),
+          // Поле для введення кількості
+          Container(
+            width: 50,
+            height: 32,
+            decoration: BoxDecoration(
+              color: Colors.transparent,
+              borderRadius: BorderRadius.circular(4),
+              border: Border.all(color: Colors.transparent),
+              // border: Border.all(color: Colors.white.withOpacity(0.2)),
+            ),
+            child: TextField(
+              controller: _quantityController,
+              textAlign: TextAlign.center,
+
+              style: const TextStyle(color: Colors.white, fontSize: 14),
+              keyboardType: TextInputType.number,
+              decoration: InputDecoration(
+                focusedBorder: OutlineInputBorder(
+                  borderSide: BorderSide(width: 0, color: Colors.transparent),
                 ),
-              );
-            },
-            onEditingComplete: () {
-              final quantity = int.tryParse(_quantityController.text) ?? 1;
+                disabledBorder: OutlineInputBorder(
+                  borderSide: BorderSide(width: 0, color: Colors.transparent),
+                ),
+                enabledBorder: OutlineInputBorder(
+                  borderSide: BorderSide(width: 0, color: Colors.transparent),
+                ),
+                border: OutlineInputBorder(
+                  borderSide: BorderSide(width: 0, color: Colors.transparent),
+                ),
+                contentPadding: EdgeInsets.symmetric(vertical: 0),
+              ),
+              inputFormatters: [
+                FilteringTextInputFormatter.digitsOnly, // ← тільки цифри
+              ],
+              focusNode: _quantityFocusNode,
+              onChanged: (value) {
+                final quantity = int.tryParse(value) ?? 1;
+                context.read<HomeBloc>().add(
+                  UpdateCartItemQuantity(
+                    guid: widget.item.guid,
+                    quantity: quantity,
+                  ),
+                );
+              },
+              onSubmitted: (value) {
+                final quantity = int.tryParse(value) ?? 1;
+                context.read<HomeBloc>().add(
+                  UpdateCartItemQuantity(
+                    guid: widget.item.guid,
+                    quantity: quantity,
+                  ),
+                );
+              },
+              onEditingComplete: () {
+                final quantity = int.tryParse(_quantityController.text) ?? 1;
+                context.read<HomeBloc>().add(
+                  UpdateCartItemQuantity(
+                    guid: widget.item.guid,
+                    quantity: quantity,
+                  ),
+                );
+              },
+            ),
+          ),
+          // Кнопка плюс
+          IconButton(
+            onPressed: () {
+              final newQuantity = widget.item.quantity + 1;
               context.read<HomeBloc>().add(
                 UpdateCartItemQuantity(
                   guid: widget.item.guid,
-                  quantity: quantity,
+                  quantity: newQuantity,
                 ),
               );
+              _quantityController.text = newQuantity.toString();
             },
+            icon: const Icon(Icons.add, color: Colors.white70, size: 18),
+            tooltip: 'Збільшити кількість',
+            padding: EdgeInsets.zero,
+            constraints: const BoxConstraints(minWidth: 32, minHeight: 32),
           ),
-        ),
-        // Кнопка плюс
-        IconButton(
-          onPressed: () {
-            final newQuantity = widget.item.quantity + 1;
-            context.read<HomeBloc>().add(
-              UpdateCartItemQuantity(
-                guid: widget.item.guid,
-                quantity: newQuantity,
-              ),
-            );
-            _quantityController.text = newQuantity.toString();
-          },
-          icon: const Icon(Icons.add, color: Colors.white70, size: 18),
-          tooltip: 'Збільшити кількість',
-          padding: EdgeInsets.zero,
-          constraints: const BoxConstraints(minWidth: 32, minHeight: 32),
-        ),
+        ],
         const SizedBox(width: 8),
         // Кнопка видалення
         IconButton(
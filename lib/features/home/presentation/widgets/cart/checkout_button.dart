@@ -1,6 +1,7 @@
 import 'package:flutter/material.dart';
 import 'package:flutter_bloc/flutter_bloc.dart';
 import '../../bloc/home_bloc.dart';
+import '../../dialogs/parked_carts_dialog.dart';
 import '../../../../../core/widgets/notificarion_toast/view.dart';
 
 class CheckoutButton extends StatelessWidget {
@@ -50,25 +51,45 @@ class CheckoutButton extends StatelessWidget {
 
         Expanded(
           flex: 3,
-          child: SizedBox(
-            width: double.infinity,
-            height: 50,
-            child: ElevatedButton(
-              onPressed: () {
-                _processPutOffCheck(context);
-              },
-              style: ElevatedButton.styleFrom(
-                foregroundColor: const Color(0xFF4A4A4A),
-                backgroundColor: Colors.white,
-                shape: RoundedRectangleBorder(
-                  borderRadius: BorderRadius.circular(8),
+          child: BlocBuilder<HomeBloc, HomeViewState>(
+            buildWhen: (prev, curr) =>
+                prev.cart.isEmpty != curr.cart.isEmpty ||
+                prev.parkedCarts.length != curr.parkedCarts.length,
+            builder: (context, state) {
+              // Порожній кошик — замість відкладання список відкладених
+              final showParked = state.cart.isEmpty;
+              return SizedBox(
+                width: double.infinity,
+                height: 50,
+                child: ElevatedButton(
+                  onPressed: () {
+                    if (showParked) {
+                      showParkedCartsDialog(context);
+                    } else {
+                      _processPutOffCheck(context);
+                    }
+                  },
+                  style: ElevatedButton.styleFrom(
+                    foregroundColor: const Color(0xFF4A4A4A),
+                    backgroundColor: Colors.white,
+                    shape: RoundedRectangleBorder(
+                      borderRadius: BorderRadius.circular(8),
+                    ),
+                  ),
+                  child: Text(
+                    !showParked
+                        ? 'Відкласти'
+                        : state.parkedCarts.isEmpty
+                        ? 'Відкладені'
+                        : 'Відкладені (${state.parkedCarts.length})',
+                    style: const TextStyle(
+                      fontSize: 16,
+                      fontWeight: FontWeight.bold,
+                    ),
+                  ),
                 ),
-              ),
-              child: const Text(
-                'Відкласти',
-                style: TextStyle(fontSize: 16, fontWeight: FontWeight.bold),
-              ),
-            ),
+              );
+            },
           ),
         ),
       ],
@@ -7,6 +7,7 @@ import '../../../data/models/category_model.dart';
 import 'package:flutter_bloc/flutter_bloc.dart';
 import '../../bloc/home_bloc.dart';
 import '../../../../../core/widgets/notificarion_toast/view.dart';
+import '../../../../../core/services/scale/native_scale_service.dart';
 
 class CategoriesGrid extends StatefulWidget {
   const CategoriesGrid({super.key});
@@ -122,14 +123,29 @@ class _CategoriesGridState extends State<CategoriesGrid> {
       _loadCategories();
     } else {
       // Клік по товару - додаємо до кошика або показуємо деталі
-      context.read<HomeBloc>().add(
+      final weighed = isWeighedUnit(category.unitName);
+      final bloc = context.read<HomeBloc>();
+      bloc.add(
         AddToCart(
           guid: category.id,
           name: category.name,
           article: category.article ?? '',
           price: category.price,
+          category: category.parentId ?? _currentCategory?.id ?? '',
+          weighed: weighed,
         ),
       );
+      if (weighed && (bloc.scaleService?.isRunning ?? false)) {
+        ToastManager.show(
+          context,
+          type: ToastType.info,
+          title: "Покладіть товар на ваги",
+          message: "\"${category.name}\" додасться з масою, щойно вона "
+              "встановиться",
+          position: ToastPosition.bottomLeft,
+        );
+        return;
+      }
       ToastManager.show(
         context,
         type: ToastType.info,
@@ -1,5 +1,6 @@
 import 'package:flutter/material.dart';
 import 'package:get_it/get_it.dart';
+import '../../../../../core/services/search/native_search_service.dart';
 import '../../../../nomenclatura/domain/usecases/search_nomenclatura.dart';
 
 class SearchBarWidget extends StatefulWidget {
@@ -15,19 +16,56 @@ class SearchBarWidget extends StatefulWidget {
 class _SearchBarWidgetState extends State<SearchBarWidget> {
   final TextEditingController _searchController = TextEditingController();
   bool _isSearching = false;
+  NativeSearchSession? _session;
+
+  @override
+  void initState() {
+    super.initState();
+    GetIt.instance<NativeSearchService>().openSession().then((session) {
+      if (!mounted) {
+        session?.close();
+        return;
+      }
+      _session = session;
+    });
+  }
 
   @override
   void dispose() {
+    _session?.close();
     _searchController.dispose();
     super.dispose();
   }
 
+  /// Нативна сесія: кожне натискання звужує попередні результати,
+  /// тому запит іде одразу, без дебаунсу.
+  Future<void> _performNativeSearch(
+    NativeSearchSession session,
+    String query,
+  ) async {
+    try {
+      final results = await session.update(query.trim().toLowerCase());
+      // null — відповідь застаріла, вже надруковано наступний символ
+      if (results == null || !mounted) return;
+      widget.onSearchResults?.call(results);
+    } catch (e) {
+      widget.onSearchResults?.call([]);
+    }
+  }
+
   Future<void> _performSearch(String query) async {
     if (query.trim().isEmpty) {
+      _session?.update('');
       widget.onClearSearch?.call();
       return;
     }
 
+    final session = _session;
+    if (session != null) {
+      await _performNativeSearch(session, query);
+      return;
+    }
+
     setState(() {
       _isSearching = true;
     });
@@ -50,14 +88,21 @@ class _SearchBarWidgetState extends State<SearchBarWidget> {
       // Обробка помилок
       widget.onSearchResults?.call([]);
     } finally {
-      setState(() {
-        _isSearching = false;
-      });
+      if (mounted) {
+        setState(() {
+          _isSearching = false;
+        });
+      }
     }
   }
 
   void _onSearchChanged(String value) {
-    // Дебаунс для уникнення занадто частих запитів
+    if (_session != null) {
+      _performSearch(value);
+      return;
+    }
+
+    // Без нативної сесії кожен запит — повний пошук, тому лишаємо дебаунс
     Future.delayed(const Duration(milliseconds: 300), () {
       if (_searchController.text == value) {
         _performSearch(value);
@@ -67,6 +112,7 @@ class _SearchBarWidgetState extends State<SearchBarWidget> {
 
   void _clearSearch() {
     _searchController.clear();
+    _session?.update('');
     widget.onClearSearch?.call();
   }
 
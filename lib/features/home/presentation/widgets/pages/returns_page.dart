@@ -1,7 +1,11 @@
+import 'dart:async';
+
 import 'package:flutter/material.dart';
 import 'package:flutter_bloc/flutter_bloc.dart';
 import 'package:get_it/get_it.dart';
 import '../../../../../core/models/cashalot_models.dart';
+import '../../../../../core/services/scanner/native_scanner_service.dart';
+import '../../../../../core/services/search/native_search_service.dart';
 import '../../../../../core/widgets/notificarion_toast/view.dart';
 import '../../../../../features/nomenclatura/domain/entities/nomenclatura.dart';
 import '../../../../../features/nomenclatura/domain/usecases/search_nomenclatura.dart';
@@ -31,9 +35,30 @@ class _ReturnsPageState extends State<ReturnsPage> {
   bool _showSearchResults = false;
   List<Nomenclatura> _searchResults = [];
   List<ReturnItem> _returnItems = [];
+  NativeSearchSession? _searchSession;
+  StreamSubscription<String>? _scannerSubscription;
+
+  @override
+  void initState() {
+    super.initState();
+    // Сканер більше не друкує код у поле: підставляємо його самі
+    if (GetIt.instance.isRegistered<NativeScannerService>()) {
+      _scannerSubscription = GetIt.instance<NativeScannerService>().barcodes
+          .listen(_onBarcodeScanned);
+    }
+    GetIt.instance<NativeSearchService>().openSession().then((session) {
+      if (!mounted) {
+        session?.close();
+        return;
+      }
+      _searchSession = session;
+    });
+  }
 
   @override
   void dispose() {
+    _scannerSubscription?.cancel();
+    _searchSession?.close();
     _fiscalNumberController.dispose();
     _rrnController.dispose();
     _barcodeController.dispose();
@@ -44,8 +69,15 @@ class _ReturnsPageState extends State<ReturnsPage> {
     super.dispose();
   }
 
+  void _onBarcodeScanned(String barcode) {
+    if (!mounted) return;
+    setState(() => _barcodeController.text = barcode);
+    _performSearch(barcode);
+  }
+
   Future<void> _performSearch(String query) async {
     if (query.trim().isEmpty) {
+      _searchSession?.update('');
       setState(() {
         _searchResults = [];
         _showSearchResults = false;
@@ -53,6 +85,29 @@ class _ReturnsPageState extends State<ReturnsPage> {
       return;
     }
 
+    // Нативна сесія звужує попередні результати — без дебаунсу і спінера
+    final session = _searchSession;
+    if (session != null) {
+      try {
+        final results = await session.update(
+          query.trim().toLowerCase(),
+          limit: _maxSearchResults,
+        );
+        if (results == null || !mounted) return;
+        setState(() {
+          _searchResults = results;
+          _showSearchResults = _searchResults.isNotEmpty;
+        });
+      } catch (e) {
+        if (!mounted) return;
+        setState(() {
+          _searchResults = [];
+          _showSearchResults = false;
+        });
+      }
+      return;
+    }
+
     setState(() => _isSearching = true);
 
     try {
@@ -87,7 +142,12 @@ class _ReturnsPageState extends State<ReturnsPage> {
   }
 
   void _onSearchChanged(String value) {
-    // Дебаунс для уникнення занадто частих запитів
+    if (_searchSession != null) {
+      _performSearch(value);
+      return;
+    }
+
+    // Без нативної сесії кожен запит — повний пошук, тому лишаємо дебаунс
     Future.delayed(const Duration(milliseconds: 300), () {
       if (_barcodeController.text == value) {
         _performSearch(value);
@@ -616,42 +616,46 @@ class _ShiftManagementPageState extends State<ShiftManagementPage> {
   }
 
   Future<void> _showPrroStateDialog(BuildContext context) async {
+    final cashalotService = GetIt.instance<CashalotComService>();
+    // Використовуємо фіскальний номер ПРРО (можна отримати з налаштувань)
+    const prroFiscalNum = 4000944684; // TODO: отримати з налаштувань
+    // Стан з нативного кешу (оновлюється у фоні) показуємо одразу.
+    final cached = cashalotService.cachedPrroState(prroFiscalNum);
+
     // Показуємо діалог із завантаженням
-    showDialog(
-      context: context,
-      barrierDismissible: false,
-      builder: (ctx) => const AlertDialog(
-        backgroundColor: Color(0xFF2A2A2A),
-        content: SizedBox(
-          height: 100,
-          child: Center(
-            child: Column(
-              mainAxisSize: MainAxisSize.min,
-              children: [
-                CircularProgressIndicator(color: Colors.white),
-                SizedBox(height: 16),
-                Text(
-                  'Перевірка стану ПРРО...',
-                  style: TextStyle(color: Colors.white70),
-                ),
-              ],
+    if (cached == null) {
+      showDialog(
+        context: context,
+        barrierDismissible: false,
+        builder: (ctx) => const AlertDialog(
+          backgroundColor: Color(0xFF2A2A2A),
+          content: SizedBox(
+            height: 100,
+            child: Center(
+              child: Column(
+                mainAxisSize: MainAxisSize.min,
+                children: [
+                  CircularProgressIndicator(color: Colors.white),
+                  SizedBox(height: 16),
+                  Text(
+                    'Перевірка стану ПРРО...',
+                    style: TextStyle(color: Colors.white70),
+                  ),
+                ],
+              ),
             ),
           ),
         ),
-      ),
-    );
+      );
+    }
 
     try {
-      final cashalotService = GetIt.instance<CashalotComService>();
-      // Використовуємо фіскальний номер ПРРО (можна отримати з налаштувань)
-      const prroFiscalNum = 4000944684; // TODO: отримати з налаштувань
-
-      final response = await cashalotService.getPrroState(
-        prroFiscalNum: prroFiscalNum,
-      );
+      final response =
+          cached ??
+          await cashalotService.getPrroState(prroFiscalNum: prroFiscalNum);
 
       // Закриваємо діалог завантаження
-      if (context.mounted) {
+      if (cached == null && context.mounted) {
         Navigator.of(context).pop();
       }
 
@@ -842,7 +846,7 @@ class _ShiftManagementPageState extends State<ShiftManagementPage> {
       }
     } catch (e) {
       // Закриваємо діалог завантаження
-      if (context.mounted) {
+      if (cached == null && context.mounted) {
         Navigator.of(context).pop();
       }
 
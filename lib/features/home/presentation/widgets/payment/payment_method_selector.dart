@@ -40,7 +40,7 @@ class _PaymentMethodSelectorState extends State<PaymentMethodSelector> {
       crossAxisAlignment: CrossAxisAlignment.start,
       children: [
         Text(
-          'До сплати ${context.select((HomeBloc b) => b.state.cart.fold(0.0, (sum, item) => sum + item.price * item.quantity)).toStringAsFixed(2)} грн',
+          'До сплати ${context.select((HomeBloc b) => b.state.cart.fold(0.0, (sum, item) => sum + item.total)).toStringAsFixed(2)} грн',
           style: TextStyle(
             color: Colors.white,
             fontSize: 16,
@@ -1,11 +1,48 @@
+import 'dart:typed_data';
+
 import 'package:sqflite/sqflite.dart';
 import 'package:path/path.dart';
 import '../models/nomenclatura_model.dart';
 import '../../../../core/error/failures.dart';
+import '../../../../core/services/printing/native_label_printer.dart';
+import '../../../../core/services/store/compact_catalogue.dart';
+import '../../../../core/services/store/native_catalogue_store.dart';
 
 abstract class NomenclaturaLocalDataSource {
   Future<void> cacheNomenclatura(List<NomenclaturaModel> nomenclaturas);
   Future<void> forceCacheNomenclatura(List<NomenclaturaModel> nomenclaturas);
+
+  /// Кешує каталог з файлу .vkc (стовпцевий формат передачі) без розбору
+  /// в Dart. Повертає кількість змінених рядків або null, якщо нативного
+  /// сховища немає — тоді викликач синхронізується через JSON.
+  Future<int?> importPackedNomenclatura(
+    Uint8List bytes, {
+    bool replace = false,
+  });
+
+  /// Обслуговування бази у простої каси (checkpoint WAL, повернення
+  /// вільних сторінок). null — нативного сховища немає.
+  Future<Map<String, int>?> maintainStore({int vacuumPages = 256});
+
+  /// Каталог у нативній пам'яті з ручками товарів замість моделей — для
+  /// кас з малим обсягом RAM. Після першого виклику пошук за GUID
+  /// обслуговується з нього, а після запису в кеш він перебудовується.
+  /// null — нативного сховища немає.
+  Future<CompactCatalogue?> getCompactCatalogue();
+
+  /// Знімок цін перед синхронізацією для [printPriceLabels]. null —
+  /// нативного сховища немає.
+  Future<PriceSnapshot?> snapshotPrices();
+
+  /// Друкує на мережевому принтері цінники товарів, ціна яких змінилась
+  /// після [before]. Повертає кількість цінників або null, якщо
+  /// нативного сховища немає чи друк не вдався.
+  Future<int?> printPriceLabels(
+    PriceSnapshot before, {
+    required String host,
+    int port = 9100,
+    int width = 32,
+  });
   Future<List<NomenclaturaModel>> getCachedNomenclatura();
   Future<NomenclaturaModel?> getCachedNomenclaturaByGuid(String guid);
   Future<List<NomenclaturaModel>> searchCachedNomenclatura(String query);
@@ -13,6 +50,17 @@ abstract class NomenclaturaLocalDataSource {
   /// Пошук товару за штрихкодом
   Future<NomenclaturaModel?> searchByBarcode(String barcode);
 
+  /// Товари за списком GUID у тому ж порядку (відсутні пропускаються)
+  Future<List<NomenclaturaModel>> getCachedNomenclaturaByGuids(
+    List<String> guids,
+  );
+
+  /// Ключі пошуку (guid -> search_name) для нативного індексу,
+  /// у порядку відображення (ORDER BY name), без папок; groups —
+  /// parent_guid товару (порожній — без категорії)
+  Future<({List<String> guids, List<String> keys, List<String> groups})>
+      getSearchKeys();
+
   /// Отримує кореневі категорії (isFolder = true і parent_guid = null)
   Future<List<NomenclaturaModel>> getCachedCategories();
 
@@ -24,8 +72,73 @@ abstract class NomenclaturaLocalDataSource {
 }
 
 class NomenclaturaLocalDataSourceImpl implements NomenclaturaLocalDataSource {
+  static const _insertSql = '''
+    INSERT OR REPLACE INTO nomenclatura
+    (guid, created_at, name, article, unit_name, unit_guid, is_folder, parent_guid, description, barcodes, price, search_name)
+    VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+  ''';
+
   Database? _database;
 
+  /// Нативне сховище (WAL + пул читачів): пошук не чекає за записом
+  /// синхронізації. Якщо воно відкрилося, sqflite для цієї бази не
+  /// відкривається зовсім.
+  Future<NativeCatalogueStore?>? _storeOpening;
+
+  Future<NativeCatalogueStore?> get _nativeStore {
+    return _storeOpening ??= () async {
+      final path = join(await getDatabasesPath(), 'nomenclatura.db');
+      return NativeCatalogueStore.open(path);
+    }();
+  }
+
+  /// Компактний каталог (див. [getCompactCatalogue]): [_compact] —
+  /// побудова, [_compactReady] — вже побудований знімок таблиці. Обидва
+  /// скидаються після кожного запису в nomenclatura.
+  Future<CompactCatalogue?>? _compact;
+  CompactCatalogue? _compactReady;
+  bool _compactWanted = false;
+
+  void _invalidateCompact() {
+    _compact = null;
+    _compactReady = null;
+  }
+
+  /// Побудований компактний каталог або null; якщо його скинув запис,
+  /// у фоні будується новий, а поки відповідає SQLite.
+  CompactCatalogue? get _readyCompact {
+    if (_compactReady == null && _compactWanted && _compact == null) {
+      getCompactCatalogue();
+    }
+    return _compactReady;
+  }
+
+  /// SELECT через нативне сховище або sqflite.
+  Future<List<Map<String, Object?>>> _select(
+    String sql, [
+    List<Object?> args = const [],
+  ]) async {
+    final store = await _nativeStore;
+    if (store != null) return store.rawQuery(sql, args);
+    final db = await database;
+    return db.rawQuery(sql, args);
+  }
+
+  List<Object?> _insertArgs(NomenclaturaModel nomenclatura) => [
+    nomenclatura.guid,
+    nomenclatura.createdAt.toIso8601String(),
+    nomenclatura.name,
+    nomenclatura.article,
+    nomenclatura.unitName,
+    nomenclatura.unitGuid,
+    nomenclatura.isFolder ? 1 : 0,
+    nomenclatura.parentGuid,
+    nomenclatura.description,
+    nomenclatura.barcodes,
+    nomenclatura.prices,
+    nomenclatura.searchName,
+  ];
+
   Future<Database> get database async {
     if (_database != null) return _database!;
     _database = await _initDatabase();
@@ -116,11 +229,100 @@ class NomenclaturaLocalDataSourceImpl implements NomenclaturaLocalDataSource {
     await _cacheNomenclaturaWithStrategy(nomenclaturas, clearFirst: false);
   }
 
+  @override
+  Future<int?> importPackedNomenclatura(
+    Uint8List bytes, {
+    bool replace = false,
+  }) async {
+    final store = await _nativeStore;
+    if (store == null) return null;
+    try {
+      final changes = await store.importPacked(bytes, replace: replace);
+      _invalidateCompact();
+      print(
+        'Imported packed catalogue (${bytes.length} bytes, '
+        '$changes changes)',
+      ); // Debug log
+      return changes;
+    } catch (e) {
+      print('Error importing packed catalogue: $e'); // Debug log
+      throw CacheFailure('Failed to import packed catalogue: $e');
+    }
+  }
+
+  @override
+  Future<Map<String, int>?> maintainStore({int vacuumPages = 256}) async {
+    final store = await _nativeStore;
+    if (store == null) return null;
+    return store.maintain(vacuumPages: vacuumPages);
+  }
+
+  @override
+  Future<CompactCatalogue?> getCompactCatalogue() async {
+    final store = await _nativeStore;
+    if (store == null) return null;
+    _compactWanted = true;
+    final loading = _compact ??= CompactCatalogue.load(store);
+    final catalogue = await loading;
+    // Запис за час побудови скинув [_compact]: цей знімок уже застарів.
+    if (identical(loading, _compact)) _compactReady = catalogue;
+    return catalogue;
+  }
+
+  @override
+  Future<PriceSnapshot?> snapshotPrices() async {
+    final store = await _nativeStore;
+    if (store == null) return null;
+    return PriceSnapshot.take(store);
+  }
+
+  @override
+  Future<int?> printPriceLabels(
+    PriceSnapshot before, {
+    required String host,
+    int port = 9100,
+    int width = 32,
+  }) async {
+    final store = await _nativeStore;
+    if (store == null) return null;
+    return NativeLabelPrinter.printChanged(
+      store,
+      before,
+      host: host,
+      port: port,
+      width: width,
+    );
+  }
+
   /// Кешує номенклатуру з можливістю очищення
   Future<void> _cacheNomenclaturaWithStrategy(
     List<NomenclaturaModel> nomenclaturas, {
     bool clearFirst = false,
   }) async {
+    final store = await _nativeStore;
+    if (store != null) {
+      // Усе одним пакетом в одній транзакції потоку-писача; читачі до
+      // коміту бачать попередній каталог.
+      try {
+        final changes = await store.write([
+          if (clearFirst) (sql: 'DELETE FROM nomenclatura', rows: []),
+          (
+            sql: _insertSql,
+            rows: [for (final n in nomenclaturas) _insertArgs(n)],
+          ),
+        ]);
+        _invalidateCompact();
+        print(
+          'Cached ${nomenclaturas.length} nomenclatura items natively '
+          '($changes changes)',
+        ); // Debug log
+        return;
+      } catch (e) {
+        print('Error caching nomenclatura: $e'); // Debug log
+        throw CacheFailure('Failed to cache nomenclatura: $e');
+      }
+    }
+
     final db = await database;
 
     try {
@@ -183,27 +385,7 @@ class NomenclaturaLocalDataSourceImpl implements NomenclaturaLocalDataSource {
 
           for (final nomenclatura in batch) {
             // Завжди використовуємо INSERT OR REPLACE для уникнення конфліктів
-            await txn.execute(
-              '''
-                INSERT OR REPLACE INTO nomenclatura 
-                (guid, created_at, name, article, unit_name, unit_guid, is_folder, parent_guid, description, barcodes, price, search_name) 
-                VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
-               ''',
-              [
-                nomenclatura.guid,
-                nomenclatura.createdAt.toIso8601String(),
-                nomenclatura.name,
-                nomenclatura.article,
-                nomenclatura.unitName,
-                nomenclatura.unitGuid,
-                nomenclatura.isFolder ? 1 : 0,
-                nomenclatura.parentGuid,
-                nomenclatura.description,
-                nomenclatura.barcodes,
-                nomenclatura.prices,
-                nomenclatura.searchName,
-              ],
-            );
+            await txn.execute(_insertSql, _insertArgs(nomenclatura));
           }
 
           // Показуємо прогрес кешування
@@ -233,10 +415,10 @@ class NomenclaturaLocalDataSourceImpl implements NomenclaturaLocalDataSource {
 
   @override
   Future<List<NomenclaturaModel>> getCachedNomenclatura() async {
-    final db = await database;
-
     try {
-      final nomenclaturaRows = await db.query('nomenclatura', orderBy: 'name');
+      final nomenclaturaRows = await _select(
+        'SELECT * FROM nomenclatura ORDER BY name',
+      );
 
       if (nomenclaturaRows.isEmpty) {
         return [];
@@ -271,14 +453,12 @@ class NomenclaturaLocalDataSourceImpl implements NomenclaturaLocalDataSource {
 
   @override
   Future<NomenclaturaModel?> getCachedNomenclaturaByGuid(String guid) async {
-    final db = await database;
-
+    final compact = _readyCompact;
+    if (compact != null) return compact.byGuid(guid)?.toModel();
     try {
-      final rows = await db.query(
-        'nomenclatura',
-        where: 'guid = ?',
-        whereArgs: [guid],
-        limit: 1,
+      final rows = await _select(
+        'SELECT * FROM nomenclatura WHERE guid = ? LIMIT 1',
+        [guid],
       );
 
       if (rows.isEmpty) {
@@ -307,16 +487,12 @@ class NomenclaturaLocalDataSourceImpl implements NomenclaturaLocalDataSource {
 
   @override
   Future<List<NomenclaturaModel>> searchCachedNomenclatura(String query) async {
-    final db = await database;
-
     try {
       // Пошук по полю search_name (найшвидший) + додаткові поля для повноти
-      final nomenclaturaRows = await db.query(
-        'nomenclatura',
-        where: 'search_name LIKE ? AND is_folder = ?',
-        whereArgs: ['%$query%', 0],
-        orderBy: 'name',
-        limit: 100,
+      final nomenclaturaRows = await _select(
+        'SELECT * FROM nomenclatura WHERE search_name LIKE ? AND is_folder = ? '
+        'ORDER BY name LIMIT 100',
+        ['%$query%', 0],
       );
 
       if (nomenclaturaRows.isEmpty) {
@@ -351,17 +527,91 @@ class NomenclaturaLocalDataSourceImpl implements NomenclaturaLocalDataSource {
   }
 
   @override
-  Future<NomenclaturaModel?> searchByBarcode(String barcode) async {
-    final db = await database;
+  Future<List<NomenclaturaModel>> getCachedNomenclaturaByGuids(
+    List<String> guids,
+  ) async {
+    if (guids.isEmpty) return [];
+
+    final compact = _readyCompact;
+    if (compact != null) {
+      return [
+        for (final guid in guids)
+          if (compact.byGuid(guid) case final item?) item.toModel(),
+      ];
+    }
+
+    try {
+      final placeholders = List.filled(guids.length, '?').join(',');
+      final rows = await _select(
+        'SELECT * FROM nomenclatura WHERE guid IN ($placeholders)',
+        guids,
+      );
+
+      final byGuid = <String, NomenclaturaModel>{};
+      for (final row in rows) {
+        final model = _modelFromRow(row);
+        byGuid[model.guid] = model;
+      }
+
+      // Зберігаємо порядок, у якому GUID прийшли (ранг видачі)
+      return [
+        for (final guid in guids)
+          if (byGuid.containsKey(guid)) byGuid[guid]!,
+      ];
+    } catch (e) {
+      throw CacheFailure('Failed to get cached nomenclatura by guids: $e');
+    }
+  }
+
+  @override
+  Future<({List<String> guids, List<String> keys, List<String> groups})>
+      getSearchKeys() async {
+    try {
+      final rows = await _select('''
+        SELECT guid, search_name, parent_guid FROM nomenclatura
+        WHERE is_folder = 0
+        ORDER BY name
+      ''');
+
+      final guids = <String>[];
+      final keys = <String>[];
+      final groups = <String>[];
+      for (final row in rows) {
+        guids.add(row['guid'] as String);
+        keys.add((row['search_name'] as String?) ?? '');
+        groups.add((row['parent_guid'] as String?) ?? '');
+      }
+      return (guids: guids, keys: keys, groups: groups);
+    } catch (e) {
+      throw CacheFailure('Failed to get search keys: $e');
+    }
+  }
 
+  NomenclaturaModel _modelFromRow(Map<String, Object?> row) {
+    return NomenclaturaModel(
+      guid: row['guid'] as String,
+      createdAt: DateTime.parse(row['created_at'] as String),
+      name: row['name'] as String,
+      article: row['article'] as String,
+      unitName: row['unit_name'] as String,
+      unitGuid: row['unit_guid'] as String,
+      isFolder: (row['is_folder'] as int) == 1,
+      parentGuid: row['parent_guid'] as String?,
+      description: row['description'] as String?,
+      barcodes: (row['barcodes'] as String?) ?? '',
+      prices: (row['price'] as num?)?.toDouble() ?? 0.0,
+      searchName: (row['search_name'] as String?) ?? '',
+    );
+  }
+
+  @override
+  Future<NomenclaturaModel?> searchByBarcode(String barcode) async {
     try {
       // Пошук по полю barcodes (штрихкоди зберігаються як рядок з комами)
-      final nomenclaturaRows = await db.query(
-        'nomenclatura',
-        where:
-            '(barcodes LIKE ? OR barcodes LIKE ? OR barcodes LIKE ? OR barcodes = ?) AND is_folder = ?',
-        whereArgs: ['$barcode,%', '%,$barcode,%', '%,$barcode', barcode, 0],
-        limit: 1,
+      final nomenclaturaRows = await _select(
+        'SELECT * FROM nomenclatura WHERE (barcodes LIKE ? OR barcodes LIKE ? '
+        'OR barcodes LIKE ? OR barcodes = ?) AND is_folder = ? LIMIT 1',
+        ['$barcode,%', '%,$barcode,%', '%,$barcode', barcode, 0],
       );
 
       if (nomenclaturaRows.isEmpty) {
@@ -390,9 +640,14 @@ class NomenclaturaLocalDataSourceImpl implements NomenclaturaLocalDataSource {
 
   @override
   Future<void> clearCache() async {
-    final db = await database;
-
     try {
+      final store = await _nativeStore;
+      if (store != null) {
+        await store.write([(sql: 'DELETE FROM nomenclatura', rows: [])]);
+        _invalidateCompact();
+        return;
+      }
+      final db = await database;
       await db.transaction((txn) async {
         // await txn.delete('barcodes');
         // await txn.delete('prices');
@@ -405,9 +660,20 @@ class NomenclaturaLocalDataSourceImpl implements NomenclaturaLocalDataSource {
 
   @override
   Future<void> cacheLastSync(DateTime lastSync) async {
-    final db = await database;
-
     try {
+      final store = await _nativeStore;
+      if (store != null) {
+        await store.write([
+          (
+            sql: 'INSERT OR REPLACE INTO sync_info (key, value) VALUES (?, ?)',
+            rows: [
+              ['last_sync', lastSync.toIso8601String()],
+            ],
+          ),
+        ]);
+        return;
+      }
+      final db = await database;
       await db.insert('sync_info', {
         'key': 'last_sync',
         'value': lastSync.toIso8601String(),
@@ -419,14 +685,10 @@ class NomenclaturaLocalDataSourceImpl implements NomenclaturaLocalDataSource {
 
   @override
   Future<DateTime?> getLastSync() async {
-    final db = await database;
-
     try {
-      final rows = await db.query(
-        'sync_info',
-        where: 'key = ?',
-        whereArgs: ['last_sync'],
-        limit: 1,
+      final rows = await _select(
+        'SELECT value FROM sync_info WHERE key = ? LIMIT 1',
+        ['last_sync'],
       );
 
       if (rows.isEmpty) {
@@ -441,14 +703,12 @@ class NomenclaturaLocalDataSourceImpl implements NomenclaturaLocalDataSource {
 
   @override
   Future<List<NomenclaturaModel>> getCachedCategories() async {
-    final db = await database;
-
     try {
       print(
         'Fetching root categories from cache (isFolder = 1 AND parent_guid IS NULL)...',
       );
 
-      final result = await db.rawQuery('''
+      final result = await _select('''
         SELECT 
           n.guid, n.created_at, n.name, n.article, n.unit_name, n.unit_guid, 
           n.is_folder, n.parent_guid, n.description, n.barcodes, n.price
@@ -486,12 +746,10 @@ class NomenclaturaLocalDataSourceImpl implements NomenclaturaLocalDataSource {
   Future<List<NomenclaturaModel>> getCachedSubcategories(
     String parentGuid,
   ) async {
-    final db = await database;
-
     try {
       print('Fetching subcategories for parent_guid: $parentGuid...');
 
-      final result = await db.rawQuery(
+      final result = await _select(
         '''
         SELECT 
           n.guid, n.created_at, n.name, n.article, n.unit_name, n.unit_guid, 
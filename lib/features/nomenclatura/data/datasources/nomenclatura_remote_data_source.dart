@@ -1,4 +1,6 @@
 import 'dart:convert';
+import 'dart:typed_data';
+import 'package:http/http.dart' as http;
 import 'package:supabase_flutter/supabase_flutter.dart';
 import '../models/nomenclatura_model.dart';
 import '../../../../core/error/failures.dart';
@@ -9,6 +11,11 @@ abstract class NomenclaturaRemoteDataSource {
     void Function(String message, double progress)? onProgress,
     bool includeRelations = true, // Чи включати ціни та штрих-коди
   });
+
+  /// Увесь каталог одним файлом .vkc (див. native/catalogue/
+  /// catalogue_codec.h), якщо налаштовано адресу пакета; інакше або при
+  /// помилці — null, і синхронізація йде через [getAllNomenclatura].
+  Future<Uint8List?> getPackedNomenclatura();
   Future<NomenclaturaModel?> getNomenclaturaByGuid(String guid);
   Future<List<NomenclaturaModel>> searchNomenclatura(String query);
   Future<NomenclaturaModel> createNomenclatura(NomenclaturaModel nomenclatura);
@@ -19,7 +26,13 @@ abstract class NomenclaturaRemoteDataSource {
 class NomenclaturaRemoteDataSourceImpl implements NomenclaturaRemoteDataSource {
   final SupabaseClient supabaseClient;
 
-  NomenclaturaRemoteDataSourceImpl({required this.supabaseClient});
+  /// Адреса статичного файлу каталогу (налаштування `catalogue_pack_url`).
+  final Future<String?> Function()? packedCatalogueUrl;
+
+  NomenclaturaRemoteDataSourceImpl({
+    required this.supabaseClient,
+    this.packedCatalogueUrl,
+  });
 
   List<NomenclaturaModel> _parseNomenclatura(
     List<Map<String, dynamic>> records,
@@ -184,6 +197,30 @@ class NomenclaturaRemoteDataSourceImpl implements NomenclaturaRemoteDataSource {
     }
   }
 
+  @override
+  Future<Uint8List?> getPackedNomenclatura() async {
+    final url = await packedCatalogueUrl?.call();
+    if (url == null || url.isEmpty) return null;
+    try {
+      final response = await http
+          .get(Uri.parse(url))
+          .timeout(const Duration(seconds: 60));
+      if (response.statusCode != 200) {
+        debugPrint(
+          '⚠️ [SYNC] Пакет каталогу недоступний: HTTP ${response.statusCode}',
+        );
+        return null;
+      }
+      debugPrint(
+        '📦 [SYNC] Пакет каталогу: ${response.bodyBytes.length} байтів',
+      );
+      return response.bodyBytes;
+    } catch (e) {
+      debugPrint('⚠️ [SYNC] Пакет каталогу не завантажено: $e');
+      return null;
+    }
+  }
+
   @override
   Future<NomenclaturaModel?> getNomenclaturaByGuid(String guid) async {
     try {
@@ -255,6 +255,8 @@ class NomenclaturaRepositoryImpl implements NomenclaturaRepository {
       // Спочатку спробуємо виконати запит без перевірки connectivity
       print('Starting sync with server...'); // Debug log
 
+      if (await _syncPacked(replace: false)) return const Right(null);
+
       final remoteNomenclatura = await remoteDataSource.getAllNomenclatura();
       print(
         'Successfully fetched ${remoteNomenclatura.length} items from server',
@@ -296,6 +298,8 @@ class NomenclaturaRepositoryImpl implements NomenclaturaRepository {
     try {
       print('Starting FORCE sync with server...'); // Debug log
 
+      if (await _syncPacked(replace: true)) return const Right(null);
+
       final remoteNomenclatura = await remoteDataSource.getAllNomenclatura(
         includeRelations: false, // Швидка синхронізація для початку
       );
@@ -375,6 +379,23 @@ class NomenclaturaRepositoryImpl implements NomenclaturaRepository {
     }
   }
 
+  /// Синхронізація одним файлом .vkc: у рази менше байтів, ніж JSON
+  /// сторінками, і без розбору в Dart. False — пакета немає (не
+  /// налаштовано, сервер недоступний, немає нативного сховища), тоді
+  /// викликач іде звичним шляхом через JSON.
+  Future<bool> _syncPacked({required bool replace}) async {
+    final bytes = await remoteDataSource.getPackedNomenclatura();
+    if (bytes == null) return false;
+    final changes = await localDataSource.importPackedNomenclatura(
+      bytes,
+      replace: replace,
+    );
+    if (changes == null) return false;
+    await localDataSource.cacheLastSync(DateTime.now());
+    print('Successfully imported packed catalogue'); // Debug log
+    return true;
+  }
+
   // Приватний метод для конвертації entity в model
   NomenclaturaModel _nomenclaturaToModel(Nomenclatura nomenclatura) {
     return NomenclaturaModel.fromEntity(nomenclatura);
@@ -6,6 +6,7 @@ import 'package:sqflite_common_ffi/sqflite_ffi.dart';
 import 'core/config/supabase_config.dart';
 import 'core/routes/app_router.dart';
 import 'core/services/sync/app_initialization_service.dart';
+import 'core/services/startup/native_startup.dart';
 import 'core/services/storage/storage_service.dart';
 import 'features/settings/presentation/bloc/settings_bloc.dart';
 import 'package:supabase_flutter/supabase_flutter.dart';
@@ -13,6 +14,7 @@ import 'features/home/presentation/bloc/home_bloc.dart';
 
 void main() async {
   WidgetsFlutterBinding.ensureInitialized();
+  NativeStartup.mark('dartMain');
 
   // Обробка помилок клавіатури на Windows
   FlutterError.onError = (FlutterErrorDetails details) {
@@ -44,15 +46,9 @@ void main() async {
     databaseFactory = databaseFactoryFfi;
   }
 
-  try {
-    await Supabase.initialize(
-      url: SupabaseConfig.url,
-      anonKey: SupabaseConfig.anonKey,
-    );
-  } catch (e) {
-    // Логуємо помилку, але не зупиняємо додаток
-    print('Supabase initialization error: $e');
-  }
+  // Supabase не потрібен для реєстрації залежностей (клієнт береться
+  // ліниво), тож підключаємося паралельно з ініціалізацією COM-Cashalot.
+  final supabaseReady = _initializeSupabase();
 
   // Ініціалізуємо залежності
   try {
@@ -60,15 +56,30 @@ void main() async {
 
     // ініціалізація COM‑Cashalot
     await AppInitializationService.initCashalot();
+    await NativeStartup.mark('dependencies');
 
+    await supabaseReady;
     runApp(const MainApp());
   } catch (e) {
     print('Dependencies initialization error: $e');
   }
 
+  await supabaseReady;
   runApp(const MainApp());
 }
 
+Future<void> _initializeSupabase() async {
+  try {
+    await Supabase.initialize(
+      url: SupabaseConfig.url,
+      anonKey: SupabaseConfig.anonKey,
+    );
+  } catch (e) {
+    // Логуємо помилку, але не зупиняємо додаток
+    print('Supabase initialization error: $e');
+  }
+}
+
 class MainApp extends StatelessWidget {
   const MainApp({super.key});
 
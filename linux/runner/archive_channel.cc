@@ -0,0 +1,254 @@
+#include "archive_channel.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "archive/archived_receipt.h"
+#include "archive/receipt_archive.h"
+#include "channel_args.h"
+#include "metrics/metrics.h"
+#include "trace/trace.h"
+
+namespace {
+
+constexpr int64_t kDefaultLimit = 50;
+
+FlMethodChannel* archive_channel = nullptr;
+virok::ReceiptArchive receipt_archive;
+
+// Чек у формі, яку чекає Dart (суми — в гривнях, кількість — дробова).
+FlValue* receipt_to_value(const virok::ArchivedReceipt& r) {
+  FlValue* lines = fl_value_new_list();
+  for (const virok::ArchivedLine& line : r.lines) {
+    FlValue* barcodes = fl_value_new_list();
+    for (const std::string& barcode : line.barcodes) {
+      fl_value_append_take(barcodes, fl_value_new_string(barcode.c_str()));
+    }
+    FlValue* map = fl_value_new_map();
+    fl_value_set_string_take(map, "guid",
+                             fl_value_new_string(line.guid.c_str()));
+    fl_value_set_string_take(map, "code",
+                             fl_value_new_string(line.code.c_str()));
+    fl_value_set_string_take(map, "name",
+                             fl_value_new_string(line.name.c_str()));
+    fl_value_set_string_take(map, "barcodes", barcodes);
+    fl_value_set_string_take(map, "quantity",
+                             fl_value_new_float(line.qty_milli / 1000.0));
+    fl_value_set_string_take(map, "price",
+                             fl_value_new_float(line.price / 100.0));
+    fl_value_set_string_take(map, "discount",
+                             fl_value_new_float(line.discount / 100.0));
+    fl_value_append_take(lines, map);
+  }
+  FlValue* payments = fl_value_new_list();
+  for (const virok::ArchivedPayment& payment : r.payments) {
+    FlValue* map = fl_value_new_map();
+    fl_value_set_string_take(map, "form",
+                             fl_value_new_string(payment.form.c_str()));
+    fl_value_set_string_take(map, "amount",
+                             fl_value_new_float(payment.amount / 100.0));
+    fl_value_append_take(payments, map);
+  }
+  FlValue* map = fl_value_new_map();
+  fl_value_set_string_take(map, "fiscalNumber",
+                           fl_value_new_string(r.fiscal_number.c_str()));
+  fl_value_set_string_take(map, "rrn", fl_value_new_string(r.rrn.c_str()));
+  fl_value_set_string_take(map, "createdMs", fl_value_new_int(r.created_ms));
+  fl_value_set_string_take(map, "date", fl_value_new_int(r.date));
+  fl_value_set_string_take(map, "docType",
+                           fl_value_new_string(r.doc_type.c_str()));
+  fl_value_set_string_take(map, "cashier",
+                           fl_value_new_string(r.cashier.c_str()));
+  fl_value_set_string_take(map, "total", fl_value_new_float(r.total / 100.0));
+  fl_value_set_string_take(map, "lines", lines);
+  fl_value_set_string_take(map, "payments", payments);
+  if (!r.visualization.empty()) {
+    fl_value_set_string_take(map, "visualization",
+                             fl_value_new_string(r.visualization.c_str()));
+  }
+  return map;
+}
+
+FlValue* receipts_to_value(
+    const std::vector<virok::ArchivedReceipt>& receipts) {
+  FlValue* list = fl_value_new_list();
+  for (const virok::ArchivedReceipt& r : receipts) {
+    fl_value_append_take(list, receipt_to_value(r));
+  }
+  return list;
+}
+
+FlValue* stats_to_value(const virok::ReceiptArchiveStats& stats) {
+  FlValue* map = fl_value_new_map();
+  fl_value_set_string_take(
+      map, "receipts", fl_value_new_int(static_cast<int64_t>(stats.receipts)));
+  fl_value_set_string_take(
+      map, "segments", fl_value_new_int(static_cast<int64_t>(stats.segments)));
+  fl_value_set_string_take(
+      map, "bytes", fl_value_new_int(static_cast<int64_t>(stats.bytes)));
+  fl_value_set_string_take(
+      map, "deadBytes",
+      fl_value_new_int(static_cast<int64_t>(stats.dead_bytes)));
+  return map;
+}
+
+int32_t today() {
+  return virok::LocalDate(
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count());
+}
+
+virok::Histogram* lookup_latency(const char* query) {
+  return virok::MetricsRegistry::Get().GetHistogram(
+      "virok_archive_lookup_microseconds",
+      "Local receipt archive lookup time",
+      virok::MetricLabel("query", query));
+}
+
+FlMethodResponse* success(FlValue* value) {
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(value));
+}
+
+FlMethodResponse* failure(const char* code, const std::string& message) {
+  return FL_METHOD_RESPONSE(
+      fl_method_error_response_new(code, message.c_str(), nullptr));
+}
+
+FlMethodResponse* handle_archive_call(const std::string& method,
+                                      FlValue* args) {
+  const size_t limit =
+      static_cast<size_t>(int_arg(args, "limit", kDefaultLimit));
+
+  if (method == "open") {
+    std::string error;
+    if (!receipt_archive.Open(string_arg(args, "path"), &error)) {
+      return failure("OPEN_FAILED", error);
+    }
+    g_autoptr(FlValue) result = stats_to_value(receipt_archive.stats());
+    return success(result);
+  }
+  if (method == "put") {
+    static virok::Histogram* const latency =
+        virok::MetricsRegistry::Get().GetHistogram(
+            "virok_archive_put_microseconds",
+            "Local receipt archive write time");
+    virok::LatencyTimer timer(latency);
+    virok::ArchivedReceipt receipt;
+    std::string error;
+    if (!virok::ParseArchivedReceipt(string_arg(args, "json"), &receipt,
+                                     &error)) {
+      return failure("INVALID_RECEIPT", error);
+    }
+    if (!receipt_archive.Put(receipt, &error)) {
+      return failure("WRITE_FAILED", error);
+    }
+    g_autoptr(FlValue) result = fl_value_new_bool(true);
+    return success(result);
+  }
+  if (method == "byFiscalNumber") {
+    static virok::Histogram* const latency = lookup_latency("fiscal_number");
+    virok::LatencyTimer timer(latency);
+    virok::ArchivedReceipt receipt;
+    if (!receipt_archive.ByFiscalNumber(string_arg(args, "fiscalNumber"),
+                                        &receipt)) {
+      return success(nullptr);
+    }
+    g_autoptr(FlValue) result = receipt_to_value(receipt);
+    return success(result);
+  }
+  if (method == "byRrn" || method == "byBarcode" || method == "byDate") {
+    std::vector<virok::ArchivedReceipt> receipts;
+    if (method == "byRrn") {
+      static virok::Histogram* const latency = lookup_latency("rrn");
+      virok::LatencyTimer timer(latency);
+      receipts = receipt_archive.ByRrn(string_arg(args, "rrn"), limit);
+    } else if (method == "byBarcode") {
+      static virok::Histogram* const latency = lookup_latency("barcode");
+      virok::LatencyTimer timer(latency);
+      receipts = receipt_archive.ByBarcode(string_arg(args, "barcode"), limit);
+    } else {
+      static virok::Histogram* const latency = lookup_latency("date");
+      virok::LatencyTimer timer(latency);
+      const int32_t from = static_cast<int32_t>(int_arg(args, "from"));
+      const int32_t to = static_cast<int32_t>(int_arg(args, "to", from));
+      receipts = receipt_archive.ByDate(from, to, limit);
+    }
+    g_autoptr(FlValue) result = receipts_to_value(receipts);
+    return success(result);
+  }
+  if (method == "compact") {
+    virok::ReceiptArchiveCompaction compaction;
+    if (!receipt_archive.Compact(
+            static_cast<int32_t>(int_arg(args, "today", today())),
+            &compaction)) {
+      return failure("COMPACT_FAILED", "Receipt archive compaction failed");
+    }
+    g_autoptr(FlValue) result = fl_value_new_map();
+    fl_value_set_string_take(
+        result, "expiredSegments",
+        fl_value_new_int(static_cast<int64_t>(compaction.expired_segments)));
+    fl_value_set_string_take(
+        result, "rewrittenSegments",
+        fl_value_new_int(static_cast<int64_t>(compaction.rewritten_segments)));
+    fl_value_set_string_take(
+        result, "reclaimedBytes",
+        fl_value_new_int(static_cast<int64_t>(compaction.reclaimed_bytes)));
+    return success(result);
+  }
+  if (method == "stats") {
+    g_autoptr(FlValue) result = stats_to_value(receipt_archive.stats());
+    return success(result);
+  }
+  return FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+}
+
+void archive_method_call_cb(FlMethodChannel* channel,
+                            FlMethodCall* method_call, gpointer user_data) {
+  const std::string method = fl_method_call_get_name(method_call);
+  virok::TraceScope trace_scope("archive", method);
+  g_autoptr(FlMethodResponse) response =
+      handle_archive_call(method, fl_method_call_get_args(method_call));
+
+  g_autoptr(GError) error = nullptr;
+  if (!fl_method_call_respond(method_call, response, &error)) {
+    g_warning("Failed to respond on com.virok/archive: %s", error->message);
+  }
+}
+
+}  // namespace
+
+virok::MaintenanceStep archive_compact_step() {
+  if (!receipt_archive.is_open()) return virok::MaintenanceStep::kDone;
+  virok::ReceiptArchiveCompaction compaction;
+  if (!receipt_archive.Compact(today(), &compaction, 1)) {
+    return virok::MaintenanceStep::kFailed;
+  }
+  return compaction.pending_segments ? virok::MaintenanceStep::kMore
+                                     : virok::MaintenanceStep::kDone;
+}
+
+bool archive_shift_checks(int64_t from_ms,
+                          std::vector<virok::ReconcileCheck>* checks) {
+  if (!receipt_archive.is_open()) return false;
+  const std::vector<virok::ArchivedReceipt> receipts =
+      receipt_archive.ByDate(virok::LocalDate(from_ms), today(), SIZE_MAX);
+  checks->reserve(receipts.size());
+  for (const virok::ArchivedReceipt& receipt : receipts) {
+    if (receipt.created_ms >= from_ms) {
+      checks->push_back(virok::CheckFromArchive(receipt));
+    }
+  }
+  return true;
+}
+
+void archive_channel_register(FlBinaryMessenger* messenger) {
+  g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+  archive_channel = fl_method_channel_new(messenger, "com.virok/archive",
+                                          FL_METHOD_CODEC(codec));
+  fl_method_channel_set_method_call_handler(archive_channel,
+                                            archive_method_call_cb, nullptr,
+                                            nullptr);
+}
@@ -0,0 +1,29 @@
+#ifndef RUNNER_ARCHIVE_CHANNEL_H_
+#define RUNNER_ARCHIVE_CHANNEL_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "maintenance/idle_scheduler.h"
+#include "reconcile/shift_reconciler.h"
+
+// Реєструє канал com.virok/archive: локальний архів фіскалізованих чеків
+// для повернень і повторного друку (див. native/archive).
+// Викликати один раз після створення FlView.
+void archive_channel_register(FlBinaryMessenger* messenger);
+
+// Крок фонового ущільнення архіву (maintenance_channel): не більше одного
+// сегмента за виклик, бо архів тримає м'ютекс усю роботу і пошук чека на
+// касі чекав би на неї. kDone — більше нічого ущільнювати або архів не
+// відкрито.
+virok::MaintenanceStep archive_compact_step();
+
+// Чеки архіву від |from_ms| (відкриття зміни) для звірки перед Z-звітом
+// (report_channel). Можна викликати з будь-якого потоку. false — архів не
+// відкрито.
+bool archive_shift_checks(int64_t from_ms,
+                          std::vector<virok::ReconcileCheck>* checks);
+
+#endif  // RUNNER_ARCHIVE_CHANNEL_H_
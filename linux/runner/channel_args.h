@@ -0,0 +1,71 @@
+#ifndef RUNNER_CHANNEL_ARGS_H_
+#define RUNNER_CHANNEL_ARGS_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Допоміжні функції для читання аргументів FlMethodCall (мапа з Dart).
+// Відсутній аргумент або аргумент іншого типу повертає |fallback|.
+
+inline FlValue* find_arg(FlValue* args, const char* key) {
+  if (args == nullptr || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return nullptr;
+  }
+  return fl_value_lookup_string(args, key);
+}
+
+inline int64_t int_arg(FlValue* args, const char* key, int64_t fallback = 0) {
+  FlValue* v = find_arg(args, key);
+  if (v != nullptr && fl_value_get_type(v) == FL_VALUE_TYPE_INT) {
+    return fl_value_get_int(v);
+  }
+  return fallback;
+}
+
+inline double double_arg(FlValue* args, const char* key, double fallback = 0) {
+  FlValue* v = find_arg(args, key);
+  if (v == nullptr) return fallback;
+  if (fl_value_get_type(v) == FL_VALUE_TYPE_FLOAT) return fl_value_get_float(v);
+  if (fl_value_get_type(v) == FL_VALUE_TYPE_INT) {
+    return static_cast<double>(fl_value_get_int(v));
+  }
+  return fallback;
+}
+
+inline bool bool_arg(FlValue* args, const char* key, bool fallback = false) {
+  FlValue* v = find_arg(args, key);
+  if (v != nullptr && fl_value_get_type(v) == FL_VALUE_TYPE_BOOL) {
+    return fl_value_get_bool(v);
+  }
+  return fallback;
+}
+
+inline std::string string_arg(FlValue* args, const char* key,
+                              const std::string& fallback = std::string()) {
+  FlValue* v = find_arg(args, key);
+  if (v != nullptr && fl_value_get_type(v) == FL_VALUE_TYPE_STRING) {
+    return fl_value_get_string(v);
+  }
+  return fallback;
+}
+
+inline std::vector<std::string> string_list_arg(FlValue* args,
+                                                const char* key) {
+  std::vector<std::string> out;
+  FlValue* v = find_arg(args, key);
+  if (v == nullptr || fl_value_get_type(v) != FL_VALUE_TYPE_LIST) return out;
+  const size_t length = fl_value_get_length(v);
+  out.reserve(length);
+  for (size_t i = 0; i < length; i++) {
+    FlValue* item = fl_value_get_list_value(v, i);
+    out.push_back(fl_value_get_type(item) == FL_VALUE_TYPE_STRING
+                      ? fl_value_get_string(item)
+                      : "");
+  }
+  return out;
+}
+
+#endif  // RUNNER_CHANNEL_ARGS_H_
@@ -1,6 +1,10 @@
 #include "my_application.h"
+#include "startup_channel.h"
 
 int main(int argc, char** argv) {
+  // Каталог і налаштування готуються паралельно зі стартом двигуна Flutter.
+  startup_prewarm_start();
+
   g_autoptr(MyApplication) app = my_application_new();
   return g_application_run(G_APPLICATION(app), argc, argv);
 }
@@ -0,0 +1,298 @@
+#include "maintenance_channel.h"
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "archive_channel.h"
+#include "channel_args.h"
+#include "maintenance/idle_scheduler.h"
+#include "trace/trace.h"
+
+namespace {
+
+using Clock = virok::IdleScheduler::Clock;
+
+// Єдина задача, що виконується в runner; решту назв виконує Dart.
+constexpr char kArchiveJob[] = "archiveCompact";
+
+// Задача Dart: крок лише надсилає "run" і чекає на finished.
+struct DartJob {
+  enum State { kIdle, kRunning, kFinished, kAborted, kFailed };
+
+  std::string name;
+  std::atomic<int> state{kIdle};
+};
+
+struct MaintenanceEvent {
+  std::string job;
+  const char* action;
+};
+
+FlMethodChannel* maintenance_channel = nullptr;
+FlEventChannel* maintenance_events = nullptr;
+// Dart слухає потік подій (лише в головному потоці).
+bool maintenance_listening = false;
+std::unique_ptr<virok::IdleScheduler> scheduler;
+// Зареєстровані задачі (лише в головному потоці); Dart-задачі спільні з
+// кроками планувальника.
+std::map<std::string, std::shared_ptr<DartJob>> dart_jobs;
+bool has_archive_job = false;
+
+gboolean send_event_cb(gpointer user_data) {
+  std::unique_ptr<MaintenanceEvent> event(
+      static_cast<MaintenanceEvent*>(user_data));
+  if (maintenance_events == nullptr || !maintenance_listening) {
+    return G_SOURCE_REMOVE;
+  }
+  g_autoptr(FlValue) value = fl_value_new_map();
+  fl_value_set_string_take(value, "job",
+                           fl_value_new_string(event->job.c_str()));
+  fl_value_set_string_take(value, "action",
+                           fl_value_new_string(event->action));
+  g_autoptr(GError) error = nullptr;
+  if (!fl_event_channel_send(maintenance_events, value, nullptr, &error)) {
+    g_warning("Failed to send on com.virok/maintenance/events: %s",
+              error->message);
+  }
+  return G_SOURCE_REMOVE;
+}
+
+// Потік планувальника: подія переходить у головний цикл.
+void send_event(const std::string& job, const char* action) {
+  g_idle_add(send_event_cb, new MaintenanceEvent{job, action});
+}
+
+virok::MaintenanceJob make_dart_job(std::shared_ptr<DartJob> dart,
+                                    std::chrono::milliseconds interval) {
+  virok::MaintenanceJob job;
+  job.name = dart->name;
+  job.interval = interval;
+  job.step = [dart](const virok::MaintenanceYield&) {
+    switch (dart->state.load()) {
+      case DartJob::kIdle:
+        dart->state = DartJob::kRunning;
+        send_event(dart->name, "run");
+        return virok::MaintenanceStep::kWait;
+      case DartJob::kRunning:
+        return virok::MaintenanceStep::kWait;
+      case DartJob::kFinished:
+        dart->state = DartJob::kIdle;
+        return virok::MaintenanceStep::kDone;
+      case DartJob::kFailed:
+        dart->state = DartJob::kIdle;
+        return virok::MaintenanceStep::kFailed;
+      default:
+        // Перервана: у наступному вікні простою — знову "run".
+        dart->state = DartJob::kIdle;
+        return virok::MaintenanceStep::kMore;
+    }
+  };
+  job.preempt = [dart] {
+    if (dart->state.load() == DartJob::kRunning) {
+      send_event(dart->name, "preempt");
+    }
+  };
+  return job;
+}
+
+virok::MaintenanceJob make_archive_job(std::chrono::milliseconds interval) {
+  virok::MaintenanceJob job;
+  job.name = kArchiveJob;
+  job.interval = interval;
+  job.step = [](const virok::MaintenanceYield&) {
+    return archive_compact_step();
+  };
+  return job;
+}
+
+// Перезапуск Dart (hot restart, нова підписка) обриває задачі, що
+// виконувалися: finished для них уже не прийде.
+void abort_running_dart_jobs() {
+  for (auto& [name, dart] : dart_jobs) {
+    int running = DartJob::kRunning;
+    dart->state.compare_exchange_strong(running, DartJob::kAborted);
+  }
+  if (scheduler) scheduler->Wake();
+}
+
+FlValue* status_to_value(const virok::IdleSchedulerStatus& status) {
+  FlValue* jobs = fl_value_new_list();
+  for (const virok::MaintenanceJobStatus& job : status.jobs) {
+    FlValue* map = fl_value_new_map();
+    fl_value_set_string_take(map, "name",
+                             fl_value_new_string(job.name.c_str()));
+    fl_value_set_string_take(
+        map, "runs", fl_value_new_int(static_cast<int64_t>(job.runs)));
+    fl_value_set_string_take(
+        map, "failures",
+        fl_value_new_int(static_cast<int64_t>(job.failures)));
+    fl_value_set_string_take(map, "dueInMs",
+                             fl_value_new_int(job.due_in_ms));
+    fl_value_append_take(jobs, map);
+  }
+  FlValue* map = fl_value_new_map();
+  fl_value_set_string_take(map, "running",
+                           fl_value_new_bool(scheduler->running()));
+  fl_value_set_string_take(map, "idle", fl_value_new_bool(status.idle));
+  fl_value_set_string_take(map, "cartOpen",
+                           fl_value_new_bool(status.cart_open));
+  fl_value_set_string_take(map, "active",
+                           fl_value_new_string(status.active.c_str()));
+  fl_value_set_string_take(
+      map, "slices", fl_value_new_int(static_cast<int64_t>(status.slices)));
+  fl_value_set_string_take(
+      map, "preemptions",
+      fl_value_new_int(static_cast<int64_t>(status.preemptions)));
+  fl_value_set_string_take(map, "jobs", jobs);
+  return map;
+}
+
+// jobs: {назва: інтервал у мс}. Задачі додаються лише раз; повторний
+// configure змінює тільки пороги простою.
+void add_jobs(FlValue* jobs) {
+  if (jobs == nullptr || fl_value_get_type(jobs) != FL_VALUE_TYPE_MAP) return;
+  const Clock::time_point now = Clock::now();
+  for (size_t i = 0; i < fl_value_get_length(jobs); i++) {
+    FlValue* key = fl_value_get_map_key(jobs, i);
+    FlValue* value = fl_value_get_map_value(jobs, i);
+    if (fl_value_get_type(key) != FL_VALUE_TYPE_STRING ||
+        fl_value_get_type(value) != FL_VALUE_TYPE_INT) {
+      continue;
+    }
+    const std::string name = fl_value_get_string(key);
+    if (name.empty() || dart_jobs.count(name) ||
+        (name == kArchiveJob && has_archive_job)) {
+      continue;
+    }
+    const std::chrono::milliseconds interval(fl_value_get_int(value));
+    if (name == kArchiveJob) {
+      has_archive_job = true;
+      scheduler->AddJob(make_archive_job(interval), now);
+      continue;
+    }
+    auto dart = std::make_shared<DartJob>();
+    dart->name = name;
+    dart_jobs[name] = dart;
+    scheduler->AddJob(make_dart_job(dart, interval), now);
+  }
+}
+
+FlMethodErrorResponse* maintenance_listen_cb(FlEventChannel* channel,
+                                             FlValue* args,
+                                             gpointer user_data) {
+  maintenance_listening = true;
+  abort_running_dart_jobs();
+  return nullptr;
+}
+
+FlMethodErrorResponse* maintenance_cancel_cb(FlEventChannel* channel,
+                                             FlValue* args,
+                                             gpointer user_data) {
+  maintenance_listening = false;
+  abort_running_dart_jobs();
+  return nullptr;
+}
+
+void maintenance_method_call_cb(FlMethodChannel* channel,
+                                FlMethodCall* method_call,
+                                gpointer user_data) {
+  const std::string method = fl_method_call_get_name(method_call);
+  FlValue* args = fl_method_call_get_args(method_call);
+  virok::TraceScope trace_scope("maintenance", method);
+  g_autoptr(FlMethodResponse) response = nullptr;
+
+  if (method == "configure") {
+    virok::IdleSchedulerOptions options;
+    options.idle_after = std::chrono::milliseconds(
+        int_arg(args, "idleAfterMs", options.idle_after.count()));
+    options.retry_after = std::chrono::milliseconds(
+        int_arg(args, "retryAfterMs", options.retry_after.count()));
+    scheduler->set_options(options);
+    add_jobs(find_arg(args, "jobs"));
+    if (bool_arg(args, "enabled", true)) {
+      if (!scheduler->running()) scheduler->Start();
+    } else {
+      scheduler->Stop();
+    }
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else if (method == "setCartOpen") {
+    scheduler->SetCartOpen(bool_arg(args, "open"));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else if (method == "finished") {
+    auto it = dart_jobs.find(string_arg(args, "job"));
+    if (it == dart_jobs.end()) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "UNKNOWN_JOB", "Unknown maintenance job", nullptr));
+    } else {
+      // "done", "aborted" (preempt) або "failed".
+      const std::string outcome = string_arg(args, "result", "done");
+      int running = DartJob::kRunning;
+      it->second->state.compare_exchange_strong(
+          running, outcome == "done"      ? DartJob::kFinished
+                   : outcome == "aborted" ? DartJob::kAborted
+                                          : DartJob::kFailed);
+      scheduler->Wake();
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+    }
+  } else if (method == "status") {
+    g_autoptr(FlValue) result =
+        status_to_value(scheduler->status(Clock::now()));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else {
+    response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+  }
+
+  g_autoptr(GError) error = nullptr;
+  if (!fl_method_call_respond(method_call, response, &error)) {
+    g_warning("Failed to respond on com.virok/maintenance: %s",
+              error->message);
+  }
+}
+
+// Сигнал "event" надходить до окремих key-press-event і button-press-event,
+// тож введення видно навіть тоді, коли його поглинає фільтр сканера.
+gboolean input_event_cb(GtkWidget* widget, GdkEvent* event,
+                        gpointer user_data) {
+  switch (event->type) {
+    case GDK_KEY_PRESS:
+    case GDK_BUTTON_PRESS:
+    case GDK_SCROLL:
+    case GDK_TOUCH_BEGIN:
+      if (scheduler) scheduler->OnInput(Clock::now());
+      break;
+    default:
+      break;
+  }
+  return FALSE;
+}
+
+}  // namespace
+
+void maintenance_channel_register(FlBinaryMessenger* messenger,
+                                  GtkWindow* window, FlView* view) {
+  // Планувальник стежить за введенням з самого запуску, а потік
+  // запускає configure з Dart.
+  scheduler = std::make_unique<virok::IdleScheduler>();
+  g_signal_connect(window, "event", G_CALLBACK(input_event_cb), nullptr);
+  g_signal_connect(view, "event", G_CALLBACK(input_event_cb), nullptr);
+
+  g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+  maintenance_channel = fl_method_channel_new(
+      messenger, "com.virok/maintenance", FL_METHOD_CODEC(codec));
+  fl_method_channel_set_method_call_handler(
+      maintenance_channel, maintenance_method_call_cb, nullptr, nullptr);
+  maintenance_events = fl_event_channel_new(
+      messenger, "com.virok/maintenance/events", FL_METHOD_CODEC(codec));
+  fl_event_channel_set_stream_handlers(maintenance_events,
+                                       maintenance_listen_cb,
+                                       maintenance_cancel_cb, nullptr,
+                                       nullptr);
+}
+
+void maintenance_channel_shutdown() {
+  if (scheduler) scheduler->Stop();
+  maintenance_listening = false;
+}
@@ -0,0 +1,24 @@
+#ifndef RUNNER_MAINTENANCE_CHANNEL_H_
+#define RUNNER_MAINTENANCE_CHANNEL_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+// Реєструє канал com.virok/maintenance (configure, setCartOpen, finished,
+// status) і потік подій com.virok/maintenance/events: фонове
+// обслуговування у простої каси (див. native/maintenance).
+//
+// Ущільнення архіву чеків виконується тут же, кроками по сегменту. Задачі
+// Dart (дельта-синхронізація, індекс пошуку, обслуговування бази)
+// отримують подію {job, action: "run"} і звітують finished; {job, action:
+// "preempt"} — каса ожила, задачу слід перервати на найближчій межі.
+//
+// Введення стежиться на |window| (клавіші, зокрема сканер, до його
+// фільтра) і на |view| (миша, дотик). Викликати один раз після створення
+// FlView.
+void maintenance_channel_register(FlBinaryMessenger* messenger,
+                                  GtkWindow* window, FlView* view);
+
+// Зупиняє планувальник до завершення застосунку.
+void maintenance_channel_shutdown();
+
+#endif  // RUNNER_MAINTENANCE_CHANNEL_H_
@@ -0,0 +1,95 @@
+#include "metrics_channel.h"
+
+#include <chrono>
+#include <map>
+#include <string>
+
+#include "channel_args.h"
+#include "metrics/metrics.h"
+#include "metrics/metrics_exporter.h"
+
+namespace {
+
+FlMethodChannel* metrics_channel = nullptr;
+virok::MetricsFileExporter metrics_exporter;
+
+// Мапа міток з Dart ({'payment': 'card'}) у текст міток Prometheus.
+// std::map дає стабільний порядок, тож однакові мітки — одна серія.
+std::string labels_arg(FlValue* args) {
+  FlValue* map = find_arg(args, "labels");
+  if (!map || fl_value_get_type(map) != FL_VALUE_TYPE_MAP) return {};
+
+  std::map<std::string, std::string> sorted;
+  for (size_t i = 0; i < fl_value_get_length(map); i++) {
+    FlValue* key = fl_value_get_map_key(map, i);
+    FlValue* value = fl_value_get_map_value(map, i);
+    if (fl_value_get_type(key) == FL_VALUE_TYPE_STRING &&
+        fl_value_get_type(value) == FL_VALUE_TYPE_STRING) {
+      sorted[fl_value_get_string(key)] = fl_value_get_string(value);
+    }
+  }
+  std::string labels;
+  for (const auto& [key, value] : sorted) {
+    if (!labels.empty()) labels.push_back(',');
+    labels.append(virok::MetricLabel(key, value));
+  }
+  return labels;
+}
+
+void metrics_method_call_cb(FlMethodChannel* channel,
+                            FlMethodCall* method_call, gpointer user_data) {
+  const std::string method = fl_method_call_get_name(method_call);
+  FlValue* args = fl_method_call_get_args(method_call);
+  virok::MetricsRegistry& registry = virok::MetricsRegistry::Get();
+  g_autoptr(FlMethodResponse) response = nullptr;
+
+  if (method == "start") {
+    const std::string lane = string_arg(args, "lane");
+    registry.SetConstLabels(lane.empty() ? std::string()
+                                         : virok::MetricLabel("lane", lane));
+    const auto interval =
+        std::chrono::milliseconds(int_arg(args, "intervalMs", 15000));
+    g_autoptr(FlValue) result = fl_value_new_bool(
+        metrics_exporter.Start(string_arg(args, "path"), interval));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (method == "stop") {
+    metrics_exporter.Stop();
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else if (method == "observe") {
+    registry
+        .GetHistogram(string_arg(args, "name"), string_arg(args, "help"),
+                      labels_arg(args))
+        ->Record(int_arg(args, "valueUs"));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else if (method == "count") {
+    registry
+        .GetCounter(string_arg(args, "name"), string_arg(args, "help"),
+                    labels_arg(args))
+        ->Add(static_cast<uint64_t>(int_arg(args, "delta", 1)));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else if (method == "gauge") {
+    registry
+        .GetGauge(string_arg(args, "name"), string_arg(args, "help"),
+                  labels_arg(args))
+        ->Set(int_arg(args, "value"));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else {
+    response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+  }
+
+  g_autoptr(GError) error = nullptr;
+  if (!fl_method_call_respond(method_call, response, &error)) {
+    g_warning("Failed to respond on com.virok/metrics: %s", error->message);
+  }
+}
+
+}  // namespace
+
+void metrics_channel_register(FlBinaryMessenger* messenger) {
+  g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+  metrics_channel = fl_method_channel_new(messenger, "com.virok/metrics",
+                                          FL_METHOD_CODEC(codec));
+  fl_method_channel_set_method_call_handler(metrics_channel,
+                                            metrics_method_call_cb, nullptr,
+                                            nullptr);
+}
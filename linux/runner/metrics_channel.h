@@ -0,0 +1,10 @@
+#ifndef RUNNER_METRICS_CHANNEL_H_
+#define RUNNER_METRICS_CHANNEL_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+// Реєструє канал com.virok/metrics: експорт знімків у файл Prometheus
+// (start/stop) і метрики з Dart (observe/count/gauge), див. native/metrics.
+void metrics_channel_register(FlBinaryMessenger* messenger);
+
+#endif  // RUNNER_METRICS_CHANNEL_H_
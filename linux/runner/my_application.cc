@@ -5,7 +5,20 @@
 #include <gdk/gdkx.h>
 #endif
 
+#include "archive_channel.h"
 #include "flutter/generated_plugin_registrant.h"
+#include "maintenance_channel.h"
+#include "metrics_channel.h"
+#include "parked_channel.h"
+#include "promo_channel.h"
+#include "report_channel.h"
+#include "scale_channel.h"
+#include "scanner_channel.h"
+#include "search_channel.h"
+#include "startup/startup_timeline.h"
+#include "startup_channel.h"
+#include "terminal_channel.h"
+#include "trace_channel.h"
 
 struct _MyApplication {
   GtkApplication parent_instance;
@@ -54,11 +67,28 @@ static void my_application_activate(GApplication* application) {
   fl_dart_project_set_dart_entrypoint_arguments(project, self->dart_entrypoint_arguments);
 
   FlView* view = fl_view_new(project);
+  virok::StartupTimeline::Get().Mark("engine");
   gtk_widget_show(GTK_WIDGET(view));
   gtk_container_add(GTK_CONTAINER(window), GTK_WIDGET(view));
 
   fl_register_plugins(FL_PLUGIN_REGISTRY(view));
 
+  // Native channels shared with the Windows runner (see native/).
+  FlBinaryMessenger* messenger =
+      fl_engine_get_binary_messenger(fl_view_get_engine(view));
+  search_channel_register(messenger);
+  report_channel_register(messenger);
+  trace_channel_register(messenger);
+  metrics_channel_register(messenger);
+  startup_channel_register(messenger);
+  promo_channel_register(messenger);
+  archive_channel_register(messenger);
+  parked_channel_register(messenger);
+  scale_channel_register(messenger);
+  terminal_channel_register(messenger);
+  maintenance_channel_register(messenger, window, view);
+  scanner_channel_register(messenger, window);
+
   gtk_widget_grab_focus(GTK_WIDGET(view));
 }
 
@@ -95,6 +125,10 @@ static void my_application_shutdown(GApplication* application) {
   //MyApplication* self = MY_APPLICATION(object);
 
   // Perform any actions required at application shutdown.
+  scale_channel_shutdown();
+  terminal_channel_shutdown();
+  maintenance_channel_shutdown();
+  trace_channel_shutdown();
 
   G_APPLICATION_CLASS(my_application_parent_class)->shutdown(application);
 }
@@ -0,0 +1,184 @@
+#include "parked_channel.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "channel_args.h"
+#include "metrics/metrics.h"
+#include "parking/parked_cart.h"
+#include "parking/parked_cart_store.h"
+#include "trace/trace.h"
+
+namespace {
+
+FlMethodChannel* parked_channel = nullptr;
+virok::ParkedCartStore parked_store;
+
+// Кошик у формі, яку чекає Dart (суми — в гривнях, маса — в кг).
+FlValue* cart_to_value(const virok::ParkedCart& cart) {
+  FlValue* lines = fl_value_new_list();
+  for (const virok::ParkedLine& line : cart.lines) {
+    FlValue* map = fl_value_new_map();
+    fl_value_set_string_take(map, "guid",
+                             fl_value_new_string(line.guid.c_str()));
+    fl_value_set_string_take(map, "name",
+                             fl_value_new_string(line.name.c_str()));
+    fl_value_set_string_take(map, "article",
+                             fl_value_new_string(line.article.c_str()));
+    fl_value_set_string_take(map, "category",
+                             fl_value_new_string(line.category.c_str()));
+    fl_value_set_string_take(map, "price",
+                             fl_value_new_float(line.price / 100.0));
+    fl_value_set_string_take(map, "quantity", fl_value_new_int(line.quantity));
+    fl_value_set_string_take(map, "weight",
+                             fl_value_new_float(line.weight_g / 1000.0));
+    fl_value_set_string_take(map, "discount",
+                             fl_value_new_float(line.discount / 100.0));
+    fl_value_append_take(lines, map);
+  }
+  FlValue* map = fl_value_new_map();
+  fl_value_set_string_take(map, "id",
+                           fl_value_new_int(static_cast<int64_t>(cart.id)));
+  fl_value_set_string_take(map, "parkedMs", fl_value_new_int(cart.parked_ms));
+  fl_value_set_string_take(map, "cashier",
+                           fl_value_new_string(cart.cashier.c_str()));
+  fl_value_set_string_take(map, "paymentForm",
+                           fl_value_new_string(cart.payment_form.c_str()));
+  fl_value_set_string_take(map, "total",
+                           fl_value_new_float(cart.total / 100.0));
+  fl_value_set_string_take(map, "lines", lines);
+  return map;
+}
+
+FlValue* summary_to_value(const virok::ParkedCartSummary& summary) {
+  FlValue* map = fl_value_new_map();
+  fl_value_set_string_take(
+      map, "id", fl_value_new_int(static_cast<int64_t>(summary.id)));
+  fl_value_set_string_take(map, "parkedMs",
+                           fl_value_new_int(summary.parked_ms));
+  fl_value_set_string_take(map, "cashier",
+                           fl_value_new_string(summary.cashier.c_str()));
+  fl_value_set_string_take(map, "paymentForm",
+                           fl_value_new_string(summary.payment_form.c_str()));
+  fl_value_set_string_take(map, "total",
+                           fl_value_new_float(summary.total / 100.0));
+  fl_value_set_string_take(
+      map, "lines", fl_value_new_int(static_cast<int64_t>(summary.lines)));
+  return map;
+}
+
+FlValue* stats_to_value(const virok::ParkedCartStoreStats& stats) {
+  FlValue* map = fl_value_new_map();
+  fl_value_set_string_take(
+      map, "carts", fl_value_new_int(static_cast<int64_t>(stats.carts)));
+  fl_value_set_string_take(
+      map, "bytes", fl_value_new_int(static_cast<int64_t>(stats.bytes)));
+  fl_value_set_string_take(
+      map, "deadBytes",
+      fl_value_new_int(static_cast<int64_t>(stats.dead_bytes)));
+  return map;
+}
+
+FlMethodResponse* success(FlValue* value) {
+  return FL_METHOD_RESPONSE(fl_method_success_response_new(value));
+}
+
+FlMethodResponse* failure(const char* code, const std::string& message) {
+  return FL_METHOD_RESPONSE(
+      fl_method_error_response_new(code, message.c_str(), nullptr));
+}
+
+FlMethodResponse* handle_parked_call(const std::string& method,
+                                     FlValue* args) {
+  if (method == "open") {
+    std::string error;
+    if (!parked_store.Open(string_arg(args, "path"), &error)) {
+      return failure("OPEN_FAILED", error);
+    }
+    g_autoptr(FlValue) result = stats_to_value(parked_store.stats());
+    return success(result);
+  }
+  if (method == "park") {
+    static virok::Histogram* const latency =
+        virok::MetricsRegistry::Get().GetHistogram(
+            "virok_parked_park_microseconds",
+            "Parked cart write time (to disk)");
+    virok::LatencyTimer timer(latency);
+    virok::ParkedCart cart;
+    std::string error;
+    if (!virok::ParseParkedCart(string_arg(args, "json"), &cart, &error)) {
+      return failure("INVALID_CART", error);
+    }
+    if (!parked_store.Park(&cart, &error)) {
+      return failure("WRITE_FAILED", error);
+    }
+    g_autoptr(FlValue) result =
+        fl_value_new_int(static_cast<int64_t>(cart.id));
+    return success(result);
+  }
+  if (method == "list") {
+    const std::vector<virok::ParkedCartSummary> carts =
+        parked_store.List(string_arg(args, "cashier"));
+    g_autoptr(FlValue) result = fl_value_new_list();
+    for (const virok::ParkedCartSummary& summary : carts) {
+      fl_value_append_take(result, summary_to_value(summary));
+    }
+    return success(result);
+  }
+  if (method == "get") {
+    virok::ParkedCart cart;
+    std::string error;
+    if (!parked_store.Get(static_cast<uint64_t>(int_arg(args, "id")), &cart,
+                          &error)) {
+      if (!error.empty()) return failure("READ_FAILED", error);
+      return success(nullptr);
+    }
+    g_autoptr(FlValue) result = cart_to_value(cart);
+    return success(result);
+  }
+  if (method == "take") {
+    static virok::Histogram* const latency =
+        virok::MetricsRegistry::Get().GetHistogram(
+            "virok_parked_take_microseconds", "Parked cart resume time");
+    virok::LatencyTimer timer(latency);
+    virok::ParkedCart cart;
+    std::string error;
+    if (!parked_store.Take(static_cast<uint64_t>(int_arg(args, "id")), &cart,
+                           &error)) {
+      if (!error.empty()) return failure("WRITE_FAILED", error);
+      return success(nullptr);
+    }
+    g_autoptr(FlValue) result = cart_to_value(cart);
+    return success(result);
+  }
+  if (method == "stats") {
+    g_autoptr(FlValue) result = stats_to_value(parked_store.stats());
+    return success(result);
+  }
+  return FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+}
+
+void parked_method_call_cb(FlMethodChannel* channel,
+                           FlMethodCall* method_call, gpointer user_data) {
+  const std::string method = fl_method_call_get_name(method_call);
+  virok::TraceScope trace_scope("parked", method);
+  g_autoptr(FlMethodResponse) response =
+      handle_parked_call(method, fl_method_call_get_args(method_call));
+
+  g_autoptr(GError) error = nullptr;
+  if (!fl_method_call_respond(method_call, response, &error)) {
+    g_warning("Failed to respond on com.virok/parked: %s", error->message);
+  }
+}
+
+}  // namespace
+
+void parked_channel_register(FlBinaryMessenger* messenger) {
+  g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+  parked_channel = fl_method_channel_new(messenger, "com.virok/parked",
+                                         FL_METHOD_CODEC(codec));
+  fl_method_channel_set_method_call_handler(parked_channel,
+                                            parked_method_call_cb, nullptr,
+                                            nullptr);
+}
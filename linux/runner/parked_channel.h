@@ -0,0 +1,11 @@
+#ifndef RUNNER_PARKED_CHANNEL_H_
+#define RUNNER_PARKED_CHANNEL_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+// Реєструє канал com.virok/parked: відкладені кошики каси, що переживають
+// перезапуск (див. native/parking). Викликати один раз після створення
+// FlView.
+void parked_channel_register(FlBinaryMessenger* messenger);
+
+#endif  // RUNNER_PARKED_CHANNEL_H_
@@ -0,0 +1,94 @@
+#include "promo_channel.h"
+
+#include <cmath>
+#include <string>
+
+#include "channel_args.h"
+#include "metrics/metrics.h"
+#include "promo/promo_service.h"
+#include "trace/trace.h"
+
+namespace {
+
+FlMethodChannel* promo_channel = nullptr;
+virok::PromoService promo_service;
+
+// Знижки рядків, що змінилися: {guid: знижка в гривнях}.
+FlValue* update_to_value(const virok::PromoUpdate& u) {
+  FlValue* changed = fl_value_new_map();
+  for (const auto& line : u.changed) {
+    fl_value_set_string_take(changed, line.item.c_str(),
+                             fl_value_new_float(line.discount / 100.0));
+  }
+  FlValue* map = fl_value_new_map();
+  fl_value_set_string_take(map, "changed", changed);
+  fl_value_set_string_take(map, "total",
+                           fl_value_new_float(u.total_discount / 100.0));
+  fl_value_set_string_take(map, "elapsedUs", fl_value_new_int(u.elapsed_us));
+  return map;
+}
+
+void record_latency(const virok::PromoUpdate& u) {
+  static virok::Histogram* const latency =
+      virok::MetricsRegistry::Get().GetHistogram(
+          "virok_promo_update_microseconds",
+          "Native promotion re-evaluation time per cart change");
+  latency->Record(u.elapsed_us);
+}
+
+void promo_method_call_cb(FlMethodChannel* channel, FlMethodCall* method_call,
+                          gpointer user_data) {
+  const std::string method = fl_method_call_get_name(method_call);
+  FlValue* args = fl_method_call_get_args(method_call);
+  virok::TraceScope trace_scope("promo", method);
+  g_autoptr(FlMethodResponse) response = nullptr;
+
+  if (method == "loadRules") {
+    virok::PromoUpdate u;
+    std::string error;
+    if (promo_service.LoadRules(string_arg(args, "json"), &u, &error)) {
+      g_autoptr(FlValue) result = update_to_value(u);
+      fl_value_set_string_take(
+          result, "rules",
+          fl_value_new_int(static_cast<int64_t>(promo_service.rule_count())));
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+    } else {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "INVALID_RULES", error.c_str(), nullptr));
+    }
+  } else if (method == "setLine" || method == "removeLine") {
+    virok::PromoUpdate u;
+    if (method == "setLine") {
+      promo_service.SetLine(
+          string_arg(args, "guid"), string_arg(args, "category"),
+          std::llround(double_arg(args, "price") * 100),
+          std::llround(double_arg(args, "quantity") * 1000), &u);
+    } else {
+      promo_service.RemoveLine(string_arg(args, "guid"), &u);
+    }
+    record_latency(u);
+    g_autoptr(FlValue) result = update_to_value(u);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (method == "clear") {
+    promo_service.Clear();
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else {
+    response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+  }
+
+  g_autoptr(GError) error = nullptr;
+  if (!fl_method_call_respond(method_call, response, &error)) {
+    g_warning("Failed to respond on com.virok/promo: %s", error->message);
+  }
+}
+
+}  // namespace
+
+void promo_channel_register(FlBinaryMessenger* messenger) {
+  g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+  promo_channel = fl_method_channel_new(messenger, "com.virok/promo",
+                                        FL_METHOD_CODEC(codec));
+  fl_method_channel_set_method_call_handler(promo_channel,
+                                            promo_method_call_cb, nullptr,
+                                            nullptr);
+}
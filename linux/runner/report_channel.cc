@@ -0,0 +1,332 @@
+#include "report_channel.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "archive_channel.h"
+#include "channel_args.h"
+#include "metrics/metrics.h"
+#include "reconcile/shift_reconciler.h"
+#include "report/report_decoder.h"
+#include "trace/trace.h"
+
+namespace {
+
+FlMethodChannel* report_channel = nullptr;
+
+void set_string(FlValue* map, const char* key, const std::string& value) {
+  fl_value_set_string_take(
+      map, key, fl_value_new_string_sized(value.data(), value.size()));
+}
+
+// -1 / NaN / "" означають "немає" і в Dart стають null.
+void set_optional_int(FlValue* map, const char* key, int64_t value) {
+  if (value >= 0) fl_value_set_string_take(map, key, fl_value_new_int(value));
+}
+
+void set_optional_float(FlValue* map, const char* key, double value) {
+  if (!std::isnan(value)) {
+    fl_value_set_string_take(map, key, fl_value_new_float(value));
+  }
+}
+
+void set_optional_string(FlValue* map, const char* key,
+                         const std::string& value) {
+  if (!value.empty()) set_string(map, key, value);
+}
+
+FlValue* pays_to_value(const std::vector<virok::ReportPay>& pays) {
+  FlValue* list = fl_value_new_list();
+  for (const auto& p : pays) {
+    FlValue* m = fl_value_new_map();
+    fl_value_set_string_take(m, "type", fl_value_new_int(p.type));
+    set_string(m, "name", p.name);
+    fl_value_set_string_take(m, "sumP", fl_value_new_float(p.sum_p));
+    fl_value_set_string_take(m, "sumM", fl_value_new_float(p.sum_m));
+    fl_value_append_take(list, m);
+  }
+  return list;
+}
+
+FlValue* report_to_value(const virok::Report& r) {
+  FlValue* map = fl_value_new_map();
+  set_optional_int(map, "res", r.res);
+  fl_value_set_string_take(map, "task", fl_value_new_int(r.task));
+  set_optional_string(map, "dt", r.dt);
+  set_optional_string(map, "fisid", r.fisid);
+  set_optional_string(map, "cashier", r.cashier);
+  fl_value_set_string_take(map, "safe", fl_value_new_float(r.safe));
+  fl_value_set_string_take(map, "safeStartShift",
+                           fl_value_new_float(r.safe_start_shift));
+  fl_value_set_string_take(map, "isOffline", fl_value_new_bool(r.is_offline));
+  set_optional_int(map, "shiftLink", r.shift_link);
+  set_optional_int(map, "shiftPrevLink", r.shift_prev_link);
+  set_optional_int(map, "vacantOffNums", r.vacant_off_nums);
+  fl_value_set_string_take(map, "isZRep", fl_value_new_bool(r.is_z_rep));
+  set_optional_string(map, "shiftOpened", r.shift_opened);
+  set_optional_float(map, "serviceInput", r.service_input);
+  set_optional_float(map, "serviceOutput", r.service_output);
+
+  if (r.has_receipt) {
+    FlValue* m = fl_value_new_map();
+    fl_value_set_string_take(m, "lastDocnoP",
+                             fl_value_new_int(r.receipt.last_docno_p));
+    fl_value_set_string_take(m, "lastDocnoM",
+                             fl_value_new_int(r.receipt.last_docno_m));
+    fl_value_set_string_take(m, "count14", fl_value_new_int(r.receipt.count_14));
+    fl_value_set_string_take(m, "countP", fl_value_new_int(r.receipt.count_p));
+    fl_value_set_string_take(m, "countM", fl_value_new_int(r.receipt.count_m));
+    fl_value_set_string_take(map, "receipt", m);
+  }
+  if (r.has_summary) {
+    // Суми підсумків пласким списком у порядку полів SummaryData.
+    const auto& s = r.summary;
+    const double sums[] = {s.base_p, s.base_m, s.taxex_p, s.taxex_m,
+                           s.disc_p, s.disc_m, s.calc_p,  s.calc_m};
+    fl_value_set_string_take(map, "summary", fl_value_new_float_list(sums, 8));
+  }
+
+  FlValue* taxes = fl_value_new_list();
+  for (const auto& t : r.taxes) {
+    FlValue* m = fl_value_new_map();
+    fl_value_set_string_take(m, "grCode", fl_value_new_int(t.gr_code));
+    fl_value_set_string_take(m, "baseSumP", fl_value_new_float(t.base_sum_p));
+    fl_value_set_string_take(m, "baseSumM", fl_value_new_float(t.base_sum_m));
+    set_string(m, "taxName", t.tax_name);
+    set_string(m, "taxFname", t.tax_fname);
+    set_string(m, "taxLit", t.tax_lit);
+    fl_value_set_string_take(m, "taxPercent", fl_value_new_float(t.tax_percent));
+    fl_value_set_string_take(m, "taxSumP", fl_value_new_float(t.tax_sum_p));
+    fl_value_set_string_take(m, "taxSumM", fl_value_new_float(t.tax_sum_m));
+    fl_value_append_take(taxes, m);
+  }
+  fl_value_set_string_take(map, "taxes", taxes);
+  fl_value_set_string_take(map, "pays", pays_to_value(r.pays));
+  fl_value_set_string_take(map, "money", pays_to_value(r.money));
+  fl_value_set_string_take(map, "cash", pays_to_value(r.cash));
+
+  if (r.has_last_check) {
+    FlValue* m = fl_value_new_map();
+    fl_value_set_string_take(m, "packnum",
+                             fl_value_new_int(r.last_check.packnum));
+    fl_value_set_string_take(m, "docnum", fl_value_new_int(r.last_check.docnum));
+    set_string(m, "fisnum", r.last_check.fisnum);
+    fl_value_set_string_take(m, "packtype",
+                             fl_value_new_int(r.last_check.packtype));
+    fl_value_set_string_take(map, "lastCheck", m);
+  }
+
+  FlValue* warnings = fl_value_new_list();
+  for (const auto& w : r.warnings) {
+    FlValue* m = fl_value_new_map();
+    fl_value_set_string_take(m, "code", fl_value_new_int(w.code));
+    set_string(m, "wtxt", w.wtxt);
+    fl_value_append_take(warnings, m);
+  }
+  fl_value_set_string_take(map, "warnings", warnings);
+
+  if (r.has_billing) {
+    FlValue* m = fl_value_new_map();
+    set_string(m, "paidDateTo", r.billing.paid_date_to);
+    fl_value_set_string_take(
+        m, "enoughToRenewSubscription",
+        fl_value_new_int(r.billing.enough_to_renew_subscription));
+    fl_value_set_string_take(map, "billing", m);
+  }
+  if (r.has_print_header) {
+    const auto& h = r.print_header;
+    FlValue* m = fl_value_new_map();
+    set_optional_string(m, "name", h.name);
+    set_optional_string(m, "shopname", h.shopname);
+    set_optional_string(m, "shopad", h.shopad);
+    set_optional_string(m, "vatCode", h.vat_code);
+    set_optional_string(m, "fisCode", h.fis_code);
+    set_optional_string(m, "dt", h.dt);
+    fl_value_set_string_take(m, "isOffline", fl_value_new_bool(h.is_offline));
+    set_optional_string(m, "fisid", h.fisid);
+    set_optional_string(m, "cashier", h.cashier);
+    fl_value_set_string_take(map, "printHeader", m);
+  }
+
+  set_optional_string(map, "visualization", r.visualization);
+  if (!r.print_data.empty()) {
+    fl_value_set_string_take(
+        map, "printData",
+        fl_value_new_uint8_list(
+            reinterpret_cast<const uint8_t*>(r.print_data.data()),
+            r.print_data.size()));
+  }
+  return map;
+}
+
+// Підсумки X-звіту, які Dart уже має в XReportData:
+//   {"safe", "countP", "countM", "pays": [{"name", "sumP", "sumM"}],
+//    "taxes": [{"grCode", "taxLit", "baseSumP", "baseSumM"}]}
+virok::Report report_from_value(FlValue* value) {
+  virok::Report report;
+  report.safe = double_arg(value, "safe");
+  report.has_receipt = true;
+  report.receipt.count_p = int_arg(value, "countP");
+  report.receipt.count_m = int_arg(value, "countM");
+  FlValue* pays = find_arg(value, "pays");
+  if (pays != nullptr && fl_value_get_type(pays) == FL_VALUE_TYPE_LIST) {
+    for (size_t i = 0; i < fl_value_get_length(pays); i++) {
+      FlValue* item = fl_value_get_list_value(pays, i);
+      virok::ReportPay& pay = report.pays.emplace_back();
+      pay.name = string_arg(item, "name");
+      pay.sum_p = double_arg(item, "sumP");
+      pay.sum_m = double_arg(item, "sumM");
+    }
+  }
+  FlValue* taxes = find_arg(value, "taxes");
+  if (taxes != nullptr && fl_value_get_type(taxes) == FL_VALUE_TYPE_LIST) {
+    for (size_t i = 0; i < fl_value_get_length(taxes); i++) {
+      FlValue* item = fl_value_get_list_value(taxes, i);
+      virok::ReportTax& tax = report.taxes.emplace_back();
+      tax.gr_code = int_arg(item, "grCode");
+      tax.tax_lit = string_arg(item, "taxLit");
+      tax.base_sum_p = double_arg(item, "baseSumP");
+      tax.base_sum_m = double_arg(item, "baseSumM");
+    }
+  }
+  return report;
+}
+
+// Звіт звірки; суми — у копійках.
+FlValue* reconcile_to_value(const virok::ReconcileReport& r) {
+  FlValue* map = fl_value_new_map();
+  fl_value_set_string_take(map, "balanced", fl_value_new_bool(r.balanced()));
+  FlValue* forms = fl_value_new_list();
+  for (const auto& f : r.forms) {
+    FlValue* m = fl_value_new_map();
+    set_string(m, "form", f.form);
+    fl_value_set_string_take(m, "device", fl_value_new_int(f.device));
+    fl_value_set_string_take(m, "server", fl_value_new_int(f.server));
+    fl_value_set_string_take(m, "till", fl_value_new_int(f.till));
+    fl_value_append_take(forms, m);
+  }
+  fl_value_set_string_take(map, "forms", forms);
+  FlValue* taxes = fl_value_new_list();
+  for (const auto& t : r.taxes) {
+    FlValue* m = fl_value_new_map();
+    set_string(m, "group", t.group);
+    fl_value_set_string_take(m, "device", fl_value_new_int(t.device));
+    fl_value_set_string_take(m, "server", fl_value_new_int(t.server));
+    fl_value_set_string_take(m, "serverKnown",
+                             fl_value_new_bool(t.server_known));
+    fl_value_append_take(taxes, m);
+  }
+  fl_value_set_string_take(map, "taxes", taxes);
+  FlValue* checks = fl_value_new_list();
+  for (const auto& c : r.checks) {
+    FlValue* m = fl_value_new_map();
+    fl_value_set_string_take(
+        m, "kind", fl_value_new_string(virok::CheckDiscrepancyName(c.kind)));
+    set_optional_string(m, "number", c.number);
+    set_optional_string(m, "rrn", c.rrn);
+    fl_value_set_string_take(m, "serverAmount",
+                             fl_value_new_int(c.server_amount));
+    fl_value_set_string_take(m, "tillAmount", fl_value_new_int(c.till_amount));
+    set_optional_string(m, "serverForm", c.server_form);
+    set_optional_string(m, "tillForm", c.till_form);
+    fl_value_append_take(checks, m);
+  }
+  fl_value_set_string_take(map, "checks", checks);
+  fl_value_set_string_take(map, "deviceSales",
+                           fl_value_new_int(r.device_sales));
+  fl_value_set_string_take(map, "deviceRefunds",
+                           fl_value_new_int(r.device_refunds));
+  fl_value_set_string_take(map, "serverSales",
+                           fl_value_new_int(r.server_sales));
+  fl_value_set_string_take(map, "serverRefunds",
+                           fl_value_new_int(r.server_refunds));
+  fl_value_set_string_take(map, "tillSales", fl_value_new_int(r.till_sales));
+  fl_value_set_string_take(map, "tillRefunds",
+                           fl_value_new_int(r.till_refunds));
+  fl_value_set_string_take(map, "cashExpected",
+                           fl_value_new_int(r.cash_expected));
+  set_optional_int(map, "cashCounted", r.cash_counted);
+  fl_value_set_string_take(map, "loadUs", fl_value_new_int(r.load_us));
+  fl_value_set_string_take(map, "elapsedUs", fl_value_new_int(r.elapsed_us));
+  return map;
+}
+
+void report_method_call_cb(FlMethodChannel* channel, FlMethodCall* method_call,
+                           gpointer user_data) {
+  const std::string method = fl_method_call_get_name(method_call);
+  FlValue* args = fl_method_call_get_args(method_call);
+  g_autoptr(FlMethodResponse) response = nullptr;
+
+  if (method == "decode") {
+    VIROK_TRACE_SCOPE("report", "decode");
+    static virok::Histogram* const latency =
+        virok::MetricsRegistry::Get().GetHistogram(
+            "virok_report_decode_microseconds",
+            "Native X/Z report decoding time");
+    virok::LatencyTimer timer(latency);
+    virok::Report report;
+    std::string error;
+    if (virok::DecodeReport(string_arg(args, "json"), &report, &error)) {
+      g_autoptr(FlValue) result = report_to_value(report);
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+    } else {
+      response = FL_METHOD_RESPONSE(
+          fl_method_error_response_new("PARSE_ERROR", error.c_str(), nullptr));
+    }
+  } else if (method == "reconcile") {
+    VIROK_TRACE_SCOPE("report", "reconcile");
+    static virok::Histogram* const latency =
+        virok::MetricsRegistry::Get().GetHistogram(
+            "virok_reconcile_microseconds",
+            "Shift reconciliation time before the Z-report");
+    virok::LatencyTimer timer(latency);
+    const virok::Report device = report_from_value(find_arg(args, "report"));
+    const std::string checks_json = string_arg(args, "checks", "[]");
+    const int64_t shift_opened_ms = int_arg(args, "shiftOpenedMs");
+    virok::ReconcileSources sources;
+    sources.device = [&device](virok::Report* report, std::string*) {
+      *report = device;
+      return true;
+    };
+    sources.server = [&checks_json](std::vector<virok::ReconcileCheck>* out,
+                                    std::string* error) {
+      return virok::ParseServerChecks(checks_json, out, error);
+    };
+    sources.till = [shift_opened_ms](std::vector<virok::ReconcileCheck>* out,
+                                     std::string* error) {
+      if (archive_shift_checks(shift_opened_ms, out)) return true;
+      *error = "Receipt archive is not open";
+      return false;
+    };
+    const double drawer = double_arg(args, "drawer", -1);
+    sources.drawer_counted = drawer < 0 ? -1 : std::llround(drawer * 100);
+    virok::ReconcileReport report;
+    std::string error;
+    if (virok::ReconcileShift(sources, &report, &error)) {
+      g_autoptr(FlValue) result = reconcile_to_value(report);
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+    } else {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "RECONCILE_FAILED", error.c_str(), nullptr));
+    }
+  } else {
+    response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+  }
+
+  g_autoptr(GError) error = nullptr;
+  if (!fl_method_call_respond(method_call, response, &error)) {
+    g_warning("Failed to respond on com.virok/report: %s", error->message);
+  }
+}
+
+}  // namespace
+
+void report_channel_register(FlBinaryMessenger* messenger) {
+  g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+  report_channel = fl_method_channel_new(messenger, "com.virok/report",
+                                         FL_METHOD_CODEC(codec));
+  fl_method_channel_set_method_call_handler(report_channel,
+                                            report_method_call_cb, nullptr,
+                                            nullptr);
+}
@@ -0,0 +1,11 @@
+#ifndef RUNNER_REPORT_CHANNEL_H_
+#define RUNNER_REPORT_CHANNEL_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+// Реєструє канал com.virok/report: розбір JSON X/Z-звітів у форму, яку
+// читає XReportData.fromNative (див. native/report), і звірка зміни перед
+// Z-звітом (reconcile, див. native/reconcile).
+void report_channel_register(FlBinaryMessenger* messenger);
+
+#endif  // RUNNER_REPORT_CHANNEL_H_
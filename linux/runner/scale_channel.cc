@@ -0,0 +1,147 @@
+#include "scale_channel.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "channel_args.h"
+#include "scale/scale_driver.h"
+#include "trace/trace.h"
+
+namespace {
+
+FlMethodChannel* scale_channel = nullptr;
+FlEventChannel* scale_events = nullptr;
+// Dart слухає потік подій (лише в головному потоці).
+bool scale_listening = false;
+std::unique_ptr<virok::ScaleDriver> scale_driver;
+std::string scale_port;
+
+FlValue* event_to_value(const virok::ScaleEvent& event) {
+  FlValue* map = fl_value_new_map();
+  fl_value_set_string_take(map, "type",
+                           fl_value_new_string(virok::ScaleEventName(
+                               event.type)));
+  fl_value_set_string_take(map, "grams", fl_value_new_int(event.grams));
+  if (event.type == virok::ScaleEvent::Type::kStable) {
+    fl_value_set_string_take(map, "settleUs",
+                             fl_value_new_int(event.settle_latency_us));
+    fl_value_set_string_take(map, "loadUs",
+                             fl_value_new_int(event.load_latency_us));
+  }
+  if (!event.error.empty()) {
+    fl_value_set_string_take(map, "error",
+                             fl_value_new_string(event.error.c_str()));
+  }
+  return map;
+}
+
+gboolean send_event_cb(gpointer user_data) {
+  std::unique_ptr<virok::ScaleEvent> event(
+      static_cast<virok::ScaleEvent*>(user_data));
+  if (scale_events == nullptr || !scale_listening) return G_SOURCE_REMOVE;
+  g_autoptr(FlValue) value = event_to_value(*event);
+  g_autoptr(GError) error = nullptr;
+  if (!fl_event_channel_send(scale_events, value, nullptr, &error)) {
+    g_warning("Failed to send on com.virok/scale/events: %s",
+              error->message);
+  }
+  return G_SOURCE_REMOVE;
+}
+
+// Потік ваг: подія переходить у головний цикл.
+void on_scale_event(const virok::ScaleEvent& event) {
+  g_idle_add(send_event_cb, new virok::ScaleEvent(event));
+}
+
+FlMethodErrorResponse* scale_listen_cb(FlEventChannel* channel, FlValue* args,
+                                       gpointer user_data) {
+  scale_listening = true;
+  return nullptr;
+}
+
+FlMethodErrorResponse* scale_cancel_cb(FlEventChannel* channel, FlValue* args,
+                                       gpointer user_data) {
+  scale_listening = false;
+  return nullptr;
+}
+
+void scale_method_call_cb(FlMethodChannel* channel, FlMethodCall* method_call,
+                          gpointer user_data) {
+  const std::string method = fl_method_call_get_name(method_call);
+  FlValue* args = fl_method_call_get_args(method_call);
+  virok::TraceScope trace_scope("scale", method);
+  g_autoptr(FlMethodResponse) response = nullptr;
+
+  if (method == "start") {
+    virok::ScaleOptions options;
+    options.port = string_arg(args, "port");
+    options.baud = static_cast<int>(int_arg(args, "baud", 9600));
+    std::string error;
+    if (!virok::ParseScaleProtocol(string_arg(args, "protocol", "cas"),
+                                   &options.protocol)) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "UNKNOWN_PROTOCOL", "Unknown scale protocol", nullptr));
+    } else {
+      options.stable.settle = std::chrono::milliseconds(
+          int_arg(args, "settleMs", options.stable.settle.count()));
+      options.stable.tolerance_grams =
+          int_arg(args, "toleranceGrams", options.stable.tolerance_grams);
+      options.stable.min_grams =
+          int_arg(args, "minGrams", options.stable.min_grams);
+      if (scale_driver->Start(options, &error)) {
+        scale_port = options.port;
+        g_autoptr(FlValue) result = fl_value_new_bool(TRUE);
+        response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+      } else {
+        scale_port.clear();
+        response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+            "OPEN_FAILED", error.c_str(), nullptr));
+      }
+    }
+  } else if (method == "stop") {
+    scale_driver->Stop();
+    scale_port.clear();
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else if (method == "status") {
+    g_autoptr(FlValue) result = fl_value_new_map();
+    fl_value_set_string_take(result, "running",
+                             fl_value_new_bool(scale_driver->running()));
+    fl_value_set_string_take(result, "port",
+                             fl_value_new_string(scale_port.c_str()));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (method == "stableWeight") {
+    const int64_t grams = scale_driver->stable_grams();
+    g_autoptr(FlValue) result =
+        grams < 0 ? fl_value_new_null() : fl_value_new_int(grams);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else {
+    response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+  }
+
+  g_autoptr(GError) error = nullptr;
+  if (!fl_method_call_respond(method_call, response, &error)) {
+    g_warning("Failed to respond on com.virok/scale: %s", error->message);
+  }
+}
+
+}  // namespace
+
+void scale_channel_register(FlBinaryMessenger* messenger) {
+  scale_driver = std::make_unique<virok::ScaleDriver>(on_scale_event);
+  g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+  scale_channel = fl_method_channel_new(messenger, "com.virok/scale",
+                                        FL_METHOD_CODEC(codec));
+  fl_method_channel_set_method_call_handler(scale_channel,
+                                            scale_method_call_cb, nullptr,
+                                            nullptr);
+  scale_events = fl_event_channel_new(messenger, "com.virok/scale/events",
+                                      FL_METHOD_CODEC(codec));
+  fl_event_channel_set_stream_handlers(scale_events, scale_listen_cb,
+                                       scale_cancel_cb, nullptr, nullptr);
+}
+
+void scale_channel_shutdown() {
+  if (scale_driver) scale_driver->Stop();
+  scale_listening = false;
+}
@@ -0,0 +1,15 @@
+#ifndef RUNNER_SCALE_CHANNEL_H_
+#define RUNNER_SCALE_CHANNEL_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+// Реєструє канал com.virok/scale (start, stop, status) і потік подій
+// com.virok/scale/events: маса з торгових ваг, щойно вона встановилася
+// (див. native/scale). Події з потоку ваг передаються в головний цикл GLib.
+// Викликати один раз після створення FlView.
+void scale_channel_register(FlBinaryMessenger* messenger);
+
+// Зупиняє ваги до завершення застосунку.
+void scale_channel_shutdown();
+
+#endif  // RUNNER_SCALE_CHANNEL_H_
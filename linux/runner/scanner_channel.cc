@@ -0,0 +1,281 @@
+#include "scanner_channel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <string>
+
+#include "channel_args.h"
+#include "scanner/scanner_key_filter.h"
+#include "trace/trace.h"
+
+namespace {
+
+using Clock = virok::ScannerKeyFilter::Clock;
+
+FlMethodChannel* scanner_channel = nullptr;
+FlEventChannel* scanner_events = nullptr;
+bool scanner_listening = false;
+GtkWidget* scanner_window = nullptr;
+bool scanner_enabled = true;
+virok::ScannerKeyFilter scanner_filter;
+// Копії утриманих подій за токеном ScannerKey.
+std::map<uint64_t, GdkEvent*> held_events;
+uint64_t next_token = 1;
+guint expire_source = 0;
+// Відтворюються утримані події: обробник пропускає їх до FlView.
+bool replaying = false;
+
+// Час подій береться з самих подій (мс X/Wayland), а не з моменту
+// обробки: клавіші людини, що накопичилися за довгий кадр, інакше
+// виглядали б як сплеск сканера.
+bool has_origin = false;
+guint32 origin_ms = 0;
+Clock::time_point origin;
+
+FILE* record_file = nullptr;
+bool record_started = false;
+Clock::time_point record_origin;
+
+Clock::time_point event_time(guint32 ms) {
+  if (!has_origin) {
+    has_origin = true;
+    origin_ms = ms;
+    origin = Clock::now();
+  }
+  const guint32 elapsed_ms = ms - origin_ms;
+  return origin + std::chrono::milliseconds(elapsed_ms);
+}
+
+char32_t key_char(const GdkEventKey* event) {
+  if (event->state & (GDK_CONTROL_MASK | GDK_MOD1_MASK | GDK_SUPER_MASK)) {
+    return 0;
+  }
+  switch (event->keyval) {
+    case GDK_KEY_Return:
+    case GDK_KEY_KP_Enter:
+    case GDK_KEY_ISO_Enter:
+      return U'\r';
+    case GDK_KEY_Tab:
+      return U'\t';
+    default:
+      return gdk_keyval_to_unicode(event->keyval);
+  }
+}
+
+void send_barcode(const std::string& barcode, int64_t burst_us) {
+  if (scanner_events == nullptr || !scanner_listening) return;
+  g_autoptr(FlValue) value = fl_value_new_map();
+  fl_value_set_string_take(value, "barcode",
+                           fl_value_new_string(barcode.c_str()));
+  fl_value_set_string_take(value, "burstUs", fl_value_new_int(burst_us));
+  g_autoptr(GError) error = nullptr;
+  if (!fl_event_channel_send(scanner_events, value, nullptr, &error)) {
+    g_warning("Failed to send on com.virok/scanner/events: %s",
+              error->message);
+  }
+}
+
+void free_held(uint64_t token) {
+  auto it = held_events.find(token);
+  if (it == held_events.end()) return;
+  gdk_event_free(it->second);
+  held_events.erase(it);
+}
+
+void apply_output(virok::ScannerOutput* out) {
+  replaying = true;
+  for (uint64_t token : out->release) {
+    auto it = held_events.find(token);
+    if (it == held_events.end()) continue;
+    gtk_widget_event(scanner_window, it->second);
+    free_held(token);
+  }
+  replaying = false;
+  for (uint64_t token : out->drop) free_held(token);
+  if (!out->barcode.empty()) send_barcode(out->barcode, out->burst_us);
+  out->Clear();
+}
+
+gboolean expire_cb(gpointer user_data) {
+  expire_source = 0;
+  virok::ScannerOutput out;
+  scanner_filter.Expire(
+      scanner_filter.deadline() + std::chrono::milliseconds(1), &out);
+  apply_output(&out);
+  return G_SOURCE_REMOVE;
+}
+
+// Таймер на deadline() фільтра, відрахований від останньої клавіші.
+void reschedule_expire(Clock::time_point now) {
+  if (expire_source != 0) {
+    g_source_remove(expire_source);
+    expire_source = 0;
+  }
+  if (!scanner_filter.holding()) return;
+  const int64_t wait_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          scanner_filter.deadline() - now)
+          .count() +
+      1;
+  expire_source = g_timeout_add(
+      static_cast<guint>(std::max<int64_t>(wait_ms, 1)), expire_cb, nullptr);
+}
+
+void flush_held() {
+  virok::ScannerOutput out;
+  scanner_filter.Flush(&out);
+  apply_output(&out);
+  reschedule_expire(Clock::now());
+}
+
+gboolean key_event_cb(GtkWidget* widget, GdkEventKey* event,
+                      gpointer user_data) {
+  // Без слухача штрихкод нікому віддати: клавіші йдуть у FlView як є.
+  if (replaying || !scanner_enabled || !scanner_listening) return FALSE;
+
+  virok::ScannerKey key;
+  key.type = event->type == GDK_KEY_PRESS ? virok::ScannerKey::Type::kDown
+                                          : virok::ScannerKey::Type::kUp;
+  key.code = event->hardware_keycode;
+  key.ch = key_char(event);
+  key.modifier = event->is_modifier;
+  key.time = event_time(event->time);
+  key.token = next_token++;
+
+  if (record_file != nullptr) {
+    if (!record_started) {
+      record_started = true;
+      record_origin = key.time;
+    }
+    std::fprintf(record_file, "%s\n",
+                 virok::FormatScannerKey(key, record_origin).c_str());
+  }
+
+  virok::ScannerOutput out;
+  const bool taken = scanner_filter.Filter(key, &out);
+  if (taken) {
+    held_events[key.token] =
+        gdk_event_copy(reinterpret_cast<GdkEvent*>(event));
+  }
+  apply_output(&out);
+  reschedule_expire(key.time);
+  return taken ? TRUE : FALSE;
+}
+
+gboolean focus_out_cb(GtkWidget* widget, GdkEventFocus* event,
+                      gpointer user_data) {
+  flush_held();
+  return FALSE;
+}
+
+FlMethodErrorResponse* scanner_listen_cb(FlEventChannel* channel,
+                                         FlValue* args, gpointer user_data) {
+  scanner_listening = true;
+  return nullptr;
+}
+
+FlMethodErrorResponse* scanner_cancel_cb(FlEventChannel* channel,
+                                         FlValue* args, gpointer user_data) {
+  scanner_listening = false;
+  // Сплеск, утриманий до відписки, повертається застосунку клавішами.
+  flush_held();
+  return nullptr;
+}
+
+// Перший символ рядка з Dart; 0 — порожній рядок.
+char32_t first_char(const std::string& text) {
+  if (text.empty()) return 0;
+  const gunichar c = g_utf8_get_char_validated(
+      text.c_str(), static_cast<gssize>(text.size()));
+  // (gunichar)-1 і -2 — некоректний UTF-8.
+  return c >= static_cast<gunichar>(-2) ? 0 : c;
+}
+
+void scanner_method_call_cb(FlMethodChannel* channel,
+                            FlMethodCall* method_call, gpointer user_data) {
+  const std::string method = fl_method_call_get_name(method_call);
+  FlValue* args = fl_method_call_get_args(method_call);
+  virok::TraceScope trace_scope("scanner", method);
+  g_autoptr(FlMethodResponse) response = nullptr;
+
+  if (method == "configure") {
+    flush_held();
+    virok::ScannerOptions options = scanner_filter.options();
+    scanner_enabled = bool_arg(args, "enabled", scanner_enabled);
+    options.max_key_gap = std::chrono::milliseconds(
+        int_arg(args, "maxGapMs", options.max_key_gap.count()));
+    options.min_length = static_cast<size_t>(int_arg(
+        args, "minLength", static_cast<int64_t>(options.min_length)));
+    options.prefix_timeout = std::chrono::milliseconds(
+        int_arg(args, "prefixTimeoutMs", options.prefix_timeout.count()));
+    if (find_arg(args, "prefix") != nullptr) {
+      options.prefix = first_char(string_arg(args, "prefix"));
+    }
+    if (find_arg(args, "suffix") != nullptr) {
+      options.suffix = first_char(string_arg(args, "suffix"));
+    }
+    scanner_filter.set_options(options);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else if (method == "record") {
+    // Запис потоку клавіш для native/test/data/scanner; порожній path
+    // зупиняє запис.
+    if (record_file != nullptr) {
+      std::fclose(record_file);
+      record_file = nullptr;
+    }
+    const std::string path = string_arg(args, "path");
+    if (!path.empty()) {
+      record_file = std::fopen(path.c_str(), "w");
+      record_started = false;
+    }
+    if (!path.empty() && record_file == nullptr) {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "OPEN_FAILED", "Cannot open the key recording", nullptr));
+    } else {
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+    }
+  } else if (method == "status") {
+    g_autoptr(FlValue) result = fl_value_new_map();
+    fl_value_set_string_take(result, "enabled",
+                             fl_value_new_bool(scanner_enabled));
+    fl_value_set_string_take(result, "holding",
+                             fl_value_new_bool(scanner_filter.holding()));
+    fl_value_set_string_take(result, "recording",
+                             fl_value_new_bool(record_file != nullptr));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else {
+    response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+  }
+
+  g_autoptr(GError) error = nullptr;
+  if (!fl_method_call_respond(method_call, response, &error)) {
+    g_warning("Failed to respond on com.virok/scanner: %s", error->message);
+  }
+}
+
+}  // namespace
+
+void scanner_channel_register(FlBinaryMessenger* messenger,
+                              GtkWindow* window) {
+  scanner_window = GTK_WIDGET(window);
+  // Обробники вікна спрацьовують до того, як GtkWindow передасть клавішу
+  // віджету з фокусом (FlView).
+  g_signal_connect(scanner_window, "key-press-event",
+                   G_CALLBACK(key_event_cb), nullptr);
+  g_signal_connect(scanner_window, "key-release-event",
+                   G_CALLBACK(key_event_cb), nullptr);
+  g_signal_connect(scanner_window, "focus-out-event", G_CALLBACK(focus_out_cb),
+                   nullptr);
+
+  g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+  scanner_channel = fl_method_channel_new(messenger, "com.virok/scanner",
+                                          FL_METHOD_CODEC(codec));
+  fl_method_channel_set_method_call_handler(
+      scanner_channel, scanner_method_call_cb, nullptr, nullptr);
+  scanner_events = fl_event_channel_new(messenger, "com.virok/scanner/events",
+                                        FL_METHOD_CODEC(codec));
+  fl_event_channel_set_stream_handlers(scanner_events, scanner_listen_cb,
+                                       scanner_cancel_cb, nullptr, nullptr);
+}
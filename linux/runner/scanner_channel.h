@@ -0,0 +1,14 @@
+#ifndef RUNNER_SCANNER_CHANNEL_H_
+#define RUNNER_SCANNER_CHANNEL_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+// Перехоплює клавіші вікна |window| до FlView і розпізнає в них
+// сканер-клавіатуру (див. native/scanner): клавіші коду не доходять до
+// текстових полів, а потік com.virok/scanner/events отримує одну подію
+// {barcode, burstUs}. Канал com.virok/scanner: configure, record, status.
+// Викликати один раз після створення FlView.
+void scanner_channel_register(FlBinaryMessenger* messenger,
+                              GtkWindow* window);
+
+#endif  // RUNNER_SCANNER_CHANNEL_H_
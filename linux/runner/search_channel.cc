@@ -0,0 +1,157 @@
+#include "search_channel.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "catalogue/shared_catalogue.h"
+#include "channel_args.h"
+#include "metrics/metrics.h"
+#include "search/search_service.h"
+#include "trace/trace.h"
+
+namespace {
+
+FlMethodChannel* search_channel = nullptr;
+virok::SearchService search_service;
+// Каталог, спільний для кас на цій машині (див. native/catalogue).
+virok::SharedCatalogue shared_catalogue;
+bool shared_catalogue_open = false;
+// Генерація, на якій зараз індекс; 0 — власний індекс каси.
+uint64_t shared_generation = 0;
+
+// Розмір сторінки за замовчуванням (як LIMIT у SQLite-пошуку).
+constexpr int64_t kDefaultLimit = 100;
+
+FlValue* result_to_value(const virok::SearchResult& r) {
+  FlValue* ids = fl_value_new_list();
+  for (const auto& id : r.ids) {
+    fl_value_append_take(ids, fl_value_new_string(id.c_str()));
+  }
+  FlValue* map = fl_value_new_map();
+  fl_value_set_string_take(map, "ids", ids);
+  fl_value_set_string_take(map, "exhausted", fl_value_new_bool(r.exhausted));
+  fl_value_set_string_take(map, "total", fl_value_new_int(r.total));
+  fl_value_set_string_take(map, "elapsedUs", fl_value_new_int(r.elapsed_us));
+  return map;
+}
+
+// Переводить пошук на спільну генерацію версії не старшої за |version|;
+// -1, якщо такої немає або каталог настільки великий, що його шардують
+// (спільна генерація — один SearchIndex, див. SearchService).
+// |keep_sessions| — відкриті сесії лишаються на попередній генерації.
+int64_t attach_shared(int64_t version, bool keep_sessions = false) {
+  if (!shared_catalogue_open) return -1;
+  auto generation = shared_catalogue.Current();
+  if (!generation || generation->version() < static_cast<uint64_t>(version) ||
+      generation->search_view().count >=
+          virok::SearchService::kShardedMinItems) {
+    return -1;
+  }
+  shared_generation = generation->generation();
+  auto index = std::make_shared<const virok::SearchIndex>(
+      generation->search_view(), generation);
+  return static_cast<int64_t>(
+      keep_sessions ? search_service.LoadIndexForNewSessions(std::move(index))
+                    : search_service.LoadIndex(std::move(index)));
+}
+
+// Нова сесія — момент перейти на генерацію, яку після синхронізації
+// опублікувала інша каса. Відкриті сесії під час набору не чіпаємо: вони
+// тримають свою генерацію, доки їх не закриють.
+void follow_shared() {
+  if (shared_generation == 0) return;
+  auto generation = shared_catalogue.Current();
+  if (generation && generation->generation() != shared_generation) {
+    attach_shared(0, /*keep_sessions=*/true);
+  }
+}
+
+void search_method_call_cb(FlMethodChannel* channel, FlMethodCall* method_call,
+                           gpointer user_data) {
+  const std::string method = fl_method_call_get_name(method_call);
+  FlValue* args = fl_method_call_get_args(method_call);
+  virok::TraceScope trace_scope("search", method);
+  g_autoptr(FlMethodResponse) response = nullptr;
+
+  if (method == "loadIndex") {
+    const std::vector<std::string> ids = string_list_arg(args, "ids");
+    const std::vector<std::string> keys = string_list_arg(args, "keys");
+    const std::vector<std::string> groups = string_list_arg(args, "groups");
+    const int64_t version = int_arg(args, "version");
+    int64_t count = -1;
+    // Версія (час синхронізації) — ознака, що каталог можна віддати
+    // іншим касам; тоді й ця каса тримає його лише у спільній пам'яті.
+    if (version > 0 && shared_catalogue_open) {
+      bool published = false;
+      std::string error;
+      if (!shared_catalogue.Publish(ids, keys, static_cast<uint64_t>(version),
+                                    &published, &error)) {
+        g_warning("Shared catalogue publish failed: %s", error.c_str());
+      }
+      count = attach_shared(version);
+    }
+    if (count < 0) {
+      shared_generation = 0;
+      count = static_cast<int64_t>(search_service.LoadIndex(ids, keys, groups));
+    }
+    g_autoptr(FlValue) result = fl_value_new_int(count);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (method == "attachShared") {
+    g_autoptr(FlValue) result =
+        fl_value_new_int(attach_shared(int_arg(args, "version")));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (method == "openSession") {
+    follow_shared();
+    g_autoptr(FlValue) result = fl_value_new_int(search_service.OpenSession());
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (method == "closeSession") {
+    search_service.CloseSession(int_arg(args, "session"));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else if (method == "query" || method == "more") {
+    const int64_t session = int_arg(args, "session");
+    const size_t limit =
+        static_cast<size_t>(int_arg(args, "limit", kDefaultLimit));
+    virok::SearchResult r;
+    const bool found =
+        method == "query"
+            ? search_service.Query(session, string_arg(args, "query"), limit,
+                                   &r)
+            : search_service.More(session, limit, &r);
+    if (found) {
+      static virok::Histogram* const latency =
+          virok::MetricsRegistry::Get().GetHistogram(
+              "virok_search_query_microseconds",
+              "Native catalogue search time per query/more call");
+      latency->Record(r.elapsed_us);
+      g_autoptr(FlValue) result = result_to_value(r);
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+    } else {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "NO_SESSION", "Search session is closed", nullptr));
+    }
+  } else {
+    response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+  }
+
+  g_autoptr(GError) error = nullptr;
+  if (!fl_method_call_respond(method_call, response, &error)) {
+    g_warning("Failed to respond on com.virok/search: %s", error->message);
+  }
+}
+
+}  // namespace
+
+void search_channel_register(FlBinaryMessenger* messenger) {
+  std::string error;
+  shared_catalogue_open = shared_catalogue.Open(&error);
+  if (!shared_catalogue_open) {
+    g_warning("Shared catalogue unavailable: %s", error.c_str());
+  }
+  g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+  search_channel = fl_method_channel_new(messenger, "com.virok/search",
+                                         FL_METHOD_CODEC(codec));
+  fl_method_channel_set_method_call_handler(search_channel,
+                                            search_method_call_cb, nullptr,
+                                            nullptr);
+}
@@ -0,0 +1,120 @@
+#include "startup_channel.h"
+
+#include <filesystem>
+#include <string>
+
+#include "channel_args.h"
+#include "startup/prewarm.h"
+#include "startup/prewarm_tasks.h"
+#include "startup/startup_timeline.h"
+
+namespace {
+
+FlMethodChannel* startup_channel = nullptr;
+
+// Живе до кінця процесу: задачі можуть ще працювати, коли вікно закрите.
+virok::PrewarmPool* prewarm_pool = nullptr;
+
+// Той самий шлях, що й getDatabasesPath() у sqflite_common_ffi:
+// <робоча папка>/.dart_tool/sqflite_common_ffi/databases.
+std::string catalogue_database_path() {
+  return (std::filesystem::current_path() / ".dart_tool" /
+          "sqflite_common_ffi" / "databases" / "nomenclatura.db")
+      .string();
+}
+
+// shared_preferences_linux зберігає налаштування в
+// $XDG_DATA_HOME/<application id>.
+std::string preferences_path() {
+  g_autofree gchar* path = g_build_filename(
+      g_get_user_data_dir(), APPLICATION_ID, "shared_preferences.json",
+      nullptr);
+  return path;
+}
+
+FlValue* result_to_value(const virok::PrewarmResult& r) {
+  FlValue* values = fl_value_new_map();
+  for (const auto& [key, value] : r.values) {
+    fl_value_set_string_take(values, key.c_str(),
+                             fl_value_new_string(value.c_str()));
+  }
+  FlValue* map = fl_value_new_map();
+  fl_value_set_string_take(map, "state",
+                           fl_value_new_string(
+                               virok::PrewarmStateName(r.state)));
+  fl_value_set_string_take(map, "startUs",
+                           fl_value_new_int(r.start_ns / 1000));
+  fl_value_set_string_take(
+      map, "elapsedUs",
+      fl_value_new_int(r.end_ns > 0 ? (r.end_ns - r.start_ns) / 1000 : 0));
+  fl_value_set_string_take(map, "values", values);
+  if (!r.error.empty()) {
+    fl_value_set_string_take(map, "error",
+                             fl_value_new_string(r.error.c_str()));
+  }
+  return map;
+}
+
+void startup_method_call_cb(FlMethodChannel* channel,
+                            FlMethodCall* method_call, gpointer user_data) {
+  const std::string method = fl_method_call_get_name(method_call);
+  FlValue* args = fl_method_call_get_args(method_call);
+  virok::StartupTimeline& timeline = virok::StartupTimeline::Get();
+  g_autoptr(FlMethodResponse) response = nullptr;
+
+  if (method == "mark") {
+    const int64_t ns = timeline.Mark(string_arg(args, "name"));
+    g_autoptr(FlValue) result = fl_value_new_int(ns / 1000);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (method == "timeline") {
+    g_autoptr(FlValue) result = fl_value_new_list();
+    for (const auto& mark : timeline.Marks()) {
+      FlValue* item = fl_value_new_map();
+      fl_value_set_string_take(item, "name",
+                               fl_value_new_string(mark.name.c_str()));
+      fl_value_set_string_take(item, "us", fl_value_new_int(mark.ns / 1000));
+      fl_value_append_take(result, item);
+    }
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (method == "prewarm") {
+    g_autoptr(FlValue) result = fl_value_new_map();
+    if (prewarm_pool != nullptr) {
+      for (const auto& r : prewarm_pool->Snapshot()) {
+        fl_value_set_string_take(result, r.name.c_str(), result_to_value(r));
+      }
+    }
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else {
+    response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+  }
+
+  g_autoptr(GError) error = nullptr;
+  if (!fl_method_call_respond(method_call, response, &error)) {
+    g_warning("Failed to respond on com.virok/startup: %s", error->message);
+  }
+}
+
+}  // namespace
+
+void startup_prewarm_start() {
+  virok::StartupTimeline::Get().Mark("runner");
+  prewarm_pool = new virok::PrewarmPool();
+
+  prewarm_pool->Run("catalogue", [path = catalogue_database_path()](
+                                     virok::PrewarmResult* r) {
+    return virok::PageInFile(path, r);
+  });
+  prewarm_pool->Run("config", [path = preferences_path()](
+                                  virok::PrewarmResult* r) {
+    return virok::ReadCashalotConfig(path, r);
+  });
+}
+
+void startup_channel_register(FlBinaryMessenger* messenger) {
+  g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+  startup_channel = fl_method_channel_new(messenger, "com.virok/startup",
+                                          FL_METHOD_CODEC(codec));
+  fl_method_channel_set_method_call_handler(startup_channel,
+                                            startup_method_call_cb, nullptr,
+                                            nullptr);
+}
@@ -0,0 +1,14 @@
+#ifndef RUNNER_STARTUP_CHANNEL_H_
+#define RUNNER_STARTUP_CHANNEL_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+// Запускає паралельний прогрів (native/startup) до створення FlView:
+// читає nomenclatura.db у кеш ОС і розбирає налаштування Cashalot.
+void startup_prewarm_start();
+
+// Реєструє канал com.virok/startup: позначки хронології запуску (mark,
+// timeline) і результати прогріву для Dart (prewarm).
+void startup_channel_register(FlBinaryMessenger* messenger);
+
+#endif  // RUNNER_STARTUP_CHANNEL_H_
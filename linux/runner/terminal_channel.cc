@@ -0,0 +1,194 @@
+#include "terminal_channel.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "channel_args.h"
+#include "terminal/terminal_driver.h"
+#include "trace/trace.h"
+
+namespace {
+
+FlMethodChannel* terminal_channel = nullptr;
+FlEventChannel* terminal_events = nullptr;
+// Dart слухає потік подій (лише в головному потоці).
+bool terminal_listening = false;
+std::unique_ptr<virok::TerminalDriver> terminal_driver;
+std::string terminal_host;
+
+FlValue* event_to_value(const virok::TerminalEvent& event) {
+  FlValue* map = fl_value_new_map();
+  fl_value_set_string_take(map, "type",
+                           fl_value_new_string(virok::TerminalEventName(
+                               event.type)));
+  fl_value_set_string_take(map, "request", fl_value_new_int(event.request));
+  fl_value_set_string_take(map, "method",
+                           fl_value_new_string(event.method.c_str()));
+  if (!event.state.empty()) {
+    fl_value_set_string_take(map, "state",
+                             fl_value_new_string(event.state.c_str()));
+  }
+  if (event.type == virok::TerminalEvent::Type::kResult) {
+    fl_value_set_string_take(map, "approved",
+                             fl_value_new_bool(event.approved));
+    fl_value_set_string_take(map, "elapsedUs",
+                             fl_value_new_int(event.elapsed_us));
+    fl_value_set_string_take(map, "tapToApprovalUs",
+                             fl_value_new_int(event.tap_to_approval_us));
+  }
+  if (event.type == virok::TerminalEvent::Type::kSlip) {
+    fl_value_set_string_take(map, "tapToSlipUs",
+                             fl_value_new_int(event.tap_to_slip_us));
+  }
+  if (!event.params.empty()) {
+    FlValue* params = fl_value_new_map();
+    for (const auto& [key, value] : event.params) {
+      fl_value_set_string_take(params, key.c_str(),
+                               fl_value_new_string(value.c_str()));
+    }
+    fl_value_set_string_take(map, "params", params);
+  }
+  if (!event.error.empty()) {
+    fl_value_set_string_take(map, "error",
+                             fl_value_new_string(event.error.c_str()));
+  }
+  return map;
+}
+
+gboolean send_event_cb(gpointer user_data) {
+  std::unique_ptr<virok::TerminalEvent> event(
+      static_cast<virok::TerminalEvent*>(user_data));
+  if (terminal_events == nullptr || !terminal_listening) {
+    return G_SOURCE_REMOVE;
+  }
+  g_autoptr(FlValue) value = event_to_value(*event);
+  g_autoptr(GError) error = nullptr;
+  if (!fl_event_channel_send(terminal_events, value, nullptr, &error)) {
+    g_warning("Failed to send on com.virok/terminal/events: %s",
+              error->message);
+  }
+  return G_SOURCE_REMOVE;
+}
+
+// Потоки драйвера: подія переходить у головний цикл.
+void on_terminal_event(const virok::TerminalEvent& event) {
+  g_idle_add(send_event_cb, new virok::TerminalEvent(event));
+}
+
+// params: {назва: рядок}; значення інших типів пропускаються.
+virok::TerminalParams params_arg(FlValue* args) {
+  virok::TerminalParams params;
+  FlValue* map = find_arg(args, "params");
+  if (map == nullptr || fl_value_get_type(map) != FL_VALUE_TYPE_MAP) {
+    return params;
+  }
+  for (size_t i = 0; i < fl_value_get_length(map); i++) {
+    FlValue* key = fl_value_get_map_key(map, i);
+    FlValue* value = fl_value_get_map_value(map, i);
+    if (fl_value_get_type(key) == FL_VALUE_TYPE_STRING &&
+        fl_value_get_type(value) == FL_VALUE_TYPE_STRING) {
+      params[fl_value_get_string(key)] = fl_value_get_string(value);
+    }
+  }
+  return params;
+}
+
+FlMethodErrorResponse* terminal_listen_cb(FlEventChannel* channel,
+                                          FlValue* args, gpointer user_data) {
+  terminal_listening = true;
+  return nullptr;
+}
+
+FlMethodErrorResponse* terminal_cancel_cb(FlEventChannel* channel,
+                                          FlValue* args, gpointer user_data) {
+  terminal_listening = false;
+  return nullptr;
+}
+
+void terminal_method_call_cb(FlMethodChannel* channel,
+                             FlMethodCall* method_call, gpointer user_data) {
+  const std::string method = fl_method_call_get_name(method_call);
+  FlValue* args = fl_method_call_get_args(method_call);
+  virok::TraceScope trace_scope("terminal", method);
+  g_autoptr(FlMethodResponse) response = nullptr;
+
+  if (method == "start") {
+    virok::TerminalOptions options;
+    options.host = string_arg(args, "host");
+    options.port = static_cast<uint16_t>(int_arg(args, "port", options.port));
+    options.printer_host = string_arg(args, "printerHost");
+    options.printer_port = static_cast<uint16_t>(
+        int_arg(args, "printerPort", options.printer_port));
+    options.slip_copies =
+        static_cast<int>(int_arg(args, "slipCopies", options.slip_copies));
+    std::string error;
+    if (terminal_driver->Start(options, &error)) {
+      terminal_host = options.host;
+      g_autoptr(FlValue) result = fl_value_new_bool(TRUE);
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+    } else {
+      terminal_host.clear();
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "CONNECT_FAILED", error.c_str(), nullptr));
+    }
+  } else if (method == "stop") {
+    terminal_driver->Stop();
+    terminal_host.clear();
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else if (method == "status") {
+    g_autoptr(FlValue) result = fl_value_new_map();
+    fl_value_set_string_take(result, "running",
+                             fl_value_new_bool(terminal_driver->running()));
+    fl_value_set_string_take(result, "connected",
+                             fl_value_new_bool(terminal_driver->connected()));
+    fl_value_set_string_take(result, "host",
+                             fl_value_new_string(terminal_host.c_str()));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (method == "submit") {
+    std::string error;
+    const int64_t request = terminal_driver->Submit(
+        string_arg(args, "method"), params_arg(args),
+        std::chrono::milliseconds(int_arg(args, "timeoutMs", 120000)),
+        &error);
+    if (request > 0) {
+      g_autoptr(FlValue) result = fl_value_new_int(request);
+      response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+    } else {
+      response = FL_METHOD_RESPONSE(fl_method_error_response_new(
+          "NOT_CONNECTED", error.c_str(), nullptr));
+    }
+  } else if (method == "cancel") {
+    std::string error;
+    g_autoptr(FlValue) result = fl_value_new_bool(
+        terminal_driver->Cancel(int_arg(args, "request"), &error));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else {
+    response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+  }
+
+  g_autoptr(GError) error = nullptr;
+  if (!fl_method_call_respond(method_call, response, &error)) {
+    g_warning("Failed to respond on com.virok/terminal: %s", error->message);
+  }
+}
+
+}  // namespace
+
+void terminal_channel_register(FlBinaryMessenger* messenger) {
+  terminal_driver = std::make_unique<virok::TerminalDriver>(on_terminal_event);
+  g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+  terminal_channel = fl_method_channel_new(messenger, "com.virok/terminal",
+                                           FL_METHOD_CODEC(codec));
+  fl_method_channel_set_method_call_handler(
+      terminal_channel, terminal_method_call_cb, nullptr, nullptr);
+  terminal_events = fl_event_channel_new(
+      messenger, "com.virok/terminal/events", FL_METHOD_CODEC(codec));
+  fl_event_channel_set_stream_handlers(terminal_events, terminal_listen_cb,
+                                       terminal_cancel_cb, nullptr, nullptr);
+}
+
+void terminal_channel_shutdown() {
+  if (terminal_driver) terminal_driver->Stop();
+  terminal_listening = false;
+}
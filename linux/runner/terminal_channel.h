@@ -0,0 +1,18 @@
+#ifndef RUNNER_TERMINAL_CHANNEL_H_
+#define RUNNER_TERMINAL_CHANNEL_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+// Реєструє канал com.virok/terminal (start, stop, status, submit, cancel)
+// і потік подій com.virok/terminal/events: банківський термінал на одному
+// постійному з'єднанні (див. native/terminal). Проміжні стани оплати
+// (картку прикладено, PIN, авторизація) приходять подіями, а сліп
+// схваленої оплати драйвер друкує сам. Події з потоків драйвера
+// передаються в головний цикл GLib. Викликати один раз після створення
+// FlView.
+void terminal_channel_register(FlBinaryMessenger* messenger);
+
+// Зупиняє драйвер термінала до завершення застосунку.
+void terminal_channel_shutdown();
+
+#endif  // RUNNER_TERMINAL_CHANNEL_H_
@@ -0,0 +1,187 @@
+#include "trace_channel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "channel_args.h"
+#include "trace/trace.h"
+#include "trace/trace_writer.h"
+#include "watchdog/stall_watchdog.h"
+
+namespace {
+
+FlMethodChannel* trace_channel = nullptr;
+virok::ChromeTraceWriter trace_writer;
+
+// Пише лише головний потік GTK (обробник каналу), як і вимагає TraceBuffer.
+virok::TraceBuffer* dart_track = nullptr;
+
+std::unique_ptr<virok::StallWatchdog> watchdog;
+
+gboolean heartbeat_cb(gpointer user_data) {
+  if (watchdog) watchdog->Beat(*static_cast<uint64_t*>(user_data));
+  return G_SOURCE_REMOVE;
+}
+
+// Потік сторожа: пульс стає в чергу головного контексту поруч із
+// введенням і повідомленнями двигуна.
+void post_heartbeat(uint64_t seq) {
+  g_idle_add_full(G_PRIORITY_DEFAULT, heartbeat_cb, new uint64_t(seq),
+                  [](gpointer data) { delete static_cast<uint64_t*>(data); });
+}
+
+FlValue* report_to_value(const virok::StallReport& report) {
+  FlValue* spans = fl_value_new_list();
+  for (const virok::StallReport::Span& span : report.spans) {
+    FlValue* map = fl_value_new_map();
+    fl_value_set_string_take(map, "category",
+                             fl_value_new_string(span.category.c_str()));
+    fl_value_set_string_take(map, "name",
+                             fl_value_new_string(span.name.c_str()));
+    fl_value_set_string_take(map, "ageMs", fl_value_new_int(span.age_ms));
+    fl_value_append_take(spans, map);
+  }
+  FlValue* stack = fl_value_new_list();
+  for (const std::string& frame : report.stack) {
+    fl_value_append_take(stack, fl_value_new_string(frame.c_str()));
+  }
+  FlValue* map = fl_value_new_map();
+  fl_value_set_string_take(
+      map, "id", fl_value_new_int(static_cast<int64_t>(report.id)));
+  fl_value_set_string_take(map, "startedMs",
+                           fl_value_new_int(report.started_unix_ms));
+  fl_value_set_string_take(map, "durationMs",
+                           fl_value_new_int(report.duration_ms));
+  fl_value_set_string_take(map, "recovered",
+                           fl_value_new_bool(report.recovered));
+  fl_value_set_string_take(map, "spans", spans);
+  fl_value_set_string_take(map, "stack", stack);
+  return map;
+}
+
+FlValue* watchdog_status_to_value(const virok::StallWatchdogStatus& status) {
+  FlValue* map = fl_value_new_map();
+  fl_value_set_string_take(map, "running", fl_value_new_bool(status.running));
+  fl_value_set_string_take(map, "stalled", fl_value_new_bool(status.stalled));
+  fl_value_set_string_take(
+      map, "beats", fl_value_new_int(static_cast<int64_t>(status.beats)));
+  fl_value_set_string_take(
+      map, "stalls", fl_value_new_int(static_cast<int64_t>(status.stalls)));
+  fl_value_set_string_take(map, "longestMs",
+                           fl_value_new_int(status.longest_ms));
+  if (status.last.id != 0) {
+    fl_value_set_string_take(map, "last", report_to_value(status.last));
+  }
+  fl_value_set_string_take(map, "error",
+                           fl_value_new_string(status.error.c_str()));
+  return map;
+}
+
+// path — журнал зависань; budgetMs/intervalMs — пороги сторожа;
+// enabled: false — зупинити.
+bool configure_watchdog(FlValue* args) {
+  if (!bool_arg(args, "enabled", true)) {
+    watchdog->Stop();
+    return true;
+  }
+  virok::StallWatchdogOptions options;
+  options.path = string_arg(args, "path");
+  options.budget = std::chrono::milliseconds(
+      int_arg(args, "budgetMs", options.budget.count()));
+  options.interval = std::chrono::milliseconds(
+      int_arg(args, "intervalMs", options.interval.count()));
+  options.sample_stack = bool_arg(args, "sampleStack", true);
+  if (options.budget.count() <= 0 || options.interval.count() <= 0) {
+    return false;
+  }
+  watchdog->set_options(options);
+  if (!watchdog->running()) watchdog->Start();
+  return true;
+}
+
+std::vector<int64_t> int64_list_arg(FlValue* args, const char* key) {
+  FlValue* v = find_arg(args, key);
+  if (!v || fl_value_get_type(v) != FL_VALUE_TYPE_INT64_LIST) return {};
+  const int64_t* data = fl_value_get_int64_list(v);
+  return std::vector<int64_t>(data, data + fl_value_get_length(v));
+}
+
+// Dart надсилає тривалість і "вік" кожного спану (скільки мкс тому він
+// завершився) — так не потрібна синхронізація годинників Dart і C++.
+void record_dart_spans(FlValue* args) {
+  virok::Tracer& tracer = virok::Tracer::Get();
+  if (!tracer.enabled()) return;
+  if (!dart_track) dart_track = tracer.CreateTrack("dart");
+
+  const auto categories = string_list_arg(args, "categories");
+  const auto names = string_list_arg(args, "names");
+  const auto durations = int64_list_arg(args, "durationsUs");
+  const auto ages = int64_list_arg(args, "agesUs");
+  const size_t count = std::min({categories.size(), names.size(),
+                                 durations.size(), ages.size()});
+
+  const int64_t now = virok::Tracer::NowNs();
+  for (size_t i = 0; i < count; i++) {
+    const int64_t end = now - ages[i] * 1000;
+    const int64_t duration = durations[i] * 1000;
+    dart_track->Push({tracer.Intern(categories[i]), tracer.Intern(names[i]),
+                      end - duration, duration, virok::TraceEvent::kNoArg});
+  }
+}
+
+void trace_method_call_cb(FlMethodChannel* channel, FlMethodCall* method_call,
+                          gpointer user_data) {
+  const std::string method = fl_method_call_get_name(method_call);
+  FlValue* args = fl_method_call_get_args(method_call);
+  g_autoptr(FlMethodResponse) response = nullptr;
+
+  if (method == "watchdog") {
+    g_autoptr(FlValue) result = fl_value_new_bool(configure_watchdog(args));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (method == "watchdogStatus") {
+    g_autoptr(FlValue) result = watchdog_status_to_value(watchdog->status());
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (method == "start") {
+    const auto interval =
+        std::chrono::milliseconds(int_arg(args, "flushMs", 1000));
+    g_autoptr(FlValue) result = fl_value_new_bool(
+        trace_writer.Start(string_arg(args, "path"), interval));
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (method == "stop") {
+    trace_writer.Stop();
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else if (method == "spans") {
+    record_dart_spans(args);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(nullptr));
+  } else {
+    response = FL_METHOD_RESPONSE(fl_method_not_implemented_response_new());
+  }
+
+  g_autoptr(GError) error = nullptr;
+  if (!fl_method_call_respond(method_call, response, &error)) {
+    g_warning("Failed to respond on com.virok/trace: %s", error->message);
+  }
+}
+
+}  // namespace
+
+void trace_channel_register(FlBinaryMessenger* messenger) {
+  virok::Tracer::Get().SetThreadName("platform");
+  // Сторож стежить за цим (головним) потоком; запускає його Dart.
+  watchdog = std::make_unique<virok::StallWatchdog>(post_heartbeat);
+  watchdog->AttachLoopThread();
+  g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+  trace_channel = fl_method_channel_new(messenger, "com.virok/trace",
+                                        FL_METHOD_CODEC(codec));
+  fl_method_channel_set_method_call_handler(trace_channel,
+                                            trace_method_call_cb, nullptr,
+                                            nullptr);
+}
+
+void trace_channel_shutdown() {
+  if (watchdog) watchdog->Stop();
+}
@@ -0,0 +1,18 @@
+#ifndef RUNNER_TRACE_CHANNEL_H_
+#define RUNNER_TRACE_CHANNEL_H_
+
+#include <flutter_linux/flutter_linux.h>
+
+// Реєструє канал com.virok/trace: запис траси у файл Chrome trace
+// (start/stop) і спани з Dart (spans) на окремій доріжці (див. native/trace).
+//
+// Там же сторож зависань головного циклу GTK (watchdog, watchdogStatus; див.
+// native/watchdog): пульс іде в головний контекст GLib з пріоритетом
+// звичайних подій. Викликати з головного потоку — його спани і стек
+// потрапляють у звіти.
+void trace_channel_register(FlBinaryMessenger* messenger);
+
+// Зупиняє сторожа до завершення застосунку.
+void trace_channel_shutdown();
+
+#endif  // RUNNER_TRACE_CHANNEL_H_
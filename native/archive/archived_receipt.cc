@@ -0,0 +1,396 @@
+#include "archive/archived_receipt.h"
+
+#include <chrono>
+#include <cmath>
+#include <ctime>
+
+#include "archive/lz_block.h"
+#include "json/json_reader.h"
+
+namespace virok {
+
+namespace {
+
+using Token = JsonReader::Token;
+
+// Прості примітиви формату: varint для довжин і лічильників, 8 байтів
+// little-endian для сум і часу.
+void PutVarint(uint64_t v, std::string* out) {
+  while (v >= 0x80) {
+    out->push_back(static_cast<char>(v | 0x80));
+    v >>= 7;
+  }
+  out->push_back(static_cast<char>(v));
+}
+
+void PutFixed64(int64_t v, std::string* out) {
+  const uint64_t u = static_cast<uint64_t>(v);
+  for (int i = 0; i < 8; i++) out->push_back(static_cast<char>(u >> (8 * i)));
+}
+
+void PutString(std::string_view s, std::string* out) {
+  PutVarint(s.size(), out);
+  out->append(s);
+}
+
+class Reader {
+ public:
+  explicit Reader(std::string_view data) : data_(data) {}
+
+  bool Varint(uint64_t* v) {
+    *v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (pos_ >= data_.size()) return false;
+      const uint8_t b = static_cast<uint8_t>(data_[pos_++]);
+      *v |= static_cast<uint64_t>(b & 0x7F) << shift;
+      if (!(b & 0x80)) return true;
+    }
+    return false;
+  }
+
+  bool Fixed64(int64_t* v) {
+    if (data_.size() - pos_ < 8) return false;
+    uint64_t u = 0;
+    for (int i = 0; i < 8; i++) {
+      u |= static_cast<uint64_t>(static_cast<uint8_t>(data_[pos_ + i]))
+           << (8 * i);
+    }
+    pos_ += 8;
+    *v = static_cast<int64_t>(u);
+    return true;
+  }
+
+  bool Bytes(std::string_view* s) {
+    uint64_t size;
+    if (!Varint(&size) || size > data_.size() - pos_) return false;
+    *s = data_.substr(pos_, size);
+    pos_ += size;
+    return true;
+  }
+
+  bool String(std::string* s) {
+    std::string_view view;
+    if (!Bytes(&view)) return false;
+    s->assign(view);
+    return true;
+  }
+
+  // Лічильник елементів, не більший за залишок даних (захист від
+  // пошкодженого запису з величезним розміром).
+  bool Count(size_t* count) {
+    uint64_t v;
+    if (!Varint(&v) || v > data_.size() - pos_) return false;
+    *count = static_cast<size_t>(v);
+    return true;
+  }
+
+  bool done() const { return pos_ == data_.size(); }
+
+ private:
+  std::string_view data_;
+  size_t pos_ = 0;
+};
+
+int64_t Kopecks(double uah) { return std::llround(uah * 100); }
+
+class ReceiptParser {
+ public:
+  explicit ReceiptParser(std::string_view json) : reader_(json) {}
+
+  bool Run(ArchivedReceipt* r, std::string* error) {
+    if (reader_.Next() != Token::kBeginObject || !ReadReceipt(r)) {
+      return Fail(error, "Malformed receipt JSON");
+    }
+    if (r->fiscal_number.empty()) {
+      return Fail(error, "fiscalNumber is required");
+    }
+    if (r->created_ms <= 0) {
+      r->created_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                          std::chrono::system_clock::now().time_since_epoch())
+                          .count();
+    }
+    r->date = LocalDate(r->created_ms);
+    return true;
+  }
+
+ private:
+  bool Fail(std::string* error, const char* message) {
+    if (error) *error = reader_.error().empty() ? message : reader_.error();
+    return false;
+  }
+
+  bool ReadReceipt(ArchivedReceipt* r) {
+    for (;;) {
+      const Token t = reader_.Next();
+      if (t == Token::kEndObject) return true;
+      if (t != Token::kKey) return false;
+      const std::string_view key = reader_.text();
+      bool ok;
+      double number = 0;
+      if (key == "fiscalNumber") {
+        ok = ReadString(&r->fiscal_number);
+      } else if (key == "rrn") {
+        ok = ReadString(&r->rrn);
+      } else if (key == "createdMs") {
+        ok = ReadNumber(&number);
+        r->created_ms = static_cast<int64_t>(number);
+      } else if (key == "docType") {
+        ok = ReadString(&r->doc_type);
+      } else if (key == "cashier") {
+        ok = ReadString(&r->cashier);
+      } else if (key == "total") {
+        ok = ReadNumber(&number);
+        r->total = Kopecks(number);
+      } else if (key == "visualization") {
+        ok = ReadString(&r->visualization);
+      } else if (key == "lines") {
+        ok = ReadObjects([this, r] {
+          return ReadLine(&r->lines.emplace_back());
+        });
+      } else if (key == "payments") {
+        ok = ReadObjects([this, r] {
+          return ReadPayment(&r->payments.emplace_back());
+        });
+      } else {
+        ok = reader_.Next() != Token::kError && reader_.Skip();
+      }
+      if (!ok) return false;
+    }
+  }
+
+  bool ReadLine(ArchivedLine* line) {
+    for (;;) {
+      const Token t = reader_.Next();
+      if (t == Token::kEndObject) return true;
+      if (t != Token::kKey) return false;
+      const std::string_view key = reader_.text();
+      bool ok;
+      double number = 0;
+      if (key == "guid") {
+        ok = ReadString(&line->guid);
+      } else if (key == "code") {
+        ok = ReadString(&line->code);
+      } else if (key == "name") {
+        ok = ReadString(&line->name);
+      } else if (key == "barcodes") {
+        ok = ReadStrings(&line->barcodes);
+      } else if (key == "quantity") {
+        ok = ReadNumber(&number);
+        line->qty_milli = std::llround(number * 1000);
+      } else if (key == "price") {
+        ok = ReadNumber(&number);
+        line->price = Kopecks(number);
+      } else if (key == "discount") {
+        ok = ReadNumber(&number);
+        line->discount = Kopecks(number);
+      } else {
+        ok = reader_.Next() != Token::kError && reader_.Skip();
+      }
+      if (!ok) return false;
+    }
+  }
+
+  bool ReadPayment(ArchivedPayment* pay) {
+    for (;;) {
+      const Token t = reader_.Next();
+      if (t == Token::kEndObject) return true;
+      if (t != Token::kKey) return false;
+      const std::string_view key = reader_.text();
+      bool ok;
+      if (key == "form") {
+        ok = ReadString(&pay->form);
+      } else if (key == "amount") {
+        double number = 0;
+        ok = ReadNumber(&number);
+        pay->amount = Kopecks(number);
+      } else {
+        ok = reader_.Next() != Token::kError && reader_.Skip();
+      }
+      if (!ok) return false;
+    }
+  }
+
+  // Масив об'єктів: |item| читає кожен елемент після його '{'.
+  template <typename ItemFn>
+  bool ReadObjects(ItemFn item) {
+    if (reader_.Next() != Token::kBeginArray) return false;
+    for (;;) {
+      const Token t = reader_.Next();
+      if (t == Token::kEndArray) return true;
+      if (t != Token::kBeginObject || !item()) return false;
+    }
+  }
+
+  // Масив рядків; порожні пропускаються.
+  bool ReadStrings(std::vector<std::string>* out) {
+    if (reader_.Next() != Token::kBeginArray) return false;
+    for (;;) {
+      const Token t = reader_.Next();
+      if (t == Token::kEndArray) return true;
+      if (t != Token::kString) return false;
+      if (!reader_.text().empty()) out->emplace_back(reader_.text());
+    }
+  }
+
+  bool ReadString(std::string* out) {
+    const Token t = reader_.Next();
+    if (t == Token::kNull) {
+      out->clear();
+      return true;
+    }
+    if (t != Token::kString && t != Token::kNumber) return false;
+    out->assign(reader_.text());
+    return true;
+  }
+
+  bool ReadNumber(double* out) {
+    const Token t = reader_.Next();
+    if (t == Token::kNull) {
+      *out = 0;
+      return true;
+    }
+    if (t != Token::kNumber) return false;
+    *out = reader_.number();
+    return true;
+  }
+
+  JsonReader reader_;
+};
+
+}  // namespace
+
+bool ParseArchivedReceipt(std::string_view json, ArchivedReceipt* receipt,
+                          std::string* error) {
+  *receipt = ArchivedReceipt();
+  ReceiptParser parser(json);
+  return parser.Run(receipt, error);
+}
+
+int32_t LocalDate(int64_t unix_ms) {
+  const std::time_t t = static_cast<std::time_t>(unix_ms / 1000);
+  std::tm local;
+#ifdef _WIN32
+  localtime_s(&local, &t);
+#else
+  localtime_r(&t, &local);
+#endif
+  return (local.tm_year + 1900) * 10000 + (local.tm_mon + 1) * 100 +
+         local.tm_mday;
+}
+
+int64_t DaysFromDate(int32_t date) {
+  // days_from_civil (H. Hinnant) для пролептичного григоріанського календаря.
+  int64_t y = date / 10000;
+  const int64_t m = date / 100 % 100;
+  const int64_t d = date % 100;
+  y -= m <= 2;
+  const int64_t era = (y >= 0 ? y : y - 399) / 400;
+  const int64_t yoe = y - era * 400;
+  const int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  const int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+}
+
+void EncodeReceiptKeys(const ArchivedReceipt& r, std::string* out) {
+  PutString(r.fiscal_number, out);
+  PutString(r.rrn, out);
+  PutVarint(static_cast<uint32_t>(r.date), out);
+  PutFixed64(r.created_ms, out);
+  size_t barcodes = 0;
+  for (const ArchivedLine& line : r.lines) barcodes += line.barcodes.size();
+  PutVarint(barcodes, out);
+  for (const ArchivedLine& line : r.lines) {
+    for (const std::string& barcode : line.barcodes) PutString(barcode, out);
+  }
+}
+
+void EncodeReceiptBody(const ArchivedReceipt& r, std::string* out) {
+  PutString(r.doc_type, out);
+  PutString(r.cashier, out);
+  PutFixed64(r.total, out);
+  PutVarint(r.lines.size(), out);
+  for (const ArchivedLine& line : r.lines) {
+    PutString(line.guid, out);
+    PutString(line.code, out);
+    PutString(line.name, out);
+    // Штрихкоди рядка — лише кількість: самі значення вже є в ключах.
+    PutVarint(line.barcodes.size(), out);
+    PutFixed64(line.qty_milli, out);
+    PutFixed64(line.price, out);
+    PutFixed64(line.discount, out);
+  }
+  PutVarint(r.payments.size(), out);
+  for (const ArchivedPayment& pay : r.payments) {
+    PutString(pay.form, out);
+    PutFixed64(pay.amount, out);
+  }
+  PutVarint(r.visualization.size(), out);
+  std::string packed;
+  if (!r.visualization.empty()) LzCompress(r.visualization, &packed);
+  PutString(packed, out);
+}
+
+bool DecodeReceiptKeys(std::string_view data, ReceiptKeys* keys) {
+  Reader in(data);
+  uint64_t date;
+  size_t barcodes;
+  if (!in.String(&keys->fiscal_number) || !in.String(&keys->rrn) ||
+      !in.Varint(&date) || !in.Fixed64(&keys->created_ms) ||
+      !in.Count(&barcodes)) {
+    return false;
+  }
+  keys->date = static_cast<int32_t>(date);
+  keys->barcodes.resize(barcodes);
+  for (std::string& barcode : keys->barcodes) {
+    if (!in.String(&barcode)) return false;
+  }
+  return in.done();
+}
+
+bool DecodeReceipt(std::string_view keys_data, std::string_view body,
+                   bool visualization, ArchivedReceipt* r) {
+  ReceiptKeys keys;
+  if (!DecodeReceiptKeys(keys_data, &keys)) return false;
+  r->fiscal_number = std::move(keys.fiscal_number);
+  r->rrn = std::move(keys.rrn);
+  r->date = keys.date;
+  r->created_ms = keys.created_ms;
+
+  Reader in(body);
+  size_t count;
+  if (!in.String(&r->doc_type) || !in.String(&r->cashier) ||
+      !in.Fixed64(&r->total) || !in.Count(&count)) {
+    return false;
+  }
+  r->lines.resize(count);
+  size_t next_barcode = 0;
+  for (ArchivedLine& line : r->lines) {
+    size_t barcodes;
+    if (!in.String(&line.guid) || !in.String(&line.code) ||
+        !in.String(&line.name) || !in.Count(&barcodes) ||
+        barcodes > keys.barcodes.size() - next_barcode ||
+        !in.Fixed64(&line.qty_milli) || !in.Fixed64(&line.price) ||
+        !in.Fixed64(&line.discount)) {
+      return false;
+    }
+    line.barcodes.assign(keys.barcodes.begin() + next_barcode,
+                         keys.barcodes.begin() + next_barcode + barcodes);
+    next_barcode += barcodes;
+  }
+  if (!in.Count(&count)) return false;
+  r->payments.resize(count);
+  for (ArchivedPayment& pay : r->payments) {
+    if (!in.String(&pay.form) || !in.Fixed64(&pay.amount)) return false;
+  }
+  uint64_t raw_size;
+  std::string_view packed;
+  if (!in.Varint(&raw_size) || !in.Bytes(&packed) || !in.done()) return false;
+  r->visualization.clear();
+  if (visualization && raw_size) {
+    return LzDecompress(packed, static_cast<size_t>(raw_size),
+                        &r->visualization);
+  }
+  return true;
+}
+
+}  // namespace virok
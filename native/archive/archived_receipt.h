@@ -0,0 +1,83 @@
+#ifndef NATIVE_ARCHIVE_ARCHIVED_RECEIPT_H_
+#define NATIVE_ARCHIVE_ARCHIVED_RECEIPT_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace virok {
+
+// Фіскалізований чек у локальному архіві. Суми — у копійках, кількість —
+// у тисячних (як у PromoCart).
+
+struct ArchivedLine {
+  std::string guid;
+  std::string code;  // артикул або guid, як у ReceiptLst
+  std::string name;
+  std::vector<std::string> barcodes;
+  int64_t qty_milli = 0;
+  int64_t price = 0;
+  int64_t discount = 0;
+};
+
+struct ArchivedPayment {
+  std::string form;  // "Готівка", "Картка", ...
+  int64_t amount = 0;
+};
+
+struct ArchivedReceipt {
+  std::string fiscal_number;
+  std::string rrn;
+  int64_t created_ms = 0;  // Unix-час фіскалізації
+  int32_t date = 0;        // yyyymmdd за місцевим часом, з created_ms
+  std::string doc_type;    // "sale", "return"
+  std::string cashier;
+  int64_t total = 0;
+  std::vector<ArchivedLine> lines;
+  std::vector<ArchivedPayment> payments;
+  // Текстова візуалізація чека з ПРРО для повторного друку; на диску
+  // зберігається стисненою (lz_block).
+  std::string visualization;
+};
+
+// Розбирає чек з JSON каналу com.virok/archive:
+//   {"fiscalNumber", "rrn", "createdMs", "docType", "cashier", "total",
+//    "lines": [{"guid", "code", "name", "barcodes": [..], "quantity",
+//               "price", "discount"}],
+//    "payments": [{"form", "amount"}], "visualization"}
+// Гроші — в гривнях (числа), кількість — дробова. date обчислюється з
+// createdMs (або поточного часу, якщо 0). Без fiscalNumber — помилка.
+bool ParseArchivedReceipt(std::string_view json, ArchivedReceipt* receipt,
+                          std::string* error);
+
+// yyyymmdd за місцевим часом для Unix-часу в мілісекундах.
+int32_t LocalDate(int64_t unix_ms);
+
+// Кількість днів від 1970-01-01 для yyyymmdd (для політики зберігання).
+int64_t DaysFromDate(int32_t date);
+
+// Бінарний запис архіву. Ключі індексів ідуть окремим префіксом, щоб
+// відкриття архіву читало лише їх, без тіла чека:
+//   keys: fiscal_number, rrn, date, created_ms, штрихкоди всіх рядків;
+//   body: решта полів і стиснена візуалізація.
+void EncodeReceiptKeys(const ArchivedReceipt& receipt, std::string* out);
+void EncodeReceiptBody(const ArchivedReceipt& receipt, std::string* out);
+
+// Ключі запису без тіла.
+struct ReceiptKeys {
+  std::string fiscal_number;
+  std::string rrn;
+  int32_t date = 0;
+  int64_t created_ms = 0;
+  std::vector<std::string> barcodes;
+};
+
+bool DecodeReceiptKeys(std::string_view data, ReceiptKeys* keys);
+// |visualization| = false пропускає розпакування (списки пошуку).
+bool DecodeReceipt(std::string_view keys, std::string_view body,
+                   bool visualization, ArchivedReceipt* receipt);
+
+}  // namespace virok
+
+#endif  // NATIVE_ARCHIVE_ARCHIVED_RECEIPT_H_
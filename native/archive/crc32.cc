@@ -0,0 +1,53 @@
+#include "archive/crc32.h"
+
+#include <array>
+
+namespace virok {
+
+namespace {
+
+// Таблиці для slicing-by-8: table[k][b] — CRC байта b, за яким іде k
+// нульових байтів. Вісім байтів за крок замість одного.
+using Tables = std::array<std::array<uint32_t, 256>, 8>;
+
+Tables MakeTables() {
+  Tables tables{};
+  for (uint32_t i = 0; i < 256; i++) {
+    uint32_t c = i;
+    for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+    tables[0][i] = c;
+  }
+  for (uint32_t i = 0; i < 256; i++) {
+    for (int k = 1; k < 8; k++) {
+      const uint32_t c = tables[k - 1][i];
+      tables[k][i] = tables[0][c & 0xFF] ^ (c >> 8);
+    }
+  }
+  return tables;
+}
+
+uint32_t Load32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+         static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+
+}  // namespace
+
+uint32_t Crc32(const void* data, size_t size, uint32_t crc) {
+  static const Tables t = MakeTables();
+  const auto* p = static_cast<const uint8_t*>(data);
+  crc = ~crc;
+  for (; size >= 8; p += 8, size -= 8) {
+    const uint32_t lo = crc ^ Load32(p);
+    const uint32_t hi = Load32(p + 4);
+    crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^
+          t[4][lo >> 24] ^ t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^
+          t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+  }
+  for (; size > 0; p++, size--) {
+    crc = t[0][(crc ^ *p) & 0xFF] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+}  // namespace virok
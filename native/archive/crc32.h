@@ -0,0 +1,15 @@
+#ifndef NATIVE_ARCHIVE_CRC32_H_
+#define NATIVE_ARCHIVE_CRC32_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace virok {
+
+// CRC-32 (IEEE 802.3, як у zlib) для перевірки записів журналів на диску.
+// |crc| — значення попереднього шматка для інкрементального підрахунку.
+uint32_t Crc32(const void* data, size_t size, uint32_t crc = 0);
+
+}  // namespace virok
+
+#endif  // NATIVE_ARCHIVE_CRC32_H_
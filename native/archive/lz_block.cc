@@ -0,0 +1,117 @@
+#include "archive/lz_block.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace virok {
+
+namespace {
+
+constexpr size_t kMinMatch = 4;
+constexpr size_t kMaxOffset = 65535;
+constexpr int kHashBits = 12;
+
+uint32_t Read32(const char* p) {
+  uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+uint32_t Hash(uint32_t sequence) {
+  return (sequence * 2654435761u) >> (32 - kHashBits);
+}
+
+// Довжина понад 15 у nibble токена: байти 255 і залишок.
+void PutLength(size_t length, std::string* out) {
+  for (; length >= 255; length -= 255) out->push_back('\xFF');
+  out->push_back(static_cast<char>(length));
+}
+
+void PutSequence(std::string_view literals, size_t offset, size_t match,
+                 std::string* out) {
+  const size_t lit = literals.size();
+  const size_t extra = match ? match - kMinMatch : 0;
+  out->push_back(static_cast<char>(((lit < 15 ? lit : 15) << 4) |
+                                   (extra < 15 ? extra : 15)));
+  if (lit >= 15) PutLength(lit - 15, out);
+  out->append(literals);
+  if (!match) return;
+  out->push_back(static_cast<char>(offset & 0xFF));
+  out->push_back(static_cast<char>(offset >> 8));
+  if (extra >= 15) PutLength(extra - 15, out);
+}
+
+bool GetLength(std::string_view in, size_t* pos, size_t* length) {
+  for (;;) {
+    if (*pos >= in.size()) return false;
+    const uint8_t b = static_cast<uint8_t>(in[(*pos)++]);
+    *length += b;
+    if (b != 255) return true;
+  }
+}
+
+}  // namespace
+
+void LzCompress(std::string_view input, std::string* out) {
+  const char* data = input.data();
+  const size_t n = input.size();
+  std::vector<int32_t> table(size_t{1} << kHashBits, -1);
+  size_t anchor = 0;
+  size_t i = 0;
+  while (i + kMinMatch <= n) {
+    const uint32_t sequence = Read32(data + i);
+    int32_t& slot = table[Hash(sequence)];
+    const int32_t candidate = slot;
+    slot = static_cast<int32_t>(i);
+    if (candidate < 0 || i - candidate > kMaxOffset ||
+        Read32(data + candidate) != sequence) {
+      i++;
+      continue;
+    }
+    size_t length = kMinMatch;
+    while (i + length < n && data[candidate + length] == data[i + length]) {
+      length++;
+    }
+    PutSequence(input.substr(anchor, i - anchor), i - candidate, length, out);
+    i += length;
+    anchor = i;
+  }
+  // Остання послідовність — лише літерали (можливо, нуль).
+  PutSequence(input.substr(anchor), 0, 0, out);
+}
+
+bool LzDecompress(std::string_view in, size_t raw_size, std::string* out) {
+  const size_t start = out->size();
+  out->reserve(start + raw_size);
+  size_t pos = 0;
+  while (pos < in.size()) {
+    const uint8_t token = static_cast<uint8_t>(in[pos++]);
+    size_t lit = token >> 4;
+    if (lit == 15 && !GetLength(in, &pos, &lit)) break;
+    if (lit > in.size() - pos || out->size() - start + lit > raw_size) break;
+    out->append(in.data() + pos, lit);
+    pos += lit;
+    if (pos == in.size()) {
+      if (out->size() - start == raw_size) return true;
+      break;
+    }
+    if (in.size() - pos < 2) break;
+    const size_t offset =
+        static_cast<size_t>(static_cast<uint8_t>(in[pos])) |
+        static_cast<size_t>(static_cast<uint8_t>(in[pos + 1])) << 8;
+    pos += 2;
+    size_t match = token & 15;
+    if (match == 15 && !GetLength(in, &pos, &match)) break;
+    match += kMinMatch;
+    const size_t produced = out->size() - start;
+    if (offset == 0 || offset > produced || produced + match > raw_size) break;
+    // Збіг може перекривати сам себе (повтор коротшого шаблону).
+    size_t from = out->size() - offset;
+    for (size_t k = 0; k < match; k++) out->push_back((*out)[from + k]);
+  }
+  out->resize(start);
+  return false;
+}
+
+}  // namespace virok
@@ -0,0 +1,24 @@
+#ifndef NATIVE_ARCHIVE_LZ_BLOCK_H_
+#define NATIVE_ARCHIVE_LZ_BLOCK_H_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace virok {
+
+// Стиснення блоку в стилі LZ4 (послідовності "літерали + збіг" з
+// 16-бітним зсувом) без зовнішніх залежностей. Візуалізація чека — текст
+// з рамками, пробілами вирівнювання і повторюваними реквізитами —
+// стискається в кілька разів за мікросекунди.
+
+// Дописує стиснений |input| у кінець |out|.
+void LzCompress(std::string_view input, std::string* out);
+
+// Розпаковує блок, що має дати рівно |raw_size| байтів (дописує в |out|).
+// False для пошкодженого блоку; |out| тоді лишається як був.
+bool LzDecompress(std::string_view input, size_t raw_size, std::string* out);
+
+}  // namespace virok
+
+#endif  // NATIVE_ARCHIVE_LZ_BLOCK_H_
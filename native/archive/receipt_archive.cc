@@ -0,0 +1,548 @@
+#include "archive/receipt_archive.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <system_error>
+
+#include "archive/crc32.h"
+
+#ifdef _WIN32
+#include <io.h>
+#include <share.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace virok {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr uint32_t kRecordMagic = 0x31415256;  // "VRA1"
+constexpr size_t kHeaderBytes = 16;
+constexpr char kSegmentPrefix[] = "receipts-";
+constexpr char kSegmentSuffix[] = ".log";
+// Номер сегмента або запису, що зник після Compact.
+constexpr uint32_t kDropped = UINT32_MAX;
+
+std::FILE* OpenFile(const std::string& path, const char* mode) {
+#ifdef _WIN32
+  // _wfsopen: дописування й читання того самого сегмента двома дескрипторами.
+  const std::wstring wmode(mode, mode + std::strlen(mode));
+  return _wfsopen(fs::u8path(path).c_str(), wmode.c_str(), _SH_DENYNO);
+#else
+  return std::fopen(path.c_str(), mode);
+#endif
+}
+
+// fflush віддає дані ОС; fsync — на диск: чек у архіві — єдина копія
+// для повернення, і збій живлення не повинен її забрати.
+bool SyncFile(std::FILE* file) {
+  if (std::fflush(file) != 0) return false;
+#ifdef _WIN32
+  return _commit(_fileno(file)) == 0;
+#else
+  return fsync(fileno(file)) == 0;
+#endif
+}
+
+// Перенумеровує списки індексу за |location_map| після Compact; ключі,
+// що лишилися без записів, видаляє. Порядок списків зберігається.
+template <typename Index>
+void RemapIndex(const std::vector<uint32_t>& location_map, Index* index) {
+  for (auto it = index->begin(); it != index->end();) {
+    std::vector<uint32_t>& list = it->second;
+    size_t kept = 0;
+    for (uint32_t location : list) {
+      if (location_map[location] != kDropped) {
+        list[kept++] = location_map[location];
+      }
+    }
+    list.resize(kept);
+    it = kept ? std::next(it) : index->erase(it);
+  }
+}
+
+void PutU32(uint32_t v, char* out) {
+  for (int i = 0; i < 4; i++) out[i] = static_cast<char>(v >> (8 * i));
+}
+
+uint32_t GetU32(const char* in) {
+  uint32_t v = 0;
+  for (int i = 0; i < 4; i++) {
+    v |= static_cast<uint32_t>(static_cast<uint8_t>(in[i])) << (8 * i);
+  }
+  return v;
+}
+
+uint32_t RecordCrc(const std::string& keys, const std::string& body) {
+  return Crc32(body.data(), body.size(), Crc32(keys.data(), keys.size()));
+}
+
+std::string SegmentName(uint32_t id) {
+  char name[32];
+  std::snprintf(name, sizeof(name), "%s%06u%s", kSegmentPrefix, id,
+                kSegmentSuffix);
+  return name;
+}
+
+// Номер сегмента з імені файлу або 0 для сторонніх файлів.
+uint32_t SegmentId(const std::string& name) {
+  const size_t prefix = sizeof(kSegmentPrefix) - 1;
+  const size_t suffix = sizeof(kSegmentSuffix) - 1;
+  if (name.size() <= prefix + suffix ||
+      name.compare(0, prefix, kSegmentPrefix) != 0 ||
+      name.compare(name.size() - suffix, suffix, kSegmentSuffix) != 0) {
+    return 0;
+  }
+  uint32_t id = 0;
+  for (size_t i = prefix; i < name.size() - suffix; i++) {
+    if (name[i] < '0' || name[i] > '9') return 0;
+    id = id * 10 + static_cast<uint32_t>(name[i] - '0');
+  }
+  return id;
+}
+
+}  // namespace
+
+ReceiptArchive::ReceiptArchive(ReceiptArchiveOptions options)
+    : options_(options) {}
+
+ReceiptArchive::~ReceiptArchive() { Close(); }
+
+bool ReceiptArchive::Open(const std::string& dir, std::string* error) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  CloseLocked();
+  dir_ = dir;
+  if (OpenLocked(error)) return true;
+  CloseLocked();
+  return false;
+}
+
+void ReceiptArchive::Close() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  CloseLocked();
+}
+
+bool ReceiptArchive::is_open() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return writer_ != nullptr;
+}
+
+bool ReceiptArchive::OpenLocked(std::string* error) {
+  std::error_code ec;
+  const fs::path root = fs::u8path(dir_);
+  fs::create_directories(root, ec);
+  std::vector<uint32_t> ids;
+  for (const auto& entry : fs::directory_iterator(root, ec)) {
+    const uint32_t id = SegmentId(entry.path().filename().u8string());
+    if (id) ids.push_back(id);
+  }
+  if (ec) {
+    if (error) *error = "cannot list " + dir_ + ": " + ec.message();
+    return false;
+  }
+  std::sort(ids.begin(), ids.end());
+
+  for (uint32_t id : ids) {
+    Segment& segment = segments_.emplace_back();
+    segment.id = id;
+    segment.path = (root / SegmentName(id)).u8string();
+    segment.file = OpenFile(segment.path, "rb");
+    if (!segment.file) {
+      if (error) *error = "cannot open " + segment.path;
+      return false;
+    }
+  }
+  for (size_t i = 0; i < segments_.size(); i++) {
+    // CRC перевіряємо лише в останньому сегменті: попередні закриті
+    // повністю, а обірваний запис можливий тільки в кінці журналу.
+    if (!ScanSegment(i, i + 1 == segments_.size(), error)) return false;
+  }
+  if (segments_.empty()) return StartSegmentLocked(error);
+  writer_ = OpenFile(segments_.back().path, "ab");
+  if (!writer_) {
+    if (error) *error = "cannot append to " + segments_.back().path;
+    return false;
+  }
+  return true;
+}
+
+void ReceiptArchive::CloseLocked() {
+  if (writer_) std::fclose(writer_);
+  writer_ = nullptr;
+  for (Segment& segment : segments_) {
+    if (segment.file) std::fclose(segment.file);
+  }
+  segments_.clear();
+  locations_.clear();
+  by_fiscal_.clear();
+  by_rrn_.clear();
+  by_barcode_.clear();
+  by_date_.clear();
+}
+
+bool ReceiptArchive::ScanSegment(size_t index, bool verify,
+                                 std::string* error) {
+  Segment& segment = segments_[index];
+  // Сегмент читається одним шматком: ключі записів розкидані між тілами,
+  // і fseek через кожне тіло скидав би буфер stdio.
+  std::string data;
+  std::error_code ec;
+  data.resize(fs::file_size(fs::u8path(segment.path), ec));
+  std::fseek(segment.file, 0, SEEK_SET);
+  if (ec || std::fread(&data[0], 1, data.size(), segment.file) != data.size()) {
+    if (error) *error = "cannot read " + segment.path;
+    return false;
+  }
+  segment.bytes = 0;
+  segment.dead = 0;
+  size_t offset = 0;
+  ReceiptKeys keys;
+  while (data.size() - offset >= kHeaderBytes) {
+    const char* header = data.data() + offset;
+    if (GetU32(header) != kRecordMagic) break;
+    const uint32_t keys_len = GetU32(header + 4);
+    const uint32_t body_len = GetU32(header + 8);
+    if (data.size() - offset - kHeaderBytes < uint64_t{keys_len} + body_len) {
+      break;
+    }
+    const std::string_view record(header + kHeaderBytes, keys_len + body_len);
+    if (verify && Crc32(record.data(), record.size()) != GetU32(header + 12)) {
+      break;
+    }
+    if (!DecodeReceiptKeys(record.substr(0, keys_len), &keys)) break;
+
+    Location loc;
+    loc.segment = static_cast<uint32_t>(index);
+    loc.offset = static_cast<uint32_t>(offset);
+    loc.keys = keys_len;
+    loc.body = body_len;
+    loc.created_ms = keys.created_ms;
+    locations_.push_back(loc);
+    offset += kHeaderBytes + keys_len + body_len;
+    segment.bytes = offset;
+    IndexRecord(static_cast<uint32_t>(locations_.size() - 1), keys);
+  }
+
+  if (offset != data.size() && verify) {
+    // Обірваний хвіст після збою: відрізаємо, щоб дописувати після
+    // останнього цілого запису.
+    std::fclose(segment.file);
+    fs::resize_file(fs::u8path(segment.path), offset, ec);
+    segment.file = OpenFile(segment.path, "rb");
+    if (ec || !segment.file) {
+      if (error) *error = "cannot truncate " + segment.path;
+      return false;
+    }
+  }
+  return true;
+}
+
+void ReceiptArchive::IndexRecord(uint32_t location, const ReceiptKeys& keys) {
+  Location& loc = locations_[location];
+  Segment& segment = segments_[loc.segment];
+  auto inserted = by_fiscal_.try_emplace(keys.fiscal_number, location);
+  if (!inserted.second) {
+    Location& old = locations_[inserted.first->second];
+    old.live = false;
+    segments_[old.segment].dead += kHeaderBytes + old.keys + old.body;
+    inserted.first->second = location;
+  }
+  if (!keys.rrn.empty()) by_rrn_[keys.rrn].push_back(location);
+  by_date_[keys.date].push_back(location);
+  for (size_t i = 0; i < keys.barcodes.size(); i++) {
+    const std::string& barcode = keys.barcodes[i];
+    // Той самий штрихкод у кількох рядках чека — один запис індексу.
+    if (std::find(keys.barcodes.begin(), keys.barcodes.begin() + i,
+                  barcode) != keys.barcodes.begin() + i) {
+      continue;
+    }
+    by_barcode_[barcode].push_back(location);
+  }
+  segment.newest_date = std::max(segment.newest_date, keys.date);
+}
+
+bool ReceiptArchive::StartSegmentLocked(std::string* error) {
+  // Записи Compact без fsync мають лягти на диск до закриття сегмента.
+  if (writer_ && !SyncFile(writer_)) {
+    if (error) *error = "cannot sync " + segments_.back().path;
+    return false;
+  }
+  if (writer_) std::fclose(writer_);
+  writer_ = nullptr;
+  const uint32_t id = segments_.empty() ? 1 : segments_.back().id + 1;
+  Segment segment;
+  segment.id = id;
+  segment.path = (fs::u8path(dir_) / SegmentName(id)).u8string();
+  writer_ = OpenFile(segment.path, "ab");
+  segment.file = writer_ ? OpenFile(segment.path, "rb") : nullptr;
+  if (!segment.file) {
+    if (error) *error = "cannot create " + segment.path;
+    return false;
+  }
+  segments_.push_back(segment);
+  return true;
+}
+
+bool ReceiptArchive::Put(const ArchivedReceipt& receipt, std::string* error) {
+  std::string keys;
+  std::string body;
+  EncodeReceiptKeys(receipt, &keys);
+  EncodeReceiptBody(receipt, &body);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!writer_) {
+    if (error) *error = "Receipt archive is not open";
+    return false;
+  }
+  return AppendLocked(keys, body, true, error);
+}
+
+bool ReceiptArchive::AppendLocked(const std::string& keys,
+                                  const std::string& body, bool sync,
+                                  std::string* error) {
+  if (segments_.back().bytes >= options_.segment_bytes &&
+      !StartSegmentLocked(error)) {
+    return false;
+  }
+  Segment& segment = segments_.back();
+  char header[kHeaderBytes];
+  PutU32(kRecordMagic, header);
+  PutU32(static_cast<uint32_t>(keys.size()), header + 4);
+  PutU32(static_cast<uint32_t>(body.size()), header + 8);
+  PutU32(RecordCrc(keys, body), header + 12);
+  const bool written =
+      std::fwrite(header, 1, kHeaderBytes, writer_) == kHeaderBytes &&
+      std::fwrite(keys.data(), 1, keys.size(), writer_) == keys.size() &&
+      std::fwrite(body.data(), 1, body.size(), writer_) == body.size() &&
+      (sync ? SyncFile(writer_) : std::fflush(writer_) == 0);
+  if (!written) {
+    // Недописаний запис прибираємо одразу, інакше наступні записи
+    // опинилися б після сміття.
+    std::fclose(writer_);
+    std::error_code ec;
+    fs::resize_file(fs::u8path(segment.path), segment.bytes, ec);
+    writer_ = OpenFile(segment.path, "ab");
+    if (error) *error = "cannot write " + segment.path;
+    return false;
+  }
+
+  ReceiptKeys decoded;
+  DecodeReceiptKeys(keys, &decoded);
+  Location loc;
+  loc.segment = static_cast<uint32_t>(segments_.size() - 1);
+  loc.offset = static_cast<uint32_t>(segment.bytes);
+  loc.keys = static_cast<uint32_t>(keys.size());
+  loc.body = static_cast<uint32_t>(body.size());
+  loc.created_ms = decoded.created_ms;
+  locations_.push_back(loc);
+  segment.bytes += kHeaderBytes + keys.size() + body.size();
+  IndexRecord(static_cast<uint32_t>(locations_.size() - 1), decoded);
+  return true;
+}
+
+bool ReceiptArchive::ReadLocked(const Location& loc, bool visualization,
+                                ArchivedReceipt* receipt, std::string* keys,
+                                std::string* body) {
+  std::FILE* file = segments_[loc.segment].file;
+  char header[kHeaderBytes];
+  keys->resize(loc.keys);
+  body->resize(loc.body);
+  if (std::fseek(file, static_cast<long>(loc.offset), SEEK_SET) != 0 ||
+      std::fread(header, 1, kHeaderBytes, file) != kHeaderBytes ||
+      std::fread(&(*keys)[0], 1, loc.keys, file) != loc.keys ||
+      std::fread(&(*body)[0], 1, loc.body, file) != loc.body ||
+      RecordCrc(*keys, *body) != GetU32(header + 12)) {
+    std::clearerr(file);
+    return false;
+  }
+  return !receipt || DecodeReceipt(*keys, *body, visualization, receipt);
+}
+
+bool ReceiptArchive::ByFiscalNumber(const std::string& fiscal_number,
+                                    ArchivedReceipt* receipt) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = by_fiscal_.find(fiscal_number);
+  if (it == by_fiscal_.end()) return false;
+  std::string keys;
+  std::string body;
+  return ReadLocked(locations_[it->second], true, receipt, &keys, &body);
+}
+
+std::vector<ArchivedReceipt> ReceiptArchive::CollectLocked(
+    std::vector<uint32_t> found, size_t limit) {
+  found.erase(
+      std::remove_if(found.begin(), found.end(),
+                     [this](uint32_t i) { return !locations_[i].live; }),
+      found.end());
+  // Новіші першими; при однаковому часі — пізніший запис.
+  std::sort(found.begin(), found.end(), [this](uint32_t a, uint32_t b) {
+    const int64_t ta = locations_[a].created_ms;
+    const int64_t tb = locations_[b].created_ms;
+    return ta != tb ? ta > tb : a > b;
+  });
+  if (found.size() > limit) found.resize(limit);
+
+  std::vector<ArchivedReceipt> out;
+  out.reserve(found.size());
+  std::string keys;
+  std::string body;
+  for (uint32_t i : found) {
+    ArchivedReceipt receipt;
+    if (ReadLocked(locations_[i], false, &receipt, &keys, &body)) {
+      out.push_back(std::move(receipt));
+    }
+  }
+  return out;
+}
+
+std::vector<ArchivedReceipt> ReceiptArchive::ByRrn(const std::string& rrn,
+                                                   size_t limit) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = by_rrn_.find(rrn);
+  if (it == by_rrn_.end()) return {};
+  return CollectLocked(it->second, limit);
+}
+
+std::vector<ArchivedReceipt> ReceiptArchive::ByDate(int32_t from, int32_t to,
+                                                    size_t limit) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<uint32_t> found;
+  for (auto it = by_date_.lower_bound(from);
+       it != by_date_.end() && it->first <= to; ++it) {
+    found.insert(found.end(), it->second.begin(), it->second.end());
+  }
+  return CollectLocked(std::move(found), limit);
+}
+
+std::vector<ArchivedReceipt> ReceiptArchive::ByBarcode(
+    const std::string& barcode, size_t limit) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = by_barcode_.find(barcode);
+  if (it == by_barcode_.end()) return {};
+  return CollectLocked(it->second, limit);
+}
+
+bool ReceiptArchive::Compact(int32_t today, ReceiptArchiveCompaction* result,
+                             size_t max_segments) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  *result = ReceiptArchiveCompaction();
+  if (!writer_) return false;
+  const int64_t cutoff = DaysFromDate(today) - options_.retention_days;
+  uint64_t before = 0;
+  for (const Segment& segment : segments_) before += segment.bytes;
+
+  // Поточний сегмент не чіпаємо: у нього йде запис.
+  const size_t sealed = segments_.size() - 1;
+  std::vector<bool> drop(segments_.size(), false);
+  std::string keys;
+  std::string body;
+  bool ok = true;
+  size_t done = 0;
+  for (size_t i = 0; i < sealed && ok; i++) {
+    const Segment& segment = segments_[i];
+    const bool expired = DaysFromDate(segment.newest_date) < cutoff;
+    const bool sparse =
+        segment.bytes &&
+        segment.dead >= options_.compact_dead_ratio * segment.bytes;
+    if (!expired && !sparse) continue;
+    if (done == max_segments) {
+      result->pending_segments++;
+      continue;
+    }
+    done++;
+    if (expired) {
+      drop[i] = true;
+      result->expired_segments++;
+      continue;
+    }
+    // Живі записи переносяться в кінець журналу; AppendLocked позначає
+    // старі копії мертвими через індекс фіскальних номерів. fsync — один
+    // на всі перенесені записи, перед видаленням старих сегментів.
+    const size_t count = locations_.size();
+    for (size_t l = 0; l < count && ok; l++) {
+      const Location loc = locations_[l];
+      if (loc.segment != i || !loc.live) continue;
+      ok = ReadLocked(loc, false, nullptr, &keys, &body) &&
+           AppendLocked(keys, body, false, nullptr);
+    }
+    if (ok) {
+      drop[i] = true;
+      result->rewritten_segments++;
+    }
+  }
+
+  if (!done) return ok;
+  if (result->rewritten_segments && !SyncFile(writer_)) {
+    // Копії можуть бути лише в кеші ОС: старі сегменти лишаються.
+    *result = ReceiptArchiveCompaction();
+    return false;
+  }
+
+  // Перенесені записи могли відкрити нові сегменти.
+  drop.resize(segments_.size(), false);
+
+  // Індекси посилаються на номери в segments_ і locations_: записи
+  // видалених сегментів викидаються, решта перенумеровується без
+  // повторного читання сегментів.
+  std::vector<uint32_t> segment_map(segments_.size(), kDropped);
+  std::vector<Segment> kept;
+  for (size_t i = 0; i < segments_.size(); i++) {
+    if (!drop[i]) {
+      segment_map[i] = static_cast<uint32_t>(kept.size());
+      kept.push_back(segments_[i]);
+      continue;
+    }
+    std::fclose(segments_[i].file);
+    std::error_code ec;
+    fs::remove(fs::u8path(segments_[i].path), ec);
+  }
+  segments_ = std::move(kept);
+
+  std::vector<uint32_t> location_map(locations_.size(), kDropped);
+  uint32_t next = 0;
+  for (size_t l = 0; l < locations_.size(); l++) {
+    const uint32_t segment = segment_map[locations_[l].segment];
+    if (segment == kDropped) continue;
+    location_map[l] = next;
+    locations_[next] = locations_[l];
+    locations_[next++].segment = segment;
+  }
+  locations_.resize(next);
+  for (auto it = by_fiscal_.begin(); it != by_fiscal_.end();) {
+    // Живий запис простроченого сегмента зникає разом із ним.
+    const uint32_t location = location_map[it->second];
+    if (location == kDropped) {
+      it = by_fiscal_.erase(it);
+    } else {
+      it->second = location;
+      ++it;
+    }
+  }
+  RemapIndex(location_map, &by_rrn_);
+  RemapIndex(location_map, &by_barcode_);
+  RemapIndex(location_map, &by_date_);
+
+  uint64_t after = 0;
+  for (const Segment& segment : segments_) after += segment.bytes;
+  result->reclaimed_bytes = before > after ? before - after : 0;
+  return ok;
+}
+
+ReceiptArchiveStats ReceiptArchive::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ReceiptArchiveStats stats;
+  stats.receipts = by_fiscal_.size();
+  stats.segments = segments_.size();
+  for (const Segment& segment : segments_) {
+    stats.bytes += segment.bytes;
+    stats.dead_bytes += segment.dead;
+  }
+  return stats;
+}
+
+}  // namespace virok
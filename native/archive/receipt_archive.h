@@ -0,0 +1,137 @@
+#ifndef NATIVE_ARCHIVE_RECEIPT_ARCHIVE_H_
+#define NATIVE_ARCHIVE_RECEIPT_ARCHIVE_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "archive/archived_receipt.h"
+
+namespace virok {
+
+struct ReceiptArchiveOptions {
+  // Розмір сегмента, після якого запис переходить у новий файл.
+  uint64_t segment_bytes = 8 << 20;
+  // Скільки днів зберігати чеки; старші сегменти видаляє Compact().
+  int retention_days = 3 * 365;
+  // Частка перезаписаних чеків у сегменті, з якої Compact() його стискає.
+  double compact_dead_ratio = 0.5;
+};
+
+struct ReceiptArchiveStats {
+  size_t receipts = 0;
+  size_t segments = 0;
+  uint64_t bytes = 0;
+  uint64_t dead_bytes = 0;
+};
+
+struct ReceiptArchiveCompaction {
+  size_t expired_segments = 0;
+  size_t rewritten_segments = 0;
+  uint64_t reclaimed_bytes = 0;
+  // Сегменти, що теж просяться під Compact, але не влізли в max_segments.
+  size_t pending_segments = 0;
+};
+
+// Локальний архів фіскалізованих чеків для повернень і повторного друку.
+//
+// Лог-структурований: чеки лише дописуються в кінець поточного сегмента
+// (receipts-NNNNNN.log), повторний запис того самого фіскального номера
+// робить попередній "мертвим". Індекси (фіскальний номер, RRN, дата,
+// штрихкод) живуть у пам'яті й будуються при відкритті з ключових
+// префіксів записів — тіла чеків читаються лише при пошуку.
+//
+// Запис на диску: заголовок {magic, довжина ключів, довжина тіла, CRC-32}
+// і далі ключі й тіло (див. EncodeReceiptKeys/EncodeReceiptBody).
+// Put повертається після fflush + fsync. Обірваний останній запис (збій
+// живлення посеред запису) відрізається при відкритті. Потокобезпечний.
+class ReceiptArchive {
+ public:
+  explicit ReceiptArchive(ReceiptArchiveOptions options = {});
+  ~ReceiptArchive();
+
+  ReceiptArchive(const ReceiptArchive&) = delete;
+  ReceiptArchive& operator=(const ReceiptArchive&) = delete;
+
+  // Відкриває (створює) архів у каталозі |dir| і будує індекси.
+  bool Open(const std::string& dir, std::string* error);
+  void Close();
+  bool is_open() const;
+
+  // Дописує чек; чек з тим самим фіскальним номером замінює попередній.
+  bool Put(const ArchivedReceipt& receipt, std::string* error);
+
+  // Чек з візуалізацією або false, якщо не знайдено.
+  bool ByFiscalNumber(const std::string& fiscal_number,
+                      ArchivedReceipt* receipt);
+
+  // Списки — новіші першими, не більше |limit|, без візуалізації.
+  std::vector<ArchivedReceipt> ByRrn(const std::string& rrn, size_t limit);
+  // Дати yyyymmdd включно.
+  std::vector<ArchivedReceipt> ByDate(int32_t from, int32_t to, size_t limit);
+  std::vector<ArchivedReceipt> ByBarcode(const std::string& barcode,
+                                         size_t limit);
+
+  // Видаляє сегменти, де всі чеки старші за retention_days від |today|
+  // (yyyymmdd), і переписує сегменти з великою часткою мертвих записів.
+  // За один виклик — не більше |max_segments| сегментів: архів тримає
+  // м'ютекс усю роботу, тож у фоні його ущільнюють дрібними кроками, доки
+  // pending_segments не стане нулем.
+  bool Compact(int32_t today, ReceiptArchiveCompaction* result,
+               size_t max_segments = SIZE_MAX);
+
+  ReceiptArchiveStats stats() const;
+
+ private:
+  struct Segment {
+    uint32_t id = 0;
+    std::string path;
+    std::FILE* file = nullptr;  // для читання
+    uint64_t bytes = 0;
+    uint64_t dead = 0;
+    int32_t newest_date = 0;
+  };
+
+  struct Location {
+    uint32_t segment = 0;  // індекс у segments_
+    uint32_t offset = 0;
+    uint32_t keys = 0;
+    uint32_t body = 0;
+    int64_t created_ms = 0;
+    bool live = true;
+  };
+
+  bool OpenLocked(std::string* error);
+  void CloseLocked();
+  bool ScanSegment(size_t index, bool verify, std::string* error);
+  void IndexRecord(uint32_t location, const ReceiptKeys& keys);
+  bool StartSegmentLocked(std::string* error);
+  // |sync| — fsync після запису (Put); Compact синхронізує один раз.
+  bool AppendLocked(const std::string& keys, const std::string& body,
+                    bool sync, std::string* error);
+  bool ReadLocked(const Location& loc, bool visualization,
+                  ArchivedReceipt* receipt, std::string* keys,
+                  std::string* body);
+  std::vector<ArchivedReceipt> CollectLocked(std::vector<uint32_t> locations,
+                                             size_t limit);
+
+  const ReceiptArchiveOptions options_;
+  mutable std::mutex mutex_;
+  std::string dir_;
+  std::vector<Segment> segments_;
+  std::FILE* writer_ = nullptr;  // останній сегмент, для дописування
+
+  std::vector<Location> locations_;
+  std::unordered_map<std::string, uint32_t> by_fiscal_;
+  std::unordered_map<std::string, std::vector<uint32_t>> by_rrn_;
+  std::unordered_map<std::string, std::vector<uint32_t>> by_barcode_;
+  std::map<int32_t, std::vector<uint32_t>> by_date_;
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_ARCHIVE_RECEIPT_ARCHIVE_H_
@@ -0,0 +1,74 @@
+#ifndef NATIVE_BENCH_BENCH_UTIL_H_
+#define NATIVE_BENCH_BENCH_UTIL_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace virok {
+namespace bench {
+
+using Clock = std::chrono::steady_clock;
+
+inline double ElapsedUs(Clock::time_point start) {
+  return std::chrono::duration<double, std::micro>(Clock::now() - start)
+      .count();
+}
+
+// Накопичувач затримок з точними перцентилями (всі виміри в пам'яті).
+class LatencyStats {
+ public:
+  void Add(double us) {
+    samples_.push_back(us);
+    sorted_ = false;
+  }
+
+  // Додає виміри іншого накопичувача (зведення по потоках).
+  void Merge(const LatencyStats& other) {
+    samples_.insert(samples_.end(), other.samples_.begin(),
+                    other.samples_.end());
+    sorted_ = false;
+  }
+
+  size_t count() const { return samples_.size(); }
+
+  double Percentile(double p) {
+    if (samples_.empty()) return 0;
+    Sort();
+    const size_t rank = static_cast<size_t>(p / 100.0 * (samples_.size() - 1) + 0.5);
+    return samples_[std::min(rank, samples_.size() - 1)];
+  }
+
+  double Max() {
+    if (samples_.empty()) return 0;
+    Sort();
+    return samples_.back();
+  }
+
+  double Mean() const {
+    if (samples_.empty()) return 0;
+    double sum = 0;
+    for (double s : samples_) sum += s;
+    return sum / samples_.size();
+  }
+
+  void Print(const char* label) {
+    std::printf("%-32s n=%-7zu mean=%9.1fus p50=%9.1fus p99=%9.1fus max=%9.1fus\n",
+                label, count(), Mean(), Percentile(50), Percentile(99), Max());
+  }
+
+ private:
+  void Sort() {
+    if (!sorted_) std::sort(samples_.begin(), samples_.end());
+    sorted_ = true;
+  }
+
+  std::vector<double> samples_;
+  bool sorted_ = true;
+};
+
+}  // namespace bench
+}  // namespace virok
+
+#endif  // NATIVE_BENCH_BENCH_UTIL_H_
@@ -0,0 +1,293 @@
+// Передача каталогу при синхронізації (native/catalogue/catalogue_codec):
+// JSON з nomenklatura_with_data, як його віддає PostgREST, проти
+// стовпцевого пакета .vkc.
+//
+//   - розмір: JSON, JSON після LZ (замість gzip транспорту) і пакет;
+//   - завантаження з локального сервера статичних файлів (GET);
+//   - розбір: JSON -> записи проти пакет -> записи;
+//   - імпорт: записи -> пакет INSERT OR REPLACE -> nomenclatura.db
+//     однією транзакцією (як forceCacheNomenclatura).
+//
+// Розбір JSON тут — нативний потоковий читач; у Dart (jsonDecode, моделі,
+// повторний jsonEncode для virok_store_write) він у рази дорожчий, тож
+// виграш пакета на живій касі більший.
+//
+//   catalogue_codec_bench [товарів] [файл_бази]
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "archive/lz_block.h"
+#include "bench/bench_util.h"
+#include "bench/catalogue_fixture.h"
+#include "bench/sim_servers.h"
+#include "catalogue/catalogue_codec.h"
+#include "store/catalogue_import.h"
+#include "store/sqlite_store.h"
+
+using virok::CatalogueRecord;
+using virok::SqlBatch;
+using virok::SqliteStore;
+using virok::SqliteStoreOptions;
+using virok::SqlResult;
+using virok::bench::Clock;
+using virok::bench::ElapsedUs;
+using virok::bench::FixtureItem;
+using virok::bench::FixtureRandom;
+using virok::bench::LatencyStats;
+using virok::bench::StaticFileServer;
+
+namespace {
+
+constexpr int kRuns = 5;
+
+void AppendJsonString(const std::string& s, std::string* out) {
+  out->push_back('"');
+  for (char c : s) {
+    if (c == '"' || c == '\\') out->push_back('\\');
+    out->push_back(c);
+  }
+  out->push_back('"');
+}
+
+// Відповідь PostgREST: масиви barcodes і prices з array_agg, created_at
+// з мікросекундами і зсувом, description здебільшого null.
+std::string MakeJson(const std::vector<FixtureItem>& catalogue) {
+  FixtureRandom rnd(7);
+  std::string json = "[";
+  for (size_t i = 0; i < catalogue.size(); i++) {
+    const FixtureItem& item = catalogue[i];
+    if (i) json.push_back(',');
+    json += "{\"guid\":";
+    AppendJsonString(item.guid, &json);
+    // Два роки імпорту з облікової системи.
+    const int64_t seconds = 1672531200 + rnd.Below(63072000);
+    const std::string created = virok::FormatCatalogueTime(
+        seconds * 1000000 + rnd.Below(1000000), true);
+    json += ",\"created_at\":\"" + created.substr(0, created.size() - 1) +
+            "+00:00\",\"name\":";
+    AppendJsonString(item.name, &json);
+    json += ",\"article\":";
+    AppendJsonString(item.article, &json);
+    json += ",\"unit_name\":";
+    AppendJsonString(item.unit_name, &json);
+    json += ",\"unit_guid\":";
+    AppendJsonString(item.unit_guid, &json);
+    json += ",\"is_folder\":false,\"parent_guid\":";
+    AppendJsonString(item.parent_guid, &json);
+    json += ",\"description\":";
+    if (rnd.Below(10) == 0) {
+      AppendJsonString("Постачальник: " + item.name.substr(0, 16), &json);
+    } else {
+      json += "null";
+    }
+    json += ",\"barcodes\":[";
+    size_t start = 0;
+    while (start < item.barcodes.size()) {
+      size_t comma = item.barcodes.find(',', start);
+      if (comma == std::string::npos) comma = item.barcodes.size();
+      if (start) json.push_back(',');
+      AppendJsonString(item.barcodes.substr(start, comma - start), &json);
+      start = comma + 1;
+    }
+    char price[32];
+    std::snprintf(price, sizeof(price), "%.2f", item.price);
+    json += "],\"prices\":[";
+    json += price;
+    json += "]}";
+  }
+  json += "]";
+  return json;
+}
+
+bool SameRecords(std::vector<CatalogueRecord> a,
+                 std::vector<CatalogueRecord> b) {
+  auto by_guid = [](const CatalogueRecord& x, const CatalogueRecord& y) {
+    return x.guid < y.guid;
+  };
+  std::sort(a.begin(), a.end(), by_guid);
+  std::sort(b.begin(), b.end(), by_guid);
+  if (a.size() != b.size()) return false;
+  for (size_t i = 0; i < a.size(); i++) {
+    const CatalogueRecord& x = a[i];
+    const CatalogueRecord& y = b[i];
+    if (x.guid != y.guid || x.created_at_us != y.created_at_us ||
+        x.created_at_utc != y.created_at_utc || x.name != y.name ||
+        x.article != y.article || x.unit_name != y.unit_name ||
+        x.unit_guid != y.unit_guid || x.is_folder != y.is_folder ||
+        x.has_parent != y.has_parent || x.parent_guid != y.parent_guid ||
+        x.has_description != y.has_description ||
+        x.description != y.description || x.barcodes != y.barcodes ||
+        x.price != y.price) {
+      return false;
+    }
+  }
+  return true;
+}
+
+double Mb(size_t bytes) { return bytes / 1048576.0; }
+
+// Час передачі |bytes| каналом |mbit| Мбіт/с, с.
+double LinkSeconds(size_t bytes, double mbit) {
+  return bytes * 8 / (mbit * 1e6);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+  namespace fs = std::filesystem;
+  const fs::path path =
+      argc > 2 ? fs::path(argv[2])
+               : fs::temp_directory_path() / "virok_catalogue_codec_bench.db";
+
+  const std::string json = MakeJson(virok::bench::MakeCatalogue(count));
+  std::string error;
+
+  std::vector<CatalogueRecord> records;
+  LatencyStats parse_json;
+  for (int run = 0; run < kRuns; run++) {
+    records.clear();
+    const auto start = Clock::now();
+    if (!virok::ParseCatalogueJson(json, &records, &error)) {
+      std::fprintf(stderr, "json: %s\n", error.c_str());
+      return 1;
+    }
+    parse_json.Add(ElapsedUs(start));
+  }
+
+  std::string packed;
+  LatencyStats encode;
+  for (int run = 0; run < kRuns; run++) {
+    packed.clear();
+    const auto start = Clock::now();
+    virok::EncodeCatalogue(records, &packed);
+    encode.Add(ElapsedUs(start));
+  }
+
+  std::vector<CatalogueRecord> decoded;
+  LatencyStats decode;
+  for (int run = 0; run < kRuns; run++) {
+    decoded.clear();
+    const auto start = Clock::now();
+    if (!virok::DecodeCatalogue(packed, &decoded, &error)) {
+      std::fprintf(stderr, "decode: %s\n", error.c_str());
+      return 1;
+    }
+    decode.Add(ElapsedUs(start));
+  }
+  if (!SameRecords(records, decoded)) {
+    std::fprintf(stderr, "decoded catalogue differs from the JSON\n");
+    return 1;
+  }
+
+  std::string json_lz;
+  virok::LzCompress(json, &json_lz);
+
+  std::printf("catalogue: %zu items\n", count);
+  std::printf("%-12s %10s %8s %14s %14s\n", "format", "size", "ratio",
+              "10 Mbit/s", "100 Mbit/s");
+  const std::pair<const char*, size_t> sizes[] = {
+      {"json", json.size()}, {"json+lz", json_lz.size()},
+      {"vkc", packed.size()}};
+  for (const auto& [name, bytes] : sizes) {
+    std::printf("%-12s %7.2f MB %7.1fx %12.2f s %12.2f s\n", name, Mb(bytes),
+                static_cast<double>(json.size()) / bytes,
+                LinkSeconds(bytes, 10), LinkSeconds(bytes, 100));
+  }
+
+  const double json_s = parse_json.Percentile(50) / 1e6;
+  const double decode_s = decode.Percentile(50) / 1e6;
+  std::printf("parse json:  %8.1f ms  %7.1f MB/s  %9.0f rows/s\n",
+              json_s * 1e3, Mb(json.size()) / json_s, count / json_s);
+  std::printf("decode vkc:  %8.1f ms  %7.1f MB/s  %9.0f rows/s\n",
+              decode_s * 1e3, Mb(packed.size()) / decode_s, count / decode_s);
+  std::printf("encode vkc:  %8.1f ms\n", encode.Percentile(50) / 1e3);
+
+  // Завантаження з локального сервера: лише ціна стека, без мережі.
+  StaticFileServer server(virok::SimulationProfile{}, 1);
+  server.Put("/catalogue.json", json);
+  server.Put("/catalogue.vkc", packed);
+  if (!server.Start()) {
+    std::perror("server");
+    return 1;
+  }
+  LatencyStats fetch_json, fetch_packed;
+  for (int run = 0; run < kRuns; run++) {
+    int status;
+    std::string body;
+    auto start = Clock::now();
+    if (!virok::bench::HttpGet(server.port(), "/catalogue.json", &status,
+                               &body) ||
+        body.size() != json.size()) {
+      std::fprintf(stderr, "GET json: %d\n", status);
+      return 1;
+    }
+    fetch_json.Add(ElapsedUs(start));
+    start = Clock::now();
+    if (!virok::bench::HttpGet(server.port(), "/catalogue.vkc", &status,
+                               &body) ||
+        body != packed) {
+      std::fprintf(stderr, "GET vkc: %d\n", status);
+      return 1;
+    }
+    fetch_packed.Add(ElapsedUs(start));
+  }
+  server.Stop();
+  fetch_json.Print("GET json (loopback)");
+  fetch_packed.Print("GET vkc (loopback)");
+
+  // Імпорт у базу: від отриманих байтів до зафіксованої транзакції.
+  for (const char* suffix : {"", "-wal", "-shm"}) {
+    std::error_code ec;
+    fs::remove(path.u8string() + suffix, ec);
+  }
+  SqliteStore store;
+  SqliteStoreOptions options;
+  options.readers = 0;
+  if (!store.Open(path.u8string(), options, &error)) {
+    std::fprintf(stderr, "open: %s\n", error.c_str());
+    return 1;
+  }
+  LatencyStats import_json, import_packed;
+  for (int run = 0; run < kRuns; run++) {
+    auto start = Clock::now();
+    std::vector<CatalogueRecord> rows;
+    std::vector<SqlBatch> batches;
+    if (!virok::ParseCatalogueJson(json, &rows, &error)) return 1;
+    virok::AppendCatalogueBatches(std::move(rows), true, &batches);
+    SqlResult result = store.WriteSync(std::move(batches));
+    if (!result.ok) {
+      std::fprintf(stderr, "import json: %s\n", result.error.c_str());
+      return 1;
+    }
+    import_json.Add(ElapsedUs(start));
+
+    start = Clock::now();
+    batches.clear();
+    if (!virok::CatalogueImportBatches(packed, true, &batches, &error)) {
+      std::fprintf(stderr, "import vkc: %s\n", error.c_str());
+      return 1;
+    }
+    result = store.WriteSync(std::move(batches));
+    if (!result.ok) {
+      std::fprintf(stderr, "import vkc: %s\n", result.error.c_str());
+      return 1;
+    }
+    import_packed.Add(ElapsedUs(start));
+  }
+  import_json.Print("import json -> store");
+  import_packed.Print("import vkc -> store");
+  store.Close();
+  for (const char* suffix : {"", "-wal", "-shm"}) {
+    std::error_code ec;
+    fs::remove(path.u8string() + suffix, ec);
+  }
+  return 0;
+}
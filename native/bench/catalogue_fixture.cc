@@ -0,0 +1,147 @@
+#include "bench/catalogue_fixture.h"
+
+#include <algorithm>
+
+namespace virok {
+namespace bench {
+
+namespace {
+
+const char* const kProducts[] = {
+    "Молоко", "Кефір", "Йогурт", "Сир", "Масло", "Хліб", "Батон", "Булка",
+    "Ковбаса", "Сосиски", "Шинка", "Цукор", "Сіль", "Борошно", "Гречка",
+    "Рис", "Макарони", "Олія", "Чай", "Кава", "Сік", "Вода", "Пиво",
+    "Шоколад", "Цукерки", "Печиво", "Вафлі", "Яблука", "Банани", "Морква",
+    "Картопля", "Цибуля", "Капуста", "Ряжанка", "Сметана", "Пельмені",
+    "Вареники", "Майонез", "Кетчуп", "Гірчиця", "Мед", "Джем", "Горіхи",
+    "Чипси", "Сухарі", "Порошок", "Мило", "Шампунь", "Зубна паста",
+    "Серветки", "Папір туалетний", "Губки", "Пакети", "Батарейки",
+};
+
+const char* const kBrands[] = {
+    "Галичина", "Яготинське", "Простоквашино", "Президент", "Рошен",
+    "Світоч", "Київхліб", "Глобино", "Мироновський", "Щедро", "Торчин",
+    "Олейна", "Моршинська", "Оболонь", "Львівське", "Садочок", "Сандора",
+    "Жменька", "Ферма", "Добра ферма", "Вимм-Билль", "Хуторок", "Ласунка",
+    "Біла Лінія", "Своя лінія", "Повна Чаша", "Козуб", "Рудь", "Лімо",
+};
+
+const char* const kSizes[] = {
+    "200г", "250г", "400г", "500г", "900г", "1кг", "2кг", "0.5л",
+    "0.9л", "1л", "1.5л", "2л", "5л", "10шт", "12шт", "24шт", "100г",
+};
+
+const char* const kTraits[] = {
+    "", "", "", "2.5%", "3.2%", "1%", "15%", "нежирний", "класичний",
+    "пастеризоване", "ультрапастеризоване", "органічний", "без цукру",
+    "вершковий", "полуниця", "ваніль", "житній", "пшеничний",
+};
+
+const char* const kUnits[][2] = {
+    {"шт", "b1e1b2a4-0000-4000-8000-000000000001"},
+    {"кг", "b1e1b2a4-0000-4000-8000-000000000002"},
+    {"л", "b1e1b2a4-0000-4000-8000-000000000003"},
+    {"уп", "b1e1b2a4-0000-4000-8000-000000000004"},
+};
+
+template <typename T, size_t N>
+constexpr uint32_t CountOf(T (&)[N]) {
+  return static_cast<uint32_t>(N);
+}
+
+}  // namespace
+
+std::string LowerUkrainian(const std::string& utf8) {
+  std::string out;
+  out.reserve(utf8.size());
+  for (size_t i = 0; i < utf8.size(); i++) {
+    const unsigned char c = static_cast<unsigned char>(utf8[i]);
+    if (c >= 'A' && c <= 'Z') {
+      out.push_back(static_cast<char>(c + 32));
+      continue;
+    }
+    if (i + 1 < utf8.size()) {
+      const unsigned char n = static_cast<unsigned char>(utf8[i + 1]);
+      if (c == 0xD0 && n >= 0x90 && n <= 0x9F) {  // А..П
+        out.push_back(static_cast<char>(0xD0));
+        out.push_back(static_cast<char>(n + 0x20));
+        i++;
+        continue;
+      }
+      if (c == 0xD0 && n >= 0xA0 && n <= 0xAF) {  // Р..Я
+        out.push_back(static_cast<char>(0xD1));
+        out.push_back(static_cast<char>(n - 0x20));
+        i++;
+        continue;
+      }
+      if (c == 0xD0 && (n == 0x84 || n == 0x86 || n == 0x87)) {  // Є, І, Ї
+        out.push_back(static_cast<char>(0xD1));
+        out.push_back(static_cast<char>(n + 0x10));
+        i++;
+        continue;
+      }
+      if (c == 0xD2 && n == 0x90) {  // Ґ
+        out.push_back(static_cast<char>(0xD2));
+        out.push_back(static_cast<char>(0x91));
+        i++;
+        continue;
+      }
+    }
+    out.push_back(static_cast<char>(c));
+  }
+  return out;
+}
+
+std::string FixtureItem::SearchKey() const {
+  return LowerUkrainian(article + barcodes + name);
+}
+
+std::vector<FixtureItem> MakeCatalogue(size_t count, uint64_t seed) {
+  FixtureRandom rnd(seed);
+
+  // Невелике дерево категорій: кожен товар посилається на одну з них.
+  std::vector<std::string> parents;
+  for (int i = 0; i < 200; i++) parents.push_back(FixtureGuid(rnd));
+
+  std::vector<FixtureItem> items;
+  items.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    FixtureItem item;
+    item.guid = FixtureGuid(rnd);
+
+    item.name = kProducts[rnd.Below(CountOf(kProducts))];
+    item.name += " ";
+    item.name += kBrands[rnd.Below(CountOf(kBrands))];
+    const char* trait = kTraits[rnd.Below(CountOf(kTraits))];
+    if (*trait) {
+      item.name += " ";
+      item.name += trait;
+    }
+    item.name += " ";
+    item.name += kSizes[rnd.Below(CountOf(kSizes))];
+
+    item.article = std::to_string(100000 + rnd.Below(900000));
+
+    const uint32_t barcode_count = rnd.Below(3);
+    for (uint32_t b = 0; b < barcode_count; b++) {
+      if (b) item.barcodes += ",";
+      item.barcodes += "482" + std::to_string(1000000000ULL + rnd.Below(999999999));
+    }
+
+    const auto& unit = kUnits[rnd.Below(CountOf(kUnits))];
+    item.unit_name = unit[0];
+    item.unit_guid = unit[1];
+    item.parent_guid = parents[rnd.Below(static_cast<uint32_t>(parents.size()))];
+    item.price = (100 + rnd.Below(200000)) / 100.0;
+    items.push_back(std::move(item));
+  }
+
+  std::sort(items.begin(), items.end(),
+            [](const FixtureItem& a, const FixtureItem& b) {
+              return a.name < b.name;
+            });
+  return items;
+}
+
+}  // namespace bench
+}  // namespace virok
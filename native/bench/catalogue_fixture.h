@@ -0,0 +1,66 @@
+#ifndef NATIVE_BENCH_CATALOGUE_FIXTURE_H_
+#define NATIVE_BENCH_CATALOGUE_FIXTURE_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace virok {
+namespace bench {
+
+// Синтетичний рядок номенклатури, схожий на nomenklatura_with_data.
+struct FixtureItem {
+  std::string guid;
+  std::string name;
+  std::string article;
+  std::string barcodes;  // через кому, як у колонці barcodes
+  std::string unit_name;
+  std::string unit_guid;
+  std::string parent_guid;
+  double price = 0;
+
+  // search_name = LOWER(article || barcodes || name), як у SQLite.
+  std::string SearchKey() const;
+};
+
+// Детермінований генератор (xorshift), щоб прогони були порівнюваними.
+class FixtureRandom {
+ public:
+  explicit FixtureRandom(uint64_t seed) : state_(seed ? seed : 1) {}
+
+  uint64_t Next() {
+    state_ ^= state_ << 13;
+    state_ ^= state_ >> 7;
+    state_ ^= state_ << 17;
+    return state_;
+  }
+
+  uint32_t Below(uint32_t n) { return static_cast<uint32_t>(Next() % n); }
+
+ private:
+  uint64_t state_;
+};
+
+inline std::string FixtureGuid(FixtureRandom& rnd) {
+  char buf[40];
+  const uint64_t a = rnd.Next(), b = rnd.Next();
+  std::snprintf(buf, sizeof(buf), "%08x-%04x-%04x-%04x-%012llx",
+                static_cast<unsigned>(a >> 32),
+                static_cast<unsigned>((a >> 16) & 0xffff),
+                static_cast<unsigned>(a & 0xffff),
+                static_cast<unsigned>(b >> 48),
+                static_cast<unsigned long long>(b & 0xffffffffffffULL));
+  return buf;
+}
+
+// Генерує |count| товарів, відсортованих за назвою (як ORDER BY name).
+std::vector<FixtureItem> MakeCatalogue(size_t count, uint64_t seed = 42);
+
+// Кирилиця в нижньому регістрі для ключів пошуку (лише А-Я, Ґ, Є, І, Ї).
+std::string LowerUkrainian(const std::string& utf8);
+
+}  // namespace bench
+}  // namespace virok
+
+#endif  // NATIVE_BENCH_CATALOGUE_FIXTURE_H_
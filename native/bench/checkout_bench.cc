@@ -0,0 +1,413 @@
+// Наскрізний сценарій каси: оплата карткою -> фіскалізація -> друк чека ->
+// запис у бекенд, проти локальних імітацій ПРРО, принтера і REST-бекенду.
+//
+// Кожна "лінія" — окрема каса зі своїм фіскальним пристроєм; принтер і
+// бекенд спільні. Виклики йдуть за контрактом каналу com.cashalot/api
+// (ті самі методи й аргументи, що шле CashalotComService), а відповідь
+// розбирається і друкується тим самим нативним кодом, що в раннері.
+//
+//   checkout_bench [--checkouts=200] [--lanes=4] [--card-share=0.3]
+//                  [--fiscal-ms=60] [--fiscal-fail=0.01]
+//                  [--card-ms=150] [--card-fail=0.02]
+//                  [--printer-ms=15] [--printer-fail=0.01]
+//                  [--backend-ms=25] [--backend-fail=0.01]
+//                  [--baseline=FILE] [--write-baseline=FILE]
+//                  [--tolerance=0.15]
+//
+// З --baseline порівнює p50/p99 кожного етапу й пропускну здатність зі
+// збереженими і повертає 1, якщо щось погіршилося більше ніж на tolerance.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench/bench_util.h"
+#include "bench/catalogue_fixture.h"
+#include "bench/sim_servers.h"
+#include "fiscal/simulated_fiscal_device.h"
+#include "json/json_reader.h"
+#include "printing/escpos.h"
+
+using virok::FiscalArgs;
+using virok::FiscalReply;
+using virok::JsonReader;
+using virok::SimulatedFiscalDevice;
+using virok::SimulationProfile;
+using virok::bench::Clock;
+using virok::bench::ElapsedUs;
+using virok::bench::FixtureItem;
+using virok::bench::FixtureRandom;
+using virok::bench::LatencyStats;
+
+namespace {
+
+// Етапи в порядку виконання; "checkout" — від початку до запису в бекенд.
+const char* const kStages[] = {"build", "card",    "fiscal", "decode",
+                               "print", "backend", "checkout"};
+
+struct Config {
+  int checkouts = 200;
+  int lanes = 4;
+  double card_share = 0.3;
+  SimulationProfile fiscal{60, 0.2, 0.02, 5, 0.01};
+  SimulationProfile card{150, 0.3, 0.02, 4, 0.02};
+  SimulationProfile printer{15, 0.2, 0.02, 5, 0.01};
+  SimulationProfile backend{25, 0.3, 0.03, 6, 0.01};
+  std::string baseline;
+  std::string write_baseline;
+  double tolerance = 0.15;
+};
+
+bool ParseFlag(const char* arg, Config* c) {
+  const char* eq = std::strchr(arg, '=');
+  if (std::strncmp(arg, "--", 2) != 0 || !eq) return false;
+  const std::string key(arg + 2, eq);
+  const char* value = eq + 1;
+  const std::map<std::string, double*> doubles = {
+      {"card-share", &c->card_share},
+      {"fiscal-ms", &c->fiscal.base_ms},
+      {"fiscal-fail", &c->fiscal.failure_rate},
+      {"card-ms", &c->card.base_ms},
+      {"card-fail", &c->card.failure_rate},
+      {"printer-ms", &c->printer.base_ms},
+      {"printer-fail", &c->printer.failure_rate},
+      {"backend-ms", &c->backend.base_ms},
+      {"backend-fail", &c->backend.failure_rate},
+      {"tolerance", &c->tolerance},
+  };
+  if (auto it = doubles.find(key); it != doubles.end()) {
+    *it->second = std::atof(value);
+  } else if (key == "checkouts") {
+    c->checkouts = std::atoi(value);
+  } else if (key == "lanes") {
+    c->lanes = std::max(1, std::atoi(value));
+  } else if (key == "baseline") {
+    c->baseline = value;
+  } else if (key == "write-baseline") {
+    c->write_baseline = value;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// 12.5 -> "12,50", як _formatMoney у CashalotComService.
+std::string FormatComma(double value, int decimals) {
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), "%.*f", decimals, value);
+  for (char* p = buf; *p; p++) {
+    if (*p == '.') *p = ',';
+  }
+  return buf;
+}
+
+void AppendJsonString(std::string* out, const std::string& text) {
+  out->push_back('"');
+  for (char c : text) {
+    if (c == '"' || c == '\\') out->push_back('\\');
+    out->push_back(c);
+  }
+  out->push_back('"');
+}
+
+struct Receipt {
+  std::string json_goods;
+  std::string json_pay;
+  std::string backend_items;  // рядки kkm_check_items
+  double total = 0;
+  bool card = false;
+};
+
+// Чек як у HomeBloc -> CashalotComService.registerSale: здебільшого кілька
+// позицій, зрідка великий кошик.
+Receipt MakeReceipt(const std::vector<FixtureItem>& catalogue,
+                    FixtureRandom& rnd, double card_share) {
+  Receipt r;
+  const uint32_t lines =
+      rnd.Below(10) == 0 ? 10 + rnd.Below(30) : 1 + rnd.Below(8);
+  r.json_goods = "{\"ReceiptLst\":[";
+  r.backend_items = "[";
+  for (uint32_t i = 0; i < lines; i++) {
+    const FixtureItem& item = catalogue[rnd.Below(catalogue.size())];
+    const double quantity = rnd.Below(5) == 0 ? 1 + rnd.Below(4) : 1;
+    const double amount = quantity * item.price;
+    r.total += amount;
+    if (i) {
+      r.json_goods.push_back(',');
+      r.backend_items.push_back(',');
+    }
+    r.json_goods.append("{\"VendorCode\":");
+    AppendJsonString(&r.json_goods, item.article);
+    r.json_goods.append(",\"Name\":");
+    AppendJsonString(&r.json_goods, item.name);
+    r.json_goods.append(",\"Quantity\":\"" + FormatComma(quantity, 3) +
+                        "\",\"Price\":\"" + FormatComma(item.price, 2) +
+                        "\",\"Amount\":\"" + FormatComma(amount, 2) +
+                        "\",\"UnitType\":\"шт\",\"IsPriceIncludeVAT\":true,"
+                        "\"GoodsType\":0}");
+    r.backend_items.append("{\"nomenclature_guid\":\"" + item.guid +
+                           "\",\"quantity\":" + std::to_string(quantity) +
+                           ",\"price\":" + std::to_string(item.price) + "}");
+  }
+  r.json_goods.append("],\"Comment\":\"Чек з Flutter App\"}");
+  r.backend_items.push_back(']');
+
+  r.card = rnd.Below(1000) < static_cast<uint32_t>(card_share * 1000);
+  const std::string sum = FormatComma(r.total, 2);
+  r.json_pay = "{\"SumPayCheck\":\"" + sum + "\",\"" +
+               (r.card ? "SumPayByCard" : "SumCash") + "\":\"" + sum +
+               "\",\"PaymentOrderType\":0}";
+  return r;
+}
+
+// Visualization з відповіді fiscalizeCheck.
+bool ExtractVisualization(const std::string& json, std::string* base64) {
+  JsonReader reader(json);
+  if (reader.Next() != JsonReader::Token::kBeginObject) return false;
+  while (reader.Next() == JsonReader::Token::kKey) {
+    const bool wanted = reader.text() == "Visualization";
+    if (reader.Next() == JsonReader::Token::kString && wanted) {
+      base64->assign(reader.text());
+      return true;
+    }
+    if (!reader.Skip()) return false;
+  }
+  return false;
+}
+
+struct Results {
+  std::map<std::string, LatencyStats> stages;
+  std::map<std::string, int> failures;
+  int completed = 0;
+};
+
+void RunLane(int lane, const Config& config,
+             const std::vector<FixtureItem>& catalogue, uint16_t printer_port,
+             uint16_t backend_port, int checkouts, Results* results) {
+  SimulatedFiscalDevice::Options options;
+  options.fiscal = config.fiscal;
+  options.card = config.card;
+  options.seed = static_cast<uint64_t>(lane) + 1;
+  SimulatedFiscalDevice device(options);
+  FixtureRandom rnd(1000 + static_cast<uint64_t>(lane));
+  const std::string fiscal_num = std::to_string(4000000100LL + lane);
+
+  std::string base64, document, response;
+  for (int i = 0; i < checkouts; i++) {
+    const auto checkout_start = Clock::now();
+    auto start = checkout_start;
+    const Receipt receipt = MakeReceipt(catalogue, rnd, config.card_share);
+    results->stages["build"].Add(ElapsedUs(start));
+
+    if (receipt.card) {
+      start = Clock::now();
+      const FiscalReply pay =
+          device.Call("payByPaymentCard",
+                      {{"fiscalNum", fiscal_num},
+                       {"amount", FormatComma(receipt.total, 2)}});
+      results->stages["card"].Add(ElapsedUs(start));
+      if (!pay.success || !pay.error.empty()) {
+        results->failures["card"]++;
+        continue;
+      }
+    }
+
+    start = Clock::now();
+    const FiscalReply fiscal = device.Call(
+        "fiscalizeCheck", {{"fiscalNum", fiscal_num},
+                           {"jsonGoods", receipt.json_goods},
+                           {"jsonPay", receipt.json_pay}});
+    results->stages["fiscal"].Add(ElapsedUs(start));
+    if (!fiscal.success || !fiscal.error.empty()) {
+      results->failures["fiscal"]++;
+      continue;
+    }
+
+    start = Clock::now();
+    base64.clear();
+    const bool decoded = ExtractVisualization(fiscal.json_val, &base64) &&
+                         virok::VisualizationToEscPos(base64, &document);
+    results->stages["decode"].Add(ElapsedUs(start));
+    if (!decoded) results->failures["decode"]++;
+
+    // Чек уже фіскалізовано: збій принтера чи бекенду не скасовує продаж.
+    start = Clock::now();
+    if (decoded && !virok::bench::PrintToSink(printer_port, document)) {
+      results->failures["print"]++;
+    }
+    results->stages["print"].Add(ElapsedUs(start));
+
+    start = Clock::now();
+    int status = 0;
+    bool saved = virok::bench::HttpPost(
+        backend_port, "/rest/v1/kkm_checks",
+        "{\"kkm_cash_register\":\"" + fiscal_num +
+            "\",\"document_type\":\"Чек ККМ\",\"amount\":" +
+            std::to_string(receipt.total) + "}",
+        &status, &response);
+    if (saved) {
+      saved = virok::bench::HttpPost(backend_port, "/rest/v1/kkm_check_items",
+                                     receipt.backend_items, &status,
+                                     &response);
+    }
+    results->stages["backend"].Add(ElapsedUs(start));
+    if (!saved) results->failures["backend"]++;
+
+    results->stages["checkout"].Add(ElapsedUs(checkout_start));
+    results->completed++;
+  }
+}
+
+struct BaselineRow {
+  double p50 = 0;
+  double p99 = 0;
+};
+
+bool ReadBaseline(const std::string& path,
+                  std::map<std::string, BaselineRow>* rows,
+                  double* throughput) {
+  std::ifstream in(path);
+  if (!in) return false;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    std::istringstream fields(line);
+    std::string name;
+    fields >> name;
+    if (name == "throughput_per_s") {
+      fields >> *throughput;
+    } else {
+      BaselineRow row;
+      fields >> row.p50 >> row.p99;
+      (*rows)[name] = row;
+    }
+  }
+  return true;
+}
+
+// +12.3% (гірше) / -4.0% (краще) відносно бази.
+double Delta(double now, double base) {
+  return base > 0 ? (now - base) / base : 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Config config;
+  for (int i = 1; i < argc; i++) {
+    if (!ParseFlag(argv[i], &config)) {
+      std::fprintf(stderr, "unknown flag: %s\n", argv[i]);
+      return 2;
+    }
+  }
+
+  const std::vector<FixtureItem> catalogue = virok::bench::MakeCatalogue(5000);
+  virok::bench::EscPosSink printer(config.printer, 7);
+  virok::bench::RestBackend backend(config.backend, 11);
+  if (!printer.Start() || !backend.Start()) {
+    std::fprintf(stderr, "cannot listen on 127.0.0.1\n");
+    return 2;
+  }
+
+  std::printf("checkouts=%d lanes=%d card=%.0f%% fiscal=%.0fms card=%.0fms "
+              "printer=%.0fms backend=%.0fms\n",
+              config.checkouts, config.lanes, config.card_share * 100,
+              config.fiscal.base_ms, config.card.base_ms,
+              config.printer.base_ms, config.backend.base_ms);
+
+  std::vector<Results> lane_results(config.lanes);
+  std::vector<std::thread> lanes;
+  const auto wall_start = Clock::now();
+  for (int lane = 0; lane < config.lanes; lane++) {
+    const int share = config.checkouts / config.lanes +
+                      (lane < config.checkouts % config.lanes ? 1 : 0);
+    lanes.emplace_back(RunLane, lane, std::cref(config), std::cref(catalogue),
+                       printer.port(), backend.port(), share,
+                       &lane_results[lane]);
+  }
+  for (auto& lane : lanes) lane.join();
+  const double wall_s = ElapsedUs(wall_start) / 1e6;
+  printer.Stop();
+  backend.Stop();
+
+  Results total;
+  for (Results& r : lane_results) {
+    for (const auto& [stage, stats] : r.stages) {
+      total.stages[stage].Merge(stats);
+    }
+    for (const auto& [stage, count] : r.failures) {
+      total.failures[stage] += count;
+    }
+    total.completed += r.completed;
+  }
+  const double throughput = total.completed / wall_s;
+
+  std::printf("\n");
+  for (const char* stage : kStages) total.stages[stage].Print(stage);
+  std::printf("\ncompleted %d/%d in %.2fs: %.1f checkouts/s\n",
+              total.completed, config.checkouts, wall_s, throughput);
+  std::printf("printed %llu documents (%llu bytes), backend %llu requests\n",
+              static_cast<unsigned long long>(printer.documents()),
+              static_cast<unsigned long long>(printer.bytes()),
+              static_cast<unsigned long long>(backend.requests()));
+  for (const auto& [stage, count] : total.failures) {
+    std::printf("failures %-8s %d\n", stage.c_str(), count);
+  }
+
+  if (!config.write_baseline.empty()) {
+    std::FILE* out = std::fopen(config.write_baseline.c_str(), "w");
+    if (!out) {
+      std::fprintf(stderr, "cannot write %s\n", config.write_baseline.c_str());
+      return 2;
+    }
+    std::fprintf(out, "# checkout_bench baseline: stage p50_us p99_us\n");
+    for (const char* stage : kStages) {
+      std::fprintf(out, "%s %.0f %.0f\n", stage,
+                   total.stages[stage].Percentile(50),
+                   total.stages[stage].Percentile(99));
+    }
+    std::fprintf(out, "throughput_per_s %.2f\n", throughput);
+    std::fclose(out);
+    std::printf("\nbaseline written to %s\n", config.write_baseline.c_str());
+  }
+
+  if (config.baseline.empty()) return 0;
+
+  std::map<std::string, BaselineRow> base;
+  double base_throughput = 0;
+  if (!ReadBaseline(config.baseline, &base, &base_throughput)) {
+    std::fprintf(stderr, "cannot read baseline %s\n", config.baseline.c_str());
+    return 2;
+  }
+  std::printf("\nvs baseline %s (tolerance %.0f%%)\n", config.baseline.c_str(),
+              config.tolerance * 100);
+  bool regressed = false;
+  for (const char* stage : kStages) {
+    auto it = base.find(stage);
+    if (it == base.end()) continue;
+    LatencyStats& stats = total.stages[stage];
+    const double d50 = Delta(stats.Percentile(50), it->second.p50);
+    const double d99 = Delta(stats.Percentile(99), it->second.p99);
+    // Етапи на кшталт build/decode вимірюються мікросекундами — там шум
+    // більший за tolerance, тож їх лише показуємо.
+    const bool significant = it->second.p50 >= 1000;
+    const bool bad =
+        significant && (d50 > config.tolerance || d99 > config.tolerance);
+    regressed |= bad;
+    std::printf("  %-10s p50 %+6.1f%%  p99 %+6.1f%%%s\n", stage, d50 * 100,
+                d99 * 100, bad ? "  REGRESSION" : "");
+  }
+  const double dt = Delta(throughput, base_throughput);
+  const bool bad_throughput = dt < -config.tolerance;
+  regressed |= bad_throughput;
+  std::printf("  %-10s      %+6.1f%%%s\n", "throughput", dt * 100,
+              bad_throughput ? "  REGRESSION" : "");
+  return regressed ? 1 : 0;
+}
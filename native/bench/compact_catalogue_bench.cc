@@ -0,0 +1,231 @@
+// Компактний каталог у пам'яті (native/catalogue/compact_catalogue) проти
+// каталогу з окремим об'єктом і рядками на кожен товар.
+//
+//   - пам'ять: байтів на товар у компактному каталозі (за стовпцями) і
+//     виміряний приріст купи для std::vector<CatalogueRecord>;
+//   - модель Dart: оцінка купи і кількості об'єктів для
+//     List<NomenclaturaModel> за розкладкою об'єктів 64-бітної Dart VM
+//     (заголовок 8 байтів, поля по 8, вирівнювання 16; рядок — 16 байтів
+//     + 1 чи 2 байти на символ). Кожен живий об'єкт старого покоління
+//     позначає збирач сміття при кожному повному проході — це і є
+//     паузи, які каса бачить як затримку сканування. Компактний каталог
+//     у Dart — один вказівник; ручки товарів живуть до кінця кадру і
+//     прибираються молодим поколінням;
+//   - доступ: декодування полів випадкового рядка, пошук за GUID.
+//
+//   compact_catalogue_bench [товарів]
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+#include <malloc.h>
+#define VIROK_HAVE_MALLINFO2 1
+#endif
+
+#include "bench/bench_util.h"
+#include "bench/catalogue_fixture.h"
+#include "catalogue/catalogue_codec.h"
+#include "catalogue/compact_catalogue.h"
+
+using virok::CatalogueRecord;
+using virok::CompactCatalogue;
+using virok::CompactCatalogueStats;
+using virok::bench::Clock;
+using virok::bench::ElapsedUs;
+using virok::bench::FixtureItem;
+using virok::bench::FixtureRandom;
+using virok::bench::LatencyStats;
+
+namespace {
+
+// Зайнята купа malloc; -1 — невідомо на цій платформі.
+int64_t HeapBytes() {
+#ifdef VIROK_HAVE_MALLINFO2
+  const struct mallinfo2 info = mallinfo2();
+  return static_cast<int64_t>(info.uordblks + info.hblkhd);
+#else
+  return -1;
+#endif
+}
+
+std::vector<CatalogueRecord> MakeRecords(size_t count) {
+  std::vector<CatalogueRecord> records;
+  records.reserve(count);
+  int64_t created = 1704103200000000LL;
+  for (FixtureItem& item : virok::bench::MakeCatalogue(count)) {
+    CatalogueRecord& r = records.emplace_back();
+    r.guid = std::move(item.guid);
+    r.created_at_us = created += 1234567;
+    r.name = std::move(item.name);
+    r.article = std::move(item.article);
+    r.unit_name = std::move(item.unit_name);
+    r.unit_guid = std::move(item.unit_guid);
+    r.has_parent = !item.parent_guid.empty();
+    r.parent_guid = std::move(item.parent_guid);
+    if (records.size() % 10 == 0) {
+      r.has_description = true;
+      r.description = "Зберігати при температурі від +2 до +6";
+    }
+    r.barcodes = std::move(item.barcodes);
+    r.price = item.price;
+  }
+  return records;
+}
+
+// Символів UTF-16 і чи вміщується рядок в OneByteString (Latin-1).
+void Utf16Length(std::string_view utf8, size_t* units, bool* one_byte) {
+  *units = 0;
+  *one_byte = true;
+  for (size_t i = 0; i < utf8.size(); i++) {
+    const uint8_t c = static_cast<uint8_t>(utf8[i]);
+    if ((c & 0xC0) == 0x80) continue;
+    *units += c >= 0xF0 ? 2 : 1;
+    if (c >= 0xC4) *one_byte = false;
+  }
+}
+
+struct DartEstimate {
+  uint64_t bytes = 0;
+  uint64_t objects = 0;
+
+  void AddObject(size_t size) {
+    bytes += (size + 15) / 16 * 16;
+    objects++;
+  }
+
+  void AddString(std::string_view utf8) {
+    size_t units;
+    bool one_byte;
+    Utf16Length(utf8, &units, &one_byte);
+    AddObject(16 + units * (one_byte ? 1 : 2));
+  }
+};
+
+// List<NomenclaturaModel> з getCachedNomenclatura: модель (12 полів),
+// DateTime і власна копія кожного рядка (sqflite/JSON не інтернують).
+DartEstimate EstimateDartModels(const std::vector<CatalogueRecord>& records) {
+  DartEstimate dart;
+  dart.AddObject(16 + records.size() * 8);  // List
+  for (const CatalogueRecord& r : records) {
+    dart.AddObject(8 + 12 * 8);  // NomenclaturaModel
+    dart.AddObject(8 + 2 * 8);   // DateTime
+    dart.AddString(r.guid);
+    dart.AddString(r.name);
+    dart.AddString(r.article);
+    dart.AddString(r.unit_name);
+    dart.AddString(r.unit_guid);
+    if (r.has_parent) dart.AddString(r.parent_guid);
+    if (r.has_description) dart.AddString(r.description);
+    dart.AddString(r.barcodes);
+    dart.AddString(virok::CatalogueSearchName(r));
+  }
+  return dart;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t count =
+      argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+
+  int64_t heap = HeapBytes();
+  std::vector<CatalogueRecord> records = MakeRecords(count);
+  const int64_t records_heap = HeapBytes() - heap;
+  const DartEstimate dart = EstimateDartModels(records);
+
+  heap = HeapBytes();
+  const auto build_start = Clock::now();
+  CompactCatalogue::Builder builder;
+  for (const CatalogueRecord& record : records) {
+    if (!builder.Add(record)) {
+      std::fprintf(stderr, "add failed\n");
+      return 1;
+    }
+  }
+  const std::unique_ptr<CompactCatalogue> catalogue = builder.Finish();
+  const double build_ms = ElapsedUs(build_start) / 1000;
+  const int64_t compact_heap = HeapBytes() - heap;
+  const CompactCatalogueStats stats = catalogue->stats();
+
+  const double n = static_cast<double>(count);
+  std::printf("items: %zu (units %u, parents %u, text guids %u), "
+              "build %.1f ms\n",
+              count, stats.units, stats.parents, stats.text_guids, build_ms);
+  std::printf("compact: %.1f B/item (guid %.1f, name %.1f, tail %.1f, "
+              "fixed %.1f, intern %.2f); %.1f MB\n",
+              stats.bytes / n, stats.guid_bytes / n, stats.name_bytes / n,
+              stats.tail_bytes / n, stats.fixed_bytes / n,
+              stats.intern_bytes / n, stats.bytes / 1e6);
+  if (compact_heap >= 0) {
+    std::printf("heap growth: compact %.1f B/item, "
+                "vector<CatalogueRecord> %.1f B/item\n",
+                compact_heap / n, records_heap / n);
+  }
+  std::printf("Dart List<NomenclaturaModel> (estimate): %.1f B/item, "
+              "%.1f MB, %llu heap objects (%.1f/item) to mark per "
+              "old-gen GC; compact: 1\n",
+              dart.bytes / n, dart.bytes / 1e6,
+              static_cast<unsigned long long>(dart.objects),
+              dart.objects / n);
+  std::printf("reduction vs Dart model: %.1fx less memory\n",
+              static_cast<double>(dart.bytes) / stats.bytes);
+
+  // Випадкові рядки, як при прокручуванні і скануванні.
+  FixtureRandom rnd(47);
+  LatencyStats name, guid, barcodes, record, find;
+  size_t sink = 0;
+  for (int i = 0; i < 100000; i++) {
+    const uint32_t row = rnd.Below(catalogue->size());
+    auto start = Clock::now();
+    sink += catalogue->name(row).size();
+    name.Add(ElapsedUs(start));
+    start = Clock::now();
+    const std::string g = catalogue->guid(row);
+    guid.Add(ElapsedUs(start));
+    start = Clock::now();
+    sink += catalogue->barcodes(row).size();
+    barcodes.Add(ElapsedUs(start));
+    start = Clock::now();
+    sink += catalogue->Record(row).name.size();
+    record.Add(ElapsedUs(start));
+    start = Clock::now();
+    const uint32_t found = catalogue->FindByGuid(g);
+    find.Add(ElapsedUs(start));
+    if (found != row) {
+      std::fprintf(stderr, "find: row %u -> %u\n", row, found);
+      return 1;
+    }
+  }
+
+  // Повна перевірка: кожен товар знаходиться і декодується в той самий
+  // запис.
+  size_t mismatched = 0;
+  for (const CatalogueRecord& want : records) {
+    const uint32_t row = catalogue->FindByGuid(want.guid);
+    if (row == CompactCatalogue::kNoRow) {
+      mismatched++;
+      continue;
+    }
+    const CatalogueRecord got = catalogue->Record(row);
+    mismatched += got.guid != want.guid || got.name != want.name ||
+                  got.barcodes != want.barcodes ||
+                  got.article != want.article || got.price != want.price ||
+                  got.description != want.description ||
+                  got.parent_guid != want.parent_guid;
+  }
+
+  name.Print("name");
+  guid.Print("guid");
+  barcodes.Print("barcodes");
+  record.Print("record (all fields)");
+  find.Print("find by guid");
+  std::printf("mismatched rows: %zu\n", mismatched);
+  return sink && mismatched == 0 ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+// Фіскальний пристрій в окремому процесі (native/fiscal/fiscal_host.h)
+// проти прямого виклику в процесі каси, на імітації Cashalot без затримки:
+// вимірюється саме ціна IPC.
+//
+//   - послідовні виклики: p50/p99 round-trip getCurrentStatus і
+//     fiscalizeCheck (jsonGoods на |позицій| рядків);
+//   - конвеєр: |ітерацій| запитів без очікування відповіді, пропускна
+//     здатність;
+//   - відновлення: SIGKILL хоста і час до першої успішної відповіді.
+//
+//   fiscal_host_bench [позицій_у_чеку] [ітерацій]
+//
+// Той самий файл є й процесом-хостом (запуск з --fiscal-host).
+
+#include <signal.h>
+
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "bench/bench_util.h"
+#include "bench/catalogue_fixture.h"
+#include "fiscal/fiscal_host.h"
+#include "fiscal/simulated_fiscal_device.h"
+
+using virok::FiscalArgs;
+using virok::FiscalHostClient;
+using virok::FiscalHostOptions;
+using virok::FiscalReply;
+using virok::SimulatedFiscalDevice;
+using virok::bench::Clock;
+using virok::bench::ElapsedUs;
+using virok::bench::FixtureItem;
+using virok::bench::FixtureRandom;
+using virok::bench::LatencyStats;
+
+namespace {
+
+const char kFiscalNum[] = "4000000001";
+
+std::unique_ptr<virok::FiscalDevice> MakeDevice(const std::string&) {
+  SimulatedFiscalDevice::Options options;
+  options.fiscal.base_ms = 0;
+  options.fiscal.tail_rate = 0;
+  options.card.base_ms = 0;
+  options.card.tail_rate = 0;
+  return std::make_unique<SimulatedFiscalDevice>(options);
+}
+
+// jsonGoods так, як його будує CashalotComService.registerSale.
+std::string MakeReceiptJson(const std::vector<FixtureItem>& catalogue,
+                            size_t lines) {
+  FixtureRandom rnd(11);
+  std::string json = "{\"ReceiptLst\":[";
+  char buf[64];
+  for (size_t i = 0; i < lines; i++) {
+    const FixtureItem& item = catalogue[rnd.Below(catalogue.size())];
+    if (i) json.push_back(',');
+    std::snprintf(buf, sizeof(buf), "%.2f", item.price);
+    std::string price = buf;
+    price[price.find('.')] = ',';
+    json += "{\"VendorCode\":\"" + item.article + "\",\"Name\":\"" +
+            item.name + "\",\"Quantity\":\"1,000\",\"Price\":\"" + price +
+            "\",\"Amount\":\"" + price +
+            "\",\"UnitType\":\"шт\",\"IsPriceIncludeVAT\":true,"
+            "\"GoodsType\":0}";
+  }
+  json += "],\"Comment\":\"Чек з Flutter App\"}";
+  return json;
+}
+
+template <typename Device>
+LatencyStats Sequential(Device* device, const std::string& method,
+                        const FiscalArgs& args, int iterations) {
+  LatencyStats stats;
+  for (int i = 0; i < iterations; i++) {
+    const auto start = Clock::now();
+    const FiscalReply reply = device->Call(method, args);
+    stats.Add(ElapsedUs(start));
+    if (!reply.error.empty()) {
+      std::fprintf(stderr, "%s: %s\n", method.c_str(), reply.error.c_str());
+      std::exit(1);
+    }
+  }
+  return stats;
+}
+
+double PipelinedCallsPerSecond(FiscalHostClient* client, int iterations) {
+  std::mutex mutex;
+  std::condition_variable cv;
+  int remaining = iterations;
+  const auto start = Clock::now();
+  for (int i = 0; i < iterations; i++) {
+    client->Submit("getCurrentStatus", {{"fiscalNum", kFiscalNum}},
+                   [&](FiscalReply) {
+                     std::lock_guard<std::mutex> lock(mutex);
+                     if (--remaining == 0) cv.notify_one();
+                   });
+  }
+  std::unique_lock<std::mutex> lock(mutex);
+  cv.wait(lock, [&] { return remaining == 0; });
+  return iterations * 1e6 / ElapsedUs(start);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc >= 4 && std::strcmp(argv[1], virok::kFiscalHostFlag) == 0) {
+    return virok::RunFiscalHost(argv[2], argv[3], MakeDevice);
+  }
+
+  const size_t lines = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 30;
+  const int iterations = argc > 2 ? std::atoi(argv[2]) : 20000;
+
+  const std::vector<FixtureItem> catalogue =
+      virok::bench::MakeCatalogue(2000, 3);
+  const FiscalArgs status = {{"fiscalNum", kFiscalNum}};
+  const FiscalArgs check = {{"fiscalNum", kFiscalNum},
+                            {"jsonGoods", MakeReceiptJson(catalogue, lines)},
+                            {"jsonPay", "{\"Cash\":\"100,00\"}"}};
+
+  std::printf("fiscal host: %zu receipt lines (%zu bytes), %d iterations\n",
+              lines, check.at("jsonGoods").size(), iterations);
+
+  auto direct = MakeDevice(kFiscalNum);
+  Sequential(direct.get(), "getCurrentStatus", status, iterations / 10);
+  Sequential(direct.get(), "getCurrentStatus", status, iterations)
+      .Print("direct getCurrentStatus");
+  Sequential(direct.get(), "fiscalizeCheck", check, iterations / 4)
+      .Print("direct fiscalizeCheck");
+
+  FiscalHostClient client(kFiscalNum, FiscalHostOptions());
+  if (!client.Start()) {
+    std::fprintf(stderr, "failed to start fiscal host\n");
+    return 1;
+  }
+  Sequential(&client, "getCurrentStatus", status, iterations / 10);
+  Sequential(&client, "getCurrentStatus", status, iterations)
+      .Print("host getCurrentStatus");
+  Sequential(&client, "fiscalizeCheck", check, iterations / 4)
+      .Print("host fiscalizeCheck");
+
+  std::printf("host pipelined getCurrentStatus: %.0f calls/s\n",
+              PipelinedCallsPerSecond(&client, iterations));
+
+  // Відновлення: запит після SIGKILL хоста чекає, доки сторож помітить
+  // смерть, перезапустить хост і повторить журнал.
+  LatencyStats recovery;
+  for (int i = 0; i < 10; i++) {
+    kill(client.host_pid(), SIGKILL);
+    const auto start = Clock::now();
+    const FiscalReply reply = client.Call("getCurrentStatus", status);
+    recovery.Add(ElapsedUs(start));
+    if (!reply.error.empty()) {
+      std::fprintf(stderr, "after kill: %s\n", reply.error.c_str());
+      return 1;
+    }
+  }
+  recovery.Print("recovery after SIGKILL");
+  std::printf("host restarts: %d\n", client.restarts());
+  return 0;
+}
@@ -0,0 +1,193 @@
+// Пакетний друк цінників (native/printing/label_batch) на локальний
+// мережевий принтер етикеток (LabelPrinterSink, RAW через TCP).
+//
+//   - верстка: етикеток/с на 1..N потоках без мережі;
+//   - "спершу все зверстати, потім надіслати" — як друк з бек-офісу
+//     одним документом — проти конвеєра, де передача йде одночасно з
+//     версткою наступних: час до першої відрізаної етикетки і
+//     етикеток/с до останньої;
+//   - з затримкою друку етикетки (другий аргумент, мс) — коли швидкість
+//     упирається в механіку принтера, конвеєр тримає пам'ять у межах
+//     вікна, а не всього пакета.
+//
+//   label_batch_bench [етикеток] [мс друку етикетки]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "bench/bench_util.h"
+#include "bench/catalogue_fixture.h"
+#include "bench/sim_servers.h"
+#include "net/tcp_stream.h"
+#include "printing/escpos.h"
+#include "printing/label_batch.h"
+#include "printing/label_layout.h"
+
+using virok::LabelBatchOptions;
+using virok::LabelBatchStats;
+using virok::LabelTemplate;
+using virok::PriceLabel;
+using virok::bench::Clock;
+using virok::bench::LabelPrinterSink;
+using virok::bench::LatencyStats;
+
+namespace {
+
+constexpr int kRuns = 5;
+
+std::vector<PriceLabel> MakeLabels(size_t count) {
+  std::vector<PriceLabel> labels;
+  labels.reserve(count);
+  for (virok::bench::FixtureItem& item : virok::bench::MakeCatalogue(count)) {
+    PriceLabel& label = labels.emplace_back();
+    label.name = std::move(item.name);
+    label.article = std::move(item.article);
+    label.barcode = item.barcodes.substr(0, item.barcodes.find(','));
+    label.unit_name = std::move(item.unit_name);
+    label.price = item.price;
+  }
+  return labels;
+}
+
+bool WaitForLabels(const LabelPrinterSink& sink, uint64_t want) {
+  const auto deadline = Clock::now() + std::chrono::seconds(60);
+  while (sink.labels() < want) {
+    if (Clock::now() > deadline) return false;
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+  }
+  return true;
+}
+
+double SinceUs(Clock::time_point start, Clock::time_point at) {
+  return std::chrono::duration<double, std::micro>(at - start).count();
+}
+
+struct Run {
+  LatencyStats first;  // до першої відрізаної етикетки
+  LatencyStats total;  // до останньої
+};
+
+void PrintRun(const char* name, Run& run, size_t labels) {
+  const double seconds = run.total.Percentile(50) / 1e6;
+  std::printf("%-26s first label p50 %8.2f ms, all %8.1f ms, "
+              "%9.0f labels/s\n",
+              name, run.first.Percentile(50) / 1000,
+              run.total.Percentile(50) / 1000, labels / seconds);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t count =
+      argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+  const double print_ms = argc > 2 ? std::strtod(argv[2], nullptr) : 0;
+  const int cores = static_cast<int>(std::thread::hardware_concurrency());
+
+  const std::vector<PriceLabel> labels = MakeLabels(count);
+  LabelTemplate tmpl;
+  tmpl.width = 48;
+
+  std::string document(virok::kEscPosInit);
+  for (const PriceLabel& label : labels) {
+    virok::AppendPriceLabel(label, tmpl, &document);
+  }
+  std::printf("labels: %zu, %.0f B/label, cores %d, print %.1f ms/label\n",
+              count, static_cast<double>(document.size()) / count, cores,
+              print_ms);
+
+  // Лише верстка: приймач нічого не робить.
+  std::vector<int> thread_counts{1, 2, 4};
+  if (cores > 4) thread_counts.push_back(cores);
+  for (int threads : thread_counts) {
+    LatencyStats total;
+    for (int run = 0; run < kRuns; run++) {
+      LabelBatchOptions options;
+      options.threads = threads;
+      LabelBatchStats stats;
+      std::string error;
+      virok::PrintLabelBatch(
+          labels, tmpl, options,
+          [](std::string_view, std::string*) { return true; }, &stats,
+          &error);
+      total.Add(stats.total_us);
+    }
+    std::printf("layout only, %2d threads     %9.0f labels/s\n", threads,
+                count / (total.Percentile(50) / 1e6));
+  }
+
+  virok::SimulationProfile profile{print_ms, 0.1, 0, 1, 0};
+  LabelPrinterSink sink(profile, 49);
+  if (!sink.Start()) {
+    std::fprintf(stderr, "sink failed to start\n");
+    return 1;
+  }
+
+  // Спершу весь документ, потім одне відправлення.
+  Run sequential;
+  for (int run = 0; run < kRuns; run++) {
+    sink.Reset();
+    const auto start = Clock::now();
+    std::string whole(virok::kEscPosInit);
+    for (const PriceLabel& label : labels) {
+      virok::AppendPriceLabel(label, tmpl, &whole);
+    }
+    virok::TcpStream printer;
+    std::string error;
+    if (!printer.Connect("127.0.0.1", sink.port(), 5000, &error) ||
+        !printer.Write(whole, &error)) {
+      std::fprintf(stderr, "sequential: %s\n", error.c_str());
+      return 1;
+    }
+    printer.Close();
+    if (!WaitForLabels(sink, count)) {
+      std::fprintf(stderr, "sequential: sink got %llu labels\n",
+                   static_cast<unsigned long long>(sink.labels()));
+      return 1;
+    }
+    sequential.first.Add(SinceUs(start, sink.first_label()));
+    sequential.total.Add(SinceUs(start, sink.last_label()));
+  }
+  PrintRun("layout, then send", sequential, count);
+
+  for (int threads : thread_counts) {
+    Run pipelined;
+    LatencyStats handed;
+    for (int run = 0; run < kRuns; run++) {
+      sink.Reset();
+      const auto start = Clock::now();
+      LabelBatchOptions options;
+      options.threads = threads;
+      LabelBatchStats stats;
+      std::string error;
+      if (!virok::PrintLabelBatchTo("127.0.0.1", sink.port(), labels, tmpl,
+                                    options, &stats, &error)) {
+        std::fprintf(stderr, "pipelined: %s\n", error.c_str());
+        return 1;
+      }
+      if (!WaitForLabels(sink, count)) {
+        std::fprintf(stderr, "pipelined: sink got %llu labels\n",
+                     static_cast<unsigned long long>(sink.labels()));
+        return 1;
+      }
+      pipelined.first.Add(SinceUs(start, sink.first_label()));
+      pipelined.total.Add(SinceUs(start, sink.last_label()));
+      handed.Add(stats.first_label_us);
+    }
+    char name[64];
+    std::snprintf(name, sizeof(name), "pipelined, %d threads", threads);
+    PrintRun(name, pipelined, count);
+    if (threads == thread_counts.back()) {
+      handed.Print("first label handed to socket");
+    }
+  }
+
+  sink.Stop();
+  return 0;
+}
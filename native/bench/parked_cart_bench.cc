@@ -0,0 +1,177 @@
+// Відкладені кошики (native/parking): |кошиків| на касі, 4 касири, по
+// 1-40 рядків з каталогу, кожен п'ятий рядок — ваговий.
+//
+//   - park: кодування і запис з fflush + fsync (час до повернення в Dart);
+//   - open: відкриття журналу з усіма кошиками (перезапуск каси);
+//   - list: список касира і всіх касирів з пам'яті;
+//   - take: відновлення кошика з записом "забрати";
+//   - churn: 5 000 відкладань/відновлень поспіль — розмір журналу
+//     тримається завдяки переписуванню.
+//
+//   parked_cart_bench [кошиків] [каталог]
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "bench/bench_util.h"
+#include "bench/catalogue_fixture.h"
+#include "parking/parked_cart.h"
+#include "parking/parked_cart_store.h"
+
+using virok::ParkedCart;
+using virok::ParkedCartStore;
+using virok::ParkedCartStoreStats;
+using virok::ParkedLine;
+using virok::bench::Clock;
+using virok::bench::ElapsedUs;
+using virok::bench::FixtureItem;
+using virok::bench::FixtureRandom;
+using virok::bench::LatencyStats;
+
+namespace {
+
+const char* const kCashiers[] = {"olena@virok.ua", "petro@virok.ua",
+                                 "iryna@virok.ua", "taras@virok.ua"};
+
+ParkedCart MakeCart(const std::vector<FixtureItem>& catalogue,
+                    FixtureRandom& rnd, size_t n) {
+  ParkedCart cart;
+  cart.cashier = kCashiers[n % 4];
+  cart.payment_form = n % 3 ? "Готівка" : "Картка";
+  cart.parked_ms = 1704110400000LL + static_cast<int64_t>(n) * 60000;
+  const size_t lines = 1 + rnd.Below(40);
+  for (size_t i = 0; i < lines; i++) {
+    const FixtureItem& item = catalogue[rnd.Below(catalogue.size())];
+    ParkedLine line;
+    line.guid = item.guid;
+    line.name = item.name;
+    line.article = item.article;
+    line.category = item.parent_guid;
+    line.price = std::llround(item.price * 100);
+    if (i % 5 == 4) {
+      line.weight_g = 100 + rnd.Below(2000);
+    } else {
+      line.quantity = 1 + static_cast<int32_t>(rnd.Below(4));
+    }
+    cart.total += virok::ParkedLineTotal(line);
+    cart.lines.push_back(line);
+  }
+  return cart;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 60;
+  namespace fs = std::filesystem;
+  const fs::path dir = argc > 2
+                           ? fs::path(argv[2])
+                           : fs::temp_directory_path() / "virok_parked_bench";
+  std::error_code ec;
+  fs::remove_all(dir, ec);
+
+  const std::vector<FixtureItem> catalogue =
+      virok::bench::MakeCatalogue(20000, 5);
+  FixtureRandom rnd(46);
+  std::vector<ParkedCart> carts;
+  size_t lines = 0;
+  for (size_t n = 0; n < count; n++) {
+    carts.push_back(MakeCart(catalogue, rnd, n));
+    lines += carts.back().lines.size();
+  }
+
+  std::string error;
+  LatencyStats park;
+  {
+    ParkedCartStore store;
+    if (!store.Open(dir.u8string(), &error)) {
+      std::fprintf(stderr, "open: %s\n", error.c_str());
+      return 1;
+    }
+    for (ParkedCart& cart : carts) {
+      const auto start = Clock::now();
+      if (!store.Park(&cart, &error)) {
+        std::fprintf(stderr, "park: %s\n", error.c_str());
+        return 1;
+      }
+      park.Add(ElapsedUs(start));
+    }
+  }
+
+  LatencyStats open;
+  ParkedCartStore store;
+  for (int i = 0; i < 50; i++) {
+    const auto start = Clock::now();
+    if (!store.Open(dir.u8string(), &error)) {
+      std::fprintf(stderr, "reopen: %s\n", error.c_str());
+      return 1;
+    }
+    open.Add(ElapsedUs(start));
+  }
+  const ParkedCartStoreStats stats = store.stats();
+  std::printf("parked: %zu carts, %zu lines, %llu B on disk "
+              "(%.0f B/cart, %.0f B/line)\n",
+              stats.carts, lines,
+              static_cast<unsigned long long>(stats.bytes),
+              static_cast<double>(stats.bytes) / stats.carts,
+              static_cast<double>(stats.bytes) / lines);
+
+  LatencyStats list_one, list_all;
+  size_t listed = 0;
+  for (int i = 0; i < 10000; i++) {
+    auto start = Clock::now();
+    listed += store.List(kCashiers[i % 4]).size();
+    list_one.Add(ElapsedUs(start));
+    start = Clock::now();
+    listed += store.List("").size();
+    list_all.Add(ElapsedUs(start));
+  }
+
+  // Відновлення кожного кошика і повторне відкладення того самого.
+  LatencyStats take;
+  size_t restored = 0;
+  for (ParkedCart& cart : carts) {
+    ParkedCart got;
+    const auto start = Clock::now();
+    if (!store.Take(cart.id, &got, &error)) {
+      std::fprintf(stderr, "take: %s\n", error.c_str());
+      return 1;
+    }
+    take.Add(ElapsedUs(start));
+    restored += got.lines.size() == cart.lines.size() &&
+                got.total == cart.total;
+    if (!store.Park(&got, &error)) return 1;
+  }
+
+  LatencyStats churn;
+  for (int i = 0; i < 5000; i++) {
+    ParkedCart cart = carts[rnd.Below(carts.size())];
+    ParkedCart got;
+    const auto start = Clock::now();
+    if (!store.Park(&cart, &error) || !store.Take(cart.id, &got, &error)) {
+      std::fprintf(stderr, "churn: %s\n", error.c_str());
+      return 1;
+    }
+    churn.Add(ElapsedUs(start));
+  }
+  const ParkedCartStoreStats after = store.stats();
+
+  park.Print("park (fsync)");
+  open.Print("open (all carts)");
+  list_one.Print("list (one cashier)");
+  list_all.Print("list (all)");
+  take.Print("take (fsync)");
+  churn.Print("park + take (fsync x2)");
+  std::printf("restored intact: %zu/%zu; after churn: %zu carts, "
+              "%llu B on disk (%llu B dead)\n",
+              restored, carts.size(), after.carts,
+              static_cast<unsigned long long>(after.bytes),
+              static_cast<unsigned long long>(after.dead_bytes));
+  fs::remove_all(dir, ec);
+  return listed && restored == carts.size() ? 0 : 1;
+}
@@ -0,0 +1,216 @@
+// Акції на кожне сканування (native/promo): чек на |рядків| позицій проти
+// |правил| акцій, згенерованих як JSON з каталогу (відсотки на товари й
+// категорії, акційні ціни, комплекти, "2+1", три складні знижки на весь
+// чек, частина — з розкладом).
+//
+//   - scan: додавання нового рядка (інкрементальна переоцінка);
+//   - rescan: той самий товар ще раз (кількість +1);
+//   - remove: видалення рядка;
+//   - full: повна переоцінка всіх правил на кожне сканування (SetRules) —
+//     те, що довелося б робити без індексу, для порівняння.
+//
+//   promo_engine_bench [правил] [рядків] [чеків]
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bench/bench_util.h"
+#include "bench/catalogue_fixture.h"
+#include "promo/promo_engine.h"
+#include "promo/promo_rules.h"
+
+using virok::PromoCart;
+using virok::PromoLineDiscount;
+using virok::PromoRule;
+using virok::PromoRuleSet;
+using virok::PromoTime;
+using virok::bench::Clock;
+using virok::bench::ElapsedUs;
+using virok::bench::FixtureItem;
+using virok::bench::FixtureRandom;
+using virok::bench::LatencyStats;
+
+namespace {
+
+std::string QuotedList(const std::vector<std::string>& values) {
+  std::string out = "[";
+  for (size_t i = 0; i < values.size(); i++) {
+    if (i) out.push_back(',');
+    out += "\"" + values[i] + "\"";
+  }
+  return out + "]";
+}
+
+std::string MakeRulesJson(const std::vector<FixtureItem>& catalogue,
+                          const std::vector<std::string>& categories,
+                          size_t count) {
+  FixtureRandom rnd(5);
+  std::string json = "[";
+  char buf[256];
+  for (size_t i = 0; i < count; i++) {
+    if (i) json.push_back(',');
+    std::vector<std::string> items;
+    std::vector<std::string> cats;
+    std::string body;
+    const uint32_t scope = rnd.Below(100);
+    if (i < 3) {
+      // Кілька складних знижок на весь чек (картка покупця тощо).
+      std::snprintf(buf, sizeof(buf),
+                    "\"kind\":\"percent\",\"percent\":%u,\"stackable\":true",
+                    1 + rnd.Below(3));
+      body = buf;
+    } else if (scope < 30) {
+      cats.push_back(categories[rnd.Below(categories.size())]);
+      std::snprintf(buf, sizeof(buf),
+                    "\"kind\":\"percent\",\"percent\":%u,\"minQty\":%u",
+                    5 + rnd.Below(25), rnd.Below(3));
+      body = buf;
+    } else {
+      const uint32_t n = 2 + rnd.Below(30);
+      double cheapest = 0;
+      for (uint32_t k = 0; k < n; k++) {
+        const FixtureItem& item = catalogue[rnd.Below(catalogue.size())];
+        items.push_back(item.guid);
+        if (!k || item.price < cheapest) cheapest = item.price;
+      }
+      const uint32_t kind = rnd.Below(100);
+      if (kind < 45) {
+        std::snprintf(buf, sizeof(buf),
+                      "\"kind\":\"percent\",\"percent\":%u,\"minQty\":%u",
+                      5 + rnd.Below(25), rnd.Below(3));
+      } else if (kind < 70) {
+        std::snprintf(buf, sizeof(buf), "\"kind\":\"price\",\"price\":%.2f",
+                      cheapest * (70 + rnd.Below(25)) / 100);
+      } else if (kind < 85) {
+        const uint32_t qty = 2 + rnd.Below(3);
+        std::snprintf(buf, sizeof(buf),
+                      "\"kind\":\"bundle\",\"qty\":%u,\"price\":%.2f", qty,
+                      cheapest * qty * 0.8);
+      } else {
+        std::snprintf(buf, sizeof(buf),
+                      "\"kind\":\"gift\",\"qty\":2,\"free\":1");
+      }
+      body = buf;
+    }
+    std::snprintf(buf, sizeof(buf), "{\"id\":\"p%zu\",", i);
+    json += buf;
+    json += "\"items\":" + QuotedList(items) +
+            ",\"categories\":" + QuotedList(cats) + "," + body;
+    if (rnd.Below(10) == 0) {
+      json += ",\"days\":[1,2,3,4,5],\"from\":\"09:00\",\"to\":\"12:00\"";
+    }
+    json += "}";
+  }
+  return json + "]";
+}
+
+int64_t Kopecks(double price) {
+  return static_cast<int64_t>(price * 100 + 0.5);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t rule_count =
+      argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000;
+  const size_t lines = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 500;
+  const int carts = argc > 3 ? std::atoi(argv[3]) : 20;
+
+  const std::vector<FixtureItem> catalogue =
+      virok::bench::MakeCatalogue(20000, 3);
+  std::vector<std::string> categories;
+  for (const FixtureItem& item : catalogue) {
+    if (categories.size() < 200 &&
+        (categories.empty() || categories.back() != item.parent_guid)) {
+      categories.push_back(item.parent_guid);
+    }
+  }
+  // Рядки беруться з цієї вибірки, щоб частина правил на товари спрацьовувала.
+  FixtureRandom pick(17);
+
+  const std::string json = MakeRulesJson(catalogue, categories, rule_count);
+  auto start = Clock::now();
+  std::vector<PromoRule> rules;
+  std::string error;
+  if (!virok::ParsePromoRules(json, &rules, &error)) {
+    std::fprintf(stderr, "rules: %s\n", error.c_str());
+    return 1;
+  }
+  auto rule_set = std::make_shared<const PromoRuleSet>(std::move(rules));
+  std::printf("promo: %zu rules (%zu KB JSON) parsed+indexed in %.0fus, "
+              "%zu-line carts x %d\n",
+              rule_set->size(), json.size() / 1024, ElapsedUs(start), lines,
+              carts);
+
+  PromoTime morning;
+  morning.date = 20261019;
+  morning.weekday = 0;
+  morning.minute = 10 * 60;
+
+  LatencyStats scan, rescan, remove, full;
+  size_t evaluated = 0;
+  size_t scans = 0;
+  int64_t discount = 0;
+  int64_t amount = 0;
+  std::vector<PromoLineDiscount> changed;
+  for (int c = 0; c < carts; c++) {
+    PromoCart cart(rule_set);
+    cart.SetTime(morning, &changed);
+    std::vector<const FixtureItem*> in_cart;
+    std::unordered_map<const FixtureItem*, int64_t> units;
+    for (size_t i = 0; i < lines; i++) {
+      const FixtureItem& item = catalogue[pick.Below(catalogue.size())];
+      const int64_t price = Kopecks(item.price);
+      changed.clear();
+      start = Clock::now();
+      cart.SetLine(item.guid, item.parent_guid, price, 1000, &changed);
+      scan.Add(ElapsedUs(start));
+      evaluated += cart.last_evaluated();
+      scans++;
+      in_cart.push_back(&item);
+      units[&item] = 1;
+
+      if (i % 10 == 9) {
+        const FixtureItem& again = *in_cart[pick.Below(in_cart.size())];
+        changed.clear();
+        start = Clock::now();
+        cart.SetLine(again.guid, again.parent_guid,
+                     Kopecks(again.price), 2000,
+                     &changed);
+        rescan.Add(ElapsedUs(start));
+        units[&again] = 2;
+      }
+      if (c == 0 && i % 25 == 24) {
+        changed.clear();
+        start = Clock::now();
+        cart.SetRules(rule_set, &changed);
+        full.Add(ElapsedUs(start));
+      }
+    }
+    discount += cart.total_discount();
+    for (const auto& line : units) {
+      amount += Kopecks(line.first->price) * line.second;
+    }
+    for (int i = 0; i < 50; i++) {
+      const FixtureItem& gone = *in_cart[pick.Below(in_cart.size())];
+      changed.clear();
+      start = Clock::now();
+      cart.RemoveLine(gone.guid, &changed);
+      remove.Add(ElapsedUs(start));
+    }
+  }
+
+  scan.Print("scan (new line)");
+  rescan.Print("rescan (qty change)");
+  remove.Print("remove line");
+  full.Print("full re-evaluation");
+  std::printf("rules evaluated per scan: %.1f of %zu; discount %.1f%% of "
+              "%.0f UAH per cart\n",
+              static_cast<double>(evaluated) / scans, rule_set->size(),
+              100.0 * discount / amount, amount / 100.0 / carts);
+  return 0;
+}
@@ -0,0 +1,231 @@
+// Локальний архів чеків (native/archive): |чеків| продажів по 1-15 рядків
+// з каталогу, половина — карткою з RRN, кожен з текстовою візуалізацією.
+//
+//   - put: запис чека (кодування, стиснення, CRC, fflush);
+//   - open: повторне відкриття і побудова індексів з ключів записів;
+//   - пошук для повернення: за фіскальним номером (з візуалізацією),
+//     RRN, штрихкодом (20 останніх) і датою (чеки за день);
+//   - compact: 2/3 чеків перезаписано (оновлені візуалізації), далі
+//     стиснення сегментів і видалення старших за термін зберігання.
+//
+//   receipt_archive_bench [чеків] [каталог_архіву]
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "archive/archived_receipt.h"
+#include "archive/lz_block.h"
+#include "archive/receipt_archive.h"
+#include "bench/bench_util.h"
+#include "bench/catalogue_fixture.h"
+
+using virok::ArchivedLine;
+using virok::ArchivedReceipt;
+using virok::ReceiptArchive;
+using virok::ReceiptArchiveCompaction;
+using virok::ReceiptArchiveOptions;
+using virok::ReceiptArchiveStats;
+using virok::bench::Clock;
+using virok::bench::ElapsedUs;
+using virok::bench::FixtureItem;
+using virok::bench::FixtureRandom;
+using virok::bench::LatencyStats;
+
+namespace {
+
+constexpr int64_t kDayMs = 24 * 3600 * 1000LL;
+// 2024-01-01 12:00 UTC: чеки розкладені по днях від цієї дати.
+constexpr int64_t kStartMs = 1704110400000LL;
+constexpr size_t kReceiptsPerDay = 120;
+
+std::string FirstBarcode(const FixtureItem& item) {
+  return item.barcodes.substr(0, item.barcodes.find(','));
+}
+
+// Текст чека, схожий на візуалізацію ПРРО: 42 символи в рядку.
+std::string Visualize(const ArchivedReceipt& r) {
+  std::string text =
+      "            ТОВ \"ВІРОК\"\n"
+      "      м. Київ, вул. Хрещатик, 1\n"
+      "       ПН 123456789012\n"
+      "------------------------------------------\n";
+  char buf[512];
+  for (const ArchivedLine& line : r.lines) {
+    std::snprintf(buf, sizeof(buf), "%s\n%10.3f x %10.2f = %12.2f А\n",
+                  line.name.c_str(), line.qty_milli / 1000.0,
+                  line.price / 100.0,
+                  line.qty_milli / 1000.0 * line.price / 100.0);
+    text += buf;
+  }
+  std::snprintf(buf, sizeof(buf),
+                "------------------------------------------\n"
+                "СУМА                          %12.2f\n"
+                "ПДВ А 20.00%%                  %12.2f\n"
+                "ФН ПРРО 4000000001   ФН чека %s\n",
+                r.total / 100.0, r.total / 600.0, r.fiscal_number.c_str());
+  text += buf;
+  text += "          ФІСКАЛЬНИЙ ЧЕК\n             ВІРОК\n";
+  return text;
+}
+
+ArchivedReceipt MakeReceipt(const std::vector<FixtureItem>& catalogue,
+                            FixtureRandom& rnd, size_t n) {
+  ArchivedReceipt r;
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), "%zu", 100000000 + n);
+  r.fiscal_number = buf;
+  r.created_ms = kStartMs + static_cast<int64_t>(n / kReceiptsPerDay) * kDayMs +
+                 static_cast<int64_t>(n % kReceiptsPerDay) * 300000;
+  r.date = virok::LocalDate(r.created_ms);
+  r.doc_type = "sale";
+  r.cashier = "kasyr";
+  const size_t lines = 1 + rnd.Below(15);
+  for (size_t i = 0; i < lines; i++) {
+    const FixtureItem& item = catalogue[rnd.Below(catalogue.size())];
+    ArchivedLine& line = r.lines.emplace_back();
+    line.guid = item.guid;
+    line.code = item.article;
+    line.name = item.name;
+    line.barcodes.push_back(FirstBarcode(item));
+    line.qty_milli = 1000 * (1 + rnd.Below(3));
+    line.price = static_cast<int64_t>(item.price * 100 + 0.5);
+    r.total += line.price * line.qty_milli / 1000;
+  }
+  const bool card = rnd.Below(2) == 0;
+  if (card) {
+    std::snprintf(buf, sizeof(buf), "%012llu",
+                  static_cast<unsigned long long>(rnd.Next() % 1000000000000));
+    r.rrn = buf;
+  }
+  r.payments.push_back({card ? "Картка" : "Готівка", r.total});
+  r.visualization = Visualize(r);
+  return r;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+  namespace fs = std::filesystem;
+  const fs::path dir =
+      argc > 2 ? fs::path(argv[2])
+               : fs::temp_directory_path() / "virok_receipt_archive_bench";
+  std::error_code ec;
+  fs::remove_all(dir, ec);
+
+  const std::vector<FixtureItem> catalogue =
+      virok::bench::MakeCatalogue(20000, 3);
+  FixtureRandom rnd(21);
+  std::vector<ArchivedReceipt> receipts;
+  receipts.reserve(count);
+  uint64_t visualization_bytes = 0;
+  std::string packed;
+  for (size_t n = 0; n < count; n++) {
+    receipts.push_back(MakeReceipt(catalogue, rnd, n));
+    visualization_bytes += receipts.back().visualization.size();
+    virok::LzCompress(receipts.back().visualization, &packed);
+  }
+
+  ReceiptArchiveOptions options;
+  std::string error;
+  LatencyStats put;
+  {
+    ReceiptArchive archive(options);
+    if (!archive.Open(dir.u8string(), &error)) {
+      std::fprintf(stderr, "open: %s\n", error.c_str());
+      return 1;
+    }
+    for (const ArchivedReceipt& r : receipts) {
+      const auto start = Clock::now();
+      if (!archive.Put(r, &error)) {
+        std::fprintf(stderr, "put: %s\n", error.c_str());
+        return 1;
+      }
+      put.Add(ElapsedUs(start));
+    }
+  }
+
+  ReceiptArchive archive(options);
+  auto start = Clock::now();
+  if (!archive.Open(dir.u8string(), &error)) {
+    std::fprintf(stderr, "reopen: %s\n", error.c_str());
+    return 1;
+  }
+  const double open_ms = ElapsedUs(start) / 1000;
+  ReceiptArchiveStats stats = archive.stats();
+  std::printf("archive: %zu receipts in %zu segments, %.1f MB on disk "
+              "(%.0f B/receipt); visualizations %.1f -> %.1f MB; "
+              "reopen %.1f ms\n",
+              stats.receipts, stats.segments, stats.bytes / 1048576.0,
+              static_cast<double>(stats.bytes) / stats.receipts,
+              visualization_bytes / 1048576.0, packed.size() / 1048576.0,
+              open_ms);
+
+  LatencyStats by_fiscal, by_rrn, by_barcode, by_date;
+  size_t found = 0;
+  for (int i = 0; i < 2000; i++) {
+    const ArchivedReceipt& want = receipts[rnd.Below(receipts.size())];
+    ArchivedReceipt got;
+    start = Clock::now();
+    if (archive.ByFiscalNumber(want.fiscal_number, &got) &&
+        got.visualization == want.visualization) {
+      found++;
+    }
+    by_fiscal.Add(ElapsedUs(start));
+
+    if (!want.rrn.empty()) {
+      start = Clock::now();
+      found += archive.ByRrn(want.rrn, 20).size();
+      by_rrn.Add(ElapsedUs(start));
+    }
+    start = Clock::now();
+    found += archive.ByBarcode(want.lines[0].barcodes[0], 20).size();
+    by_barcode.Add(ElapsedUs(start));
+    if (i % 10 == 0) {
+      start = Clock::now();
+      found += archive.ByDate(want.date, want.date, 500).size();
+      by_date.Add(ElapsedUs(start));
+    }
+  }
+  put.Print("put");
+  by_fiscal.Print("by fiscal number (+visual.)");
+  by_rrn.Print("by RRN");
+  by_barcode.Print("by barcode (20 newest)");
+  by_date.Print("by date (one day)");
+  if (!found) return 1;
+
+  // 2/3 чеків перезаписано; потім сегменти з мертвими записами і старші
+  // за рік (retention = 365 днів від останнього дня).
+  for (size_t n = 0; n < count; n++) {
+    if (n % 3 == 0) continue;
+    receipts[n].visualization += "          КОПІЯ\n";
+    archive.Put(receipts[n], &error);
+  }
+  stats = archive.stats();
+  const double dead_mb = stats.dead_bytes / 1048576.0;
+  ReceiptArchiveCompaction compaction;
+  start = Clock::now();
+  archive.Compact(receipts.back().date, &compaction);
+  const double compact_ms = ElapsedUs(start) / 1000;
+  std::printf("compact: %.1f MB dead -> %zu segments rewritten in %.1f ms, "
+              "%.1f MB reclaimed\n",
+              dead_mb, compaction.rewritten_segments, compact_ms,
+              compaction.reclaimed_bytes / 1048576.0);
+
+  ReceiptArchive short_retention(
+      ReceiptArchiveOptions{options.segment_bytes, 365, 0.5});
+  short_retention.Open(dir.u8string(), &error);
+  start = Clock::now();
+  short_retention.Compact(receipts.back().date, &compaction);
+  std::printf("retention 365d: %zu segments expired in %.1f ms, "
+              "%zu receipts left\n",
+              compaction.expired_segments, ElapsedUs(start) / 1000,
+              short_retention.stats().receipts);
+
+  fs::remove_all(dir, ec);
+  return 0;
+}
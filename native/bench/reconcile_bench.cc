@@ -0,0 +1,344 @@
+// Звірка зміни перед Z-звітом (native/reconcile) на синтетичних змінах.
+//
+// Зміна з |чеків| продажів (кожен 40-й — повернення), 60% готівкою,
+// решта карткою з RRN, дві податкові групи. Джерела як на касі:
+//   - X-звіт: відповідь Vchasno, розбір DecodeReport;
+//   - kkm_checks: JSON PostgREST, розбір ParseServerChecks;
+//   - архів каси: ReceiptArchive на диску, чеки зміни через ByDate.
+// У серверну копію внесено відомі розбіжності (втрачені й подвоєні рядки,
+// інша сума, інша форма, рядок без фіскального номера), а в шухляді
+// бракує 50 копійок: звірка має знайти саме їх.
+//
+//   reconcile_bench [чеків] [каталог_архіву]
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "archive/archived_receipt.h"
+#include "archive/receipt_archive.h"
+#include "bench/bench_util.h"
+#include "reconcile/shift_reconciler.h"
+#include "report/report_decoder.h"
+
+using virok::ArchivedReceipt;
+using virok::CheckDiscrepancy;
+using virok::ReceiptArchive;
+using virok::ReconcileCheck;
+using virok::ReconcileReport;
+using virok::ReconcileSources;
+using virok::Report;
+using virok::bench::Clock;
+using virok::bench::ElapsedUs;
+using virok::bench::LatencyStats;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// 2026-10-18 08:00 UTC: відкриття зміни, чек щохвилини-дві.
+constexpr int64_t kShiftOpenedMs = 1792310400000LL;
+
+struct ShiftCheck {
+  std::string number;
+  std::string rrn;
+  bool card = false;
+  bool refund = false;
+  int64_t amount = 0;  // копійки
+  int64_t tax_a = 0;   // база групи А, решта — Б
+};
+
+std::string Uah(int64_t kopecks) {
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), "%s%lld.%02lld", kopecks < 0 ? "-" : "",
+                static_cast<long long>(std::llabs(kopecks) / 100),
+                static_cast<long long>(std::llabs(kopecks) % 100));
+  return buf;
+}
+
+std::vector<ShiftCheck> MakeShift(size_t count) {
+  std::vector<ShiftCheck> checks(count);
+  uint64_t seed = 0x9e3779b97f4a7c15ULL;
+  auto next = [&seed] {
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return seed;
+  };
+  for (size_t i = 0; i < count; i++) {
+    ShiftCheck& c = checks[i];
+    c.number = std::to_string(4000000000ULL + i);
+    c.card = next() % 10 >= 6;
+    c.refund = i % 40 == 39;
+    if (c.card) c.rrn = std::to_string(600000000000ULL + i * 7919);
+    c.amount = 500 + static_cast<int64_t>(next() % 250000);
+    c.tax_a = c.amount * static_cast<int64_t>(next() % 101) / 100;
+  }
+  return checks;
+}
+
+std::string MakeXReport(const std::vector<ShiftCheck>& checks,
+                        int64_t safe_start) {
+  int64_t cash_p = 0, cash_m = 0, card_p = 0, card_m = 0;
+  int64_t tax_a_p = 0, tax_a_m = 0, tax_b_p = 0, tax_b_m = 0;
+  int64_t count_p = 0, count_m = 0;
+  for (const ShiftCheck& c : checks) {
+    int64_t& form = c.card ? (c.refund ? card_m : card_p)
+                           : (c.refund ? cash_m : cash_p);
+    form += c.amount;
+    (c.refund ? tax_a_m : tax_a_p) += c.tax_a;
+    (c.refund ? tax_b_m : tax_b_p) += c.amount - c.tax_a;
+    ++(c.refund ? count_m : count_p);
+  }
+  const int64_t safe = safe_start + cash_p - cash_m;
+  char buf[1024];
+  std::string json;
+  json += R"({"ver":6,"source":"virok","device":"pos-1","res":0,)";
+  std::snprintf(
+      buf, sizeof(buf),
+      R"("info":{"task":10,"dt":"20261018200000","fisid":"4000123456",)"
+      R"("safe":%s,"safe_start_shift":%s,"receipt":{"count_p":%lld,)"
+      R"("count_m":%lld},"taxes":[)"
+      R"({"gr_code":1,"tax_lit":"А","tax_percent":20,"base_sum_p":%s,)"
+      R"("base_sum_m":%s},{"gr_code":2,"tax_lit":"Б","tax_percent":7,)"
+      R"("base_sum_p":%s,"base_sum_m":%s}],)"
+      R"("pays":[{"type":0,"name":"ГОТІВКА","sum_p":%s,"sum_m":%s},)"
+      R"({"type":2,"name":"КАРТКА","sum_p":%s,"sum_m":%s}]}})",
+      Uah(safe).c_str(), Uah(safe_start).c_str(),
+      static_cast<long long>(count_p), static_cast<long long>(count_m),
+      Uah(tax_a_p).c_str(), Uah(tax_a_m).c_str(), Uah(tax_b_p).c_str(),
+      Uah(tax_b_m).c_str(), Uah(cash_p).c_str(), Uah(cash_m).c_str(),
+      Uah(card_p).c_str(), Uah(card_m).c_str());
+  json += buf;
+  return json;
+}
+
+// Очікувані розбіжності серверної копії.
+struct Injected {
+  size_t missing = 0;    // рядок не дійшов до сервера
+  size_t duplicate = 0;  // рядок записано двічі
+  size_t amount = 0;
+  size_t form = 0;
+  size_t unnumbered = 0;  // без document_number, з'єднується за RRN
+};
+
+std::string MakeServerChecks(const std::vector<ShiftCheck>& checks,
+                             Injected* injected) {
+  std::string json = "[";
+  char buf[512];
+  auto row = [&](const ShiftCheck& c, const std::string& number,
+                 int64_t amount, bool card) {
+    if (json.size() > 1) json += ',';
+    std::snprintf(
+        buf, sizeof(buf),
+        R"({"id":%zu,"document_date":"2026-10-18T10:00:00",)"
+        R"("kkm_cash_register":"cashier@virok.ua","document_type":"%s",)"
+        R"("status":null,"kkm_check_number":"17923%s","document_number":%s,)"
+        R"("amount":%s,"payment_form":"%s","RRN":%s,)"
+        R"("taxes":{"А":%s,"Б":%s}})",
+        json.size(), c.refund ? "Повернення ККМ" : "Чек ККМ",
+        c.number.c_str(),
+        number.empty() ? "null" : ("\"" + number + "\"").c_str(),
+        Uah(amount).c_str(), card ? "Картка" : "Готівка",
+        c.rrn.empty() ? "null" : ("\"" + c.rrn + "\"").c_str(),
+        Uah(c.tax_a + amount - c.amount).c_str(),
+        Uah(c.amount - c.tax_a).c_str());
+    json += buf;
+  };
+  bool unnumbered = false;
+  for (size_t i = 0; i < checks.size(); i++) {
+    const ShiftCheck& c = checks[i];
+    if (i % 1000 == 0) unnumbered = true;
+    if (i % 701 == 100) {
+      injected->missing++;
+      continue;
+    }
+    if (i % 997 == 200) {
+      injected->amount++;
+      row(c, c.number, c.amount + 100, c.card);
+      continue;
+    }
+    if (i % 1499 == 300) {
+      injected->form++;
+      row(c, c.number, c.amount, !c.card);
+      continue;
+    }
+    if (c.card && unnumbered) {
+      unnumbered = false;
+      injected->unnumbered++;
+      row(c, "", c.amount, c.card);
+      continue;
+    }
+    row(c, c.number, c.amount, c.card);
+    if (i % 1777 == 500) {
+      injected->duplicate++;
+      row(c, c.number, c.amount, c.card);
+    }
+  }
+  // Відкладений чек: не фіскалізовано, звірка його пропускає.
+  json += R"(,{"status":"Чек відкладений","amount":99.5,)"
+          R"("payment_form":"Готівка"}])";
+  return json;
+}
+
+bool FillArchive(ReceiptArchive* archive,
+                 const std::vector<ShiftCheck>& checks) {
+  std::string error;
+  for (size_t i = 0; i < checks.size(); i++) {
+    const ShiftCheck& c = checks[i];
+    ArchivedReceipt r;
+    r.fiscal_number = c.number;
+    r.rrn = c.rrn;
+    r.created_ms = kShiftOpenedMs + static_cast<int64_t>(i) * 15000;
+    r.date = virok::LocalDate(r.created_ms);
+    r.doc_type = c.refund ? "return" : "sale";
+    r.cashier = "Іваненко Петро";
+    r.total = c.amount;
+    auto& line = r.lines.emplace_back();
+    line.code = "A" + std::to_string(i % 5000);
+    line.name = "Товар " + line.code;
+    line.qty_milli = 1000;
+    line.price = c.amount;
+    r.payments.push_back({c.card ? "КАРТКА" : "ГОТІВКА", c.amount});
+    if (!archive->Put(r, &error)) {
+      std::printf("archive put failed: %s\n", error.c_str());
+      return false;
+    }
+  }
+  return true;
+}
+
+void PrintReport(ReconcileReport& report, const Injected& injected,
+                 int64_t drawer_short) {
+  std::printf("  forms:\n");
+  for (const auto& f : report.forms) {
+    std::printf("    %-10s device %12s server %12s till %12s %s\n",
+                f.form.c_str(), Uah(f.device).c_str(), Uah(f.server).c_str(),
+                Uah(f.till).c_str(), f.matches() ? "ok" : "MISMATCH");
+  }
+  std::printf("  taxes:\n");
+  for (const auto& t : report.taxes) {
+    std::printf("    %-10s device %12s server %12s %s\n", t.group.c_str(),
+                Uah(t.device).c_str(), Uah(t.server).c_str(),
+                t.matches() ? "ok" : "MISMATCH");
+  }
+  std::printf("  checks: device %lld/%lld server %lld/%lld till %lld/%lld\n",
+              static_cast<long long>(report.device_sales),
+              static_cast<long long>(report.device_refunds),
+              static_cast<long long>(report.server_sales),
+              static_cast<long long>(report.server_refunds),
+              static_cast<long long>(report.till_sales),
+              static_cast<long long>(report.till_refunds));
+  std::printf("  drawer: expected %s counted %s\n",
+              Uah(report.cash_expected).c_str(),
+              Uah(report.cash_counted).c_str());
+
+  std::map<CheckDiscrepancy, size_t> found;
+  for (const auto& issue : report.checks) found[issue.kind]++;
+  auto line = [&](CheckDiscrepancy kind, size_t expected) {
+    std::printf("  %-18s expected %4zu found %4zu %s\n",
+                virok::CheckDiscrepancyName(kind), expected, found[kind],
+                expected == found[kind] ? "" : "<-- UNEXPECTED");
+  };
+  line(CheckDiscrepancy::kMissingOnServer, injected.missing);
+  line(CheckDiscrepancy::kMissingInArchive, 0);
+  line(CheckDiscrepancy::kAmountMismatch, injected.amount);
+  line(CheckDiscrepancy::kFormMismatch, injected.form);
+  // Чек без номера з'єднано за RRN: номер не порівнюється.
+  line(CheckDiscrepancy::kRrnMismatch, 0);
+  line(CheckDiscrepancy::kDuplicateNumber, injected.duplicate);
+  line(CheckDiscrepancy::kDuplicateRrn, 0);
+  std::printf("  unnumbered rows joined by RRN: %zu\n", injected.unnumbered);
+  std::printf("  drawer short %s, balanced: %s\n", Uah(drawer_short).c_str(),
+              report.balanced() ? "yes" : "no");
+}
+
+bool Run(size_t count, const fs::path& dir) {
+  std::error_code ec;
+  fs::remove_all(dir, ec);
+  const std::vector<ShiftCheck> checks = MakeShift(count);
+  const int64_t safe_start = 150000;
+  const std::string x_report = MakeXReport(checks, safe_start);
+  Injected injected;
+  const std::string server_json = MakeServerChecks(checks, &injected);
+
+  ReceiptArchive archive;
+  std::string error;
+  if (!archive.Open(dir.string(), &error)) {
+    std::printf("archive open failed: %s\n", error.c_str());
+    return false;
+  }
+  if (!FillArchive(&archive, checks)) return false;
+
+  Report device;
+  virok::DecodeReport(x_report, &device, nullptr);
+  const int64_t drawer_short = 50;
+  const int64_t drawer = std::llround(device.safe * 100) - drawer_short;
+  const int32_t from = virok::LocalDate(kShiftOpenedMs);
+  const int32_t to = virok::LocalDate(
+      kShiftOpenedMs + static_cast<int64_t>(count) * 15000);
+
+  ReconcileSources sources;
+  sources.device = [&](Report* report, std::string* err) {
+    return virok::DecodeReport(x_report, report, err);
+  };
+  sources.server = [&](std::vector<ReconcileCheck>* out, std::string* err) {
+    return virok::ParseServerChecks(server_json, out, err);
+  };
+  sources.till = [&](std::vector<ReconcileCheck>* out, std::string*) {
+    const auto receipts = archive.ByDate(from, to, SIZE_MAX);
+    out->reserve(receipts.size());
+    for (const ArchivedReceipt& r : receipts) {
+      if (r.created_ms >= kShiftOpenedMs) {
+        out->push_back(virok::CheckFromArchive(r));
+      }
+    }
+    return true;
+  };
+  sources.drawer_counted = drawer;
+
+  LatencyStats total;
+  LatencyStats load;
+  ReconcileReport report;
+  const int iterations = count > 20000 ? 5 : 30;
+  for (int i = 0; i < iterations; i++) {
+    const auto start = Clock::now();
+    if (!virok::ReconcileShift(sources, &report, &error)) {
+      std::printf("reconcile failed: %s\n", error.c_str());
+      return false;
+    }
+    total.Add(ElapsedUs(start));
+    load.Add(static_cast<double>(report.load_us));
+  }
+
+  char title[96];
+  std::printf("\nshift of %zu checks (kkm_checks %.1f KB, X-report %zu B)\n",
+              count, server_json.size() / 1024.0, x_report.size());
+  std::snprintf(title, sizeof(title), "reconcile %zu", count);
+  total.Print(title);
+  std::snprintf(title, sizeof(title), "  of which sources %zu", count);
+  load.Print(title);
+  PrintReport(report, injected, drawer_short);
+
+  archive.Close();
+  fs::remove_all(dir, ec);
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+  const fs::path dir =
+      argc > 2 ? fs::path(argv[2])
+               : fs::temp_directory_path() / "virok_reconcile_bench";
+
+  if (!Run(count, dir)) return 1;
+  if (argc <= 1 && !Run(count * 10, dir)) return 1;
+  return 0;
+}
@@ -0,0 +1,126 @@
+// Розбір X/Z-звітів DecodeReport на синтетичних відповідях пристрою.
+//
+// Найбільший Z-звіт — це зміна з тисячами позицій у візуалізації: саме
+// вона домінує в розмірі JSON (base64 тексту звіту), тож розміри задаються
+// кількістю рядків візуалізації.
+//
+//   report_decoder_bench [рядків_найбільшого_звіту]
+
+#include <cstdlib>
+#include <string>
+
+#include "bench/bench_util.h"
+#include "report/report_decoder.h"
+
+using virok::Report;
+using virok::bench::Clock;
+using virok::bench::ElapsedUs;
+using virok::bench::LatencyStats;
+
+namespace {
+
+std::string Base64Encode(const std::string& in) {
+  static const char kAlphabet[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string out;
+  out.reserve((in.size() + 2) / 3 * 4);
+  size_t i = 0;
+  for (; i + 2 < in.size(); i += 3) {
+    const uint32_t v = (static_cast<unsigned char>(in[i]) << 16) |
+                       (static_cast<unsigned char>(in[i + 1]) << 8) |
+                       static_cast<unsigned char>(in[i + 2]);
+    out.push_back(kAlphabet[(v >> 18) & 63]);
+    out.push_back(kAlphabet[(v >> 12) & 63]);
+    out.push_back(kAlphabet[(v >> 6) & 63]);
+    out.push_back(kAlphabet[v & 63]);
+  }
+  if (i < in.size()) {
+    uint32_t v = static_cast<unsigned char>(in[i]) << 16;
+    if (i + 1 < in.size()) v |= static_cast<unsigned char>(in[i + 1]) << 8;
+    out.push_back(kAlphabet[(v >> 18) & 63]);
+    out.push_back(kAlphabet[(v >> 12) & 63]);
+    out.push_back(i + 1 < in.size() ? kAlphabet[(v >> 6) & 63] : '=');
+    out.push_back('=');
+  }
+  return out;
+}
+
+// Відповідь Vchasno на Z-звіт (task 11) з |lines| рядками візуалізації.
+std::string MakeZReport(size_t lines) {
+  std::string text;
+  text.reserve(lines * 64);
+  char buf[256];
+  text += "ТОВ \"ВІРОК\"\nм. Київ, вул. Хрещатик, 1\nZ-ЗВІТ № 1234\n";
+  for (size_t i = 0; i < lines; i++) {
+    std::snprintf(buf, sizeof(buf),
+                  "%05zu Молоко пастеризоване 2,5%% 900г  %3zu x 42,50 = %.2f А\n",
+                  i, i % 17 + 1, (i % 17 + 1) * 42.5);
+    text += buf;
+  }
+  text += "СУМА ПРОДАЖУ                                   123456,78\n";
+
+  std::string json;
+  json.reserve(text.size() * 2);
+  json += R"({"ver":6,"source":"virok","device":"pos-1","tag":"","type":1,)";
+  json += R"("res":0,"errortxt":"","info":{"task":11,"dt":"20261018213000",)";
+  json += R"("fisid":"4000123456","cashier":"Іваненко Петро","safe":15420.5,)";
+  json += R"("safe_start_shift":1000,"isoffline":false,"shift_link":1234,)";
+  json += R"("shift_prev_link":1233,"vacant_off_nums":2000,)";
+  json += R"("receipt":{"last_docno_p":2811,"last_docno_m":12,"count_14":1,)";
+  json += R"("count_p":2000,"count_m":12},"summary":{"base_p":123456.78,)";
+  json += R"("base_m":1200.5,"taxex_p":0,"taxex_m":0,"disc_p":3400.1,)";
+  json += R"("disc_m":0,"calc_p":123456.78,"calc_m":1200.5},"taxes":[)";
+  for (int t = 0; t < 6; t++) {
+    std::snprintf(buf, sizeof(buf),
+                  R"(%s{"gr_code":%d,"base_sum_p":%d.25,"base_sum_m":10.5,)"
+                  R"("tax_name":"ПДВ","tax_fname":"ПДВ %d%%","tax_lit":"%c",)"
+                  R"("tax_percent":%d,"tax_sum_p":%d.04,"tax_sum_m":1.75})",
+                  t ? "," : "", t + 1, 20000 + t, t * 7, 'A' + t, t * 7,
+                  3000 + t);
+    json += buf;
+  }
+  json += R"(],"pays":[{"type":0,"name":"Готівка","sum_p":60000,"sum_m":100},)";
+  json += R"({"type":2,"name":"Картка","sum_p":63456.78,"sum_m":1100.5}],)";
+  json += R"("money":[{"type":0,"name":"Готівка","sum_p":60000,"sum_m":100}],)";
+  json += R"("cash":[{"type":0,"name":"Службова видача","sum_m":45000}]},)";
+  json += R"("warnings":[{"code":1,"wtxt":"Закінчується термін підписки"}],)";
+  json += R"("billing":{"paid_date_to":"2026-12-31","enough_to_renew_subscription":1},)";
+  json += R"("Visualization":")";
+  json += Base64Encode(text);
+  json += R"("})";
+  return json;
+}
+
+void Run(const char* label, const std::string& json, int iterations) {
+  LatencyStats stats;
+  Report report;
+  std::string error;
+  size_t checksum = 0;
+  for (int i = 0; i < iterations; i++) {
+    const auto start = Clock::now();
+    if (!virok::DecodeReport(json, &report, &error)) {
+      std::printf("%s: decode failed: %s\n", label, error.c_str());
+      return;
+    }
+    stats.Add(ElapsedUs(start));
+    checksum += report.print_data.size() + report.taxes.size();
+  }
+  char title[96];
+  std::snprintf(title, sizeof(title), "%s (%.1f KB)", label,
+                json.size() / 1024.0);
+  stats.Print(title);
+  std::printf("%-32s %.0f MB/s, print_data %zu bytes, checksum %zu\n", "",
+              json.size() / stats.Percentile(50), report.print_data.size(),
+              checksum);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t largest = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+
+  Run("X-report (40 lines)", MakeZReport(40), 2000);
+  Run("busy Z-report", MakeZReport(largest / 4), 200);
+  Run("largest Z-report", MakeZReport(largest), 50);
+  return 0;
+}
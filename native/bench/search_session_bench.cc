@@ -0,0 +1,141 @@
+// Затримка "натискання клавіші -> результати" для SearchSession.
+//
+// Імітує касира, що набирає запити посимвольно (з Backspace), і порівнює
+// інкрементальну сесію з повним проходом по каталогу на кожне натискання.
+//
+//   search_session_bench [кількість_товарів]
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bench/bench_util.h"
+#include "bench/catalogue_fixture.h"
+#include "search/search_session.h"
+
+using virok::SearchIndex;
+using virok::SearchPage;
+using virok::SearchSession;
+using virok::bench::Clock;
+using virok::bench::ElapsedUs;
+using virok::bench::LatencyStats;
+
+namespace {
+
+constexpr size_t kPageSize = 100;
+
+// Розбиває UTF-8 рядок на послідовність префіксів (по одному символу).
+std::vector<std::string> Keystrokes(const std::string& text) {
+  std::vector<std::string> out;
+  for (size_t i = 1; i <= text.size(); i++) {
+    if (i == text.size() || (static_cast<unsigned char>(text[i]) & 0xC0) != 0x80) {
+      out.push_back(text.substr(0, i));
+    }
+  }
+  return out;
+}
+
+// Сценарій: набір запиту, кілька Backspace, донабір іншого закінчення.
+std::vector<std::string> Script() {
+  const char* const kQueries[][2] = {
+      {"молоко галичина", "молоко яго"},
+      {"сир президент", "сир рош"},
+      {"кава", "кефір"},
+      {"4821", "48210"},
+      {"шоколад світоч", "шоколад рош"},
+      {"пиво оболонь 0.5л", "пиво льв"},
+      {"хліб київхліб житній", "хліб ки"},
+      {"вода моршинська 1.5л", "вода моршинська 0.5"},
+  };
+  std::vector<std::string> script;
+  for (const auto& q : kQueries) {
+    for (const auto& s : Keystrokes(q[0])) script.push_back(s);
+    // Backspace до спільного префікса, потім донабір.
+    std::vector<std::string> first = Keystrokes(q[0]);
+    std::vector<std::string> second = Keystrokes(q[1]);
+    size_t common = 0;
+    while (common < first.size() && common < second.size() &&
+           first[common] == second[common]) {
+      common++;
+    }
+    for (size_t i = first.size(); i-- > common;) {
+      script.push_back(i == 0 ? std::string() : first[i - 1]);
+    }
+    for (size_t i = common; i < second.size(); i++) script.push_back(second[i]);
+    script.push_back(std::string());
+  }
+  return script;
+}
+
+// Те, що реально йде в канал: ідентифікатори рядків сторінки.
+size_t Materialize(const SearchIndex& index, const SearchPage& page,
+                   std::vector<std::string>* ids) {
+  ids->clear();
+  for (uint32_t row : page.rows) ids->emplace_back(index.id(row));
+  return ids->size();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+
+  auto catalogue = virok::bench::MakeCatalogue(count);
+  std::vector<std::string> ids, keys;
+  ids.reserve(catalogue.size());
+  keys.reserve(catalogue.size());
+  for (const auto& item : catalogue) {
+    ids.push_back(item.guid);
+    keys.push_back(item.SearchKey());
+  }
+
+  const auto build_start = Clock::now();
+  auto index = std::make_shared<const SearchIndex>(ids, keys);
+  std::printf("catalogue: %zu items, index build %.1f ms\n", count,
+              ElapsedUs(build_start) / 1000.0);
+
+  const std::vector<std::string> script = Script();
+  std::vector<std::string> out;
+  size_t checksum = 0;
+
+  LatencyStats incremental;
+  LatencyStats scrolling;
+  SearchSession session(index);
+  for (int round = 0; round < 20; round++) {
+    for (const auto& query : script) {
+      const auto start = Clock::now();
+      SearchPage page = session.Update(query, kPageSize);
+      checksum += Materialize(*index, page, &out);
+      incremental.Add(ElapsedUs(start));
+    }
+    // Прокрутка результатів останнього короткого запиту.
+    session.Update("мол", kPageSize);
+    for (int i = 0; i < 10; i++) {
+      const auto start = Clock::now();
+      SearchPage page = session.More(kPageSize);
+      checksum += Materialize(*index, page, &out);
+      scrolling.Add(ElapsedUs(start));
+    }
+  }
+
+  // Базова лінія: нова сесія на кожне натискання (повний прохід каталогу).
+  LatencyStats full_scan;
+  for (int round = 0; round < 3; round++) {
+    for (const auto& query : script) {
+      const auto start = Clock::now();
+      SearchSession fresh(index);
+      SearchPage page = fresh.Update(query, kPageSize);
+      checksum += Materialize(*index, page, &out);
+      full_scan.Add(ElapsedUs(start));
+    }
+  }
+
+  std::printf("keystrokes per round: %zu, page size: %zu\n", script.size(),
+              kPageSize);
+  incremental.Print("incremental session");
+  scrolling.Print("next page (More)");
+  full_scan.Print("full scan per keystroke");
+  std::printf("checksum: %zu\n", checksum);
+  return 0;
+}
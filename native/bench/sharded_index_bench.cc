@@ -0,0 +1,220 @@
+// Шардований каталог (native/search/sharded_index) для оптових складів:
+// перебудова і затримка запиту на 100 тис., 1 млн і 5 млн товарів, щоб
+// підібрати залізо.
+//
+//   - перебудова: розкладання по шардах і пакування на 1..N потоках,
+//     за хешем id і за категоріями;
+//   - запит: перша сторінка (100 рядків) і повний підрахунок збігів —
+//     один SearchIndex одним потоком проти розсилки по шардах зі
+//     злиттям перших K.
+//
+// Товари генеруються пакетами catalogue_fixture (свої 200 категорій у
+// кожному) і лежать одним суцільним буфером, як рядки з бази; порядок
+// пакетів — порядок відображення.
+//
+//   sharded_index_bench [товарів ...]
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "bench/bench_util.h"
+#include "bench/catalogue_fixture.h"
+#include "search/search_index.h"
+#include "search/sharded_index.h"
+
+using virok::SearchIndex;
+using virok::SearchIndexView;
+using virok::ShardedHit;
+using virok::ShardedIndex;
+using virok::ShardedIndexOptions;
+using virok::ShardPartition;
+using virok::bench::Clock;
+using virok::bench::ElapsedUs;
+using virok::bench::LatencyStats;
+
+namespace {
+
+constexpr size_t kBatch = 100000;
+constexpr size_t kPageSize = 100;
+constexpr int kRepeats = 5;
+
+const char* const kQueries[] = {
+    "молоко",        "сир президент", "4821",   "шоколад світоч",
+    "пиво оболонь",  "кава",          "ваніль", "немає такого",
+};
+
+// Рядки каталогу одним буфером, як їх повернув би SELECT.
+struct Source {
+  std::string ids;
+  std::vector<uint32_t> id_offsets{0};
+  std::string keys;
+  std::vector<uint32_t> key_offsets{0};
+  std::vector<uint32_t> groups;
+  std::vector<std::string> group_names;
+
+  size_t size() const { return groups.size(); }
+  std::string_view id(size_t i) const {
+    return std::string_view(ids.data() + id_offsets[i],
+                            id_offsets[i + 1] - id_offsets[i]);
+  }
+  std::string_view key(size_t i) const {
+    return std::string_view(keys.data() + key_offsets[i],
+                            key_offsets[i + 1] - key_offsets[i]);
+  }
+};
+
+void Generate(size_t count, Source* source) {
+  std::unordered_map<std::string, uint32_t> group_index;
+  for (size_t done = 0; done < count; done += kBatch) {
+    const size_t batch = std::min(kBatch, count - done);
+    for (virok::bench::FixtureItem& item :
+         virok::bench::MakeCatalogue(batch, 42 + done / kBatch)) {
+      source->ids.append(item.guid);
+      source->id_offsets.push_back(
+          static_cast<uint32_t>(source->ids.size()));
+      source->keys.append(item.SearchKey());
+      source->key_offsets.push_back(
+          static_cast<uint32_t>(source->keys.size()));
+      auto it = group_index.find(item.parent_guid);
+      if (it == group_index.end()) {
+        it = group_index
+                 .emplace(item.parent_guid,
+                          static_cast<uint32_t>(source->group_names.size()))
+                 .first;
+        source->group_names.push_back(item.parent_guid);
+      }
+      source->groups.push_back(it->second);
+    }
+  }
+}
+
+std::unique_ptr<ShardedIndex> Build(const Source& source,
+                                    const ShardedIndexOptions& options,
+                                    double* build_ms) {
+  const auto start = Clock::now();
+  ShardedIndex::Builder builder(options);
+  builder.Reserve(source.size(), source.ids.size(), source.keys.size());
+  for (size_t i = 0; i < source.size(); i++) {
+    builder.Add(source.id(i), source.key(i),
+                source.group_names[source.groups[i]]);
+  }
+  std::unique_ptr<ShardedIndex> index = builder.Finish();
+  *build_ms = ElapsedUs(start) / 1000;
+  return index;
+}
+
+// Перші |limit| збігів одного індексу (як SearchSession на першій
+// сторінці); |total| — пройти до кінця.
+size_t SingleSearch(const SearchIndex& index, const std::string& query,
+                    size_t limit, bool total) {
+  const SearchIndex::Finder finder(index, query);
+  size_t found = 0;
+  for (uint32_t row = finder.Next(0); row < index.size();
+       row = finder.Next(row + 1)) {
+    found++;
+    if (!total && found == limit) break;
+  }
+  return found;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::vector<size_t> sizes;
+  for (int i = 1; i < argc; i++) {
+    sizes.push_back(std::strtoul(argv[i], nullptr, 10));
+  }
+  if (sizes.empty()) sizes = {100000, 1000000, 5000000};
+  const int cores = static_cast<int>(std::thread::hardware_concurrency());
+  std::vector<int> thread_counts{1, 2, 4};
+  if (cores > 4) thread_counts.push_back(cores);
+  std::printf("cores: %d\n", cores);
+
+  for (size_t count : sizes) {
+    Source source;
+    const auto generate_start = Clock::now();
+    Generate(count, &source);
+    std::printf("\n== %zu items, %zu categories, keys %.1f MB "
+                "(generated in %.1f s)\n",
+                count, source.group_names.size(), source.keys.size() / 1e6,
+                ElapsedUs(generate_start) / 1e6);
+
+    // Один індекс поверх буфера — та сама видача, один потік.
+    SearchIndexView view;
+    view.count = static_cast<uint32_t>(source.size());
+    view.ids = source.ids.data();
+    view.id_offsets = source.id_offsets.data();
+    view.keys = source.keys.data();
+    view.key_offsets = source.key_offsets.data();
+    const SearchIndex single(view, nullptr);
+    LatencyStats single_page, single_count;
+    for (int r = 0; r < kRepeats; r++) {
+      for (const char* query : kQueries) {
+        auto start = Clock::now();
+        SingleSearch(single, query, kPageSize, false);
+        single_page.Add(ElapsedUs(start));
+        start = Clock::now();
+        SingleSearch(single, query, kPageSize, true);
+        single_count.Add(ElapsedUs(start));
+      }
+    }
+    single_page.Print("single index, first page");
+    single_count.Print("single index, count all");
+
+    for (ShardPartition partition :
+         {ShardPartition::kHash, ShardPartition::kCategory}) {
+      for (int threads : thread_counts) {
+        ShardedIndexOptions options;
+        options.threads = threads;
+        options.partition = partition;
+        double build_ms = 0;
+        const std::unique_ptr<ShardedIndex> index =
+            Build(source, options, &build_ms);
+
+        uint32_t largest = 0;
+        for (int s = 0; s < index->shards(); s++) {
+          largest = std::max(largest, index->shard_size(s));
+        }
+        LatencyStats page, total;
+        size_t mismatched = 0;
+        for (int r = 0; r < kRepeats; r++) {
+          for (const char* query : kQueries) {
+            auto start = Clock::now();
+            const std::vector<ShardedHit> hits =
+                index->Search(query, kPageSize);
+            page.Add(ElapsedUs(start));
+            start = Clock::now();
+            size_t matches = 0;
+            index->Search(query, kPageSize, &matches);
+            total.Add(ElapsedUs(start));
+            if (r == 0) {
+              mismatched +=
+                  hits.size() != SingleSearch(single, query, kPageSize,
+                                              false) ||
+                  matches != SingleSearch(single, query, kPageSize, true);
+            }
+          }
+        }
+        std::printf("%s, %d threads: rebuild %.0f ms, %d shards "
+                    "(largest %.0f%% of even), %.1f MB, "
+                    "mismatched queries %zu\n",
+                    partition == ShardPartition::kHash ? "hash" : "category",
+                    threads, build_ms, index->shards(),
+                    100.0 * largest * index->shards() / count,
+                    index->bytes() / 1e6, mismatched);
+        page.Print("  sharded, first page");
+        total.Print("  sharded, count all");
+        if (mismatched) return 1;
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,332 @@
+// Каталог кількох кас на одній машині (native/catalogue): кожна каса —
+// окремий процес (fork), як раннери з G_APPLICATION_NON_UNIQUE.
+//
+//   - private: кожна каса будує власний SearchIndex з GUID і ключів (так
+//     працює loadIndex каналу com.virok/search);
+//   - shared: видавець публікує генерацію у спільну пам'ять і закриває її,
+//     каси відображають генерацію і будують індекс без копіювання.
+//
+// Пам'ять — приріст Rss/Pss/Private з /proc/self/smaps_rollup у процесі
+// каси після проходу по всіх ключах і GUID, поки відкриті всі каси
+// (Pss ділить спільні сторінки між тими, хто їх відображає). Далі
+// видавець публікує нову версію, а каси, що опитують Current()
+// щомілісекунди, переходять на неї: затримка до переходу і ціна
+// відображення (CRC + індекс).
+//
+//   shared_catalogue_bench [товарів]
+
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "bench/bench_util.h"
+#include "bench/catalogue_fixture.h"
+#include "catalogue/shared_catalogue.h"
+#include "ipc/shared_memory.h"
+#include "search/search_index.h"
+
+using virok::CatalogueGeneration;
+using virok::SearchIndex;
+using virok::SharedCatalogue;
+using virok::SharedMemory;
+using virok::bench::Clock;
+using virok::bench::ElapsedUs;
+using virok::bench::LatencyStats;
+
+namespace {
+
+struct Memory {
+  int64_t rss_kb = 0;
+  int64_t pss_kb = 0;
+  int64_t private_kb = 0;
+};
+
+// Повідомлення каси батьківському процесу (запис у pipe до PIPE_BUF
+// атомарний, тож каси пишуть в один канал).
+struct LaneReport {
+  enum Kind : int32_t { kMemory, kSwap } kind;
+  int32_t lane;
+  Memory memory;
+  int64_t seen_ns;  // steady_clock, спільний для процесів на Linux
+  double remap_us;
+};
+
+// smaps_rollup (Linux 4.14+) або сума по smaps — формат рядків той самий.
+Memory ReadMemory() {
+  FILE* f = std::fopen("/proc/self/smaps_rollup", "r");
+  if (f == nullptr) f = std::fopen("/proc/self/smaps", "r");
+  Memory m;
+  if (f == nullptr) return m;
+  char line[256];
+  long long kb;
+  while (std::fgets(line, sizeof(line), f)) {
+    if (std::sscanf(line, "Rss: %lld kB", &kb) == 1) {
+      m.rss_kb += kb;
+    } else if (std::sscanf(line, "Pss: %lld kB", &kb) == 1) {
+      m.pss_kb += kb;
+    } else if (std::sscanf(line, "Private_Clean: %lld kB", &kb) == 1 ||
+               std::sscanf(line, "Private_Dirty: %lld kB", &kb) == 1) {
+      m.private_kb += kb;
+    }
+  }
+  std::fclose(f);
+  return m;
+}
+
+// Прохід пошуку по всіх ключах і всіх GUID: сторінки каталогу реально
+// потрапляють у пам'ять каси.
+size_t Touch(const SearchIndex& index) {
+  SearchIndex::Finder finder(index, "~~немає~~");
+  size_t checksum = finder.Next(0);
+  for (uint32_t row = 0; row < index.size(); row++) {
+    checksum += index.id(row).size();
+  }
+  return checksum;
+}
+
+int64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             Clock::now().time_since_epoch())
+      .count();
+}
+
+void WriteAll(int fd, const void* data, size_t size) {
+  if (write(fd, data, size) != static_cast<ssize_t>(size)) std::_Exit(2);
+}
+
+void ReadAll(int fd, void* data, size_t size) {
+  if (read(fd, data, size) != static_cast<ssize_t>(size)) std::_Exit(3);
+}
+
+// Стовпці, які каса отримує каналом loadIndex.
+void BuildColumns(size_t count, std::vector<std::string>* ids,
+                  std::vector<std::string>* keys) {
+  const auto catalogue = virok::bench::MakeCatalogue(count);
+  ids->reserve(catalogue.size());
+  keys->reserve(catalogue.size());
+  for (const auto& item : catalogue) {
+    ids->push_back(item.guid);
+    keys->push_back(item.SearchKey());
+  }
+}
+
+// Повертає звільнену купу системі, щоб у прирості лишилося тільки те,
+// що каса тримає.
+void ReleaseHeap() {
+#ifdef __GLIBC__
+  malloc_trim(0);
+#endif
+}
+
+// Бар'єри: каса пише байт у ready і чекає байта з go[фаза]. Окремий
+// канал на фазу, щоб швидка каса не забрала байт сусідньої.
+constexpr int kPhases = 3;
+
+struct Pipes {
+  int ready[2];
+  int go[kPhases][2];
+  int reports[2];
+};
+
+void Barrier(const Pipes& pipes, int phase) {
+  char byte = 1;
+  WriteAll(pipes.ready[1], &byte, 1);
+  ReadAll(pipes.go[phase][0], &byte, 1);
+}
+
+void Release(const Pipes& pipes, int phase, int lanes, bool wait_ready) {
+  char byte;
+  if (wait_ready) {
+    for (int lane = 0; lane < lanes; lane++) {
+      ReadAll(pipes.ready[0], &byte, 1);
+    }
+  }
+  const std::string go(lanes, '\1');
+  WriteAll(pipes.go[phase][1], go.data(), go.size());
+}
+
+// Каса: 0 — усі каси запущені (базовий вимір), 1 — усі тримають каталог
+// (вимір), 2 — усі виміряли (далі перехід на нову генерацію).
+[[noreturn]] void Lane(int lane, bool shared, const std::string& name,
+                       size_t count, const Pipes& pipes) {
+  Barrier(pipes, 0);
+  const Memory before = ReadMemory();
+
+  SharedCatalogue catalogue(name);
+  std::shared_ptr<const CatalogueGeneration> generation;
+  std::shared_ptr<const SearchIndex> index;
+  if (shared) {
+    std::string error;
+    if (!catalogue.Open(&error)) std::_Exit(4);
+    generation = catalogue.Current();
+    if (!generation) std::_Exit(5);
+    index = std::make_shared<const SearchIndex>(generation->search_view(),
+                                                generation);
+  } else {
+    std::vector<std::string> ids, keys;
+    BuildColumns(count, &ids, &keys);
+    index = std::make_shared<const SearchIndex>(ids, keys);
+  }
+  ReleaseHeap();
+  volatile size_t checksum = Touch(*index);
+
+  Barrier(pipes, 1);
+  const Memory after = ReadMemory();
+  LaneReport report = {};
+  report.kind = LaneReport::kMemory;
+  report.lane = lane;
+  report.memory.rss_kb = after.rss_kb - before.rss_kb;
+  report.memory.pss_kb = after.pss_kb - before.pss_kb;
+  report.memory.private_kb = after.private_kb - before.private_kb;
+  WriteAll(pipes.reports[1], &report, sizeof(report));
+  char byte;
+  ReadAll(pipes.go[2][0], &byte, 1);
+
+  if (shared) {
+    // Як раннер: Current() перед запитом пошуку, тут — щомілісекунди.
+    // Виклик, що побачив новий номер, відображає генерацію і перевіряє
+    // CRC; до нього додається побудова індексу.
+    const uint64_t old_generation = generation->generation();
+    report.kind = LaneReport::kSwap;
+    for (;;) {
+      const auto start = Clock::now();
+      std::shared_ptr<const CatalogueGeneration> next = catalogue.Current();
+      if (next && next->generation() != old_generation) {
+        report.seen_ns = NowNs();
+        generation = std::move(next);
+        index = std::make_shared<const SearchIndex>(
+            generation->search_view(), generation);
+        checksum = Touch(*index);
+        report.remap_us = ElapsedUs(start);
+        break;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    WriteAll(pipes.reports[1], &report, sizeof(report));
+  }
+  (void)checksum;
+  std::_Exit(0);
+}
+
+// Публікує версію |version| і одразу закриває видавця: каси не ділять
+// сторінки генерації з ним, як з окремим демоном.
+// |*start_ns| — початок самої публікації, після підготовки стовпців.
+bool Publish(const std::string& name, size_t count, uint64_t version,
+             uint64_t* generation, size_t* bytes, int64_t* start_ns) {
+  std::vector<std::string> ids, keys;
+  BuildColumns(count, &ids, &keys);
+  *start_ns = NowNs();
+  SharedCatalogue publisher(name);
+  std::string error;
+  bool published = false;
+  if (!publisher.Open(&error) ||
+      !publisher.Publish(ids, keys, version, &published, &error) ||
+      !published) {
+    std::fprintf(stderr, "publish failed: %s\n", error.c_str());
+    return false;
+  }
+  *generation = publisher.Current()->generation();
+  *bytes = publisher.Current()->bytes();
+  return true;
+}
+
+double Mb(int64_t kb) { return kb / 1024.0; }
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+  const std::string name =
+      "virok-catalogue-bench-" + std::to_string(getpid());
+
+  uint64_t version = 1;
+  uint64_t generation = 0;
+  size_t bytes = 0;
+  int64_t start_ns = 0;
+  if (!Publish(name, count, version, &generation, &bytes, &start_ns)) {
+    return 1;
+  }
+  std::printf("catalogue: %zu items, generation %.1f MB, publish %.1f ms\n",
+              count, bytes / 1048576.0, (NowNs() - start_ns) / 1e6);
+  // Каси не успадковують сторінок фікстури від батьківського процесу.
+  ReleaseHeap();
+
+  std::printf("%-6s %-8s %12s %12s %12s\n", "lanes", "mode", "rss/lane",
+              "pss/lane", "private/lane");
+  LatencyStats visible;
+  LatencyStats remap;
+  for (int lanes : {1, 4, 8}) {
+    for (bool shared : {false, true}) {
+      Pipes pipes;
+      bool ok = pipe(pipes.ready) == 0 && pipe(pipes.reports) == 0;
+      for (int phase = 0; phase < kPhases; phase++) {
+        ok = ok && pipe(pipes.go[phase]) == 0;
+      }
+      if (!ok) {
+        std::perror("pipe");
+        return 1;
+      }
+      std::vector<pid_t> children;
+      for (int lane = 0; lane < lanes; lane++) {
+        const pid_t pid = fork();
+        if (pid == 0) Lane(lane, shared, name, count, pipes);
+        children.push_back(pid);
+      }
+      Release(pipes, 0, lanes, true);
+      Release(pipes, 1, lanes, true);
+
+      Memory total;
+      for (int lane = 0; lane < lanes; lane++) {
+        LaneReport report;
+        ReadAll(pipes.reports[0], &report, sizeof(report));
+        total.rss_kb += report.memory.rss_kb;
+        total.pss_kb += report.memory.pss_kb;
+        total.private_kb += report.memory.private_kb;
+      }
+      std::printf("%-6d %-8s %9.1f MB %9.1f MB %9.1f MB\n", lanes,
+                  shared ? "shared" : "private", Mb(total.rss_kb / lanes),
+                  Mb(total.pss_kb / lanes), Mb(total.private_kb / lanes));
+      Release(pipes, 2, lanes, false);
+
+      if (shared) {
+        if (!Publish(name, count, ++version, &generation, &bytes,
+                     &start_ns)) {
+          return 1;
+        }
+        ReleaseHeap();
+        for (int lane = 0; lane < lanes; lane++) {
+          LaneReport report;
+          ReadAll(pipes.reports[0], &report, sizeof(report));
+          visible.Add((report.seen_ns - start_ns) / 1000.0);
+          remap.Add(report.remap_us);
+        }
+      }
+      for (pid_t pid : children) waitpid(pid, nullptr, 0);
+      for (int* p : {pipes.ready, pipes.reports, pipes.go[0], pipes.go[1],
+                     pipes.go[2]}) {
+        close(p[0]);
+        close(p[1]);
+      }
+    }
+  }
+
+  // Від початку публікації; каси ділять з видавцем ті самі ядра.
+  visible.Print("lane sees new generation");
+  remap.Print("lane remap + CRC + index");
+
+  SharedMemory::Unlink(name + "-g" + std::to_string(generation));
+  SharedMemory::Unlink(name);
+  return 0;
+}
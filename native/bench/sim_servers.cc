@@ -0,0 +1,322 @@
+#include "bench/sim_servers.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace virok {
+namespace bench {
+
+namespace {
+
+// DLE EOT 1 — запит статусу принтера; 0x16 — "онлайн, без помилок".
+constexpr char kStatusRequest[] = {0x10, 0x04, 0x01};
+constexpr char kStatusOnline = 0x16;
+
+bool WriteAll(int fd, std::string_view data) {
+  while (!data.empty()) {
+    const ssize_t n = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+    if (n <= 0) return false;
+    data.remove_prefix(static_cast<size_t>(n));
+  }
+  return true;
+}
+
+int ConnectLocal(uint16_t port) {
+  const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return -1;
+  // Ані бекенд, ані принтер не мають права підвісити касу назавжди.
+  timeval timeout{10, 0};
+  ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  const int one = 1;
+  ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+    ::close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+// Запит і відповідь до закриття з'єднання; |status| — HTTP-код (0, якщо
+// з'єднання впало), у |response| лишається тіло.
+bool HttpExchange(uint16_t port, std::string_view request, int* status,
+                  std::string* response) {
+  *status = 0;
+  response->clear();
+  const int fd = ConnectLocal(port);
+  if (fd < 0) return false;
+
+  if (WriteAll(fd, request)) {
+    char buf[65536];
+    for (;;) {
+      const ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+      if (n <= 0) break;
+      response->append(buf, static_cast<size_t>(n));
+    }
+  }
+  ::close(fd);
+
+  // "HTTP/1.1 201 Created" — код після першого пробілу.
+  const size_t space = response->find(' ');
+  if (space == std::string::npos) return false;
+  *status = std::atoi(response->c_str() + space + 1);
+  const size_t header_end = response->find("\r\n\r\n");
+  response->erase(0, header_end == std::string::npos ? response->size()
+                                                     : header_end + 4);
+  return *status >= 200 && *status < 300;
+}
+
+}  // namespace
+
+LocalServer::LocalServer(const SimulationProfile& profile, uint64_t seed)
+    : dice_(profile, seed) {}
+
+LocalServer::~LocalServer() { Stop(); }
+
+bool LocalServer::Start() {
+  listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (listen_fd_ < 0) return false;
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t len = sizeof(addr);
+  if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), len) != 0 ||
+      ::listen(listen_fd_, 128) != 0 ||
+      ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len) !=
+          0) {
+    ::close(listen_fd_);
+    listen_fd_ = -1;
+    return false;
+  }
+  port_ = ntohs(addr.sin_port);
+  accept_thread_ = std::thread([this] { AcceptLoop(); });
+  return true;
+}
+
+void LocalServer::Stop() {
+  if (listen_fd_ < 0) return;
+  ::shutdown(listen_fd_, SHUT_RDWR);
+  ::close(listen_fd_);
+  listen_fd_ = -1;
+  accept_thread_.join();
+  for (auto& connection : connections_) connection.join();
+  connections_.clear();
+}
+
+bool LocalServer::NextRequest(std::chrono::microseconds* latency) {
+  std::lock_guard<std::mutex> lock(dice_mutex_);
+  *latency = dice_.NextLatency();
+  return !dice_.NextFailure();
+}
+
+void LocalServer::AcceptLoop() {
+  for (;;) {
+    const int fd = ::accept(listen_fd_, nullptr, nullptr);
+    if (fd < 0) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    connections_.emplace_back([this, fd] {
+      Serve(fd);
+      ::close(fd);
+    });
+  }
+}
+
+void EscPosSink::Serve(int fd) {
+  char buf[4096];
+  char tail[3] = {0, 0, 0};
+  uint64_t received = 0;
+  for (;;) {
+    const ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+    if (n <= 0) return;
+    received += static_cast<uint64_t>(n);
+    // Запит статусу може розірватися між двома recv.
+    for (ssize_t i = 0; i < n; i++) {
+      tail[0] = tail[1];
+      tail[1] = tail[2];
+      tail[2] = buf[i];
+    }
+    if (std::memcmp(tail, kStatusRequest, sizeof(tail)) != 0) continue;
+
+    std::chrono::microseconds latency;
+    const bool ok = NextRequest(&latency);
+    std::this_thread::sleep_for(latency);
+    if (!ok) return;  // принтер "завис": відповіді не буде
+    documents_++;
+    bytes_ += received - sizeof(kStatusRequest);
+    WriteAll(fd, std::string_view(&kStatusOnline, 1));
+    return;
+  }
+}
+
+Clock::time_point LabelPrinterSink::first_label() const {
+  return Clock::time_point(Clock::duration(first_label_.load()));
+}
+
+Clock::time_point LabelPrinterSink::last_label() const {
+  return Clock::time_point(Clock::duration(last_label_.load()));
+}
+
+void LabelPrinterSink::Reset() {
+  labels_ = 0;
+  bytes_ = 0;
+  first_label_ = 0;
+  last_label_ = 0;
+}
+
+void LabelPrinterSink::Serve(int fd) {
+  // GS V B — відрізка; за нею байт прогону.
+  constexpr char kCut[] = {0x1D, 0x56, 0x42};
+  char buf[4096];
+  char tail[3] = {0, 0, 0};
+  for (;;) {
+    const ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+    if (n <= 0) return;
+    bytes_ += static_cast<uint64_t>(n);
+    for (ssize_t i = 0; i < n; i++) {
+      tail[0] = tail[1];
+      tail[1] = tail[2];
+      tail[2] = buf[i];
+      if (std::memcmp(tail, kCut, sizeof(tail)) != 0) continue;
+      std::chrono::microseconds latency;
+      NextRequest(&latency);
+      std::this_thread::sleep_for(latency);
+      const Clock::rep now = Clock::now().time_since_epoch().count();
+      Clock::rep none = 0;
+      first_label_.compare_exchange_strong(none, now);
+      last_label_ = now;
+      labels_++;
+    }
+  }
+}
+
+void RestBackend::Serve(int fd) {
+  std::string request;
+  char buf[4096];
+  size_t header_end = std::string::npos;
+  size_t content_length = 0;
+  for (;;) {
+    if (header_end == std::string::npos) {
+      header_end = request.find("\r\n\r\n");
+      if (header_end != std::string::npos) {
+        const size_t pos = request.find("Content-Length:");
+        if (pos != std::string::npos && pos < header_end) {
+          content_length = std::strtoul(request.c_str() + pos + 15, nullptr, 10);
+        }
+      }
+    }
+    if (header_end != std::string::npos &&
+        request.size() >= header_end + 4 + content_length) {
+      break;
+    }
+    const ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+    if (n <= 0) return;
+    request.append(buf, static_cast<size_t>(n));
+  }
+
+  std::chrono::microseconds latency;
+  const bool ok = NextRequest(&latency);
+  std::this_thread::sleep_for(latency);
+  requests_++;
+  if (!ok) {
+    WriteAll(fd,
+             "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\n"
+             "Connection: close\r\n\r\n");
+    return;
+  }
+  char body[64];
+  const int body_len = std::snprintf(body, sizeof(body), "[{\"id\":%lld}]",
+                                     static_cast<long long>(next_id_++));
+  char response[256];
+  const int len = std::snprintf(
+      response, sizeof(response),
+      "HTTP/1.1 201 Created\r\nContent-Type: application/json\r\n"
+      "Content-Length: %d\r\nConnection: close\r\n\r\n%s",
+      body_len, body);
+  WriteAll(fd, std::string_view(response, static_cast<size_t>(len)));
+}
+
+void StaticFileServer::Put(std::string path, std::string body) {
+  files_[std::move(path)] = std::move(body);
+}
+
+void StaticFileServer::Serve(int fd) {
+  std::string request;
+  char buf[4096];
+  while (request.find("\r\n\r\n") == std::string::npos) {
+    const ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+    if (n <= 0) return;
+    request.append(buf, static_cast<size_t>(n));
+  }
+
+  std::chrono::microseconds latency;
+  const bool ok = NextRequest(&latency);
+  std::this_thread::sleep_for(latency);
+  requests_++;
+  // "GET /path HTTP/1.1"
+  auto it = files_.end();
+  const size_t end = request.find(' ', 4);
+  if (request.compare(0, 4, "GET ") == 0 && end != std::string::npos) {
+    it = files_.find(request.substr(4, end - 4));
+  }
+  if (!ok || it == files_.end()) {
+    WriteAll(fd, ok ? "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n"
+                      "Connection: close\r\n\r\n"
+                    : "HTTP/1.1 503 Service Unavailable\r\n"
+                      "Content-Length: 0\r\nConnection: close\r\n\r\n");
+    return;
+  }
+  const std::string header =
+      "HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\n"
+      "Content-Length: " +
+      std::to_string(it->second.size()) + "\r\nConnection: close\r\n\r\n";
+  if (WriteAll(fd, header)) WriteAll(fd, it->second);
+}
+
+bool PrintToSink(uint16_t port, std::string_view document) {
+  const int fd = ConnectLocal(port);
+  if (fd < 0) return false;
+  char status = 0;
+  const bool ok = WriteAll(fd, document) &&
+                  WriteAll(fd, std::string_view(kStatusRequest,
+                                                sizeof(kStatusRequest))) &&
+                  ::recv(fd, &status, 1, 0) == 1 && status == kStatusOnline;
+  ::close(fd);
+  return ok;
+}
+
+bool HttpPost(uint16_t port, std::string_view path, std::string_view body,
+              int* status, std::string* response) {
+  std::string request = "POST ";
+  request.append(path);
+  request.append(
+      " HTTP/1.1\r\nHost: 127.0.0.1\r\nContent-Type: application/json\r\n"
+      "Prefer: return=representation\r\nContent-Length: ");
+  request.append(std::to_string(body.size()));
+  request.append("\r\nConnection: close\r\n\r\n");
+  request.append(body);
+  return HttpExchange(port, request, status, response);
+}
+
+bool HttpGet(uint16_t port, std::string_view path, int* status,
+             std::string* response) {
+  std::string request = "GET ";
+  request.append(path);
+  request.append(
+      " HTTP/1.1\r\nHost: 127.0.0.1\r\nConnection: close\r\n\r\n");
+  return HttpExchange(port, request, status, response);
+}
+
+}  // namespace bench
+}  // namespace virok
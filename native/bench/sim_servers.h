@@ -0,0 +1,144 @@
+#ifndef NATIVE_BENCH_SIM_SERVERS_H_
+#define NATIVE_BENCH_SIM_SERVERS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "bench/bench_util.h"
+#include "fiscal/simulated_fiscal_device.h"
+
+namespace virok {
+namespace bench {
+
+// TCP-сервер на 127.0.0.1 з випадковим портом; кожне з'єднання
+// обробляється окремим потоком (як справжній принтер/бекенд, що не
+// блокує інших клієнтів). Лише POSIX-сокети — бенчмарки ганяються на Linux.
+class LocalServer {
+ public:
+  explicit LocalServer(const SimulationProfile& profile, uint64_t seed);
+  virtual ~LocalServer();
+
+  LocalServer(const LocalServer&) = delete;
+  LocalServer& operator=(const LocalServer&) = delete;
+
+  bool Start();
+  void Stop();
+
+  uint16_t port() const { return port_; }
+
+ protected:
+  virtual void Serve(int fd) = 0;
+
+  // Затримка і рішення про збій для наступного запиту (потокобезпечно).
+  bool NextRequest(std::chrono::microseconds* latency);
+
+ private:
+  void AcceptLoop();
+
+  int listen_fd_ = -1;
+  uint16_t port_ = 0;
+  std::thread accept_thread_;
+  std::mutex mutex_;  // connections_
+  std::vector<std::thread> connections_;
+  std::mutex dice_mutex_;
+  SimulationDice dice_;
+};
+
+// Мережевий чековий принтер (RAW 9100). Приймає документ і на запит
+// статусу DLE EOT 1 відповідає байтом "онлайн" після затримки друку;
+// збій — з'єднання закривається без відповіді.
+class EscPosSink : public LocalServer {
+ public:
+  using LocalServer::LocalServer;
+
+  uint64_t documents() const { return documents_; }
+  uint64_t bytes() const { return bytes_; }
+
+ protected:
+  void Serve(int fd) override;
+
+ private:
+  std::atomic<uint64_t> documents_{0};
+  std::atomic<uint64_t> bytes_{0};
+};
+
+// Мережевий принтер етикеток (RAW 9100). Рахує етикетки за командою
+// відрізки GS V B і "друкує" кожну із затримкою профілю: поки він
+// друкує, не читає сокет, тож TCP пригальмовує відправника, як
+// заповнений буфер справжнього принтера.
+class LabelPrinterSink : public LocalServer {
+ public:
+  using LocalServer::LocalServer;
+
+  uint64_t labels() const { return labels_; }
+  uint64_t bytes() const { return bytes_; }
+  // Коли відрізано першу й останню етикетку після Reset.
+  Clock::time_point first_label() const;
+  Clock::time_point last_label() const;
+  void Reset();
+
+ protected:
+  void Serve(int fd) override;
+
+ private:
+  std::atomic<uint64_t> labels_{0};
+  std::atomic<uint64_t> bytes_{0};
+  std::atomic<Clock::rep> first_label_{0};
+  std::atomic<Clock::rep> last_label_{0};
+};
+
+// REST-бекенд у стилі PostgREST (Supabase): POST /rest/v1/<таблиця>
+// повертає 201 і [{"id":N}], збій — 503.
+class RestBackend : public LocalServer {
+ public:
+  using LocalServer::LocalServer;
+
+  uint64_t requests() const { return requests_; }
+
+ protected:
+  void Serve(int fd) override;
+
+ private:
+  std::atomic<uint64_t> requests_{0};
+  std::atomic<int64_t> next_id_{1};
+};
+
+// Статичні файли (CDN або локальний сервер з пакетом каталогу): GET
+// шляху, доданого через Put, віддає 200 з тілом, інший шлях — 404.
+class StaticFileServer : public LocalServer {
+ public:
+  using LocalServer::LocalServer;
+
+  // До Start().
+  void Put(std::string path, std::string body);
+
+  uint64_t requests() const { return requests_; }
+
+ protected:
+  void Serve(int fd) override;
+
+ private:
+  std::unordered_map<std::string, std::string> files_;
+  std::atomic<uint64_t> requests_{0};
+};
+
+// Клієнтські половини: те, що роблять RawPrinterService і http.post.
+// Друк: з'єднання, документ, запит статусу й очікування відповіді.
+bool PrintToSink(uint16_t port, std::string_view document);
+// POST з JSON-тілом; |status| — HTTP-код (0, якщо з'єднання впало).
+bool HttpPost(uint16_t port, std::string_view path, std::string_view body,
+              int* status, std::string* response);
+// GET; тіло відповіді в |response|.
+bool HttpGet(uint16_t port, std::string_view path, int* status,
+             std::string* response);
+
+}  // namespace bench
+}  // namespace virok
+
+#endif  // NATIVE_BENCH_SIM_SERVERS_H_
@@ -0,0 +1,210 @@
+// Сховище номенклатури (native/store) під час синхронізації: |товарів|
+// у nomenclatura.db, повна синхронізація (DELETE + INSERT усіх рядків в
+// одній транзакції, як _cacheNomenclaturaWithStrategy(clearFirst: true))
+// іде потоком-писачем, а три "каси" паралельно шукають:
+//
+//   - by guid: товар за первинним ключем (кошик, акції);
+//   - barcode: пошук за штрихкодом тим самим LIKE, що searchByBarcode;
+//   - search: search_name LIKE '%запит%' ORDER BY name LIMIT 100;
+//   - category: товари групи (WHERE parent_guid = ?).
+//
+// Каса робить запит раз на 20 мс (сканування, набір запиту), а не
+// безперервно. Два режими: одне з'єднання (readers = 0, як sqflite —
+// запити стоять у черзі за транзакцією синхронізації) і WAL з пулом
+// читачів.
+//
+//   sqlite_store_bench [товарів] [читачів] [файл_бази]
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "bench/bench_util.h"
+#include "bench/catalogue_fixture.h"
+#include "store/sqlite_store.h"
+
+using virok::SqlBatch;
+using virok::SqliteStore;
+using virok::SqliteStoreOptions;
+using virok::SqlResult;
+using virok::SqlValue;
+using virok::bench::Clock;
+using virok::bench::ElapsedUs;
+using virok::bench::FixtureItem;
+using virok::bench::FixtureRandom;
+using virok::bench::LatencyStats;
+
+namespace {
+
+constexpr char kInsert[] =
+    "INSERT OR REPLACE INTO nomenclatura (guid, created_at, name, article,"
+    " unit_name, unit_guid, is_folder, parent_guid, description, barcodes,"
+    " price, search_name) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+constexpr char kByGuid[] = "SELECT * FROM nomenclatura WHERE guid = ? LIMIT 1";
+constexpr char kByBarcode[] =
+    "SELECT * FROM nomenclatura WHERE (barcodes LIKE ? OR barcodes LIKE ?"
+    " OR barcodes LIKE ? OR barcodes = ?) AND is_folder = ? LIMIT 1";
+constexpr char kSearch[] =
+    "SELECT * FROM nomenclatura WHERE search_name LIKE ? AND is_folder = ?"
+    " ORDER BY name LIMIT 100";
+constexpr char kCategory[] =
+    "SELECT * FROM nomenclatura WHERE parent_guid = ?"
+    " ORDER BY is_folder DESC, name ASC";
+
+std::vector<SqlBatch> FullSync(const std::vector<FixtureItem>& catalogue) {
+  std::vector<SqlBatch> batches(2);
+  batches[0].sql = "DELETE FROM nomenclatura";
+  batches[1].sql = kInsert;
+  batches[1].rows.reserve(catalogue.size());
+  for (const FixtureItem& item : catalogue) {
+    batches[1].rows.push_back(
+        {item.guid, std::string("2024-01-01T00:00:00.000"), item.name,
+         item.article, item.unit_name, item.unit_guid, int64_t{0},
+         item.parent_guid, std::monostate(), item.barcodes, item.price,
+         item.SearchKey()});
+  }
+  return batches;
+}
+
+// Пауза каси між запитами.
+void Pause() { std::this_thread::sleep_for(std::chrono::milliseconds(20)); }
+
+std::string FirstBarcode(const FixtureItem& item) {
+  return item.barcodes.substr(0, item.barcodes.find(','));
+}
+
+struct Lookups {
+  LatencyStats by_guid, barcode, search, category;
+};
+
+// Три паралельні "каси" шукають, доки |stop| не стане true (або
+// |rounds| запитів кожна, якщо |stop| == nullptr).
+Lookups RunLookups(SqliteStore& store,
+                   const std::vector<FixtureItem>& catalogue,
+                   const std::atomic<bool>* stop, int rounds) {
+  Lookups out;
+  auto running = [&](int i) { return stop ? !stop->load() : i < rounds; };
+  std::thread scans([&] {
+    FixtureRandom rnd(7);
+    for (int i = 0; running(i); i++) {
+      const FixtureItem& item = catalogue[rnd.Below(catalogue.size())];
+      const std::string code = FirstBarcode(item);
+      auto start = Clock::now();
+      store.ReadSync(kByBarcode, {code + ",%", "%," + code + ",%",
+                                  "%," + code, code, int64_t{0}});
+      out.barcode.Add(ElapsedUs(start));
+      start = Clock::now();
+      store.ReadSync(kByGuid, {item.guid});
+      out.by_guid.Add(ElapsedUs(start));
+      Pause();
+    }
+  });
+  std::thread search([&] {
+    FixtureRandom rnd(8);
+    for (int i = 0; running(i); i++) {
+      const FixtureItem& item = catalogue[rnd.Below(catalogue.size())];
+      const std::string key = item.SearchKey();
+      const auto start = Clock::now();
+      store.ReadSync(kSearch, {"%" + key.substr(key.size() / 2, 4) + "%",
+                               int64_t{0}});
+      out.search.Add(ElapsedUs(start));
+      Pause();
+    }
+  });
+  std::thread category([&] {
+    FixtureRandom rnd(9);
+    for (int i = 0; running(i); i++) {
+      const FixtureItem& item = catalogue[rnd.Below(catalogue.size())];
+      const auto start = Clock::now();
+      store.ReadSync(kCategory, {item.parent_guid});
+      out.category.Add(ElapsedUs(start));
+      Pause();
+    }
+  });
+  scans.join();
+  search.join();
+  category.join();
+  return out;
+}
+
+void Print(const char* mode, const char* phase, Lookups& lookups) {
+  std::printf("-- %s, %s\n", mode, phase);
+  lookups.by_guid.Print("by guid");
+  lookups.barcode.Print("barcode (LIKE)");
+  lookups.search.Print("search (LIKE, 100)");
+  lookups.category.Print("category");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 50000;
+  const int readers = argc > 2 ? std::atoi(argv[2]) : 3;
+  namespace fs = std::filesystem;
+  const fs::path path =
+      argc > 3 ? fs::path(argv[3])
+               : fs::temp_directory_path() / "virok_sqlite_store_bench.db";
+
+  const std::vector<FixtureItem> catalogue =
+      virok::bench::MakeCatalogue(count, 11);
+  std::printf("store: %zu items, %d readers\n", count, readers);
+
+  for (const int mode_readers : {0, readers}) {
+    const char* mode =
+        mode_readers ? "WAL + reader pool" : "single connection";
+    std::error_code ec;
+    for (const char* suffix : {"", "-wal", "-shm"}) {
+      fs::remove(path.u8string() + suffix, ec);
+    }
+
+    SqliteStore store;
+    SqliteStoreOptions options;
+    options.readers = mode_readers;
+    std::string error;
+    if (!store.Open(path.u8string(), options, &error)) {
+      std::fprintf(stderr, "open: %s\n", error.c_str());
+      return 1;
+    }
+    auto start = Clock::now();
+    SqlResult filled = store.WriteSync(FullSync(catalogue));
+    if (!filled.ok) {
+      std::fprintf(stderr, "fill: %s\n", filled.error.c_str());
+      return 1;
+    }
+    std::printf("\n== %s: initial fill %.0f ms\n", mode,
+                ElapsedUs(start) / 1000);
+
+    Lookups idle = RunLookups(store, catalogue, nullptr, 100);
+    Print(mode, "idle", idle);
+
+    // Синхронізації поспіль, поки каси шукають.
+    std::atomic<bool> stop{false};
+    double sync_ms = 0;
+    int syncs = 0;
+    std::thread sync([&] {
+      for (; syncs < 3; syncs++) {
+        std::vector<SqlBatch> batches = FullSync(catalogue);
+        const auto sync_start = Clock::now();
+        store.WriteSync(std::move(batches));
+        sync_ms += ElapsedUs(sync_start) / 1000;
+      }
+      stop = true;
+    });
+    Lookups busy = RunLookups(store, catalogue, &stop, 0);
+    sync.join();
+    std::printf("full sync: %.0f ms each (%d runs)\n", sync_ms / syncs, syncs);
+    Print(mode, "during full sync", busy);
+  }
+  std::error_code ec;
+  for (const char* suffix : {"", "-wal", "-shm"}) {
+    fs::remove(path.u8string() + suffix, ec);
+  }
+  return 0;
+}
@@ -0,0 +1,193 @@
+// Сторож зависань потоку платформи (native/watchdog): накладні витрати і
+// точність на модельному циклі подій з навмисними зависаннями.
+//
+//   - TraceScope у неприєднаному і приєднаному потоці (трасування
+//     вимкнене) і Beat — те, що додається до кожного обробника;
+//   - процесорний час сторожа, поки цикл простоює;
+//   - для кожного зависання: через скільки його виявлено і наскільки
+//     виміряна тривалість відрізняється від справжньої; короткі затримки
+//     між ними (менші за бюджет) не мають давати звітів.
+//
+//   stall_watchdog_bench [зависань] [бюджет_мс] [інтервал_мс]
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "bench/bench_util.h"
+#include "trace/trace.h"
+#include "watchdog/stall_watchdog.h"
+
+using std::chrono::milliseconds;
+using virok::StallWatchdog;
+using virok::StallWatchdogStatus;
+using virok::bench::Clock;
+using virok::bench::ElapsedUs;
+using virok::bench::LatencyStats;
+
+namespace {
+
+constexpr int kScopes = 1000000;
+
+double NsPerScope() {
+  const auto start = Clock::now();
+  for (int i = 0; i < kScopes; i++) {
+    VIROK_TRACE_SCOPE("bench", "span");
+  }
+  return ElapsedUs(start) * 1000.0 / kScopes;
+}
+
+// Цикл подій на окремому потоці: задачі з черги по одній, як головний
+// цикл GTK чи цикл повідомлень Win32.
+class Loop {
+ public:
+  explicit Loop(StallWatchdog* watchdog) {
+    std::atomic<bool> attached{false};
+    thread_ = std::thread([this, watchdog, &attached] {
+      watchdog->AttachLoopThread();
+      attached = true;
+      std::unique_lock<std::mutex> lock(mutex_);
+      while (true) {
+        cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+        if (tasks_.empty()) return;
+        std::function<void()> task = std::move(tasks_.front());
+        tasks_.pop_front();
+        lock.unlock();
+        task();
+        lock.lock();
+      }
+    });
+    while (!attached) std::this_thread::yield();
+  }
+
+  ~Loop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+  }
+
+  void Post(std::function<void()> task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      tasks_.push_back(std::move(task));
+    }
+    cv_.notify_all();
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> tasks_;
+  bool stop_ = false;
+  std::thread thread_;
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int stalls = argc > 1 ? std::atoi(argv[1]) : 20;
+  virok::StallWatchdogOptions options;
+  options.budget = milliseconds(argc > 2 ? std::atoi(argv[2]) : 100);
+  options.interval = milliseconds(argc > 3 ? std::atoi(argv[3]) : 50);
+  const int budget_ms = static_cast<int>(options.budget.count());
+  const int interval_ms = static_cast<int>(options.interval.count());
+
+  std::printf("TraceScope, thread not watched: %6.1f ns\n", NsPerScope());
+  double watched_ns = 0;
+  std::thread([&watched_ns] {
+    virok::ActiveSpans::AttachCurrentThread();
+    watched_ns = NsPerScope();
+  }).join();
+  std::printf("TraceScope, watched thread:     %6.1f ns\n", watched_ns);
+
+  StallWatchdog* watchdog_ptr = nullptr;
+  Loop* loop_ptr = nullptr;
+  StallWatchdog watchdog(
+      [&](uint64_t seq) {
+        loop_ptr->Post([&watchdog_ptr, seq] { watchdog_ptr->Beat(seq); });
+      },
+      options);
+  watchdog_ptr = &watchdog;
+
+  {
+    const auto start = Clock::now();
+    for (int i = 0; i < kScopes; i++) watchdog.Beat(i);
+    std::printf("Beat:                           %6.1f ns\n",
+                ElapsedUs(start) * 1000.0 / kScopes);
+  }
+
+  Loop loop(&watchdog);
+  loop_ptr = &loop;
+  watchdog.Start();
+
+  // Простій: увесь процесорний час процесу — це сторож і пульси.
+  const std::clock_t cpu_start = std::clock();
+  const uint64_t beats_start = watchdog.status().beats;
+  std::this_thread::sleep_for(std::chrono::seconds(2));
+  const double cpu_us =
+      (std::clock() - cpu_start) * 1e6 / CLOCKS_PER_SEC / 2.0;
+  std::printf("idle: %.0f beats/s, %.1f us CPU/s (budget %d ms, interval "
+              "%d ms)\n",
+              (watchdog.status().beats - beats_start) / 2.0, cpu_us,
+              budget_ms, interval_ms);
+
+  LatencyStats detection, error;
+  int missed = 0;
+  uint64_t expected = 0;
+  for (int i = 0; i < stalls; i++) {
+    // Коротка затримка, як важкий кадр, — не зависання.
+    loop.Post([budget_ms] {
+      std::this_thread::sleep_for(milliseconds(budget_ms / 3));
+    });
+    std::this_thread::sleep_for(milliseconds(budget_ms));
+
+    const int stall_ms = budget_ms + 2 * interval_ms + (i * 97) % 700;
+    const uint64_t before = watchdog.status().stalls;
+    std::atomic<int64_t> started_ns{0};
+    std::atomic<bool> done{false};
+    loop.Post([&, stall_ms] {
+      started_ns = Clock::now().time_since_epoch().count();
+      VIROK_TRACE_SCOPE("bench", "injectedStall");
+      std::this_thread::sleep_for(milliseconds(stall_ms));
+      done = true;
+    });
+    // Виявлення: коли status() показав нове зависання.
+    bool detected = false;
+    while (!done) {
+      if (!detected && watchdog.status().stalls > before) {
+        detected = true;
+        detection.Add(Clock::now().time_since_epoch().count() / 1000.0 -
+                      started_ns.load() / 1000.0);
+      }
+      std::this_thread::sleep_for(std::chrono::microseconds(500));
+    }
+    std::this_thread::sleep_for(options.interval * 3);
+    const StallWatchdogStatus status = watchdog.status();
+    expected++;
+    if (status.stalls <= before) {
+      missed++;
+      continue;
+    }
+    error.Add((status.last.duration_ms - stall_ms) * 1000.0);
+  }
+  watchdog.Stop();
+
+  const StallWatchdogStatus status = watchdog.status();
+  detection.Print("detection after stall start");
+  error.Print("measured - injected duration");
+  std::printf("stalls: injected %llu, reported %llu, missed %d\n",
+              static_cast<unsigned long long>(expected),
+              static_cast<unsigned long long>(status.stalls), missed);
+  return missed == 0 && status.stalls == expected ? 0 : 1;
+}
@@ -0,0 +1,81 @@
+// Накладні витрати TraceScope: вимкнене трасування, увімкнене з фоновим
+// писачем, і кілька потоків одночасно (кожен пише у свій буфер).
+//
+//   trace_bench [файл_траси]
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench/bench_util.h"
+#include "trace/trace.h"
+#include "trace/trace_writer.h"
+
+using virok::bench::Clock;
+using virok::bench::ElapsedUs;
+
+namespace {
+
+constexpr int kSpansPerBatch = 1000;
+
+// Середній час одного спану (нс) у пачці з kSpansPerBatch. Пачки менші за
+// буфер потоку, а між ними писач встигає його звільнити.
+double NsPerSpan(int batches) {
+  double total_us = 0;
+  for (int b = 0; b < batches; b++) {
+    const auto start = Clock::now();
+    for (int i = 0; i < kSpansPerBatch; i++) {
+      VIROK_TRACE_SCOPE("bench", "span");
+    }
+    total_us += ElapsedUs(start);
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+  }
+  return total_us * 1000.0 / (static_cast<double>(batches) * kSpansPerBatch);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::string path = argc > 1 ? argv[1] : "trace_bench.json";
+
+  std::printf("disabled:            %6.1f ns/span\n", NsPerSpan(200));
+
+  virok::ChromeTraceWriter writer;
+  if (!writer.Start(path, std::chrono::milliseconds(5))) {
+    std::printf("cannot open %s\n", path.c_str());
+    return 1;
+  }
+  virok::Tracer::Get().SetThreadName("bench-main");
+  std::printf("enabled, 1 thread:   %6.1f ns/span\n", NsPerSpan(200));
+
+  // Динамічне ім'я (як назва методу каналу) — з інтернуванням.
+  const std::string method = "fiscalizeCheck";
+  const auto start = Clock::now();
+  for (int i = 0; i < kSpansPerBatch; i++) {
+    virok::TraceScope scope("fiscal", method);
+  }
+  std::printf("enabled, interned:   %6.1f ns/span\n",
+              ElapsedUs(start) * 1000.0 / kSpansPerBatch);
+
+  std::vector<std::thread> threads;
+  std::atomic<double> worst{0};
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([t, &worst] {
+      virok::Tracer::Get().SetThreadName("worker-" + std::to_string(t));
+      const double ns = NsPerSpan(100);
+      double prev = worst.load();
+      while (ns > prev && !worst.compare_exchange_weak(prev, ns)) {
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  std::printf("enabled, 4 threads:  %6.1f ns/span (worst thread)\n",
+              worst.load());
+
+  writer.Stop();
+  std::printf("written %llu spans to %s\n",
+              static_cast<unsigned long long>(writer.written()), path.c_str());
+  return 0;
+}
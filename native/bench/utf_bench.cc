@@ -0,0 +1,170 @@
+// Перекодування UTF-8 <-> UTF-16 на тексті чеків (native/text/utf.h)
+// проти двопрохідної схеми з алокацією, як у старих Utf8ToWide/BstrToUtf8
+// (прохід для розміру, новий рядок, прохід для перетворення).
+//
+//   utf_bench [позицій_у_чеку] [ітерацій]
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "bench/bench_util.h"
+#include "bench/catalogue_fixture.h"
+#include "text/utf.h"
+
+using virok::bench::Clock;
+using virok::bench::ElapsedUs;
+using virok::bench::FixtureItem;
+using virok::bench::FixtureRandom;
+using virok::bench::LatencyStats;
+
+namespace {
+
+// jsonGoods так, як його будує CashalotComService.registerSale.
+std::string MakeReceiptJson(const std::vector<FixtureItem>& catalogue,
+                            size_t lines) {
+  FixtureRandom rnd(7);
+  std::string json = "{\"ReceiptLst\":[";
+  char buf[64];
+  for (size_t i = 0; i < lines; i++) {
+    const FixtureItem& item = catalogue[rnd.Below(catalogue.size())];
+    if (i) json.push_back(',');
+    std::snprintf(buf, sizeof(buf), "%.2f", item.price);
+    std::string price = buf;
+    price[price.find('.')] = ',';
+    json += "{\"VendorCode\":\"" + item.article + "\",\"Name\":\"" +
+            item.name + "\",\"Quantity\":\"1,000\",\"Price\":\"" + price +
+            "\",\"Amount\":\"" + price +
+            "\",\"UnitType\":\"шт\",\"IsPriceIncludeVAT\":true,"
+            "\"GoodsType\":0}";
+  }
+  json += "],\"Comment\":\"Чек з Flutter App\"}";
+  return json;
+}
+
+// Скалярне декодування без перевірок надлишковості — нижня межа того, що
+// робить MultiByteToWideChar, але з тими самими двома проходами.
+size_t NaiveDecode(const std::string& in, char16_t* out) {
+  size_t n = 0;
+  for (size_t i = 0; i < in.size();) {
+    const unsigned char c = in[i];
+    uint32_t cp;
+    if (c < 0x80) {
+      cp = c;
+      i += 1;
+    } else if (c < 0xE0 && i + 1 < in.size()) {
+      cp = ((c & 0x1F) << 6) | (in[i + 1] & 0x3F);
+      i += 2;
+    } else if (c < 0xF0 && i + 2 < in.size()) {
+      cp = ((c & 0x0F) << 12) | ((in[i + 1] & 0x3F) << 6) | (in[i + 2] & 0x3F);
+      i += 3;
+    } else {
+      cp = 0xFFFD;
+      i += 1;
+    }
+    if (out) out[n] = static_cast<char16_t>(cp);
+    n++;
+  }
+  return n;
+}
+
+std::u16string NaiveUtf8ToUtf16(const std::string& in) {
+  std::u16string out(NaiveDecode(in, nullptr), 0);
+  NaiveDecode(in, &out[0]);
+  return out;
+}
+
+size_t NaiveEncode(const std::u16string& in, char* out) {
+  size_t n = 0;
+  for (char16_t u : in) {
+    if (u < 0x80) {
+      if (out) out[n] = static_cast<char>(u);
+      n += 1;
+    } else if (u < 0x800) {
+      if (out) {
+        out[n] = static_cast<char>(0xC0 | (u >> 6));
+        out[n + 1] = static_cast<char>(0x80 | (u & 0x3F));
+      }
+      n += 2;
+    } else {
+      if (out) {
+        out[n] = static_cast<char>(0xE0 | (u >> 12));
+        out[n + 1] = static_cast<char>(0x80 | ((u >> 6) & 0x3F));
+        out[n + 2] = static_cast<char>(0x80 | (u & 0x3F));
+      }
+      n += 3;
+    }
+  }
+  return n;
+}
+
+std::string NaiveUtf16ToUtf8(const std::u16string& in) {
+  std::string out(NaiveEncode(in, nullptr), 0);
+  NaiveEncode(in, &out[0]);
+  return out;
+}
+
+template <typename Fn>
+void Measure(const char* label, size_t bytes, int iterations, Fn fn) {
+  LatencyStats stats;
+  size_t sink = 0;
+  for (int i = 0; i < iterations; i++) {
+    const auto start = Clock::now();
+    sink += fn();
+    stats.Add(ElapsedUs(start));
+  }
+  stats.Print(label);
+  std::printf("%-32s %.0f MB/s (checksum %zu)\n", "",
+              bytes / stats.Percentile(50), sink % 10);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t lines = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200;
+  const int iterations = argc > 2 ? std::atoi(argv[2]) : 2000;
+
+  const std::vector<FixtureItem> catalogue = virok::bench::MakeCatalogue(5000);
+  const std::string json = MakeReceiptJson(catalogue, lines);
+  std::u16string utf16;
+  virok::Utf8ToUtf16(json, &utf16);
+  std::printf("receipt: %zu positions, %zu UTF-8 bytes, %zu UTF-16 units\n\n",
+              lines, json.size(), utf16.size());
+
+  Measure("utf8->utf16 two-pass + alloc", json.size(), iterations,
+          [&] { return NaiveUtf8ToUtf16(json).size(); });
+  Measure("utf8->utf16 scratch", json.size(), iterations,
+          [&] { return virok::Utf8ToUtf16Scratch(json).size(); });
+  std::u16string owned;
+  Measure("utf8->utf16 owned string", json.size(), iterations, [&] {
+    virok::Utf8ToUtf16(json, &owned);
+    return owned.size();
+  });
+
+  std::printf("\n");
+  Measure("utf16->utf8 two-pass + alloc", json.size(), iterations,
+          [&] { return NaiveUtf16ToUtf8(utf16).size(); });
+  Measure("utf16->utf8 scratch", json.size(), iterations,
+          [&] { return virok::Utf16ToUtf8Scratch(utf16).size(); });
+  std::string back;
+  Measure("utf16->utf8 owned string", json.size(), iterations, [&] {
+    virok::Utf16ToUtf8(utf16, &back);
+    return back.size();
+  });
+
+  // Лише назви товарів: кирилиця з пробілами, майже без ASCII-блоків.
+  std::string cyrillic;
+  for (const auto& item : catalogue) cyrillic += item.name;
+  std::u16string cyrillic16;
+  virok::Utf8ToUtf16(cyrillic, &cyrillic16);
+  std::printf("\nnames only: %zu UTF-8 bytes\n", cyrillic.size());
+  Measure("names utf8->utf16 two-pass", cyrillic.size(), 200,
+          [&] { return NaiveUtf8ToUtf16(cyrillic).size(); });
+  Measure("names utf8->utf16 scratch", cyrillic.size(), 200,
+          [&] { return virok::Utf8ToUtf16Scratch(cyrillic).size(); });
+  Measure("names utf16->utf8 two-pass", cyrillic.size(), 200,
+          [&] { return NaiveUtf16ToUtf8(cyrillic16).size(); });
+  Measure("names utf16->utf8 scratch", cyrillic.size(), 200,
+          [&] { return virok::Utf16ToUtf8Scratch(cyrillic16).size(); });
+  return 0;
+}
@@ -0,0 +1,993 @@
+#include "catalogue/catalogue_codec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <unordered_map>
+
+#include "archive/crc32.h"
+#include "archive/lz_block.h"
+#include "json/json_reader.h"
+#include "text/lower_case.h"
+
+namespace virok {
+
+namespace {
+
+using Token = JsonReader::Token;
+
+constexpr char kMagic[4] = {'V', 'K', 'C', '1'};
+constexpr uint8_t kLayout = 1;
+// Захист від пошкодженого заголовка з величезною кількістю рядків.
+constexpr uint64_t kMaxRows = 1u << 26;
+
+enum Column : uint8_t {
+  kGuid = 1,
+  kCreatedAt = 2,
+  kName = 3,
+  kArticle = 4,
+  kUnit = 5,
+  kFolder = 6,
+  kParent = 7,
+  kDescription = 8,
+  kBarcodes = 9,
+  kPrice = 10,
+};
+
+enum BlockCodec : uint8_t { kRaw = 0, kLz = 1 };
+
+// Підпис стовпців GUID: 16 байтів на рядок або рядки як є (якщо хоч
+// один GUID не канонічний і не пережив би перетворення туди й назад).
+enum GuidKind : uint8_t { kGuidBinary = 0, kGuidText = 1 };
+enum PriceKind : uint8_t { kPriceCents = 0, kPriceDouble = 1 };
+
+// Примітиви формату — як в archive/archived_receipt.cc.
+void PutVarint(uint64_t v, std::string* out) {
+  while (v >= 0x80) {
+    out->push_back(static_cast<char>(v | 0x80));
+    v >>= 7;
+  }
+  out->push_back(static_cast<char>(v));
+}
+
+void PutZigzag(int64_t v, std::string* out) {
+  PutVarint((static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63),
+            out);
+}
+
+void PutString(std::string_view s, std::string* out) {
+  PutVarint(s.size(), out);
+  out->append(s);
+}
+
+void PutFixed32(uint32_t v, std::string* out) {
+  for (int i = 0; i < 4; i++) out->push_back(static_cast<char>(v >> (8 * i)));
+}
+
+uint32_t GetFixed32(const char* p) {
+  uint32_t v = 0;
+  for (int i = 0; i < 4; i++) {
+    v |= static_cast<uint32_t>(static_cast<uint8_t>(p[i])) << (8 * i);
+  }
+  return v;
+}
+
+class Reader {
+ public:
+  explicit Reader(std::string_view data) : data_(data) {}
+
+  bool Varint(uint64_t* v) {
+    *v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (pos_ >= data_.size()) return false;
+      const uint8_t b = static_cast<uint8_t>(data_[pos_++]);
+      *v |= static_cast<uint64_t>(b & 0x7F) << shift;
+      if (!(b & 0x80)) return true;
+    }
+    return false;
+  }
+
+  bool Zigzag(int64_t* v) {
+    uint64_t u;
+    if (!Varint(&u)) return false;
+    *v = static_cast<int64_t>(u >> 1) ^ -static_cast<int64_t>(u & 1);
+    return true;
+  }
+
+  bool Byte(uint8_t* v) {
+    if (pos_ >= data_.size()) return false;
+    *v = static_cast<uint8_t>(data_[pos_++]);
+    return true;
+  }
+
+  bool Raw(size_t size, std::string_view* s) {
+    if (size > data_.size() - pos_) return false;
+    *s = data_.substr(pos_, size);
+    pos_ += size;
+    return true;
+  }
+
+  bool Bytes(std::string_view* s) {
+    uint64_t size;
+    return Varint(&size) && size <= data_.size() - pos_ &&
+           Raw(static_cast<size_t>(size), s);
+  }
+
+  bool String(std::string* s) {
+    std::string_view view;
+    if (!Bytes(&view)) return false;
+    s->assign(view);
+    return true;
+  }
+
+  bool done() const { return pos_ == data_.size(); }
+
+ private:
+  std::string_view data_;
+  size_t pos_ = 0;
+};
+
+// ---- GUID ----
+
+int HexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  return -1;
+}
+
+// Канонічний GUID у нижньому регістрі (8-4-4-4-12) у 16 байтів.
+bool PackGuid(std::string_view guid, char* out) {
+  if (guid.size() != 36) return false;
+  int n = 0;
+  for (size_t i = 0; i < guid.size(); i++) {
+    if (i == 8 || i == 13 || i == 18 || i == 23) {
+      if (guid[i] != '-') return false;
+      continue;
+    }
+    const int hi = HexValue(guid[i]);
+    const int lo = HexValue(guid[++i]);
+    if (hi < 0 || lo < 0) return false;
+    out[n++] = static_cast<char>(hi << 4 | lo);
+  }
+  return true;
+}
+
+void UnpackGuid(const char* in, std::string* out) {
+  static const char kHex[] = "0123456789abcdef";
+  out->resize(36);
+  size_t pos = 0;
+  for (int i = 0; i < 16; i++) {
+    if (i == 4 || i == 6 || i == 8 || i == 10) (*out)[pos++] = '-';
+    const uint8_t b = static_cast<uint8_t>(in[i]);
+    (*out)[pos++] = kHex[b >> 4];
+    (*out)[pos++] = kHex[b & 15];
+  }
+}
+
+void PutGuids(const std::vector<std::string_view>& guids, std::string* out) {
+  std::string packed(guids.size() * 16, '\0');
+  bool binary = true;
+  for (size_t i = 0; i < guids.size() && binary; i++) {
+    binary = PackGuid(guids[i], &packed[i * 16]);
+  }
+  if (binary) {
+    out->push_back(static_cast<char>(kGuidBinary));
+    out->append(packed);
+    return;
+  }
+  out->push_back(static_cast<char>(kGuidText));
+  for (std::string_view guid : guids) PutString(guid, out);
+}
+
+bool ReadGuids(Reader& reader, size_t count, std::vector<std::string>* out) {
+  uint8_t kind;
+  if (!reader.Byte(&kind)) return false;
+  out->resize(count);
+  if (kind == kGuidBinary) {
+    std::string_view packed;
+    if (count > SIZE_MAX / 16 || !reader.Raw(count * 16, &packed)) {
+      return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+      UnpackGuid(packed.data() + i * 16, &(*out)[i]);
+    }
+    return true;
+  }
+  if (kind != kGuidText) return false;
+  for (size_t i = 0; i < count; i++) {
+    if (!reader.String(&(*out)[i])) return false;
+  }
+  return true;
+}
+
+// ---- Префіксне кодування ----
+
+void PutFrontCoded(std::string_view previous, std::string_view value,
+                   std::string* out) {
+  const size_t limit = std::min(previous.size(), value.size());
+  size_t shared = 0;
+  while (shared < limit && previous[shared] == value[shared]) shared++;
+  PutVarint(shared, out);
+  PutString(value.substr(shared), out);
+}
+
+bool ReadFrontCoded(Reader& reader, const std::string& previous,
+                    std::string* value) {
+  uint64_t shared;
+  std::string_view suffix;
+  if (!reader.Varint(&shared) || shared > previous.size() ||
+      !reader.Bytes(&suffix)) {
+    return false;
+  }
+  value->assign(previous, 0, static_cast<size_t>(shared));
+  value->append(suffix);
+  return true;
+}
+
+// ---- Штрихкоди ----
+
+// Цифровий код до 19 знаків вміщується в uint64; довжина зберігає нулі
+// попереду.
+bool NumericBarcode(std::string_view code, uint64_t* value) {
+  if (code.empty() || code.size() > 19) return false;
+  *value = 0;
+  for (char c : code) {
+    if (c < '0' || c > '9') return false;
+    *value = *value * 10 + static_cast<uint64_t>(c - '0');
+  }
+  return true;
+}
+
+void PutBarcodes(std::string_view barcodes, std::string* out) {
+  if (barcodes.empty()) {
+    PutVarint(0, out);
+    return;
+  }
+  const size_t count = std::count(barcodes.begin(), barcodes.end(), ',') + 1;
+  PutVarint(count, out);
+  for (;;) {
+    const size_t comma = barcodes.find(',');
+    const std::string_view code = barcodes.substr(0, comma);
+    uint64_t value;
+    if (NumericBarcode(code, &value)) {
+      PutVarint(code.size() << 1 | 1, out);
+      PutVarint(value, out);
+    } else {
+      PutVarint(code.size() << 1, out);
+      out->append(code);
+    }
+    if (comma == std::string_view::npos) return;
+    barcodes.remove_prefix(comma + 1);
+  }
+}
+
+bool ReadBarcodes(Reader& reader, std::string* out) {
+  uint64_t count;
+  if (!reader.Varint(&count)) return false;
+  out->clear();
+  for (uint64_t i = 0; i < count; i++) {
+    if (i) out->push_back(',');
+    uint64_t tag;
+    if (!reader.Varint(&tag)) return false;
+    const uint64_t size = tag >> 1;
+    if (tag & 1) {
+      uint64_t value;
+      if (size == 0 || size > 19 || !reader.Varint(&value)) return false;
+      // Цифри з кінця, нулі попереду — до довжини коду.
+      const size_t end = out->size() + size;
+      out->resize(end);
+      for (size_t pos = end; pos-- > end - size;) {
+        (*out)[pos] = static_cast<char>('0' + value % 10);
+        value /= 10;
+      }
+      if (value != 0) return false;
+    } else {
+      std::string_view code;
+      if (!reader.Raw(static_cast<size_t>(size), &code)) return false;
+      out->append(code);
+    }
+  }
+  return true;
+}
+
+// ---- Час ----
+
+// Дні від 1970-01-01 для григоріанської дати (алгоритм Говарда Хіннанта).
+int64_t DaysFromCivil(int64_t y, unsigned m, unsigned d) {
+  y -= m <= 2;
+  const int64_t era = (y >= 0 ? y : y - 399) / 400;
+  const unsigned yoe = static_cast<unsigned>(y - era * 400);
+  const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+void CivilFromDays(int64_t z, int64_t* y, unsigned* m, unsigned* d) {
+  z += 719468;
+  const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+  const unsigned doe = static_cast<unsigned>(z - era * 146097);
+  const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  const unsigned mp = (5 * doy + 2) / 153;
+  *d = doy - (153 * mp + 2) / 5 + 1;
+  *m = mp < 10 ? mp + 3 : mp - 9;
+  *y = static_cast<int64_t>(yoe) + era * 400 + (*m <= 2);
+}
+
+// Рівно |width| цифр з позиції |*pos|.
+bool Digits(std::string_view text, size_t* pos, int width, int* value) {
+  if (*pos + width > text.size()) return false;
+  *value = 0;
+  for (int i = 0; i < width; i++) {
+    const char c = text[*pos + i];
+    if (c < '0' || c > '9') return false;
+    *value = *value * 10 + (c - '0');
+  }
+  *pos += width;
+  return true;
+}
+
+// ---- JSON ----
+
+class JsonRowParser {
+ public:
+  explicit JsonRowParser(std::string_view json) : reader_(json) {}
+
+  bool Run(std::vector<CatalogueRecord>* records, std::string* error) {
+    if (reader_.Next() != Token::kBeginArray) {
+      return Fail(error, "Catalogue JSON must be an array");
+    }
+    for (;;) {
+      const Token t = reader_.Next();
+      if (t == Token::kEndArray) return true;
+      if (t != Token::kBeginObject) {
+        return Fail(error, "Malformed catalogue JSON");
+      }
+      std::string message;
+      if (!ReadRow(&records->emplace_back(), &message)) {
+        if (message.empty()) return Fail(error, "Malformed catalogue JSON");
+        if (error) *error = message;
+        return false;
+      }
+    }
+  }
+
+ private:
+  bool Fail(std::string* error, const char* message) {
+    if (error) *error = reader_.error().empty() ? message : reader_.error();
+    return false;
+  }
+
+  bool ReadRow(CatalogueRecord* r, std::string* error) {
+    bool has_created_at = false;
+    for (;;) {
+      const Token t = reader_.Next();
+      if (t == Token::kEndObject) break;
+      if (t != Token::kKey) return false;
+      const std::string_view key = reader_.text();
+      bool ok = true;
+      if (key == "guid") {
+        ok = ReadText(&r->guid, nullptr);
+      } else if (key == "name") {
+        ok = ReadText(&r->name, nullptr);
+      } else if (key == "article") {
+        ok = ReadText(&r->article, nullptr);
+      } else if (key == "unit_name") {
+        ok = ReadText(&r->unit_name, nullptr);
+      } else if (key == "unit_guid") {
+        ok = ReadText(&r->unit_guid, nullptr);
+      } else if (key == "parent_guid") {
+        ok = ReadText(&r->parent_guid, &r->has_parent);
+      } else if (key == "description") {
+        ok = ReadText(&r->description, &r->has_description);
+      } else if (key == "created_at") {
+        std::string text;
+        ok = ReadText(&text, &has_created_at);
+        if (ok && has_created_at &&
+            !ParseCatalogueTime(text, &r->created_at_us,
+                                &r->created_at_utc)) {
+          *error = "Invalid created_at: " + text;
+          return false;
+        }
+      } else if (key == "is_folder") {
+        const Token v = reader_.Next();
+        ok = v == Token::kBool || v == Token::kNull;
+        r->is_folder = v == Token::kBool && reader_.boolean();
+      } else if (key == "barcodes") {
+        ok = ReadBarcodeList(reader_, reader_.Next(), &r->barcodes);
+      } else if (key == "prices") {
+        bool found = false;
+        ok = ReadPriceList(reader_, reader_.Next(), &r->price, &found);
+      } else {
+        reader_.Next();
+        ok = reader_.Skip();
+      }
+      if (!ok) return false;
+    }
+    // DateTime.parse у Dart теж не приймає рядок без created_at.
+    if (!has_created_at) {
+      *error = "created_at is required (" + r->guid + ")";
+      return false;
+    }
+    return true;
+  }
+
+  // Рядок або null (null — порожній рядок і |*present| = false).
+  bool ReadText(std::string* out, bool* present) {
+    const Token t = reader_.Next();
+    if (present) *present = t == Token::kString;
+    if (t == Token::kNull) {
+      out->clear();
+      return true;
+    }
+    if (t != Token::kString) return false;
+    out->assign(reader_.text());
+    return true;
+  }
+
+  // Масив кодів (рядки, числа; null пропускається) або JSON-рядок з ним.
+  static bool ReadBarcodeList(JsonReader& reader, Token t, std::string* out) {
+    out->clear();
+    if (t == Token::kNull) return true;
+    if (t == Token::kString) {
+      const std::string text(reader.text());
+      JsonReader nested(text);
+      // Нерозбірний рядок у Dart теж дає порожній список.
+      if (!ReadBarcodeList(nested, nested.Next(), out)) out->clear();
+      return true;
+    }
+    if (t != Token::kBeginArray) return reader.Skip();
+    for (;;) {
+      t = reader.Next();
+      if (t == Token::kEndArray) return true;
+      if (t == Token::kString || t == Token::kNumber) {
+        if (!out->empty()) out->push_back(',');
+        out->append(reader.text());
+      } else if (t == Token::kNull) {
+        continue;
+      } else if (!reader.Skip()) {
+        return false;
+      }
+    }
+  }
+
+  // Ціна з елемента: число, {price|value: число} або ще один рівень
+  // вкладеності, як _extractPrice у NomenclaturaModel.
+  static bool ReadPrice(JsonReader& reader, Token t, int depth, double* price,
+                        bool* found) {
+    *found = false;
+    if (t == Token::kNumber) {
+      *price = reader.number();
+      *found = true;
+      return true;
+    }
+    if (t != Token::kBeginObject) return reader.Skip();
+    // p['price'] ?? p['value']: price має перевагу, якщо не null.
+    bool has_price = false, has_value = false;
+    bool price_found = false, value_found = false;
+    double price_number = 0, value_number = 0;
+    for (;;) {
+      t = reader.Next();
+      if (t == Token::kEndObject) break;
+      if (t != Token::kKey) return false;
+      const std::string_view key = reader.text();
+      const bool is_price = key == "price";
+      const bool is_value = key == "value";
+      t = reader.Next();
+      if ((!is_price && !is_value) || t == Token::kNull) {
+        if (!reader.Skip()) return false;
+        continue;
+      }
+      bool inner_found = false;
+      double inner = 0;
+      if (t == Token::kNumber ||
+          (t == Token::kBeginObject && depth == 0)) {
+        if (!ReadPrice(reader, t, depth + 1, &inner, &inner_found)) {
+          return false;
+        }
+      } else if (!reader.Skip()) {
+        return false;
+      }
+      if (is_price) {
+        has_price = true;
+        price_found = inner_found;
+        price_number = inner;
+      } else {
+        has_value = true;
+        value_found = inner_found;
+        value_number = inner;
+      }
+    }
+    if (has_price) {
+      *found = price_found;
+      *price = price_number;
+    } else if (has_value) {
+      *found = value_found;
+      *price = value_number;
+    }
+    return true;
+  }
+
+  static bool ReadPriceList(JsonReader& reader, Token t, double* price,
+                            bool* found) {
+    *found = false;
+    if (t == Token::kNull) return true;
+    if (t == Token::kString) {
+      const std::string text(reader.text());
+      JsonReader nested(text);
+      if (!ReadPriceList(nested, nested.Next(), price, found)) *found = false;
+      return true;
+    }
+    if (t != Token::kBeginArray) return reader.Skip();
+    for (;;) {
+      t = reader.Next();
+      if (t == Token::kEndArray) return true;
+      double value = 0;
+      bool value_found = false;
+      if (!ReadPrice(reader, t, 0, &value, &value_found)) return false;
+      if (value_found && !*found) {
+        *price = value;
+        *found = true;
+      }
+    }
+  }
+
+  JsonReader reader_;
+};
+
+// ---- Блоки ----
+
+void PutBlock(Column id, const std::string& payload, std::string* out) {
+  out->push_back(static_cast<char>(id));
+  std::string packed;
+  // Дрібні блоки не стискаються: виграш менший за заголовок.
+  if (payload.size() >= 64) LzCompress(payload, &packed);
+  if (!packed.empty() && packed.size() + 8 < payload.size()) {
+    out->push_back(static_cast<char>(kLz));
+    PutVarint(payload.size(), out);
+    PutString(packed, out);
+  } else {
+    out->push_back(static_cast<char>(kRaw));
+    PutString(payload, out);
+  }
+}
+
+bool ExactCents(double price, int64_t* cents) {
+  if (!std::isfinite(price) || std::fabs(price) > 1e13) return false;
+  *cents = std::llround(price * 100);
+  return static_cast<double>(*cents) / 100 == price;
+}
+
+}  // namespace
+
+bool ParseCatalogueJson(std::string_view json,
+                        std::vector<CatalogueRecord>* records,
+                        std::string* error) {
+  return JsonRowParser(json).Run(records, error);
+}
+
+void EncodeCatalogue(const std::vector<CatalogueRecord>& records,
+                     std::string* out) {
+  const size_t rows = records.size();
+  // Порядок відображення (ORDER BY name): сусідні назви мають спільні
+  // префікси.
+  std::vector<uint32_t> order(rows);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+    const CatalogueRecord& x = records[a];
+    const CatalogueRecord& y = records[b];
+    const int c = x.name.compare(y.name);
+    return c != 0 ? c < 0 : x.guid < y.guid;
+  });
+
+  std::string guid, created_at, name, article, unit, folder, parent;
+  std::string description, barcodes, price;
+
+  std::vector<std::string_view> guids;
+  guids.reserve(rows);
+  for (uint32_t i : order) guids.push_back(records[i].guid);
+  PutGuids(guids, &guid);
+
+  // Зсунуте на біт значення: молодший біт — час без зсуву (не UTC).
+  uint64_t previous_time = 0;
+  for (uint32_t i : order) {
+    const CatalogueRecord& r = records[i];
+    const uint64_t value = static_cast<uint64_t>(r.created_at_us) << 1 |
+                           (r.created_at_utc ? 0 : 1);
+    PutZigzag(static_cast<int64_t>(value - previous_time), &created_at);
+    previous_time = value;
+  }
+
+  const std::string* previous_name = nullptr;
+  const std::string* previous_article = nullptr;
+  static const std::string kEmpty;
+  for (uint32_t i : order) {
+    const CatalogueRecord& r = records[i];
+    PutFrontCoded(previous_name ? *previous_name : kEmpty, r.name, &name);
+    PutFrontCoded(previous_article ? *previous_article : kEmpty, r.article,
+                  &article);
+    previous_name = &r.name;
+    previous_article = &r.article;
+  }
+
+  // Словник одиниць: у каталозі їх кілька на сотні тисяч товарів.
+  std::unordered_map<std::string, uint32_t> unit_index;
+  std::vector<uint32_t> unit_rows;
+  std::vector<std::string_view> unit_guids, unit_names;
+  unit_rows.reserve(rows);
+  for (uint32_t i : order) {
+    const CatalogueRecord& r = records[i];
+    std::string key = r.unit_guid;
+    key.push_back('\0');
+    key.append(r.unit_name);
+    auto it = unit_index.emplace(std::move(key), unit_index.size()).first;
+    if (it->second == unit_guids.size()) {
+      unit_guids.push_back(r.unit_guid);
+      unit_names.push_back(r.unit_name);
+    }
+    unit_rows.push_back(it->second);
+  }
+  PutVarint(unit_guids.size(), &unit);
+  PutGuids(unit_guids, &unit);
+  for (std::string_view unit_name : unit_names) PutString(unit_name, &unit);
+  for (uint32_t index : unit_rows) PutVarint(index, &unit);
+
+  folder.assign((rows + 7) / 8, '\0');
+  for (size_t row = 0; row < rows; row++) {
+    if (records[order[row]].is_folder) {
+      folder[row / 8] = static_cast<char>(folder[row / 8] | 1 << (row % 8));
+    }
+  }
+
+  // Словник батьківських папок; 0 — без батька.
+  std::unordered_map<std::string_view, uint32_t> parent_index;
+  std::vector<std::string_view> parents;
+  std::vector<uint32_t> parent_rows;
+  parent_rows.reserve(rows);
+  for (uint32_t i : order) {
+    const CatalogueRecord& r = records[i];
+    if (!r.has_parent) {
+      parent_rows.push_back(0);
+      continue;
+    }
+    auto it = parent_index.emplace(r.parent_guid, parents.size() + 1).first;
+    if (it->second == parents.size() + 1) parents.push_back(r.parent_guid);
+    parent_rows.push_back(it->second);
+  }
+  PutVarint(parents.size(), &parent);
+  PutGuids(parents, &parent);
+  for (uint32_t index : parent_rows) PutVarint(index, &parent);
+
+  for (uint32_t i : order) {
+    const CatalogueRecord& r = records[i];
+    if (!r.has_description) {
+      PutVarint(0, &description);
+      continue;
+    }
+    PutVarint(r.description.size() + 1, &description);
+    description.append(r.description);
+  }
+
+  for (uint32_t i : order) PutBarcodes(records[i].barcodes, &barcodes);
+
+  bool cents_exact = true;
+  std::string cents;
+  for (uint32_t i : order) {
+    int64_t value;
+    if (!ExactCents(records[i].price, &value)) {
+      cents_exact = false;
+      break;
+    }
+    PutZigzag(value, &cents);
+  }
+  if (cents_exact) {
+    price.push_back(static_cast<char>(kPriceCents));
+    price.append(cents);
+  } else {
+    price.push_back(static_cast<char>(kPriceDouble));
+    for (uint32_t i : order) {
+      uint64_t bits;
+      std::memcpy(&bits, &records[i].price, sizeof(bits));
+      for (int b = 0; b < 8; b++) {
+        price.push_back(static_cast<char>(bits >> (8 * b)));
+      }
+    }
+  }
+
+  const size_t start = out->size();
+  out->append(kMagic, sizeof(kMagic));
+  out->push_back(static_cast<char>(kLayout));
+  PutVarint(rows, out);
+  PutVarint(10, out);
+  PutBlock(kGuid, guid, out);
+  PutBlock(kCreatedAt, created_at, out);
+  PutBlock(kName, name, out);
+  PutBlock(kArticle, article, out);
+  PutBlock(kUnit, unit, out);
+  PutBlock(kFolder, folder, out);
+  PutBlock(kParent, parent, out);
+  PutBlock(kDescription, description, out);
+  PutBlock(kBarcodes, barcodes, out);
+  PutBlock(kPrice, price, out);
+  PutFixed32(Crc32(out->data() + start, out->size() - start), out);
+}
+
+bool DecodeCatalogue(std::string_view data,
+                     std::vector<CatalogueRecord>* records,
+                     std::string* error) {
+  auto fail = [error](const char* message) {
+    if (error) *error = message;
+    return false;
+  };
+  if (data.size() < sizeof(kMagic) + 1 + 4 ||
+      std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) {
+    return fail("Not a catalogue pack");
+  }
+  const std::string_view body = data.substr(0, data.size() - 4);
+  if (Crc32(body.data(), body.size()) !=
+      GetFixed32(data.data() + body.size())) {
+    return fail("Catalogue pack checksum mismatch");
+  }
+  Reader header(body.substr(sizeof(kMagic)));
+  uint8_t layout;
+  uint64_t rows, blocks;
+  if (!header.Byte(&layout) || layout != kLayout) {
+    return fail("Unsupported catalogue pack layout");
+  }
+  if (!header.Varint(&rows) || rows > kMaxRows || !header.Varint(&blocks)) {
+    return fail("Malformed catalogue pack header");
+  }
+
+  const size_t base = records->size();
+  records->resize(base + rows);
+  CatalogueRecord* const row = records->data() + base;
+  // Після помилки в |records| не лишається недорозібраних рядків.
+  auto reject = [records, base, &fail](const char* message) {
+    records->resize(base);
+    return fail(message);
+  };
+  std::string unpacked;
+  std::vector<std::string> strings;
+  for (uint64_t b = 0; b < blocks; b++) {
+    uint8_t id, codec;
+    std::string_view payload;
+    if (!header.Byte(&id) || !header.Byte(&codec)) {
+      return reject("Truncated catalogue pack");
+    }
+    if (codec == kLz) {
+      uint64_t raw_size;
+      std::string_view packed;
+      if (!header.Varint(&raw_size) || raw_size > (uint64_t{1} << 32) ||
+          !header.Bytes(&packed)) {
+        return reject("Truncated catalogue pack");
+      }
+      unpacked.clear();
+      if (!LzDecompress(packed, static_cast<size_t>(raw_size), &unpacked)) {
+        return reject("Corrupted catalogue pack block");
+      }
+      payload = unpacked;
+    } else if (codec != kRaw || !header.Bytes(&payload)) {
+      return reject("Truncated catalogue pack");
+    }
+
+    Reader reader(payload);
+    bool ok = true;
+    switch (id) {
+      case kGuid:
+        ok = ReadGuids(reader, rows, &strings);
+        for (size_t i = 0; ok && i < rows; i++) {
+          row[i].guid = std::move(strings[i]);
+        }
+        break;
+      case kCreatedAt: {
+        uint64_t value = 0;
+        for (size_t i = 0; ok && i < rows; i++) {
+          int64_t delta = 0;
+          ok = reader.Zigzag(&delta);
+          value += static_cast<uint64_t>(delta);
+          row[i].created_at_us = static_cast<int64_t>(value) >> 1;
+          row[i].created_at_utc = (value & 1) == 0;
+        }
+        break;
+      }
+      case kName:
+      case kArticle: {
+        const std::string empty;
+        for (size_t i = 0; ok && i < rows; i++) {
+          std::string* field = id == kName ? &row[i].name : &row[i].article;
+          const std::string* previous =
+              i == 0 ? &empty
+                     : (id == kName ? &row[i - 1].name : &row[i - 1].article);
+          ok = ReadFrontCoded(reader, *previous, field);
+        }
+        break;
+      }
+      case kUnit: {
+        uint64_t count;
+        std::vector<std::string> names;
+        ok = reader.Varint(&count) && count <= payload.size() &&
+             ReadGuids(reader, count, &strings);
+        names.resize(ok ? count : 0);
+        for (size_t i = 0; ok && i < count; i++) ok = reader.String(&names[i]);
+        for (size_t i = 0; ok && i < rows; i++) {
+          uint64_t index;
+          ok = reader.Varint(&index) && index < count;
+          if (ok) {
+            row[i].unit_guid = strings[index];
+            row[i].unit_name = names[index];
+          }
+        }
+        break;
+      }
+      case kFolder: {
+        std::string_view bits;
+        ok = reader.Raw((rows + 7) / 8, &bits);
+        for (size_t i = 0; ok && i < rows; i++) {
+          row[i].is_folder = (bits[i / 8] >> (i % 8)) & 1;
+        }
+        break;
+      }
+      case kParent: {
+        uint64_t count;
+        ok = reader.Varint(&count) && count <= payload.size() &&
+             ReadGuids(reader, count, &strings);
+        for (size_t i = 0; ok && i < rows; i++) {
+          uint64_t index;
+          ok = reader.Varint(&index) && index <= count;
+          row[i].has_parent = ok && index > 0;
+          if (row[i].has_parent) row[i].parent_guid = strings[index - 1];
+        }
+        break;
+      }
+      case kDescription:
+        for (size_t i = 0; ok && i < rows; i++) {
+          uint64_t size;
+          std::string_view text;
+          ok = reader.Varint(&size) &&
+               (size == 0 ||
+                reader.Raw(static_cast<size_t>(size - 1), &text));
+          row[i].has_description = ok && size > 0;
+          row[i].description.assign(text);
+        }
+        break;
+      case kBarcodes:
+        for (size_t i = 0; ok && i < rows; i++) {
+          ok = ReadBarcodes(reader, &row[i].barcodes);
+        }
+        break;
+      case kPrice: {
+        uint8_t kind;
+        ok = reader.Byte(&kind) &&
+             (kind == kPriceCents || kind == kPriceDouble);
+        for (size_t i = 0; ok && i < rows; i++) {
+          if (kind == kPriceCents) {
+            int64_t cents = 0;
+            ok = reader.Zigzag(&cents);
+            row[i].price = static_cast<double>(cents) / 100;
+          } else {
+            std::string_view bits;
+            ok = reader.Raw(8, &bits);
+            if (ok) {
+              uint64_t u = 0;
+              for (int k = 0; k < 8; k++) {
+                u |= static_cast<uint64_t>(static_cast<uint8_t>(bits[k]))
+                     << (8 * k);
+              }
+              std::memcpy(&row[i].price, &u, sizeof(u));
+            }
+          }
+        }
+        break;
+      }
+      default:
+        // Блок новішої версії формату: рядки без нього лишаються з
+        // типовими значеннями.
+        continue;
+    }
+    if (!ok || !reader.done()) return reject("Corrupted catalogue pack column");
+  }
+  if (!header.done()) return reject("Trailing data in catalogue pack");
+  return true;
+}
+
+std::string FormatCatalogueTime(int64_t us, bool utc) {
+  int64_t days = us / 86400000000LL;
+  int64_t rest = us % 86400000000LL;
+  if (rest < 0) {
+    rest += 86400000000LL;
+    days--;
+  }
+  int64_t year;
+  unsigned month, day;
+  CivilFromDays(days, &year, &month, &day);
+  const int64_t seconds = rest / 1000000;
+  const int micros = static_cast<int>(rest % 1000000);
+  char buf[48];
+  int n = std::snprintf(
+      buf, sizeof(buf), "%04lld-%02u-%02uT%02d:%02d:%02d.%03d",
+      static_cast<long long>(year), month, day,
+      static_cast<int>(seconds / 3600), static_cast<int>(seconds / 60 % 60),
+      static_cast<int>(seconds % 60), micros / 1000);
+  if (micros % 1000 != 0) {
+    n += std::snprintf(buf + n, sizeof(buf) - n, "%03d", micros % 1000);
+  }
+  std::string out(buf, static_cast<size_t>(n));
+  if (utc) out.push_back('Z');
+  return out;
+}
+
+bool ParseCatalogueTime(std::string_view text, int64_t* us, bool* utc) {
+  // YYYY-MM-DD[(T| )HH:MM[:SS[.ffffff]]][Z|±HH[:?MM]] — те, що віддає
+  // PostgREST для timestamp і timestamptz і що приймає DateTime.parse.
+  size_t pos = 0;
+  int year, month, day, hour = 0, minute = 0, second = 0;
+  if (!Digits(text, &pos, 4, &year) || pos >= text.size() ||
+      text[pos++] != '-' || !Digits(text, &pos, 2, &month) ||
+      pos >= text.size() || text[pos++] != '-' ||
+      !Digits(text, &pos, 2, &day) || month < 1 || month > 12 || day < 1 ||
+      day > 31) {
+    return false;
+  }
+  int64_t micros = 0;
+  if (pos < text.size() && (text[pos] == 'T' || text[pos] == ' ')) {
+    pos++;
+    if (!Digits(text, &pos, 2, &hour) || pos >= text.size() ||
+        text[pos++] != ':' || !Digits(text, &pos, 2, &minute)) {
+      return false;
+    }
+    if (pos < text.size() && text[pos] == ':') {
+      pos++;
+      if (!Digits(text, &pos, 2, &second)) return false;
+      if (pos < text.size() && (text[pos] == '.' || text[pos] == ',')) {
+        pos++;
+        int digits = 0;
+        while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') {
+          // Понад мікросекунди Dart відкидає.
+          if (digits < 6) micros = micros * 10 + (text[pos] - '0');
+          digits++;
+          pos++;
+        }
+        if (digits == 0) return false;
+        for (; digits < 6; digits++) micros *= 10;
+      }
+    }
+  }
+  int64_t offset_minutes = 0;
+  *utc = false;
+  if (pos < text.size()) {
+    const char sign = text[pos++];
+    if (sign == 'Z' || sign == 'z') {
+      *utc = true;
+    } else if (sign == '+' || sign == '-') {
+      int oh, om = 0;
+      if (!Digits(text, &pos, 2, &oh)) return false;
+      if (pos < text.size() && text[pos] == ':') pos++;
+      if (pos < text.size() && !Digits(text, &pos, 2, &om)) return false;
+      offset_minutes = (sign == '-' ? -1 : 1) * (oh * 60 + om);
+      *utc = true;
+    } else {
+      return false;
+    }
+  }
+  if (pos != text.size() || hour > 24 || minute > 59 || second > 59) {
+    return false;
+  }
+  const int64_t days = DaysFromCivil(year, month, day);
+  *us = ((days * 24 + hour) * 60 + minute - offset_minutes) * 60000000LL +
+        second * 1000000LL + micros;
+  return true;
+}
+
+std::string CatalogueSearchName(const CatalogueRecord& record) {
+  std::string key;
+  key.reserve(record.article.size() + record.barcodes.size() +
+              record.name.size());
+  AppendUtf8Lower(record.article, &key);
+  AppendUtf8Lower(record.barcodes, &key);
+  AppendUtf8Lower(record.name, &key);
+  return key;
+}
+
+}  // namespace virok
@@ -0,0 +1,71 @@
+#ifndef NATIVE_CATALOGUE_CATALOGUE_CODEC_H_
+#define NATIVE_CATALOGUE_CATALOGUE_CODEC_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace virok {
+
+// Рядок nomenklatura_with_data у тому вигляді, в якому він лягає в
+// таблицю nomenclatura локальної бази.
+struct CatalogueRecord {
+  std::string guid;
+  // created_at: мікросекунди від епохи. Без зсуву в рядку (utc = false)
+  // це місцевий час без перерахунку, як DateTime.parse у Dart.
+  int64_t created_at_us = 0;
+  bool created_at_utc = true;
+  std::string name;
+  std::string article;
+  std::string unit_name;
+  std::string unit_guid;
+  bool is_folder = false;
+  bool has_parent = false;
+  std::string parent_guid;
+  bool has_description = false;
+  std::string description;
+  std::string barcodes;  // через кому
+  double price = 0;
+};
+
+// Розбирає відповідь PostgREST з nomenklatura_with_data (масив об'єктів).
+// barcodes — масив рядків або JSON-рядок з ним; prices — масив чисел чи
+// об'єктів {price|value}, береться перше дійсне значення.
+bool ParseCatalogueJson(std::string_view json,
+                        std::vector<CatalogueRecord>* records,
+                        std::string* error);
+
+// Компактний формат передачі каталогу (.vkc) для синхронізації замість
+// JSON: той самий файл віддається статично (CDN, локальний сервер) і
+// розкладається прямо в сховище без побудови моделей у Dart.
+//
+// Стовпцевий: рядки впорядковані за (name, guid), кожне поле — окремий
+// блок зі своїм кодуванням:
+//   guid, parent     — 16 байтів на канонічний GUID; parent — словник;
+//   created_at       — дельти мікросекунд (zigzag varint);
+//   name, article    — префіксне кодування відносно попереднього рядка;
+//   unit             — словник пар (guid, назва) і індекс на рядок;
+//   is_folder        — бітова маска;
+//   barcodes         — цифрові коди як числа з довжиною (нулі попереду
+//                      зберігаються);
+//   price            — копійки (zigzag varint), якщо всі ціни точні.
+// Блоки стиснуто LZ (archive/lz_block), якщо це дає виграш; увесь файл
+// закінчується CRC-32. Невідомі блоки декодер пропускає.
+void EncodeCatalogue(const std::vector<CatalogueRecord>& records,
+                     std::string* out);
+bool DecodeCatalogue(std::string_view data,
+                     std::vector<CatalogueRecord>* records,
+                     std::string* error);
+
+// created_at так, як його пише DateTime.toIso8601String:
+// "2024-03-01T08:15:00.000Z" (мікросекунди — лише якщо є).
+std::string FormatCatalogueTime(int64_t us, bool utc);
+bool ParseCatalogueTime(std::string_view text, int64_t* us, bool* utc);
+
+// search_name = '${article}${barcodes}${name}'.toLowerCase().
+std::string CatalogueSearchName(const CatalogueRecord& record);
+
+}  // namespace virok
+
+#endif  // NATIVE_CATALOGUE_CATALOGUE_CODEC_H_
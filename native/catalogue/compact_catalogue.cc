@@ -0,0 +1,494 @@
+#include "catalogue/compact_catalogue.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace virok {
+
+namespace {
+
+// Рядків у блоці префіксного кодування назв: перший рядок блоку лежить
+// повністю, тож доступ до будь-якої назви декодує не більше 16 рядків.
+constexpr uint32_t kNameBlock = 16;
+
+enum RowFlags : uint8_t {
+  kFolder = 1,
+  kUtc = 2,
+  kTextGuid = 4,  // GUID не канонічний, лежить у text_guids_
+};
+
+// Ціна, що не вміщується в int32 копійок або не точна до копійки.
+constexpr int32_t kOddPrice = INT32_MIN;
+
+void PutVarint(uint64_t v, std::string* out) {
+  while (v >= 0x80) {
+    out->push_back(static_cast<char>(v | 0x80));
+    v >>= 7;
+  }
+  out->push_back(static_cast<char>(v));
+}
+
+// Буфери будує Builder, тож читання без перевірок меж.
+uint64_t GetVarint(const char** p) {
+  uint64_t v = 0;
+  for (int shift = 0;; shift += 7) {
+    const uint8_t b = static_cast<uint8_t>(*(*p)++);
+    v |= static_cast<uint64_t>(b & 0x7F) << shift;
+    if (!(b & 0x80)) return v;
+  }
+}
+
+std::string_view GetBytes(const char** p) {
+  const size_t size = static_cast<size_t>(GetVarint(p));
+  const std::string_view out(*p, size);
+  *p += size;
+  return out;
+}
+
+int HexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  return -1;
+}
+
+// Канонічний GUID у нижньому регістрі (8-4-4-4-12) у 16 байтів — як у
+// catalogue_codec.cc.
+bool PackGuid(std::string_view guid, char* out) {
+  if (guid.size() != 36) return false;
+  int n = 0;
+  for (size_t i = 0; i < guid.size(); i++) {
+    if (i == 8 || i == 13 || i == 18 || i == 23) {
+      if (guid[i] != '-') return false;
+      continue;
+    }
+    const int hi = HexValue(guid[i]);
+    const int lo = HexValue(guid[++i]);
+    if (hi < 0 || lo < 0) return false;
+    out[n++] = static_cast<char>(hi << 4 | lo);
+  }
+  return true;
+}
+
+std::string UnpackGuid(const char* in) {
+  static const char kHex[] = "0123456789abcdef";
+  std::string out(36, '-');
+  size_t pos = 0;
+  for (int i = 0; i < 16; i++) {
+    if (i == 4 || i == 6 || i == 8 || i == 10) pos++;
+    const uint8_t b = static_cast<uint8_t>(in[i]);
+    out[pos++] = kHex[b >> 4];
+    out[pos++] = kHex[b & 15];
+  }
+  return out;
+}
+
+// Цифровий код до 19 знаків вміщується в uint64; довжина зберігає нулі
+// попереду.
+bool NumericBarcode(std::string_view code, uint64_t* value) {
+  if (code.empty() || code.size() > 19) return false;
+  *value = 0;
+  for (char c : code) {
+    if (c < '0' || c > '9') return false;
+    *value = *value * 10 + static_cast<uint64_t>(c - '0');
+  }
+  return true;
+}
+
+// Штрихкоди через кому: кількість, далі на код тег (довжина << 1 |
+// цифровий) і число або байти коду.
+void PutBarcodes(std::string_view barcodes, std::string* out) {
+  if (barcodes.empty()) {
+    PutVarint(0, out);
+    return;
+  }
+  PutVarint(std::count(barcodes.begin(), barcodes.end(), ',') + 1, out);
+  for (;;) {
+    const size_t comma = barcodes.find(',');
+    const std::string_view code = barcodes.substr(0, comma);
+    uint64_t value;
+    if (NumericBarcode(code, &value)) {
+      PutVarint(code.size() << 1 | 1, out);
+      PutVarint(value, out);
+    } else {
+      PutVarint(code.size() << 1, out);
+      out->append(code);
+    }
+    if (comma == std::string_view::npos) return;
+    barcodes.remove_prefix(comma + 1);
+  }
+}
+
+void AppendBarcodes(std::string_view packed, std::string* out) {
+  const char* p = packed.data();
+  const uint64_t count = GetVarint(&p);
+  for (uint64_t i = 0; i < count; i++) {
+    if (i) out->push_back(',');
+    const uint64_t tag = GetVarint(&p);
+    const size_t size = static_cast<size_t>(tag >> 1);
+    if (!(tag & 1)) {
+      out->append(p, size);
+      p += size;
+      continue;
+    }
+    uint64_t value = GetVarint(&p);
+    const size_t end = out->size() + size;
+    out->resize(end);
+    for (size_t pos = end; pos-- > end - size;) {
+      (*out)[pos] = static_cast<char>('0' + value % 10);
+      value /= 10;
+    }
+  }
+}
+
+bool ExactCents(double price, int32_t* cents) {
+  if (!std::isfinite(price) || std::fabs(price) > 2e7) return false;
+  const int64_t rounded = std::llround(price * 100);
+  if (static_cast<double>(rounded) / 100 != price || rounded == kOddPrice) {
+    return false;
+  }
+  *cents = static_cast<int32_t>(rounded);
+  return true;
+}
+
+// Оцінка вузла unordered_map: ключ, значення, next і хеш плюс кошик.
+template <typename K, typename V>
+uint64_t MapBytes(const std::unordered_map<K, V>& map) {
+  return map.size() * (sizeof(K) + sizeof(V) + 2 * sizeof(void*)) +
+         map.bucket_count() * sizeof(void*);
+}
+
+uint64_t StringBytes(const std::string& s) {
+  return sizeof(std::string) + (s.capacity() > 15 ? s.capacity() + 1 : 0);
+}
+
+}  // namespace
+
+// ---- Builder ----
+
+bool CompactCatalogue::Builder::Add(const CatalogueRecord& record) {
+  const uint32_t row = static_cast<uint32_t>(created_.size());
+  if (names_.size() + record.name.size() > UINT32_MAX ||
+      tails_.size() + record.article.size() + record.barcodes.size() +
+              record.description.size() + 32 >
+          UINT32_MAX) {
+    return false;
+  }
+
+  uint16_t unit;
+  auto key = std::make_pair(record.unit_guid, record.unit_name);
+  auto it = unit_index_.find(key);
+  if (it != unit_index_.end()) {
+    unit = it->second;
+  } else {
+    if (unit_table_.size() > UINT16_MAX) return false;
+    unit = static_cast<uint16_t>(unit_table_.size());
+    unit_table_.push_back(key);
+    unit_index_.emplace(std::move(key), unit);
+  }
+
+  uint32_t parent = 0;
+  if (record.has_parent) {
+    auto inserted = parent_index_.emplace(
+        record.parent_guid, static_cast<uint32_t>(parent_table_.size() + 1));
+    if (inserted.second) parent_table_.push_back(record.parent_guid);
+    parent = inserted.first->second;
+  }
+
+  uint8_t flags = 0;
+  if (record.is_folder) flags |= kFolder;
+  if (record.created_at_utc) flags |= kUtc;
+  const size_t guid_at = guids_.size();
+  guids_.resize(guid_at + 16);
+  if (!PackGuid(record.guid, &guids_[guid_at])) {
+    std::memset(&guids_[guid_at], 0, 16);
+    text_guids_.emplace(row, record.guid);
+    flags |= kTextGuid;
+  }
+
+  if (name_offsets_.empty()) name_offsets_.push_back(0);
+  names_.append(record.name);
+  name_offsets_.push_back(static_cast<uint32_t>(names_.size()));
+
+  if (tail_offsets_.empty()) tail_offsets_.push_back(0);
+  PutVarint(record.article.size(), &tails_);
+  tails_.append(record.article);
+  PutBarcodes(record.barcodes, &tails_);
+  if (record.has_description) {
+    PutVarint(record.description.size() + 1, &tails_);
+    tails_.append(record.description);
+  } else {
+    PutVarint(0, &tails_);
+  }
+  tail_offsets_.push_back(static_cast<uint32_t>(tails_.size()));
+
+  int32_t cents;
+  if (!ExactCents(record.price, &cents)) {
+    cents = kOddPrice;
+    odd_prices_.emplace(row, record.price);
+  }
+  prices_.push_back(cents);
+  units_.push_back(unit);
+  parents_.push_back(parent);
+  flags_.push_back(flags);
+  created_.push_back(record.created_at_us);
+  return true;
+}
+
+std::unique_ptr<CompactCatalogue> CompactCatalogue::Builder::Finish() {
+  const uint32_t rows = static_cast<uint32_t>(created_.size());
+  auto name_of = [this](uint32_t row) {
+    return std::string_view(names_).substr(
+        name_offsets_[row], name_offsets_[row + 1] - name_offsets_[row]);
+  };
+  std::vector<uint32_t> order(rows);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+    const int c = name_of(a).compare(name_of(b));
+    if (c != 0) return c < 0;
+    const int g = std::memcmp(&guids_[a * 16ull], &guids_[b * 16ull], 16);
+    return g != 0 ? g < 0 : a < b;
+  });
+
+  std::unique_ptr<CompactCatalogue> out(new CompactCatalogue());
+  out->guids_.resize(rows * 16ull);
+  out->name_blocks_.reserve((rows + kNameBlock - 1) / kNameBlock);
+  out->tails_.reserve(tails_.size());
+  out->tail_offsets_.reserve(rows);
+  out->units_.reserve(rows);
+  out->parents_.reserve(rows);
+  out->flags_.reserve(rows);
+  out->prices_.reserve(rows);
+  out->created_.reserve(rows);
+
+  std::string_view previous;
+  for (uint32_t row = 0; row < rows; row++) {
+    const uint32_t from = order[row];
+    std::memcpy(&out->guids_[row * 16ull], &guids_[from * 16ull], 16);
+    if (flags_[from] & kTextGuid) {
+      out->text_guids_.emplace(row, std::move(text_guids_[from]));
+    }
+
+    const std::string_view name = name_of(from);
+    size_t shared = 0;
+    if (row % kNameBlock == 0) {
+      out->name_blocks_.push_back(static_cast<uint32_t>(out->names_.size()));
+    } else {
+      const size_t limit = std::min(previous.size(), name.size());
+      while (shared < limit && previous[shared] == name[shared]) shared++;
+    }
+    PutVarint(shared, &out->names_);
+    PutVarint(name.size() - shared, &out->names_);
+    out->names_.append(name.substr(shared));
+    previous = name;
+
+    out->tail_offsets_.push_back(static_cast<uint32_t>(out->tails_.size()));
+    out->tails_.append(tails_, tail_offsets_[from],
+                       tail_offsets_[from + 1] - tail_offsets_[from]);
+
+    out->prices_.push_back(prices_[from]);
+    if (prices_[from] == kOddPrice) {
+      out->odd_prices_.emplace(row, odd_prices_[from]);
+    }
+    out->units_.push_back(units_[from]);
+    out->parents_.push_back(parents_[from]);
+    out->flags_.push_back(flags_[from]);
+    out->created_.push_back(created_[from]);
+  }
+
+  out->by_guid_.resize(rows);
+  std::iota(out->by_guid_.begin(), out->by_guid_.end(), 0);
+  const char* guids = out->guids_.data();
+  std::sort(out->by_guid_.begin(), out->by_guid_.end(),
+            [guids](uint32_t a, uint32_t b) {
+              return std::memcmp(guids + a * 16ull, guids + b * 16ull, 16) <
+                     0;
+            });
+
+  out->names_.shrink_to_fit();
+  out->name_blocks_.shrink_to_fit();
+  out->unit_table_ = std::move(unit_table_);
+  out->unit_table_.shrink_to_fit();
+  out->parent_table_ = std::move(parent_table_);
+  out->parent_table_.shrink_to_fit();
+  // Присвоєння порожнього рядка зберегло б ємність, тож проміжні буфери
+  // звільняє лише переміщення.
+  Builder released = std::move(*this);
+  *this = Builder();
+  return out;
+}
+
+// ---- Читання ----
+
+CompactCatalogue::Tail CompactCatalogue::ReadTail(uint32_t row) const {
+  Tail tail;
+  const char* p = tails_.data() + tail_offsets_[row];
+  tail.article = GetBytes(&p);
+  const char* barcodes = p;
+  const uint64_t count = GetVarint(&p);
+  for (uint64_t i = 0; i < count; i++) {
+    const uint64_t tag = GetVarint(&p);
+    if (tag & 1) {
+      GetVarint(&p);
+    } else {
+      p += tag >> 1;
+    }
+  }
+  tail.barcodes = std::string_view(barcodes, p - barcodes);
+  const uint64_t description = GetVarint(&p);
+  if (description > 0) {
+    tail.has_description = true;
+    tail.description = std::string_view(p, description - 1);
+  }
+  return tail;
+}
+
+std::string CompactCatalogue::guid(uint32_t row) const {
+  if (flags_[row] & kTextGuid) return text_guids_.at(row);
+  return UnpackGuid(&guids_[row * 16ull]);
+}
+
+std::string CompactCatalogue::name(uint32_t row) const {
+  const char* p = names_.data() + name_blocks_[row / kNameBlock];
+  std::string out;
+  for (uint32_t i = 0; i <= row % kNameBlock; i++) {
+    const size_t shared = static_cast<size_t>(GetVarint(&p));
+    const std::string_view suffix = GetBytes(&p);
+    out.resize(shared);
+    out.append(suffix);
+  }
+  return out;
+}
+
+std::string_view CompactCatalogue::article(uint32_t row) const {
+  const char* p = tails_.data() + tail_offsets_[row];
+  return GetBytes(&p);
+}
+
+std::string_view CompactCatalogue::unit_name(uint32_t row) const {
+  return unit_table_[units_[row]].second;
+}
+
+std::string_view CompactCatalogue::unit_guid(uint32_t row) const {
+  return unit_table_[units_[row]].first;
+}
+
+bool CompactCatalogue::is_folder(uint32_t row) const {
+  return flags_[row] & kFolder;
+}
+
+bool CompactCatalogue::parent_guid(uint32_t row,
+                                   std::string_view* out) const {
+  if (parents_[row] == 0) return false;
+  *out = parent_table_[parents_[row] - 1];
+  return true;
+}
+
+bool CompactCatalogue::description(uint32_t row,
+                                   std::string_view* out) const {
+  const Tail tail = ReadTail(row);
+  if (tail.has_description) *out = tail.description;
+  return tail.has_description;
+}
+
+std::string CompactCatalogue::barcodes(uint32_t row) const {
+  std::string out;
+  AppendBarcodes(ReadTail(row).barcodes, &out);
+  return out;
+}
+
+double CompactCatalogue::price(uint32_t row) const {
+  if (prices_[row] == kOddPrice) return odd_prices_.at(row);
+  return static_cast<double>(prices_[row]) / 100;
+}
+
+int64_t CompactCatalogue::created_at_us(uint32_t row) const {
+  return created_[row];
+}
+
+bool CompactCatalogue::created_at_utc(uint32_t row) const {
+  return flags_[row] & kUtc;
+}
+
+std::string CompactCatalogue::search_name(uint32_t row) const {
+  CatalogueRecord record;
+  const Tail tail = ReadTail(row);
+  record.article.assign(tail.article);
+  AppendBarcodes(tail.barcodes, &record.barcodes);
+  record.name = name(row);
+  return CatalogueSearchName(record);
+}
+
+CatalogueRecord CompactCatalogue::Record(uint32_t row) const {
+  CatalogueRecord record;
+  record.guid = guid(row);
+  record.created_at_us = created_[row];
+  record.created_at_utc = created_at_utc(row);
+  record.name = name(row);
+  const Tail tail = ReadTail(row);
+  record.article.assign(tail.article);
+  record.unit_name.assign(unit_name(row));
+  record.unit_guid.assign(unit_guid(row));
+  record.is_folder = is_folder(row);
+  std::string_view parent;
+  record.has_parent = parent_guid(row, &parent);
+  record.parent_guid.assign(parent);
+  record.has_description = tail.has_description;
+  record.description.assign(tail.description);
+  AppendBarcodes(tail.barcodes, &record.barcodes);
+  record.price = price(row);
+  return record;
+}
+
+uint32_t CompactCatalogue::FindByGuid(std::string_view guid) const {
+  char packed[16];
+  if (!PackGuid(guid, packed)) {
+    for (const auto& [row, text] : text_guids_) {
+      if (text == guid) return row;
+    }
+    return kNoRow;
+  }
+  auto it = std::lower_bound(
+      by_guid_.begin(), by_guid_.end(), packed,
+      [this](uint32_t row, const char* key) {
+        return std::memcmp(&guids_[row * 16ull], key, 16) < 0;
+      });
+  // Нульові 16 байтів у рядків з текстовим GUID стоять поруч зі
+  // справжнім нульовим GUID — їх пропускаємо.
+  for (; it != by_guid_.end() &&
+         std::memcmp(&guids_[*it * 16ull], packed, 16) == 0;
+       ++it) {
+    if (!(flags_[*it] & kTextGuid)) return *it;
+  }
+  return kNoRow;
+}
+
+CompactCatalogueStats CompactCatalogue::stats() const {
+  CompactCatalogueStats stats;
+  stats.items = size();
+  stats.units = static_cast<uint32_t>(unit_table_.size());
+  stats.parents = static_cast<uint32_t>(parent_table_.size());
+  stats.text_guids = static_cast<uint32_t>(text_guids_.size());
+  stats.guid_bytes = guids_.capacity() + by_guid_.capacity() * 4;
+  for (const auto& entry : text_guids_) {
+    stats.guid_bytes += StringBytes(entry.second);
+  }
+  stats.guid_bytes += MapBytes(text_guids_);
+  stats.name_bytes = names_.capacity() + name_blocks_.capacity() * 4;
+  stats.tail_bytes = tails_.capacity() + tail_offsets_.capacity() * 4;
+  stats.fixed_bytes = units_.capacity() * 2 + parents_.capacity() * 4 +
+                      flags_.capacity() + prices_.capacity() * 4 +
+                      created_.capacity() * 8 + MapBytes(odd_prices_);
+  for (const auto& unit : unit_table_) {
+    stats.intern_bytes += StringBytes(unit.first) + StringBytes(unit.second);
+  }
+  for (const std::string& parent : parent_table_) {
+    stats.intern_bytes += StringBytes(parent);
+  }
+  stats.bytes = sizeof(*this) + stats.guid_bytes + stats.name_bytes +
+                stats.tail_bytes + stats.fixed_bytes + stats.intern_bytes;
+  return stats;
+}
+
+}  // namespace virok
@@ -0,0 +1,142 @@
+#ifndef NATIVE_CATALOGUE_COMPACT_CATALOGUE_H_
+#define NATIVE_CATALOGUE_COMPACT_CATALOGUE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "catalogue/catalogue_codec.h"
+
+namespace virok {
+
+// Розподіл пам'яті компактного каталогу за стовпцями, байтів.
+struct CompactCatalogueStats {
+  uint32_t items = 0;
+  uint32_t units = 0;
+  uint32_t parents = 0;
+  uint32_t text_guids = 0;  // неканонічні GUID, що лежать текстом
+  uint64_t guid_bytes = 0;  // 16 байтів на рядок + перестановка за GUID
+  uint64_t name_bytes = 0;
+  uint64_t tail_bytes = 0;   // артикул, штрихкоди, опис
+  uint64_t fixed_bytes = 0;  // ціна, час, одиниця, батько, ознаки
+  uint64_t intern_bytes = 0;
+  uint64_t bytes = 0;
+};
+
+// Каталог у пам'яті для кас з малим обсягом RAM: замість об'єкта з
+// десятком рядків на товар — стовпці, з яких поля декодуються на запит.
+//
+//   guid        — 16 байтів (канонічний GUID у нижньому регістрі; інші
+//                 лежать текстом окремо);
+//   name        — префіксне кодування блоками по 16 рядків, рядки
+//                 впорядковані за назвою (як ORDER BY name);
+//   unit,parent — словники, на рядок лише індекс;
+//   article, barcodes, description — один суцільний буфер: цифрові
+//                 штрихкоди як числа з довжиною, як у catalogue_codec;
+//   price       — копійки в int32 (неточні ціни — окремо);
+//   search_name — не зберігається, обчислюється з полів.
+//
+// Незмінний після Finish, читання потокобезпечне.
+class CompactCatalogue {
+ public:
+  static constexpr uint32_t kNoRow = UINT32_MAX;
+
+  // Рядки додаються в будь-якому порядку; Finish сортує за назвою.
+  class Builder {
+   public:
+    Builder() = default;
+
+    // false — у каталозі понад 65 535 одиниць виміру (індекс одиниці —
+    // 2 байти на рядок) або понад 4 ГіБ тексту.
+    bool Add(const CatalogueRecord& record);
+    size_t size() const { return created_.size(); }
+
+    std::unique_ptr<CompactCatalogue> Finish();
+
+   private:
+    std::string guids_;
+    std::unordered_map<uint32_t, std::string> text_guids_;
+    std::string names_;
+    std::vector<uint32_t> name_offsets_;  // size() + 1
+    std::string tails_;
+    std::vector<uint32_t> tail_offsets_;
+    std::vector<uint16_t> units_;
+    std::vector<uint32_t> parents_;
+    std::vector<uint8_t> flags_;
+    std::vector<int32_t> prices_;
+    std::unordered_map<uint32_t, double> odd_prices_;
+    std::vector<int64_t> created_;
+
+    std::map<std::pair<std::string, std::string>, uint16_t> unit_index_;
+    std::vector<std::pair<std::string, std::string>> unit_table_;
+    std::unordered_map<std::string, uint32_t> parent_index_;
+    std::vector<std::string> parent_table_;
+  };
+
+  CompactCatalogue(const CompactCatalogue&) = delete;
+  CompactCatalogue& operator=(const CompactCatalogue&) = delete;
+
+  uint32_t size() const { return static_cast<uint32_t>(created_.size()); }
+  // Пам'ять усіх стовпців і словників.
+  uint64_t bytes() const { return stats().bytes; }
+  CompactCatalogueStats stats() const;
+
+  std::string guid(uint32_t row) const;
+  std::string name(uint32_t row) const;
+  std::string_view article(uint32_t row) const;
+  std::string_view unit_name(uint32_t row) const;
+  std::string_view unit_guid(uint32_t row) const;
+  bool is_folder(uint32_t row) const;
+  // false — кореневий рядок (parent_guid IS NULL).
+  bool parent_guid(uint32_t row, std::string_view* out) const;
+  // false — опису немає (description IS NULL).
+  bool description(uint32_t row, std::string_view* out) const;
+  std::string barcodes(uint32_t row) const;
+  double price(uint32_t row) const;
+  int64_t created_at_us(uint32_t row) const;
+  bool created_at_utc(uint32_t row) const;
+  std::string search_name(uint32_t row) const;
+
+  CatalogueRecord Record(uint32_t row) const;
+
+  // Рядок за GUID (двійковий пошук) або kNoRow.
+  uint32_t FindByGuid(std::string_view guid) const;
+
+ private:
+  struct Tail {
+    std::string_view article;
+    std::string_view barcodes;  // упаковані
+    bool has_description = false;
+    std::string_view description;
+  };
+
+  CompactCatalogue() = default;
+  Tail ReadTail(uint32_t row) const;
+
+  std::string guids_;  // 16 байтів на рядок
+  std::vector<uint32_t> by_guid_;
+  std::unordered_map<uint32_t, std::string> text_guids_;
+  std::string names_;
+  std::vector<uint32_t> name_blocks_;
+  std::string tails_;
+  std::vector<uint32_t> tail_offsets_;
+  std::vector<uint16_t> units_;
+  std::vector<uint32_t> parents_;  // 0 — немає, інакше індекс + 1
+  std::vector<uint8_t> flags_;
+  std::vector<int32_t> prices_;
+  std::unordered_map<uint32_t, double> odd_prices_;
+  std::vector<int64_t> created_;
+
+  std::vector<std::pair<std::string, std::string>> unit_table_;  // guid, назва
+  std::vector<std::string> parent_table_;
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_CATALOGUE_COMPACT_CATALOGUE_H_
@@ -0,0 +1,345 @@
+#include "catalogue/shared_catalogue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+#include "archive/crc32.h"
+#include "metrics/metrics.h"
+#include "trace/trace.h"
+
+namespace virok {
+
+namespace {
+
+constexpr uint32_t kMagic = 0x564B4347;  // "VKCG"
+constexpr uint32_t kLayout = 1;
+constexpr uint64_t kFormat = static_cast<uint64_t>(kMagic) << 32 | kLayout;
+
+size_t Align8(size_t n) { return (n + 7) & ~static_cast<size_t>(7); }
+
+struct GuidPrefix {
+  uint64_t prefix;
+  uint32_t row;
+};
+
+// Перші 8 байтів у порядку порівняння рядків (доповнені нулями).
+uint64_t Prefix(const std::string& s) {
+  uint64_t prefix = 0;
+  for (size_t i = 0; i < 8; i++) {
+    const uint8_t c = i < s.size() ? static_cast<uint8_t>(s[i]) : 0;
+    prefix = prefix << 8 | c;
+  }
+  return prefix;
+}
+
+}  // namespace
+
+// Зміщення — від початку області; стовпці — count + 1 зміщень uint32 у
+// свій буфер, by_guid — count номерів рядків за зростанням GUID.
+struct CatalogueGeneration::Header {
+  uint32_t magic;
+  uint32_t layout;
+  uint64_t generation;
+  uint64_t version;
+  uint64_t total_size;
+  uint32_t row_count;
+  uint32_t crc;  // CRC-32 усього після заголовка
+  uint64_t guid_offsets;
+  uint64_t guid_blob;
+  uint64_t key_offsets;
+  uint64_t key_blob;
+  uint64_t by_guid;
+};
+
+uint64_t CatalogueGeneration::generation() const {
+  return header_->generation;
+}
+
+uint64_t CatalogueGeneration::version() const { return header_->version; }
+
+uint32_t CatalogueGeneration::size() const { return header_->row_count; }
+
+size_t CatalogueGeneration::bytes() const {
+  return static_cast<size_t>(header_->total_size);
+}
+
+std::string_view CatalogueGeneration::guid(uint32_t row) const {
+  const auto* offsets =
+      reinterpret_cast<const uint32_t*>(base_ + header_->guid_offsets);
+  return std::string_view(base_ + header_->guid_blob + offsets[row],
+                          offsets[row + 1] - offsets[row]);
+}
+
+std::string_view CatalogueGeneration::search_key(uint32_t row) const {
+  const auto* offsets =
+      reinterpret_cast<const uint32_t*>(base_ + header_->key_offsets);
+  return std::string_view(base_ + header_->key_blob + offsets[row],
+                          offsets[row + 1] - offsets[row]);
+}
+
+uint32_t CatalogueGeneration::FindByGuid(std::string_view guid) const {
+  const auto* rows =
+      reinterpret_cast<const uint32_t*>(base_ + header_->by_guid);
+  const uint32_t* const end = rows + header_->row_count;
+  const uint32_t* it = std::lower_bound(
+      rows, end, guid,
+      [this](uint32_t row, std::string_view g) { return this->guid(row) < g; });
+  return it != end && this->guid(*it) == guid ? *it : kNoRow;
+}
+
+SearchIndexView CatalogueGeneration::search_view() const {
+  SearchIndexView view;
+  view.count = header_->row_count;
+  view.ids = base_ + header_->guid_blob;
+  view.id_offsets =
+      reinterpret_cast<const uint32_t*>(base_ + header_->guid_offsets);
+  view.keys = base_ + header_->key_blob;
+  view.key_offsets =
+      reinterpret_cast<const uint32_t*>(base_ + header_->key_offsets);
+  return view;
+}
+
+bool CatalogueGeneration::Attach(bool verify_crc, std::string* error) {
+  base_ = static_cast<const char*>(memory_.data());
+  const size_t size = memory_.size();
+  const auto* header = reinterpret_cast<const Header*>(base_);
+  if (size < sizeof(Header) || header->magic != kMagic) {
+    *error = "not a catalogue generation";
+    return false;
+  }
+  if (header->layout != kLayout) {
+    *error = "unsupported catalogue layout " + std::to_string(header->layout);
+    return false;
+  }
+  const uint64_t total = header->total_size;
+  const uint64_t n = header->row_count;
+  const uint64_t column = (n + 1) * sizeof(uint32_t);
+  if (total > size || header->guid_offsets + column > total ||
+      header->key_offsets + column > total ||
+      header->by_guid + n * sizeof(uint32_t) > total) {
+    *error = "catalogue generation is truncated";
+    return false;
+  }
+  const auto* guid_offsets =
+      reinterpret_cast<const uint32_t*>(base_ + header->guid_offsets);
+  const auto* key_offsets =
+      reinterpret_cast<const uint32_t*>(base_ + header->key_offsets);
+  if (header->guid_blob + guid_offsets[n] > total ||
+      header->key_blob + key_offsets[n] > total) {
+    *error = "catalogue generation is truncated";
+    return false;
+  }
+  if (verify_crc && Crc32(base_ + sizeof(Header), total - sizeof(Header)) !=
+                        header->crc) {
+    *error = "catalogue generation checksum mismatch";
+    return false;
+  }
+  header_ = header;
+  return true;
+}
+
+SharedCatalogue::SharedCatalogue(std::string name) : name_(std::move(name)) {}
+
+SharedCatalogue::~SharedCatalogue() { Close(); }
+
+bool SharedCatalogue::Open(std::string* error) {
+  Close();
+  if (!control_memory_.OpenOrCreate(name_, sizeof(SharedCatalogueControl))) {
+    *error = "cannot open shared catalogue " + name_;
+    return false;
+  }
+  auto* control = static_cast<SharedCatalogueControl*>(control_memory_.data());
+  // Нульову область розмічає перший, хто її побачив.
+  uint64_t format = 0;
+  control->format.compare_exchange_strong(format, kFormat);
+  if (control->format.load() != kFormat) {
+    *error = "shared catalogue " + name_ + " has an incompatible layout";
+    control_memory_.Close();
+    return false;
+  }
+  control_ = control;
+  return true;
+}
+
+void SharedCatalogue::Close() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  current_.reset();
+  own_.reset();
+  control_ = nullptr;
+  control_memory_.Close();
+}
+
+std::string SharedCatalogue::SegmentName(uint64_t generation) const {
+  return name_ + "-g" + std::to_string(generation);
+}
+
+bool SharedCatalogue::Publish(const std::vector<std::string>& guids,
+                              const std::vector<std::string>& keys,
+                              uint64_t version, bool* published,
+                              std::string* error) {
+  VIROK_TRACE_SCOPE("catalogue", "publish");
+  const auto start = std::chrono::steady_clock::now();
+  *published = false;
+  if (control_ == nullptr) {
+    *error = "shared catalogue is not open";
+    return false;
+  }
+  const std::shared_ptr<const CatalogueGeneration> current = Current();
+  if (current && current->version() >= version) return true;
+
+  const size_t count = std::min(guids.size(), keys.size());
+  size_t guid_bytes = 0;
+  size_t key_bytes = 0;
+  for (size_t i = 0; i < count; i++) {
+    guid_bytes += guids[i].size();
+    key_bytes += keys[i].size();
+  }
+  if (count >= UINT32_MAX || guid_bytes > UINT32_MAX ||
+      key_bytes > UINT32_MAX) {
+    *error = "catalogue is too large for a shared generation";
+    return false;
+  }
+
+  const size_t column = (count + 1) * sizeof(uint32_t);
+  CatalogueGeneration::Header header = {};
+  header.magic = kMagic;
+  header.layout = kLayout;
+  header.version = version;
+  header.row_count = static_cast<uint32_t>(count);
+  header.guid_offsets = Align8(sizeof(header));
+  header.key_offsets = Align8(header.guid_offsets + column);
+  header.by_guid = Align8(header.key_offsets + column);
+  header.guid_blob = Align8(header.by_guid + count * sizeof(uint32_t));
+  header.key_blob = header.guid_blob + guid_bytes;
+  header.total_size = header.key_blob + key_bytes;
+  header.generation = control_->next.fetch_add(1) + 1;
+
+  const std::string segment = SegmentName(header.generation);
+  std::shared_ptr<CatalogueGeneration> generation(new CatalogueGeneration());
+  SharedMemory& memory = generation->memory_;
+  if (!memory.Create(segment, static_cast<size_t>(header.total_size))) {
+    *error = "cannot create " + segment;
+    return false;
+  }
+  char* const base = static_cast<char*>(memory.data());
+  auto* guid_offsets = reinterpret_cast<uint32_t*>(base + header.guid_offsets);
+  auto* key_offsets = reinterpret_cast<uint32_t*>(base + header.key_offsets);
+  uint32_t guid_at = 0;
+  uint32_t key_at = 0;
+  for (size_t i = 0; i < count; i++) {
+    guid_offsets[i] = guid_at;
+    key_offsets[i] = key_at;
+    std::copy(guids[i].begin(), guids[i].end(),
+              base + header.guid_blob + guid_at);
+    std::copy(keys[i].begin(), keys[i].end(), base + header.key_blob + key_at);
+    guid_at += static_cast<uint32_t>(guids[i].size());
+    key_at += static_cast<uint32_t>(keys[i].size());
+  }
+  guid_offsets[count] = guid_at;
+  key_offsets[count] = key_at;
+
+  // Сортування за 8-байтовим префіксом (GUID випадкові, тож майже завжди
+  // вирішує він) — удвічі-втричі швидше, ніж порівнювати std::string.
+  std::vector<GuidPrefix> order(count);
+  for (size_t i = 0; i < count; i++) {
+    order[i] = {Prefix(guids[i]), static_cast<uint32_t>(i)};
+  }
+  std::sort(order.begin(), order.end(),
+            [&guids](const GuidPrefix& a, const GuidPrefix& b) {
+              if (a.prefix != b.prefix) return a.prefix < b.prefix;
+              return guids[a.row] < guids[b.row];
+            });
+  auto* by_guid = reinterpret_cast<uint32_t*>(base + header.by_guid);
+  for (size_t i = 0; i < count; i++) by_guid[i] = order[i].row;
+
+  header.crc = Crc32(base + sizeof(header),
+                     static_cast<size_t>(header.total_size) - sizeof(header));
+  std::copy(reinterpret_cast<const char*>(&header),
+            reinterpret_cast<const char*>(&header) + sizeof(header), base);
+  // Ім'я має пережити цей процес: його видалить той, хто замінить
+  // генерацію.
+  memory.Persist();
+  if (!generation->Attach(false, error)) {
+    SharedMemory::Unlink(segment);
+    return false;
+  }
+
+  // Версію |current| уже перевірено вище.
+  const uint64_t checked = current ? current->generation() : 0;
+  uint64_t replaced = control_->generation.load(std::memory_order_acquire);
+  for (;;) {
+    // Поки писали, іншу касу могли синхронізувати свіжіше.
+    if (replaced != 0 && replaced != checked) {
+      const std::shared_ptr<const CatalogueGeneration> other = Map(replaced);
+      if (other && other->version() >= version) {
+        SharedMemory::Unlink(segment);
+        return true;
+      }
+    }
+    if (control_->generation.compare_exchange_weak(
+            replaced, header.generation, std::memory_order_acq_rel,
+            std::memory_order_acquire)) {
+      break;
+    }
+  }
+  if (replaced != 0) SharedMemory::Unlink(SegmentName(replaced));
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!current_ || current_->version() < version) current_ = generation;
+    own_ = generation;
+  }
+  *published = true;
+
+  static Histogram* const latency = MetricsRegistry::Get().GetHistogram(
+      "virok_catalogue_publish_microseconds",
+      "Time to write and publish a shared catalogue generation");
+  latency->Record(std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count());
+  return true;
+}
+
+std::shared_ptr<const CatalogueGeneration> SharedCatalogue::Current() {
+  uint64_t generation;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (control_ == nullptr) return nullptr;
+    generation = control_->generation.load(std::memory_order_acquire);
+    if (generation == 0 ||
+        (current_ && current_->generation() == generation)) {
+      return current_;
+    }
+  }
+  // Відображення з перевіркою CRC — поза м'ютексом: інші потоки тим часом
+  // віддають попередню генерацію. Якщо область уже замінили й видалили,
+  // лишаємося на попередній до наступного виклику.
+  std::shared_ptr<const CatalogueGeneration> next = Map(generation);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (control_ == nullptr) return nullptr;
+  // Кожна публікація замінює лише старішу версію, тож новіша версія —
+  // пізніша генерація, хоч би який потік відобразив її першим.
+  if (next && (!current_ || current_->version() < next->version())) {
+    current_ = std::move(next);
+    static Counter* const swaps = MetricsRegistry::Get().GetCounter(
+        "virok_catalogue_generation_swaps_total",
+        "Switches to a newer shared catalogue generation");
+    swaps->Add();
+  }
+  return current_;
+}
+
+std::shared_ptr<const CatalogueGeneration> SharedCatalogue::Map(
+    uint64_t generation) {
+  VIROK_TRACE_SCOPE("catalogue", "map generation");
+  std::shared_ptr<CatalogueGeneration> mapped(new CatalogueGeneration());
+  if (!mapped->memory_.OpenReadOnly(SegmentName(generation))) return nullptr;
+  std::string error;
+  if (!mapped->Attach(true, &error) || mapped->generation() != generation) {
+    return nullptr;
+  }
+  return mapped;
+}
+
+}  // namespace virok
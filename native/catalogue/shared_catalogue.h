@@ -0,0 +1,126 @@
+#ifndef NATIVE_CATALOGUE_SHARED_CATALOGUE_H_
+#define NATIVE_CATALOGUE_SHARED_CATALOGUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ipc/shared_memory.h"
+#include "search/search_index.h"
+
+namespace virok {
+
+// Керуюча область каталогу: номер опублікованої генерації. Нулі —
+// коректний початковий стан (генерацій ще немає).
+struct SharedCatalogueControl {
+  std::atomic<uint64_t> format;      // kMagic << 32 | kLayout
+  std::atomic<uint64_t> generation;  // опублікована генерація, 0 — немає
+  std::atomic<uint64_t> next;        // останній виданий номер генерації
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "catalogue control is shared between processes");
+
+// Одна опублікована генерація каталогу, відображена лише для читання.
+// Незмінна: після синхронізації публікується нова генерація, а стара
+// живе, доки її тримає хоча б один shared_ptr (сесія пошуку, індекс).
+class CatalogueGeneration {
+ public:
+  static constexpr uint32_t kNoRow = UINT32_MAX;
+
+  CatalogueGeneration(const CatalogueGeneration&) = delete;
+  CatalogueGeneration& operator=(const CatalogueGeneration&) = delete;
+
+  uint64_t generation() const;
+  // Версія даних від видавця (час синхронізації, мс).
+  uint64_t version() const;
+  uint32_t size() const;
+  // Розмір області генерації в байтах.
+  size_t bytes() const;
+
+  std::string_view guid(uint32_t row) const;
+  std::string_view search_key(uint32_t row) const;
+  // Рядок за GUID (двійковий пошук) або kNoRow.
+  uint32_t FindByGuid(std::string_view guid) const;
+
+  // Буфери для SearchIndex без копіювання:
+  //   std::make_shared<const SearchIndex>(g->search_view(), g)
+  SearchIndexView search_view() const;
+
+ private:
+  friend class SharedCatalogue;
+  struct Header;
+
+  CatalogueGeneration() = default;
+  // Перевіряє заголовок (і CRC-32 вмісту) відображеної області.
+  bool Attach(bool verify_crc, std::string* error);
+
+  SharedMemory memory_;
+  const Header* header_ = nullptr;
+  const char* base_ = nullptr;
+};
+
+// Каталог у спільній пам'яті для кількох кас на одній машині (раннер
+// запускається з G_APPLICATION_NON_UNIQUE, кожна каса — окремий процес).
+//
+// Кожна генерація — окрема незмінна область <name>-g<N>: рядки в порядку
+// відображення (ORDER BY name), стовпці GUID і ключа пошуку як суцільні
+// буфери зі зміщеннями (той самий формат, що й у SearchIndex), плюс
+// перестановка рядків за GUID. Керуюча область <name> тримає лише номер
+// поточної генерації.
+//
+// Публікує будь-яка каса після синхронізації: якщо її версія даних
+// новіша за поточну, вона пише нову область і CAS-ом перемикає номер.
+// Решта кас бачать новий номер при наступному Current() і атомарно
+// переходять на нову генерацію; старе відображення лишається дійсним,
+// доки його тримають. Ім'я старої області видаляє той, хто її замінив.
+//
+// Потокобезпечний.
+class SharedCatalogue {
+ public:
+  explicit SharedCatalogue(std::string name = "virok-catalogue");
+  ~SharedCatalogue();
+
+  SharedCatalogue(const SharedCatalogue&) = delete;
+  SharedCatalogue& operator=(const SharedCatalogue&) = delete;
+
+  // Відкриває (створює) керуючу область.
+  bool Open(std::string* error);
+  void Close();
+
+  // Публікує каталог версії |version|, якщо опублікована генерація
+  // старша. |*published| — false, якщо інша каса вже опублікувала ту саму
+  // або новішу версію (тоді Current() віддасть її).
+  bool Publish(const std::vector<std::string>& guids,
+               const std::vector<std::string>& keys, uint64_t version,
+               bool* published, std::string* error);
+
+  // Поточна генерація або nullptr, якщо нічого не опубліковано (чи
+  // область недоступна). Поки номер не змінився, області генерацій не
+  // відкриваються повторно — дешево викликати перед кожним пошуком.
+  std::shared_ptr<const CatalogueGeneration> Current();
+
+ private:
+  std::string SegmentName(uint64_t generation) const;
+  // Відображає генерацію |generation| (nullptr, якщо її вже немає).
+  std::shared_ptr<const CatalogueGeneration> Map(uint64_t generation);
+
+  const std::string name_;
+  SharedMemory control_memory_;
+  SharedCatalogueControl* control_ = nullptr;
+
+  std::mutex mutex_;
+  std::shared_ptr<const CatalogueGeneration> current_;
+  // Генерація, яку опублікувала ця каса: на Windows область живе, доки
+  // відкрита хоча б в одному процесі, тож видавець тримає її сам.
+  std::shared_ptr<const CatalogueGeneration> own_;
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_CATALOGUE_SHARED_CATALOGUE_H_
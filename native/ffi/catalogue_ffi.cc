@@ -0,0 +1,119 @@
+#include "ffi/catalogue_ffi.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "catalogue/compact_catalogue.h"
+#include "ffi/store_handle.h"
+#include "store/catalogue_import.h"
+
+struct VirokCatalogue {
+  std::unique_ptr<virok::CompactCatalogue> catalogue;
+};
+
+namespace {
+
+using virok::CompactCatalogue;
+
+char* CopyOut(const std::string& text) {
+  char* out = static_cast<char*>(std::malloc(text.size() + 1));
+  if (out) std::memcpy(out, text.c_str(), text.size() + 1);
+  return out;
+}
+
+bool ValidRow(const VirokCatalogue* catalogue, int64_t row) {
+  return catalogue && row >= 0 && row < catalogue->catalogue->size();
+}
+
+int32_t CopyText(std::string_view text, uint8_t* out, int32_t capacity) {
+  if (text.size() > INT32_MAX) return -1;
+  const int32_t size = static_cast<int32_t>(text.size());
+  if (size <= capacity && out) std::memcpy(out, text.data(), text.size());
+  return size;
+}
+
+}  // namespace
+
+VirokCatalogue* virok_catalogue_load(VirokStore* store, char** error) {
+  std::string message;
+  std::unique_ptr<CompactCatalogue> catalogue;
+  if (store) {
+    catalogue = virok::LoadCompactCatalogue(&store->store, &message);
+  } else {
+    message = "invalid arguments";
+  }
+  if (!catalogue) {
+    if (error) *error = CopyOut(message);
+    return nullptr;
+  }
+  return new VirokCatalogue{std::move(catalogue)};
+}
+
+int64_t virok_catalogue_size(const VirokCatalogue* catalogue) {
+  return catalogue ? catalogue->catalogue->size() : 0;
+}
+
+int64_t virok_catalogue_bytes(const VirokCatalogue* catalogue) {
+  return catalogue ? static_cast<int64_t>(catalogue->catalogue->bytes()) : 0;
+}
+
+int32_t virok_catalogue_text(const VirokCatalogue* catalogue, int64_t row,
+                             int32_t field, uint8_t* out, int32_t capacity) {
+  if (!ValidRow(catalogue, row)) return -1;
+  const CompactCatalogue& c = *catalogue->catalogue;
+  const uint32_t r = static_cast<uint32_t>(row);
+  std::string_view view;
+  switch (field) {
+    case kVirokCatalogueGuid:
+      return CopyText(c.guid(r), out, capacity);
+    case kVirokCatalogueName:
+      return CopyText(c.name(r), out, capacity);
+    case kVirokCatalogueArticle:
+      return CopyText(c.article(r), out, capacity);
+    case kVirokCatalogueUnitName:
+      return CopyText(c.unit_name(r), out, capacity);
+    case kVirokCatalogueUnitGuid:
+      return CopyText(c.unit_guid(r), out, capacity);
+    case kVirokCatalogueParentGuid:
+      return c.parent_guid(r, &view) ? CopyText(view, out, capacity) : -1;
+    case kVirokCatalogueDescription:
+      return c.description(r, &view) ? CopyText(view, out, capacity) : -1;
+    case kVirokCatalogueBarcodes:
+      return CopyText(c.barcodes(r), out, capacity);
+    case kVirokCatalogueSearchName:
+      return CopyText(c.search_name(r), out, capacity);
+    default:
+      return -1;
+  }
+}
+
+double virok_catalogue_price(const VirokCatalogue* catalogue, int64_t row) {
+  if (!ValidRow(catalogue, row)) return 0;
+  return catalogue->catalogue->price(static_cast<uint32_t>(row));
+}
+
+int32_t virok_catalogue_is_folder(const VirokCatalogue* catalogue,
+                                  int64_t row) {
+  if (!ValidRow(catalogue, row)) return 0;
+  return catalogue->catalogue->is_folder(static_cast<uint32_t>(row)) ? 1 : 0;
+}
+
+int64_t virok_catalogue_created_at(const VirokCatalogue* catalogue,
+                                   int64_t row, int32_t* utc) {
+  if (!ValidRow(catalogue, row)) return 0;
+  const uint32_t r = static_cast<uint32_t>(row);
+  if (utc) *utc = catalogue->catalogue->created_at_utc(r) ? 1 : 0;
+  return catalogue->catalogue->created_at_us(r);
+}
+
+int64_t virok_catalogue_find(const VirokCatalogue* catalogue,
+                             const char* guid) {
+  if (!catalogue || !guid) return -1;
+  const uint32_t row = catalogue->catalogue->FindByGuid(guid);
+  return row == CompactCatalogue::kNoRow ? -1 : row;
+}
+
+void virok_catalogue_free(VirokCatalogue* catalogue) { delete catalogue; }
@@ -0,0 +1,66 @@
+#ifndef NATIVE_FFI_CATALOGUE_FFI_H_
+#define NATIVE_FFI_CATALOGUE_FFI_H_
+
+#include <cstdint>
+
+#include "ffi/ffi_export.h"
+#include "ffi/store_ffi.h"
+
+// C API компактного каталогу (catalogue/compact_catalogue.h) для dart:ffi.
+//
+// Каталог живе в нативній пам'яті; Dart тримає лише вказівник і читає
+// поля рядка на запит. Після завантаження незмінний: читати можна з
+// будь-якого ізолята, доки не викликано virok_catalogue_free.
+struct VirokCatalogue;
+
+// Текстові поля для virok_catalogue_text.
+enum VirokCatalogueField : int32_t {
+  kVirokCatalogueGuid = 0,
+  kVirokCatalogueName = 1,
+  kVirokCatalogueArticle = 2,
+  kVirokCatalogueUnitName = 3,
+  kVirokCatalogueUnitGuid = 4,
+  kVirokCatalogueParentGuid = 5,
+  kVirokCatalogueDescription = 6,
+  kVirokCatalogueBarcodes = 7,
+  kVirokCatalogueSearchName = 8,
+};
+
+// Будує каталог з таблиці nomenclatura сховища |store| у порядку
+// ORDER BY name. Синхронний (сотні мілісекунд на 100 тис. товарів) —
+// викликати з фонового ізолята. nullptr — помилка, текст у |*error|
+// (звільнити virok_ffi_free).
+VIROK_FFI_EXPORT VirokCatalogue* virok_catalogue_load(VirokStore* store,
+                                                      char** error);
+
+VIROK_FFI_EXPORT int64_t virok_catalogue_size(const VirokCatalogue* catalogue);
+
+// Пам'ять каталогу в байтах.
+VIROK_FFI_EXPORT int64_t virok_catalogue_bytes(
+    const VirokCatalogue* catalogue);
+
+// Поле |field| рядка |row| в UTF-8 у буфер |out| місткістю |capacity|
+// (без нуля в кінці). Повертає довжину; якщо вона більша за |capacity|,
+// нічого не записано і виклик треба повторити з більшим буфером. -1 —
+// NULL (parent_guid, description) або рядка/поля немає.
+VIROK_FFI_EXPORT int32_t virok_catalogue_text(const VirokCatalogue* catalogue,
+                                              int64_t row, int32_t field,
+                                              uint8_t* out, int32_t capacity);
+
+VIROK_FFI_EXPORT double virok_catalogue_price(const VirokCatalogue* catalogue,
+                                              int64_t row);
+VIROK_FFI_EXPORT int32_t virok_catalogue_is_folder(
+    const VirokCatalogue* catalogue, int64_t row);
+
+// created_at у мікросекундах від епохи; |*utc| = 0 — час був без зсуву
+// (місцевий, як DateTime.parse).
+VIROK_FFI_EXPORT int64_t virok_catalogue_created_at(
+    const VirokCatalogue* catalogue, int64_t row, int32_t* utc);
+
+// Рядок за GUID або -1.
+VIROK_FFI_EXPORT int64_t virok_catalogue_find(const VirokCatalogue* catalogue,
+                                              const char* guid);
+
+VIROK_FFI_EXPORT void virok_catalogue_free(VirokCatalogue* catalogue);
+
+#endif  // NATIVE_FFI_CATALOGUE_FFI_H_
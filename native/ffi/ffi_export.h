@@ -0,0 +1,12 @@
+#ifndef NATIVE_FFI_FFI_EXPORT_H_
+#define NATIVE_FFI_FFI_EXPORT_H_
+
+// Функції C API для dart:ffi (бібліотека virok_ffi). Dart знаходить їх за
+// іменем через DynamicLibrary.lookup, тож вони мають бути експортовані.
+#if defined(_WIN32)
+#define VIROK_FFI_EXPORT extern "C" __declspec(dllexport)
+#else
+#define VIROK_FFI_EXPORT extern "C" __attribute__((visibility("default")))
+#endif
+
+#endif  // NATIVE_FFI_FFI_EXPORT_H_
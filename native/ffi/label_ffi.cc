@@ -0,0 +1,71 @@
+#include "ffi/label_ffi.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ffi/store_handle.h"
+#include "printing/label_batch.h"
+#include "store/price_labels.h"
+
+struct VirokPriceSnapshot {
+  virok::PriceSnapshot prices;
+};
+
+namespace {
+
+char* CopyOut(const std::string& text) {
+  char* out = static_cast<char*>(std::malloc(text.size() + 1));
+  if (out) std::memcpy(out, text.c_str(), text.size() + 1);
+  return out;
+}
+
+}  // namespace
+
+VirokPriceSnapshot* virok_prices_snapshot(VirokStore* store, char** error) {
+  std::string message = "invalid arguments";
+  auto snapshot = std::make_unique<VirokPriceSnapshot>();
+  if (store &&
+      virok::SnapshotPrices(&store->store, &snapshot->prices, &message)) {
+    return snapshot.release();
+  }
+  if (error) *error = CopyOut(message);
+  return nullptr;
+}
+
+int64_t virok_prices_snapshot_size(const VirokPriceSnapshot* snapshot) {
+  return snapshot ? static_cast<int64_t>(snapshot->prices.size()) : 0;
+}
+
+void virok_prices_snapshot_free(VirokPriceSnapshot* snapshot) {
+  delete snapshot;
+}
+
+int64_t virok_labels_print_changed(VirokStore* store,
+                                   const VirokPriceSnapshot* before,
+                                   const char* host, int32_t port,
+                                   int32_t width, int32_t copies,
+                                   double* first_label_ms, char** error) {
+  std::string message;
+  std::vector<virok::PriceLabel> labels;
+  if (!store || !before || !host || port <= 0 || port > 65535) {
+    message = "invalid arguments";
+  } else if (virok::ChangedPriceLabels(&store->store, before->prices, &labels,
+                                       &message)) {
+    if (labels.empty()) return 0;
+    virok::LabelTemplate tmpl;
+    if (width > 0) tmpl.width = width;
+    if (copies > 0) tmpl.copies = copies;
+    virok::LabelBatchStats stats;
+    if (virok::PrintLabelBatchTo(host, static_cast<uint16_t>(port), labels,
+                                 tmpl, {}, &stats, &message)) {
+      if (first_label_ms) *first_label_ms = stats.first_label_us / 1000;
+      return static_cast<int64_t>(labels.size());
+    }
+  }
+  if (error) *error = CopyOut(message);
+  return -1;
+}
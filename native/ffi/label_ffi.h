@@ -0,0 +1,36 @@
+#ifndef NATIVE_FFI_LABEL_FFI_H_
+#define NATIVE_FFI_LABEL_FFI_H_
+
+#include <cstdint>
+
+#include "ffi/ffi_export.h"
+#include "ffi/store_ffi.h"
+
+// C API пакетного друку цінників (printing/label_batch.h) для dart:ffi.
+//
+// Перед синхронізацією каталогу знімаються ціни, після неї друкуються
+// цінники товарів, чия ціна змінилась. Обидва виклики синхронні —
+// викликати з фонового ізолята.
+struct VirokPriceSnapshot;
+
+// Ціни товарів сховища |store|. nullptr — помилка, текст у |*error|
+// (звільнити virok_ffi_free).
+VIROK_FFI_EXPORT VirokPriceSnapshot* virok_prices_snapshot(VirokStore* store,
+                                                           char** error);
+
+VIROK_FFI_EXPORT int64_t virok_prices_snapshot_size(
+    const VirokPriceSnapshot* snapshot);
+
+VIROK_FFI_EXPORT void virok_prices_snapshot_free(VirokPriceSnapshot* snapshot);
+
+// Друкує на |host|:|port| (RAW) цінники товарів, ціна яких змінилась
+// після |before|: |width| знаків у рядку (32 — 58 мм, 48 — 80 мм),
+// |copies| примірників. Повертає кількість цінників (0 — змін немає,
+// нічого не надіслано) або -1 — помилка в |*error|. |first_label_ms| —
+// за скільки перший цінник пішов на принтер.
+VIROK_FFI_EXPORT int64_t virok_labels_print_changed(
+    VirokStore* store, const VirokPriceSnapshot* before, const char* host,
+    int32_t port, int32_t width, int32_t copies, double* first_label_ms,
+    char** error);
+
+#endif  // NATIVE_FFI_LABEL_FFI_H_
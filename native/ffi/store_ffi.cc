@@ -0,0 +1,253 @@
+#include "ffi/store_ffi.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "ffi/store_handle.h"
+#include "json/json_reader.h"
+#include "store/catalogue_import.h"
+#include "store/sqlite_store.h"
+
+namespace {
+
+using virok::JsonReader;
+using virok::SqlBatch;
+using virok::SqlResult;
+using virok::SqlValue;
+using Token = JsonReader::Token;
+
+char* CopyOut(const std::string& text) {
+  char* out = static_cast<char*>(std::malloc(text.size() + 1));
+  if (out) std::memcpy(out, text.c_str(), text.size() + 1);
+  return out;
+}
+
+void AppendString(std::string_view s, std::string* out) {
+  out->push_back('"');
+  for (char c : s) {
+    switch (c) {
+      case '"':
+        *out += "\\\"";
+        break;
+      case '\\':
+        *out += "\\\\";
+        break;
+      case '\n':
+        *out += "\\n";
+        break;
+      case '\r':
+        *out += "\\r";
+        break;
+      case '\t':
+        *out += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char buf[8];
+          std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+          *out += buf;
+        } else {
+          out->push_back(c);
+        }
+    }
+  }
+  out->push_back('"');
+}
+
+void AppendValue(const SqlValue& value, std::string* out) {
+  if (const auto* n = std::get_if<int64_t>(&value)) {
+    *out += std::to_string(*n);
+  } else if (const auto* d = std::get_if<double>(&value)) {
+    if (!std::isfinite(*d)) {
+      *out += "null";
+      return;
+    }
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.17g", *d);
+    *out += buf;
+    // Ціле число в REAL-колонці лишається double на боці Dart.
+    if (std::strpbrk(buf, ".eE") == nullptr) *out += ".0";
+  } else if (const auto* s = std::get_if<std::string>(&value)) {
+    AppendString(*s, out);
+  } else {
+    *out += "null";
+  }
+}
+
+std::string ResultJson(const SqlResult& result) {
+  std::string out = "{\"columns\":[";
+  for (size_t i = 0; i < result.columns.size(); i++) {
+    if (i) out.push_back(',');
+    AppendString(result.columns[i], &out);
+  }
+  out += "],\"rows\":[";
+  for (size_t r = 0; r < result.rows.size(); r++) {
+    if (r) out.push_back(',');
+    out.push_back('[');
+    const std::vector<SqlValue>& row = result.rows[r];
+    for (size_t i = 0; i < row.size(); i++) {
+      if (i) out.push_back(',');
+      AppendValue(row[i], &out);
+    }
+    out.push_back(']');
+  }
+  out += "],\"changes\":" + std::to_string(result.changes) + "}";
+  return out;
+}
+
+// Значення після вже прочитаного токена.
+bool ReadValue(JsonReader& reader, Token token, SqlValue* value) {
+  switch (token) {
+    case Token::kString:
+      *value = std::string(reader.text());
+      return true;
+    case Token::kNumber: {
+      const std::string_view text = reader.number_text();
+      if (text.find_first_of(".eE") == std::string_view::npos) {
+        *value = reader.integer();
+      } else {
+        *value = reader.number();
+      }
+      return true;
+    }
+    case Token::kBool:
+      *value = static_cast<int64_t>(reader.boolean() ? 1 : 0);
+      return true;
+    case Token::kNull:
+      *value = std::monostate();
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Масив параметрів; |reader| стоїть перед '['.
+bool ReadParams(JsonReader& reader, std::vector<SqlValue>* params) {
+  if (reader.Next() != Token::kBeginArray) return false;
+  for (;;) {
+    const Token token = reader.Next();
+    if (token == Token::kEndArray) return true;
+    if (!ReadValue(reader, token, &params->emplace_back())) return false;
+  }
+}
+
+bool ParseParams(const char* json, std::vector<SqlValue>* params) {
+  if (!json || !*json) return true;
+  JsonReader reader(json);
+  return ReadParams(reader, params);
+}
+
+bool ParseBatches(const char* json, std::vector<SqlBatch>* batches) {
+  if (!json) return false;
+  JsonReader reader(json);
+  if (reader.Next() != Token::kBeginArray) return false;
+  for (;;) {
+    Token token = reader.Next();
+    if (token == Token::kEndArray) return true;
+    if (token != Token::kBeginObject) return false;
+    SqlBatch& batch = batches->emplace_back();
+    while ((token = reader.Next()) == Token::kKey) {
+      const std::string key(reader.text());
+      if (key == "sql") {
+        if (reader.Next() != Token::kString) return false;
+        batch.sql = std::string(reader.text());
+      } else if (key == "rows") {
+        if (reader.Next() != Token::kBeginArray) return false;
+        for (;;) {
+          token = reader.Next();
+          if (token == Token::kEndArray) break;
+          if (token != Token::kBeginArray) return false;
+          std::vector<SqlValue>& row = batch.rows.emplace_back();
+          while ((token = reader.Next()) != Token::kEndArray) {
+            if (!ReadValue(reader, token, &row.emplace_back())) return false;
+          }
+        }
+      } else {
+        reader.Next();
+        if (!reader.Skip()) return false;
+      }
+    }
+    if (token != Token::kEndObject || batch.sql.empty()) return false;
+  }
+}
+
+virok::SqlCallback Reply(VirokStore* store, int64_t request) {
+  VirokStoreCallback callback = store->callback;
+  return [callback, request](SqlResult result) {
+    if (result.ok) {
+      callback(request, 1, CopyOut(ResultJson(result)));
+    } else {
+      callback(request, 0, CopyOut(result.error));
+    }
+  };
+}
+
+}  // namespace
+
+VirokStore* virok_store_open(const char* path, int32_t readers,
+                             VirokStoreCallback callback, char** error) {
+  auto* store = new VirokStore();
+  store->callback = callback;
+  virok::SqliteStoreOptions options;
+  options.readers = readers < 0 ? 0 : readers;
+  std::string message;
+  if (!callback || !path ||
+      !store->store.Open(path, options, &message)) {
+    if (message.empty()) message = "invalid arguments";
+    if (error) *error = CopyOut(message);
+    delete store;
+    return nullptr;
+  }
+  return store;
+}
+
+void virok_store_read(VirokStore* store, int64_t request, const char* sql,
+                      const char* params_json) {
+  std::vector<SqlValue> params;
+  if (!sql || !ParseParams(params_json, &params)) {
+    store->callback(request, 0, CopyOut("invalid query parameters"));
+    return;
+  }
+  store->store.Read(sql, std::move(params), Reply(store, request));
+}
+
+void virok_store_write(VirokStore* store, int64_t request,
+                       const char* batches_json) {
+  std::vector<SqlBatch> batches;
+  if (!ParseBatches(batches_json, &batches)) {
+    store->callback(request, 0, CopyOut("invalid write batch"));
+    return;
+  }
+  store->store.Write(std::move(batches), Reply(store, request));
+}
+
+void virok_store_import(VirokStore* store, int64_t request,
+                        const uint8_t* data, int64_t size, int32_t replace) {
+  std::vector<SqlBatch> batches;
+  std::string error;
+  if (!data || size < 0 ||
+      !virok::CatalogueImportBatches(
+          std::string_view(reinterpret_cast<const char*>(data),
+                           static_cast<size_t>(size)),
+          replace != 0, &batches, &error)) {
+    store->callback(request, 0,
+                    CopyOut(error.empty() ? "invalid catalogue pack" : error));
+    return;
+  }
+  store->store.Write(std::move(batches), Reply(store, request));
+}
+
+void virok_store_maintain(VirokStore* store, int64_t request,
+                          int32_t vacuum_pages) {
+  store->store.Maintain(vacuum_pages, Reply(store, request));
+}
+
+void virok_store_close(VirokStore* store) { delete store; }
+
+void virok_ffi_free(void* data) { std::free(data); }
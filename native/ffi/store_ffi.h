@@ -0,0 +1,58 @@
+#ifndef NATIVE_FFI_STORE_FFI_H_
+#define NATIVE_FFI_STORE_FFI_H_
+
+#include <cstdint>
+
+#include "ffi/ffi_export.h"
+
+// C API сховища номенклатури (store/sqlite_store.h) для dart:ffi.
+//
+// Усі виклики неблокувальні: запит ставиться в чергу, а результат
+// приходить у |callback| з потоку сховища (на боці Dart —
+// NativeCallable.listener). |json| у колбеку виділено malloc; його
+// звільняє отримувач через virok_ffi_free.
+//
+//   ok = 1: {"columns": [...], "rows": [[...], ...], "changes": n}
+//   ok = 0: текст помилки
+struct VirokStore;
+
+typedef void (*VirokStoreCallback)(int64_t request, int32_t ok, char* json);
+
+// Відкриває базу (WAL, схема номенклатури) з |readers| з'єднаннями для
+// читання. nullptr — помилка, текст у |*error| (звільнити virok_ffi_free).
+VIROK_FFI_EXPORT VirokStore* virok_store_open(const char* path,
+                                              int32_t readers,
+                                              VirokStoreCallback callback,
+                                              char** error);
+
+// SELECT; |params_json| — масив параметрів ("[1, \"a\", null]") або nullptr.
+VIROK_FFI_EXPORT void virok_store_read(VirokStore* store, int64_t request,
+                                       const char* sql,
+                                       const char* params_json);
+
+// Пакет в одній транзакції:
+//   [{"sql": "INSERT ...", "rows": [[...], ...]}, {"sql": "DELETE ..."}]
+VIROK_FFI_EXPORT void virok_store_write(VirokStore* store, int64_t request,
+                                        const char* batches_json);
+
+// Файл каталогу (catalogue/catalogue_codec.h) в одній транзакції, тими
+// самими INSERT OR REPLACE, що й синхронізація з JSON; |replace| = 1 —
+// спершу очистити таблицю. Файл розбирається в потоці викликача (як і
+// virok_store_write), тож |data| можна звільнити одразу після виклику.
+VIROK_FFI_EXPORT void virok_store_import(VirokStore* store, int64_t request,
+                                         const uint8_t* data, int64_t size,
+                                         int32_t replace);
+
+// Обслуговування бази у простої каси: checkpoint WAL, до |vacuum_pages|
+// сторінок incremental_vacuum, PRAGMA optimize. Відповідь — один рядок
+// {wal_frames, checkpointed_frames, freelist_pages}.
+VIROK_FFI_EXPORT void virok_store_maintain(VirokStore* store, int64_t request,
+                                           int32_t vacuum_pages);
+
+// Дочікується поставлених запитів (їх колбеки ще викличуться) і закриває
+// базу.
+VIROK_FFI_EXPORT void virok_store_close(VirokStore* store);
+
+VIROK_FFI_EXPORT void virok_ffi_free(void* data);
+
+#endif  // NATIVE_FFI_STORE_FFI_H_
@@ -0,0 +1,14 @@
+#ifndef NATIVE_FFI_STORE_HANDLE_H_
+#define NATIVE_FFI_STORE_HANDLE_H_
+
+#include "ffi/store_ffi.h"
+#include "store/sqlite_store.h"
+
+// Вміст непрозорого VirokStore — спільний для частин C API, що працюють
+// з тим самим сховищем (store_ffi, catalogue_ffi).
+struct VirokStore {
+  virok::SqliteStore store;
+  VirokStoreCallback callback = nullptr;
+};
+
+#endif  // NATIVE_FFI_STORE_HANDLE_H_
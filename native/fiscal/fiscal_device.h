@@ -0,0 +1,35 @@
+#ifndef NATIVE_FISCAL_FISCAL_DEVICE_H_
+#define NATIVE_FISCAL_FISCAL_DEVICE_H_
+
+#include <map>
+#include <string>
+
+namespace virok {
+
+// Аргументи виклику каналу com.cashalot/api у тому вигляді, в якому їх
+// шле CashalotComService: fiscalNum, jsonGoods, jsonPay, amount ("15,65")...
+using FiscalArgs = std::map<std::string, std::string>;
+
+// Відповідь каналу: {success, jsonVal}, або помилка COM_ERROR, якщо
+// |error| непорожній (див. ComResult у flutter_window.cpp).
+struct FiscalReply {
+  bool success = false;
+  std::string json_val;
+  std::string error;
+};
+
+// Фіскальний пристрій за контрактом каналу com.cashalot/api: назви
+// методів і аргументів ті самі, що в Dart (fiscalizeCheck, payByPaymentCard,
+// printXReport, ...). Дозволяє ганяти той самий сценарій каси проти
+// Cashalot або проти симулятора.
+class FiscalDevice {
+ public:
+  virtual ~FiscalDevice() = default;
+
+  virtual FiscalReply Call(const std::string& method,
+                           const FiscalArgs& args) = 0;
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_FISCAL_FISCAL_DEVICE_H_
@@ -0,0 +1,520 @@
+#include "fiscal/fiscal_host.h"
+
+#include <atomic>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <string_view>
+
+#include "metrics/metrics.h"
+#include "trace/trace.h"
+
+#ifdef __linux__
+#include <signal.h>
+#include <sys/prctl.h>
+#include <unistd.h>
+#endif
+
+namespace virok {
+
+namespace {
+
+// Заголовок області хоста; за ним — кільце запитів і кільце відповідей.
+struct HostRegionHeader {
+  uint32_t magic;
+  uint32_t ring_capacity;
+  std::atomic<uint64_t> heartbeat;  // хост збільшує кожні kHeartbeatPeriod
+};
+
+constexpr uint32_t kRegionMagic = 0x46484F53;  // "FHOS"
+constexpr size_t kHeaderBytes = 4096;
+constexpr auto kHeartbeatPeriod = std::chrono::milliseconds(100);
+// Як часто сторож перевіряє хост, коли відповідей немає.
+constexpr auto kWatchPeriod = std::chrono::milliseconds(100);
+// Не частіше, якщо хост не запускається зовсім.
+constexpr auto kRespawnBackoff = std::chrono::seconds(1);
+
+size_t RegionBytes(size_t ring_capacity) {
+  return kHeaderBytes + 2 * SpscRing::RegionSize(ring_capacity);
+}
+
+void* RequestRing(void* region) {
+  return static_cast<uint8_t*>(region) + kHeaderBytes;
+}
+
+void* ReplyRing(void* region, size_t ring_capacity) {
+  return static_cast<uint8_t*>(region) + kHeaderBytes +
+         SpscRing::RegionSize(ring_capacity);
+}
+
+// --- Формат повідомлень у кільцях ---
+// [u8 тип][u64 id]..., рядки — [u32 довжина][байти].
+
+enum MessageType : uint8_t {
+  kRequest = 1,   // клієнт -> хост: метод і аргументи
+  kStarted = 2,   // хост -> клієнт: виклик пристрою почався
+  kReply = 3,     // хост -> клієнт: відповідь пристрою
+  kShutdown = 4,  // клієнт -> хост: завершитися
+};
+
+void PutU32(uint32_t v, std::string* out) {
+  out->append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+void PutU64(uint64_t v, std::string* out) {
+  out->append(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+void PutString(std::string_view s, std::string* out) {
+  PutU32(static_cast<uint32_t>(s.size()), out);
+  out->append(s.data(), s.size());
+}
+
+void PutHeader(MessageType type, uint64_t id, std::string* out) {
+  out->push_back(static_cast<char>(type));
+  PutU64(id, out);
+}
+
+class WireReader {
+ public:
+  explicit WireReader(std::string_view data) : data_(data) {}
+
+  bool U8(uint8_t* v) { return Raw(v, sizeof(*v)); }
+  bool U32(uint32_t* v) { return Raw(v, sizeof(*v)); }
+  bool U64(uint64_t* v) { return Raw(v, sizeof(*v)); }
+
+  bool String(std::string* s) {
+    uint32_t size;
+    if (!U32(&size) || data_.size() < size) return false;
+    s->assign(data_.data(), size);
+    data_.remove_prefix(size);
+    return true;
+  }
+
+ private:
+  bool Raw(void* v, size_t size) {
+    if (data_.size() < size) return false;
+    std::memcpy(v, data_.data(), size);
+    data_.remove_prefix(size);
+    return true;
+  }
+
+  std::string_view data_;
+};
+
+std::string EncodeRequest(uint64_t id, const std::string& method,
+                          const FiscalArgs& args) {
+  std::string out;
+  PutHeader(kRequest, id, &out);
+  PutString(method, &out);
+  PutU32(static_cast<uint32_t>(args.size()), &out);
+  for (const auto& arg : args) {
+    PutString(arg.first, &out);
+    PutString(arg.second, &out);
+  }
+  return out;
+}
+
+bool DecodeRequest(WireReader* reader, std::string* method, FiscalArgs* args) {
+  uint32_t count;
+  if (!reader->String(method) || !reader->U32(&count)) return false;
+  for (uint32_t i = 0; i < count; i++) {
+    std::string key, value;
+    if (!reader->String(&key) || !reader->String(&value)) return false;
+    (*args)[std::move(key)] = std::move(value);
+  }
+  return true;
+}
+
+std::string EncodeReply(uint64_t id, const FiscalReply& reply) {
+  std::string out;
+  PutHeader(kReply, id, &out);
+  out.push_back(reply.success ? 1 : 0);
+  PutString(reply.json_val, &out);
+  PutString(reply.error, &out);
+  return out;
+}
+
+bool DecodeReply(WireReader* reader, FiscalReply* reply) {
+  uint8_t success;
+  if (!reader->U8(&success)) return false;
+  reply->success = success != 0;
+  return reader->String(&reply->json_val) && reader->String(&reply->error);
+}
+
+FiscalReply HostError(std::string error) {
+  FiscalReply reply;
+  reply.error = std::move(error);
+  return reply;
+}
+
+// Хост: відповідь чекає, доки клієнт звільнить місце в кільці.
+void WriteToClient(SpscRing* ring, const std::string& message) {
+  while (!ring->TryWrite(message.data(), message.size())) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+std::string NewRegionName() {
+  static std::atomic<uint32_t> counter{0};
+  const auto now = std::chrono::steady_clock::now().time_since_epoch();
+  return "virok-fiscal-" +
+         std::to_string(
+             std::chrono::duration_cast<std::chrono::microseconds>(now)
+                 .count()) +
+         "-" + std::to_string(counter.fetch_add(1));
+}
+
+}  // namespace
+
+int RunFiscalHost(const std::string& region, const std::string& fiscal_num,
+                  const FiscalDeviceFactory& factory) {
+#ifdef __linux__
+  // Хост не переживає касу (на Windows це робить job-об'єкт клієнта).
+  prctl(PR_SET_PDEATHSIG, SIGKILL);
+  if (getppid() == 1) return 1;
+#endif
+
+  uint32_t ring_capacity;
+  {
+    SharedMemory header_only;
+    if (!header_only.Open(region, kHeaderBytes)) return 2;
+    const auto* header = static_cast<HostRegionHeader*>(header_only.data());
+    if (header->magic != kRegionMagic) return 2;
+    ring_capacity = header->ring_capacity;
+  }
+  SharedMemory memory;
+  if (!memory.Open(region, RegionBytes(ring_capacity))) return 2;
+  auto* header = static_cast<HostRegionHeader*>(memory.data());
+  SpscRing requests;
+  SpscRing replies;
+  if (!requests.Attach(RequestRing(memory.data()), region + "-req") ||
+      !replies.Attach(ReplyRing(memory.data(), ring_capacity),
+                      region + "-rep")) {
+    return 2;
+  }
+
+  // Серцебиття з окремого потоку: клієнт відрізняє довгий виклик (є
+  // серцебиття, перевіряє call_timeout) від замерзлого процесу.
+  std::atomic<bool> running{true};
+  std::thread heartbeat([&] {
+    while (running.load()) {
+      header->heartbeat.fetch_add(1);
+      std::this_thread::sleep_for(kHeartbeatPeriod);
+    }
+  });
+
+  Tracer::Get().SetThreadName("fiscal host " + fiscal_num);
+  std::unique_ptr<FiscalDevice> device;
+  std::string message;
+  bool shutdown = false;
+  while (!shutdown) {
+    requests.Wait(std::chrono::seconds(1));
+    while (!shutdown && requests.TryRead(&message)) {
+      WireReader reader(message);
+      uint8_t type;
+      uint64_t id;
+      if (!reader.U8(&type)) continue;
+      if (type == kShutdown) {
+        shutdown = true;
+        break;
+      }
+      std::string method;
+      FiscalArgs args;
+      if (type != kRequest || !reader.U64(&id) ||
+          !DecodeRequest(&reader, &method, &args)) {
+        continue;
+      }
+
+      // Спершу "почато", потім виклик: клієнт знає, що запит без цієї
+      // позначки пристрій не бачив і його можна повторити.
+      std::string started;
+      PutHeader(kStarted, id, &started);
+      WriteToClient(&replies, started);
+
+      if (!device) device = factory(fiscal_num);
+      FiscalReply reply = device ? device->Call(method, args)
+                                 : HostError("Fiscal device is not available");
+      std::string encoded = EncodeReply(id, reply);
+      if (encoded.size() > replies.capacity() / 2) {
+        encoded = EncodeReply(id, HostError("Fiscal reply is too large"));
+      }
+      WriteToClient(&replies, encoded);
+    }
+  }
+
+  device.reset();
+  running = false;
+  heartbeat.join();
+  return 0;
+}
+
+FiscalHostClient::FiscalHostClient(std::string fiscal_num,
+                                   FiscalHostOptions options)
+    : fiscal_num_(std::move(fiscal_num)), options_(std::move(options)) {}
+
+FiscalHostClient::~FiscalHostClient() {
+  if (!thread_.joinable()) return;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+    std::string shutdown(1, static_cast<char>(kShutdown));
+    requests_.TryWrite(shutdown.data(), shutdown.size());
+  }
+  replies_.Ring();
+  thread_.join();
+
+  // Хост закриває пристрій сам (Release COM-об'єкта); недовго чекаємо.
+  for (int i = 0; i < 100 && host_.Running(); i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  host_.Kill();
+
+  std::map<uint64_t, Pending> journal;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    journal.swap(journal_);
+  }
+  for (auto& entry : journal) {
+    entry.second.done(HostError("Fiscal host is closed"));
+  }
+}
+
+bool FiscalHostClient::Start() {
+  const std::string name = NewRegionName();
+  if (!region_.Create(name, RegionBytes(options_.ring_capacity))) return false;
+  auto* header = new (region_.data()) HostRegionHeader();
+  header->magic = kRegionMagic;
+  header->ring_capacity = static_cast<uint32_t>(options_.ring_capacity);
+  if (!requests_.Init(RequestRing(region_.data()), options_.ring_capacity,
+                      name + "-req") ||
+      !replies_.Init(ReplyRing(region_.data(), options_.ring_capacity),
+                     options_.ring_capacity, name + "-rep")) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (options_.startup_calls) {
+    for (auto& call : options_.startup_calls()) {
+      const uint64_t id =
+          EnqueueLocked(std::move(call.first), call.second, [](FiscalReply) {});
+      journal_[id].startup = true;
+    }
+  }
+  FlushLocked();
+  if (!SpawnLocked()) return false;
+  thread_ = std::thread(&FiscalHostClient::Loop, this);
+  return true;
+}
+
+void FiscalHostClient::Submit(std::string method, FiscalArgs args,
+                              FiscalCallback done) {
+  std::string error = "Fiscal host is not running";
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (thread_.joinable() && !stop_) {
+      const uint64_t id = EnqueueLocked(std::move(method), args, done);
+      if (journal_[id].request.size() <= requests_.capacity() / 2) {
+        FlushLocked();
+        return;
+      }
+      journal_.erase(id);
+      error = "Fiscal request is too large";
+    }
+  }
+  // Поза м'ютексом: колбек може одразу надіслати наступний запит.
+  done(HostError(error));
+}
+
+FiscalReply FiscalHostClient::Call(const std::string& method,
+                                   const FiscalArgs& args) {
+  std::promise<FiscalReply> promise;
+  std::future<FiscalReply> reply = promise.get_future();
+  Submit(method, args,
+         [&promise](FiscalReply r) { promise.set_value(std::move(r)); });
+  return reply.get();
+}
+
+int FiscalHostClient::restarts() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return restarts_;
+}
+
+int FiscalHostClient::host_pid() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return host_.pid();
+}
+
+bool FiscalHostClient::SpawnLocked() {
+  std::vector<std::string> args = {kFiscalHostFlag, region_.name(),
+                                   fiscal_num_};
+  args.insert(args.end(), options_.extra_args.begin(),
+              options_.extra_args.end());
+  const auto* header = static_cast<HostRegionHeader*>(region_.data());
+  last_beat_ = header->heartbeat.load();
+  last_beat_at_ = spawned_at_ = Clock::now();
+  spawn_failed_ = !host_.Start(options_.executable.empty()
+                                   ? ChildProcess::SelfPath()
+                                   : options_.executable,
+                               args);
+  return !spawn_failed_;
+}
+
+uint64_t FiscalHostClient::EnqueueLocked(std::string method,
+                                         const FiscalArgs& args,
+                                         FiscalCallback done) {
+  const uint64_t id = ++next_id_;
+  Pending& pending = journal_[id];
+  pending.request = EncodeRequest(id, method, args);
+  pending.method = std::move(method);
+  pending.done = std::move(done);
+  return id;
+}
+
+void FiscalHostClient::FlushLocked() {
+  // Запити йдуть у кільце строго за порядком id, налаштування — перед
+  // усіма; що не вмістилося — допише сторож, коли хост звільнить місце.
+  for (const bool startup : {true, false}) {
+    for (auto& entry : journal_) {
+      Pending& pending = entry.second;
+      if (pending.sent || pending.startup != startup) continue;
+      if (!requests_.TryWrite(pending.request.data(),
+                              pending.request.size())) {
+        return;
+      }
+      pending.sent = true;
+    }
+  }
+}
+
+void FiscalHostClient::Loop() {
+  Tracer::Get().SetThreadName("fiscal ipc " + fiscal_num_);
+  std::vector<std::pair<FiscalCallback, FiscalReply>> done;
+  for (;;) {
+    replies_.Wait(kWatchPeriod);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stop_) return;
+      DrainRepliesLocked(&done);
+      FlushLocked();
+      const char* reason;
+      if (!HostHealthyLocked(&reason)) RestartLocked(reason, &done);
+    }
+    for (auto& reply : done) reply.first(std::move(reply.second));
+    done.clear();
+  }
+}
+
+void FiscalHostClient::DrainRepliesLocked(
+    std::vector<std::pair<FiscalCallback, FiscalReply>>* done) {
+  std::string message;
+  while (replies_.TryRead(&message)) {
+    WireReader reader(message);
+    uint8_t type;
+    uint64_t id;
+    if (!reader.U8(&type) || !reader.U64(&id)) continue;
+    auto it = journal_.find(id);
+    if (it == journal_.end()) continue;
+    if (type == kStarted) {
+      it->second.started = true;
+      it->second.started_at = Clock::now();
+    } else if (type == kReply) {
+      FiscalReply reply;
+      if (!DecodeReply(&reader, &reply)) {
+        reply = HostError("Malformed fiscal host reply");
+      }
+      done->emplace_back(std::move(it->second.done), std::move(reply));
+      journal_.erase(it);
+    }
+  }
+}
+
+bool FiscalHostClient::HostHealthyLocked(const char** reason) {
+  const auto now = Clock::now();
+  if (spawn_failed_) {
+    *reason = "spawn";
+    return now - spawned_at_ < kRespawnBackoff;
+  }
+  if (!host_.Running()) {
+    *reason = "exited";
+    return false;
+  }
+  const auto* header = static_cast<HostRegionHeader*>(region_.data());
+  const uint64_t beat = header->heartbeat.load();
+  if (beat != last_beat_) {
+    last_beat_ = beat;
+    last_beat_at_ = now;
+  } else if (now - last_beat_at_ > options_.heartbeat_timeout) {
+    *reason = "heartbeat";
+    return false;
+  }
+  for (const auto& entry : journal_) {
+    if (entry.second.started &&
+        now - entry.second.started_at > options_.call_timeout) {
+      *reason = "timeout";
+      return false;
+    }
+  }
+  return true;
+}
+
+void FiscalHostClient::RestartLocked(
+    const char* reason,
+    std::vector<std::pair<FiscalCallback, FiscalReply>>* done) {
+  VIROK_TRACE_SCOPE("fiscal", "host restart");
+  MetricsRegistry::Get()
+      .GetCounter("virok_fiscal_host_restarts_total",
+                  "Fiscal host process restarts by reason",
+                  MetricLabel("reason", reason))
+      ->Add();
+
+  host_.Kill();
+  // Відповіді, які хост встиг записати до збою, дійсні.
+  DrainRepliesLocked(done);
+  requests_.Reset();
+  replies_.Reset();
+
+  const auto now = Clock::now();
+  for (auto it = journal_.begin(); it != journal_.end();) {
+    Pending& pending = it->second;
+    const bool timed_out =
+        pending.started && now - pending.started_at > options_.call_timeout;
+    if (timed_out) {
+      done->emplace_back(std::move(pending.done),
+                         HostError("Fiscal call timed out, host restarted"));
+      it = journal_.erase(it);
+    } else if (pending.started &&
+               !options_.replay_safe.count(pending.method)) {
+      done->emplace_back(std::move(pending.done),
+                         HostError("Fiscal host restarted during " +
+                                   pending.method +
+                                   "; check device state before retrying"));
+      it = journal_.erase(it);
+    } else {
+      pending.sent = false;
+      pending.started = false;
+      ++it;
+    }
+  }
+
+  // Налаштування — першими, до повторених запитів.
+  if (options_.startup_calls) {
+    for (auto& call : options_.startup_calls()) {
+      const uint64_t id =
+          EnqueueLocked(std::move(call.first), call.second, [](FiscalReply) {});
+      journal_[id].startup = true;
+    }
+  }
+  FlushLocked();
+  restarts_++;
+
+  if (!SpawnLocked()) {
+    for (auto& entry : journal_) {
+      done->emplace_back(std::move(entry.second.done),
+                         HostError("Fiscal host failed to start"));
+    }
+    journal_.clear();
+  }
+}
+
+}  // namespace virok
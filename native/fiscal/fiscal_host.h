@@ -0,0 +1,141 @@
+#ifndef NATIVE_FISCAL_FISCAL_HOST_H_
+#define NATIVE_FISCAL_FISCAL_HOST_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "fiscal/fiscal_device.h"
+#include "fiscal/fiscal_session_pool.h"
+#include "ipc/child_process.h"
+#include "ipc/shared_memory.h"
+#include "ipc/spsc_ring.h"
+
+namespace virok {
+
+// Аргумент, з яким клієнт запускає процес-хост:
+//   <exe> --fiscal-host <область> <фіскальний номер> [додаткові аргументи]
+constexpr char kFiscalHostFlag[] = "--fiscal-host";
+
+// Тіло процесу-хоста: відкриває область клієнта, створює пристрій через
+// |factory| і виконує запити з кільця по одному, доки клієнт не закриє
+// сесію. Повертає код виходу процесу.
+int RunFiscalHost(const std::string& region, const std::string& fiscal_num,
+                  const FiscalDeviceFactory& factory);
+
+struct FiscalHostOptions {
+  // Виконуваний файл хоста; порожній — поточний (той самий exe з
+  // kFiscalHostFlag).
+  std::string executable;
+  // Аргументи після фіскального номера (налаштування симулятора тощо).
+  std::vector<std::string> extra_args;
+  // Байтів у кожному з кілець; jsonGoods великого чека — десятки КБ.
+  size_t ring_capacity = 1 << 20;
+  // Виклик, що триває довше, вважається зависанням DLL. Оплата карткою
+  // чекає на покупця, тож запас великий.
+  std::chrono::milliseconds call_timeout = std::chrono::minutes(3);
+  // Хост без серцебиття довше за цей час вважається замерзлим.
+  std::chrono::milliseconds heartbeat_timeout = std::chrono::seconds(3);
+  // Методи, які можна повторити, навіть якщо хост упав посеред виклику:
+  // вони нічого не фіскалізують і не рухають гроші.
+  std::set<std::string> replay_safe = {"getCurrentStatus", "getPOSTerminalList",
+                                       "getVersion", "printXReport",
+                                       "setParameter"};
+  // Виклики, які хост отримує першими після кожного запуску: налаштування,
+  // що жили в пам'яті попереднього процесу (setParameter Cashalot).
+  std::function<std::vector<std::pair<std::string, FiscalArgs>>()>
+      startup_calls;
+};
+
+// Фіскальний пристрій в окремому процесі. Збій або зависання DLL
+// постачальника вбиває лише хост, а не касу.
+//
+// Запити й відповіді йдуть через два SPSC-кільця у спільній пам'яті;
+// клієнт може мати кілька запитів у польоті (конвеєр), хост виконує їх по
+// черзі. Кожен запит лежить у журналі клієнта, доки не прийде відповідь.
+// Сторожовий потік перезапускає хост, якщо той завершився, не б'є
+// серцебиттям або завис у виклику, і повторює журнал:
+//   - запити, яких хост ще не почав, надсилаються знову;
+//   - розпочаті запити з replay_safe повторюються;
+//   - решта розпочатих отримує помилку: чек міг бути фіскалізований, і
+//     повтор наосліп дав би дубль. Стан перевіряє касир (getCurrentStatus).
+// Відповідь, яку хост встиг записати в кільце до збою, не губиться:
+// кільце живе в області клієнта.
+class FiscalHostClient : public FiscalDevice {
+ public:
+  FiscalHostClient(std::string fiscal_num, FiscalHostOptions options);
+  // Просить хост завершитися, решта журналу отримує помилку.
+  ~FiscalHostClient() override;
+
+  FiscalHostClient(const FiscalHostClient&) = delete;
+  FiscalHostClient& operator=(const FiscalHostClient&) = delete;
+
+  // Створює область і запускає хост. False, якщо хост не запустився.
+  bool Start();
+
+  // Асинхронний виклик; |done| виконується в потоці клієнта.
+  void Submit(std::string method, FiscalArgs args, FiscalCallback done);
+
+  FiscalReply Call(const std::string& method, const FiscalArgs& args) override;
+
+  // Скільки разів хост перезапускався (метрики, тести, бенчмарк).
+  int restarts();
+  // PID поточного хоста.
+  int host_pid();
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Pending {
+    std::string method;
+    std::string request;  // закодований запит для повтору
+    FiscalCallback done;
+    bool sent = false;
+    bool started = false;
+    // Налаштування з startup_calls: у кільце раніше за всі інші запити.
+    bool startup = false;
+    Clock::time_point started_at;
+  };
+
+  bool SpawnLocked();
+  void FlushLocked();
+  uint64_t EnqueueLocked(std::string method, const FiscalArgs& args,
+                         FiscalCallback done);
+  void Loop();
+  // Розбирає відповіді з кільця; завершені запити переносить у |done|.
+  void DrainRepliesLocked(
+      std::vector<std::pair<FiscalCallback, FiscalReply>>* done);
+  void RestartLocked(const char* reason,
+                     std::vector<std::pair<FiscalCallback, FiscalReply>>* done);
+  bool HostHealthyLocked(const char** reason);
+
+  const std::string fiscal_num_;
+  const FiscalHostOptions options_;
+
+  std::mutex mutex_;
+  SharedMemory region_;
+  SpscRing requests_;
+  SpscRing replies_;
+  ChildProcess host_;
+  std::map<uint64_t, Pending> journal_;
+  uint64_t next_id_ = 0;
+  int restarts_ = 0;
+  uint64_t last_beat_ = 0;
+  Clock::time_point last_beat_at_;
+  Clock::time_point spawned_at_;
+  bool spawn_failed_ = false;
+  bool stop_ = false;
+  std::thread thread_;
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_FISCAL_FISCAL_HOST_H_
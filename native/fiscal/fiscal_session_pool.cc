@@ -0,0 +1,232 @@
+#include "fiscal/fiscal_session_pool.h"
+
+#include <atomic>
+#include <future>
+#include <utility>
+
+#include "metrics/metrics.h"
+#include "trace/trace.h"
+
+namespace virok {
+
+namespace {
+
+FiscalReply SessionError(const char* error) {
+  FiscalReply reply;
+  reply.error = error;
+  return reply;
+}
+
+Gauge* SessionsGauge() {
+  static Gauge* const gauge = MetricsRegistry::Get().GetGauge(
+      "virok_fiscal_sessions", "Open fiscal device sessions");
+  return gauge;
+}
+
+}  // namespace
+
+void FairGate::Acquire() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  const uint64_t ticket = next_ticket_++;
+  wake_.wait(lock, [&] { return ticket == serving_ && in_use_ < slots_; });
+  serving_++;
+  in_use_++;
+  // Наступний квиток може теж вміститися у вільний слот.
+  wake_.notify_all();
+}
+
+void FairGate::Release() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    in_use_--;
+  }
+  wake_.notify_all();
+}
+
+struct FiscalSessionPool::Session {
+  explicit Session(std::string num)
+      : fiscal_num(std::move(num)),
+        depth(MetricsRegistry::Get().GetGauge(
+            "virok_fiscal_queue_depth",
+            "Fiscal calls queued or running per device",
+            MetricLabel("fiscal_num", fiscal_num))),
+        wait(MetricsRegistry::Get().GetHistogram(
+            "virok_fiscal_queue_wait_microseconds",
+            "Time a fiscal call waits for its device session",
+            MetricLabel("fiscal_num", fiscal_num))) {}
+
+  const std::string fiscal_num;
+  Gauge* const depth;
+  Histogram* const wait;
+
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::deque<Job> queue;
+  bool stop = false;
+  std::thread thread;
+  std::atomic<bool> finished{false};
+};
+
+FiscalSessionPool::FiscalSessionPool(FiscalDeviceFactory factory,
+                                     FiscalSessionOptions options)
+    : factory_(std::move(factory)), options_(std::move(options)) {
+  if (options_.max_concurrent > 0) {
+    gate_ = std::make_unique<FairGate>(options_.max_concurrent);
+  }
+}
+
+FiscalSessionPool::~FiscalSessionPool() {
+  std::vector<std::shared_ptr<Session>> sessions;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closing_ = true;
+    for (auto& entry : sessions_) sessions.push_back(std::move(entry.second));
+    sessions_.clear();
+    for (auto& session : retired_) sessions.push_back(std::move(session));
+    retired_.clear();
+  }
+  for (const auto& session : sessions) {
+    {
+      std::lock_guard<std::mutex> lock(session->mutex);
+      session->stop = true;
+    }
+    session->wake.notify_all();
+  }
+  for (const auto& session : sessions) session->thread.join();
+}
+
+bool FiscalSessionPool::Submit(const std::string& fiscal_num,
+                               std::string method, FiscalArgs args,
+                               FiscalCallback done) {
+  const char* rejected = nullptr;
+  std::vector<std::shared_ptr<Session>> retired;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Приєднуємо лише потоки, що вже вийшли: закриття COM-об'єкта може
+    // тривати, і викликач (потік платформи) на нього не чекає.
+    for (auto it = retired_.begin(); it != retired_.end();) {
+      if ((*it)->finished.load(std::memory_order_acquire)) {
+        retired.push_back(std::move(*it));
+        it = retired_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    if (closing_) {
+      rejected = "Fiscal session pool is closed";
+    } else {
+      std::shared_ptr<Session>& session = sessions_[fiscal_num];
+      if (!session) {
+        session = std::make_shared<Session>(fiscal_num);
+        session->thread = std::thread(&FiscalSessionPool::Run, this, session);
+        SessionsGauge()->Add(1);
+      }
+      std::lock_guard<std::mutex> session_lock(session->mutex);
+      if (session->queue.size() >= options_.max_queue) {
+        rejected = "Fiscal device queue is full";
+      } else {
+        session->queue.push_back(
+            {std::move(method), std::move(args), std::move(done),
+             Tracer::NowNs()});
+        session->depth->Add(1);
+        session->wake.notify_one();
+      }
+    }
+  }
+  for (const auto& session : retired) session->thread.join();
+
+  if (rejected) {
+    done(SessionError(rejected));
+    return false;
+  }
+  return true;
+}
+
+FiscalReply FiscalSessionPool::Call(const std::string& fiscal_num,
+                                    std::string method, FiscalArgs args) {
+  std::promise<FiscalReply> promise;
+  std::future<FiscalReply> reply = promise.get_future();
+  Submit(fiscal_num, std::move(method), std::move(args),
+         [&promise](FiscalReply r) { promise.set_value(std::move(r)); });
+  return reply.get();
+}
+
+std::vector<std::string> FiscalSessionPool::Sessions() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<std::string> nums;
+  nums.reserve(sessions_.size());
+  for (const auto& entry : sessions_) nums.push_back(entry.first);
+  return nums;
+}
+
+void FiscalSessionPool::Run(const std::shared_ptr<Session>& session) {
+  Tracer::Get().SetThreadName("fiscal " + session->fiscal_num);
+  if (options_.on_thread_start) options_.on_thread_start();
+  std::unique_ptr<FiscalDevice> device;
+
+  for (;;) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(session->mutex);
+      const bool woken = session->wake.wait_for(
+          lock, options_.idle_timeout,
+          [&] { return session->stop || !session->queue.empty(); });
+      if (session->stop) break;
+      if (!woken) {
+        lock.unlock();
+        if (TryEvict(session)) break;
+        continue;
+      }
+      job = std::move(session->queue.front());
+      session->queue.pop_front();
+    }
+    session->wait->Record((Tracer::NowNs() - job.enqueued_ns) / 1000);
+
+    FiscalReply reply;
+    if (gate_) gate_->Acquire();
+    {
+      TraceScope trace_scope("fiscal", job.method);
+      if (!device) device = factory_(session->fiscal_num);
+      if (device) {
+        reply = device->Call(job.method, job.args);
+      } else {
+        reply = SessionError("Fiscal device is not available");
+      }
+    }
+    if (gate_) gate_->Release();
+
+    session->depth->Add(-1);
+    job.done(std::move(reply));
+  }
+
+  device.reset();
+  if (options_.on_thread_exit) options_.on_thread_exit();
+
+  // Пул закривається: решта черги не виконається.
+  std::deque<Job> cancelled;
+  {
+    std::lock_guard<std::mutex> lock(session->mutex);
+    cancelled.swap(session->queue);
+  }
+  for (Job& job : cancelled) {
+    session->depth->Add(-1);
+    job.done(SessionError("Fiscal session is closed"));
+  }
+  SessionsGauge()->Add(-1);
+  session->finished.store(true, std::memory_order_release);
+}
+
+bool FiscalSessionPool::TryEvict(const std::shared_ptr<Session>& session) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<std::mutex> session_lock(session->mutex);
+  // Між тайм-аутом і цим блокуванням міг прийти виклик або почалося
+  // закриття пулу — тоді сесія живе далі (або її зупинить деструктор).
+  if (!session->queue.empty() || session->stop || closing_) return false;
+  auto it = sessions_.find(session->fiscal_num);
+  if (it == sessions_.end() || it->second != session) return false;
+  retired_.push_back(std::move(it->second));
+  sessions_.erase(it);
+  return true;
+}
+
+}  // namespace virok
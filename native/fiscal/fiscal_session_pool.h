@@ -0,0 +1,122 @@
+#ifndef NATIVE_FISCAL_FISCAL_SESSION_POOL_H_
+#define NATIVE_FISCAL_FISCAL_SESSION_POOL_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fiscal/fiscal_device.h"
+
+namespace virok {
+
+// Семафор зі строгим порядком черги: хто раніше попросив слот, той раніше
+// його й отримає. Сесії різних ПРРО ділять його чесно — довга черга одного
+// пристрою не витісняє поодинокі виклики іншого.
+class FairGate {
+ public:
+  explicit FairGate(size_t slots) : slots_(slots) {}
+
+  FairGate(const FairGate&) = delete;
+  FairGate& operator=(const FairGate&) = delete;
+
+  void Acquire();
+  void Release();
+
+ private:
+  const size_t slots_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  uint64_t next_ticket_ = 0;
+  uint64_t serving_ = 0;
+  size_t in_use_ = 0;
+};
+
+struct FiscalSessionOptions {
+  // Сесія без викликів довше за цей час закривається разом із пристроєм
+  // і потоком; наступний виклик відкриє її заново.
+  std::chrono::milliseconds idle_timeout = std::chrono::minutes(10);
+  // Викликів у черзі однієї сесії, понад які нові відхиляються.
+  size_t max_queue = 64;
+  // Скільки викликів одночасно на всі пристрої (FairGate); 0 — без обмеження.
+  size_t max_concurrent = 0;
+  // Виконуються в потоці сесії до створення пристрою і після його
+  // знищення: там, де пристрій вимагає STA (CoInitialize/CoUninitialize).
+  std::function<void()> on_thread_start;
+  std::function<void()> on_thread_exit;
+};
+
+// Створює пристрій для фіскального номера. Викликається в потоці сесії;
+// nullptr — пристрій недоступний (виклик отримає помилку, наступний
+// спробує створити знову).
+using FiscalDeviceFactory =
+    std::function<std::unique_ptr<FiscalDevice>(const std::string& fiscal_num)>;
+
+// Відповідь на виклик. Виконується в потоці сесії (або одразу в Submit,
+// якщо виклик відхилено), тож передача результату в UI — справа викликача.
+using FiscalCallback = std::function<void(FiscalReply reply)>;
+
+// Сесії фіскальних пристроїв за фіскальним номером ПРРО.
+//
+// Кожна сесія має власний пристрій і потік, що виконує її виклики по черзі
+// (FIFO): операції одного ПРРО впорядковані, а різні ПРРО працюють
+// паралельно — X-звіт на одній касі не чекає фіскалізації чека на іншій.
+// Пристрій живе в одному потоці від створення до знищення, як того вимагає
+// COM-об'єкт у STA.
+class FiscalSessionPool {
+ public:
+  explicit FiscalSessionPool(FiscalDeviceFactory factory,
+                             FiscalSessionOptions options = {});
+  // Закриває всі сесії: поточні виклики завершуються, решта черги
+  // отримує помилку.
+  ~FiscalSessionPool();
+
+  FiscalSessionPool(const FiscalSessionPool&) = delete;
+  FiscalSessionPool& operator=(const FiscalSessionPool&) = delete;
+
+  // Ставить виклик у чергу сесії |fiscal_num| (створює її за потреби).
+  // False, якщо черга повна або пул закривається — тоді |done| вже
+  // викликано з помилкою.
+  bool Submit(const std::string& fiscal_num, std::string method,
+              FiscalArgs args, FiscalCallback done);
+
+  // Синхронний варіант Submit (тести, бенчмарки).
+  FiscalReply Call(const std::string& fiscal_num, std::string method,
+                   FiscalArgs args);
+
+  // Фіскальні номери відкритих сесій.
+  std::vector<std::string> Sessions();
+
+ private:
+  struct Job {
+    std::string method;
+    FiscalArgs args;
+    FiscalCallback done;
+    int64_t enqueued_ns;
+  };
+  struct Session;
+
+  void Run(const std::shared_ptr<Session>& session);
+  bool TryEvict(const std::shared_ptr<Session>& session);
+
+  const FiscalDeviceFactory factory_;
+  const FiscalSessionOptions options_;
+  std::unique_ptr<FairGate> gate_;
+
+  std::mutex mutex_;  // порядок блокувань: mutex_, потім Session::mutex
+  std::map<std::string, std::shared_ptr<Session>> sessions_;
+  // Закриті за простоєм сесії, чиї потоки ще треба приєднати.
+  std::vector<std::shared_ptr<Session>> retired_;
+  bool closing_ = false;
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_FISCAL_FISCAL_SESSION_POOL_H_
@@ -0,0 +1,217 @@
+#include "fiscal/fiscal_status_cache.h"
+
+#include <utility>
+#include <vector>
+
+#include "metrics/metrics.h"
+#include "trace/trace.h"
+
+namespace virok {
+
+namespace {
+
+int64_t NowMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+bool Failed(const FiscalReply& reply) {
+  return !reply.success || !reply.error.empty();
+}
+
+void CountLookup(const char* result) {
+  MetricsRegistry::Get()
+      .GetCounter("virok_fiscal_status_cache_total",
+                  "getCurrentStatus lookups in the status cache",
+                  MetricLabel("result", result))
+      ->Add();
+}
+
+}  // namespace
+
+FiscalStatusCache::FiscalStatusCache(FiscalStatusFetch fetch,
+                                     FiscalStatusListener listener,
+                                     FiscalStatusOptions options)
+    : fetch_(std::move(fetch)),
+      listener_(std::move(listener)),
+      options_(std::move(options)) {
+  thread_ = std::thread(&FiscalStatusCache::Run, this);
+}
+
+FiscalStatusCache::~FiscalStatusCache() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  thread_.join();
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [this] { return in_flight_ == 0; });
+}
+
+bool FiscalStatusCache::Get(const std::string& fiscal_num,
+                            FiscalStatus* out) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const Entry& entry = TouchLocked(fiscal_num);
+  if (!entry.has_status || entry.status.stale || Failed(entry.status.reply)) {
+    CountLookup("miss");
+    return false;
+  }
+  CountLookup("hit");
+  *out = entry.status;
+  return true;
+}
+
+void FiscalStatusCache::Store(const std::string& fiscal_num,
+                              const FiscalReply& reply) {
+  FiscalStatus status;
+  bool changed;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry& entry = TouchLocked(fiscal_num);
+    if (Failed(reply) && entry.has_status && !Failed(entry.status.reply)) {
+      return;
+    }
+    changed = UpdateLocked(&entry, reply) || entry.status.stale;
+    entry.status.stale = false;
+    entry.next_refresh = Clock::now() + options_.refresh_interval;
+    status = entry.status;
+  }
+  if (changed) listener_(fiscal_num, status);
+}
+
+void FiscalStatusCache::Observe(const std::string& fiscal_num,
+                                const std::string& method) {
+  if (options_.invalidating.count(method)) {
+    Invalidate(fiscal_num);
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  TouchLocked(fiscal_num);
+}
+
+void FiscalStatusCache::Invalidate(const std::string& fiscal_num) {
+  FiscalStatus status;
+  bool notify;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry& entry = TouchLocked(fiscal_num);
+    notify = entry.has_status && !entry.status.stale;
+    entry.status.stale = true;
+    entry.dirty = entry.in_flight;
+    entry.next_refresh = Clock::now();
+    status = entry.status;
+  }
+  cv_.notify_all();
+  if (notify) listener_(fiscal_num, status);
+}
+
+FiscalStatusCache::Entry& FiscalStatusCache::TouchLocked(
+    const std::string& fiscal_num) {
+  const auto now = Clock::now();
+  auto inserted = entries_.try_emplace(fiscal_num);
+  Entry& entry = inserted.first->second;
+  if (inserted.second) {
+    // Перший стан принесе сам виклик, що звернувся до кешу.
+    entry.next_refresh = now + options_.refresh_interval;
+    cv_.notify_all();
+  }
+  entry.last_used = now;
+  return entry;
+}
+
+bool FiscalStatusCache::UpdateLocked(Entry* entry, const FiscalReply& reply) {
+  const FiscalReply& old = entry->status.reply;
+  const bool changed = !entry->has_status || old.success != reply.success ||
+                       old.json_val != reply.json_val ||
+                       old.error != reply.error;
+  entry->status.reply = reply;
+  entry->status.updated_ms = NowMs();
+  entry->has_status = true;
+  return changed;
+}
+
+void FiscalStatusCache::OnFetched(const std::string& fiscal_num,
+                                  FiscalReply reply) {
+  FiscalStatus status;
+  bool changed;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry& entry = entries_[fiscal_num];
+    entry.in_flight = false;
+    const auto now = Clock::now();
+    if (Failed(reply) && entry.has_status && !Failed(entry.status.reply)) {
+      // Пристрій не відповів: успішний стан лишається (застарілий — теж
+      // застарілим). Запит до зміни стану варто повторити одразу.
+      changed = false;
+      entry.next_refresh =
+          entry.dirty ? now : now + options_.refresh_interval;
+      entry.dirty = false;
+    } else if (entry.dirty) {
+      changed = UpdateLocked(&entry, reply);
+      // Запит пішов до зміни стану — потрібен ще один.
+      entry.dirty = false;
+      entry.next_refresh = now;
+    } else {
+      changed = UpdateLocked(&entry, reply) || entry.status.stale;
+      entry.status.stale = false;
+      entry.next_refresh = now + options_.refresh_interval;
+    }
+    status = entry.status;
+  }
+  if (changed) listener_(fiscal_num, status);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  in_flight_--;
+  cv_.notify_all();
+}
+
+void FiscalStatusCache::Run() {
+  Tracer::Get().SetThreadName("fiscal status");
+  std::unique_lock<std::mutex> lock(mutex_);
+  std::vector<std::string> due;
+  while (!stop_) {
+    const auto now = Clock::now();
+    auto deadline = Clock::time_point::max();
+    for (auto it = entries_.begin(); it != entries_.end();) {
+      Entry& entry = it->second;
+      if (entry.in_flight) {
+        ++it;
+        continue;
+      }
+      if (now - entry.last_used > options_.forget_after) {
+        it = entries_.erase(it);
+        continue;
+      }
+      if (entry.next_refresh <= now) {
+        entry.in_flight = true;
+        in_flight_++;
+        due.push_back(it->first);
+      } else if (entry.next_refresh < deadline) {
+        deadline = entry.next_refresh;
+      }
+      ++it;
+    }
+
+    if (!due.empty()) {
+      // Відповідь може прийти синхронно (черга повна), тож без м'ютекса.
+      lock.unlock();
+      for (const std::string& fiscal_num : due) {
+        fetch_(fiscal_num, [this, fiscal_num](FiscalReply reply) {
+          OnFetched(fiscal_num, std::move(reply));
+        });
+      }
+      due.clear();
+      lock.lock();
+      continue;
+    }
+    if (deadline == Clock::time_point::max()) {
+      cv_.wait(lock);
+    } else {
+      cv_.wait_until(lock, deadline);
+    }
+  }
+}
+
+}  // namespace virok
@@ -0,0 +1,118 @@
+#ifndef NATIVE_FISCAL_FISCAL_STATUS_CACHE_H_
+#define NATIVE_FISCAL_FISCAL_STATUS_CACHE_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+#include "fiscal/fiscal_device.h"
+#include "fiscal/fiscal_session_pool.h"
+
+namespace virok {
+
+struct FiscalStatusOptions {
+  // Як часто стан оновлюється у фоні.
+  std::chrono::milliseconds refresh_interval = std::chrono::seconds(30);
+  // ПРРО, до якого ніхто не звертався довше, перестає оновлюватися (і не
+  // тримає свою сесію відкритою).
+  std::chrono::milliseconds forget_after = std::chrono::hours(1);
+  // Методи, після яких стан ПРРО змінюється: кеш застаріває й одразу
+  // оновлюється.
+  std::set<std::string> invalidating = {
+      "closeShift",   "fiscalizeCheck", "fiscalizeReturnCheck",
+      "openShift",    "serviceInput",   "serviceOutput"};
+};
+
+// Відповідь getCurrentStatus з кешу.
+struct FiscalStatus {
+  FiscalReply reply;
+  // Коли отримано, мс від епохи (system_clock, для Dart).
+  int64_t updated_ms = 0;
+  // Після відповіді був метод, що змінює стан; свіжої ще немає.
+  bool stale = false;
+};
+
+// Запитує getCurrentStatus для |fiscal_num| (зазвичай через
+// FiscalSessionPool::Submit) і викликає |done| з відповіддю.
+using FiscalStatusFetch =
+    std::function<void(const std::string& fiscal_num, FiscalCallback done)>;
+// Стан ПРРО змінився. Викликається з потоку, що отримав відповідь.
+using FiscalStatusListener =
+    std::function<void(const std::string& fiscal_num, const FiscalStatus&)>;
+
+// Кеш getCurrentStatus за фіскальним номером. Діалоги зміни відкриваються
+// з готовим станом замість повного виклику ПРРО.
+//
+// Номер, до якого звернулися (Get, Store, Observe), оновлюється у фоні
+// кожні refresh_interval. Після методів, що змінюють стан (invalidating),
+// кеш застаріває: Get повертає false, доки не прийде свіжа відповідь, а
+// оновлення запитується одразу. Слухач отримує кожну зміну стану, а також
+// сам факт застарівання (stale), щоб Dart не показував старий стан.
+// Помилка пристрою (зв'язок із ПРРО, зайнятий порт) не затирає останній
+// успішний стан: без методів, що його змінюють, він лишається вірним, і
+// Get віддає його далі (вік — у updated_ms).
+//
+// Пул, через який іде |fetch|, має жити довше за кеш: деструктор чекає
+// відповідей на запити, що вже в польоті.
+class FiscalStatusCache {
+ public:
+  FiscalStatusCache(FiscalStatusFetch fetch, FiscalStatusListener listener,
+                    FiscalStatusOptions options = {});
+  ~FiscalStatusCache();
+
+  FiscalStatusCache(const FiscalStatusCache&) = delete;
+  FiscalStatusCache& operator=(const FiscalStatusCache&) = delete;
+
+  // Останній успішний стан. False — його немає або він застарів: тоді
+  // виклик іде на пристрій.
+  bool Get(const std::string& fiscal_num, FiscalStatus* out);
+
+  // Відповідь getCurrentStatus, отримана поза кешем (виклик з Dart).
+  void Store(const std::string& fiscal_num, const FiscalReply& reply);
+
+  // Метод |method| ПРРО завершився (успішно чи ні).
+  void Observe(const std::string& fiscal_num, const std::string& method);
+
+  // Стан застарів: оновити якнайшвидше.
+  void Invalidate(const std::string& fiscal_num);
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Entry {
+    FiscalStatus status;
+    bool has_status = false;
+    // Інвалідовано, поки запит був у польоті: його відповідь уже стара.
+    bool dirty = false;
+    bool in_flight = false;
+    Clock::time_point next_refresh;
+    Clock::time_point last_used;
+  };
+
+  Entry& TouchLocked(const std::string& fiscal_num);
+  // Зберігає відповідь; true, якщо стан змінився.
+  bool UpdateLocked(Entry* entry, const FiscalReply& reply);
+  void OnFetched(const std::string& fiscal_num, FiscalReply reply);
+  void Run();
+
+  const FiscalStatusFetch fetch_;
+  const FiscalStatusListener listener_;
+  const FiscalStatusOptions options_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::map<std::string, Entry> entries_;
+  int in_flight_ = 0;
+  bool stop_ = false;
+  std::thread thread_;
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_FISCAL_FISCAL_STATUS_CACHE_H_
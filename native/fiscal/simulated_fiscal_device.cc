@@ -0,0 +1,169 @@
+#include "fiscal/simulated_fiscal_device.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+#include <thread>
+
+#include "json/json_reader.h"
+#include "printing/escpos.h"
+
+namespace virok {
+
+namespace {
+
+// "15,65" / "15.65" / число з JSON -> double.
+double ParseAmount(std::string_view text) {
+  std::string copy(text);
+  for (char& c : copy) {
+    if (c == ',') c = '.';
+  }
+  return std::strtod(copy.c_str(), nullptr);
+}
+
+struct ReceiptLine {
+  std::string_view name;
+  double quantity = 0;
+  double price = 0;
+  double amount = 0;
+};
+
+// Читає ReceiptLst з jsonGoods (формат CashalotComService.registerSale).
+bool ParseGoods(std::string_view json, std::vector<ReceiptLine>* lines) {
+  JsonReader reader(json);
+  if (reader.Next() != JsonReader::Token::kBeginObject) return false;
+  for (auto t = reader.Next(); t == JsonReader::Token::kKey;
+       t = reader.Next()) {
+    if (reader.text() != "ReceiptLst") {
+      reader.Next();
+      if (!reader.Skip()) return false;
+      continue;
+    }
+    if (reader.Next() != JsonReader::Token::kBeginArray) return false;
+    while (reader.Next() == JsonReader::Token::kBeginObject) {
+      ReceiptLine line;
+      while (reader.Next() == JsonReader::Token::kKey) {
+        const std::string_view key = reader.text();
+        const auto value = reader.Next();
+        if (value == JsonReader::Token::kString ||
+            value == JsonReader::Token::kNumber) {
+          if (key == "Name") line.name = reader.text();
+          if (key == "Quantity") line.quantity = ParseAmount(reader.text());
+          if (key == "Price") line.price = ParseAmount(reader.text());
+          if (key == "Amount") line.amount = ParseAmount(reader.text());
+        } else if (!reader.Skip()) {
+          return false;
+        }
+      }
+      lines->push_back(line);
+    }
+  }
+  return reader.error().empty() && !lines->empty();
+}
+
+FiscalReply Rejected(const char* error) {
+  FiscalReply reply;
+  reply.success = false;
+  reply.json_val = std::string("{\"Ret\":false,\"ErrorCode\":1,"
+                               "\"ErrorString\":\"") +
+                   error + "\"}";
+  return reply;
+}
+
+}  // namespace
+
+std::chrono::microseconds SimulationDice::NextLatency() {
+  double ms = profile_.base_ms * (1 + profile_.jitter * (2 * Uniform() - 1));
+  if (Uniform() < profile_.tail_rate) ms *= profile_.tail_factor;
+  return std::chrono::microseconds(static_cast<int64_t>(ms * 1000));
+}
+
+bool SimulationDice::NextFailure() {
+  return profile_.failure_rate > 0 && Uniform() < profile_.failure_rate;
+}
+
+SimulatedFiscalDevice::SimulatedFiscalDevice(const Options& options)
+    : fiscal_dice_(options.fiscal, options.seed),
+      card_dice_(options.card, options.seed * 31 + 7) {}
+
+FiscalReply SimulatedFiscalDevice::Call(const std::string& method,
+                                        const FiscalArgs& args) {
+  // Один виклик за раз, як COM-об'єкт Cashalot.
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (method == "fiscalizeCheck") return FiscalizeCheck(args);
+  if (method == "payByPaymentCard") return PayByCard(args);
+
+  std::this_thread::sleep_for(fiscal_dice_.NextLatency());
+  if (method == "getCurrentStatus" || method == "openShift" ||
+      method == "closeShift" || method == "printXReport" ||
+      method == "serviceInput" || method == "serviceOutput") {
+    FiscalReply reply;
+    reply.success = true;
+    reply.json_val = "{\"Ret\":true,\"ErrorCode\":0,\"ErrorString\":\"\"}";
+    return reply;
+  }
+  FiscalReply reply;
+  reply.error = "Method not found: " + method;
+  return reply;
+}
+
+FiscalReply SimulatedFiscalDevice::FiscalizeCheck(const FiscalArgs& args) {
+  std::this_thread::sleep_for(fiscal_dice_.NextLatency());
+  if (fiscal_dice_.NextFailure()) return Rejected("Timeout waiting for DPS");
+
+  const auto goods = args.find("jsonGoods");
+  std::vector<ReceiptLine> lines;
+  if (goods == args.end() || !ParseGoods(goods->second, &lines)) {
+    return Rejected("Invalid ReceiptLst");
+  }
+
+  checks_++;
+  char fiscal_number[32];
+  std::snprintf(fiscal_number, sizeof(fiscal_number), "%lld",
+                static_cast<long long>(4000000000LL + checks_));
+
+  // Текст чека в UTF-8 -> CP1251 -> Base64, як Visualization у Cashalot.
+  std::string text = "ТОВ \"ВІРОК\"\nКАСОВИЙ ЧЕК\n";
+  double total = 0;
+  char buf[64];
+  for (const ReceiptLine& line : lines) {
+    text.append(line.name).push_back('\n');
+    std::snprintf(buf, sizeof(buf), "  %.3f x %.2f = %.2f\n", line.quantity,
+                  line.price, line.amount);
+    text.append(buf);
+    total += line.amount;
+  }
+  std::snprintf(buf, sizeof(buf), "СУМА %.2f\nФН %s\n", total, fiscal_number);
+  text.append(buf);
+
+  std::string cp1251;
+  Utf8ToCp1251(text, &cp1251);
+  FiscalReply reply;
+  reply.success = true;
+  reply.json_val.append("{\"Ret\":true,\"ErrorCode\":0,\"ErrorString\":\"\","
+                        "\"NumFiscal\":\"");
+  reply.json_val.append(fiscal_number);
+  reply.json_val.append("\",\"Visualization\":\"");
+  Base64Encode(cp1251, &reply.json_val);
+  reply.json_val.append("\"}");
+  return reply;
+}
+
+FiscalReply SimulatedFiscalDevice::PayByCard(const FiscalArgs& args) {
+  std::this_thread::sleep_for(card_dice_.NextLatency());
+  if (card_dice_.NextFailure()) return Rejected("Card declined");
+
+  rrn_++;
+  char json[160];
+  std::snprintf(json, sizeof(json),
+                "{\"Ret\":true,\"RRN\":\"%012lld\",\"ApprovalCode\":\"%06lld\","
+                "\"TerminalID\":\"SIM00001\"}",
+                static_cast<long long>(rrn_),
+                static_cast<long long>(rrn_ % 1000000));
+  FiscalReply reply;
+  reply.success = true;
+  reply.json_val = json;
+  return reply;
+}
+
+}  // namespace virok
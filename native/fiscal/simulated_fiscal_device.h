@@ -0,0 +1,76 @@
+#ifndef NATIVE_FISCAL_SIMULATED_FISCAL_DEVICE_H_
+#define NATIVE_FISCAL_SIMULATED_FISCAL_DEVICE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "fiscal/fiscal_device.h"
+
+namespace virok {
+
+// Модель затримки й збоїв зовнішньої системи (ПРРО, принтер, бекенд).
+// Затримка: base_ms * (1 ± jitter), а з імовірністю tail_rate — ще й
+// множиться на tail_factor (повільні відповіді, що формують p99).
+struct SimulationProfile {
+  double base_ms = 0;
+  double jitter = 0.2;
+  double tail_rate = 0.02;
+  double tail_factor = 5;
+  double failure_rate = 0;
+};
+
+// Детермінований генератор затримок і збоїв за профілем.
+class SimulationDice {
+ public:
+  SimulationDice(const SimulationProfile& profile, uint64_t seed)
+      : profile_(profile), rng_(seed) {}
+
+  std::chrono::microseconds NextLatency();
+  bool NextFailure();
+
+ private:
+  double Uniform() { return std::uniform_real_distribution<double>()(rng_); }
+
+  SimulationProfile profile_;
+  std::mt19937_64 rng_;
+};
+
+// Імітація Cashalot: відповідає на методи каналу com.cashalot/api
+// JSON-ом у форматі справжнього пристрою, зі штучною затримкою і збоями.
+//
+// Як і COM-об'єкт Cashalot, обробляє один виклик за раз: паралельні
+// виклики стоять у черзі. fiscalizeCheck розбирає jsonGoods (помилка в
+// JSON — відмова, як у Cashalot) і повертає фіскальний номер та
+// візуалізацію чека (Base64, CP1251).
+class SimulatedFiscalDevice : public FiscalDevice {
+ public:
+  struct Options {
+    SimulationProfile fiscal;  // fiscalizeCheck, звіти, зміна
+    SimulationProfile card;    // payByPaymentCard (клієнт з карткою)
+    uint64_t seed = 1;
+  };
+
+  explicit SimulatedFiscalDevice(const Options& options);
+
+  FiscalReply Call(const std::string& method, const FiscalArgs& args) override;
+
+  int64_t checks() const { return checks_; }
+
+ private:
+  FiscalReply FiscalizeCheck(const FiscalArgs& args);
+  FiscalReply PayByCard(const FiscalArgs& args);
+
+  std::mutex mutex_;
+  SimulationDice fiscal_dice_;
+  SimulationDice card_dice_;
+  int64_t checks_ = 0;
+  int64_t rrn_ = 0;
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_FISCAL_SIMULATED_FISCAL_DEVICE_H_
@@ -0,0 +1,165 @@
+#include "ipc/child_process.h"
+
+#ifdef _WIN32
+#include <windows.h>
+
+#include "text/utf.h"
+#else
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <climits>
+
+extern char** environ;
+#endif
+
+namespace virok {
+
+#ifdef _WIN32
+
+namespace {
+
+// Аргумент командного рядка за правилами CommandLineToArgvW.
+void AppendQuoted(const std::string& arg, std::string* out) {
+  if (!out->empty()) out->push_back(' ');
+  if (!arg.empty() && arg.find_first_of(" \t\"") == std::string::npos) {
+    out->append(arg);
+    return;
+  }
+  out->push_back('"');
+  size_t backslashes = 0;
+  for (char c : arg) {
+    if (c == '\\') {
+      backslashes++;
+      continue;
+    }
+    if (c == '"') backslashes = backslashes * 2 + 1;
+    out->append(backslashes, '\\');
+    backslashes = 0;
+    out->push_back(c);
+  }
+  out->append(backslashes * 2, '\\');
+  out->push_back('"');
+}
+
+}  // namespace
+
+ChildProcess::~ChildProcess() {
+  Kill();
+  if (job_) CloseHandle(job_);
+}
+
+std::string ChildProcess::SelfPath() {
+  wchar_t path[MAX_PATH];
+  const DWORD length = GetModuleFileNameW(nullptr, path, MAX_PATH);
+  std::string out;
+  Utf16ToUtf8(std::u16string_view(reinterpret_cast<const char16_t*>(path),
+                                  length),
+              &out);
+  return out;
+}
+
+bool ChildProcess::Start(const std::string& path,
+                         const std::vector<std::string>& args) {
+  Kill();
+  if (!job_) {
+    job_ = CreateJobObjectW(nullptr, nullptr);
+    JOBOBJECT_EXTENDED_LIMIT_INFORMATION limits = {};
+    limits.BasicLimitInformation.LimitFlags =
+        JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE;
+    if (job_) {
+      SetInformationJobObject(job_, JobObjectExtendedLimitInformation,
+                              &limits, sizeof(limits));
+    }
+  }
+
+  std::string command;
+  AppendQuoted(path, &command);
+  for (const std::string& arg : args) AppendQuoted(arg, &command);
+  std::u16string wide_path;
+  std::u16string wide_command;
+  Utf8ToUtf16(path, &wide_path);
+  Utf8ToUtf16(command, &wide_command);
+
+  STARTUPINFOW startup = {};
+  startup.cb = sizeof(startup);
+  PROCESS_INFORMATION info = {};
+  if (!CreateProcessW(reinterpret_cast<const wchar_t*>(wide_path.c_str()),
+                      reinterpret_cast<wchar_t*>(&wide_command[0]), nullptr,
+                      nullptr, FALSE, CREATE_NO_WINDOW | CREATE_SUSPENDED,
+                      nullptr, nullptr, &startup, &info)) {
+    return false;
+  }
+  // У job до першої інструкції: процес не може залишитися сиротою.
+  if (job_) AssignProcessToJobObject(job_, info.hProcess);
+  ResumeThread(info.hThread);
+  CloseHandle(info.hThread);
+  process_ = info.hProcess;
+  pid_ = static_cast<int>(info.dwProcessId);
+  return true;
+}
+
+bool ChildProcess::Running() {
+  return process_ && WaitForSingleObject(process_, 0) == WAIT_TIMEOUT;
+}
+
+void ChildProcess::Kill() {
+  if (!process_) return;
+  TerminateProcess(process_, 1);
+  WaitForSingleObject(process_, INFINITE);
+  CloseHandle(process_);
+  process_ = nullptr;
+  pid_ = 0;
+}
+
+#else
+
+ChildProcess::~ChildProcess() { Kill(); }
+
+std::string ChildProcess::SelfPath() {
+  char path[PATH_MAX];
+  const ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+  return length > 0 ? std::string(path, static_cast<size_t>(length))
+                    : std::string();
+}
+
+bool ChildProcess::Start(const std::string& path,
+                         const std::vector<std::string>& args) {
+  Kill();
+  std::vector<char*> argv;
+  argv.push_back(const_cast<char*>(path.c_str()));
+  for (const std::string& arg : args) {
+    argv.push_back(const_cast<char*>(arg.c_str()));
+  }
+  argv.push_back(nullptr);
+
+  pid_t pid;
+  if (posix_spawn(&pid, path.c_str(), nullptr, nullptr, argv.data(),
+                  environ) != 0) {
+    return false;
+  }
+  pid_ = pid;
+  return true;
+}
+
+bool ChildProcess::Running() {
+  if (pid_ <= 0) return false;
+  int status;
+  if (waitpid(pid_, &status, WNOHANG) == 0) return true;
+  pid_ = 0;
+  return false;
+}
+
+void ChildProcess::Kill() {
+  if (pid_ <= 0) return;
+  kill(pid_, SIGKILL);
+  int status;
+  waitpid(pid_, &status, 0);
+  pid_ = 0;
+}
+
+#endif
+
+}  // namespace virok
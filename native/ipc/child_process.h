@@ -0,0 +1,45 @@
+#ifndef NATIVE_IPC_CHILD_PROCESS_H_
+#define NATIVE_IPC_CHILD_PROCESS_H_
+
+#include <string>
+#include <vector>
+
+namespace virok {
+
+// Допоміжний процес каси (posix_spawn або CreateProcess). Дочірній процес
+// не переживає батьківський: на Windows він у job-об'єкті з
+// KILL_ON_JOB_CLOSE, на Linux сам просить PR_SET_PDEATHSIG (див.
+// RunFiscalHost).
+class ChildProcess {
+ public:
+  ChildProcess() = default;
+  ~ChildProcess();
+
+  ChildProcess(const ChildProcess&) = delete;
+  ChildProcess& operator=(const ChildProcess&) = delete;
+
+  // Шлях до виконуваного файлу поточного процесу: допоміжні процеси — це
+  // той самий файл з іншими аргументами.
+  static std::string SelfPath();
+
+  bool Start(const std::string& path, const std::vector<std::string>& args);
+
+  // Не блокує. False, якщо процес завершився (або не запускався).
+  bool Running();
+
+  // Завершує процес примусово і чекає його.
+  void Kill();
+
+  int pid() const { return pid_; }
+
+ private:
+  int pid_ = 0;
+#ifdef _WIN32
+  void* process_ = nullptr;
+  void* job_ = nullptr;
+#endif
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_IPC_CHILD_PROCESS_H_
@@ -0,0 +1,145 @@
+#include "ipc/shared_memory.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace virok {
+
+SharedMemory::~SharedMemory() { Close(); }
+
+bool SharedMemory::Create(const std::string& name, size_t size) {
+  return Map(name, size, Mode::kCreate);
+}
+
+bool SharedMemory::Open(const std::string& name, size_t size) {
+  return Map(name, size, Mode::kOpen);
+}
+
+bool SharedMemory::OpenReadOnly(const std::string& name) {
+  return Map(name, 0, Mode::kOpenReadOnly);
+}
+
+bool SharedMemory::OpenOrCreate(const std::string& name, size_t size) {
+  return Map(name, size, Mode::kOpenOrCreate);
+}
+
+#ifdef _WIN32
+
+bool SharedMemory::Map(const std::string& name, size_t size, Mode mode) {
+  Close();
+  const std::string full = "Local\\" + name;
+  const bool read_only = mode == Mode::kOpenReadOnly;
+  const DWORD access = read_only ? FILE_MAP_READ : FILE_MAP_ALL_ACCESS;
+  if (mode == Mode::kCreate || mode == Mode::kOpenOrCreate) {
+    // Для наявної області CreateFileMapping повертає її ж
+    // (ERROR_ALREADY_EXISTS).
+    const unsigned long long size64 = size;
+    mapping_ = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr,
+                                  PAGE_READWRITE,
+                                  static_cast<DWORD>(size64 >> 32),
+                                  static_cast<DWORD>(size64), full.c_str());
+  } else {
+    mapping_ = OpenFileMappingA(access, FALSE, full.c_str());
+  }
+  if (!mapping_) return false;
+  data_ = MapViewOfFile(mapping_, access, 0, 0, size);
+  if (!data_) {
+    CloseHandle(mapping_);
+    mapping_ = nullptr;
+    return false;
+  }
+  if (read_only) {
+    MEMORY_BASIC_INFORMATION info;
+    size = VirtualQuery(data_, &info, sizeof(info)) ? info.RegionSize : 0;
+  }
+  // Нова сторінкова пам'ять Windows уже нульова.
+  size_ = size;
+  name_ = name;
+  owner_ = mode == Mode::kCreate;
+  return true;
+}
+
+void SharedMemory::Close() {
+  if (data_) UnmapViewOfFile(data_);
+  if (mapping_) CloseHandle(mapping_);
+  data_ = nullptr;
+  mapping_ = nullptr;
+  size_ = 0;
+  owner_ = false;
+}
+
+// Ім'я file mapping зникає разом з останнім дескриптором.
+void SharedMemory::Unlink(const std::string& name) {}
+
+#else
+
+bool SharedMemory::Map(const std::string& name, size_t size, Mode mode) {
+  Close();
+  const std::string full = "/" + name;
+  const bool read_only = mode == Mode::kOpenReadOnly;
+  int fd = -1;
+  if (mode == Mode::kCreate) {
+    shm_unlink(full.c_str());
+    fd = shm_open(full.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  } else if (mode == Mode::kOpenOrCreate) {
+    fd = shm_open(full.c_str(), O_RDWR | O_CREAT, 0600);
+  } else {
+    fd = shm_open(full.c_str(), read_only ? O_RDONLY : O_RDWR, 0600);
+  }
+  if (fd < 0) return false;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return false;
+  }
+  if (read_only) {
+    size = static_cast<size_t>(st.st_size);
+  } else if (mode != Mode::kOpen && static_cast<size_t>(st.st_size) < size) {
+    // Для kOpenOrCreate розширюють обидва учасники гонки: ftruncate до
+    // того самого розміру нічого не стирає.
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+      close(fd);
+      if (mode == Mode::kCreate) shm_unlink(full.c_str());
+      return false;
+    }
+  }
+  if (size == 0) {
+    close(fd);
+    return false;
+  }
+  const int prot = read_only ? PROT_READ : PROT_READ | PROT_WRITE;
+  void* data = mmap(nullptr, size, prot, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    if (mode == Mode::kCreate) shm_unlink(full.c_str());
+    return false;
+  }
+  data_ = data;
+  size_ = size;
+  name_ = name;
+  owner_ = mode == Mode::kCreate;
+  return true;
+}
+
+void SharedMemory::Close() {
+  if (data_) munmap(data_, size_);
+  if (owner_) shm_unlink(("/" + name_).c_str());
+  data_ = nullptr;
+  size_ = 0;
+  owner_ = false;
+}
+
+void SharedMemory::Unlink(const std::string& name) {
+  shm_unlink(("/" + name).c_str());
+}
+
+#endif
+
+}  // namespace virok
@@ -0,0 +1,63 @@
+#ifndef NATIVE_IPC_SHARED_MEMORY_H_
+#define NATIVE_IPC_SHARED_MEMORY_H_
+
+#include <cstddef>
+#include <string>
+
+namespace virok {
+
+// Іменована область спільної пам'яті між процесами каси: POSIX shm_open
+// або file mapping Windows ("Local\<name>").
+//
+// Створює область процес-власник (клієнт); допоміжний процес відкриває її
+// за іменем. Область живе, поки її тримає власник: перезапуск допоміжного
+// процесу її не втрачає.
+class SharedMemory {
+ public:
+  SharedMemory() = default;
+  ~SharedMemory();
+
+  SharedMemory(const SharedMemory&) = delete;
+  SharedMemory& operator=(const SharedMemory&) = delete;
+
+  // Створює нову область розміром |size| байтів, заповнену нулями.
+  // Область з тим самим іменем, що лишилася від аварійного процесу,
+  // перестворюється.
+  bool Create(const std::string& name, size_t size);
+  // Відкриває наявну область.
+  bool Open(const std::string& name, size_t size);
+  // Відкриває наявну область лише для читання; розмір береться з самої
+  // області (на Windows — округлений до сторінки).
+  bool OpenReadOnly(const std::string& name);
+  // Відкриває область, а якщо її ще немає — створює нульову. Таку
+  // область ділять рівноправні процеси, тож Close її не видаляє.
+  bool OpenOrCreate(const std::string& name, size_t size);
+  void Close();
+
+  // Лишає створену область після Close (POSIX). Windows тримає область,
+  // доки її відкрито хоча б в одному процесі.
+  void Persist() { owner_ = false; }
+  // Видаляє ім'я області; наявні відображення лишаються дійсними.
+  static void Unlink(const std::string& name);
+
+  void* data() const { return data_; }
+  size_t size() const { return size_; }
+  const std::string& name() const { return name_; }
+
+ private:
+  enum class Mode { kCreate, kOpen, kOpenReadOnly, kOpenOrCreate };
+
+  bool Map(const std::string& name, size_t size, Mode mode);
+
+  void* data_ = nullptr;
+  size_t size_ = 0;
+  std::string name_;
+  bool owner_ = false;
+#ifdef _WIN32
+  void* mapping_ = nullptr;
+#endif
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_IPC_SHARED_MEMORY_H_
@@ -0,0 +1,177 @@
+#include "ipc/spsc_ring.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace virok {
+
+namespace {
+
+constexpr uint32_t kRingMagic = 0x52494E47;  // "RING"
+// Мітка в полі довжини: решта буфера порожня, читати з початку.
+constexpr uint32_t kWrapMarker = 0xFFFFFFFF;
+// Скільки споживач крутиться перед сном: повідомлення, що приходять
+// щільно одне за одним, не платять за пробудження.
+constexpr auto kSpin = std::chrono::microseconds(20);
+
+size_t Align8(size_t n) { return (n + 7) & ~size_t{7}; }
+
+size_t HeaderSize() { return (sizeof(SpscRingHeader) + 63) & ~size_t{63}; }
+
+}  // namespace
+
+size_t SpscRing::RegionSize(size_t capacity) {
+  return HeaderSize() + Align8(capacity);
+}
+
+SpscRing::~SpscRing() {
+#ifdef _WIN32
+  if (event_) CloseHandle(event_);
+#endif
+}
+
+bool SpscRing::Init(void* memory, size_t capacity,
+                    const std::string& bell_name) {
+  header_ = new (memory) SpscRingHeader();
+  header_->magic = kRingMagic;
+  header_->capacity = static_cast<uint32_t>(Align8(capacity));
+  data_ = static_cast<uint8_t*>(memory) + HeaderSize();
+  return OpenBell(bell_name);
+}
+
+bool SpscRing::Attach(void* memory, const std::string& bell_name) {
+  auto* header = static_cast<SpscRingHeader*>(memory);
+  if (header->magic != kRingMagic) return false;
+  header_ = header;
+  data_ = static_cast<uint8_t*>(memory) + HeaderSize();
+  return OpenBell(bell_name);
+}
+
+bool SpscRing::TryWrite(const void* data, size_t size) {
+  const size_t capacity = header_->capacity;
+  if (size > capacity / 2) return false;
+  const size_t record = Align8(sizeof(uint32_t) + size);
+
+  uint64_t head = header_->head.load(std::memory_order_relaxed);
+  const uint64_t tail = header_->tail.load(std::memory_order_acquire);
+  size_t offset = static_cast<size_t>(head % capacity);
+  const size_t contiguous = capacity - offset;
+  const size_t needed = record + (record > contiguous ? contiguous : 0);
+  if (head - tail + needed > capacity) return false;
+
+  if (record > contiguous) {
+    std::memcpy(data_ + offset, &kWrapMarker, sizeof(uint32_t));
+    head += contiguous;
+    offset = 0;
+  }
+  const uint32_t length = static_cast<uint32_t>(size);
+  std::memcpy(data_ + offset, &length, sizeof(uint32_t));
+  std::memcpy(data_ + offset + sizeof(uint32_t), data, size);
+  // Мітка переходу й запис стають видимі одним збереженням.
+  header_->head.store(head + record, std::memory_order_release);
+
+  header_->bell.fetch_add(1);
+  if (header_->sleeping.load()) Wake();
+  return true;
+}
+
+bool SpscRing::TryRead(std::string* out) {
+  const size_t capacity = header_->capacity;
+  uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+  const uint64_t head = header_->head.load(std::memory_order_acquire);
+  if (tail == head) return false;
+
+  size_t offset = static_cast<size_t>(tail % capacity);
+  uint32_t length;
+  std::memcpy(&length, data_ + offset, sizeof(uint32_t));
+  if (length == kWrapMarker) {
+    tail += capacity - offset;
+    offset = 0;
+    std::memcpy(&length, data_, sizeof(uint32_t));
+  }
+  out->assign(reinterpret_cast<const char*>(data_ + offset + sizeof(uint32_t)),
+              length);
+  header_->tail.store(tail + Align8(sizeof(uint32_t) + length),
+                      std::memory_order_release);
+  return true;
+}
+
+bool SpscRing::Empty() const {
+  return header_->head.load(std::memory_order_acquire) ==
+         header_->tail.load(std::memory_order_relaxed);
+}
+
+void SpscRing::Reset() {
+  header_->head.store(0);
+  header_->tail.store(0);
+  header_->sleeping.store(0);
+}
+
+bool SpscRing::Wait(std::chrono::milliseconds timeout) {
+  using Clock = std::chrono::steady_clock;
+  const auto spin_until = Clock::now() + kSpin;
+  while (Clock::now() < spin_until) {
+    if (!Empty()) return true;
+    std::this_thread::yield();
+  }
+
+  // Лічильник читаємо до перевірки: запис після неї змінить його, і сон
+  // (futex з очікуваним значенням) не почнеться.
+  const uint32_t seen = header_->bell.load();
+  if (!Empty()) return true;
+  header_->sleeping.store(1);
+#ifdef _WIN32
+  if (Empty()) WaitForSingleObject(event_, static_cast<DWORD>(timeout.count()));
+#elif defined(__linux__)
+  timespec ts;
+  ts.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+  ts.tv_nsec = static_cast<long>(timeout.count() % 1000 * 1000000);
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&header_->bell), FUTEX_WAIT,
+          seen, &ts, nullptr, 0);
+#else
+  (void)seen;
+  std::this_thread::sleep_for(std::min(
+      timeout, std::chrono::duration_cast<std::chrono::milliseconds>(kSpin * 50)));
+#endif
+  header_->sleeping.store(0);
+  return !Empty();
+}
+
+void SpscRing::Ring() {
+  header_->bell.fetch_add(1);
+  Wake();
+}
+
+void SpscRing::Wake() {
+#ifdef _WIN32
+  SetEvent(event_);
+#elif defined(__linux__)
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&header_->bell), FUTEX_WAKE,
+          1, nullptr, nullptr, 0);
+#endif
+}
+
+bool SpscRing::OpenBell(const std::string& name) {
+#ifdef _WIN32
+  if (event_) CloseHandle(event_);
+  // Автоскидна подія: обидві сторони "створюють" її, друга отримує наявну.
+  event_ = CreateEventA(nullptr, FALSE, FALSE, ("Local\\" + name).c_str());
+  return event_ != nullptr;
+#else
+  (void)name;
+  return true;
+#endif
+}
+
+}  // namespace virok
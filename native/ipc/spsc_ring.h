@@ -0,0 +1,87 @@
+#ifndef NATIVE_IPC_SPSC_RING_H_
+#define NATIVE_IPC_SPSC_RING_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace virok {
+
+// Заголовок кільця в спільній пам'яті. Позиції — лічильники байтів від
+// початку (не зміщення), тож порожнє й повне кільце не плутаються.
+struct SpscRingHeader {
+  uint32_t magic;
+  uint32_t capacity;
+  alignas(64) std::atomic<uint64_t> head;  // пише лише виробник
+  alignas(64) std::atomic<uint64_t> tail;  // пише лише споживач
+  // Дзвінок: лічильник записів (слово futex на Linux) і ознака, що
+  // споживач спить.
+  alignas(64) std::atomic<uint32_t> bell;
+  std::atomic<uint32_t> sleeping;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "ring positions are shared between processes");
+
+// Кільце повідомлень змінної довжини з одним виробником і одним
+// споживачем, що живуть у різних процесах. Без блокувань: запис і читання
+// — це копія байтів і одне release-збереження позиції.
+//
+// Повідомлення: [u32 довжина][дані], вирівняні на 8 байтів; якщо до кінця
+// буфера не вміщається, виробник ставить мітку переходу на початок.
+// Споживач, якому нема чого читати, спить на дзвінку (futex у спільній
+// пам'яті або іменована подія Windows), тож порожнє кільце не їсть CPU.
+class SpscRing {
+ public:
+  // Розмір області для кільця з |capacity| байтів даних (кратне 8).
+  static size_t RegionSize(size_t capacity);
+
+  SpscRing() = default;
+  ~SpscRing();
+
+  SpscRing(const SpscRing&) = delete;
+  SpscRing& operator=(const SpscRing&) = delete;
+
+  // Розмічає нове кільце в |memory| (власник області).
+  bool Init(void* memory, size_t capacity, const std::string& bell_name);
+  // Під'єднується до розміченого кільця.
+  bool Attach(void* memory, const std::string& bell_name);
+
+  // Виробник. False, якщо місця немає або повідомлення задовге
+  // (більше за capacity/2).
+  bool TryWrite(const void* data, size_t size);
+
+  // Споживач. False, якщо кільце порожнє.
+  bool TryRead(std::string* out);
+
+  // Споживач: чекає повідомлення не довше за |timeout|. Може повернутися
+  // раніше (Ring, сигнал) — тоді False, якщо кільце досі порожнє.
+  bool Wait(std::chrono::milliseconds timeout);
+
+  // Будить споживача, що спить у Wait (закриття, перезапуск).
+  void Ring();
+
+  bool Empty() const;
+
+  // Скидає позиції. Лише коли жодна зі сторін не працює з кільцем
+  // (інший процес завершився).
+  void Reset();
+
+  size_t capacity() const { return header_ ? header_->capacity : 0; }
+
+ private:
+  bool OpenBell(const std::string& name);
+  void Wake();
+
+  SpscRingHeader* header_ = nullptr;
+  uint8_t* data_ = nullptr;
+#ifdef _WIN32
+  void* event_ = nullptr;
+#endif
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_IPC_SPSC_RING_H_
@@ -0,0 +1,328 @@
+#include "json/json_reader.h"
+
+#include <cstdlib>
+
+namespace virok {
+
+namespace {
+
+constexpr int kMaxDepth = 64;
+
+int HexDigit(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+void AppendUtf8(uint32_t cp, std::string* out) {
+  if (cp < 0x80) {
+    out->push_back(static_cast<char>(cp));
+  } else if (cp < 0x800) {
+    out->push_back(static_cast<char>(0xC0 | (cp >> 6)));
+    out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  } else if (cp < 0x10000) {
+    out->push_back(static_cast<char>(0xE0 | (cp >> 12)));
+    out->push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  } else {
+    out->push_back(static_cast<char>(0xF0 | (cp >> 18)));
+    out->push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  }
+}
+
+}  // namespace
+
+JsonReader::JsonReader(std::string_view input) : input_(input) {}
+
+JsonReader::Token JsonReader::Fail(const char* message) {
+  error_ = std::string(message) + " at offset " + std::to_string(pos_);
+  last_ = Token::kError;
+  return last_;
+}
+
+void JsonReader::SkipWhitespace() {
+  while (pos_ < input_.size()) {
+    const char c = input_[pos_];
+    if (c != ' ' && c != '\n' && c != '\r' && c != '\t') break;
+    pos_++;
+  }
+}
+
+JsonReader::Token JsonReader::Next() {
+  if (last_ == Token::kError || last_ == Token::kEnd) return last_;
+
+  SkipWhitespace();
+  const bool in_object = depth_ > 0 && ((object_mask_ >> (depth_ - 1)) & 1);
+
+  if (after_value_) {
+    if (depth_ == 0) {
+      if (pos_ != input_.size()) return Fail("Trailing characters");
+      return last_ = Token::kEnd;
+    }
+    if (pos_ == input_.size()) return Fail("Unexpected end of input");
+    const char c = input_[pos_];
+    if (c == ',') {
+      pos_++;
+      after_value_ = false;
+      expect_key_ = in_object;
+      SkipWhitespace();
+    } else if (c == (in_object ? '}' : ']')) {
+      pos_++;
+      depth_--;
+      return last_ = in_object ? Token::kEndObject : Token::kEndArray;
+    } else {
+      return Fail("Expected ',' or closing bracket");
+    }
+  } else if (pos_ < input_.size() &&
+             (last_ == Token::kBeginObject || last_ == Token::kBeginArray)) {
+    // Порожній контейнер: "{}" або "[]".
+    const char c = input_[pos_];
+    if (c == (in_object ? '}' : ']')) {
+      pos_++;
+      depth_--;
+      after_value_ = true;
+      expect_key_ = false;
+      return last_ = in_object ? Token::kEndObject : Token::kEndArray;
+    }
+  }
+
+  if (pos_ == input_.size()) return Fail("Unexpected end of input");
+
+  if (expect_key_) {
+    if (input_[pos_] != '"') return Fail("Expected object key");
+    if (!ReadString()) return last_;
+    SkipWhitespace();
+    if (pos_ == input_.size() || input_[pos_] != ':') {
+      return Fail("Expected ':'");
+    }
+    pos_++;
+    expect_key_ = false;
+    return last_ = Token::kKey;
+  }
+
+  const char c = input_[pos_];
+  switch (c) {
+    case '{':
+    case '[':
+      if (depth_ == kMaxDepth) return Fail("Nesting too deep");
+      pos_++;
+      if (c == '{') {
+        object_mask_ |= uint64_t{1} << depth_;
+      } else {
+        object_mask_ &= ~(uint64_t{1} << depth_);
+      }
+      depth_++;
+      expect_key_ = c == '{';
+      after_value_ = false;
+      last_ = c == '{' ? Token::kBeginObject : Token::kBeginArray;
+      // Ключ перевіряється на наступному виклику, щоб "{}" пройшов гілкою
+      // порожнього контейнера.
+      if (expect_key_) {
+        SkipWhitespace();
+        if (pos_ < input_.size() && input_[pos_] == '}') expect_key_ = false;
+      }
+      return last_;
+    case '"':
+      if (!ReadString()) return last_;
+      after_value_ = true;
+      return last_ = Token::kString;
+    case 't':
+      if (!ReadLiteral("true")) return last_;
+      bool_ = true;
+      after_value_ = true;
+      return last_ = Token::kBool;
+    case 'f':
+      if (!ReadLiteral("false")) return last_;
+      bool_ = false;
+      after_value_ = true;
+      return last_ = Token::kBool;
+    case 'n':
+      if (!ReadLiteral("null")) return last_;
+      after_value_ = true;
+      return last_ = Token::kNull;
+    default:
+      if (c == '-' || (c >= '0' && c <= '9')) {
+        if (!ReadNumber()) return last_;
+        after_value_ = true;
+        return last_ = Token::kNumber;
+      }
+      return Fail("Unexpected character");
+  }
+}
+
+bool JsonReader::ReadString() {
+  const size_t start = ++pos_;
+  // Швидкий шлях: рядок без escape-послідовностей повертаємо як view.
+  while (pos_ < input_.size()) {
+    const char c = input_[pos_];
+    if (c == '"') {
+      text_ = input_.substr(start, pos_ - start);
+      pos_++;
+      return true;
+    }
+    if (c == '\\') break;
+    pos_++;
+  }
+  if (pos_ == input_.size()) {
+    Fail("Unterminated string");
+    return false;
+  }
+
+  unescaped_.assign(input_.data() + start, pos_ - start);
+  while (pos_ < input_.size()) {
+    const char c = input_[pos_++];
+    if (c == '"') {
+      text_ = unescaped_;
+      return true;
+    }
+    if (c != '\\') {
+      unescaped_.push_back(c);
+      continue;
+    }
+    if (pos_ == input_.size()) break;
+    const char e = input_[pos_++];
+    switch (e) {
+      case '"': unescaped_.push_back('"'); break;
+      case '\\': unescaped_.push_back('\\'); break;
+      case '/': unescaped_.push_back('/'); break;
+      case 'b': unescaped_.push_back('\b'); break;
+      case 'f': unescaped_.push_back('\f'); break;
+      case 'n': unescaped_.push_back('\n'); break;
+      case 'r': unescaped_.push_back('\r'); break;
+      case 't': unescaped_.push_back('\t'); break;
+      case 'u': {
+        auto read_hex4 = [this](uint32_t* out) {
+          if (pos_ + 4 > input_.size()) return false;
+          uint32_t v = 0;
+          for (int i = 0; i < 4; i++) {
+            const int d = HexDigit(input_[pos_ + i]);
+            if (d < 0) return false;
+            v = (v << 4) | static_cast<uint32_t>(d);
+          }
+          pos_ += 4;
+          *out = v;
+          return true;
+        };
+        uint32_t cp;
+        if (!read_hex4(&cp)) {
+          Fail("Invalid \\u escape");
+          return false;
+        }
+        // Сурогатна пара UTF-16.
+        if (cp >= 0xD800 && cp <= 0xDBFF && pos_ + 1 < input_.size() &&
+            input_[pos_] == '\\' && input_[pos_ + 1] == 'u') {
+          pos_ += 2;
+          uint32_t low;
+          if (!read_hex4(&low)) {
+            Fail("Invalid \\u escape");
+            return false;
+          }
+          if (low >= 0xDC00 && low <= 0xDFFF) {
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+          } else {
+            AppendUtf8(0xFFFD, &unescaped_);
+            cp = low;
+          }
+        } else if (cp >= 0xD800 && cp <= 0xDFFF) {
+          cp = 0xFFFD;
+        }
+        AppendUtf8(cp, &unescaped_);
+        break;
+      }
+      default:
+        Fail("Invalid escape");
+        return false;
+    }
+  }
+  Fail("Unterminated string");
+  return false;
+}
+
+bool JsonReader::ReadNumber() {
+  const size_t start = pos_;
+  if (input_[pos_] == '-') pos_++;
+  auto digits = [this]() {
+    const size_t from = pos_;
+    while (pos_ < input_.size() && input_[pos_] >= '0' && input_[pos_] <= '9') {
+      pos_++;
+    }
+    return pos_ > from;
+  };
+  if (!digits()) {
+    Fail("Invalid number");
+    return false;
+  }
+  if (pos_ < input_.size() && input_[pos_] == '.') {
+    pos_++;
+    if (!digits()) {
+      Fail("Invalid number");
+      return false;
+    }
+  }
+  if (pos_ < input_.size() && (input_[pos_] == 'e' || input_[pos_] == 'E')) {
+    pos_++;
+    if (pos_ < input_.size() && (input_[pos_] == '+' || input_[pos_] == '-')) {
+      pos_++;
+    }
+    if (!digits()) {
+      Fail("Invalid number");
+      return false;
+    }
+  }
+  text_ = input_.substr(start, pos_ - start);
+  return true;
+}
+
+bool JsonReader::ReadLiteral(std::string_view literal) {
+  if (input_.substr(pos_, literal.size()) != literal) {
+    Fail("Invalid literal");
+    return false;
+  }
+  pos_ += literal.size();
+  return true;
+}
+
+double JsonReader::number() const {
+  // text_ не нуль-термінований: копіюємо в локальний буфер (числа короткі).
+  char buf[64];
+  const size_t n = text_.size() < sizeof(buf) - 1 ? text_.size() : sizeof(buf) - 1;
+  text_.copy(buf, n);
+  buf[n] = '\0';
+  return std::strtod(buf, nullptr);
+}
+
+int64_t JsonReader::integer() const {
+  int64_t value = 0;
+  size_t i = 0;
+  const bool negative = !text_.empty() && text_[0] == '-';
+  if (negative) i++;
+  for (; i < text_.size(); i++) {
+    const char c = text_[i];
+    if (c < '0' || c > '9') return static_cast<int64_t>(number());
+    value = value * 10 + (c - '0');
+  }
+  return negative ? -value : value;
+}
+
+bool JsonReader::Skip() {
+  if (last_ == Token::kKey) {
+    // Пропускаємо значення цього ключа.
+    const Token t = Next();
+    if (t == Token::kError || t == Token::kEnd) return false;
+    return Skip();
+  }
+  if (last_ != Token::kBeginObject && last_ != Token::kBeginArray) {
+    return last_ != Token::kError;
+  }
+  const int target = depth_ - 1;
+  while (depth_ > target) {
+    const Token t = Next();
+    if (t == Token::kError || t == Token::kEnd) return false;
+  }
+  return true;
+}
+
+}  // namespace virok
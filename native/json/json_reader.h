@@ -0,0 +1,88 @@
+#ifndef NATIVE_JSON_JSON_READER_H_
+#define NATIVE_JSON_JSON_READER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace virok {
+
+// Потоковий (pull) читач JSON без побудови дерева.
+//
+// Читач віддає токени по одному; вкладені об'єкти, які не потрібні,
+// пропускаються через Skip() без жодних алокацій. Рядки без escape-
+// послідовностей повертаються як view у вхідний буфер, тож вхід має жити
+// довше за прочитані значення.
+class JsonReader {
+ public:
+  enum class Token {
+    kBeginObject,
+    kEndObject,
+    kBeginArray,
+    kEndArray,
+    kKey,
+    kString,
+    kNumber,
+    kBool,
+    kNull,
+    kEnd,
+    kError,
+  };
+
+  explicit JsonReader(std::string_view input);
+
+  JsonReader(const JsonReader&) = delete;
+  JsonReader& operator=(const JsonReader&) = delete;
+
+  // Наступний токен. Після kError або kEnd завжди повертає те саме.
+  Token Next();
+
+  // Текст поточного kKey або kString (вже без escape-послідовностей).
+  std::string_view text() const { return text_; }
+
+  // Сире представлення поточного kNumber ("15.65", "-3", "1e3").
+  std::string_view number_text() const { return text_; }
+
+  double number() const;
+  int64_t integer() const;
+  bool boolean() const { return bool_; }
+
+  // Пропускає значення, що починається поточним токеном (для kBeginObject /
+  // kBeginArray — до парної дужки включно). Повертає false при помилці.
+  bool Skip();
+
+  // Глибина вкладеності після поточного токена.
+  int depth() const { return depth_; }
+
+  const std::string& error() const { return error_; }
+  size_t offset() const { return pos_; }
+
+ private:
+  Token Fail(const char* message);
+  void SkipWhitespace();
+  bool ReadString();
+  bool ReadNumber();
+  bool ReadLiteral(std::string_view literal);
+
+  std::string_view input_;
+  size_t pos_ = 0;
+  int depth_ = 0;
+
+  // Стек контейнерів як бітова маска (1 = об'єкт), щоб не алокувати:
+  // звіти мають глибину 4-5, ліміт 64 з великим запасом.
+  uint64_t object_mask_ = 0;
+  // Очікуємо ключ (після '{' або ',' всередині об'єкта).
+  bool expect_key_ = false;
+  bool after_value_ = false;
+
+  Token last_ = Token::kNull;
+  std::string_view text_;
+  std::string unescaped_;
+  bool bool_ = false;
+  std::string error_;
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_JSON_JSON_READER_H_
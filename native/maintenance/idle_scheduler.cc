@@ -0,0 +1,256 @@
+#include "maintenance/idle_scheduler.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "metrics/metrics.h"
+#include "trace/trace.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace virok {
+
+namespace {
+
+// Найдовший сон потоку між опитуваннями: страхує від годинника, що
+// стрибнув, і від переповнення в wait_until.
+constexpr auto kMaxSleep = std::chrono::minutes(1);
+
+// Обслуговування не має відбирати процесор у каси навіть між вводами.
+void LowerThreadPriority() {
+#ifdef _WIN32
+  ::SetThreadPriority(::GetCurrentThread(), THREAD_PRIORITY_IDLE);
+#elif defined(__linux__)
+  sched_param param{};
+  pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+#endif
+}
+
+Counter* JobCounter(const char* name, const char* help,
+                    const std::string& job) {
+  return MetricsRegistry::Get().GetCounter(name, help,
+                                           MetricLabel("job", job));
+}
+
+}  // namespace
+
+IdleScheduler::IdleScheduler(IdleSchedulerOptions options)
+    : last_input_(std::numeric_limits<Clock::rep>::min() / 2),
+      options_(options) {}
+
+IdleScheduler::~IdleScheduler() { Stop(); }
+
+void IdleScheduler::AddJob(MaintenanceJob job, Clock::time_point first_due) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Entry entry;
+  entry.job = std::move(job);
+  entry.due = first_due;
+  jobs_.push_back(std::move(entry));
+  kicked_ = true;
+  wake_.notify_all();
+}
+
+void IdleScheduler::set_options(const IdleSchedulerOptions& options) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  options_ = options;
+  kicked_ = true;
+  wake_.notify_all();
+}
+
+void IdleScheduler::OnInput(Clock::time_point now) {
+  last_input_.store(now.time_since_epoch().count(),
+                    std::memory_order_relaxed);
+  if (!yield_.exchange(true) && in_step_.load()) {
+    yield_since_.store(Clock::now().time_since_epoch().count());
+  }
+}
+
+void IdleScheduler::SetCartOpen(bool open) {
+  if (open) {
+    cart_open_.store(true);
+    yield_.store(true);
+    return;
+  }
+  cart_open_.store(false);
+  std::lock_guard<std::mutex> lock(mutex_);
+  kicked_ = true;
+  wake_.notify_all();
+}
+
+void IdleScheduler::Wake() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  woken_ = true;
+  kicked_ = true;
+  wake_.notify_all();
+}
+
+IdleScheduler::Clock::time_point IdleScheduler::LastInput() const {
+  return Clock::time_point(
+      Clock::duration(last_input_.load(std::memory_order_relaxed)));
+}
+
+int IdleScheduler::PickDue(Clock::time_point now) const {
+  int best = -1;
+  for (size_t i = 0; i < jobs_.size(); i++) {
+    if (jobs_[i].due > now) continue;
+    if (best < 0 || jobs_[i].due < jobs_[best].due) {
+      best = static_cast<int>(i);
+    }
+  }
+  return best;
+}
+
+IdleScheduler::Clock::time_point IdleScheduler::Poll(Clock::time_point now) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  // Скидання до перевірки простою: введення, що прийде після неї, крок
+  // побачить через прапорець.
+  yield_.store(false);
+  yield_since_.store(0);
+  const Clock::time_point idle_at = LastInput() + options_.idle_after;
+  if (cart_open_.load() || now < idle_at) {
+    if (active_ >= 0 && !preempted_) {
+      preempted_ = true;
+      preemptions_++;
+      const MaintenanceJob& job = jobs_[active_].job;
+      JobCounter("virok_maintenance_preemptions_total",
+                 "Maintenance jobs interrupted by lane input", job.name)
+          ->Add();
+      if (job.preempt) {
+        std::function<void()> preempt = job.preempt;
+        lock.unlock();
+        preempt();
+      }
+    }
+    // Відкритий чек закриває SetCartOpen, він і розбудить потік.
+    return cart_open_.load() ? now + kMaxSleep : idle_at;
+  }
+  preempted_ = false;
+
+  if (active_ < 0) {
+    active_ = PickDue(now);
+    woken_ = false;
+  }
+  if (active_ < 0) {
+    Clock::time_point next = Clock::time_point::max();
+    for (const Entry& entry : jobs_) next = std::min(next, entry.due);
+    return next;
+  }
+  Entry& entry = jobs_[active_];
+  if (entry.waiting && !woken_ && now < entry.wait_until) {
+    return entry.wait_until;
+  }
+  entry.waiting = false;
+  woken_ = false;
+
+  in_step_.store(true);
+  lock.unlock();
+  MaintenanceStep step;
+  {
+    TraceScope trace_scope("maintenance", entry.job.name);
+    step = entry.job.step(MaintenanceYield(&yield_));
+  }
+  in_step_.store(false);
+  const Clock::rep since = yield_since_.exchange(0);
+  if (since != 0) {
+    static Histogram* const latency = MetricsRegistry::Get().GetHistogram(
+        "virok_maintenance_preempt_microseconds",
+        "Time from lane input to the end of the running maintenance step");
+    latency->Record(std::chrono::duration_cast<std::chrono::microseconds>(
+                        Clock::now() - Clock::time_point(Clock::duration(since)))
+                        .count());
+  }
+  lock.lock();
+
+  slices_++;
+  switch (step) {
+    case MaintenanceStep::kMore:
+      break;
+    case MaintenanceStep::kWait:
+      entry.waiting = true;
+      entry.wait_until = now + options_.wait_poll;
+      break;
+    case MaintenanceStep::kDone:
+      entry.runs++;
+      entry.due = now + entry.job.interval;
+      active_ = -1;
+      JobCounter("virok_maintenance_runs_total",
+                 "Completed maintenance jobs", entry.job.name)
+          ->Add();
+      break;
+    case MaintenanceStep::kFailed:
+      entry.failures++;
+      entry.due = now + options_.retry_after;
+      active_ = -1;
+      JobCounter("virok_maintenance_failures_total",
+                 "Failed maintenance jobs", entry.job.name)
+          ->Add();
+      break;
+  }
+  return now;
+}
+
+void IdleScheduler::Start() {
+  Stop();
+  OnInput(Clock::now());
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = false;
+  }
+  thread_ = std::thread(&IdleScheduler::Run, this);
+}
+
+void IdleScheduler::Stop() {
+  if (!thread_.joinable()) return;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+    wake_.notify_all();
+  }
+  yield_.store(true);
+  thread_.join();
+}
+
+void IdleScheduler::Run() {
+  LowerThreadPriority();
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stop_) {
+    lock.unlock();
+    Clock::time_point wake = Poll(Clock::now());
+    lock.lock();
+    const Clock::time_point now = Clock::now();
+    if (wake <= now) continue;
+    wake = std::min(wake, now + kMaxSleep);
+    wake_.wait_until(lock, wake, [this] { return stop_ || kicked_; });
+    kicked_ = false;
+  }
+}
+
+IdleSchedulerStatus IdleScheduler::status(Clock::time_point now) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  IdleSchedulerStatus status;
+  status.cart_open = cart_open_.load();
+  status.idle =
+      !status.cart_open && now >= LastInput() + options_.idle_after;
+  if (active_ >= 0) status.active = jobs_[active_].job.name;
+  status.slices = slices_;
+  status.preemptions = preemptions_;
+  for (const Entry& entry : jobs_) {
+    MaintenanceJobStatus job;
+    job.name = entry.job.name;
+    job.runs = entry.runs;
+    job.failures = entry.failures;
+    job.due_in_ms =
+        std::chrono::duration_cast<std::chrono::milliseconds>(entry.due - now)
+            .count();
+    status.jobs.push_back(std::move(job));
+  }
+  return status;
+}
+
+}  // namespace virok
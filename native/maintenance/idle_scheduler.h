@@ -0,0 +1,169 @@
+#ifndef NATIVE_MAINTENANCE_IDLE_SCHEDULER_H_
+#define NATIVE_MAINTENANCE_IDLE_SCHEDULER_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace virok {
+
+// Результат одного кроку задачі обслуговування.
+enum class MaintenanceStep {
+  // Робота ще є: наступний крок, поки каса простоює.
+  kMore,
+  // Задача чекає зовнішнього завершення (напр. виконується в Dart) і
+  // продовжиться після IdleScheduler::Wake().
+  kWait,
+  kDone,
+  kFailed,
+};
+
+// Передається в крок задачі: true — з'явилося введення (скан, клавіша) і
+// крок має повернутися якнайшвидше, зберігши місце, де зупинився.
+class MaintenanceYield {
+ public:
+  explicit MaintenanceYield(const std::atomic<bool>* flag) : flag_(flag) {}
+
+  bool ShouldYield() const { return flag_->load(std::memory_order_relaxed); }
+
+ private:
+  const std::atomic<bool>* flag_;
+};
+
+struct MaintenanceJob {
+  std::string name;
+  // Проміжок між завершеними запусками.
+  std::chrono::milliseconds interval = std::chrono::hours(1);
+  // Один короткий крок (одиниці мілісекунд). Стан між кроками тримає сама
+  // задача: витіснена, вона продовжує з того ж місця в наступному вікні
+  // простою.
+  std::function<MaintenanceStep(const MaintenanceYield& yield)> step;
+  // Необов'язково: каса ожила посеред задачі (для задач, що працюють поза
+  // кроками, як kWait).
+  std::function<void()> preempt;
+};
+
+struct IdleSchedulerOptions {
+  // Скільки без введення, щоб вважати касу вільною (і без відкритого
+  // чека).
+  std::chrono::milliseconds idle_after = std::chrono::seconds(30);
+  // Повтор задачі, що завершилася kFailed.
+  std::chrono::milliseconds retry_after = std::chrono::minutes(5);
+  // Як часто опитувати задачу в kWait, якщо Wake() так і не надійшов.
+  std::chrono::milliseconds wait_poll = std::chrono::seconds(1);
+};
+
+struct MaintenanceJobStatus {
+  std::string name;
+  uint64_t runs = 0;
+  uint64_t failures = 0;
+  // До наступного запуску (від'ємне — прострочено), мс.
+  int64_t due_in_ms = 0;
+};
+
+struct IdleSchedulerStatus {
+  bool idle = false;
+  bool cart_open = false;
+  // Розпочата й не завершена задача (зокрема витіснена).
+  std::string active;
+  uint64_t slices = 0;
+  uint64_t preemptions = 0;
+  std::vector<MaintenanceJobStatus> jobs;
+};
+
+// Фонове обслуговування каси у вікнах простою: дельта-синхронізація,
+// перебудова індексів, checkpoint бази, ущільнення архіву.
+//
+// Каса вільна, коли idle_after немає введення і не відкрито чек. Тоді
+// найбільш прострочена задача виконується кроками; між кроками
+// планувальник перевіряє простій знову. Введення (OnInput) лише ставить
+// атомарні прапорці й ніколи не чекає на крок: поточний крок бачить його
+// через MaintenanceYield, а наступний уже не починається. Витіснена задача
+// отримує preempt і продовжує, коли каса знову простоюватиме; нові задачі
+// до того часу не беруться.
+//
+// Poll детермінований щодо переданого часу (тести з модельною хронологією
+// введення); Start() запускає власний потік із найнижчим пріоритетом ОС.
+// Затримка від введення до завершення кроку пишеться в гістограму
+// virok_maintenance_preempt_microseconds. Потокобезпечний.
+class IdleScheduler {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit IdleScheduler(IdleSchedulerOptions options = {});
+  ~IdleScheduler();
+
+  IdleScheduler(const IdleScheduler&) = delete;
+  IdleScheduler& operator=(const IdleScheduler&) = delete;
+
+  // Перший запуск — не раніше |first_due|.
+  void AddJob(MaintenanceJob job, Clock::time_point first_due);
+  void set_options(const IdleSchedulerOptions& options);
+
+  // Скан, клавіша, дотик. З будь-якого потоку, без блокувань.
+  void OnInput(Clock::time_point now);
+  void SetCartOpen(bool open);
+  // Задача в kWait може продовжити.
+  void Wake();
+
+  // Один крок планувальника: витісняє задачу, якщо каса зайнята, або
+  // виконує один крок задачі. Повертає, коли викликати знову (|now| —
+  // одразу).
+  Clock::time_point Poll(Clock::time_point now);
+
+  // Власний потік, що викликає Poll. Запуск рахується як введення: спершу
+  // каса прогрівається, обслуговування — після простою.
+  void Start();
+  void Stop();
+  bool running() const { return thread_.joinable(); }
+
+  IdleSchedulerStatus status(Clock::time_point now) const;
+
+ private:
+  struct Entry {
+    MaintenanceJob job;
+    Clock::time_point due;
+    // kWait: опитати знову не пізніше.
+    bool waiting = false;
+    Clock::time_point wait_until;
+    uint64_t runs = 0;
+    uint64_t failures = 0;
+  };
+
+  void Run();
+  Clock::time_point LastInput() const;
+  // Задача з найранішим due <= |now| або -1.
+  int PickDue(Clock::time_point now) const;
+
+  std::atomic<Clock::rep> last_input_;
+  std::atomic<bool> cart_open_{false};
+  std::atomic<bool> yield_{false};
+  // Момент (Clock::now) першого введення під час кроку, для метрики.
+  std::atomic<Clock::rep> yield_since_{0};
+  std::atomic<bool> in_step_{false};
+
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  IdleSchedulerOptions options_;
+  // deque: кроки виконуються без м'ютекса, AddJob не переміщує записи.
+  std::deque<Entry> jobs_;
+  int active_ = -1;
+  bool preempted_ = false;
+  bool woken_ = false;
+  bool kicked_ = false;
+  bool stop_ = false;
+  uint64_t slices_ = 0;
+  uint64_t preemptions_ = 0;
+  std::thread thread_;
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_MAINTENANCE_IDLE_SCHEDULER_H_
@@ -0,0 +1,87 @@
+#include "metrics/histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace virok {
+
+namespace {
+
+constexpr int64_t kMaxValue = (int64_t{1} << Histogram::kMaxBits) - 1;
+
+int HighestBit(uint64_t v) {
+  int bit = 0;
+  while (v >>= 1) bit++;
+  return bit;
+}
+
+}  // namespace
+
+// Значення < kSubBuckets лежать у власних корзинах (точно). Далі кожен
+// інтервал [2^b, 2^(b+1)) ділиться на kSubBuckets рівних частин.
+size_t Histogram::BucketIndex(int64_t value) {
+  if (value < kSubBuckets) {
+    return static_cast<size_t>(std::max<int64_t>(0, value));
+  }
+  value = std::min(value, kMaxValue);
+  const int shift = HighestBit(static_cast<uint64_t>(value)) - kSubBits;
+  const int64_t sub = (value >> shift) - kSubBuckets;
+  return static_cast<size_t>(kSubBuckets * (shift + 1) + sub);
+}
+
+int64_t Histogram::BucketLowerBound(size_t index) {
+  const int64_t i = static_cast<int64_t>(index);
+  if (i < kSubBuckets) return i;
+  const int shift = static_cast<int>(i / kSubBuckets) - 1;
+  const int64_t sub = i % kSubBuckets;
+  return (kSubBuckets + sub) << shift;
+}
+
+int64_t Histogram::BucketUpperBound(size_t index) {
+  const int64_t i = static_cast<int64_t>(index);
+  if (i < kSubBuckets) return i;
+  const int shift = static_cast<int>(i / kSubBuckets) - 1;
+  return BucketLowerBound(index) + (int64_t{1} << shift) - 1;
+}
+
+void Histogram::Record(int64_t value) {
+  value = std::max<int64_t>(0, value);
+  buckets_[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(value, std::memory_order_relaxed);
+  int64_t prev = max_.load(std::memory_order_relaxed);
+  while (value > prev &&
+         !max_.compare_exchange_weak(prev, value, std::memory_order_relaxed)) {
+  }
+}
+
+HistogramSnapshot Histogram::Snapshot() const {
+  HistogramSnapshot s;
+  s.counts.resize(kBucketCount);
+  // Лічильники читаються не атомарно разом, тому count — сума корзин,
+  // щоб перцентилі завжди сходилися з розподілом.
+  for (size_t i = 0; i < kBucketCount; i++) {
+    s.counts[i] = buckets_[i].load(std::memory_order_relaxed);
+    s.count += s.counts[i];
+  }
+  s.sum = sum_.load(std::memory_order_relaxed);
+  s.max = max_.load(std::memory_order_relaxed);
+  return s;
+}
+
+int64_t HistogramSnapshot::Percentile(double q) const {
+  if (count == 0) return 0;
+  q = std::min(1.0, std::max(0.0, q));
+  const uint64_t rank = std::max<uint64_t>(
+      1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(count))));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < counts.size(); i++) {
+    seen += counts[i];
+    if (seen >= rank) {
+      return std::min(Histogram::BucketUpperBound(i), max);
+    }
+  }
+  return max;
+}
+
+}  // namespace virok
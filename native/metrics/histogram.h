@@ -0,0 +1,62 @@
+#ifndef NATIVE_METRICS_HISTOGRAM_H_
+#define NATIVE_METRICS_HISTOGRAM_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace virok {
+
+// Знімок гістограми: звичайні числа, які можна спокійно рахувати.
+struct HistogramSnapshot {
+  std::vector<uint64_t> counts;  // по корзинах Histogram
+  uint64_t count = 0;
+  int64_t sum = 0;
+  int64_t max = 0;
+
+  // Значення, нижче якого лежить частка |q| (0..1) вимірів. Похибка —
+  // ширина корзини, тобто не більше 1/Histogram::kSubBuckets від значення.
+  int64_t Percentile(double q) const;
+};
+
+// Гістограма в стилі HDR: лог-лінійні корзини (kSubBuckets на кожен степінь
+// двійки), тож відносна похибка однакова і для 50 мкс, і для 30 с.
+// Record — кілька relaxed-атомарних інкрементів без блокувань; писати можуть
+// будь-які потоки одночасно.
+class Histogram {
+ public:
+  static constexpr int kSubBits = 5;
+  static constexpr int64_t kSubBuckets = int64_t{1} << kSubBits;
+  // Найбільше точне значення ~2^40 (≈12.7 днів у мкс); більші обрізаються.
+  static constexpr int kMaxBits = 40;
+  static constexpr size_t kBucketCount =
+      static_cast<size_t>(kSubBuckets * (kMaxBits - kSubBits + 1));
+
+  Histogram() = default;
+
+  Histogram(const Histogram&) = delete;
+  Histogram& operator=(const Histogram&) = delete;
+
+  // Від'ємні значення рахуються як 0.
+  void Record(int64_t value);
+
+  HistogramSnapshot Snapshot() const;
+
+  static size_t BucketIndex(int64_t value);
+  // Найменше значення, що потрапляє в корзину |index|.
+  static int64_t BucketLowerBound(size_t index);
+  // Найбільше значення корзини |index|.
+  static int64_t BucketUpperBound(size_t index);
+
+ private:
+  std::array<std::atomic<uint64_t>, kBucketCount> buckets_{};
+  std::atomic<uint64_t> count_{0};
+  std::atomic<int64_t> sum_{0};
+  std::atomic<int64_t> max_{0};
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_METRICS_HISTOGRAM_H_
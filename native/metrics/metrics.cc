@@ -0,0 +1,166 @@
+#include "metrics/metrics.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <utility>
+
+namespace virok {
+
+namespace {
+
+// {a,b} з непорожніх частин; порожній рядок, якщо міток немає.
+std::string JoinLabels(const std::string& a, const std::string& b,
+                       const std::string& extra = std::string()) {
+  std::string out;
+  for (const std::string* part : {&a, &b, &extra}) {
+    if (part->empty()) continue;
+    out.push_back(out.empty() ? '{' : ',');
+    out.append(*part);
+  }
+  if (!out.empty()) out.push_back('}');
+  return out;
+}
+
+void AppendHeader(std::string* out, const std::string& name,
+                  const std::string& help, const char* type) {
+  out->append("# HELP ").append(name).push_back(' ');
+  for (char c : help) {
+    if (c == '\n') {
+      out->append("\\n");
+    } else {
+      if (c == '\\') out->push_back('\\');
+      out->push_back(c);
+    }
+  }
+  out->append("\n# TYPE ").append(name).push_back(' ');
+  out->append(type).push_back('\n');
+}
+
+void AppendSample(std::string* out, const std::string& name,
+                  const std::string& labels, const std::string& value) {
+  out->append(name).append(labels).push_back(' ');
+  out->append(value).push_back('\n');
+}
+
+template <typename T>
+T* SeriesLocked(std::map<std::string, std::unique_ptr<T>, std::less<>>* map,
+                std::string_view labels) {
+  auto it = map->find(labels);
+  if (it == map->end()) {
+    it = map->emplace(std::string(labels), std::make_unique<T>()).first;
+  }
+  return it->second.get();
+}
+
+}  // namespace
+
+std::string MetricLabel(std::string_view key, std::string_view value) {
+  std::string out(key);
+  out.append("=\"");
+  for (char c : value) {
+    if (c == '\\' || c == '"') {
+      out.push_back('\\');
+      out.push_back(c);
+    } else if (c == '\n') {
+      out.append("\\n");
+    } else {
+      out.push_back(c);
+    }
+  }
+  out.push_back('"');
+  return out;
+}
+
+MetricsRegistry& MetricsRegistry::Get() {
+  // Навмисно не руйнується: метрики пишуться й з потоків, що живуть
+  // довше за main().
+  static MetricsRegistry* registry = new MetricsRegistry();
+  return *registry;
+}
+
+MetricsRegistry::Family* MetricsRegistry::FamilyLocked(std::string_view name,
+                                                       std::string_view help,
+                                                       Type type) {
+  auto it = families_.find(name);
+  if (it == families_.end()) {
+    it = families_.emplace(std::string(name), Family{type, std::string(help)})
+             .first;
+  }
+  return it->second.type == type ? &it->second : &orphans_;
+}
+
+Counter* MetricsRegistry::GetCounter(std::string_view name,
+                                     std::string_view help,
+                                     std::string_view labels) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return SeriesLocked(&FamilyLocked(name, help, Type::kCounter)->counters,
+                      labels);
+}
+
+Gauge* MetricsRegistry::GetGauge(std::string_view name, std::string_view help,
+                                 std::string_view labels) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return SeriesLocked(&FamilyLocked(name, help, Type::kGauge)->gauges, labels);
+}
+
+Histogram* MetricsRegistry::GetHistogram(std::string_view name,
+                                         std::string_view help,
+                                         std::string_view labels) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return SeriesLocked(&FamilyLocked(name, help, Type::kHistogram)->histograms,
+                      labels);
+}
+
+void MetricsRegistry::SetConstLabels(std::string labels) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const_labels_ = std::move(labels);
+}
+
+void MetricsRegistry::WritePrometheus(std::string* out) {
+  static constexpr double kQuantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& [name, family] : families_) {
+    switch (family.type) {
+      case Type::kCounter:
+        AppendHeader(out, name, family.help, "counter");
+        for (const auto& [labels, counter] : family.counters) {
+          AppendSample(out, name, JoinLabels(const_labels_, labels),
+                       std::to_string(counter->value()));
+        }
+        break;
+      case Type::kGauge:
+        AppendHeader(out, name, family.help, "gauge");
+        for (const auto& [labels, gauge] : family.gauges) {
+          AppendSample(out, name, JoinLabels(const_labels_, labels),
+                       std::to_string(gauge->value()));
+        }
+        break;
+      case Type::kHistogram: {
+        AppendHeader(out, name, family.help, "summary");
+        std::string max_lines;
+        for (const auto& [labels, histogram] : family.histograms) {
+          const HistogramSnapshot s = histogram->Snapshot();
+          for (double q : kQuantiles) {
+            char quantile[32];
+            std::snprintf(quantile, sizeof(quantile), "quantile=\"%g\"", q);
+            AppendSample(out, name, JoinLabels(const_labels_, labels, quantile),
+                         std::to_string(s.Percentile(q)));
+          }
+          const std::string series = JoinLabels(const_labels_, labels);
+          AppendSample(out, name + "_sum", series, std::to_string(s.sum));
+          AppendSample(out, name + "_count", series, std::to_string(s.count));
+          AppendSample(&max_lines, name + "_max", series,
+                       std::to_string(s.max));
+        }
+        if (!max_lines.empty()) {
+          AppendHeader(out, name + "_max", "Maximum of " + name, "gauge");
+          out->append(max_lines);
+        }
+        break;
+      }
+    }
+  }
+}
+
+}  // namespace virok
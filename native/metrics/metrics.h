@@ -0,0 +1,111 @@
+#ifndef NATIVE_METRICS_METRICS_H_
+#define NATIVE_METRICS_METRICS_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "metrics/histogram.h"
+
+namespace virok {
+
+class Counter {
+ public:
+  void Add(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+  uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<uint64_t> value_{0};
+};
+
+// Поточне значення (глибина черги, кількість офлайн-чеків).
+class Gauge {
+ public:
+  void Set(int64_t v) { value_.store(v, std::memory_order_relaxed); }
+  void Add(int64_t n) { value_.fetch_add(n, std::memory_order_relaxed); }
+  int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<int64_t> value_{0};
+};
+
+// Мітка Prometheus з екрануванням значення: method="FiscalizeCheck".
+std::string MetricLabel(std::string_view key, std::string_view value);
+
+// Реєстр метрик процесу (одна каса = одна лінія).
+//
+// Get* бере м'ютекс і повертає стабільний вказівник, що живе до кінця
+// процесу, — гарячі місця зберігають його (static local) і далі пишуть
+// лише атомарними операціями. Серії групуються в сімейства за |name|;
+// |labels| — текст міток без дужок (див. MetricLabel). Одне ім'я має
+// один тип: запит іншого типу повертає серію, яка не експортується.
+class MetricsRegistry {
+ public:
+  static MetricsRegistry& Get();
+
+  Counter* GetCounter(std::string_view name, std::string_view help,
+                      std::string_view labels = {});
+  Gauge* GetGauge(std::string_view name, std::string_view help,
+                  std::string_view labels = {});
+  // Значення гістограм — мікросекунди (суфікс _microseconds у назві).
+  Histogram* GetHistogram(std::string_view name, std::string_view help,
+                          std::string_view labels = {});
+
+  // Мітки, що додаються до кожної серії, напр. lane="kasa-2".
+  void SetConstLabels(std::string labels);
+
+  // Знімок усіх метрик у текстовому форматі Prometheus 0.0.4. Гістограми
+  // експортуються як summary (квантилі 0.5/0.9/0.99/0.999) плюс _max.
+  void WritePrometheus(std::string* out);
+
+ private:
+  enum class Type { kCounter, kGauge, kHistogram };
+
+  struct Family {
+    Type type;
+    std::string help;
+    std::map<std::string, std::unique_ptr<Counter>, std::less<>> counters;
+    std::map<std::string, std::unique_ptr<Gauge>, std::less<>> gauges;
+    std::map<std::string, std::unique_ptr<Histogram>, std::less<>> histograms;
+  };
+
+  MetricsRegistry() = default;
+
+  Family* FamilyLocked(std::string_view name, std::string_view help,
+                       Type type);
+
+  std::mutex mutex_;
+  std::map<std::string, Family, std::less<>> families_;
+  std::string const_labels_;
+  // Серії для запитів з конфліктом типу: живі, але не експортуються.
+  Family orphans_{Type::kCounter, {}, {}, {}, {}};
+};
+
+// Записує у гістограму час від конструктора до деструктора (мкс).
+class LatencyTimer {
+ public:
+  explicit LatencyTimer(Histogram* histogram)
+      : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+
+  ~LatencyTimer() {
+    histogram_->Record(std::chrono::duration_cast<std::chrono::microseconds>(
+                           std::chrono::steady_clock::now() - start_)
+                           .count());
+  }
+
+  LatencyTimer(const LatencyTimer&) = delete;
+  LatencyTimer& operator=(const LatencyTimer&) = delete;
+
+ private:
+  Histogram* histogram_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_METRICS_METRICS_H_
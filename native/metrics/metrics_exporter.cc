@@ -0,0 +1,68 @@
+#include "metrics/metrics_exporter.h"
+
+#include <cstdio>
+
+#include "metrics/metrics.h"
+
+namespace virok {
+
+MetricsFileExporter::~MetricsFileExporter() { Stop(); }
+
+bool MetricsFileExporter::Start(const std::string& path,
+                                std::chrono::milliseconds interval) {
+  Stop();
+  std::lock_guard<std::mutex> lock(mutex_);
+  path_ = path;
+  if (!WriteLocked()) return false;
+  stop_ = false;
+  thread_ = std::thread([this, interval] { Loop(interval); });
+  return true;
+}
+
+void MetricsFileExporter::Stop() {
+  if (!thread_.joinable()) return;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  thread_.join();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  WriteLocked();
+}
+
+bool MetricsFileExporter::WriteNow() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return WriteLocked();
+}
+
+void MetricsFileExporter::Loop(std::chrono::milliseconds interval) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!wake_.wait_for(lock, interval, [this] { return stop_; })) {
+    WriteLocked();
+  }
+}
+
+bool MetricsFileExporter::WriteLocked() {
+  if (path_.empty()) return false;
+  text_.clear();
+  MetricsRegistry::Get().WritePrometheus(&text_);
+
+  const std::string tmp = path_ + ".tmp";
+  std::FILE* file = std::fopen(tmp.c_str(), "wb");
+  if (!file) return false;
+  const bool written =
+      std::fwrite(text_.data(), 1, text_.size(), file) == text_.size();
+  if (std::fclose(file) != 0 || !written) {
+    std::remove(tmp.c_str());
+    return false;
+  }
+#ifdef _WIN32
+  // rename на Windows не замінює наявний файл.
+  std::remove(path_.c_str());
+#endif
+  return std::rename(tmp.c_str(), path_.c_str()) == 0;
+}
+
+}  // namespace virok
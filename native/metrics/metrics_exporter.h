@@ -0,0 +1,51 @@
+#ifndef NATIVE_METRICS_METRICS_EXPORTER_H_
+#define NATIVE_METRICS_METRICS_EXPORTER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace virok {
+
+// Періодично записує знімок MetricsRegistry у файл у форматі Prometheus
+// (для node_exporter textfile collector або просто для перегляду).
+// Файл замінюється цілком через тимчасовий, тож читач ніколи не бачить
+// половину знімка.
+class MetricsFileExporter {
+ public:
+  MetricsFileExporter() = default;
+  ~MetricsFileExporter();
+
+  MetricsFileExporter(const MetricsFileExporter&) = delete;
+  MetricsFileExporter& operator=(const MetricsFileExporter&) = delete;
+
+  // Запускає фоновий потік, що пише |path| кожні |interval|. Перший знімок
+  // пишеться одразу; false, якщо його не вдалося записати.
+  bool Start(const std::string& path,
+             std::chrono::milliseconds interval = std::chrono::seconds(15));
+
+  // Пише останній знімок і зупиняє потік.
+  void Stop();
+
+  // Записує знімок зараз.
+  bool WriteNow();
+
+  bool running() const { return thread_.joinable(); }
+
+ private:
+  void Loop(std::chrono::milliseconds interval);
+  bool WriteLocked();
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::thread thread_;
+  bool stop_ = false;
+  std::string path_;
+  std::string text_;
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_METRICS_METRICS_EXPORTER_H_
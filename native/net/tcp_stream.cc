@@ -0,0 +1,216 @@
+#include "net/tcp_stream.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif
+
+namespace virok {
+
+namespace {
+
+constexpr int kSendTimeoutMs = 5000;
+
+#ifdef _WIN32
+
+using Socket = SOCKET;
+constexpr Socket kNoSocket = INVALID_SOCKET;
+
+std::string SocketError(const std::string& what) {
+  return what + " failed: " + std::to_string(WSAGetLastError());
+}
+
+bool InitSockets() {
+  static const bool ok = [] {
+    WSADATA data;
+    return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+  }();
+  return ok;
+}
+
+void CloseSocket(Socket s) { closesocket(s); }
+
+int PollOne(Socket s, short events, int timeout_ms) {
+  WSAPOLLFD pfd = {s, events, 0};
+  return WSAPoll(&pfd, 1, timeout_ms);
+}
+
+bool WouldBlock() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+
+void SetBlocking(Socket s, bool blocking) {
+  u_long mode = blocking ? 0 : 1;
+  ioctlsocket(s, FIONBIO, &mode);
+}
+
+void SetSendTimeout(Socket s) {
+  const DWORD timeout = kSendTimeoutMs;
+  setsockopt(s, SOL_SOCKET, SO_SNDTIMEO,
+             reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+}
+
+#else
+
+using Socket = int;
+constexpr Socket kNoSocket = -1;
+
+std::string SocketError(const std::string& what) {
+  return what + ": " + std::strerror(errno);
+}
+
+bool InitSockets() { return true; }
+
+void CloseSocket(Socket s) { close(s); }
+
+int PollOne(Socket s, short events, int timeout_ms) {
+  pollfd pfd = {s, events, 0};
+  const int ready = poll(&pfd, 1, timeout_ms);
+  return ready < 0 && errno == EINTR ? 0 : ready;
+}
+
+bool WouldBlock() { return errno == EINPROGRESS || errno == EAGAIN; }
+
+void SetBlocking(Socket s, bool blocking) {
+  const int flags = fcntl(s, F_GETFL, 0);
+  fcntl(s, F_SETFL, blocking ? flags & ~O_NONBLOCK : flags | O_NONBLOCK);
+}
+
+void SetSendTimeout(Socket s) {
+  timeval timeout{kSendTimeoutMs / 1000, 0};
+  setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+}
+
+#endif
+
+// Неблокуюче з'єднання з тайм-аутом; повертає сокет у блокуючому режимі.
+Socket ConnectTo(const addrinfo* ai, int timeout_ms, std::string* error) {
+  Socket s = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+  if (s == kNoSocket) {
+    *error = SocketError("socket");
+    return kNoSocket;
+  }
+  SetBlocking(s, false);
+  if (connect(s, ai->ai_addr, static_cast<int>(ai->ai_addrlen)) != 0) {
+    if (!WouldBlock()) {
+      *error = SocketError("connect");
+      CloseSocket(s);
+      return kNoSocket;
+    }
+    if (PollOne(s, POLLOUT, timeout_ms) <= 0) {
+      *error = "connect timeout";
+      CloseSocket(s);
+      return kNoSocket;
+    }
+    int so_error = 0;
+    socklen_t len = sizeof(so_error);
+    getsockopt(s, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&so_error),
+               &len);
+    if (so_error != 0) {
+#ifdef _WIN32
+      *error = "connect failed: " + std::to_string(so_error);
+#else
+      *error = std::string("connect: ") + std::strerror(so_error);
+#endif
+      CloseSocket(s);
+      return kNoSocket;
+    }
+  }
+  SetBlocking(s, true);
+  const int one = 1;
+  setsockopt(s, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&one),
+             sizeof(one));
+  SetSendTimeout(s);
+  return s;
+}
+
+}  // namespace
+
+TcpStream::~TcpStream() { Close(); }
+
+bool TcpStream::Connect(const std::string& host, uint16_t port,
+                        int timeout_ms, std::string* error) {
+  Close();
+  std::string local_error;
+  if (!error) error = &local_error;
+  if (!InitSockets()) {
+    *error = "WSAStartup failed";
+    return false;
+  }
+  addrinfo hints = {};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* found = nullptr;
+  const std::string service = std::to_string(port);
+  const int rc = getaddrinfo(host.c_str(), service.c_str(), &hints, &found);
+  if (rc != 0 || found == nullptr) {
+    *error = "cannot resolve " + host;
+    return false;
+  }
+  Socket s = kNoSocket;
+  for (const addrinfo* ai = found; ai && s == kNoSocket; ai = ai->ai_next) {
+    s = ConnectTo(ai, timeout_ms, error);
+  }
+  freeaddrinfo(found);
+  if (s == kNoSocket) {
+    *error = host + ":" + service + ": " + *error;
+    return false;
+  }
+  socket_ = static_cast<intptr_t>(s);
+  return true;
+}
+
+void TcpStream::Close() {
+  if (!is_open()) return;
+  CloseSocket(static_cast<Socket>(socket_));
+  socket_ = -1;
+}
+
+bool TcpStream::is_open() const { return socket_ != -1; }
+
+int TcpStream::Read(char* buf, size_t size, int timeout_ms,
+                    std::string* error) {
+  const Socket s = static_cast<Socket>(socket_);
+  const int ready = PollOne(s, POLLIN, timeout_ms);
+  if (ready < 0) {
+    if (error) *error = SocketError("poll");
+    return -1;
+  }
+  if (ready == 0) return 0;
+  const int n = static_cast<int>(recv(s, buf, static_cast<int>(size), 0));
+  if (n > 0) return n;
+  if (error) *error = n == 0 ? "connection closed" : SocketError("recv");
+  return -1;
+}
+
+bool TcpStream::Write(std::string_view data, std::string* error) {
+#ifdef _WIN32
+  constexpr int kFlags = 0;
+#else
+  constexpr int kFlags = MSG_NOSIGNAL;
+#endif
+  const Socket s = static_cast<Socket>(socket_);
+  while (!data.empty()) {
+    const int n = static_cast<int>(send(s, data.data(),
+                                        static_cast<int>(data.size()),
+                                        kFlags));
+    if (n <= 0) {
+      if (error) *error = SocketError("send");
+      return false;
+    }
+    data.remove_prefix(static_cast<size_t>(n));
+  }
+  return true;
+}
+
+}  // namespace virok
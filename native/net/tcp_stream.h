@@ -0,0 +1,45 @@
+#ifndef NATIVE_NET_TCP_STREAM_H_
+#define NATIVE_NET_TCP_STREAM_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace virok {
+
+// TCP-клієнт з тим самим контрактом, що й SerialPort: читання з
+// тайм-аутом, щоб потік вводу-виводу міг перевіряти, чи його не
+// зупиняють. Банківський термінал, мережевий принтер (RAW 9100).
+//
+// Read і Write можна викликати з різних потоків; Connect і Close — ні.
+class TcpStream {
+ public:
+  TcpStream() = default;
+  ~TcpStream();
+
+  TcpStream(const TcpStream&) = delete;
+  TcpStream& operator=(const TcpStream&) = delete;
+
+  // |host| — IP або ім'я. З'єднання без Nagle: кадри термінала короткі, і
+  // кожна затримка на них — затримка на касі.
+  bool Connect(const std::string& host, uint16_t port, int timeout_ms,
+               std::string* error);
+  void Close();
+  bool is_open() const;
+
+  // Чекає на дані до |timeout_ms| і читає те, що є, до |size| байтів.
+  // Повертає кількість байтів, 0 — тайм-аут, -1 — з'єднання закрито
+  // (причина в |error|).
+  int Read(char* buf, size_t size, int timeout_ms, std::string* error);
+  // Пише все або повертає false (тайм-аут відправки — 5 с).
+  bool Write(std::string_view data, std::string* error);
+
+ private:
+  // Дескриптор POSIX або SOCKET Winsock (INVALID_SOCKET — теж -1).
+  intptr_t socket_ = -1;
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_NET_TCP_STREAM_H_
@@ -0,0 +1,274 @@
+#include "parking/parked_cart.h"
+
+#include <chrono>
+#include <cmath>
+
+#include "json/json_reader.h"
+
+namespace virok {
+
+namespace {
+
+using Token = JsonReader::Token;
+
+constexpr uint8_t kFormatVersion = 1;
+
+void PutVarint(uint64_t v, std::string* out) {
+  while (v >= 0x80) {
+    out->push_back(static_cast<char>(v | 0x80));
+    v >>= 7;
+  }
+  out->push_back(static_cast<char>(v));
+}
+
+// Суми й час — zigzag-varint: ціна в копійках займає 2–4 байти замість 8.
+void PutSigned(int64_t v, std::string* out) {
+  PutVarint((static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63),
+            out);
+}
+
+void PutString(std::string_view s, std::string* out) {
+  PutVarint(s.size(), out);
+  out->append(s);
+}
+
+class Reader {
+ public:
+  explicit Reader(std::string_view data) : data_(data) {}
+
+  bool Byte(uint8_t* v) {
+    if (pos_ >= data_.size()) return false;
+    *v = static_cast<uint8_t>(data_[pos_++]);
+    return true;
+  }
+
+  bool Varint(uint64_t* v) {
+    *v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (pos_ >= data_.size()) return false;
+      const uint8_t b = static_cast<uint8_t>(data_[pos_++]);
+      *v |= static_cast<uint64_t>(b & 0x7F) << shift;
+      if (!(b & 0x80)) return true;
+    }
+    return false;
+  }
+
+  bool Signed(int64_t* v) {
+    uint64_t u;
+    if (!Varint(&u)) return false;
+    *v = static_cast<int64_t>(u >> 1) ^ -static_cast<int64_t>(u & 1);
+    return true;
+  }
+
+  bool String(std::string* s) {
+    uint64_t size;
+    if (!Varint(&size) || size > data_.size() - pos_) return false;
+    s->assign(data_.substr(pos_, size));
+    pos_ += size;
+    return true;
+  }
+
+  // Лічильник, не більший за залишок даних (захист від пошкодженого запису).
+  bool Count(size_t* count) {
+    uint64_t v;
+    if (!Varint(&v) || v > data_.size() - pos_) return false;
+    *count = static_cast<size_t>(v);
+    return true;
+  }
+
+  bool done() const { return pos_ == data_.size(); }
+
+ private:
+  std::string_view data_;
+  size_t pos_ = 0;
+};
+
+int64_t Kopecks(double uah) { return std::llround(uah * 100); }
+
+class CartParser {
+ public:
+  explicit CartParser(std::string_view json) : reader_(json) {}
+
+  bool Run(ParkedCart* cart, std::string* error) {
+    if (reader_.Next() != Token::kBeginObject || !ReadCart(cart)) {
+      if (error) {
+        *error = reader_.error().empty() ? "Malformed parked cart JSON"
+                                         : reader_.error();
+      }
+      return false;
+    }
+    if (cart->lines.empty()) {
+      if (error) *error = "Parked cart has no lines";
+      return false;
+    }
+    if (cart->parked_ms <= 0) {
+      cart->parked_ms =
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+              std::chrono::system_clock::now().time_since_epoch())
+              .count();
+    }
+    cart->total = 0;
+    for (const ParkedLine& line : cart->lines) {
+      cart->total += ParkedLineTotal(line);
+    }
+    return true;
+  }
+
+ private:
+  bool ReadCart(ParkedCart* cart) {
+    for (;;) {
+      const Token t = reader_.Next();
+      if (t == Token::kEndObject) return true;
+      if (t != Token::kKey) return false;
+      const std::string_view key = reader_.text();
+      bool ok;
+      if (key == "cashier") {
+        ok = ReadString(&cart->cashier);
+      } else if (key == "paymentForm") {
+        ok = ReadString(&cart->payment_form);
+      } else if (key == "parkedMs") {
+        double number = 0;
+        ok = ReadNumber(&number);
+        cart->parked_ms = static_cast<int64_t>(number);
+      } else if (key == "lines") {
+        ok = ReadLines(&cart->lines);
+      } else {
+        ok = reader_.Next() != Token::kError && reader_.Skip();
+      }
+      if (!ok) return false;
+    }
+  }
+
+  bool ReadLines(std::vector<ParkedLine>* lines) {
+    if (reader_.Next() != Token::kBeginArray) return false;
+    for (;;) {
+      const Token t = reader_.Next();
+      if (t == Token::kEndArray) return true;
+      if (t != Token::kBeginObject || !ReadLine(&lines->emplace_back())) {
+        return false;
+      }
+    }
+  }
+
+  bool ReadLine(ParkedLine* line) {
+    for (;;) {
+      const Token t = reader_.Next();
+      if (t == Token::kEndObject) return true;
+      if (t != Token::kKey) return false;
+      const std::string_view key = reader_.text();
+      bool ok;
+      double number = 0;
+      if (key == "guid") {
+        ok = ReadString(&line->guid);
+      } else if (key == "name") {
+        ok = ReadString(&line->name);
+      } else if (key == "article") {
+        ok = ReadString(&line->article);
+      } else if (key == "category") {
+        ok = ReadString(&line->category);
+      } else if (key == "price") {
+        ok = ReadNumber(&number);
+        line->price = Kopecks(number);
+      } else if (key == "quantity") {
+        ok = ReadNumber(&number);
+        line->quantity = static_cast<int32_t>(std::llround(number));
+      } else if (key == "weight") {
+        ok = ReadNumber(&number);
+        line->weight_g = std::llround(number * 1000);
+      } else if (key == "discount") {
+        ok = ReadNumber(&number);
+        line->discount = Kopecks(number);
+      } else {
+        ok = reader_.Next() != Token::kError && reader_.Skip();
+      }
+      if (!ok) return false;
+    }
+  }
+
+  bool ReadString(std::string* out) {
+    const Token t = reader_.Next();
+    if (t == Token::kNull) {
+      out->clear();
+      return true;
+    }
+    if (t != Token::kString && t != Token::kNumber) return false;
+    out->assign(reader_.text());
+    return true;
+  }
+
+  bool ReadNumber(double* out) {
+    const Token t = reader_.Next();
+    if (t == Token::kNull) {
+      *out = 0;
+      return true;
+    }
+    if (t != Token::kNumber) return false;
+    *out = reader_.number();
+    return true;
+  }
+
+  JsonReader reader_;
+};
+
+}  // namespace
+
+bool ParseParkedCart(std::string_view json, ParkedCart* cart,
+                     std::string* error) {
+  *cart = ParkedCart();
+  CartParser parser(json);
+  return parser.Run(cart, error);
+}
+
+int64_t ParkedLineTotal(const ParkedLine& line) {
+  // Як CartItem.total: ціна × маса (кг) або × штуки, мінус знижка.
+  const int64_t gross =
+      line.weight_g > 0 ? (line.price * line.weight_g + 500) / 1000
+                        : line.price * line.quantity;
+  return gross - line.discount;
+}
+
+void EncodeParkedCart(const ParkedCart& cart, std::string* out) {
+  out->push_back(static_cast<char>(kFormatVersion));
+  PutVarint(cart.id, out);
+  PutSigned(cart.parked_ms, out);
+  PutString(cart.cashier, out);
+  PutString(cart.payment_form, out);
+  PutSigned(cart.total, out);
+  PutVarint(cart.lines.size(), out);
+  for (const ParkedLine& line : cart.lines) {
+    PutString(line.guid, out);
+    PutString(line.name, out);
+    PutString(line.article, out);
+    PutString(line.category, out);
+    PutSigned(line.price, out);
+    PutSigned(line.quantity, out);
+    PutSigned(line.weight_g, out);
+    PutSigned(line.discount, out);
+  }
+}
+
+bool DecodeParkedCart(std::string_view data, ParkedCart* cart) {
+  Reader in(data);
+  uint8_t version;
+  size_t count;
+  if (!in.Byte(&version) || version != kFormatVersion ||
+      !in.Varint(&cart->id) || !in.Signed(&cart->parked_ms) ||
+      !in.String(&cart->cashier) || !in.String(&cart->payment_form) ||
+      !in.Signed(&cart->total) || !in.Count(&count)) {
+    return false;
+  }
+  cart->lines.resize(count);
+  for (ParkedLine& line : cart->lines) {
+    int64_t quantity;
+    if (!in.String(&line.guid) || !in.String(&line.name) ||
+        !in.String(&line.article) || !in.String(&line.category) ||
+        !in.Signed(&line.price) || !in.Signed(&quantity) ||
+        !in.Signed(&line.weight_g) || !in.Signed(&line.discount)) {
+      return false;
+    }
+    line.quantity = static_cast<int32_t>(quantity);
+  }
+  return in.done();
+}
+
+}  // namespace virok
@@ -0,0 +1,52 @@
+#ifndef NATIVE_PARKING_PARKED_CART_H_
+#define NATIVE_PARKING_PARKED_CART_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace virok {
+
+// Відкладений (паркований) кошик каси. Суми — у копійках, маса — у грамах.
+
+struct ParkedLine {
+  std::string guid;
+  std::string name;
+  std::string article;
+  std::string category;  // guid групи каталогу (для акцій)
+  int64_t price = 0;     // ціна на момент відкладення
+  int32_t quantity = 1;  // штуки
+  int64_t weight_g = 0;  // маса з ваг; 0 — штучний товар
+  int64_t discount = 0;  // знижка за акціями на весь рядок
+};
+
+struct ParkedCart {
+  uint64_t id = 0;  // призначає ParkedCartStore
+  int64_t parked_ms = 0;
+  std::string cashier;
+  std::string payment_form;
+  int64_t total = 0;
+  std::vector<ParkedLine> lines;
+};
+
+// Розбирає кошик з JSON каналу com.virok/parked:
+//   {"cashier", "paymentForm", "parkedMs",
+//    "lines": [{"guid", "name", "article", "category", "price", "quantity",
+//               "weight", "discount"}]}
+// Гроші — в гривнях, маса — в кг. total рахується з рядків; parkedMs —
+// поточний час, якщо не задано. Порожній кошик — помилка.
+bool ParseParkedCart(std::string_view json, ParkedCart* cart,
+                     std::string* error);
+
+// Сума рядка до сплати, копійки.
+int64_t ParkedLineTotal(const ParkedLine& line);
+
+// Компактний бінарний запис кошика (varint для довжин і лічильників,
+// zigzag-varint для сум): типовий кошик на 10 рядків — кількасот байтів.
+void EncodeParkedCart(const ParkedCart& cart, std::string* out);
+bool DecodeParkedCart(std::string_view data, ParkedCart* cart);
+
+}  // namespace virok
+
+#endif  // NATIVE_PARKING_PARKED_CART_H_
@@ -0,0 +1,367 @@
+#include "parking/parked_cart_store.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+#include "archive/crc32.h"
+
+#ifdef _WIN32
+#include <io.h>
+#include <share.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace virok {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr uint32_t kRecordMagic = 0x314B5056;  // "VPK1"
+constexpr size_t kHeaderBytes = 12;
+constexpr char kLogName[] = "parked.log";
+constexpr char kTempName[] = "parked.log.tmp";
+
+// Тип запису — перший байт тіла.
+constexpr char kOpPark = 'P';
+constexpr char kOpTake = 'T';
+
+// Переписувати журнал, коли мертвих записів більше за живі і не менше
+// за стільки байтів: десяток відкладених чеків на день не варто
+// переписувати щоразу.
+constexpr uint64_t kRewriteMinDeadBytes = 64 << 10;
+
+std::FILE* OpenFile(const std::string& path, const char* mode) {
+#ifdef _WIN32
+  const std::wstring wmode(mode, mode + std::strlen(mode));
+  return _wfsopen(fs::u8path(path).c_str(), wmode.c_str(), _SH_DENYNO);
+#else
+  return std::fopen(path.c_str(), mode);
+#endif
+}
+
+// fflush віддає дані ОС; fsync — на диск, щоб відкладений чек пережив
+// збій живлення, а не лише падіння застосунку.
+bool SyncFile(std::FILE* file) {
+  if (std::fflush(file) != 0) return false;
+#ifdef _WIN32
+  return _commit(_fileno(file)) == 0;
+#else
+  return fsync(fileno(file)) == 0;
+#endif
+}
+
+void PutU32(uint32_t v, char* out) {
+  for (int i = 0; i < 4; i++) out[i] = static_cast<char>(v >> (8 * i));
+}
+
+uint32_t GetU32(const char* in) {
+  uint32_t v = 0;
+  for (int i = 0; i < 4; i++) {
+    v |= static_cast<uint32_t>(static_cast<uint8_t>(in[i])) << (8 * i);
+  }
+  return v;
+}
+
+void PutU64(uint64_t v, std::string* out) {
+  for (int i = 0; i < 8; i++) out->push_back(static_cast<char>(v >> (8 * i)));
+}
+
+uint64_t GetU64(const char* in) {
+  uint64_t v = 0;
+  for (int i = 0; i < 8; i++) {
+    v |= static_cast<uint64_t>(static_cast<uint8_t>(in[i])) << (8 * i);
+  }
+  return v;
+}
+
+std::string TakePayload(uint64_t id) {
+  std::string payload(1, kOpTake);
+  PutU64(id, &payload);
+  return payload;
+}
+
+bool WriteRecord(std::FILE* file, const std::string& payload) {
+  char header[kHeaderBytes];
+  PutU32(kRecordMagic, header);
+  PutU32(static_cast<uint32_t>(payload.size()), header + 4);
+  PutU32(Crc32(payload.data(), payload.size()), header + 8);
+  return std::fwrite(header, 1, kHeaderBytes, file) == kHeaderBytes &&
+         std::fwrite(payload.data(), 1, payload.size(), file) ==
+             payload.size();
+}
+
+}  // namespace
+
+ParkedCartStore::~ParkedCartStore() { Close(); }
+
+bool ParkedCartStore::Open(const std::string& dir, std::string* error) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  CloseLocked();
+  std::error_code ec;
+  fs::create_directories(fs::u8path(dir), ec);
+  path_ = (fs::u8path(dir) / kLogName).u8string();
+  // Недописаний tmp лишився від збою посеред переписування: старий журнал
+  // ще цілий.
+  fs::remove(fs::u8path(dir) / kTempName, ec);
+  if (!ReplayLocked(error)) {
+    CloseLocked();
+    return false;
+  }
+  writer_ = OpenFile(path_, "ab");
+  if (!writer_) {
+    if (error) *error = "cannot append to " + path_;
+    CloseLocked();
+    return false;
+  }
+  if (dead_bytes_ >= kRewriteMinDeadBytes && dead_bytes_ * 2 > bytes_) {
+    RewriteLocked();
+  }
+  return true;
+}
+
+void ParkedCartStore::Close() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  CloseLocked();
+}
+
+bool ParkedCartStore::is_open() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return writer_ != nullptr;
+}
+
+void ParkedCartStore::CloseLocked() {
+  if (writer_) std::fclose(writer_);
+  writer_ = nullptr;
+  bytes_ = 0;
+  dead_bytes_ = 0;
+  next_id_ = 1;
+  carts_.clear();
+  by_time_.clear();
+  by_cashier_.clear();
+}
+
+bool ParkedCartStore::ReplayLocked(std::string* error) {
+  std::error_code ec;
+  const fs::path path = fs::u8path(path_);
+  if (!fs::exists(path, ec)) return true;
+  std::string data;
+  data.resize(fs::file_size(path, ec));
+  std::FILE* file = OpenFile(path_, "rb");
+  const bool read =
+      !ec && file &&
+      std::fread(&data[0], 1, data.size(), file) == data.size();
+  if (file) std::fclose(file);
+  if (!read) {
+    if (error) *error = "cannot read " + path_;
+    return false;
+  }
+
+  size_t offset = 0;
+  while (data.size() - offset >= kHeaderBytes) {
+    const char* header = data.data() + offset;
+    if (GetU32(header) != kRecordMagic) break;
+    const uint32_t size = GetU32(header + 4);
+    if (data.size() - offset - kHeaderBytes < size) break;
+    const std::string_view payload(header + kHeaderBytes, size);
+    if (Crc32(payload.data(), payload.size()) != GetU32(header + 8) ||
+        !ApplyLocked(payload)) {
+      break;
+    }
+    offset += kHeaderBytes + size;
+    bytes_ = offset;
+  }
+
+  if (offset != data.size()) {
+    // Обірваний хвіст після збою: відрізаємо, щоб дописувати після
+    // останнього цілого запису.
+    fs::resize_file(path, offset, ec);
+    if (ec) {
+      if (error) *error = "cannot truncate " + path_;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ParkedCartStore::ApplyLocked(std::string_view payload) {
+  const uint64_t record_bytes = kHeaderBytes + payload.size();
+  if (!payload.empty() && payload[0] == kOpTake && payload.size() == 9) {
+    const uint64_t id = GetU64(payload.data() + 1);
+    next_id_ = std::max(next_id_, id + 1);
+    dead_bytes_ += record_bytes;
+    auto it = carts_.find(id);
+    if (it == carts_.end()) return true;
+    const ParkedCartSummary& summary = it->second.summary;
+    const TimeKey key(summary.parked_ms, id);
+    by_time_.erase(key);
+    auto cashier = by_cashier_.find(summary.cashier);
+    cashier->second.erase(key);
+    if (cashier->second.empty()) by_cashier_.erase(cashier);
+    dead_bytes_ += kHeaderBytes + it->second.record.size();
+    carts_.erase(it);
+    return true;
+  }
+  if (payload.empty() || payload[0] != kOpPark) return false;
+
+  ParkedCart cart;
+  if (!DecodeParkedCart(payload.substr(1), &cart)) return false;
+  Entry entry;
+  entry.summary.id = cart.id;
+  entry.summary.parked_ms = cart.parked_ms;
+  entry.summary.cashier = std::move(cart.cashier);
+  entry.summary.payment_form = std::move(cart.payment_form);
+  entry.summary.total = cart.total;
+  entry.summary.lines = cart.lines.size();
+  entry.record.assign(payload);
+  next_id_ = std::max(next_id_, cart.id + 1);
+  IndexLocked(cart.id, std::move(entry));
+  return true;
+}
+
+void ParkedCartStore::IndexLocked(uint64_t id, Entry entry) {
+  const TimeKey key(entry.summary.parked_ms, id);
+  by_time_.insert(key);
+  by_cashier_[entry.summary.cashier].insert(key);
+  carts_[id] = std::move(entry);
+}
+
+bool ParkedCartStore::AppendLocked(const std::string& payload,
+                                   std::string* error) {
+  if (!WriteRecord(writer_, payload) || !SyncFile(writer_)) {
+    // Недописаний запис прибираємо одразу, інакше наступні записи
+    // опинилися б після сміття.
+    std::fclose(writer_);
+    std::error_code ec;
+    fs::resize_file(fs::u8path(path_), bytes_, ec);
+    writer_ = OpenFile(path_, "ab");
+    if (error) *error = "cannot write " + path_;
+    return false;
+  }
+  bytes_ += kHeaderBytes + payload.size();
+  return true;
+}
+
+bool ParkedCartStore::Park(ParkedCart* cart, std::string* error) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!writer_) {
+    if (error) *error = "Parked cart store is not open";
+    return false;
+  }
+  cart->id = next_id_;
+  std::string payload(1, kOpPark);
+  EncodeParkedCart(*cart, &payload);
+  if (!AppendLocked(payload, error)) return false;
+  next_id_++;
+  ApplyLocked(payload);
+  return true;
+}
+
+std::vector<ParkedCartSummary> ParkedCartStore::List(
+    const std::string& cashier) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const std::set<TimeKey>* keys = &by_time_;
+  if (!cashier.empty()) {
+    auto it = by_cashier_.find(cashier);
+    if (it == by_cashier_.end()) return {};
+    keys = &it->second;
+  }
+  std::vector<ParkedCartSummary> out;
+  out.reserve(keys->size());
+  for (auto it = keys->rbegin(); it != keys->rend(); ++it) {
+    out.push_back(carts_.at(it->second).summary);
+  }
+  return out;
+}
+
+bool ParkedCartStore::Get(uint64_t id, ParkedCart* cart,
+                          std::string* error) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = carts_.find(id);
+  if (it == carts_.end()) return false;
+  if (!DecodeParkedCart(std::string_view(it->second.record).substr(1),
+                        cart)) {
+    if (error) *error = "Corrupted parked cart";
+    return false;
+  }
+  return true;
+}
+
+bool ParkedCartStore::Take(uint64_t id, ParkedCart* cart,
+                           std::string* error) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!writer_) {
+    if (error) *error = "Parked cart store is not open";
+    return false;
+  }
+  auto it = carts_.find(id);
+  if (it == carts_.end()) return false;
+  if (!DecodeParkedCart(std::string_view(it->second.record).substr(1),
+                        cart)) {
+    if (error) *error = "Corrupted parked cart";
+    return false;
+  }
+  const std::string payload = TakePayload(id);
+  if (!AppendLocked(payload, error)) return false;
+  ApplyLocked(payload);
+  if (dead_bytes_ >= kRewriteMinDeadBytes && dead_bytes_ * 2 > bytes_) {
+    RewriteLocked();
+  }
+  return true;
+}
+
+bool ParkedCartStore::RewriteLocked() {
+  const fs::path path = fs::u8path(path_);
+  const fs::path temp = path.parent_path() / kTempName;
+  std::FILE* file = OpenFile(temp.u8string(), "wb");
+  if (!file) return false;
+  uint64_t bytes = 0;
+  uint64_t dead = 0;
+  bool ok = true;
+  for (const TimeKey& key : by_time_) {
+    const std::string& record = carts_.at(key.second).record;
+    ok = ok && WriteRecord(file, record);
+    bytes += kHeaderBytes + record.size();
+  }
+  // Надгробок останнього виданого id тримає лічильник id монотонним,
+  // навіть якщо сам кошик уже забрали.
+  if (ok && !carts_.count(next_id_ - 1) && next_id_ > 1) {
+    const std::string payload = TakePayload(next_id_ - 1);
+    ok = WriteRecord(file, payload);
+    dead = kHeaderBytes + payload.size();
+    bytes += dead;
+  }
+  ok = SyncFile(file) && ok;
+  std::fclose(file);
+  std::error_code ec;
+  if (!ok) {
+    fs::remove(temp, ec);
+    return false;
+  }
+
+  // Після rename старий дескриптор дописував би в уже видалений файл.
+  std::fclose(writer_);
+  fs::rename(temp, path, ec);
+  writer_ = OpenFile(path_, "ab");
+  if (ec) {
+    fs::remove(temp, ec);
+    return false;
+  }
+  bytes_ = bytes;
+  dead_bytes_ = dead;
+  return writer_ != nullptr;
+}
+
+ParkedCartStoreStats ParkedCartStore::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ParkedCartStoreStats stats;
+  stats.carts = carts_.size();
+  stats.bytes = bytes_;
+  stats.dead_bytes = dead_bytes_;
+  return stats;
+}
+
+}  // namespace virok
@@ -0,0 +1,104 @@
+#ifndef NATIVE_PARKING_PARKED_CART_STORE_H_
+#define NATIVE_PARKING_PARKED_CART_STORE_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "parking/parked_cart.h"
+
+namespace virok {
+
+// Рядок списку відкладених кошиків (без рядків кошика).
+struct ParkedCartSummary {
+  uint64_t id = 0;
+  int64_t parked_ms = 0;
+  std::string cashier;
+  std::string payment_form;
+  int64_t total = 0;
+  size_t lines = 0;
+};
+
+struct ParkedCartStoreStats {
+  size_t carts = 0;
+  uint64_t bytes = 0;
+  uint64_t dead_bytes = 0;
+};
+
+// Відкладені кошики каси, що переживають перезапуск і збій живлення.
+//
+// Один журнал parked.log: запис "відкласти" несе весь кошик
+// (EncodeParkedCart), запис "забрати" — лише id. Кожен запис — заголовок
+// {magic, довжина, CRC-32} і тіло; Park і Take повертаються лише після
+// fflush + fsync. Обірваний останній запис відрізається при відкритті.
+//
+// Живі кошики (на касі їх десятки) разом із закодованими записами тримаються
+// в пам'яті з індексами за id, часом і касиром: список і відновлення кошика
+// не читають диск. Коли мертві записи переважають живі, журнал переписується
+// в parked.log.tmp і атомарно підміняє старий. Потокобезпечний.
+class ParkedCartStore {
+ public:
+  ParkedCartStore() = default;
+  ~ParkedCartStore();
+
+  ParkedCartStore(const ParkedCartStore&) = delete;
+  ParkedCartStore& operator=(const ParkedCartStore&) = delete;
+
+  // Відкриває (створює) журнал у каталозі |dir|.
+  bool Open(const std::string& dir, std::string* error);
+  void Close();
+  bool is_open() const;
+
+  // Призначає cart->id і зберігає кошик.
+  bool Park(ParkedCart* cart, std::string* error);
+
+  // Кошики касира |cashier| (порожній — усіх), новіші першими.
+  std::vector<ParkedCartSummary> List(const std::string& cashier) const;
+
+  // Кошик без вилучення: відновлення спершу переносить рядки в чек, а
+  // прибирає кошик (Take) лише після цього. false без |error| — кошика
+  // немає.
+  bool Get(uint64_t id, ParkedCart* cart, std::string* error) const;
+
+  // Повертає кошик і прибирає його зі сховища. false без |error| — кошика
+  // з таким id немає (вже забрала інша каса або цей же касир).
+  bool Take(uint64_t id, ParkedCart* cart, std::string* error);
+
+  ParkedCartStoreStats stats() const;
+
+ private:
+  struct Entry {
+    ParkedCartSummary summary;
+    std::string record;  // тіло запису "відкласти", для Take і переписування
+  };
+
+  using TimeKey = std::pair<int64_t, uint64_t>;  // parked_ms, id
+
+  bool ReplayLocked(std::string* error);
+  bool ApplyLocked(std::string_view payload);
+  void IndexLocked(uint64_t id, Entry entry);
+  bool AppendLocked(const std::string& payload, std::string* error);
+  bool RewriteLocked();
+  void CloseLocked();
+
+  mutable std::mutex mutex_;
+  std::string path_;
+  std::FILE* writer_ = nullptr;
+  uint64_t bytes_ = 0;
+  uint64_t dead_bytes_ = 0;
+  uint64_t next_id_ = 1;
+
+  std::unordered_map<uint64_t, Entry> carts_;
+  std::set<TimeKey> by_time_;
+  std::unordered_map<std::string, std::set<TimeKey>> by_cashier_;
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_PARKING_PARKED_CART_STORE_H_
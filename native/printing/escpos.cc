@@ -0,0 +1,160 @@
+#include "printing/escpos.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+namespace virok {
+
+namespace {
+
+struct Base64Table {
+  std::array<int8_t, 256> values;
+
+  constexpr Base64Table() : values() {
+    for (auto& v : values) v = -1;
+    const char* alphabet =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    for (int i = 0; i < 64; i++) {
+      values[static_cast<unsigned char>(alphabet[i])] = static_cast<int8_t>(i);
+    }
+    // URL-safe варіант теж трапляється в логах/тестах.
+    values['-'] = 62;
+    values['_'] = 63;
+  }
+};
+
+constexpr Base64Table kBase64;
+
+// Верхня половина CP1251 (0x80-0xBF); 0xC0-0xFF — суцільний діапазон
+// А..я (U+0410-U+044F) і рахується арифметично.
+constexpr uint16_t kCp1251High[64] = {
+    0x0402, 0x0403, 0x201A, 0x0453, 0x201E, 0x2026, 0x2020, 0x2021,  // 80
+    0x20AC, 0x2030, 0x0409, 0x2039, 0x040A, 0x040C, 0x040B, 0x040F,  // 88
+    0x0452, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,  // 90
+    0x0000, 0x2122, 0x0459, 0x203A, 0x045A, 0x045C, 0x045B, 0x045F,  // 98
+    0x00A0, 0x040E, 0x045E, 0x0408, 0x00A4, 0x0490, 0x00A6, 0x00A7,  // A0
+    0x0401, 0x00A9, 0x0404, 0x00AB, 0x00AC, 0x00AD, 0x00AE, 0x0407,  // A8
+    0x00B0, 0x00B1, 0x0406, 0x0456, 0x0491, 0x00B5, 0x00B6, 0x00B7,  // B0
+    0x0451, 0x2116, 0x0454, 0x00BB, 0x0458, 0x0405, 0x0455, 0x0457,  // B8
+};
+
+char EncodeCp1251(uint32_t cp) {
+  if (cp < 0x80) return static_cast<char>(cp);
+  if (cp >= 0x0410 && cp <= 0x044F) return static_cast<char>(cp - 0x0350);
+  for (int i = 0; i < 64; i++) {
+    if (kCp1251High[i] == cp) return static_cast<char>(0x80 + i);
+  }
+  return '?';
+}
+
+}  // namespace
+
+bool Base64Decode(std::string_view input, std::string* out) {
+  out->reserve(out->size() + input.size() / 4 * 3);
+  uint32_t acc = 0;
+  int bits = 0;
+  for (const char c : input) {
+    if (c == '=') break;
+    const int8_t v = kBase64.values[static_cast<unsigned char>(c)];
+    if (v < 0) {
+      if (c == ' ' || c == '\n' || c == '\r' || c == '\t') continue;
+      return false;
+    }
+    acc = (acc << 6) | static_cast<uint32_t>(v);
+    bits += 6;
+    if (bits >= 8) {
+      bits -= 8;
+      out->push_back(static_cast<char>((acc >> bits) & 0xFF));
+    }
+  }
+  return true;
+}
+
+void Base64Encode(std::string_view input, std::string* out) {
+  static constexpr char kAlphabet[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  out->reserve(out->size() + (input.size() + 2) / 3 * 4);
+  size_t i = 0;
+  for (; i + 3 <= input.size(); i += 3) {
+    const uint32_t v = static_cast<uint8_t>(input[i]) << 16 |
+                       static_cast<uint8_t>(input[i + 1]) << 8 |
+                       static_cast<uint8_t>(input[i + 2]);
+    out->push_back(kAlphabet[v >> 18]);
+    out->push_back(kAlphabet[(v >> 12) & 63]);
+    out->push_back(kAlphabet[(v >> 6) & 63]);
+    out->push_back(kAlphabet[v & 63]);
+  }
+  const size_t rest = input.size() - i;
+  if (rest == 0) return;
+  uint32_t v = static_cast<uint8_t>(input[i]) << 16;
+  if (rest == 2) v |= static_cast<uint8_t>(input[i + 1]) << 8;
+  out->push_back(kAlphabet[v >> 18]);
+  out->push_back(kAlphabet[(v >> 12) & 63]);
+  out->push_back(rest == 2 ? kAlphabet[(v >> 6) & 63] : '=');
+  out->push_back('=');
+}
+
+bool Utf8ToCp1251(std::string_view input, std::string* out) {
+  out->reserve(out->size() + input.size());
+  const auto* p = reinterpret_cast<const unsigned char*>(input.data());
+  const auto* end = p + input.size();
+  while (p < end) {
+    // ASCII-відрізки (розмітка, цифри) копіюємо без розбору.
+    const auto* ascii_end = p;
+    while (ascii_end < end && *ascii_end < 0x80) ascii_end++;
+    if (ascii_end != p) {
+      out->append(reinterpret_cast<const char*>(p), ascii_end - p);
+      p = ascii_end;
+      if (p == end) break;
+    }
+
+    const unsigned char lead = *p;
+    int extra;
+    uint32_t cp;
+    if ((lead & 0xE0) == 0xC0) {
+      extra = 1;
+      cp = lead & 0x1F;
+    } else if ((lead & 0xF0) == 0xE0) {
+      extra = 2;
+      cp = lead & 0x0F;
+    } else if ((lead & 0xF8) == 0xF0) {
+      extra = 3;
+      cp = lead & 0x07;
+    } else {
+      return false;
+    }
+    if (end - p <= extra) return false;
+    for (int i = 1; i <= extra; i++) {
+      if ((p[i] & 0xC0) != 0x80) return false;
+      cp = (cp << 6) | (p[i] & 0x3F);
+    }
+    // Надлишкові (overlong) форми не є коректним UTF-8.
+    if ((extra == 1 && cp < 0x80) || (extra == 2 && cp < 0x800) ||
+        (extra == 3 && cp < 0x10000)) {
+      return false;
+    }
+    out->push_back(EncodeCp1251(cp));
+    p += extra + 1;
+  }
+  return true;
+}
+
+bool VisualizationToEscPos(std::string_view base64, std::string* out) {
+  out->clear();
+  std::string raw;
+  if (!Base64Decode(base64, &raw)) return false;
+
+  out->reserve(kEscPosInit.size() + raw.size() + kEscPosFeedCut.size());
+  out->append(kEscPosInit);
+  const size_t text_start = out->size();
+  if (!Utf8ToCp1251(raw, out)) {
+    // Не UTF-8 — отже текст уже в CP1251 (Cashalot), друкуємо як є.
+    out->resize(text_start);
+    out->append(raw);
+  }
+  out->append(kEscPosFeedCut);
+  return true;
+}
+
+}  // namespace virok
@@ -0,0 +1,33 @@
+#ifndef NATIVE_PRINTING_ESCPOS_H_
+#define NATIVE_PRINTING_ESCPOS_H_
+
+#include <string>
+#include <string_view>
+
+namespace virok {
+
+// Ті самі послідовності, що й у RawPrinterService:
+// ESC @ (ініціалізація) + ESC t 17 (кодова сторінка CP1251).
+constexpr std::string_view kEscPosInit("\x1B\x40\x1B\x74\x11", 5);
+// ESC d 4 (прогін 4 рядки) + GS V B 0 (часткова відрізка).
+constexpr std::string_view kEscPosFeedCut("\x1B\x64\x04\x1D\x56\x42\x00", 7);
+
+// Декодує Base64, пропускаючи пробіли й переводи рядків. Дописує в |out|.
+bool Base64Decode(std::string_view input, std::string* out);
+
+// Стандартний Base64 з вирівнюванням '='. Дописує в |out|.
+void Base64Encode(std::string_view input, std::string* out);
+
+// Перекодовує UTF-8 у Windows-1251; символи поза кодовою сторінкою
+// замінюються на '?'. Повертає false, якщо вхід не є коректним UTF-8
+// (тоді |out| містить лише частину, що встигла перекодуватися).
+bool Utf8ToCp1251(std::string_view input, std::string* out);
+
+// Base64-візуалізація звіту/чека -> готовий документ для принтера.
+// Vchasno віддає текст у UTF-8, Cashalot — вже у CP1251, тому кодування
+// визначається за вмістом. Результат замінює вміст |out|.
+bool VisualizationToEscPos(std::string_view base64, std::string* out);
+
+}  // namespace virok
+
+#endif  // NATIVE_PRINTING_ESCPOS_H_
@@ -0,0 +1,164 @@
+#include "printing/label_batch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "metrics/metrics.h"
+#include "net/tcp_stream.h"
+#include "printing/escpos.h"
+
+namespace virok {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kConnectTimeoutMs = 5000;
+
+double Micros(Clock::duration d) {
+  return std::chrono::duration<double, std::micro>(d).count();
+}
+
+// Межі завдань: перше — одна етикетка, далі по |chunk|.
+std::vector<size_t> ChunkBounds(size_t labels, size_t chunk) {
+  std::vector<size_t> bounds{0};
+  size_t next = std::min<size_t>(1, labels);
+  while (next > bounds.back()) {
+    bounds.push_back(next);
+    next = std::min(labels, next + chunk);
+  }
+  return bounds;
+}
+
+// Спільний стан верстальників і писача. Завдання i верстається в
+// |done[i]|; писач забирає їх строго по черзі.
+struct Pipeline {
+  std::mutex mutex;
+  std::condition_variable ready;     // зверстано завдання
+  std::condition_variable accepted;  // писач забрав завдання
+  std::vector<std::string> done;
+  std::vector<char> has;
+  size_t written = 0;
+  bool stop = false;
+};
+
+}  // namespace
+
+bool PrintLabelBatch(const std::vector<PriceLabel>& labels,
+                     const LabelTemplate& tmpl,
+                     const LabelBatchOptions& options, const LabelSink& sink,
+                     LabelBatchStats* stats, std::string* error) {
+  const Clock::time_point start = Clock::now();
+  const std::vector<size_t> bounds =
+      ChunkBounds(labels.size(), std::max<size_t>(options.chunk, 1));
+  const size_t tasks = bounds.size() - 1;
+  int threads = options.threads;
+  if (threads <= 0) {
+    threads = static_cast<int>(std::thread::hardware_concurrency());
+  }
+  threads = std::max(1, std::min(threads, static_cast<int>(tasks)));
+  const size_t window =
+      options.window ? options.window : static_cast<size_t>(threads) * 4;
+
+  LabelBatchStats result;
+  result.labels = labels.size();
+  result.threads = tasks ? threads : 0;
+
+  Pipeline pipe;
+  pipe.done.resize(tasks);
+  pipe.has.resize(tasks);
+  std::atomic<size_t> next{0};
+
+  auto layout = [&] {
+    for (;;) {
+      const size_t task = next.fetch_add(1, std::memory_order_relaxed);
+      if (task >= tasks) return;
+      {
+        std::unique_lock<std::mutex> lock(pipe.mutex);
+        pipe.accepted.wait(lock, [&] {
+          return pipe.stop || task < pipe.written + window;
+        });
+        if (pipe.stop) return;
+      }
+      std::string commands;
+      for (size_t i = bounds[task]; i < bounds[task + 1]; i++) {
+        AppendPriceLabel(labels[i], tmpl, &commands);
+      }
+      std::lock_guard<std::mutex> lock(pipe.mutex);
+      pipe.done[task] = std::move(commands);
+      pipe.has[task] = 1;
+      pipe.ready.notify_all();
+    }
+  };
+
+  std::vector<std::thread> workers;
+  workers.reserve(threads);
+  for (int i = 0; i < threads && tasks; i++) workers.emplace_back(layout);
+
+  bool ok = true;
+  std::string message;
+  for (size_t task = 0; task < tasks; task++) {
+    std::string commands;
+    {
+      std::unique_lock<std::mutex> lock(pipe.mutex);
+      pipe.ready.wait(lock, [&] { return pipe.has[task] != 0; });
+      // Переносимо, а не очищаємо: буфер звільняється після передачі.
+      commands = std::move(pipe.done[task]);
+    }
+    if (task == 0) commands.insert(0, kEscPosInit);
+    ok = sink(commands, &message);
+    {
+      std::lock_guard<std::mutex> lock(pipe.mutex);
+      pipe.written = task + 1;
+      if (!ok) pipe.stop = true;
+      pipe.accepted.notify_all();
+    }
+    if (!ok) break;
+    result.bytes += commands.size();
+    if (task == 0) result.first_label_us = Micros(Clock::now() - start);
+  }
+  for (std::thread& worker : workers) worker.join();
+
+  result.total_us = Micros(Clock::now() - start);
+  if (stats) *stats = result;
+  if (!ok && error) *error = message;
+  return ok;
+}
+
+bool PrintLabelBatchTo(const std::string& host, uint16_t port,
+                       const std::vector<PriceLabel>& labels,
+                       const LabelTemplate& tmpl,
+                       const LabelBatchOptions& options,
+                       LabelBatchStats* stats, std::string* error) {
+  TcpStream printer;
+  const bool ok =
+      printer.Connect(host, port, kConnectTimeoutMs, error) &&
+      PrintLabelBatch(
+          labels, tmpl, options,
+          [&printer](std::string_view data, std::string* write_error) {
+            return printer.Write(data, write_error);
+          },
+          stats, error);
+  MetricsRegistry& metrics = MetricsRegistry::Get();
+  if (ok) {
+    metrics
+        .GetCounter("virok_price_labels_total",
+                    "Shelf labels sent to the label printer")
+        ->Add(labels.size() * std::max(tmpl.copies, 1));
+  } else {
+    metrics
+        .GetCounter("virok_print_failures_total",
+                    "Failed raw prints to the receipt printer",
+                    MetricLabel("kind", "priceLabels"))
+        ->Add();
+  }
+  return ok;
+}
+
+}  // namespace virok
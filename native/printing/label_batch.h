@@ -0,0 +1,56 @@
+#ifndef NATIVE_PRINTING_LABEL_BATCH_H_
+#define NATIVE_PRINTING_LABEL_BATCH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "printing/label_layout.h"
+
+namespace virok {
+
+struct LabelBatchOptions {
+  // Потоків верстки; 0 — за кількістю ядер.
+  int threads = 0;
+  // Етикеток на завдання. Перше завдання — завжди одна етикетка, щоб
+  // принтер почав друкувати, поки верстаються решта.
+  size_t chunk = 32;
+  // Скільки завдань можна зверстати наперед, поки принтер не прийняв
+  // попередні (пам'ять пакета не росте з його розміром); 0 — 4 на потік.
+  size_t window = 0;
+};
+
+struct LabelBatchStats {
+  size_t labels = 0;
+  uint64_t bytes = 0;
+  int threads = 0;
+  // Від початку до повної передачі першої етикетки приймачу.
+  double first_label_us = 0;
+  double total_us = 0;
+};
+
+// Приймач команд принтера; false — зупинити пакет (причина в |error|).
+using LabelSink =
+    std::function<bool(std::string_view data, std::string* error)>;
+
+// Верстає |labels| паралельно і віддає ESC/POS у |sink| на потоці
+// викликача в порядку |labels|: передача йде одночасно з версткою
+// наступних. Перший виклик |sink| починається з kEscPosInit.
+bool PrintLabelBatch(const std::vector<PriceLabel>& labels,
+                     const LabelTemplate& tmpl,
+                     const LabelBatchOptions& options, const LabelSink& sink,
+                     LabelBatchStats* stats, std::string* error);
+
+// Те саме на мережевий принтер (RAW, порт 9100) одним з'єднанням.
+bool PrintLabelBatchTo(const std::string& host, uint16_t port,
+                       const std::vector<PriceLabel>& labels,
+                       const LabelTemplate& tmpl,
+                       const LabelBatchOptions& options,
+                       LabelBatchStats* stats, std::string* error);
+
+}  // namespace virok
+
+#endif  // NATIVE_PRINTING_LABEL_BATCH_H_
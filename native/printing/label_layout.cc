@@ -0,0 +1,212 @@
+#include "printing/label_layout.h"
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+#include "printing/escpos.h"
+
+namespace virok {
+namespace {
+
+// Точок у знаку шрифту A (12x24) — з цього рахується ширина штрихкоду.
+constexpr int kDotsPerChar = 12;
+constexpr int kBarcodeHeight = 64;
+
+struct PackUnit {
+  std::string_view suffix;
+  double scale;
+  const char* base;
+};
+
+// Довші суфікси раніше: "гр" не має розпізнатися як "г" + літера.
+constexpr PackUnit kPackUnits[] = {
+    {"кг", 1, "кг"},     {"гр", 0.001, "кг"}, {"мл", 0.001, "л"},
+    {"г", 0.001, "кг"},  {"л", 1, "л"},
+};
+
+bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+// Літера після суфікса означає, що це інше слово ("1 година").
+bool IsLetterAt(std::string_view s, size_t i) {
+  if (i >= s.size()) return false;
+  const unsigned char c = static_cast<unsigned char>(s[i]);
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= 0xD0 && c <= 0xD2);  // кирилиця в UTF-8
+}
+
+std::string FormatMoney(double value) {
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), "%.2f", value);
+  return buf;
+}
+
+void AppendCp1251(std::string_view utf8, std::string* out) {
+  const size_t start = out->size();
+  if (!Utf8ToCp1251(utf8, out)) {
+    out->resize(start);
+    out->push_back('?');
+  }
+}
+
+// Переносить назву (вже в CP1251, байт на знак) за словами в |lines|
+// рядків по |width|; що не вмістилось — обрізається з "…".
+void AppendWrapped(std::string_view text, size_t width, int lines,
+                   std::string* out) {
+  for (int line = 0; line < lines && !text.empty(); line++) {
+    while (!text.empty() && text.front() == ' ') text.remove_prefix(1);
+    size_t take = text.size();
+    if (take > width) {
+      take = text.rfind(' ', width);
+      if (take == std::string_view::npos || take == 0) take = width;
+    }
+    std::string_view part = text.substr(0, take);
+    text.remove_prefix(take);
+    while (!part.empty() && part.back() == ' ') part.remove_suffix(1);
+    const bool truncated =
+        line + 1 == lines && text.find_first_not_of(' ') !=
+                                 std::string_view::npos;
+    if (truncated) {
+      if (part.size() + 1 > width) part = part.substr(0, width - 1);
+      out->append(part);
+      out->push_back('\x85');  // "…" у CP1251
+    } else {
+      out->append(part);
+    }
+    out->push_back('\n');
+  }
+}
+
+// GS k (функція B): EAN-13/EAN-8 або CODE128 набору B. Символи поза
+// друкованим ASCII CODE128 не кодує — такий штрихкод лише текстом.
+void AppendBarcode(std::string_view barcode, int width, std::string* out) {
+  if (barcode.empty()) return;
+  std::string data;
+  char type;
+  int modules;
+  if (IsValidEan(barcode)) {
+    type = barcode.size() == 13 ? 67 : 68;
+    data.assign(barcode);
+    modules = barcode.size() == 13 ? 95 : 67;
+  } else {
+    for (char c : barcode) {
+      if (c < 0x20 || c > 0x7E) {
+        AppendCp1251(barcode, out);
+        out->push_back('\n');
+        return;
+      }
+    }
+    type = 73;
+    data = "{B";
+    for (char c : barcode) {
+      data.push_back(c);
+      if (c == '{') data.push_back('{');  // "{" у даних подвоюється
+    }
+    modules = 11 * static_cast<int>(barcode.size() + 3) + 2;
+  }
+  if (data.size() > 255) return;
+  const char module = modules * 2 <= width * kDotsPerChar ? 2 : 1;
+  const char setup[] = {'\x1D', 'h', static_cast<char>(kBarcodeHeight),
+                        '\x1D', 'w', module,
+                        '\x1D', 'H', '\x02'};  // цифри під штрихкодом
+  out->append(setup, sizeof(setup));
+  out->push_back('\x1D');
+  out->push_back('k');
+  out->push_back(type);
+  out->push_back(static_cast<char>(data.size()));
+  out->append(data);
+}
+
+}  // namespace
+
+bool ParsePackSize(std::string_view name, double* amount,
+                   const char** base_unit) {
+  bool found = false;
+  for (size_t i = 0; i < name.size(); i++) {
+    if (!IsDigit(name[i])) continue;
+    if (i > 0 && (IsDigit(name[i - 1]) || name[i - 1] == '.' ||
+                  name[i - 1] == ',')) {
+      continue;
+    }
+    double value = 0;
+    size_t j = i;
+    while (j < name.size() && IsDigit(name[j])) {
+      value = value * 10 + (name[j++] - '0');
+    }
+    if (j + 1 < name.size() && (name[j] == '.' || name[j] == ',') &&
+        IsDigit(name[j + 1])) {
+      double scale = 0.1;
+      for (j++; j < name.size() && IsDigit(name[j]); j++, scale /= 10) {
+        value += (name[j] - '0') * scale;
+      }
+    }
+    size_t k = j;
+    while (k < name.size() && name[k] == ' ') k++;
+    if (value <= 0) continue;
+    for (const PackUnit& unit : kPackUnits) {
+      if (name.compare(k, unit.suffix.size(), unit.suffix) != 0) continue;
+      if (IsLetterAt(name, k + unit.suffix.size())) break;
+      *amount = value * unit.scale;
+      *base_unit = unit.base;
+      found = true;
+      break;
+    }
+    i = j - 1;
+  }
+  return found;
+}
+
+bool IsValidEan(std::string_view barcode) {
+  if (barcode.size() != 8 && barcode.size() != 13) return false;
+  int sum = 0;
+  // Ваги 3 і 1 справа наліво, починаючи з цифри перед контрольною.
+  for (size_t i = 0; i + 1 < barcode.size(); i++) {
+    if (!IsDigit(barcode[i])) return false;
+    const size_t from_right = barcode.size() - 1 - i;
+    sum += (barcode[i] - '0') * (from_right % 2 == 1 ? 3 : 1);
+  }
+  if (!IsDigit(barcode.back())) return false;
+  return (10 - sum % 10) % 10 == barcode.back() - '0';
+}
+
+void AppendPriceLabel(const PriceLabel& label, const LabelTemplate& tmpl,
+                      std::string* out) {
+  const size_t width = tmpl.width > 8 ? tmpl.width : 8;
+  const size_t start = out->size();
+
+  out->append("\x1B\x61\x01", 3);  // ESC a 1: по центру
+  std::string name;
+  AppendCp1251(label.name, &name);
+  out->append("\x1B\x45\x01", 3);  // ESC E 1: жирний
+  AppendWrapped(name, width, 2, out);
+  out->append("\x1B\x45\x00", 3);
+
+  out->append("\x1D\x21\x11", 3);  // GS ! 0x11: подвійні ширина і висота
+  out->append(FormatMoney(label.price));
+  AppendCp1251(" грн\n", out);
+  out->append("\x1D\x21\x00", 3);
+
+  double amount;
+  const char* base_unit;
+  if (tmpl.unit_price && label.unit_name != "кг" && label.unit_name != "л" &&
+      ParsePackSize(label.name, &amount, &base_unit)) {
+    AppendCp1251("Ціна за 1 " + std::string(base_unit) + ": " +
+                     FormatMoney(label.price / amount) + " грн\n",
+                 out);
+  } else if (!label.unit_name.empty()) {
+    AppendCp1251("за 1 " + label.unit_name + "\n", out);
+  }
+  if (!label.article.empty()) {
+    AppendCp1251("Арт. " + label.article + "\n", out);
+  }
+  AppendBarcode(label.barcode, static_cast<int>(width), out);
+  out->append("\x1B\x61\x00", 3);
+  out->append(kEscPosFeedCut);
+
+  const size_t size = out->size() - start;
+  for (int copy = 1; copy < tmpl.copies; copy++) {
+    out->append(*out, start, size);
+  }
+}
+
+}  // namespace virok
@@ -0,0 +1,46 @@
+#ifndef NATIVE_PRINTING_LABEL_LAYOUT_H_
+#define NATIVE_PRINTING_LABEL_LAYOUT_H_
+
+#include <string>
+#include <string_view>
+
+namespace virok {
+
+// Дані цінника: те, що закон вимагає на полиці (назва, ціна, ціна за
+// одиницю виміру), і штрихкод для звірки на касі.
+struct PriceLabel {
+  std::string name;
+  std::string article;
+  std::string barcode;    // перший штрихкод товару; порожній — без нього
+  std::string unit_name;  // "шт", "кг", ...
+  double price = 0;
+};
+
+struct LabelTemplate {
+  // Знаків шрифту A в рядку: 32 для стрічки 58 мм, 48 для 80 мм.
+  int width = 32;
+  int copies = 1;
+  // Рядок "Ціна за 1 кг/л" для фасованих товарів з вагою чи об'ємом у
+  // назві.
+  bool unit_price = true;
+};
+
+// Вміст упаковки з назви ("Молоко 2.5% 900г", "Сік 1,5 л") у кілограмах
+// або літрах; |*base_unit| — "кг" чи "л". Береться останнє входження.
+// false — у назві немає ваги чи об'єму.
+bool ParsePackSize(std::string_view name, double* amount,
+                   const char** base_unit);
+
+// true — 8 чи 13 цифр з правильною контрольною цифрою (EAN-8/EAN-13).
+bool IsValidEan(std::string_view barcode);
+
+// Дописує в |out| ESC/POS однієї етикетки (у CP1251, з відрізкою; копії
+// — підряд): назва до двох рядків, ціна подвійним шрифтом, ціна за
+// одиницю, штрихкод (EAN, інакше CODE128, нелатинський — лише текстом).
+// Ініціалізацію принтера (kEscPosInit) викликач шле один раз на пакет.
+void AppendPriceLabel(const PriceLabel& label, const LabelTemplate& tmpl,
+                      std::string* out);
+
+}  // namespace virok
+
+#endif  // NATIVE_PRINTING_LABEL_LAYOUT_H_
@@ -0,0 +1,304 @@
+#include "promo/promo_engine.h"
+
+#include <algorithm>
+
+namespace virok {
+
+namespace {
+
+// Вартість рядка в копійках з округленням до копійки.
+int64_t LineAmount(int64_t price, int64_t qty_milli) {
+  return (price * qty_milli + 500) / 1000;
+}
+
+}  // namespace
+
+PromoCart::PromoCart(std::shared_ptr<const PromoRuleSet> rules)
+    : rules_(std::move(rules)), now_(PromoTime::Now()) {
+  states_.resize(rules_->size());
+  for (uint32_t i = 0; i < states_.size(); i++) {
+    states_[i].active = rules_->rules()[i].schedule.ActiveAt(now_);
+  }
+}
+
+void PromoCart::SetRules(std::shared_ptr<const PromoRuleSet> rules,
+                         std::vector<PromoLineDiscount>* changed) {
+  rules_ = std::move(rules);
+  Rebuild(changed);
+}
+
+void PromoCart::SetTime(const PromoTime& now,
+                        std::vector<PromoLineDiscount>* changed) {
+  last_evaluated_ = 0;
+  now_ = now;
+  for (uint32_t i = 0; i < states_.size(); i++) {
+    const bool active = rules_->rules()[i].schedule.ActiveAt(now);
+    if (active == states_[i].active) continue;
+    states_[i].active = active;
+    if (!states_[i].lines.empty()) Evaluate(i);
+  }
+  Settle(changed);
+}
+
+void PromoCart::SetLine(const std::string& item, const std::string& category,
+                        int64_t unit_price, int64_t qty_milli,
+                        std::vector<PromoLineDiscount>* changed) {
+  if (qty_milli <= 0) {
+    RemoveLine(item, changed);
+    return;
+  }
+  last_evaluated_ = 0;
+  auto inserted = lines_.try_emplace(item);
+  Line& line = inserted.first->second;
+  scratch_rules_.clear();
+  if (inserted.second || line.category != category) {
+    // Нова категорія — інші правила: старі переоцінюються без рядка.
+    for (uint32_t r : line.rules) {
+      auto& members = states_[r].lines;
+      members.erase(std::find(members.begin(), members.end(), &line));
+    }
+    scratch_rules_ = line.rules;
+    line.offers.clear();
+    line.item = item;
+    line.category = category;
+    rules_->Match(item, category, &line.rules);
+    for (uint32_t r : line.rules) states_[r].lines.push_back(&line);
+  }
+  line.price = unit_price;
+  line.qty = qty_milli;
+  if (!line.dirty) {
+    line.dirty = true;
+    dirty_.push_back(&line);
+  }
+
+  const size_t old_rules = scratch_rules_.size();
+  scratch_rules_.insert(scratch_rules_.end(), line.rules.begin(),
+                        line.rules.end());
+  std::inplace_merge(scratch_rules_.begin(),
+                     scratch_rules_.begin() + old_rules, scratch_rules_.end());
+  scratch_rules_.erase(
+      std::unique(scratch_rules_.begin(), scratch_rules_.end()),
+      scratch_rules_.end());
+  for (uint32_t r : scratch_rules_) EvaluateFor(r, &line);
+  Settle(changed);
+}
+
+void PromoCart::RemoveLine(const std::string& item,
+                           std::vector<PromoLineDiscount>* changed) {
+  last_evaluated_ = 0;
+  auto it = lines_.find(item);
+  if (it == lines_.end()) return;
+  Line& line = it->second;
+  for (uint32_t r : line.rules) {
+    auto& members = states_[r].lines;
+    members.erase(std::find(members.begin(), members.end(), &line));
+  }
+  if (line.discount) {
+    total_discount_ -= line.discount;
+    changed->push_back({item, 0});
+  }
+  const std::vector<uint32_t> rules = std::move(line.rules);
+  lines_.erase(it);
+  for (uint32_t r : rules) EvaluateFor(r, nullptr);
+  Settle(changed);
+}
+
+void PromoCart::Clear() {
+  lines_.clear();
+  for (RuleState& state : states_) state.lines.clear();
+  dirty_.clear();
+  total_discount_ = 0;
+}
+
+int64_t PromoCart::Discount(const std::string& item) const {
+  auto it = lines_.find(item);
+  return it == lines_.end() ? 0 : it->second.discount;
+}
+
+void PromoCart::Rebuild(std::vector<PromoLineDiscount>* changed) {
+  last_evaluated_ = 0;
+  states_.assign(rules_->size(), RuleState());
+  for (uint32_t i = 0; i < states_.size(); i++) {
+    states_[i].active = rules_->rules()[i].schedule.ActiveAt(now_);
+  }
+  dirty_.clear();
+  for (auto& entry : lines_) {
+    Line& line = entry.second;
+    rules_->Match(line.item, line.category, &line.rules);
+    for (uint32_t r : line.rules) states_[r].lines.push_back(&line);
+    line.offers.clear();
+    line.dirty = true;
+    dirty_.push_back(&line);
+  }
+  for (uint32_t i = 0; i < states_.size(); i++) {
+    if (!states_[i].lines.empty()) Evaluate(i);
+  }
+  Settle(changed);
+}
+
+void PromoCart::Evaluate(uint32_t rule_index) {
+  last_evaluated_++;
+  RuleState& state = states_[rule_index];
+  const PromoRule& rule = rules_->rules()[rule_index];
+  if (!state.active) {
+    for (Line* line : state.lines) Offer(line, rule_index, 0);
+    return;
+  }
+  switch (rule.kind) {
+    case PromoKind::kPercent:
+    case PromoKind::kUnitPrice:
+      EvaluatePercentOrPrice(rule, &state, rule_index);
+      break;
+    case PromoKind::kBundle:
+    case PromoKind::kGift:
+      EvaluateSet(rule, &state, rule_index);
+      break;
+  }
+}
+
+void PromoCart::EvaluateFor(uint32_t rule_index, Line* touched) {
+  RuleState& state = states_[rule_index];
+  const PromoRule& rule = rules_->rules()[rule_index];
+  if (rule.kind == PromoKind::kBundle || rule.kind == PromoKind::kGift) {
+    Evaluate(rule_index);
+    return;
+  }
+  // Рядок, що вийшов з правила (нова категорія), теж приходить сюди: його
+  // пропозиція вже знята, а решта рядків — як і кваліфікація нижче.
+  const bool member =
+      touched && std::binary_search(touched->rules.begin(),
+                                    touched->rules.end(), rule_index);
+  if (!state.active) {
+    if (member) Offer(touched, rule_index, 0);
+    return;
+  }
+  bool qualifies = true;
+  if (rule.min_qty > 0) {
+    int64_t total_qty = 0;
+    for (const Line* line : state.lines) total_qty += line->qty;
+    qualifies = total_qty >= rule.min_qty * 1000;
+  }
+  if (qualifies != state.qualified) {
+    Evaluate(rule_index);
+    return;
+  }
+  last_evaluated_++;
+  if (member) OfferPercentOrPrice(rule, qualifies, touched, rule_index);
+}
+
+void PromoCart::EvaluatePercentOrPrice(const PromoRule& rule, RuleState* state,
+                                       uint32_t rule_index) {
+  int64_t total_qty = 0;
+  for (const Line* line : state->lines) total_qty += line->qty;
+  const bool qualifies = total_qty >= rule.min_qty * 1000;
+  state->qualified = qualifies;
+  for (Line* line : state->lines) {
+    OfferPercentOrPrice(rule, qualifies, line, rule_index);
+  }
+}
+
+void PromoCart::OfferPercentOrPrice(const PromoRule& rule, bool qualifies,
+                                    Line* line, uint32_t rule_index) {
+  int64_t amount = 0;
+  if (qualifies && rule.kind == PromoKind::kPercent) {
+    amount =
+        (LineAmount(line->price, line->qty) * rule.percent_bp + 5000) / 10000;
+  } else if (qualifies && rule.price < line->price) {
+    amount = LineAmount(line->price - rule.price, line->qty);
+  }
+  Offer(line, rule_index, amount);
+}
+
+void PromoCart::EvaluateSet(const PromoRule& rule, RuleState* state,
+                            uint32_t rule_index) {
+  // Рядки від найдорожчого; у комплект ідуть лише цілі одиниці.
+  std::vector<Line*>& lines = state->lines;
+  std::sort(lines.begin(), lines.end(), [](const Line* a, const Line* b) {
+    return a->price != b->price ? a->price > b->price : a->item < b->item;
+  });
+  int64_t units = 0;
+  for (const Line* line : lines) units += line->qty / 1000;
+
+  std::vector<int64_t> taken(lines.size(), 0);
+  std::vector<int64_t> offers(lines.size(), 0);
+  if (rule.kind == PromoKind::kGift) {
+    // Кожні qty + free одиниць: free найдешевших — даром.
+    int64_t free = units / (rule.qty + rule.free_qty) * rule.free_qty;
+    for (size_t i = lines.size(); i-- > 0 && free > 0;) {
+      taken[i] = std::min(free, lines[i]->qty / 1000);
+      offers[i] = taken[i] * lines[i]->price;
+      free -= taken[i];
+    }
+  } else {
+    // Кожні qty одиниць (найдорожчі) — за price разом.
+    const int64_t bundles = units / rule.qty;
+    int64_t left = bundles * rule.qty;
+    int64_t regular = 0;
+    for (size_t i = 0; i < lines.size() && left > 0; i++) {
+      taken[i] = std::min(left, lines[i]->qty / 1000);
+      regular += taken[i] * lines[i]->price;
+      left -= taken[i];
+    }
+    const int64_t discount =
+        std::max<int64_t>(0, regular - bundles * rule.price);
+    int64_t allocated = 0;
+    for (size_t i = 0; discount && i < lines.size(); i++) {
+      offers[i] = discount * (taken[i] * lines[i]->price) / regular;
+      allocated += offers[i];
+    }
+    // Залишок копійок — найдорожчим рядкам, по копійці.
+    for (size_t i = 0; allocated < discount && i < lines.size(); i++) {
+      if (!taken[i]) continue;
+      offers[i]++;
+      allocated++;
+    }
+  }
+  for (size_t i = 0; i < lines.size(); i++) {
+    Offer(lines[i], rule_index, offers[i]);
+  }
+}
+
+void PromoCart::Offer(Line* line, uint32_t rule_index, int64_t amount) {
+  auto it = std::find_if(
+      line->offers.begin(), line->offers.end(),
+      [rule_index](const auto& offer) { return offer.first == rule_index; });
+  if (it == line->offers.end()) {
+    if (!amount) return;
+    line->offers.emplace_back(rule_index, amount);
+  } else if (!amount) {
+    line->offers.erase(it);
+  } else if (it->second != amount) {
+    it->second = amount;
+  } else {
+    return;
+  }
+  if (!line->dirty) {
+    line->dirty = true;
+    dirty_.push_back(line);
+  }
+}
+
+void PromoCart::Settle(std::vector<PromoLineDiscount>* changed) {
+  const std::vector<PromoRule>& rules = rules_->rules();
+  for (Line* line : dirty_) {
+    line->dirty = false;
+    int64_t best = 0;
+    int64_t stacked = 0;
+    for (const auto& offer : line->offers) {
+      if (rules[offer.first].stackable) {
+        stacked += offer.second;
+      } else {
+        best = std::max(best, offer.second);
+      }
+    }
+    const int64_t discount =
+        std::min(best + stacked, LineAmount(line->price, line->qty));
+    if (discount == line->discount) continue;
+    total_discount_ += discount - line->discount;
+    line->discount = discount;
+    changed->push_back({line->item, discount});
+  }
+  dirty_.clear();
+}
+
+}  // namespace virok
@@ -0,0 +1,111 @@
+#ifndef NATIVE_PROMO_PROMO_ENGINE_H_
+#define NATIVE_PROMO_PROMO_ENGINE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "promo/promo_rules.h"
+
+namespace virok {
+
+// Знижка рядка чека після зміни кошика.
+struct PromoLineDiscount {
+  std::string item;
+  int64_t discount = 0;  // копійки, на весь рядок
+};
+
+// Кошик з інкрементальним розрахунком акцій.
+//
+// Рядок чека — товар (guid) з категорією, ціною одиниці і кількістю. Кожне
+// правило пропонує рядкам знижку незалежно від інших правил; знижка рядка
+// — найбільша з нескладних пропозицій плюс сума складних, не більше
+// вартості рядка. Тому зміна рядка переоцінює лише правила, що його
+// стосуються (індекс PromoRuleSet), а не весь набір.
+//
+// Знижки комплектів (kBundle, kGift) розподіляються між рядками
+// пропорційно їхній вартості в комплекті, залишок копійок — найдорожчим.
+// Не потокобезпечний.
+class PromoCart {
+ public:
+  explicit PromoCart(std::shared_ptr<const PromoRuleSet> rules);
+
+  PromoCart(const PromoCart&) = delete;
+  PromoCart& operator=(const PromoCart&) = delete;
+
+  // Новий набір правил: кошик переоцінюється повністю.
+  void SetRules(std::shared_ptr<const PromoRuleSet> rules,
+                std::vector<PromoLineDiscount>* changed);
+
+  // Час для розкладу акцій; переоцінюються лише правила, що ввімкнулися
+  // або вимкнулися.
+  void SetTime(const PromoTime& now, std::vector<PromoLineDiscount>* changed);
+
+  // Додає або змінює рядок (кількість у тисячних; 0 — видалити).
+  // |changed| отримує рядки, чия знижка змінилася.
+  void SetLine(const std::string& item, const std::string& category,
+               int64_t unit_price, int64_t qty_milli,
+               std::vector<PromoLineDiscount>* changed);
+  void RemoveLine(const std::string& item,
+                  std::vector<PromoLineDiscount>* changed);
+  void Clear();
+
+  int64_t Discount(const std::string& item) const;
+  int64_t total_discount() const { return total_discount_; }
+  size_t size() const { return lines_.size(); }
+
+  // Скільки правил переоцінила остання зміна (бенчмарк, метрики).
+  size_t last_evaluated() const { return last_evaluated_; }
+
+ private:
+  struct Line {
+    std::string item;
+    std::string category;
+    int64_t price = 0;
+    int64_t qty = 0;  // тисячні
+    std::vector<uint32_t> rules;
+    // Пропозиції правил цьому рядку: (номер правила, копійки).
+    std::vector<std::pair<uint32_t, int64_t>> offers;
+    int64_t discount = 0;
+    bool dirty = false;
+  };
+
+  struct RuleState {
+    std::vector<Line*> lines;
+    bool active = false;
+    // kPercent/kUnitPrice: чи виконано min_qty при останній повній оцінці.
+    bool qualified = false;
+  };
+
+  void Rebuild(std::vector<PromoLineDiscount>* changed);
+  void Evaluate(uint32_t rule_index);
+  // Оцінка після зміни одного рядка (|touched|; nullptr — рядок видалено).
+  // Знижки на одиницю не залежать від інших рядків, поки не змінилася
+  // кваліфікація min_qty, тож глобальні правила не обходять увесь чек.
+  void EvaluateFor(uint32_t rule_index, Line* touched);
+  void Offer(Line* line, uint32_t rule_index, int64_t amount);
+  void EvaluatePercentOrPrice(const PromoRule& rule, RuleState* state,
+                              uint32_t rule_index);
+  void OfferPercentOrPrice(const PromoRule& rule, bool qualifies, Line* line,
+                           uint32_t rule_index);
+  void EvaluateSet(const PromoRule& rule, RuleState* state,
+                   uint32_t rule_index);
+  void Settle(std::vector<PromoLineDiscount>* changed);
+
+  std::shared_ptr<const PromoRuleSet> rules_;
+  std::vector<RuleState> states_;
+  // Вузли unordered_map не переміщуються, тож RuleState тримає вказівники.
+  std::unordered_map<std::string, Line> lines_;
+  std::vector<Line*> dirty_;
+  std::vector<uint32_t> scratch_rules_;
+  PromoTime now_;
+  int64_t total_discount_ = 0;
+  size_t last_evaluated_ = 0;
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_PROMO_PROMO_ENGINE_H_
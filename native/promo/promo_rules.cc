@@ -0,0 +1,301 @@
+#include "promo/promo_rules.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+
+#include "json/json_reader.h"
+
+namespace virok {
+
+namespace {
+
+using Token = JsonReader::Token;
+
+// Число або рядок з десятковою комою ("12,50").
+bool ParseDecimal(std::string_view text, double* out) {
+  char buf[64];
+  if (text.empty() || text.size() >= sizeof(buf)) return false;
+  for (size_t i = 0; i < text.size(); i++) {
+    buf[i] = text[i] == ',' ? '.' : text[i];
+  }
+  buf[text.size()] = '\0';
+  char* end = nullptr;
+  const double value = std::strtod(buf, &end);
+  if (end != buf + text.size()) return false;
+  *out = value;
+  return true;
+}
+
+// "2026-01-31" -> 20260131.
+bool ParseDate(std::string_view text, int32_t* out) {
+  if (text.size() < 10 || text[4] != '-' || text[7] != '-') return false;
+  int32_t value = 0;
+  for (size_t i : {0, 1, 2, 3, 5, 6, 8, 9}) {
+    if (text[i] < '0' || text[i] > '9') return false;
+    value = value * 10 + (text[i] - '0');
+  }
+  *out = value;
+  return true;
+}
+
+// "09:30" -> 570; "24:00" дозволено як кінець доби.
+bool ParseMinute(std::string_view text, int* out) {
+  if (text.size() != 5 || text[2] != ':') return false;
+  for (size_t i : {0, 1, 3, 4}) {
+    if (text[i] < '0' || text[i] > '9') return false;
+  }
+  const int hours = (text[0] - '0') * 10 + (text[1] - '0');
+  const int minutes = (text[3] - '0') * 10 + (text[4] - '0');
+  if (minutes > 59 || hours * 60 + minutes > 24 * 60) return false;
+  *out = hours * 60 + minutes;
+  return true;
+}
+
+class RuleParser {
+ public:
+  explicit RuleParser(std::string_view json) : reader_(json) {}
+
+  bool Run(std::vector<PromoRule>* rules, std::string* error) {
+    if (reader_.Next() != Token::kBeginArray) {
+      return Fail(error, "Promo rules must be a JSON array");
+    }
+    for (;;) {
+      const Token t = reader_.Next();
+      if (t == Token::kEndArray) break;
+      if (t != Token::kBeginObject) {
+        return Fail(error, "Rule must be an object");
+      }
+      PromoRule& rule = rules->emplace_back();
+      if (!ReadRule(&rule)) return Fail(error, "Malformed promo rule");
+      const char* invalid = Validate(rule);
+      if (invalid) return Fail(error, (rule.id + ": " + invalid).c_str());
+    }
+    if (reader_.Next() != Token::kEnd) return Fail(error, "Trailing data");
+    return true;
+  }
+
+ private:
+  bool Fail(std::string* error, const char* message) {
+    if (error) *error = reader_.error().empty() ? message : reader_.error();
+    return false;
+  }
+
+  bool ReadRule(PromoRule* rule) {
+    bool has_kind = false;
+    for (;;) {
+      const Token t = reader_.Next();
+      if (t == Token::kEndObject) break;
+      if (t != Token::kKey) return false;
+      const std::string_view key = reader_.text();
+      bool ok;
+      if (key == "id") {
+        ok = ReadString(&rule->id);
+      } else if (key == "kind") {
+        std::string kind;
+        ok = ReadString(&kind);
+        has_kind = true;
+        if (kind == "percent") rule->kind = PromoKind::kPercent;
+        else if (kind == "price") rule->kind = PromoKind::kUnitPrice;
+        else if (kind == "bundle") rule->kind = PromoKind::kBundle;
+        else if (kind == "gift") rule->kind = PromoKind::kGift;
+        else has_kind = false;
+      } else if (key == "items") {
+        ok = ReadStringList(&rule->items);
+      } else if (key == "categories") {
+        ok = ReadStringList(&rule->categories);
+      } else if (key == "percent") {
+        double percent = 0;
+        ok = ReadNumber(&percent);
+        rule->percent_bp = std::llround(percent * 100);
+      } else if (key == "price") {
+        double price = 0;
+        ok = ReadNumber(&price);
+        rule->price = std::llround(price * 100);
+      } else if (key == "qty") {
+        ok = ReadInt(&rule->qty);
+      } else if (key == "free") {
+        ok = ReadInt(&rule->free_qty);
+      } else if (key == "minQty") {
+        ok = ReadInt(&rule->min_qty);
+      } else if (key == "stackable") {
+        ok = reader_.Next() == Token::kBool;
+        rule->stackable = ok && reader_.boolean();
+      } else if (key == "validFrom" || key == "validTo") {
+        std::string date;
+        ok = ReadString(&date) &&
+             (date.empty() ||
+              ParseDate(date, key == "validFrom" ? &rule->schedule.from_date
+                                                 : &rule->schedule.to_date));
+      } else if (key == "from" || key == "to") {
+        std::string time;
+        ok = ReadString(&time) &&
+             ParseMinute(time, key == "from" ? &rule->schedule.from_minute
+                                             : &rule->schedule.to_minute);
+      } else if (key == "days") {
+        ok = ReadDays(&rule->schedule.weekdays);
+      } else {
+        ok = reader_.Next() != Token::kError && reader_.Skip();
+      }
+      if (!ok) return false;
+    }
+    return has_kind;
+  }
+
+  static const char* Validate(const PromoRule& rule) {
+    switch (rule.kind) {
+      case PromoKind::kPercent:
+        if (rule.percent_bp <= 0 || rule.percent_bp > 10000) {
+          return "percent must be in (0, 100]";
+        }
+        break;
+      case PromoKind::kUnitPrice:
+        if (rule.price < 0) return "price must not be negative";
+        break;
+      case PromoKind::kBundle:
+        if (rule.qty < 2 || rule.price < 0) {
+          return "bundle needs qty >= 2 and price";
+        }
+        break;
+      case PromoKind::kGift:
+        if (rule.qty < 1 || rule.free_qty < 1) {
+          return "gift needs qty >= 1 and free >= 1";
+        }
+        break;
+    }
+    if (rule.schedule.weekdays == 0) return "days must not be empty";
+    return nullptr;
+  }
+
+  bool ReadString(std::string* out) {
+    const Token t = reader_.Next();
+    if (t == Token::kNull) {
+      out->clear();
+      return true;
+    }
+    if (t != Token::kString && t != Token::kNumber) return false;
+    out->assign(reader_.text());
+    return true;
+  }
+
+  bool ReadNumber(double* out) {
+    const Token t = reader_.Next();
+    if (t == Token::kNumber) {
+      *out = reader_.number();
+      return true;
+    }
+    return t == Token::kString && ParseDecimal(reader_.text(), out);
+  }
+
+  bool ReadInt(int64_t* out) {
+    double value;
+    if (!ReadNumber(&value) || value < 0) return false;
+    *out = static_cast<int64_t>(value);
+    return true;
+  }
+
+  bool ReadStringList(std::vector<std::string>* out) {
+    if (reader_.Next() != Token::kBeginArray) return false;
+    for (;;) {
+      const Token t = reader_.Next();
+      if (t == Token::kEndArray) return true;
+      if (t != Token::kString) return false;
+      out->emplace_back(reader_.text());
+    }
+  }
+
+  bool ReadDays(uint8_t* mask) {
+    if (reader_.Next() != Token::kBeginArray) return false;
+    *mask = 0;
+    for (;;) {
+      const Token t = reader_.Next();
+      if (t == Token::kEndArray) return true;
+      if (t != Token::kNumber) return false;
+      const int64_t day = reader_.integer();
+      if (day < 1 || day > 7) return false;
+      *mask |= static_cast<uint8_t>(1 << (day - 1));
+    }
+  }
+
+  JsonReader reader_;
+};
+
+// Злиття відсортованих списків номерів правил без повторів.
+void MergeInto(const std::vector<uint32_t>& from, std::vector<uint32_t>* out) {
+  if (from.empty()) return;
+  const size_t middle = out->size();
+  out->insert(out->end(), from.begin(), from.end());
+  std::inplace_merge(out->begin(), out->begin() + middle, out->end());
+  out->erase(std::unique(out->begin(), out->end()), out->end());
+}
+
+}  // namespace
+
+PromoTime PromoTime::Now() {
+  const std::time_t now = std::time(nullptr);
+  std::tm local;
+#ifdef _WIN32
+  localtime_s(&local, &now);
+#else
+  localtime_r(&now, &local);
+#endif
+  PromoTime t;
+  t.date = (local.tm_year + 1900) * 10000 + (local.tm_mon + 1) * 100 +
+           local.tm_mday;
+  t.weekday = (local.tm_wday + 6) % 7;
+  t.minute = local.tm_hour * 60 + local.tm_min;
+  return t;
+}
+
+bool PromoSchedule::ActiveAt(const PromoTime& t) const {
+  if (from_date && t.date < from_date) return false;
+  if (to_date && t.date > to_date) return false;
+  if (!(weekdays & (1 << t.weekday))) return false;
+  if (from_minute <= to_minute) {
+    return t.minute >= from_minute && t.minute < to_minute;
+  }
+  return t.minute >= from_minute || t.minute < to_minute;
+}
+
+bool ParsePromoRules(std::string_view json, std::vector<PromoRule>* rules,
+                     std::string* error) {
+  rules->clear();
+  RuleParser parser(json);
+  if (parser.Run(rules, error)) return true;
+  rules->clear();
+  return false;
+}
+
+PromoRuleSet::PromoRuleSet(std::vector<PromoRule> rules)
+    : rules_(std::move(rules)) {
+  for (uint32_t i = 0; i < rules_.size(); i++) {
+    const PromoRule& rule = rules_[i];
+    if (rule.items.empty() && rule.categories.empty()) {
+      all_items_.push_back(i);
+      continue;
+    }
+    for (const std::string& item : rule.items) {
+      std::vector<uint32_t>& list = by_item_[item];
+      if (list.empty() || list.back() != i) list.push_back(i);
+    }
+    for (const std::string& category : rule.categories) {
+      std::vector<uint32_t>& list = by_category_[category];
+      if (list.empty() || list.back() != i) list.push_back(i);
+    }
+  }
+}
+
+void PromoRuleSet::Match(std::string_view item, std::string_view category,
+                         std::vector<uint32_t>* out) const {
+  out->clear();
+  MergeInto(all_items_, out);
+  auto it = by_item_.find(item);
+  if (it != by_item_.end()) MergeInto(it->second, out);
+  if (!category.empty()) {
+    it = by_category_.find(category);
+    if (it != by_category_.end()) MergeInto(it->second, out);
+  }
+}
+
+}  // namespace virok
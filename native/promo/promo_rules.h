@@ -0,0 +1,99 @@
+#ifndef NATIVE_PROMO_PROMO_RULES_H_
+#define NATIVE_PROMO_PROMO_RULES_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace virok {
+
+// Місцевий час каси, за яким перевіряється розклад акцій.
+struct PromoTime {
+  int32_t date = 0;  // yyyymmdd
+  int weekday = 0;   // 0 — понеділок
+  int minute = 0;    // хвилина доби
+
+  static PromoTime Now();
+};
+
+// Коли діє акція. Значення за замовчуванням — без обмежень.
+struct PromoSchedule {
+  int32_t from_date = 0;  // yyyymmdd включно; 0 — з будь-якої дати
+  int32_t to_date = 0;    // yyyymmdd включно; 0 — без кінця
+  uint8_t weekdays = 0x7F;  // біт 0 — понеділок
+  int from_minute = 0;      // [from_minute, to_minute) доби; якщо from >
+  int to_minute = 24 * 60;  // to — інтервал через північ
+
+  bool ActiveAt(const PromoTime& t) const;
+};
+
+enum class PromoKind {
+  kPercent,    // відсоток від вартості рядків
+  kUnitPrice,  // ціна одиниці (акційна або "щасливі години")
+  kBundle,     // кожні qty одиниць — за price разом
+  kGift,       // кожні qty + free_qty одиниць — free_qty найдешевших даром
+};
+
+// Правило акції. Гроші — у копійках, кількість — у тисячних (як Quantity
+// у чеку Cashalot: "1,000").
+struct PromoRule {
+  std::string id;
+  PromoKind kind = PromoKind::kPercent;
+  // Товари (guid номенклатури) і категорії (guid батьківської папки), до
+  // яких застосовується правило. Обидва порожні — усі товари.
+  std::vector<std::string> items;
+  std::vector<std::string> categories;
+  int64_t percent_bp = 0;  // kPercent, у сотих відсотка (1000 = 10%)
+  int64_t price = 0;       // kUnitPrice: за одиницю; kBundle: за комплект
+  int64_t qty = 0;         // kBundle, kGift: одиниць у комплекті
+  int64_t free_qty = 0;    // kGift
+  // kPercent, kUnitPrice: мінімум одиниць усіх відповідних товарів у чеку.
+  int64_t min_qty = 0;
+  // Складається з іншими знижками рядка; інакше рядок отримує найбільшу
+  // з нескладних знижок.
+  bool stackable = false;
+  PromoSchedule schedule;
+};
+
+// Розбирає масив правил JSON:
+//   [{"id": "p1", "kind": "percent"|"price"|"bundle"|"gift",
+//     "items": [...], "categories": [...],
+//     "percent": 10, "price": 12.5, "qty": 3, "free": 1, "minQty": 2,
+//     "stackable": false, "validFrom": "2026-01-01", "validTo": "...",
+//     "days": [1, 2, 3, 4, 5], "from": "09:00", "to": "12:00"}, ...]
+// Ціни — у гривнях (число або рядок з комою), дні — 1 (пн) ... 7 (нд).
+// Правило без потрібних для свого виду полів — помилка.
+bool ParsePromoRules(std::string_view json, std::vector<PromoRule>* rules,
+                     std::string* error);
+
+// Незмінний скомпільований набір правил: індекси за товаром і категорією,
+// щоб зміна рядка чека торкалася лише своїх правил.
+class PromoRuleSet {
+ public:
+  explicit PromoRuleSet(std::vector<PromoRule> rules);
+
+  PromoRuleSet(const PromoRuleSet&) = delete;
+  PromoRuleSet& operator=(const PromoRuleSet&) = delete;
+
+  // Номери правил, що стосуються товару |item| з категорії |category|,
+  // за зростанням, без повторів.
+  void Match(std::string_view item, std::string_view category,
+             std::vector<uint32_t>* out) const;
+
+  const std::vector<PromoRule>& rules() const { return rules_; }
+  size_t size() const { return rules_.size(); }
+
+ private:
+  using Index = std::unordered_map<std::string_view, std::vector<uint32_t>>;
+
+  std::vector<PromoRule> rules_;
+  Index by_item_;      // ключі вказують на рядки в rules_
+  Index by_category_;
+  std::vector<uint32_t> all_items_;
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_PROMO_PROMO_RULES_H_
@@ -0,0 +1,59 @@
+#include "promo/promo_service.h"
+
+#include <chrono>
+
+namespace virok {
+
+namespace {
+
+int64_t MicrosSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+}  // namespace
+
+PromoService::PromoService()
+    : rules_(std::make_shared<const PromoRuleSet>(std::vector<PromoRule>())),
+      cart_(rules_) {}
+
+bool PromoService::LoadRules(std::string_view json, PromoUpdate* update,
+                             std::string* error) {
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<PromoRule> rules;
+  if (!ParsePromoRules(json, &rules, error)) return false;
+  rules_ = std::make_shared<const PromoRuleSet>(std::move(rules));
+  update->changed.clear();
+  cart_.SetRules(rules_, &update->changed);
+  update->total_discount = cart_.total_discount();
+  update->elapsed_us = MicrosSince(start);
+  return true;
+}
+
+void PromoService::SetLine(const std::string& item,
+                           const std::string& category, int64_t unit_price,
+                           int64_t qty_milli, PromoUpdate* update) {
+  const auto start = std::chrono::steady_clock::now();
+  Tick(update);
+  cart_.SetLine(item, category, unit_price, qty_milli, &update->changed);
+  update->total_discount = cart_.total_discount();
+  update->elapsed_us = MicrosSince(start);
+}
+
+void PromoService::RemoveLine(const std::string& item, PromoUpdate* update) {
+  const auto start = std::chrono::steady_clock::now();
+  Tick(update);
+  cart_.RemoveLine(item, &update->changed);
+  update->total_discount = cart_.total_discount();
+  update->elapsed_us = MicrosSince(start);
+}
+
+void PromoService::Clear() { cart_.Clear(); }
+
+void PromoService::Tick(PromoUpdate* update) {
+  update->changed.clear();
+  cart_.SetTime(PromoTime::Now(), &update->changed);
+}
+
+}  // namespace virok
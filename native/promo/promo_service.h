@@ -0,0 +1,56 @@
+#ifndef NATIVE_PROMO_PROMO_SERVICE_H_
+#define NATIVE_PROMO_PROMO_SERVICE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "promo/promo_engine.h"
+#include "promo/promo_rules.h"
+
+namespace virok {
+
+// Відповідь каналу com.virok/promo на зміну кошика.
+struct PromoUpdate {
+  std::vector<PromoLineDiscount> changed;
+  int64_t total_discount = 0;
+  // Час роботи нативної частини, для моніторингу затримки сканування.
+  int64_t elapsed_us = 0;
+};
+
+// Акції поточного чека, спільні для Windows і Linux раннерів: раннер лише
+// перетворює аргументи каналу і викликає ці методи з платформного потоку.
+// Перед кожною зміною кошика звіряє розклад акцій з годинником каси.
+class PromoService {
+ public:
+  PromoService();
+
+  PromoService(const PromoService&) = delete;
+  PromoService& operator=(const PromoService&) = delete;
+
+  // Замінює набір правил (JSON, див. ParsePromoRules); кошик
+  // переоцінюється. False і текст у |error| — старі правила лишаються.
+  bool LoadRules(std::string_view json, PromoUpdate* update,
+                 std::string* error);
+
+  void SetLine(const std::string& item, const std::string& category,
+               int64_t unit_price, int64_t qty_milli, PromoUpdate* update);
+  void RemoveLine(const std::string& item, PromoUpdate* update);
+  // Новий чек.
+  void Clear();
+
+  size_t rule_count() const { return rules_->size(); }
+
+ private:
+  // Звіряє розклад акцій з годинником каси перед зміною кошика.
+  void Tick(PromoUpdate* update);
+
+  std::shared_ptr<const PromoRuleSet> rules_;
+  PromoCart cart_;
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_PROMO_PROMO_SERVICE_H_
@@ -0,0 +1,434 @@
+#include "reconcile/shift_reconciler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <thread>
+#include <unordered_map>
+
+#include "json/json_reader.h"
+#include "text/lower_case.h"
+#include "trace/trace.h"
+
+namespace virok {
+
+namespace {
+
+using Token = JsonReader::Token;
+using Clock = std::chrono::steady_clock;
+
+int64_t Kopecks(double uah) { return std::llround(uah * 100); }
+
+int64_t MicrosSince(Clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() -
+                                                               start)
+      .count();
+}
+
+// Форми оплати пишуть по-різному ("Картка" в kkm_checks, "КАРТКА" в
+// чеку ПРРО), тож ключ зведення — нижній регістр.
+std::string FormKey(std::string_view form) { return Utf8ToLower(form); }
+
+bool Contains(std::string_view text, std::string_view part) {
+  return text.find(part) != std::string_view::npos;
+}
+
+// Результат одного джерела: завантаження в окремому потоці.
+template <typename T>
+struct Loaded {
+  T value;
+  bool ok = false;
+  std::string error;
+  int64_t elapsed_us = 0;
+};
+
+template <typename T, typename Fn>
+void Load(const Fn& fn, const char* name, Loaded<T>* out) {
+  VIROK_TRACE_SCOPE("reconcile", name);
+  const auto start = Clock::now();
+  if (!fn) {
+    out->error = std::string(name) + " source is not set";
+  } else {
+    out->ok = fn(&out->value, &out->error);
+  }
+  out->elapsed_us = MicrosSince(start);
+}
+
+class ServerCheckParser {
+ public:
+  explicit ServerCheckParser(std::string_view json) : reader_(json) {}
+
+  bool Run(std::vector<ReconcileCheck>* checks, std::string* error) {
+    if (reader_.Next() != Token::kBeginArray) {
+      return Fail(error, "kkm_checks must be a JSON array");
+    }
+    for (;;) {
+      const Token t = reader_.Next();
+      if (t == Token::kEndArray) return true;
+      ReconcileCheck check;
+      bool parked = false;
+      if (t != Token::kBeginObject || !ReadRow(&check, &parked)) {
+        return Fail(error, "Malformed kkm_checks row");
+      }
+      if (!parked) checks->push_back(std::move(check));
+    }
+  }
+
+ private:
+  bool Fail(std::string* error, const char* message) {
+    if (error) *error = reader_.error().empty() ? message : reader_.error();
+    return false;
+  }
+
+  bool ReadRow(ReconcileCheck* check, bool* parked) {
+    std::string document_type;
+    std::string status;
+    double amount = 0;
+    for (;;) {
+      const Token t = reader_.Next();
+      if (t == Token::kEndObject) break;
+      if (t != Token::kKey) return false;
+      const std::string_view key = reader_.text();
+      bool ok;
+      if (key == "document_number") {
+        ok = ReadString(&check->number);
+      } else if (key == "RRN" || key == "rrn") {
+        ok = ReadString(&check->rrn);
+      } else if (key == "payment_form") {
+        ok = ReadString(&check->payment_form);
+      } else if (key == "amount") {
+        ok = ReadNumber(&amount);
+      } else if (key == "status") {
+        ok = ReadString(&status);
+      } else if (key == "document_type") {
+        ok = ReadString(&document_type);
+      } else if (key == "taxes") {
+        ok = ReadTaxes(&check->taxes);
+      } else {
+        ok = reader_.Next() != Token::kError && reader_.Skip();
+      }
+      if (!ok) return false;
+    }
+    *parked = status == "Чек відкладений";
+    check->refund = amount < 0 || Contains(document_type, "Повернення");
+    check->amount = std::llabs(Kopecks(amount));
+    return true;
+  }
+
+  // {"А": 12.5, ...}
+  bool ReadTaxes(std::vector<std::pair<std::string, int64_t>>* taxes) {
+    const Token t = reader_.Next();
+    if (t == Token::kNull) return true;
+    if (t != Token::kBeginObject) return false;
+    for (;;) {
+      const Token key = reader_.Next();
+      if (key == Token::kEndObject) return true;
+      if (key != Token::kKey) return false;
+      std::string group(reader_.text());
+      double base = 0;
+      if (!ReadNumber(&base)) return false;
+      taxes->emplace_back(std::move(group), std::llabs(Kopecks(base)));
+    }
+  }
+
+  // null читається як порожній рядок / 0: PostgREST віддає так незаповнені
+  // колонки.
+  bool ReadString(std::string* out) {
+    const Token t = reader_.Next();
+    if (t == Token::kNull) return true;
+    if (t != Token::kString) return false;
+    out->assign(reader_.text());
+    return true;
+  }
+
+  bool ReadNumber(double* out) {
+    const Token t = reader_.Next();
+    if (t == Token::kNull) return true;
+    if (t != Token::kNumber) return false;
+    *out = reader_.number();
+    return true;
+  }
+
+  JsonReader reader_;
+};
+
+// Зведення за ключем у нижньому регістрі; назва — як у першого джерела,
+// де форма трапилась (X-звіт іде першим).
+class FormTable {
+ public:
+  ReconcileFormTotals* At(std::string_view form) {
+    auto [it, inserted] = rows_.try_emplace(FormKey(form));
+    if (inserted) it->second.form = std::string(form);
+    return &it->second;
+  }
+
+  std::vector<ReconcileFormTotals> Take() {
+    std::vector<ReconcileFormTotals> out;
+    out.reserve(rows_.size());
+    for (auto& [key, row] : rows_) out.push_back(std::move(row));
+    return out;
+  }
+
+ private:
+  std::map<std::string, ReconcileFormTotals> rows_;
+};
+
+int64_t Signed(const ReconcileCheck& check) {
+  return check.refund ? -check.amount : check.amount;
+}
+
+ReconcileCheckIssue MakeIssue(CheckDiscrepancy kind,
+                              const ReconcileCheck* server,
+                              const ReconcileCheck* till) {
+  ReconcileCheckIssue issue;
+  issue.kind = kind;
+  const ReconcileCheck* any = till ? till : server;
+  issue.number = any->number.empty() && server ? server->number : any->number;
+  issue.rrn = any->rrn.empty() && server ? server->rrn : any->rrn;
+  if (server) {
+    issue.server_amount = Signed(*server);
+    issue.server_form = server->payment_form;
+  }
+  if (till) {
+    issue.till_amount = Signed(*till);
+    issue.till_form = till->payment_form;
+  }
+  return issue;
+}
+
+// Індекс RRN одного джерела; повторний RRN того самого напрямку (продаж чи
+// повернення) — підозра на подвійне списання або подвійний запис.
+class RrnIndex {
+ public:
+  void Reserve(size_t n) {
+    by_rrn_[0].reserve(n);
+    by_rrn_[1].reserve(n / 8 + 1);
+  }
+
+  // false — такий RRN уже є.
+  bool Add(const ReconcileCheck& check, size_t index) {
+    if (check.rrn.empty()) return true;
+    return by_rrn_[check.refund].emplace(check.rrn, index).second;
+  }
+
+  const size_t* Find(const ReconcileCheck& check) const {
+    if (check.rrn.empty()) return nullptr;
+    const auto& map = by_rrn_[check.refund];
+    auto it = map.find(check.rrn);
+    return it == map.end() ? nullptr : &it->second;
+  }
+
+ private:
+  std::unordered_map<std::string_view, size_t> by_rrn_[2];
+};
+
+void JoinChecks(const std::vector<ReconcileCheck>& server,
+                const std::vector<ReconcileCheck>& till,
+                std::vector<ReconcileCheckIssue>* issues) {
+  std::unordered_map<std::string_view, size_t> till_by_number;
+  till_by_number.reserve(till.size());
+  RrnIndex till_by_rrn;
+  till_by_rrn.Reserve(till.size());
+  for (size_t i = 0; i < till.size(); i++) {
+    till_by_number.emplace(till[i].number, i);
+    if (!till_by_rrn.Add(till[i], i)) {
+      issues->push_back(
+          MakeIssue(CheckDiscrepancy::kDuplicateRrn, nullptr, &till[i]));
+    }
+  }
+
+  std::vector<bool> matched(till.size(), false);
+  std::unordered_map<std::string_view, size_t> server_by_number;
+  server_by_number.reserve(server.size());
+  RrnIndex server_by_rrn;
+  server_by_rrn.Reserve(server.size());
+  for (size_t i = 0; i < server.size(); i++) {
+    const ReconcileCheck& s = server[i];
+    if (!s.number.empty() && !server_by_number.emplace(s.number, i).second) {
+      issues->push_back(
+          MakeIssue(CheckDiscrepancy::kDuplicateNumber, &s, nullptr));
+      continue;
+    }
+    if (!server_by_rrn.Add(s, i)) {
+      issues->push_back(MakeIssue(CheckDiscrepancy::kDuplicateRrn, &s, nullptr));
+    }
+
+    // Спершу за фіскальним номером; чек без номера (або з чужим) — за
+    // RRN, якщо той чек каси ще ні з чим не з'єднано.
+    const size_t* index = nullptr;
+    if (!s.number.empty()) {
+      auto it = till_by_number.find(s.number);
+      if (it != till_by_number.end()) index = &it->second;
+    }
+    if (!index) {
+      index = till_by_rrn.Find(s);
+      if (index && matched[*index]) index = nullptr;
+    }
+    if (!index) {
+      issues->push_back(
+          MakeIssue(CheckDiscrepancy::kMissingInArchive, &s, nullptr));
+      continue;
+    }
+    matched[*index] = true;
+    const ReconcileCheck* t = &till[*index];
+    if (Signed(s) != Signed(*t)) {
+      issues->push_back(MakeIssue(CheckDiscrepancy::kAmountMismatch, &s, t));
+    }
+    if (FormKey(s.payment_form) != FormKey(t->payment_form)) {
+      issues->push_back(MakeIssue(CheckDiscrepancy::kFormMismatch, &s, t));
+    }
+    if (s.rrn != t->rrn) {
+      issues->push_back(MakeIssue(CheckDiscrepancy::kRrnMismatch, &s, t));
+    }
+  }
+
+  for (size_t i = 0; i < till.size(); i++) {
+    if (!matched[i]) {
+      issues->push_back(
+          MakeIssue(CheckDiscrepancy::kMissingOnServer, nullptr, &till[i]));
+    }
+  }
+}
+
+void CountChecks(const std::vector<ReconcileCheck>& checks, int64_t* sales,
+                 int64_t* refunds) {
+  for (const ReconcileCheck& check : checks) ++*(check.refund ? refunds : sales);
+}
+
+}  // namespace
+
+const char* CheckDiscrepancyName(CheckDiscrepancy kind) {
+  switch (kind) {
+    case CheckDiscrepancy::kMissingOnServer:
+      return "missingOnServer";
+    case CheckDiscrepancy::kMissingInArchive:
+      return "missingInArchive";
+    case CheckDiscrepancy::kAmountMismatch:
+      return "amountMismatch";
+    case CheckDiscrepancy::kFormMismatch:
+      return "formMismatch";
+    case CheckDiscrepancy::kRrnMismatch:
+      return "rrnMismatch";
+    case CheckDiscrepancy::kDuplicateNumber:
+      return "duplicateNumber";
+    case CheckDiscrepancy::kDuplicateRrn:
+      return "duplicateRrn";
+  }
+  return "";
+}
+
+bool ReconcileReport::balanced() const {
+  for (const auto& form : forms) {
+    if (!form.matches()) return false;
+  }
+  for (const auto& tax : taxes) {
+    if (!tax.matches()) return false;
+  }
+  if (device_sales != server_sales || server_sales != till_sales ||
+      device_refunds != server_refunds || server_refunds != till_refunds) {
+    return false;
+  }
+  if (cash_counted >= 0 && cash_counted != cash_expected) return false;
+  return checks.empty();
+}
+
+bool ParseServerChecks(std::string_view json,
+                       std::vector<ReconcileCheck>* checks,
+                       std::string* error) {
+  return ServerCheckParser(json).Run(checks, error);
+}
+
+ReconcileCheck CheckFromArchive(const ArchivedReceipt& receipt) {
+  ReconcileCheck check;
+  check.number = receipt.fiscal_number;
+  check.rrn = receipt.rrn;
+  if (!receipt.payments.empty()) {
+    check.payment_form = receipt.payments.front().form;
+  }
+  check.refund = receipt.doc_type == "return";
+  check.amount = std::llabs(receipt.total);
+  return check;
+}
+
+bool ReconcileShift(const ReconcileSources& sources, ReconcileReport* report,
+                    std::string* error) {
+  VIROK_TRACE_SCOPE("reconcile", "shift");
+  const auto start = Clock::now();
+  *report = ReconcileReport();
+
+  // Сервер і архів — найдовші (JSON на тисячі рядків, читання сегментів):
+  // кожен у своєму потоці, X-звіт тим часом у поточному.
+  Loaded<std::vector<ReconcileCheck>> server;
+  Loaded<std::vector<ReconcileCheck>> till;
+  Loaded<Report> device;
+  std::thread server_thread([&] { Load(sources.server, "server", &server); });
+  std::thread till_thread([&] { Load(sources.till, "till", &till); });
+  Load(sources.device, "device", &device);
+  server_thread.join();
+  till_thread.join();
+  report->load_us = std::max(
+      {device.elapsed_us, server.elapsed_us, till.elapsed_us});
+
+  for (const auto* loaded : {&server, &till}) {
+    if (!loaded->ok) {
+      if (error) *error = loaded->error;
+      return false;
+    }
+  }
+  if (!device.ok) {
+    if (error) *error = device.error;
+    return false;
+  }
+
+  const Report& r = device.value;
+  FormTable forms;
+  for (const ReportPay& pay : r.pays) {
+    forms.At(pay.name)->device += Kopecks(pay.sum_p) - Kopecks(pay.sum_m);
+  }
+  for (const ReconcileCheck& check : server.value) {
+    forms.At(check.payment_form)->server += Signed(check);
+  }
+  for (const ReconcileCheck& check : till.value) {
+    forms.At(check.payment_form)->till += Signed(check);
+  }
+  report->forms = forms.Take();
+
+  std::map<std::string, ReconcileTaxTotals> taxes;
+  for (const ReportTax& tax : r.taxes) {
+    const std::string group =
+        tax.tax_lit.empty() ? std::to_string(tax.gr_code) : tax.tax_lit;
+    ReconcileTaxTotals& row = taxes[group];
+    row.group = group;
+    row.device += Kopecks(tax.base_sum_p) - Kopecks(tax.base_sum_m);
+  }
+  bool server_taxes = false;
+  for (const ReconcileCheck& check : server.value) {
+    for (const auto& [group, base] : check.taxes) {
+      ReconcileTaxTotals& row = taxes[group];
+      row.group = group;
+      row.server += check.refund ? -base : base;
+      server_taxes = true;
+    }
+  }
+  for (auto& [group, row] : taxes) {
+    row.server_known = server_taxes;
+    report->taxes.push_back(std::move(row));
+  }
+
+  if (r.has_receipt) {
+    report->device_sales = r.receipt.count_p;
+    report->device_refunds = r.receipt.count_m;
+  }
+  CountChecks(server.value, &report->server_sales, &report->server_refunds);
+  CountChecks(till.value, &report->till_sales, &report->till_refunds);
+  report->cash_expected = Kopecks(r.safe);
+  report->cash_counted = sources.drawer_counted;
+
+  JoinChecks(server.value, till.value, &report->checks);
+  report->elapsed_us = MicrosSince(start);
+  return true;
+}
+
+}  // namespace virok
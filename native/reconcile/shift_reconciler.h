@@ -0,0 +1,135 @@
+#ifndef NATIVE_RECONCILE_SHIFT_RECONCILER_H_
+#define NATIVE_RECONCILE_SHIFT_RECONCILER_H_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "archive/archived_receipt.h"
+#include "report/report.h"
+
+namespace virok {
+
+// Звірка зміни перед Z-звітом: X-звіт пристрою, чеки на сервері
+// (kkm_checks), чеки в локальному архіві каси і готівка в шухляді.
+// Усі суми — у копійках.
+
+// Чек зміни з одного джерела.
+struct ReconcileCheck {
+  std::string number;  // фіскальний номер
+  std::string rrn;     // RRN картки; порожньо для готівки
+  // Змішана оплата зводиться до першої форми: каса сьогодні не ділить
+  // оплату чека.
+  std::string payment_form;
+  bool refund = false;
+  int64_t amount = 0;  // завжди додатна, напрямок — |refund|
+  // База за податковими групами (літера групи, сума); порожньо, якщо
+  // джерело не знає розбивки.
+  std::vector<std::pair<std::string, int64_t>> taxes;
+};
+
+// Оборот за формою оплати: продажі мінус повернення.
+struct ReconcileFormTotals {
+  std::string form;
+  int64_t device = 0;
+  int64_t server = 0;
+  int64_t till = 0;
+
+  bool matches() const { return device == server && server == till; }
+};
+
+// База податкової групи: продажі мінус повернення.
+struct ReconcileTaxTotals {
+  std::string group;
+  int64_t device = 0;
+  int64_t server = 0;
+  // false — жоден серверний чек не мав розбивки: звіряти нема з чим.
+  bool server_known = false;
+
+  bool matches() const { return !server_known || device == server; }
+};
+
+enum class CheckDiscrepancy {
+  kMissingOnServer,   // фіскалізовано на касі, у kkm_checks немає
+  kMissingInArchive,  // є в kkm_checks, у касі такого чека немає
+  kAmountMismatch,
+  kFormMismatch,
+  kRrnMismatch,       // той самий чек, різні RRN
+  kDuplicateNumber,   // фіскальний номер кілька разів у kkm_checks
+  kDuplicateRrn,      // один RRN у кількох чеках одного джерела
+};
+
+const char* CheckDiscrepancyName(CheckDiscrepancy kind);
+
+struct ReconcileCheckIssue {
+  CheckDiscrepancy kind;
+  std::string number;  // фіскальний номер (або номер з іншого джерела)
+  std::string rrn;
+  // Значення з боку сервера і каси; порожні / 0, якщо чека там немає.
+  int64_t server_amount = 0;
+  int64_t till_amount = 0;
+  std::string server_form;
+  std::string till_form;
+};
+
+struct ReconcileReport {
+  std::vector<ReconcileFormTotals> forms;  // за назвою форми
+  std::vector<ReconcileTaxTotals> taxes;   // за літерою групи
+  std::vector<ReconcileCheckIssue> checks;
+
+  // Кількість чеків продажу / повернення за кожним джерелом.
+  int64_t device_sales = 0;
+  int64_t device_refunds = 0;
+  int64_t server_sales = 0;
+  int64_t server_refunds = 0;
+  int64_t till_sales = 0;
+  int64_t till_refunds = 0;
+
+  // Залишок готівки за X-звітом і перераховане касиром; -1 — не
+  // перераховано.
+  int64_t cash_expected = 0;
+  int64_t cash_counted = -1;
+
+  // Час завантаження джерел (найдовше з паралельних) і всієї звірки.
+  int64_t load_us = 0;
+  int64_t elapsed_us = 0;
+
+  bool balanced() const;
+};
+
+// Джерела зміни. Кожне завантажується й нормалізується у власному потоці;
+// false з |error| зупиняє звірку.
+struct ReconcileSources {
+  std::function<bool(Report* report, std::string* error)> device;
+  std::function<bool(std::vector<ReconcileCheck>* checks, std::string* error)>
+      server;
+  std::function<bool(std::vector<ReconcileCheck>* checks, std::string* error)>
+      till;
+  // Готівка, перерахована в шухляді; -1 — не перераховано.
+  int64_t drawer_counted = -1;
+};
+
+// Тягне джерела паралельно і зводить їх: обороти за формами оплати й
+// податковими групами, кількість чеків, готівку, а також кожен чек
+// сервера проти каси (хеш-з'єднання за фіскальним номером, далі за RRN).
+bool ReconcileShift(const ReconcileSources& sources, ReconcileReport* report,
+                    std::string* error);
+
+// Рядки kkm_checks як їх повертає PostgREST:
+//   [{"document_number", "kkm_check_number", "amount", "payment_form",
+//     "status", "RRN", "document_type", "taxes": {"А": 12.5}}, ...]
+// Відкладені чеки ("Чек відкладений") не фіскалізовані й пропускаються;
+// повернення — document_type з "Повернення" або від'ємна сума. Чек без
+// document_number з'єднується з касою лише за RRN.
+bool ParseServerChecks(std::string_view json,
+                       std::vector<ReconcileCheck>* checks,
+                       std::string* error);
+
+ReconcileCheck CheckFromArchive(const ArchivedReceipt& receipt);
+
+}  // namespace virok
+
+#endif  // NATIVE_RECONCILE_SHIFT_RECONCILER_H_
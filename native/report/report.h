@@ -0,0 +1,128 @@
+#ifndef NATIVE_REPORT_REPORT_H_
+#define NATIVE_REPORT_REPORT_H_
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace virok {
+
+// Плоска типізована модель X/Z-звіту; поля дзеркалять XReportData
+// (lib/core/models/x_report_data.dart). Значення "немає" — -1 для
+// цілих, NaN для сум, порожній рядок для текстів.
+
+struct ReportReceipt {
+  int64_t last_docno_p = 0;
+  int64_t last_docno_m = 0;
+  int64_t count_14 = 0;
+  int64_t count_p = 0;
+  int64_t count_m = 0;
+};
+
+struct ReportSummary {
+  double base_p = 0;
+  double base_m = 0;
+  double taxex_p = 0;
+  double taxex_m = 0;
+  double disc_p = 0;
+  double disc_m = 0;
+  double calc_p = 0;
+  double calc_m = 0;
+};
+
+struct ReportTax {
+  int64_t gr_code = 0;
+  double base_sum_p = 0;
+  double base_sum_m = 0;
+  std::string tax_name;
+  std::string tax_fname;
+  std::string tax_lit;
+  double tax_percent = 0;
+  double tax_sum_p = 0;
+  double tax_sum_m = 0;
+};
+
+// Оплати (pays) і операції з грошима (money) мають однакову форму;
+// для видачі (cash) sum_p завжди 0.
+struct ReportPay {
+  int64_t type = 0;
+  std::string name;
+  double sum_p = 0;
+  double sum_m = 0;
+};
+
+struct ReportLastCheck {
+  int64_t packnum = 0;
+  int64_t docnum = 0;
+  std::string fisnum;
+  int64_t packtype = 0;
+};
+
+struct ReportWarning {
+  int64_t code = 0;
+  std::string wtxt;
+};
+
+struct ReportBilling {
+  std::string paid_date_to;
+  int64_t enough_to_renew_subscription = 0;
+};
+
+struct ReportPrintHeader {
+  std::string name;
+  std::string shopname;
+  std::string shopad;
+  std::string vat_code;
+  std::string fis_code;
+  std::string dt;
+  bool is_offline = false;
+  std::string fisid;
+  std::string cashier;
+};
+
+struct Report {
+  // Код результату Vchasno ("res", 0 = успіх); -1 — поля немає (Cashalot).
+  int64_t res = -1;
+  int64_t task = 0;
+  std::string dt;
+  std::string fisid;
+  std::string cashier;
+  double safe = 0;
+  double safe_start_shift = 0;
+  bool is_offline = false;
+  int64_t shift_link = -1;
+  int64_t shift_prev_link = -1;
+  int64_t vacant_off_nums = -1;
+  bool is_z_rep = false;
+
+  std::string shift_opened;  // як прийшло від пристрою (ISO 8601)
+  double service_input = std::numeric_limits<double>::quiet_NaN();
+  double service_output = std::numeric_limits<double>::quiet_NaN();
+
+  bool has_receipt = false;
+  ReportReceipt receipt;
+  bool has_summary = false;
+  ReportSummary summary;
+  std::vector<ReportTax> taxes;
+  std::vector<ReportPay> pays;
+  std::vector<ReportPay> money;
+  std::vector<ReportPay> cash;
+  bool has_last_check = false;
+  ReportLastCheck last_check;
+  std::vector<ReportWarning> warnings;
+  bool has_billing = false;
+  ReportBilling billing;
+  bool has_print_header = false;
+  ReportPrintHeader print_header;
+
+  // Base64-візуалізація як прийшла (діалог розбирає з неї XML-теги).
+  std::string visualization;
+  // Готові байти для ESC/POS-принтера: ініціалізація, текст у CP1251,
+  // прогін і відрізка. Порожньо, якщо візуалізації немає.
+  std::string print_data;
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_REPORT_REPORT_H_
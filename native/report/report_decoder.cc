@@ -0,0 +1,336 @@
+#include "report/report_decoder.h"
+
+#include <cstdlib>
+
+#include "json/json_reader.h"
+#include "printing/escpos.h"
+
+namespace virok {
+
+namespace {
+
+using Token = JsonReader::Token;
+
+// Суми в Cashalot інколи приходять рядком і з комою ("15,65").
+bool ParseDecimal(std::string_view text, double* out) {
+  char buf[64];
+  if (text.empty() || text.size() >= sizeof(buf)) return false;
+  for (size_t i = 0; i < text.size(); i++) {
+    buf[i] = text[i] == ',' ? '.' : text[i];
+  }
+  buf[text.size()] = '\0';
+  char* end = nullptr;
+  const double value = std::strtod(buf, &end);
+  if (end != buf + text.size()) return false;
+  *out = value;
+  return true;
+}
+
+class Decoder {
+ public:
+  Decoder(std::string_view json, Report* report)
+      : reader_(json), report_(report) {}
+
+  bool Run(std::string* error) {
+    if (reader_.Next() != Token::kBeginObject) {
+      return Failed(error, "Report JSON must be an object");
+    }
+    ForEachField([this](std::string_view key) { return RootField(key); });
+    if (reader_.Next() != Token::kEnd) return Failed(error, nullptr);
+
+    // Запасні поля кореня (як у XReportData.fromJson: info[...] ?? json[...]).
+    if (report_->dt.empty()) report_->dt = std::move(order_date_time_);
+    if (report_->fisid.empty()) report_->fisid = std::move(num_fiscal_);
+    if (!has_is_offline_) report_->is_offline = offline_;
+    report_->is_z_rep = report_->task == 11;
+    return true;
+  }
+
+ private:
+  bool Failed(std::string* error, const char* message) {
+    if (error) {
+      *error = reader_.error().empty() ? std::string(message ? message : "")
+                                       : reader_.error();
+    }
+    return false;
+  }
+
+  // Поточний токен — ключ; |fn| зчитує значення або повертає false, і тоді
+  // значення пропускається.
+  template <typename Fn>
+  bool ForEachField(Fn fn) {
+    for (;;) {
+      const Token t = reader_.Next();
+      if (t == Token::kEndObject) return true;
+      if (t != Token::kKey) return false;
+      if (!fn(reader_.text()) && !reader_.Skip()) return false;
+    }
+  }
+
+  // Значення ключа — об'єкт: обходить його поля; інакше пропускає.
+  template <typename Fn>
+  bool ReadObject(Fn fn) {
+    const Token t = reader_.Next();
+    if (t != Token::kBeginObject) return reader_.Skip();
+    return ForEachField(fn);
+  }
+
+  // Значення ключа — масив об'єктів: для кожного додає елемент у |list|.
+  template <typename T, typename Fn>
+  bool ReadObjectList(std::vector<T>* list, Fn fn) {
+    Token t = reader_.Next();
+    if (t != Token::kBeginArray) return reader_.Skip();
+    for (;;) {
+      t = reader_.Next();
+      if (t == Token::kEndArray) return true;
+      if (t != Token::kBeginObject) {
+        if (!reader_.Skip()) return false;
+        continue;
+      }
+      T& item = list->emplace_back();
+      if (!ForEachField([&](std::string_view key) { return fn(key, &item); })) {
+        return false;
+      }
+    }
+  }
+
+  bool ReadString(std::string* out) {
+    switch (reader_.Next()) {
+      case Token::kString:
+      case Token::kNumber:
+        out->assign(reader_.text());
+        return true;
+      case Token::kBool:
+        out->assign(reader_.boolean() ? "true" : "false");
+        return true;
+      case Token::kNull:
+        out->clear();
+        return true;
+      default:
+        return reader_.Skip();
+    }
+  }
+
+  bool ReadInt(int64_t* out) {
+    switch (reader_.Next()) {
+      case Token::kNumber:
+        *out = reader_.integer();
+        return true;
+      case Token::kString: {
+        double value;
+        if (ParseDecimal(reader_.text(), &value)) {
+          *out = static_cast<int64_t>(value);
+        }
+        return true;
+      }
+      default:
+        return reader_.Skip();
+    }
+  }
+
+  bool ReadDouble(double* out) {
+    switch (reader_.Next()) {
+      case Token::kNumber:
+        *out = reader_.number();
+        return true;
+      case Token::kString:
+        ParseDecimal(reader_.text(), out);
+        return true;
+      default:
+        return reader_.Skip();
+    }
+  }
+
+  bool ReadBool(bool* out) {
+    switch (reader_.Next()) {
+      case Token::kBool:
+        *out = reader_.boolean();
+        return true;
+      case Token::kNumber:
+        *out = reader_.integer() != 0;
+        return true;
+      case Token::kString:
+        *out = reader_.text() == "true" || reader_.text() == "1";
+        return true;
+      default:
+        return reader_.Skip();
+    }
+  }
+
+  bool RootField(std::string_view key) {
+    if (key == "info") {
+      return ReadObject([this](std::string_view k) { return InfoField(k); });
+    }
+    if (key == "Values") {
+      // Cashalot кладе корисні дані у Values; вони мають ту саму форму.
+      return ReadObject([this](std::string_view k) { return RootField(k); });
+    }
+    if (key == "warnings") {
+      return ReadObjectList(&report_->warnings,
+                            [this](std::string_view k, ReportWarning* w) {
+                              if (k == "code") return ReadInt(&w->code);
+                              if (k == "wtxt") return ReadString(&w->wtxt);
+                              return false;
+                            });
+    }
+    if (key == "Visualization" || key == "visualization" ||
+        key == "Base64Str1251ReportXML") {
+      if (!ReadString(&report_->visualization)) return false;
+      // Байти для друку готуємо тут же, поки рядок гарячий у кеші.
+      if (report_->visualization.empty() ||
+          !VisualizationToEscPos(report_->visualization,
+                                 &report_->print_data)) {
+        report_->print_data.clear();
+      }
+      return true;
+    }
+    if (key == "ShiftOpened") return ReadString(&report_->shift_opened);
+    if (key == "Totals") {
+      return ReadObject([this](std::string_view k) {
+        if (k != "ZREPBODY") return false;
+        return ReadObject([this](std::string_view body_key) {
+          if (body_key == "SERVICEINPUT") {
+            return ReadDouble(&report_->service_input);
+          }
+          if (body_key == "SERVICEOUTPUT") {
+            return ReadDouble(&report_->service_output);
+          }
+          return false;
+        });
+      });
+    }
+    if (key == "res") return ReadInt(&report_->res);
+    if (key == "OrderDateTime") return ReadString(&order_date_time_);
+    if (key == "NumFiscal") return ReadString(&num_fiscal_);
+    if (key == "Offline") return ReadBool(&offline_);
+    // Поля info можуть лежати прямо в корені.
+    return InfoField(key);
+  }
+
+  bool InfoField(std::string_view key) {
+    Report* r = report_;
+    if (key == "task") return ReadInt(&r->task);
+    if (key == "dt") return ReadString(&r->dt);
+    if (key == "fisid") return ReadString(&r->fisid);
+    if (key == "cashier") return ReadString(&r->cashier);
+    if (key == "safe") return ReadDouble(&r->safe);
+    if (key == "safe_start_shift") return ReadDouble(&r->safe_start_shift);
+    if (key == "isoffline") {
+      has_is_offline_ = true;
+      return ReadBool(&r->is_offline);
+    }
+    if (key == "shift_link") return ReadInt(&r->shift_link);
+    if (key == "shift_prev_link") return ReadInt(&r->shift_prev_link);
+    if (key == "vacant_off_nums") return ReadInt(&r->vacant_off_nums);
+    if (key == "receipt") {
+      r->has_receipt = true;
+      ReportReceipt* c = &r->receipt;
+      return ReadObject([this, c](std::string_view k) {
+        if (k == "last_docno_p") return ReadInt(&c->last_docno_p);
+        if (k == "last_docno_m") return ReadInt(&c->last_docno_m);
+        if (k == "count_14") return ReadInt(&c->count_14);
+        if (k == "count_p") return ReadInt(&c->count_p);
+        if (k == "count_m") return ReadInt(&c->count_m);
+        return false;
+      });
+    }
+    if (key == "summary") {
+      r->has_summary = true;
+      ReportSummary* s = &r->summary;
+      return ReadObject([this, s](std::string_view k) {
+        if (k == "base_p") return ReadDouble(&s->base_p);
+        if (k == "base_m") return ReadDouble(&s->base_m);
+        if (k == "taxex_p") return ReadDouble(&s->taxex_p);
+        if (k == "taxex_m") return ReadDouble(&s->taxex_m);
+        if (k == "disc_p") return ReadDouble(&s->disc_p);
+        if (k == "disc_m") return ReadDouble(&s->disc_m);
+        if (k == "calc_p") return ReadDouble(&s->calc_p);
+        if (k == "calc_m") return ReadDouble(&s->calc_m);
+        return false;
+      });
+    }
+    if (key == "taxes") {
+      return ReadObjectList(&r->taxes, [this](std::string_view k, ReportTax* t) {
+        if (k == "gr_code") return ReadInt(&t->gr_code);
+        if (k == "base_sum_p") return ReadDouble(&t->base_sum_p);
+        if (k == "base_sum_m") return ReadDouble(&t->base_sum_m);
+        if (k == "tax_name") return ReadString(&t->tax_name);
+        if (k == "tax_fname") return ReadString(&t->tax_fname);
+        if (k == "tax_lit") return ReadString(&t->tax_lit);
+        if (k == "tax_percent") return ReadDouble(&t->tax_percent);
+        if (k == "tax_sum_p") return ReadDouble(&t->tax_sum_p);
+        if (k == "tax_sum_m") return ReadDouble(&t->tax_sum_m);
+        return false;
+      });
+    }
+    if (key == "pays") return ReadPayList(&r->pays);
+    if (key == "money") return ReadPayList(&r->money);
+    if (key == "cash") return ReadPayList(&r->cash);
+    if (key == "last_check") {
+      r->has_last_check = true;
+      ReportLastCheck* c = &r->last_check;
+      return ReadObject([this, c](std::string_view k) {
+        if (k == "packnum") return ReadInt(&c->packnum);
+        if (k == "docnum") return ReadInt(&c->docnum);
+        if (k == "fisnum") return ReadString(&c->fisnum);
+        if (k == "packtype") return ReadInt(&c->packtype);
+        return false;
+      });
+    }
+    if (key == "billing") {
+      r->has_billing = true;
+      ReportBilling* b = &r->billing;
+      return ReadObject([this, b](std::string_view k) {
+        if (k == "paid_date_to") return ReadString(&b->paid_date_to);
+        if (k == "enough_to_renew_subscription") {
+          return ReadInt(&b->enough_to_renew_subscription);
+        }
+        return false;
+      });
+    }
+    if (key == "print_header") {
+      r->has_print_header = true;
+      ReportPrintHeader* h = &r->print_header;
+      return ReadObject([this, h](std::string_view k) {
+        if (k == "name") return ReadString(&h->name);
+        if (k == "shopname") return ReadString(&h->shopname);
+        if (k == "shopad") return ReadString(&h->shopad);
+        if (k == "vat_code") return ReadString(&h->vat_code);
+        if (k == "fis_code") return ReadString(&h->fis_code);
+        if (k == "dt") return ReadString(&h->dt);
+        if (k == "isOffline") return ReadBool(&h->is_offline);
+        if (k == "fisid") return ReadString(&h->fisid);
+        if (k == "cashier") return ReadString(&h->cashier);
+        return false;
+      });
+    }
+    return false;
+  }
+
+  bool ReadPayList(std::vector<ReportPay>* list) {
+    return ReadObjectList(list, [this](std::string_view k, ReportPay* p) {
+      if (k == "type") return ReadInt(&p->type);
+      if (k == "name") return ReadString(&p->name);
+      if (k == "sum_p") return ReadDouble(&p->sum_p);
+      if (k == "sum_m") return ReadDouble(&p->sum_m);
+      return false;
+    });
+  }
+
+  JsonReader reader_;
+  Report* report_;
+
+  std::string order_date_time_;
+  std::string num_fiscal_;
+  bool offline_ = false;
+  bool has_is_offline_ = false;
+};
+
+}  // namespace
+
+bool DecodeReport(std::string_view json, Report* report, std::string* error) {
+  *report = Report();
+  return Decoder(json, report).Run(error);
+}
+
+}  // namespace virok
@@ -0,0 +1,28 @@
+#ifndef NATIVE_REPORT_REPORT_DECODER_H_
+#define NATIVE_REPORT_REPORT_DECODER_H_
+
+#include <string>
+#include <string_view>
+
+#include "report/report.h"
+
+namespace virok {
+
+// Розбирає відповідь пристрою на X/Z-звіт за один прохід потоковим
+// читачем, без проміжного дерева.
+//
+// Підтримує обидві форми, які сьогодні розбирає XReportData.fromJson:
+//  * Vchasno: {"res":0, "info":{...}, "warnings":[...]} (або поля info
+//    прямо в корені);
+//  * Cashalot: {"Ret":true, "Values":{"Base64Str1251ReportXML":...},
+//    "ShiftOpened":..., "Totals":{"ZREPBODY":{...}}}.
+// Невідомі ключі пропускаються. Візуалізація одразу перетворюється на
+// Report::print_data.
+//
+// Повертає false лише для синтаксично некоректного JSON; |error| (може
+// бути nullptr) тоді містить опис і зміщення.
+bool DecodeReport(std::string_view json, Report* report, std::string* error);
+
+}  // namespace virok
+
+#endif  // NATIVE_REPORT_REPORT_DECODER_H_
@@ -0,0 +1,183 @@
+#include "scale/scale_driver.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+#include "metrics/metrics.h"
+
+namespace virok {
+
+namespace {
+
+// Найдовше очікування в Read: стільки щонайбільше триває Stop.
+constexpr int kMaxReadWaitMs = 100;
+
+void RecordLatency(const StableWeightResult& r, const char* protocol) {
+  MetricsRegistry& registry = MetricsRegistry::Get();
+  const std::string label = MetricLabel("protocol", protocol);
+  registry
+      .GetHistogram(
+          "virok_scale_settle_microseconds",
+          "Time from the weight settling to the scale driver reporting it",
+          label)
+      ->Record(r.settle_latency_us);
+  registry
+      .GetHistogram("virok_scale_load_microseconds",
+                    "Time from goods touching the platform to a stable weight",
+                    label)
+      ->Record(r.load_latency_us);
+}
+
+}  // namespace
+
+const char* ScaleEventName(ScaleEvent::Type type) {
+  switch (type) {
+    case ScaleEvent::Type::kConnected:
+      return "connected";
+    case ScaleEvent::Type::kDisconnected:
+      return "disconnected";
+    case ScaleEvent::Type::kWeight:
+      return "weight";
+    case ScaleEvent::Type::kStable:
+      return "stable";
+    case ScaleEvent::Type::kRemoved:
+      return "removed";
+  }
+  return "";
+}
+
+ScaleDriver::ScaleDriver(ScaleListener listener)
+    : listener_(std::move(listener)) {}
+
+ScaleDriver::~ScaleDriver() { Stop(); }
+
+bool ScaleDriver::Start(const ScaleOptions& options, std::string* error) {
+  Stop();
+  options_ = options;
+  if (!port_.Open(options_.port, options_.baud, error)) return false;
+  stop_ = false;
+  thread_ = std::thread(&ScaleDriver::Run, this);
+  return true;
+}
+
+void ScaleDriver::Stop() {
+  if (!thread_.joinable()) return;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  thread_.join();
+  port_.Close();
+  stable_grams_ = -1;
+}
+
+bool ScaleDriver::Sleep(std::chrono::milliseconds delay) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return !wake_.wait_for(lock, delay, [this] { return stop_.load(); });
+}
+
+void ScaleDriver::Emit(ScaleEvent::Type type, int64_t grams) {
+  ScaleEvent event;
+  event.type = type;
+  event.grams = grams;
+  listener_(event);
+}
+
+void ScaleDriver::Disconnect(const std::string& error) {
+  port_.Close();
+  stable_grams_ = -1;
+  ScaleEvent event;
+  event.type = ScaleEvent::Type::kDisconnected;
+  event.error = error;
+  listener_(event);
+}
+
+void ScaleDriver::Run() {
+  using Clock = StableWeightDetector::Clock;
+  ScaleFrameParser parser(options_.protocol);
+  StableWeightDetector detector(options_.stable);
+  const std::string poll(parser.PollCommand());
+  const char* protocol = ScaleProtocolName(options_.protocol);
+
+  Emit(ScaleEvent::Type::kConnected);
+  std::vector<ScaleReading> readings;
+  char buf[256];
+  Clock::time_point next_poll = Clock::now();
+  bool has_shown = false;
+  int64_t shown_grams = 0;
+
+  while (!stop_) {
+    std::string error;
+    if (!port_.is_open()) {
+      if (!Sleep(options_.reconnect_delay)) break;
+      if (!port_.Open(options_.port, options_.baud, &error)) continue;
+      parser.Reset();
+      detector.Reset();
+      has_shown = false;
+      next_poll = Clock::now();
+      Emit(ScaleEvent::Type::kConnected);
+      continue;
+    }
+
+    int wait_ms = kMaxReadWaitMs;
+    if (!poll.empty()) {
+      const Clock::time_point now = Clock::now();
+      if (now >= next_poll) {
+        if (!port_.Write(poll, &error)) {
+          Disconnect(error);
+          continue;
+        }
+        next_poll = now + options_.poll_interval;
+      }
+      const auto until_poll =
+          std::chrono::duration_cast<std::chrono::milliseconds>(next_poll -
+                                                                now);
+      wait_ms = std::clamp(static_cast<int>(until_poll.count()), 1,
+                           kMaxReadWaitMs);
+    }
+
+    const int n = port_.Read(buf, sizeof(buf), wait_ms, &error);
+    if (n < 0) {
+      Disconnect(error);
+      continue;
+    }
+    if (n == 0) continue;
+
+    const Clock::time_point now = Clock::now();
+    readings.clear();
+    parser.Feed(std::string_view(buf, static_cast<size_t>(n)), &readings);
+    for (const ScaleReading& reading : readings) {
+      const StableWeightResult r = detector.Add(reading, now);
+      const int64_t stable = stable_grams_.load();
+      if (stable >= 0 && reading.has_weight &&
+          std::abs(reading.grams - stable) > options_.stable.tolerance_grams) {
+        stable_grams_ = -1;
+      }
+      if (reading.has_weight &&
+          (!has_shown || std::abs(reading.grams - shown_grams) >
+                             options_.stable.tolerance_grams)) {
+        has_shown = true;
+        shown_grams = reading.grams;
+        Emit(ScaleEvent::Type::kWeight, reading.grams);
+      }
+      if (r.kind == StableWeightResult::Kind::kStable) {
+        RecordLatency(r, protocol);
+        stable_grams_ = r.grams;
+        ScaleEvent event;
+        event.type = ScaleEvent::Type::kStable;
+        event.grams = r.grams;
+        event.settle_latency_us = r.settle_latency_us;
+        event.load_latency_us = r.load_latency_us;
+        listener_(event);
+      } else if (r.kind == StableWeightResult::Kind::kRemoved) {
+        stable_grams_ = -1;
+        Emit(ScaleEvent::Type::kRemoved, r.grams);
+      }
+    }
+  }
+}
+
+}  // namespace virok
@@ -0,0 +1,102 @@
+#ifndef NATIVE_SCALE_SCALE_DRIVER_H_
+#define NATIVE_SCALE_SCALE_DRIVER_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "scale/scale_protocol.h"
+#include "scale/serial_port.h"
+#include "scale/stable_weight_detector.h"
+
+namespace virok {
+
+struct ScaleOptions {
+  // "COM3" або "/dev/ttyUSB0".
+  std::string port;
+  int baud = 9600;
+  ScaleProtocol protocol = ScaleProtocol::kCasAscii;
+  // Як часто опитувати ваги з протоколом запит-відповідь.
+  std::chrono::milliseconds poll_interval = std::chrono::milliseconds(100);
+  // Пауза перед повторним відкриттям порту, що зник.
+  std::chrono::milliseconds reconnect_delay = std::chrono::seconds(2);
+  StableWeightOptions stable;
+};
+
+struct ScaleEvent {
+  enum class Type {
+    kConnected,
+    kDisconnected,
+    // Поточна маса змінилася (для індикатора; не частіше за показання).
+    kWeight,
+    kStable,
+    kRemoved,
+  };
+  Type type = Type::kWeight;
+  int64_t grams = 0;
+  // Для kStable, див. StableWeightResult.
+  int64_t settle_latency_us = 0;
+  int64_t load_latency_us = 0;
+  // Для kDisconnected.
+  std::string error;
+};
+
+const char* ScaleEventName(ScaleEvent::Type type);
+
+// Викликається з потоку вводу-виводу ваг.
+using ScaleListener = std::function<void(const ScaleEvent& event)>;
+
+// Драйвер торгових ваг: окремий потік читає порт (і опитує ваги, якщо
+// протокол цього вимагає), розбирає кадри і пропускає показання через
+// StableWeightDetector. Слухач отримує встановлену масу одразу, щойно
+// плато підтверджено, а не за запитом каси.
+//
+// Порт, що зник (вийняли USB-адаптер), перевідкривається кожні
+// reconnect_delay. Затримки виявлення пишуться в гістограми
+// virok_scale_settle_microseconds і virok_scale_load_microseconds.
+class ScaleDriver {
+ public:
+  explicit ScaleDriver(ScaleListener listener);
+  ~ScaleDriver();
+
+  ScaleDriver(const ScaleDriver&) = delete;
+  ScaleDriver& operator=(const ScaleDriver&) = delete;
+
+  // Відкриває порт і запускає потік. Драйвер, що вже працює, спершу
+  // зупиняється.
+  bool Start(const ScaleOptions& options, std::string* error);
+  void Stop();
+  bool running() const { return thread_.joinable(); }
+
+  // Маса, що встановилася і досі лежить на платформі, г; -1 — немає
+  // (порожньо, маса змінюється або ваги відключено). Товар, покладений
+  // до того, як каса почала чекати ваги, береться звідси, а не чекає
+  // наступного kStable, якого без зміни маси не буде.
+  int64_t stable_grams() const { return stable_grams_.load(); }
+
+ private:
+  void Run();
+  // Чекає |delay| або зупинки; false — драйвер зупиняють.
+  bool Sleep(std::chrono::milliseconds delay);
+  void Emit(ScaleEvent::Type type, int64_t grams = 0);
+  void Disconnect(const std::string& error);
+
+  const ScaleListener listener_;
+  ScaleOptions options_;
+  SerialPort port_;
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::atomic<bool> stop_{false};
+  std::atomic<int64_t> stable_grams_{-1};
+  std::thread thread_;
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_SCALE_SCALE_DRIVER_H_
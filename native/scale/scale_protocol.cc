@@ -0,0 +1,228 @@
+#include "scale/scale_protocol.h"
+
+#include <cctype>
+
+namespace virok {
+
+namespace {
+
+constexpr char kStx = 0x02;
+constexpr char kCr = '\r';
+// Кадр довший за це — сміття на лінії (не та швидкість, не той протокол).
+constexpr size_t kMaxFrame = 128;
+
+std::string_view Trim(std::string_view s) {
+  while (!s.empty() && std::isspace(static_cast<unsigned char>(s.front()))) {
+    s.remove_prefix(1);
+  }
+  while (!s.empty() && std::isspace(static_cast<unsigned char>(s.back()))) {
+    s.remove_suffix(1);
+  }
+  return s;
+}
+
+// "+  1.234kg", "1234 g", "01.234" (без одиниці — кілограми) у грамах.
+// Десяткова частина розбирається без double, щоб 1.005 кг лишалися 1005 г.
+bool ParseMass(std::string_view text, int64_t* grams, bool* negative) {
+  text = Trim(text);
+  *negative = false;
+  if (!text.empty() && (text.front() == '+' || text.front() == '-')) {
+    *negative = text.front() == '-';
+    text.remove_prefix(1);
+    text = Trim(text);
+  }
+  int64_t whole = 0;
+  int64_t frac = 0;
+  int frac_digits = 0;
+  bool digits = false;
+  bool point = false;
+  size_t i = 0;
+  for (; i < text.size(); i++) {
+    const char c = text[i];
+    if (c >= '0' && c <= '9') {
+      digits = true;
+      if (!point) {
+        whole = whole * 10 + (c - '0');
+      } else if (frac_digits < 3) {
+        frac = frac * 10 + (c - '0');
+        frac_digits++;
+      }
+    } else if ((c == '.' || c == ',') && !point) {
+      point = true;
+    } else {
+      break;
+    }
+  }
+  if (!digits || whole > 1000000) return false;
+  for (; frac_digits < 3; frac_digits++) frac *= 10;
+
+  const std::string_view unit = Trim(text.substr(i));
+  if (unit.empty() || unit == "kg" || unit == "KG" || unit == "Kg") {
+    *grams = whole * 1000 + frac;
+  } else if (unit == "g" || unit == "G") {
+    // Частки грама відкидаємо з округленням.
+    *grams = whole + (frac >= 500 ? 1 : 0);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+std::vector<std::string_view> Split(std::string_view s, char separator) {
+  std::vector<std::string_view> parts;
+  for (;;) {
+    const size_t pos = s.find(separator);
+    parts.push_back(s.substr(0, pos));
+    if (pos == std::string_view::npos) return parts;
+    s.remove_prefix(pos + 1);
+  }
+}
+
+std::vector<std::string_view> Words(std::string_view s) {
+  std::vector<std::string_view> words;
+  size_t i = 0;
+  while (i < s.size()) {
+    while (i < s.size() && s[i] == ' ') i++;
+    const size_t start = i;
+    while (i < s.size() && s[i] != ' ') i++;
+    if (i > start) words.push_back(s.substr(start, i - start));
+  }
+  return words;
+}
+
+bool SetMass(std::string_view text, ScaleReading* out) {
+  bool negative = false;
+  if (!ParseMass(text, &out->grams, &negative)) return false;
+  if (negative && out->grams != 0) {
+    // Від'ємна маса (тара більша за вантаж): показання немає.
+    out->out_of_range = true;
+    out->grams = 0;
+    return true;
+  }
+  out->has_weight = true;
+  return true;
+}
+
+}  // namespace
+
+bool ParseScaleProtocol(std::string_view name, ScaleProtocol* out) {
+  if (name == "cas") {
+    *out = ScaleProtocol::kCasAscii;
+  } else if (name == "mt-sics") {
+    *out = ScaleProtocol::kMtSics;
+  } else if (name == "toledo-8217") {
+    *out = ScaleProtocol::kToledo8217;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+const char* ScaleProtocolName(ScaleProtocol protocol) {
+  switch (protocol) {
+    case ScaleProtocol::kCasAscii:
+      return "cas";
+    case ScaleProtocol::kMtSics:
+      return "mt-sics";
+    case ScaleProtocol::kToledo8217:
+      return "toledo-8217";
+  }
+  return "";
+}
+
+ScaleFrameParser::ScaleFrameParser(ScaleProtocol protocol)
+    : protocol_(protocol) {}
+
+std::string_view ScaleFrameParser::PollCommand() const {
+  switch (protocol_) {
+    case ScaleProtocol::kCasAscii:
+      return {};
+    case ScaleProtocol::kMtSics:
+      return "SI\r\n";
+    case ScaleProtocol::kToledo8217:
+      return "W";
+  }
+  return {};
+}
+
+void ScaleFrameParser::Feed(std::string_view bytes,
+                            std::vector<ScaleReading>* out) {
+  pending_.append(bytes.data(), bytes.size());
+  const bool toledo = protocol_ == ScaleProtocol::kToledo8217;
+  size_t start = 0;
+  for (;;) {
+    if (toledo) {
+      // Усе до STX — залишки попереднього кадру або шум.
+      const size_t stx = pending_.find(kStx, start);
+      if (stx == std::string::npos) {
+        start = pending_.size();
+        break;
+      }
+      start = stx;
+    }
+    const size_t end = pending_.find(toledo ? kCr : '\n', start);
+    if (end == std::string::npos) break;
+    std::string_view frame(pending_.data() + start, end - start);
+    if (toledo) frame.remove_prefix(1);
+    ScaleReading reading;
+    if (ParseFrame(frame, &reading)) out->push_back(reading);
+    start = end + 1;
+  }
+  pending_.erase(0, start);
+  if (pending_.size() > kMaxFrame) pending_.clear();
+}
+
+bool ScaleFrameParser::ParseFrame(std::string_view frame,
+                                  ScaleReading* out) const {
+  // Байт стану Toledo може бути пробілом, тож його кадр не обрізається.
+  if (protocol_ != ScaleProtocol::kToledo8217) frame = Trim(frame);
+  if (frame.empty()) return false;
+  switch (protocol_) {
+    case ScaleProtocol::kCasAscii: {
+      // ST,GS,+  1.234kg (деякі моделі вставляють номер ваг третім полем:
+      // маса завжди остання).
+      const std::vector<std::string_view> fields = Split(frame, ',');
+      if (fields.size() < 3) return false;
+      const std::string_view status = Trim(fields.front());
+      if (status == "OL") {
+        out->out_of_range = true;
+        return true;
+      }
+      if (status != "ST" && status != "US") return false;
+      out->device_stable = status == "ST";
+      return SetMass(fields.back(), out);
+    }
+    case ScaleProtocol::kMtSics: {
+      // S S      1.234 kg; S D — у русі; S + / S - — поза діапазоном;
+      // S I, ES, EL — ваги зайняті або не зрозуміли команду.
+      const std::vector<std::string_view> words = Words(frame);
+      if (words.size() < 2 || words[0] != "S") return false;
+      if (words[1] == "+" || words[1] == "-") {
+        out->out_of_range = true;
+        return true;
+      }
+      if ((words[1] != "S" && words[1] != "D") || words.size() < 3) {
+        return false;
+      }
+      out->device_stable = words[1] == "S";
+      std::string mass(words[2]);
+      if (words.size() > 3) mass += words[3];
+      return SetMass(mass, out);
+    }
+    case ScaleProtocol::kToledo8217: {
+      // Байт стану після "?": біт 0 — у русі, біти 4 і 5 — нижче нуля і
+      // перевантаження.
+      if (frame.front() == '?') {
+        const unsigned char state =
+            frame.size() > 1 ? static_cast<unsigned char>(frame[1]) : 0;
+        out->out_of_range = (state & 0x30) != 0;
+        return true;
+      }
+      out->device_stable = true;
+      return SetMass(frame, out);
+    }
+  }
+  return false;
+}
+
+}  // namespace virok
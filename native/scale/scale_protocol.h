@@ -0,0 +1,65 @@
+#ifndef NATIVE_SCALE_SCALE_PROTOCOL_H_
+#define NATIVE_SCALE_SCALE_PROTOCOL_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace virok {
+
+// Протоколи торгових ваг з RS-232/USB-COM.
+enum class ScaleProtocol {
+  // Безперервний ASCII-потік CAS (PD-II, ER, AP, DB): ваги самі шлють
+  // "ST,GS,+  1.234kg\r\n" (ST — стабільно, US — у русі, OL —
+  // перевантаження) кілька разів на секунду.
+  kCasAscii,
+  // MT-SICS (Mettler Toledo, частина Axis/Jadever): на "SI\r\n" ваги
+  // відповідають "S S      1.234 kg\r\n" (S S — стабільно, S D — у русі).
+  kMtSics,
+  // Toledo 8217 (POS-режим багатьох ваг): на "W" ваги відповідають
+  // STX "01.234" CR, а в русі — STX "?" <стан> CR.
+  kToledo8217,
+};
+
+// "cas", "mt-sics", "toledo-8217"; false — невідомий протокол.
+bool ParseScaleProtocol(std::string_view name, ScaleProtocol* out);
+const char* ScaleProtocolName(ScaleProtocol protocol);
+
+// Одне показання ваг.
+struct ScaleReading {
+  // Маса нетто в грамах; лише якщо |has_weight|.
+  int64_t grams = 0;
+  bool has_weight = false;
+  // Ваги самі вважають показання стабільним.
+  bool device_stable = false;
+  // Перевантаження або від'ємна маса: показання немає.
+  bool out_of_range = false;
+};
+
+// Розбирає потік байтів із ваг на показання. Кадри можуть приходити
+// частинами і з шумом між ними: незавершений кадр чекає на наступні байти,
+// а кадр, що не розібрався, пропускається.
+class ScaleFrameParser {
+ public:
+  explicit ScaleFrameParser(ScaleProtocol protocol);
+
+  ScaleProtocol protocol() const { return protocol_; }
+  // Запит показання для протоколів з опитуванням; порожній, якщо ваги
+  // шлють потік самі.
+  std::string_view PollCommand() const;
+
+  void Feed(std::string_view bytes, std::vector<ScaleReading>* out);
+  // Скинути незавершений кадр (після перепідключення).
+  void Reset() { pending_.clear(); }
+
+ private:
+  bool ParseFrame(std::string_view frame, ScaleReading* out) const;
+
+  const ScaleProtocol protocol_;
+  std::string pending_;
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_SCALE_SCALE_PROTOCOL_H_
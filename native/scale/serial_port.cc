@@ -0,0 +1,223 @@
+#include "scale/serial_port.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif
+
+namespace virok {
+
+SerialPort::~SerialPort() { Close(); }
+
+#ifdef _WIN32
+
+namespace {
+
+std::string LastError(const std::string& what) {
+  return what + " failed: " + std::to_string(GetLastError());
+}
+
+}  // namespace
+
+bool SerialPort::Open(const std::string& path, int baud, std::string* error) {
+  Close();
+  // COM10 і далі відкриваються лише через простір імен пристроїв.
+  const std::string device =
+      path.rfind("\\\\.\\", 0) == 0 ? path : "\\\\.\\" + path;
+  HANDLE handle = CreateFileA(device.c_str(), GENERIC_READ | GENERIC_WRITE, 0,
+                              nullptr, OPEN_EXISTING, 0, nullptr);
+  if (handle == INVALID_HANDLE_VALUE) {
+    if (error) *error = LastError("CreateFile " + path);
+    return false;
+  }
+  DCB dcb = {};
+  dcb.DCBlength = sizeof(dcb);
+  if (!GetCommState(handle, &dcb)) {
+    if (error) *error = LastError("GetCommState");
+    CloseHandle(handle);
+    return false;
+  }
+  dcb.BaudRate = static_cast<DWORD>(baud);
+  dcb.ByteSize = 8;
+  dcb.Parity = NOPARITY;
+  dcb.StopBits = ONESTOPBIT;
+  dcb.fBinary = TRUE;
+  dcb.fParity = FALSE;
+  dcb.fOutxCtsFlow = FALSE;
+  dcb.fOutxDsrFlow = FALSE;
+  dcb.fDtrControl = DTR_CONTROL_ENABLE;
+  dcb.fRtsControl = RTS_CONTROL_ENABLE;
+  dcb.fOutX = FALSE;
+  dcb.fInX = FALSE;
+  if (!SetCommState(handle, &dcb)) {
+    if (error) *error = LastError("SetCommState");
+    CloseHandle(handle);
+    return false;
+  }
+  PurgeComm(handle, PURGE_RXCLEAR | PURGE_TXCLEAR);
+  handle_ = handle;
+  read_timeout_ms_ = -1;
+  return true;
+}
+
+void SerialPort::Close() {
+  if (handle_) CloseHandle(static_cast<HANDLE>(handle_));
+  handle_ = nullptr;
+}
+
+bool SerialPort::is_open() const { return handle_ != nullptr; }
+
+int SerialPort::Read(char* buf, size_t size, int timeout_ms,
+                     std::string* error) {
+  HANDLE handle = static_cast<HANDLE>(handle_);
+  if (timeout_ms != read_timeout_ms_) {
+    // Повертатися, щойно прийшов хоч один байт і настала пауза, або за
+    // загальним тайм-аутом.
+    COMMTIMEOUTS timeouts = {};
+    timeouts.ReadIntervalTimeout = MAXDWORD;
+    timeouts.ReadTotalTimeoutMultiplier = MAXDWORD;
+    timeouts.ReadTotalTimeoutConstant = static_cast<DWORD>(timeout_ms);
+    timeouts.WriteTotalTimeoutConstant = 1000;
+    if (!SetCommTimeouts(handle, &timeouts)) {
+      if (error) *error = LastError("SetCommTimeouts");
+      return -1;
+    }
+    read_timeout_ms_ = timeout_ms;
+  }
+  DWORD read = 0;
+  if (!ReadFile(handle, buf, static_cast<DWORD>(size), &read, nullptr)) {
+    if (error) *error = LastError("ReadFile");
+    return -1;
+  }
+  return static_cast<int>(read);
+}
+
+bool SerialPort::Write(std::string_view data, std::string* error) {
+  DWORD written = 0;
+  if (!WriteFile(static_cast<HANDLE>(handle_), data.data(),
+                 static_cast<DWORD>(data.size()), &written, nullptr) ||
+      written != data.size()) {
+    if (error) *error = LastError("WriteFile");
+    return false;
+  }
+  return true;
+}
+
+#else
+
+namespace {
+
+std::string Errno(const std::string& what) {
+  return what + ": " + std::strerror(errno);
+}
+
+speed_t BaudConstant(int baud) {
+  switch (baud) {
+    case 1200:
+      return B1200;
+    case 2400:
+      return B2400;
+    case 4800:
+      return B4800;
+    case 19200:
+      return B19200;
+    case 38400:
+      return B38400;
+    case 57600:
+      return B57600;
+    case 115200:
+      return B115200;
+    default:
+      return B9600;
+  }
+}
+
+}  // namespace
+
+bool SerialPort::Open(const std::string& path, int baud, std::string* error) {
+  Close();
+  const int fd = open(path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+  if (fd < 0) {
+    if (error) *error = Errno(path);
+    return false;
+  }
+  termios tio = {};
+  if (tcgetattr(fd, &tio) != 0) {
+    if (error) *error = Errno("tcgetattr " + path);
+    close(fd);
+    return false;
+  }
+  cfmakeraw(&tio);
+  tio.c_cflag |= CLOCAL | CREAD;
+  tio.c_cflag &= ~(CSTOPB | PARENB | CRTSCTS);
+  tio.c_cc[VMIN] = 0;
+  tio.c_cc[VTIME] = 0;
+  cfsetispeed(&tio, BaudConstant(baud));
+  cfsetospeed(&tio, BaudConstant(baud));
+  if (tcsetattr(fd, TCSANOW, &tio) != 0) {
+    if (error) *error = Errno("tcsetattr " + path);
+    close(fd);
+    return false;
+  }
+  tcflush(fd, TCIOFLUSH);
+  fd_ = fd;
+  return true;
+}
+
+void SerialPort::Close() {
+  if (fd_ >= 0) close(fd_);
+  fd_ = -1;
+}
+
+bool SerialPort::is_open() const { return fd_ >= 0; }
+
+int SerialPort::Read(char* buf, size_t size, int timeout_ms,
+                     std::string* error) {
+  pollfd pfd = {fd_, POLLIN, 0};
+  const int ready = poll(&pfd, 1, timeout_ms);
+  if (ready < 0) {
+    if (errno == EINTR) return 0;
+    if (error) *error = Errno("poll");
+    return -1;
+  }
+  if (ready == 0) return 0;
+  const ssize_t n = read(fd_, buf, size);
+  if (n > 0) return static_cast<int>(n);
+  if (n < 0 && (errno == EAGAIN || errno == EINTR)) return 0;
+  // POLLHUP/EIO: USB-адаптер вийняли або другий кінець pty закрився.
+  if (error) *error = n == 0 ? "port closed" : Errno("read");
+  return -1;
+}
+
+bool SerialPort::Write(std::string_view data, std::string* error) {
+  size_t done = 0;
+  while (done < data.size()) {
+    const ssize_t n = write(fd_, data.data() + done, data.size() - done);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      if (errno == EAGAIN) {
+        pollfd pfd = {fd_, POLLOUT, 0};
+        if (poll(&pfd, 1, 1000) <= 0) {
+          if (error) *error = "write timeout";
+          return false;
+        }
+        continue;
+      }
+      if (error) *error = Errno("write");
+      return false;
+    }
+    done += static_cast<size_t>(n);
+  }
+  return true;
+}
+
+#endif
+
+}  // namespace virok
@@ -0,0 +1,44 @@
+#ifndef NATIVE_SCALE_SERIAL_PORT_H_
+#define NATIVE_SCALE_SERIAL_PORT_H_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace virok {
+
+// Послідовний порт у режимі 8N1 без керування потоком: COM-порт Windows
+// ("COM3") або пристрій POSIX ("/dev/ttyUSB0", псевдотермінал у тестах).
+//
+// Читання з тайм-аутом, щоб потік вводу-виводу міг перевіряти, чи його
+// не зупиняють. Не потокобезпечний: порт належить одному потоку.
+class SerialPort {
+ public:
+  SerialPort() = default;
+  ~SerialPort();
+
+  SerialPort(const SerialPort&) = delete;
+  SerialPort& operator=(const SerialPort&) = delete;
+
+  bool Open(const std::string& path, int baud, std::string* error);
+  void Close();
+  bool is_open() const;
+
+  // Чекає на дані до |timeout_ms| і читає те, що є, до |size| байтів.
+  // Повертає кількість байтів, 0 — тайм-аут, -1 — порт зник (помилка в
+  // |error|).
+  int Read(char* buf, size_t size, int timeout_ms, std::string* error);
+  bool Write(std::string_view data, std::string* error);
+
+ private:
+#ifdef _WIN32
+  void* handle_ = nullptr;
+  int read_timeout_ms_ = -1;
+#else
+  int fd_ = -1;
+#endif
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_SCALE_SERIAL_PORT_H_
@@ -0,0 +1,97 @@
+#include "scale/stable_weight_detector.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace virok {
+
+namespace {
+
+int64_t MicrosBetween(StableWeightDetector::Clock::time_point from,
+                      StableWeightDetector::Clock::time_point to) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(to - from)
+      .count();
+}
+
+}  // namespace
+
+StableWeightDetector::StableWeightDetector(StableWeightOptions options)
+    : options_(options) {}
+
+void StableWeightDetector::Reset() {
+  in_plateau_ = false;
+  plateau_reported_ = false;
+  loaded_ = false;
+  reported_ = false;
+  last_grams_ = 0;
+}
+
+void StableWeightDetector::StartPlateau(int64_t grams, Clock::time_point now) {
+  in_plateau_ = true;
+  plateau_reported_ = false;
+  plateau_min_ = grams;
+  plateau_max_ = grams;
+  plateau_count_ = 0;
+  plateau_start_ = now;
+}
+
+StableWeightResult StableWeightDetector::Add(const ScaleReading& reading,
+                                             Clock::time_point now) {
+  StableWeightResult result;
+  if (!reading.has_weight) {
+    // Ваги в русі без маси або поза діапазоном: плато перервано.
+    in_plateau_ = false;
+    return result;
+  }
+
+  const int64_t grams = reading.grams;
+  last_grams_ = grams;
+  if (grams < options_.min_grams) {
+    in_plateau_ = false;
+    loaded_ = false;
+    if (reported_) {
+      reported_ = false;
+      result.kind = StableWeightResult::Kind::kRemoved;
+      result.grams = grams;
+    }
+    return result;
+  }
+
+  if (!loaded_) {
+    loaded_ = true;
+    load_start_ = now;
+  }
+  if (!in_plateau_ ||
+      std::max(plateau_max_, grams) - std::min(plateau_min_, grams) >
+          options_.tolerance_grams) {
+    StartPlateau(grams, now);
+  }
+  plateau_min_ = std::min(plateau_min_, grams);
+  plateau_max_ = std::max(plateau_max_, grams);
+  plateau_count_++;
+  if (plateau_reported_) return result;
+
+  const bool held = now - plateau_start_ >= options_.settle &&
+                    plateau_count_ >= options_.min_readings;
+  const bool confirmed = options_.trust_device_flag &&
+                         reading.device_stable && plateau_count_ >= 2;
+  if (!held && !confirmed) return result;
+
+  plateau_reported_ = true;
+  // Плато перервалося на мить (одне показання в русі), а маса та сама:
+  // товар уже додано, вдруге не повідомляємо.
+  if (reported_ &&
+      std::abs(grams - reported_grams_) <= options_.tolerance_grams) {
+    return result;
+  }
+  reported_ = true;
+  reported_grams_ = grams;
+  // Повідомляється поточне показання — саме його ваги показують покупцеві.
+  result.kind = StableWeightResult::Kind::kStable;
+  result.grams = grams;
+  result.settle_latency_us = MicrosBetween(plateau_start_, now);
+  result.load_latency_us = MicrosBetween(load_start_, now);
+  return result;
+}
+
+}  // namespace virok
@@ -0,0 +1,88 @@
+#ifndef NATIVE_SCALE_STABLE_WEIGHT_DETECTOR_H_
+#define NATIVE_SCALE_STABLE_WEIGHT_DETECTOR_H_
+
+#include <chrono>
+#include <cstdint>
+
+#include "scale/scale_protocol.h"
+
+namespace virok {
+
+struct StableWeightOptions {
+  // Коливання показань у межах плато (дискрета ваг і вібрація прилавка).
+  int64_t tolerance_grams = 2;
+  // Скільки показання мають триматися в межах допуску.
+  std::chrono::milliseconds settle = std::chrono::milliseconds(250);
+  // І скільки щонайменше показань на це плато (ваги, що шлють рідко).
+  int min_readings = 3;
+  // Менше — порожня платформа.
+  int64_t min_grams = 20;
+  // Прапорець стабільності від ваг разом з двома однаковими показаннями
+  // підтверджує плато, не чекаючи |settle|.
+  bool trust_device_flag = true;
+};
+
+// Що змінилося після показання.
+struct StableWeightResult {
+  enum class Kind {
+    kNone,
+    // Маса встановилася (один раз на кожне нове плато).
+    kStable,
+    // Платформу звільнили після встановленої маси.
+    kRemoved,
+  };
+  Kind kind = Kind::kNone;
+  int64_t grams = 0;
+  // Від першого показання плато до виявлення: на скільки каса дізналася
+  // про масу пізніше, ніж вона справді встановилася.
+  int64_t settle_latency_us = 0;
+  // Від першого показання з вантажем до виявлення (покласти товар — і
+  // побачити його в кошику).
+  int64_t load_latency_us = 0;
+};
+
+// Виявляє встановлену масу в потоці показань.
+//
+// Плато — поспіль показання, розкид яких не більший за tolerance_grams.
+// Маса вважається встановленою, коли плато тримається settle і має
+// min_readings показань (або раніше, якщо ваги самі позначили показання
+// стабільним). Про кожне плато повідомляється один раз; наступне —
+// лише після того, як маса змінилася за межі допуску або платформу
+// звільнили. Час передається явно, тож детектор детермінований у тестах.
+class StableWeightDetector {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit StableWeightDetector(StableWeightOptions options = {});
+
+  StableWeightResult Add(const ScaleReading& reading, Clock::time_point now);
+  void Reset();
+
+  // Останнє показання з масою (для індикатора на екрані).
+  int64_t last_grams() const { return last_grams_; }
+  bool settled() const { return reported_; }
+
+ private:
+  void StartPlateau(int64_t grams, Clock::time_point now);
+
+  const StableWeightOptions options_;
+
+  bool in_plateau_ = false;
+  int64_t plateau_min_ = 0;
+  int64_t plateau_max_ = 0;
+  int plateau_count_ = 0;
+  Clock::time_point plateau_start_;
+  bool plateau_reported_ = false;
+  // Вантаж на платформі з цього моменту (для load_latency_us).
+  bool loaded_ = false;
+  Clock::time_point load_start_;
+  // Відколи платформа не порожня, вже повідомлено про масу
+  // |reported_grams_|.
+  bool reported_ = false;
+  int64_t reported_grams_ = 0;
+  int64_t last_grams_ = 0;
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_SCALE_STABLE_WEIGHT_DETECTOR_H_
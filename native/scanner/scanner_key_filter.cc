@@ -0,0 +1,235 @@
+#include "scanner/scanner_key_filter.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+
+#include "metrics/metrics.h"
+
+namespace virok {
+
+namespace {
+
+void AppendUtf8(char32_t c, std::string* out) {
+  if (c < 0x80) {
+    out->push_back(static_cast<char>(c));
+  } else if (c < 0x800) {
+    out->push_back(static_cast<char>(0xC0 | (c >> 6)));
+    out->push_back(static_cast<char>(0x80 | (c & 0x3F)));
+  } else if (c < 0x10000) {
+    out->push_back(static_cast<char>(0xE0 | (c >> 12)));
+    out->push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | (c & 0x3F)));
+  } else {
+    out->push_back(static_cast<char>(0xF0 | (c >> 18)));
+    out->push_back(static_cast<char>(0x80 | ((c >> 12) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | (c & 0x3F)));
+  }
+}
+
+bool IsPrintable(char32_t c) { return c >= 0x20 && c != 0x7F; }
+
+}  // namespace
+
+ScannerKeyFilter::ScannerKeyFilter(ScannerOptions options)
+    : options_(options) {}
+
+ScannerKeyFilter::Clock::time_point ScannerKeyFilter::deadline() const {
+  return last_key_ +
+         (prefixed_ ? options_.prefix_timeout : options_.max_key_gap);
+}
+
+bool ScannerKeyFilter::IsRepeat(uint32_t code) const {
+  for (auto it = held_.rbegin(); it != held_.rend(); ++it) {
+    if (it->code == code) return it->type == ScannerKey::Type::kDown;
+  }
+  return false;
+}
+
+bool ScannerKeyFilter::Filter(const ScannerKey& key, ScannerOutput* out) {
+  if (holding() && key.time > deadline()) Expire(key.time, out);
+
+  if (key.type == ScannerKey::Type::kUp) {
+    // Відпускання клавіш уже поглинутого коду (сканер відпускає останні
+    // клавіші, коли код уже розпізнано).
+    auto it = std::find(swallowed_.begin(), swallowed_.end(), key.code);
+    if (it != swallowed_.end()) {
+      swallowed_.erase(it);
+      out->drop.push_back(key.token);
+      return true;
+    }
+    if (!holding()) return false;
+    held_.push_back(key);
+    return true;
+  }
+
+  if (key.modifier) {
+    if (!holding()) return false;
+    held_.push_back(key);
+    return true;
+  }
+
+  if (!holding()) {
+    prefixed_ = options_.prefix != 0 && key.ch == options_.prefix;
+    if (!prefixed_ && !IsPrintable(key.ch)) return false;
+    code_.clear();
+    code_chars_ = 0;
+    if (!prefixed_) {
+      AppendUtf8(key.ch, &code_);
+      code_chars_ = 1;
+    }
+    first_key_ = key.time;
+    last_key_ = key.time;
+    held_.push_back(key);
+    return true;
+  }
+
+  if (IsRepeat(key.code)) {
+    Release(out);
+    return false;
+  }
+  if (options_.suffix != 0 && key.ch == options_.suffix) {
+    if (code_chars_ >= options_.min_length) {
+      Accept(&key, key.time, out);
+      return true;
+    }
+    Release(out);
+    return false;
+  }
+  if (!IsPrintable(key.ch)) {
+    Release(out);
+    return false;
+  }
+  AppendUtf8(key.ch, &code_);
+  ++code_chars_;
+  last_key_ = key.time;
+  held_.push_back(key);
+  return true;
+}
+
+void ScannerKeyFilter::Expire(Clock::time_point now, ScannerOutput* out) {
+  if (!holding() || now <= deadline()) return;
+  if (options_.suffix == 0 && code_chars_ >= options_.min_length) {
+    Accept(nullptr, last_key_, out);
+  } else {
+    Release(out);
+  }
+}
+
+void ScannerKeyFilter::Flush(ScannerOutput* out) {
+  if (holding()) Release(out);
+}
+
+void ScannerKeyFilter::Release(ScannerOutput* out) {
+  for (const ScannerKey& key : held_) out->release.push_back(key.token);
+  held_.clear();
+  code_.clear();
+  code_chars_ = 0;
+  prefixed_ = false;
+}
+
+void ScannerKeyFilter::Accept(const ScannerKey* terminator,
+                              Clock::time_point end, ScannerOutput* out) {
+  for (size_t i = 0; i < held_.size(); ++i) {
+    const ScannerKey& key = held_[i];
+    const auto same_code = [&key](const ScannerKey& other) {
+      return other.code == key.code;
+    };
+    if (key.type == ScannerKey::Type::kUp) {
+      // Відпускання клавіші, натиснутої до сплеску: застосунок бачив
+      // натискання, тож має побачити й відпускання.
+      const bool own = std::any_of(held_.begin(), held_.begin() + i,
+                                   same_code);
+      (own ? out->drop : out->release).push_back(key.token);
+      continue;
+    }
+    out->drop.push_back(key.token);
+    if (std::none_of(held_.begin() + i + 1, held_.end(), same_code)) {
+      swallowed_.push_back(key.code);
+    }
+  }
+  if (terminator != nullptr) {
+    out->drop.push_back(terminator->token);
+    swallowed_.push_back(terminator->code);
+  }
+
+  out->barcode = std::move(code_);
+  out->burst_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(end - first_key_)
+          .count();
+  MetricsRegistry::Get()
+      .GetHistogram("virok_scanner_burst_microseconds",
+                    "Time from the first key of a scanned code to its end")
+      ->Record(out->burst_us);
+
+  held_.clear();
+  code_.clear();
+  code_chars_ = 0;
+  prefixed_ = false;
+}
+
+std::string FormatScannerKey(const ScannerKey& key,
+                             ScannerKey::Clock::time_point origin) {
+  const double ms =
+      std::chrono::duration<double, std::milli>(key.time - origin).count();
+  char buf[96];
+  if (key.ch != 0) {
+    std::snprintf(buf, sizeof(buf), "%.3f %c %u U+%04X%s", ms,
+                  key.type == ScannerKey::Type::kDown ? 'd' : 'u', key.code,
+                  static_cast<unsigned>(key.ch), key.modifier ? " m" : "");
+  } else {
+    std::snprintf(buf, sizeof(buf), "%.3f %c %u -%s", ms,
+                  key.type == ScannerKey::Type::kDown ? 'd' : 'u', key.code,
+                  key.modifier ? " m" : "");
+  }
+  return buf;
+}
+
+bool ParseScannerRecording(std::string_view text,
+                           ScannerKey::Clock::time_point origin,
+                           std::vector<ScannerKey>* keys, std::string* error) {
+  size_t line_no = 0;
+  while (!text.empty()) {
+    const size_t eol = text.find('\n');
+    std::string line(text.substr(0, eol));
+    text.remove_prefix(eol == std::string_view::npos ? text.size() : eol + 1);
+    ++line_no;
+
+    const size_t hash = line.find('#');
+    if (hash != std::string::npos) line.resize(hash);
+    if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+    double ms = 0;
+    char type = 0;
+    unsigned code = 0;
+    char ch[16] = {};
+    char flag[8] = {};
+    const int fields = std::sscanf(line.c_str(), "%lf %c %u %15s %7s", &ms,
+                                   &type, &code, ch, flag);
+    ScannerKey key;
+    bool ok = fields >= 4 && (type == 'd' || type == 'u');
+    if (ok && ch[0] != '-') {
+      ok = ch[0] == 'U' && ch[1] == '+';
+      char* end = nullptr;
+      if (ok) key.ch = static_cast<char32_t>(std::strtoul(ch + 2, &end, 16));
+      ok = ok && end != nullptr && *end == '\0';
+    }
+    if (!ok) {
+      *error = "line " + std::to_string(line_no) + ": " + line;
+      return false;
+    }
+    key.type =
+        type == 'd' ? ScannerKey::Type::kDown : ScannerKey::Type::kUp;
+    key.code = code;
+    key.modifier = fields == 5 && flag[0] == 'm';
+    key.time = origin + std::chrono::duration_cast<ScannerKey::Clock::duration>(
+                            std::chrono::duration<double, std::milli>(ms));
+    key.token = keys->size();
+    keys->push_back(key);
+  }
+  return true;
+}
+
+}  // namespace virok
@@ -0,0 +1,135 @@
+#ifndef NATIVE_SCANNER_SCANNER_KEY_FILTER_H_
+#define NATIVE_SCANNER_SCANNER_KEY_FILTER_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace virok {
+
+struct ScannerOptions {
+  // Найбільша пауза між клавішами сканера. Сканер-клавіатура «друкує» код
+  // за 2-10 мс на символ, людина — від 60 мс.
+  std::chrono::milliseconds max_key_gap = std::chrono::milliseconds(30);
+  // Коротший сплеск — не штрихкод, а швидкий набір.
+  size_t min_length = 6;
+  // Символ, яким сканер позначає початок коду (0 — без префікса). Після
+  // префікса код збирається без вимог до пауз, доки вони не перевищать
+  // prefix_timeout (бездротові сканери з нерівним темпом).
+  char32_t prefix = 0;
+  std::chrono::milliseconds prefix_timeout = std::chrono::milliseconds(300);
+  // Завершувач коду ('\r' — Enter, '\t' — Tab). 0 — код закінчується
+  // паузою довшою за max_key_gap.
+  char32_t suffix = U'\r';
+};
+
+// Натискання або відпускання клавіші, як його бачить раннер.
+struct ScannerKey {
+  using Clock = std::chrono::steady_clock;
+
+  enum class Type { kDown, kUp };
+  Type type = Type::kDown;
+  // Апаратний код клавіші: за ним відпускання пов'язується з натисканням.
+  uint32_t code = 0;
+  // Символ, що його друкує натискання; 0 — не символ (стрілки, F1,
+  // Backspace, комбінації з Ctrl/Alt). Enter — '\r', Tab — '\t'.
+  char32_t ch = 0;
+  // Shift, Ctrl, Alt: не переривають сплеск і утримуються разом з ним.
+  bool modifier = false;
+  Clock::time_point time;
+  // Ідентифікатор сирої події раннера (скопійований MSG, GdkEvent).
+  uint64_t token = 0;
+};
+
+struct ScannerOutput {
+  // Утримані події, що виявилися набором людини: доставити застосунку в
+  // цьому порядку (перед поточною подією, якщо Filter повернув false).
+  std::vector<uint64_t> release;
+  // Утримані й поглинуті події: раннер звільняє їх, не доставляючи.
+  std::vector<uint64_t> drop;
+  // Зчитаний код (UTF-8) або порожньо.
+  std::string barcode;
+  // Від першої клавіші коду до завершувача, мкс.
+  int64_t burst_us = 0;
+
+  void Clear() {
+    release.clear();
+    drop.clear();
+    barcode.clear();
+    burst_us = 0;
+  }
+};
+
+// Розпізнає сканер-клавіатуру в потоці клавіш за темпом і
+// префіксом/завершувачем.
+//
+// Кожна символьна клавіша, що може бути початком коду, утримується, доки не
+// стане ясно, чия вона: наступна клавіша через max_key_gap або раніше
+// продовжує сплеск; завершувач після щонайменше min_length символів
+// перетворює сплеск на штрихкод, і всі його клавіші (з відпусканнями, що
+// прийдуть пізніше) поглинаються. Інакше утримане віддається застосунку в
+// початковому порядку, тож набір людини запізнюється щонайбільше на
+// max_key_gap. Автоповтор (повторне натискання без відпускання) сканером не
+// вважається.
+//
+// Фільтр не знає про платформу і годинник: час приходить з подіями, а
+// раннер викликає Expire, коли настає deadline(). Тому записаний потік
+// клавіш відтворюється в тестах детерміновано. Не потокобезпечний: усе
+// викликається з потоку платформи.
+class ScannerKeyFilter {
+ public:
+  using Clock = ScannerKey::Clock;
+
+  explicit ScannerKeyFilter(ScannerOptions options = {});
+
+  // False — доставити |key| застосунку зараз (після out->release); true —
+  // фільтр забрав подію: утримав або поглинув. |out| доповнюється.
+  bool Filter(const ScannerKey& key, ScannerOutput* out);
+
+  // Час вийшов: утримане віддається застосунку (або стає штрихкодом, якщо
+  // завершувача немає). До deadline() нічого не робить.
+  void Expire(Clock::time_point now, ScannerOutput* out);
+
+  // Віддає все утримане (вікно втратило фокус, змінилися налаштування).
+  void Flush(ScannerOutput* out);
+
+  void set_options(const ScannerOptions& options) { options_ = options; }
+  const ScannerOptions& options() const { return options_; }
+
+  bool holding() const { return !held_.empty(); }
+  // Коли викликати Expire; має сенс лише при holding().
+  Clock::time_point deadline() const;
+
+ private:
+  bool IsRepeat(uint32_t code) const;
+  void Release(ScannerOutput* out);
+  void Accept(const ScannerKey* terminator, Clock::time_point end,
+              ScannerOutput* out);
+
+  ScannerOptions options_;
+
+  // Утримані події сплеску в порядку надходження.
+  std::vector<ScannerKey> held_;
+  std::string code_;
+  size_t code_chars_ = 0;
+  bool prefixed_ = false;
+  Clock::time_point first_key_;
+  Clock::time_point last_key_;
+  // Клавіші поглинутого коду, чиє відпускання ще не прийшло.
+  std::vector<uint32_t> swallowed_;
+};
+
+// Текстовий запис потоку клавіш для відтворення в тестах: рядок на подію,
+// «<мс від початку> <d|u> <код> <U+XXXX|-> [m]», '#' — коментар.
+std::string FormatScannerKey(const ScannerKey& key,
+                             ScannerKey::Clock::time_point origin);
+bool ParseScannerRecording(std::string_view text,
+                           ScannerKey::Clock::time_point origin,
+                           std::vector<ScannerKey>* keys, std::string* error);
+
+}  // namespace virok
+
+#endif  // NATIVE_SCANNER_SCANNER_KEY_FILTER_H_
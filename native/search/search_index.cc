@@ -0,0 +1,72 @@
+#include "search/search_index.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace virok {
+
+namespace {
+
+void Pack(const std::vector<std::string>& strings, size_t count,
+          std::string* blob, std::vector<uint32_t>* offsets) {
+  size_t total = 0;
+  for (size_t i = 0; i < count; i++) total += strings[i].size();
+  blob->reserve(total);
+  offsets->reserve(count + 1);
+  offsets->push_back(0);
+  for (size_t i = 0; i < count; i++) {
+    blob->append(strings[i]);
+    offsets->push_back(static_cast<uint32_t>(blob->size()));
+  }
+}
+
+}  // namespace
+
+SearchIndex::SearchIndex(const std::vector<std::string>& ids,
+                         const std::vector<std::string>& keys) {
+  const size_t count = std::min(ids.size(), keys.size());
+  Pack(ids, count, &id_blob_, &id_offsets_);
+  Pack(keys, count, &key_blob_, &key_offsets_);
+
+  view_.count = static_cast<uint32_t>(count);
+  view_.ids = id_blob_.data();
+  view_.id_offsets = id_offsets_.data();
+  view_.keys = key_blob_.data();
+  view_.key_offsets = key_offsets_.data();
+}
+
+SearchIndex::SearchIndex(const SearchIndexView& view,
+                         std::shared_ptr<const void> owner)
+    : view_(view), owner_(std::move(owner)) {}
+
+SearchIndex::Finder::Finder(const SearchIndex& index, std::string needle)
+    : index_(index),
+      needle_(std::move(needle)),
+      searcher_(needle_.data(), needle_.data() + needle_.size()) {}
+
+uint32_t SearchIndex::Finder::Next(uint32_t row) const {
+  const uint32_t count = index_.size();
+  if (row >= count) return count;
+  if (needle_.empty()) return row;
+
+  const uint32_t* const offsets = index_.view_.key_offsets;
+  const char* const begin = index_.view_.keys;
+  const char* const end = begin + offsets[count];
+  const char* pos = begin + offsets[row];
+  while (pos < end) {
+    const char* const hit = std::search(pos, end, searcher_);
+    if (hit == end) return count;
+    const uint32_t at = static_cast<uint32_t>(hit - begin);
+    // Рядок, у межах якого почався збіг.
+    const uint32_t hit_row = static_cast<uint32_t>(
+        std::upper_bound(offsets + row, offsets + count + 1, at) - offsets -
+        1);
+    // Збіг, що перетинає межу двох ключів, не рахується.
+    if (at + needle_.size() <= offsets[hit_row + 1]) return hit_row;
+    row = hit_row + 1;
+    pos = begin + offsets[row];
+  }
+  return count;
+}
+
+}  // namespace virok
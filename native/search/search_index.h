@@ -0,0 +1,92 @@
+#ifndef NATIVE_SEARCH_SEARCH_INDEX_H_
+#define NATIVE_SEARCH_SEARCH_INDEX_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace virok {
+
+// Буфери індексу, що належать комусь іншому (генерація спільного
+// каталогу, див. catalogue/shared_catalogue.h). Рядок |row| — це
+// [offsets[row], offsets[row + 1]) у відповідному буфері.
+struct SearchIndexView {
+  uint32_t count = 0;
+  const char* ids = nullptr;
+  const uint32_t* id_offsets = nullptr;
+  const char* keys = nullptr;
+  const uint32_t* key_offsets = nullptr;
+};
+
+// Незмінний індекс ключів пошуку по каталогу.
+//
+// Рядки зберігаються в порядку відображення (як ORDER BY name у SQLite),
+// тому номер рядка одночасно є його рангом у видачі. Ключ — це вже
+// нормалізований search_name (article + barcodes + name у нижньому регістрі).
+class SearchIndex {
+ public:
+  // |ids| і |keys| мають однакову довжину; зайві елементи ігноруються.
+  SearchIndex(const std::vector<std::string>& ids,
+              const std::vector<std::string>& keys);
+  // Індекс поверх чужих буферів без копіювання; |owner| тримає їх живими
+  // стільки, скільки живе індекс.
+  SearchIndex(const SearchIndexView& view, std::shared_ptr<const void> owner);
+
+  SearchIndex(const SearchIndex&) = delete;
+  SearchIndex& operator=(const SearchIndex&) = delete;
+
+  uint32_t size() const { return view_.count; }
+
+  std::string_view id(uint32_t row) const {
+    const uint32_t* const offsets = view_.id_offsets;
+    return std::string_view(view_.ids + offsets[row],
+                            offsets[row + 1] - offsets[row]);
+  }
+
+  std::string_view key(uint32_t row) const {
+    const uint32_t* const offsets = view_.key_offsets;
+    return std::string_view(view_.keys + offsets[row],
+                            offsets[row + 1] - offsets[row]);
+  }
+
+  // Чи містить ключ рядка |row| підрядок |needle| (семантика LIKE '%q%').
+  bool Contains(uint32_t row, std::string_view needle) const {
+    return key(row).find(needle) != std::string_view::npos;
+  }
+
+  // Пошук підрядка одразу по всьому буферу ключів (Boyer-Moore-Horspool):
+  // для рідкісних запитів значно швидше, ніж перевіряти рядки по одному.
+  class Finder {
+   public:
+    Finder(const SearchIndex& index, std::string needle);
+
+    Finder(const Finder&) = delete;
+    Finder& operator=(const Finder&) = delete;
+
+    // Перший рядок >= |row|, ключ якого містить підрядок, або size().
+    uint32_t Next(uint32_t row) const;
+
+   private:
+    const SearchIndex& index_;
+    const std::string needle_;
+    const std::boyer_moore_horspool_searcher<const char*> searcher_;
+  };
+
+ private:
+  SearchIndexView view_;
+  std::shared_ptr<const void> owner_;
+  // Власні буфери, якщо індекс збудовано з векторів. Усі ключі в одному
+  // суцільному буфері: послідовний прохід по кешу замість стрибків по
+  // окремих std::string.
+  std::string id_blob_;
+  std::vector<uint32_t> id_offsets_;
+  std::string key_blob_;
+  std::vector<uint32_t> key_offsets_;
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_SEARCH_SEARCH_INDEX_H_
@@ -0,0 +1,137 @@
+#include "search/search_service.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+namespace virok {
+
+namespace {
+
+int64_t MicrosSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+}  // namespace
+
+size_t SearchService::LoadIndex(const std::vector<std::string>& ids,
+                                const std::vector<std::string>& keys,
+                                const std::vector<std::string>& groups) {
+  const size_t count = std::min(ids.size(), keys.size());
+  if (count < kShardedMinItems) {
+    return LoadIndex(std::make_shared<const SearchIndex>(ids, keys));
+  }
+  size_t id_bytes = 0, key_bytes = 0;
+  for (size_t i = 0; i < count; i++) {
+    id_bytes += ids[i].size();
+    key_bytes += keys[i].size();
+  }
+  // Товари однієї категорії — в одному шарді (ShardPartition::kCategory).
+  ShardedIndexOptions options;
+  if (!groups.empty()) options.partition = ShardPartition::kCategory;
+  ShardedIndex::Builder builder(options);
+  builder.Reserve(count, id_bytes, key_bytes);
+  for (size_t i = 0; i < count; i++) {
+    builder.Add(ids[i], keys[i],
+                i < groups.size() ? std::string_view(groups[i])
+                                  : std::string_view());
+  }
+  sharded_ = builder.Finish();
+  index_.reset();
+  for (auto& entry : sessions_) entry.second->Reset(nullptr);
+  for (auto& entry : cursors_) entry.second = ShardedIndex::Cursor();
+  return sharded_->size();
+}
+
+size_t SearchService::LoadIndex(std::shared_ptr<const SearchIndex> index) {
+  sharded_.reset();
+  cursors_.clear();
+  index_ = std::move(index);
+  for (auto& entry : sessions_) entry.second->Reset(index_);
+  return index_->size();
+}
+
+size_t SearchService::LoadIndexForNewSessions(
+    std::shared_ptr<const SearchIndex> index) {
+  // Сесії над шардованим індексом без нього не працюють — їх переводимо.
+  if (sharded_) return LoadIndex(std::move(index));
+  index_ = std::move(index);
+  return index_->size();
+}
+
+int64_t SearchService::OpenSession() {
+  const int64_t id = next_session_++;
+  sessions_[id] = std::make_unique<SearchSession>(index_);
+  return id;
+}
+
+void SearchService::CloseSession(int64_t session) {
+  sessions_.erase(session);
+  cursors_.erase(session);
+}
+
+bool SearchService::Query(int64_t session, std::string_view query,
+                          size_t limit, SearchResult* result) {
+  SearchSession* s = Find(session);
+  if (!s) return false;
+  const auto start = std::chrono::steady_clock::now();
+  if (sharded_) {
+    // Дописаний запит звужує збіги курсора, як SearchSession — свій стек.
+    ShardedIndex::Cursor& cursor = cursors_[session];
+    sharded_->Requery(&cursor, query);
+    FillSharded(&cursor, limit, result);
+  } else {
+    Fill(*s, s->Update(query, limit), result);
+  }
+  result->elapsed_us = MicrosSince(start);
+  return true;
+}
+
+bool SearchService::More(int64_t session, size_t limit, SearchResult* result) {
+  SearchSession* s = Find(session);
+  if (!s) return false;
+  const auto start = std::chrono::steady_clock::now();
+  if (sharded_) {
+    FillSharded(&cursors_[session], limit, result);
+  } else {
+    Fill(*s, s->More(limit), result);
+  }
+  result->elapsed_us = MicrosSince(start);
+  return true;
+}
+
+SearchSession* SearchService::Find(int64_t session) {
+  auto it = sessions_.find(session);
+  return it == sessions_.end() ? nullptr : it->second.get();
+}
+
+void SearchService::Fill(const SearchSession& session, const SearchPage& page,
+                         SearchResult* result) const {
+  // Номери рядків — в індексі сесії, який може бути старішим за index_.
+  const SearchIndex* index = session.index().get();
+  result->ids.clear();
+  result->ids.reserve(page.rows.size());
+  for (uint32_t row : page.rows) result->ids.emplace_back(index->id(row));
+  result->exhausted = page.exhausted;
+  result->total = page.total;
+}
+
+void SearchService::FillSharded(ShardedIndex::Cursor* cursor, size_t limit,
+                                SearchResult* result) const {
+  result->ids.clear();
+  if (cursor->query().empty()) {
+    result->exhausted = true;
+    result->total = 0;
+    return;
+  }
+  const std::vector<ShardedHit> hits = sharded_->Next(cursor, limit);
+  result->ids.reserve(hits.size());
+  for (const ShardedHit& hit : hits) result->ids.emplace_back(hit.id);
+  result->exhausted = cursor->exhausted();
+  result->total =
+      result->exhausted ? static_cast<int64_t>(cursor->delivered()) : -1;
+}
+
+}  // namespace virok
@@ -0,0 +1,83 @@
+#ifndef NATIVE_SEARCH_SEARCH_SERVICE_H_
+#define NATIVE_SEARCH_SEARCH_SERVICE_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "search/search_index.h"
+#include "search/search_session.h"
+#include "search/sharded_index.h"
+
+namespace virok {
+
+// Відповідь каналу com.virok/search на query/more.
+struct SearchResult {
+  std::vector<std::string> ids;
+  bool exhausted = true;
+  int64_t total = -1;
+  // Час роботи нативної частини, для моніторингу затримки на Dart-стороні.
+  int64_t elapsed_us = 0;
+};
+
+// Реєстр сесій пошуку, спільний для Windows і Linux раннерів: раннер лише
+// перетворює аргументи каналу і викликає ці методи з платформного потоку.
+class SearchService {
+ public:
+  SearchService() = default;
+
+  SearchService(const SearchService&) = delete;
+  SearchService& operator=(const SearchService&) = delete;
+
+  // Каталоги від цього розміру (оптові склади) шардуються: запит іде на
+  // всі ядра (див. ShardedIndex), а не інкрементальною сесією по одному
+  // індексу.
+  static constexpr size_t kShardedMinItems = 500000;
+
+  // Замінює індекс; відкриті сесії переходять на нього з порожнім кешем.
+  // |groups| — категорія кожного товару (parent_guid) для розкладання
+  // шардованого каталогу; порожній — шарди за хешем id.
+  size_t LoadIndex(const std::vector<std::string>& ids,
+                   const std::vector<std::string>& keys,
+                   const std::vector<std::string>& groups = {});
+  // Те саме для готового індексу (наприклад, поверх спільного каталогу).
+  size_t LoadIndex(std::shared_ptr<const SearchIndex> index);
+  // Як LoadIndex, але відкриті сесії лишаються на своєму індексі до
+  // закриття: на новий переходять лише сесії, відкриті після виклику.
+  size_t LoadIndexForNewSessions(std::shared_ptr<const SearchIndex> index);
+
+  int64_t OpenSession();
+  void CloseSession(int64_t session);
+
+  // false, якщо сесію не знайдено.
+  bool Query(int64_t session, std::string_view query, size_t limit,
+             SearchResult* result);
+  bool More(int64_t session, size_t limit, SearchResult* result);
+
+  size_t index_size() const {
+    if (sharded_) return sharded_->size();
+    return index_ ? index_->size() : 0;
+  }
+  bool sharded() const { return sharded_ != nullptr; }
+
+ private:
+  SearchSession* Find(int64_t session);
+  void Fill(const SearchSession& session, const SearchPage& page,
+            SearchResult* result) const;
+  void FillSharded(ShardedIndex::Cursor* cursor, size_t limit,
+                   SearchResult* result) const;
+
+  std::shared_ptr<const SearchIndex> index_;
+  std::unique_ptr<const ShardedIndex> sharded_;
+  std::map<int64_t, std::unique_ptr<SearchSession>> sessions_;
+  // Курсори сесій над шардованим індексом.
+  std::map<int64_t, ShardedIndex::Cursor> cursors_;
+  int64_t next_session_ = 1;
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_SEARCH_SEARCH_SERVICE_H_
@@ -0,0 +1,115 @@
+#include "search/search_session.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace virok {
+
+SearchSession::SearchSession(std::shared_ptr<const SearchIndex> index)
+    : index_(std::move(index)) {}
+
+void SearchSession::Reset(std::shared_ptr<const SearchIndex> index) {
+  index_ = std::move(index);
+  levels_.clear();
+  delivered_ = 0;
+}
+
+SearchPage SearchSession::Update(std::string_view query, size_t limit) {
+  // Залишаємо лише рівні, чий запит є префіксом нового: їхні збіги —
+  // надмножина збігів нового запиту. Backspace просто знімає рівні зі стеку.
+  while (!levels_.empty()) {
+    const std::string& cached = levels_.back().query;
+    if (query.size() >= cached.size() &&
+        query.compare(0, cached.size(), cached) == 0) {
+      break;
+    }
+    levels_.pop_back();
+  }
+  delivered_ = 0;
+
+  if (query.empty()) {
+    SearchPage page;
+    page.exhausted = true;
+    page.total = 0;
+    return page;
+  }
+
+  if (levels_.empty() || levels_.back().query != query) {
+    Level level;
+    level.query.assign(query.data(), query.size());
+    levels_.push_back(std::move(level));
+  }
+  return TakePage(limit);
+}
+
+SearchPage SearchSession::More(size_t limit) {
+  if (levels_.empty()) {
+    SearchPage page;
+    page.exhausted = true;
+    page.total = 0;
+    return page;
+  }
+  return TakePage(limit);
+}
+
+SearchPage SearchSession::TakePage(size_t limit) {
+  const size_t top = levels_.size() - 1;
+  // +1, щоб без додаткового проходу знати, чи є ще сторінка.
+  Pull(top, delivered_ + limit + 1);
+
+  const Level& level = levels_[top];
+  const size_t begin = std::min(delivered_, level.matches.size());
+  const size_t end = std::min(level.matches.size(), delivered_ + limit);
+
+  SearchPage page;
+  page.rows.assign(level.matches.begin() + begin, level.matches.begin() + end);
+  delivered_ = end;
+  page.exhausted = level.matches.size() <= end;
+  if (level.complete) page.total = static_cast<int64_t>(level.matches.size());
+  return page;
+}
+
+void SearchSession::Pull(size_t li, size_t need) {
+  Level& level = levels_[li];
+  const size_t count = index_ ? index_->size() : 0;
+
+  while (level.matches.size() < need && level.scanned < count) {
+    const Level* parent = li > 0 ? &levels_[li - 1] : nullptr;
+
+    if (parent && parent->scanned > level.scanned) {
+      // Батьківський рівень уже вирішив рядки [scanned, parent->scanned):
+      // кандидати — лише його збіги з цього діапазону.
+      auto it = std::lower_bound(parent->matches.begin(),
+                                 parent->matches.end(),
+                                 static_cast<uint32_t>(level.scanned));
+      for (; it != parent->matches.end() && level.matches.size() < need;
+           ++it) {
+        if (index_->Contains(*it, level.query)) level.matches.push_back(*it);
+        level.scanned = static_cast<size_t>(*it) + 1;
+      }
+      if (it == parent->matches.end()) {
+        level.scanned = std::max(level.scanned, parent->scanned);
+      }
+      continue;
+    }
+
+    // Далі рядки ще ніхто не перевіряв — шукаємо по індексу напряму.
+    if (!level.finder) {
+      level.finder =
+          std::make_unique<SearchIndex::Finder>(*index_, level.query);
+    }
+    while (level.matches.size() < need && level.scanned < count) {
+      const uint32_t row =
+          level.finder->Next(static_cast<uint32_t>(level.scanned));
+      if (row < count) level.matches.push_back(row);
+      level.scanned = static_cast<size_t>(row) + 1;
+    }
+  }
+
+  if (level.scanned >= count) {
+    level.scanned = count;
+    level.complete = true;
+  }
+}
+
+}  // namespace virok
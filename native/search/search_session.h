@@ -0,0 +1,82 @@
+#ifndef NATIVE_SEARCH_SEARCH_SESSION_H_
+#define NATIVE_SEARCH_SEARCH_SESSION_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "search/search_index.h"
+
+namespace virok {
+
+// Сторінка результатів пошуку: номери рядків індексу в порядку рангу.
+struct SearchPage {
+  std::vector<uint32_t> rows;
+  // true, якщо після цієї сторінки результатів більше немає.
+  bool exhausted = false;
+  // Загальна кількість збігів; -1, поки набір ще не дораховано.
+  int64_t total = -1;
+};
+
+// Інкрементальна сесія пошуку "по мірі введення".
+//
+// Кожне натискання клавіші звужує попередній набір кандидатів замість
+// повного проходу по каталогу: якщо ключ містить "молок", то він містить і
+// "моло". Набори для кожного префікса запиту кешуються у стеку, тож
+// Backspace повертає вже пораховану множину миттєво.
+//
+// Рівні рахуються ліниво, у просторі номерів рядків: для першої сторінки
+// перевіряється рівно стільки рядків, скільки потрібно. Там, де батьківський
+// рівень уже порахований, фільтруються його збіги; далі рівень шукає по
+// індексу напряму своїм (довшим, отже швидшим) підрядком, не змушуючи
+// батьківський рівень матеріалізуватись повністю. Сесія не потокобезпечна —
+// викликається з платформного потоку раннера.
+class SearchSession {
+ public:
+  explicit SearchSession(std::shared_ptr<const SearchIndex> index);
+
+  SearchSession(const SearchSession&) = delete;
+  SearchSession& operator=(const SearchSession&) = delete;
+
+  // Встановлює новий запит і повертає першу сторінку до |limit| рядків.
+  SearchPage Update(std::string_view query, size_t limit);
+
+  // Наступна сторінка для поточного запиту.
+  SearchPage More(size_t limit);
+
+  // Переприв'язує сесію до нового індексу (після синхронізації каталогу).
+  void Reset(std::shared_ptr<const SearchIndex> index);
+
+  const std::shared_ptr<const SearchIndex>& index() const { return index_; }
+
+  // Кількість закешованих рівнів (для діагностики та бенчмарків).
+  size_t depth() const { return levels_.size(); }
+
+ private:
+  struct Level {
+    std::string query;
+    std::vector<uint32_t> matches;
+    // Усі рядки індексу < scanned уже перевірені для цього рівня.
+    size_t scanned = 0;
+    bool complete = false;
+    // Створюється при першому прямому проході по індексу.
+    std::unique_ptr<SearchIndex::Finder> finder;
+  };
+
+  // Дораховує рівень |level| до |need| збігів або до вичерпання джерела.
+  void Pull(size_t level, size_t need);
+
+  SearchPage TakePage(size_t limit);
+
+  std::shared_ptr<const SearchIndex> index_;
+  std::vector<Level> levels_;
+  // Скільки рядків поточного (верхнього) рівня вже віддано у Dart.
+  size_t delivered_ = 0;
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_SEARCH_SEARCH_SESSION_H_
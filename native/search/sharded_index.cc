@@ -0,0 +1,366 @@
+#include "search/sharded_index.h"
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+namespace virok {
+
+namespace {
+
+// Більше шардів, ніж уміщує номер шарду рядка (uint16_t), не буває.
+constexpr int kMaxShards = 1024;
+
+// FNV-1a: розкладання однакове між запусками і платформами (std::hash —
+// ні), тож той самий товар після перебудови лишається в тому ж шарді.
+uint64_t HashId(std::string_view id) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (char c : id) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+int DefaultThreads(int threads) {
+  if (threads > 0) return threads;
+  const unsigned cores = std::thread::hardware_concurrency();
+  return cores ? static_cast<int>(cores) : 1;
+}
+
+// Буфери одного шарду; SearchIndex тримає їх як власника.
+struct ShardBuffers {
+  std::string ids;
+  std::vector<uint32_t> id_offsets{0};
+  std::string keys;
+  std::vector<uint32_t> key_offsets{0};
+};
+
+}  // namespace
+
+ShardedIndex::Builder::Builder(const ShardedIndexOptions& options)
+    : options_(options) {}
+
+void ShardedIndex::Builder::Reserve(size_t items, size_t id_bytes,
+                                    size_t key_bytes) {
+  ids_.reserve(id_bytes);
+  id_offsets_.reserve(items + 1);
+  keys_.reserve(key_bytes);
+  key_offsets_.reserve(items + 1);
+  if (options_.partition == ShardPartition::kCategory) {
+    groups_.reserve(items);
+  }
+}
+
+void ShardedIndex::Builder::Add(std::string_view id, std::string_view key,
+                                std::string_view group) {
+  ids_.append(id);
+  id_offsets_.push_back(ids_.size());
+  keys_.append(key);
+  key_offsets_.push_back(keys_.size());
+  if (options_.partition != ShardPartition::kCategory) return;
+
+  uint32_t number = 0;
+  if (!group.empty()) {
+    std::string name(group);
+    auto it = group_index_.find(name);
+    if (it == group_index_.end()) {
+      it = group_index_
+               .emplace(std::move(name),
+                        static_cast<uint32_t>(group_sizes_.size()))
+               .first;
+      group_sizes_.push_back(0);
+    }
+    group_sizes_[it->second]++;
+    number = it->second + 1;
+  }
+  groups_.push_back(number);
+}
+
+std::unique_ptr<ShardedIndex> ShardedIndex::Builder::Finish() {
+  const int threads = DefaultThreads(options_.threads);
+  const int shards = std::min(
+      kMaxShards, options_.shards > 0 ? options_.shards : threads);
+  const size_t count = size();
+
+  std::unique_ptr<ShardedIndex> index(new ShardedIndex());
+  index->size_ = static_cast<uint32_t>(count);
+  for (int i = 1; i < threads; i++) {
+    index->workers_.emplace_back(&ShardedIndex::WorkerLoop, index.get());
+  }
+
+  // Категорії — від найбільших на найменш завантажений шард.
+  std::vector<uint16_t> group_shard(group_sizes_.size());
+  if (!group_sizes_.empty()) {
+    std::vector<uint32_t> order(group_sizes_.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [this](uint32_t a, uint32_t b) {
+                       return group_sizes_[a] > group_sizes_[b];
+                     });
+    std::vector<uint64_t> load(shards);
+    for (uint32_t group : order) {
+      const auto lightest = std::min_element(load.begin(), load.end());
+      group_shard[group] = static_cast<uint16_t>(lightest - load.begin());
+      *lightest += group_sizes_[group];
+    }
+  }
+
+  // Шард кожного рядка смугами на всіх потоках (хеш id — найдорожче в
+  // розкладанні).
+  std::vector<uint16_t> shard_of(count);
+  const int stripes = threads * 4;
+  index->ParallelFor(stripes, [&](int stripe) {
+    const size_t end = count * (stripe + 1) / stripes;
+    for (size_t i = count * stripe / stripes; i < end; i++) {
+      const uint32_t group = groups_.empty() ? 0 : groups_[i];
+      if (group) {
+        shard_of[i] = group_shard[group - 1];
+        continue;
+      }
+      const std::string_view id(ids_.data() + id_offsets_[i],
+                                id_offsets_[i + 1] - id_offsets_[i]);
+      shard_of[i] = static_cast<uint16_t>(HashId(id) % shards);
+    }
+  });
+
+  // Рядки, згруповані за шардом (підрахунок і розкладання за один
+  // прохід кожне): шард бачить лише свій діапазон, а не весь каталог.
+  std::vector<size_t> shard_begin(shards + 1);
+  for (size_t i = 0; i < count; i++) shard_begin[shard_of[i] + 1]++;
+  std::partial_sum(shard_begin.begin(), shard_begin.end(),
+                   shard_begin.begin());
+  std::vector<uint32_t> shard_rows(count);
+  {
+    std::vector<size_t> fill(shard_begin.begin(), shard_begin.end() - 1);
+    for (size_t i = 0; i < count; i++) {
+      shard_rows[fill[shard_of[i]]++] = static_cast<uint32_t>(i);
+    }
+  }
+  std::vector<uint16_t>().swap(shard_of);
+
+  // Кожен шард збирає свої рядки сам, у порядку рангу.
+  index->shards_.resize(shards);
+  std::vector<uint64_t> shard_bytes(shards);
+  index->ParallelFor(shards, [&](int s) {
+    const uint32_t* const first = shard_rows.data() + shard_begin[s];
+    const uint32_t* const last = shard_rows.data() + shard_begin[s + 1];
+    const size_t rows = last - first;
+    size_t id_bytes = 0, key_bytes = 0;
+    for (const uint32_t* row = first; row != last; row++) {
+      id_bytes += id_offsets_[*row + 1] - id_offsets_[*row];
+      key_bytes += key_offsets_[*row + 1] - key_offsets_[*row];
+    }
+    auto buffers = std::make_shared<ShardBuffers>();
+    Shard& shard = index->shards_[s];
+    buffers->ids.reserve(id_bytes);
+    buffers->id_offsets.reserve(rows + 1);
+    buffers->keys.reserve(key_bytes);
+    buffers->key_offsets.reserve(rows + 1);
+    shard.ranks.assign(first, last);
+    for (const uint32_t* row = first; row != last; row++) {
+      const size_t i = *row;
+      buffers->ids.append(ids_, id_offsets_[i],
+                          id_offsets_[i + 1] - id_offsets_[i]);
+      buffers->id_offsets.push_back(
+          static_cast<uint32_t>(buffers->ids.size()));
+      buffers->keys.append(keys_, key_offsets_[i],
+                           key_offsets_[i + 1] - key_offsets_[i]);
+      buffers->key_offsets.push_back(
+          static_cast<uint32_t>(buffers->keys.size()));
+    }
+    SearchIndexView view;
+    view.count = static_cast<uint32_t>(rows);
+    view.ids = buffers->ids.data();
+    view.id_offsets = buffers->id_offsets.data();
+    view.keys = buffers->keys.data();
+    view.key_offsets = buffers->key_offsets.data();
+    shard_bytes[s] = id_bytes + key_bytes + (rows + 1) * 8 + rows * 4;
+    shard.index = std::make_unique<SearchIndex>(view, std::move(buffers));
+  });
+  index->bytes_ =
+      std::accumulate(shard_bytes.begin(), shard_bytes.end(), uint64_t{0});
+
+  // Будівник віддає свої буфери: на мільйонах товарів це сотні МБ.
+  std::string().swap(ids_);
+  std::string().swap(keys_);
+  std::vector<uint64_t>{0}.swap(id_offsets_);
+  std::vector<uint64_t>{0}.swap(key_offsets_);
+  std::vector<uint32_t>().swap(groups_);
+  group_index_.clear();
+  group_sizes_.clear();
+  return index;
+}
+
+ShardedIndex::~ShardedIndex() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (std::thread& worker : workers_) worker.join();
+}
+
+std::vector<ShardedHit> ShardedIndex::Search(std::string_view needle,
+                                             size_t limit,
+                                             size_t* total) const {
+  std::vector<std::vector<ShardedHit>> found(shards_.size());
+  std::vector<size_t> counts(shards_.size());
+  const std::string query(needle);
+  ParallelFor(shards(), [&](int s) {
+    const Shard& shard = shards_[s];
+    const SearchIndex& index = *shard.index;
+    const SearchIndex::Finder finder(index, query);
+    std::vector<ShardedHit>& hits = found[s];
+    size_t matches = 0;
+    for (uint32_t row = finder.Next(0); row < index.size();
+         row = finder.Next(row + 1)) {
+      if (hits.size() < limit) {
+        hits.push_back({shard.ranks[row], index.id(row)});
+      } else if (!total) {
+        break;
+      }
+      matches++;
+    }
+    counts[s] = matches;
+  });
+
+  // Збіги кожного шарду вже в порядку рангу, і їх не більше |limit| на
+  // шард — злиття сортуванням дешевше за купу на таких розмірах.
+  std::vector<ShardedHit> merged;
+  for (const std::vector<ShardedHit>& hits : found) {
+    merged.insert(merged.end(), hits.begin(), hits.end());
+  }
+  std::sort(merged.begin(), merged.end(),
+            [](const ShardedHit& a, const ShardedHit& b) {
+              return a.rank < b.rank;
+            });
+  if (merged.size() > limit) merged.resize(limit);
+  if (total) *total = std::accumulate(counts.begin(), counts.end(), size_t{0});
+  return merged;
+}
+
+std::vector<ShardedHit> ShardedIndex::Next(Cursor* cursor,
+                                           size_t limit) const {
+  std::vector<ShardedHit> page;
+  if (cursor->shards_.size() != shards_.size()) {
+    cursor->shards_.assign(shards_.size(), Cursor::ShardState());
+  }
+  // Кожен шард дотягує буфер не виданих збігів до |limit| + 1, продовжуючи
+  // прохід з місця попередньої сторінки: за всі сторінки рядок шарду
+  // переглядається один раз. +1 — щоб знати, чи є ще сторінка.
+  ParallelFor(shards(), [&](int s) {
+    Cursor::ShardState& state = cursor->shards_[s];
+    const SearchIndex& index = *shards_[s].index;
+    if (state.next >= index.size() ||
+        state.matches.size() - state.head > limit) {
+      return;
+    }
+    const SearchIndex::Finder finder(index, cursor->query_);
+    uint32_t row = finder.Next(state.next);
+    for (; row < index.size(); row = finder.Next(row + 1)) {
+      state.matches.push_back(row);
+      if (state.matches.size() - state.head > limit) {
+        row++;
+        break;
+      }
+    }
+    state.next = row;
+  });
+
+  // Голови буферів уже в порядку рангу: сторінка — злиття по одному
+  // найменшому рангу серед шардів.
+  page.reserve(limit);
+  while (page.size() < limit) {
+    int best = -1;
+    uint32_t best_rank = 0;
+    for (int s = 0; s < shards(); s++) {
+      const Cursor::ShardState& state = cursor->shards_[s];
+      if (state.head == state.matches.size()) continue;
+      const uint32_t rank = shards_[s].ranks[state.matches[state.head]];
+      if (best < 0 || rank < best_rank) {
+        best = s;
+        best_rank = rank;
+      }
+    }
+    if (best < 0) break;
+    const uint32_t row = cursor->shards_[best].matches[
+        cursor->shards_[best].head++];
+    page.push_back({best_rank, shards_[best].index->id(row)});
+  }
+  cursor->delivered_ += page.size();
+  cursor->exhausted_ = true;
+  for (int s = 0; s < shards(); s++) {
+    const Cursor::ShardState& state = cursor->shards_[s];
+    if (state.head < state.matches.size() ||
+        state.next < shards_[s].index->size()) {
+      cursor->exhausted_ = false;
+      break;
+    }
+  }
+  return page;
+}
+
+void ShardedIndex::Requery(Cursor* cursor, std::string_view query) const {
+  const bool extends = !cursor->query_.empty() &&
+                       cursor->shards_.size() == shards_.size() &&
+                       query.size() >= cursor->query_.size() &&
+                       query.compare(0, cursor->query_.size(),
+                                     cursor->query_) == 0;
+  cursor->query_.assign(query.data(), query.size());
+  cursor->delivered_ = 0;
+  cursor->exhausted_ = false;
+  if (!extends) {
+    cursor->shards_.clear();
+    return;
+  }
+  // Ключ, що містить новий запит, містить і старий: поза збігами
+  // переглянутих рядків нових збігів немає.
+  ParallelFor(shards(), [&](int s) {
+    Cursor::ShardState& state = cursor->shards_[s];
+    const SearchIndex& index = *shards_[s].index;
+    state.matches.erase(
+        std::remove_if(state.matches.begin(), state.matches.end(),
+                       [&](uint32_t row) {
+                         return !index.Contains(row, cursor->query_);
+                       }),
+        state.matches.end());
+    state.head = 0;
+  });
+}
+
+void ShardedIndex::ParallelFor(int count,
+                               const std::function<void(int)>& task) const {
+  std::lock_guard<std::mutex> fan_out(fan_out_);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = &task;
+    count_ = count;
+    next_.store(0);
+    running_ = static_cast<int>(workers_.size());
+    generation_++;
+  }
+  wake_.notify_all();
+  for (int i = next_++; i < count; i = next_++) task(i);
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_.wait(lock, [this] { return running_ == 0; });
+  task_ = nullptr;
+}
+
+void ShardedIndex::WorkerLoop() {
+  uint64_t seen = 0;
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+    if (stop_) return;
+    seen = generation_;
+    const std::function<void(int)>* task = task_;
+    const int count = count_;
+    lock.unlock();
+    for (int i = next_++; i < count; i = next_++) (*task)(i);
+    lock.lock();
+    if (--running_ == 0) done_.notify_one();
+  }
+}
+
+}  // namespace virok
@@ -0,0 +1,184 @@
+#ifndef NATIVE_SEARCH_SHARDED_INDEX_H_
+#define NATIVE_SEARCH_SHARDED_INDEX_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "search/search_index.h"
+
+namespace virok {
+
+enum class ShardPartition {
+  // За хешем id: шарди однакового розміру.
+  kHash,
+  // За групою (коренем піддерева категорій): категорія цілком в одному
+  // шарді, великі категорії розкладаються першими на найменший шард.
+  kCategory,
+};
+
+struct ShardedIndexOptions {
+  // Шардів; 0 — за кількістю потоків.
+  int shards = 0;
+  // Потоків побудови і пошуку (разом із викликачем); 0 — за кількістю
+  // ядер.
+  int threads = 0;
+  ShardPartition partition = ShardPartition::kHash;
+};
+
+// Збіг пошуку: ранг — номер рядка в порядку відображення всього каталогу
+// (як ORDER BY name), тож злиття шардів дає ту саму видачу, що й один
+// SearchIndex.
+struct ShardedHit {
+  uint32_t rank = 0;
+  std::string_view id;
+};
+
+// Каталог оптових складів (мільйони товарів), розбитий на шарди —
+// окремі SearchIndex, що будуються і переглядаються паралельно.
+//
+// Один SearchIndex на 1M+ товарів — сотні мегабайтів ключів, які запит
+// без збігів проходить одним потоком, а перебудова пакує їх теж одним.
+// Тут кожен запит розсилається всім шардам (потоки пулу разом із
+// викликачем), кожен шард віддає свої перші |limit| збігів у порядку
+// рангу, а викликач зливає їх у загальні перші |limit|.
+//
+// Незмінний після Finish. Search потокобезпечний; одночасні запити
+// розсилаються по черзі (пул один на індекс).
+class ShardedIndex {
+ public:
+  // Рядки додаються в порядку відображення: номер Add — ранг. Додавання
+  // лише копіює в суцільні буфери; розкладання по шардах і пакування
+  // робить Finish на всіх потоках.
+  class Builder {
+   public:
+    explicit Builder(const ShardedIndexOptions& options = {});
+
+    // Необов'язкова підказка розміру: без неї буфери на мільйонах рядків
+    // кілька разів переносяться при зростанні.
+    void Reserve(size_t items, size_t id_bytes, size_t key_bytes);
+
+    // |group| — категорія для ShardPartition::kCategory (порожня — за
+    // хешем id).
+    void Add(std::string_view id, std::string_view key,
+             std::string_view group = {});
+    size_t size() const { return key_offsets_.size() - 1; }
+
+    std::unique_ptr<ShardedIndex> Finish();
+
+   private:
+    ShardedIndexOptions options_;
+    std::string ids_;
+    std::vector<uint64_t> id_offsets_{0};
+    std::string keys_;
+    std::vector<uint64_t> key_offsets_{0};
+    std::vector<uint32_t> groups_;  // номер групи + 1; 0 — без групи
+    std::unordered_map<std::string, uint32_t> group_index_;
+    std::vector<uint32_t> group_sizes_;
+  };
+
+  // Посторінкова видача одного запиту: кожен шард продовжує прохід з
+  // рядка, де зупинився на попередній сторінці, а ще не видані збіги
+  // чекають у його буфері. Знайдені збіги шард тримає і після видачі —
+  // з них Requery звужує видачу, коли запит дописують. Прив'язаний до
+  // індексу, яким його проходили; id у збігах живуть, доки живе індекс.
+  class Cursor {
+   public:
+    Cursor() = default;
+    explicit Cursor(std::string query) : query_(std::move(query)) {}
+
+    const std::string& query() const { return query_; }
+    // Скільки збігів видано всіма сторінками.
+    size_t delivered() const { return delivered_; }
+    // Після останньої сторінки: збігів більше немає.
+    bool exhausted() const { return exhausted_; }
+
+   private:
+    friend class ShardedIndex;
+
+    struct ShardState {
+      uint32_t next = 0;  // перший ще не переглянутий рядок шарду
+      size_t head = 0;    // перший не виданий збіг у matches
+      std::vector<uint32_t> matches;  // рядки шарду зі збігом у [0, next)
+    };
+
+    std::string query_;
+    std::vector<ShardState> shards_;
+    size_t delivered_ = 0;
+    bool exhausted_ = false;
+  };
+
+  ~ShardedIndex();
+
+  ShardedIndex(const ShardedIndex&) = delete;
+  ShardedIndex& operator=(const ShardedIndex&) = delete;
+
+  uint32_t size() const { return size_; }
+  int shards() const { return static_cast<int>(shards_.size()); }
+  int threads() const { return static_cast<int>(workers_.size()) + 1; }
+  uint32_t shard_size(int shard) const {
+    return shards_[shard].index->size();
+  }
+  // Пам'ять ключів, id і таблиць рангу всіх шардів.
+  uint64_t bytes() const { return bytes_; }
+
+  // Перші |limit| рядків, ключ яких містить |needle| (семантика
+  // LIKE '%q%'), у порядку рангу. |total| — якщо не null, загальна
+  // кількість збігів (тоді шарди проходять до кінця, а не до |limit|).
+  // id у збігах живуть, доки живе індекс.
+  std::vector<ShardedHit> Search(std::string_view needle, size_t limit,
+                                 size_t* total = nullptr) const;
+
+  // Наступні |limit| збігів запиту курсора в порядку рангу. Сторінки
+  // разом переглядають кожен рядок один раз, а не заново від початку.
+  std::vector<ShardedHit> Next(Cursor* cursor, size_t limit) const;
+
+  // Переводить курсор на новий запит з першої сторінки. Якщо |query|
+  // дописує запит курсора (набір "по мірі введення"), збіги вже
+  // переглянутих рядків лише фільтруються новим запитом, а прохід шардів
+  // продовжується з місця, де зупинився; інакше курсор починає заново.
+  void Requery(Cursor* cursor, std::string_view query) const;
+
+ private:
+  struct Shard {
+    std::unique_ptr<SearchIndex> index;
+    std::vector<uint32_t> ranks;  // ранг кожного рядка шарду, зростає
+  };
+
+  ShardedIndex() = default;
+
+  // Виконує |task|(0..count-1) на потоках пулу і викликача;
+  // повертається, коли всі завершились.
+  void ParallelFor(int count, const std::function<void(int)>& task) const;
+  void WorkerLoop();
+
+  uint32_t size_ = 0;
+  uint64_t bytes_ = 0;
+  std::vector<Shard> shards_;
+
+  std::vector<std::thread> workers_;
+  mutable std::mutex fan_out_;  // один розподіл за раз
+  mutable std::mutex mutex_;
+  mutable std::condition_variable wake_;
+  mutable std::condition_variable done_;
+  mutable const std::function<void(int)>* task_ = nullptr;
+  mutable uint64_t generation_ = 0;
+  mutable int count_ = 0;
+  mutable std::atomic<int> next_{0};
+  mutable int running_ = 0;
+  bool stop_ = false;
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_SEARCH_SHARDED_INDEX_H_
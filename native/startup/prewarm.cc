@@ -0,0 +1,68 @@
+#include "startup/prewarm.h"
+
+#include "startup/startup_timeline.h"
+#include "trace/trace.h"
+
+namespace virok {
+
+const char* PrewarmStateName(PrewarmState state) {
+  switch (state) {
+    case PrewarmState::kPending:
+      return "pending";
+    case PrewarmState::kRunning:
+      return "running";
+    case PrewarmState::kReady:
+      return "ready";
+    case PrewarmState::kFailed:
+      return "failed";
+  }
+  return "unknown";
+}
+
+PrewarmPool::~PrewarmPool() {
+  for (auto& thread : threads_) thread.join();
+}
+
+void PrewarmPool::Run(std::string name, PrewarmTask task) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const size_t index = results_.size();
+  results_.emplace_back().name = std::move(name);
+  running_++;
+  threads_.emplace_back(
+      [this, index, task = std::move(task)] { Execute(index, task); });
+}
+
+void PrewarmPool::Execute(size_t index, const PrewarmTask& task) {
+  PrewarmResult result;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    results_[index].state = PrewarmState::kRunning;
+    results_[index].start_ns = Tracer::NowNs();
+    result = results_[index];
+  }
+
+  bool ok = false;
+  {
+    TraceScope trace_scope("startup", std::string_view(result.name));
+    ok = task(&result);
+  }
+  result.state = ok ? PrewarmState::kReady : PrewarmState::kFailed;
+  result.end_ns = StartupTimeline::Get().Mark("prewarm:" + result.name);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  results_[index] = std::move(result);
+  running_--;
+  done_.notify_all();
+}
+
+std::vector<PrewarmResult> PrewarmPool::Snapshot() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return results_;
+}
+
+bool PrewarmPool::Wait(std::chrono::milliseconds timeout) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return done_.wait_for(lock, timeout, [this] { return running_ == 0; });
+}
+
+}  // namespace virok
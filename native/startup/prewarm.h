@@ -0,0 +1,69 @@
+#ifndef NATIVE_STARTUP_PREWARM_H_
+#define NATIVE_STARTUP_PREWARM_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace virok {
+
+enum class PrewarmState { kPending, kRunning, kReady, kFailed };
+
+const char* PrewarmStateName(PrewarmState state);
+
+// Результат однієї задачі прогріву — "дескриптор", який забирає Dart.
+struct PrewarmResult {
+  std::string name;
+  PrewarmState state = PrewarmState::kPending;
+  int64_t start_ns = 0;  // Tracer::NowNs
+  int64_t end_ns = 0;
+  // Те, що задача підготувала: шлях до бази, прочитані налаштування тощо.
+  std::map<std::string, std::string> values;
+  std::string error;
+};
+
+// Заповнює values/error; false — задача не вдалася.
+using PrewarmTask = std::function<bool(PrewarmResult*)>;
+
+// Паралельний прогрів під час запуску, поки Flutter ще піднімає двигун.
+//
+// Кожна задача отримує власний потік (їх одиниці, і кожна здебільшого
+// чекає диска або завантаження DLL), завершення позначається в
+// StartupTimeline як "prewarm:<name>". Результати читаються без
+// очікування через Snapshot() — потік платформи ніколи не блокується.
+class PrewarmPool {
+ public:
+  PrewarmPool() = default;
+  // Чекає завершення всіх задач.
+  ~PrewarmPool();
+
+  PrewarmPool(const PrewarmPool&) = delete;
+  PrewarmPool& operator=(const PrewarmPool&) = delete;
+
+  // Запускає |task| одразу в окремому потоці.
+  void Run(std::string name, PrewarmTask task);
+
+  std::vector<PrewarmResult> Snapshot() const;
+
+  // Чекає до |timeout|; true, якщо всі задачі завершилися.
+  bool Wait(std::chrono::milliseconds timeout);
+
+ private:
+  void Execute(size_t index, const PrewarmTask& task);
+
+  mutable std::mutex mutex_;
+  std::condition_variable done_;
+  std::vector<PrewarmResult> results_;
+  std::vector<std::thread> threads_;
+  size_t running_ = 0;
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_STARTUP_PREWARM_H_
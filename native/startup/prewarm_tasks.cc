@@ -0,0 +1,118 @@
+#include "startup/prewarm_tasks.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+#include "json/json_reader.h"
+
+namespace virok {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr size_t kPageInChunk = 1 << 20;
+
+// Кількість прочитаних байтів або -1, якщо файл не відкрився.
+int64_t ReadThrough(const fs::path& path, std::vector<char>* buffer) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) return -1;
+  const auto chunk = static_cast<std::streamsize>(buffer->size());
+  int64_t total = 0;
+  while (in.read(buffer->data(), chunk) || in.gcount() > 0) {
+    total += in.gcount();
+  }
+  return total;
+}
+
+}  // namespace
+
+bool PageInFile(const std::string& path, PrewarmResult* result) {
+  result->values["path"] = path;
+  const fs::path file = fs::u8path(path);
+  std::error_code ec;
+  if (!fs::exists(file, ec)) {
+    result->values["exists"] = "false";
+    result->values["bytes"] = "0";
+    return true;
+  }
+
+  std::vector<char> buffer(kPageInChunk);
+  const int64_t bytes = ReadThrough(file, &buffer);
+  if (bytes < 0) {
+    result->error = "cannot open " + path;
+    return false;
+  }
+  fs::path wal = file;
+  wal += "-wal";
+  int64_t wal_bytes = 0;
+  if (fs::exists(wal, ec)) {
+    wal_bytes = std::max<int64_t>(ReadThrough(wal, &buffer), 0);
+  }
+
+  result->values["exists"] = "true";
+  result->values["bytes"] = std::to_string(bytes + wal_bytes);
+  return true;
+}
+
+bool ReadPreferences(const std::string& path,
+                     const std::vector<std::string>& keys,
+                     PrewarmResult* result) {
+  std::ifstream in(fs::u8path(path), std::ios::binary);
+  if (!in) {
+    // Налаштувань ще немає — Dart візьме значення за замовчуванням.
+    return true;
+  }
+  const std::string json((std::istreambuf_iterator<char>(in)),
+                         std::istreambuf_iterator<char>());
+
+  JsonReader reader(json);
+  if (reader.Next() != JsonReader::Token::kBeginObject) {
+    result->error = "shared_preferences.json is not an object";
+    return false;
+  }
+  for (;;) {
+    const JsonReader::Token token = reader.Next();
+    if (token == JsonReader::Token::kEndObject) return true;
+    if (token != JsonReader::Token::kKey) break;
+
+    std::string key(reader.text());
+    constexpr std::string_view kPrefix = "flutter.";
+    bool wanted = false;
+    if (key.compare(0, kPrefix.size(), kPrefix) == 0) {
+      key.erase(0, kPrefix.size());
+      for (const auto& k : keys) wanted |= k == key;
+    }
+
+    const JsonReader::Token value = reader.Next();
+    if (wanted && value == JsonReader::Token::kString) {
+      result->values[key] = std::string(reader.text());
+    } else if (!reader.Skip()) {
+      break;
+    }
+  }
+  result->error = "shared_preferences.json: " + reader.error();
+  return false;
+}
+
+bool ReadCashalotConfig(const std::string& preferences_path,
+                        PrewarmResult* result) {
+  if (!ReadPreferences(preferences_path,
+                       {"cashalot_folder_path", "cashalot_key_path"}, result)) {
+    return false;
+  }
+  auto key = result->values.find("cashalot_key_path");
+  if (key != result->values.end() && !key->second.empty()) {
+    const fs::path key_path = fs::u8path(key->second);
+    std::error_code ec;
+    result->values["cashalot_key_dir"] =
+        fs::is_regular_file(key_path, ec) ? key_path.parent_path().u8string()
+                                          : key->second;
+  }
+  return true;
+}
+
+}  // namespace virok
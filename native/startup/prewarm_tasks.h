@@ -0,0 +1,34 @@
+#ifndef NATIVE_STARTUP_PREWARM_TASKS_H_
+#define NATIVE_STARTUP_PREWARM_TASKS_H_
+
+#include <string>
+#include <vector>
+
+#include "startup/prewarm.h"
+
+namespace virok {
+
+// Спільні для обох раннерів задачі прогріву. Шляхи — UTF-8.
+
+// Послідовно читає файл (і його -wal, якщо є), щоб сторінки SQLite вже
+// були в кеші ОС, коли Dart відкриє базу. Відсутній файл (перший запуск)
+// — не помилка: values["exists"] = "false".
+// values: path, exists, bytes.
+bool PageInFile(const std::string& path, PrewarmResult* result);
+
+// Читає shared_preferences.json плагіна shared_preferences і кладе
+// рядкові значення |keys| (без префікса "flutter.") у values.
+bool ReadPreferences(const std::string& path,
+                     const std::vector<std::string>& keys,
+                     PrewarmResult* result);
+
+// Налаштування Cashalot для AppInitializationService.initCashalot:
+// cashalot_folder_path, cashalot_key_path і вже розв'язана папка ключа
+// cashalot_key_dir (батьківська, якщо в налаштуваннях шлях до файлу).
+// Пароль сюди навмисно не потрапляє.
+bool ReadCashalotConfig(const std::string& preferences_path,
+                        PrewarmResult* result);
+
+}  // namespace virok
+
+#endif  // NATIVE_STARTUP_PREWARM_TASKS_H_
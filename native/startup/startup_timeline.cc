@@ -0,0 +1,43 @@
+#include "startup/startup_timeline.h"
+
+#include "metrics/metrics.h"
+#include "trace/trace.h"
+
+namespace virok {
+
+StartupTimeline& StartupTimeline::Get() {
+  static StartupTimeline* timeline = new StartupTimeline();
+  return *timeline;
+}
+
+int64_t StartupTimeline::Mark(std::string_view name) {
+  const int64_t now = Tracer::NowNs();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& mark : marks_) {
+      if (mark.name == name) return mark.ns;
+    }
+    marks_.push_back({std::string(name), now});
+  }
+  MetricsRegistry::Get()
+      .GetGauge("virok_startup_stage_microseconds",
+                "Time from process start to each startup stage",
+                MetricLabel("stage", name))
+      ->Set(now / 1000);
+  return now;
+}
+
+int64_t StartupTimeline::Find(std::string_view name) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& mark : marks_) {
+    if (mark.name == name) return mark.ns;
+  }
+  return -1;
+}
+
+std::vector<StartupMark> StartupTimeline::Marks() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return marks_;
+}
+
+}  // namespace virok
@@ -0,0 +1,44 @@
+#ifndef NATIVE_STARTUP_STARTUP_TIMELINE_H_
+#define NATIVE_STARTUP_STARTUP_TIMELINE_H_
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace virok {
+
+struct StartupMark {
+  std::string name;
+  int64_t ns;  // від старту процесу (Tracer::NowNs)
+};
+
+// Хронологія запуску каси: раннер, двигун Flutter, Dart, перший кадр.
+//
+// Позначки ставлять і раннер, і Dart (канал com.virok/startup); кожна
+// одразу потрапляє в гейдж virok_startup_stage_microseconds{stage=...},
+// тож час до готовності видно у файлі метрик без окремого звіту.
+class StartupTimeline {
+ public:
+  static StartupTimeline& Get();
+
+  // Ставить позначку |name| і повертає її час, нс. Повторна позначка з тим
+  // самим ім'ям не перезаписує першу (Dart після hot restart).
+  int64_t Mark(std::string_view name);
+
+  // Час позначки або -1, якщо її ще немає.
+  int64_t Find(std::string_view name);
+
+  std::vector<StartupMark> Marks();
+
+ private:
+  StartupTimeline() = default;
+
+  std::mutex mutex_;
+  std::vector<StartupMark> marks_;
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_STARTUP_STARTUP_TIMELINE_H_
@@ -0,0 +1,125 @@
+#include "store/catalogue_import.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <variant>
+
+namespace virok {
+
+namespace {
+
+// Рядків на сторінку LoadCompactCatalogue: читач не тримає знімок WAL
+// надовго, а проміжний SqlResult лишається в межах кількох мегабайтів.
+constexpr int64_t kLoadPage = 4096;
+
+const char kLoadPageSql[] =
+    "SELECT rowid, guid, created_at, name, article, unit_name, unit_guid,"
+    " is_folder, parent_guid, description, barcodes, price"
+    " FROM nomenclatura WHERE rowid > ? ORDER BY rowid LIMIT ?";
+
+void TakeText(SqlValue& value, std::string* out) {
+  if (auto* s = std::get_if<std::string>(&value)) {
+    *out = std::move(*s);
+  } else if (auto* i = std::get_if<int64_t>(&value)) {
+    *out = std::to_string(*i);
+  } else {
+    out->clear();
+  }
+}
+
+double Number(const SqlValue& value) {
+  if (auto* d = std::get_if<double>(&value)) return *d;
+  if (auto* i = std::get_if<int64_t>(&value)) return static_cast<double>(*i);
+  return 0;
+}
+
+}  // namespace
+
+const char kCatalogueInsertSql[] =
+    "INSERT OR REPLACE INTO nomenclatura"
+    " (guid, created_at, name, article, unit_name, unit_guid, is_folder,"
+    " parent_guid, description, barcodes, price, search_name)"
+    " VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+
+void AppendCatalogueBatches(std::vector<CatalogueRecord> records,
+                            bool replace, std::vector<SqlBatch>* batches) {
+  if (replace) batches->push_back({"DELETE FROM nomenclatura", {}});
+  SqlBatch& insert = batches->emplace_back();
+  insert.sql = kCatalogueInsertSql;
+  insert.rows.reserve(records.size());
+  for (CatalogueRecord& r : records) {
+    std::vector<SqlValue>& row = insert.rows.emplace_back();
+    row.reserve(12);
+    std::string search_name = CatalogueSearchName(r);
+    row.emplace_back(std::move(r.guid));
+    row.emplace_back(FormatCatalogueTime(r.created_at_us, r.created_at_utc));
+    row.emplace_back(std::move(r.name));
+    row.emplace_back(std::move(r.article));
+    row.emplace_back(std::move(r.unit_name));
+    row.emplace_back(std::move(r.unit_guid));
+    row.emplace_back(static_cast<int64_t>(r.is_folder ? 1 : 0));
+    row.emplace_back(r.has_parent ? SqlValue(std::move(r.parent_guid))
+                                  : SqlValue());
+    row.emplace_back(r.has_description ? SqlValue(std::move(r.description))
+                                       : SqlValue());
+    row.emplace_back(std::move(r.barcodes));
+    row.emplace_back(r.price);
+    row.emplace_back(std::move(search_name));
+  }
+}
+
+bool CatalogueImportBatches(std::string_view packed, bool replace,
+                            std::vector<SqlBatch>* batches,
+                            std::string* error) {
+  std::vector<CatalogueRecord> records;
+  if (!DecodeCatalogue(packed, &records, error)) return false;
+  AppendCatalogueBatches(std::move(records), replace, batches);
+  return true;
+}
+
+std::unique_ptr<CompactCatalogue> LoadCompactCatalogue(SqliteStore* store,
+                                                       std::string* error) {
+  CompactCatalogue::Builder builder;
+  CatalogueRecord record;
+  int64_t last = 0;
+  for (;;) {
+    SqlResult page = store->ReadSync(kLoadPageSql, {last, kLoadPage});
+    if (!page.ok) {
+      if (error) *error = page.error;
+      return nullptr;
+    }
+    for (std::vector<SqlValue>& row : page.rows) {
+      if (row.size() != 12) continue;
+      last = static_cast<int64_t>(Number(row[0]));
+      TakeText(row[1], &record.guid);
+      std::string created_at;
+      TakeText(row[2], &created_at);
+      if (!ParseCatalogueTime(created_at, &record.created_at_us,
+                              &record.created_at_utc)) {
+        if (error) *error = "invalid created_at: " + created_at;
+        return nullptr;
+      }
+      TakeText(row[3], &record.name);
+      TakeText(row[4], &record.article);
+      TakeText(row[5], &record.unit_name);
+      TakeText(row[6], &record.unit_guid);
+      record.is_folder = Number(row[7]) == 1;
+      record.has_parent = !std::holds_alternative<std::monostate>(row[8]);
+      TakeText(row[8], &record.parent_guid);
+      record.has_description =
+          !std::holds_alternative<std::monostate>(row[9]);
+      TakeText(row[9], &record.description);
+      TakeText(row[10], &record.barcodes);
+      record.price = Number(row[11]);
+      if (!builder.Add(record)) {
+        if (error) *error = "catalogue is too large for the compact form";
+        return nullptr;
+      }
+    }
+    if (static_cast<int64_t>(page.rows.size()) < kLoadPage) break;
+  }
+  return builder.Finish();
+}
+
+}  // namespace virok
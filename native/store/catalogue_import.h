@@ -0,0 +1,38 @@
+#ifndef NATIVE_STORE_CATALOGUE_IMPORT_H_
+#define NATIVE_STORE_CATALOGUE_IMPORT_H_
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "catalogue/catalogue_codec.h"
+#include "catalogue/compact_catalogue.h"
+#include "store/sqlite_store.h"
+
+namespace virok {
+
+// Той самий оператор, що _insertSql у NomenclaturaLocalDataSourceImpl.
+extern const char kCatalogueInsertSql[];
+
+// Пакет запису каталогу для SqliteStore::Write: рядки у форматі
+// _insertArgs (created_at — toIso8601String, search_name — як у
+// fromSupabaseJson). |replace| — спершу очистити таблицю (примусова
+// синхронізація). Рядки записів переносяться в пакет без копіювання.
+void AppendCatalogueBatches(std::vector<CatalogueRecord> records,
+                            bool replace, std::vector<SqlBatch>* batches);
+
+// Розкладає файл каталогу (EncodeCatalogue) прямо в пакет запису, без
+// проміжних моделей.
+bool CatalogueImportBatches(std::string_view packed, bool replace,
+                            std::vector<SqlBatch>* batches,
+                            std::string* error);
+
+// Будує компактний каталог з таблиці nomenclatura: сторінки по rowid через
+// пул читачів, тож запис синхронізації не чекає. Блокує до кінця читання.
+std::unique_ptr<CompactCatalogue> LoadCompactCatalogue(SqliteStore* store,
+                                                       std::string* error);
+
+}  // namespace virok
+
+#endif  // NATIVE_STORE_CATALOGUE_IMPORT_H_
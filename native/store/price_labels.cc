@@ -0,0 +1,96 @@
+#include "store/price_labels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <utility>
+#include <variant>
+
+namespace virok {
+
+namespace {
+
+// Рядків на сторінку: як у LoadCompactCatalogue.
+constexpr int64_t kPage = 4096;
+
+const char kPricePageSql[] =
+    "SELECT rowid, guid, price FROM nomenclatura"
+    " WHERE rowid > ? AND is_folder = 0 ORDER BY rowid LIMIT ?";
+
+const char kLabelPageSql[] =
+    "SELECT rowid, guid, price, name, article, unit_name, barcodes"
+    " FROM nomenclatura"
+    " WHERE rowid > ? AND is_folder = 0 ORDER BY rowid LIMIT ?";
+
+std::string Text(SqlValue& value) {
+  if (auto* s = std::get_if<std::string>(&value)) return std::move(*s);
+  if (auto* i = std::get_if<int64_t>(&value)) return std::to_string(*i);
+  return {};
+}
+
+double Number(const SqlValue& value) {
+  if (auto* d = std::get_if<double>(&value)) return *d;
+  if (auto* i = std::get_if<int64_t>(&value)) return static_cast<double>(*i);
+  return 0;
+}
+
+// Ціни порівнюються в копійках: REAL з JSON не завжди точно той самий.
+int64_t Kopecks(const SqlValue& value) {
+  return std::llround(Number(value) * 100);
+}
+
+// Перебирає сторінки |sql|; |row| отримує рядок без rowid-стовпця 0.
+template <typename RowFn>
+bool ForEachPage(SqliteStore* store, const char* sql, size_t columns,
+                 std::string* error, RowFn row) {
+  int64_t last = 0;
+  for (;;) {
+    SqlResult page = store->ReadSync(sql, {last, kPage});
+    if (!page.ok) {
+      if (error) *error = page.error;
+      return false;
+    }
+    for (std::vector<SqlValue>& values : page.rows) {
+      if (values.size() != columns) continue;
+      last = static_cast<int64_t>(Number(values[0]));
+      row(values);
+    }
+    if (static_cast<int64_t>(page.rows.size()) < kPage) return true;
+  }
+}
+
+}  // namespace
+
+bool SnapshotPrices(SqliteStore* store, PriceSnapshot* out,
+                    std::string* error) {
+  out->clear();
+  return ForEachPage(store, kPricePageSql, 3, error,
+                     [out](std::vector<SqlValue>& row) {
+                       out->emplace(Text(row[1]), Kopecks(row[2]));
+                     });
+}
+
+bool ChangedPriceLabels(SqliteStore* store, const PriceSnapshot& before,
+                        std::vector<PriceLabel>* out, std::string* error) {
+  out->clear();
+  if (before.empty()) return true;
+  const bool ok = ForEachPage(
+      store, kLabelPageSql, 7, error, [&](std::vector<SqlValue>& row) {
+        const auto it = before.find(Text(row[1]));
+        if (it != before.end() && it->second == Kopecks(row[2])) return;
+        PriceLabel& label = out->emplace_back();
+        label.price = Number(row[2]);
+        label.name = Text(row[3]);
+        label.article = Text(row[4]);
+        label.unit_name = Text(row[5]);
+        const std::string barcodes = Text(row[6]);
+        label.barcode = barcodes.substr(0, barcodes.find(','));
+      });
+  std::stable_sort(out->begin(), out->end(),
+                   [](const PriceLabel& a, const PriceLabel& b) {
+                     return a.name < b.name;
+                   });
+  return ok;
+}
+
+}  // namespace virok
@@ -0,0 +1,31 @@
+#ifndef NATIVE_STORE_PRICE_LABELS_H_
+#define NATIVE_STORE_PRICE_LABELS_H_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "printing/label_layout.h"
+#include "store/sqlite_store.h"
+
+namespace virok {
+
+// Ціни товарів (guid -> копійки) до синхронізації. Синхронізація
+// каталогу завжди повна, тож змінені ціни — різниця двох знімків.
+using PriceSnapshot = std::unordered_map<std::string, int64_t>;
+
+// Знімок цін товарів (без папок) таблиці nomenclatura; сторінки по rowid
+// через пул читачів, як LoadCompactCatalogue. Блокує до кінця читання.
+bool SnapshotPrices(SqliteStore* store, PriceSnapshot* out,
+                    std::string* error);
+
+// Цінники товарів, ціна яких відрізняється від |before| або яких у ньому
+// не було, у порядку назви (як розкладаються на полиці). Порожній
+// |before| — перша синхронізація: змін немає.
+bool ChangedPriceLabels(SqliteStore* store, const PriceSnapshot& before,
+                        std::vector<PriceLabel>* out, std::string* error);
+
+}  // namespace virok
+
+#endif  // NATIVE_STORE_PRICE_LABELS_H_
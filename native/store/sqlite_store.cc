@@ -0,0 +1,499 @@
+#include "store/sqlite_store.h"
+
+#include <sqlite3.h>
+
+#include <future>
+#include <utility>
+
+namespace virok {
+
+namespace {
+
+// Схема NomenclaturaLocalDataSourceImpl (версія 3). user_version той самий,
+// тож sqflite, якщо відкриє базу після нативного сховища (мобільні
+// платформи, відкат), не запускатиме onCreate/onUpgrade повторно.
+constexpr int kSchemaVersion = 3;
+
+constexpr const char* kCreateSchema[] = {
+    "CREATE TABLE IF NOT EXISTS nomenclatura ("
+    " guid TEXT PRIMARY KEY, created_at TEXT NOT NULL, name TEXT NOT NULL,"
+    " article TEXT NOT NULL, unit_name TEXT NOT NULL,"
+    " unit_guid TEXT NOT NULL, is_folder INTEGER NOT NULL,"
+    " parent_guid TEXT, description TEXT, barcodes TEXT, price REAL,"
+    " search_name TEXT)",
+    "CREATE TABLE IF NOT EXISTS sync_info ("
+    " key TEXT PRIMARY KEY, value TEXT NOT NULL)",
+    "CREATE INDEX IF NOT EXISTS idx_nomenclatura_name"
+    " ON nomenclatura (name)",
+    "CREATE INDEX IF NOT EXISTS idx_nomenclatura_search_name"
+    " ON nomenclatura (search_name)",
+    "CREATE INDEX IF NOT EXISTS idx_nomenclatura_article"
+    " ON nomenclatura (article)",
+};
+
+// Міграції зі старіших версій, як у _onUpgrade.
+constexpr const char* kUpgradeTo2[] = {
+    "ALTER TABLE nomenclatura ADD COLUMN barcodes TEXT",
+    "ALTER TABLE nomenclatura ADD COLUMN price REAL",
+    "DROP TABLE IF EXISTS barcodes",
+    "DROP TABLE IF EXISTS prices",
+};
+constexpr const char* kUpgradeTo3[] = {
+    "ALTER TABLE nomenclatura ADD COLUMN search_name TEXT",
+    "CREATE INDEX IF NOT EXISTS idx_nomenclatura_search_name"
+    " ON nomenclatura (search_name)",
+    "UPDATE nomenclatura SET search_name = LOWER(article || barcodes || name)"
+    " WHERE search_name IS NULL OR search_name = ''",
+};
+
+// Дотик до категорії (WHERE parent_guid = ?) без індексу сканує всю
+// таблицю. Індекс сумісний з sqflite, який про нього не знає.
+constexpr char kParentIndex[] =
+    "CREATE INDEX IF NOT EXISTS idx_nomenclatura_parent_guid"
+    " ON nomenclatura (parent_guid)";
+
+bool Exec(sqlite3* db, const char* sql, std::string* error) {
+  char* message = nullptr;
+  if (sqlite3_exec(db, sql, nullptr, nullptr, &message) == SQLITE_OK) {
+    return true;
+  }
+  if (error) *error = message ? message : sqlite3_errmsg(db);
+  sqlite3_free(message);
+  return false;
+}
+
+template <size_t N>
+bool ExecAll(sqlite3* db, const char* const (&statements)[N],
+             std::string* error) {
+  for (const char* sql : statements) {
+    if (!Exec(db, sql, error)) return false;
+  }
+  return true;
+}
+
+int UserVersion(sqlite3* db) {
+  sqlite3_stmt* stmt = nullptr;
+  int version = 0;
+  if (sqlite3_prepare_v2(db, "PRAGMA user_version", -1, &stmt, nullptr) ==
+          SQLITE_OK &&
+      sqlite3_step(stmt) == SQLITE_ROW) {
+    version = sqlite3_column_int(stmt, 0);
+  }
+  sqlite3_finalize(stmt);
+  return version;
+}
+
+int64_t PragmaInt(sqlite3* db, const char* sql) {
+  sqlite3_stmt* stmt = nullptr;
+  int64_t value = 0;
+  if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK &&
+      sqlite3_step(stmt) == SQLITE_ROW) {
+    value = sqlite3_column_int64(stmt, 0);
+  }
+  sqlite3_finalize(stmt);
+  return value;
+}
+
+bool MigrateSchema(sqlite3* db, std::string* error) {
+  if (!Exec(db, "BEGIN IMMEDIATE", error)) return false;
+  const int version = UserVersion(db);
+  bool ok = true;
+  if (version == 0) {
+    ok = ExecAll(db, kCreateSchema, error);
+  } else {
+    if (version < 2) ok = ExecAll(db, kUpgradeTo2, error);
+    if (ok && version < 3) ok = ExecAll(db, kUpgradeTo3, error);
+  }
+  ok = ok && Exec(db, kParentIndex, error);
+  if (ok && version < kSchemaVersion) {
+    const std::string pragma =
+        "PRAGMA user_version = " + std::to_string(kSchemaVersion);
+    ok = Exec(db, pragma.c_str(), error);
+  }
+  if (!ok) {
+    Exec(db, "ROLLBACK", nullptr);
+    return false;
+  }
+  return Exec(db, "COMMIT", error);
+}
+
+sqlite3* OpenConnection(const std::string& path, bool read_only,
+                        const SqliteStoreOptions& options,
+                        std::string* error) {
+  sqlite3* db = nullptr;
+  // NOMUTEX: з'єднанням користується лише його потік.
+  const int flags =
+      (read_only ? SQLITE_OPEN_READONLY
+                 : SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE) |
+      SQLITE_OPEN_NOMUTEX;
+  if (sqlite3_open_v2(path.c_str(), &db, flags, nullptr) != SQLITE_OK) {
+    if (error) {
+      *error = "cannot open " + path + ": " +
+               (db ? sqlite3_errmsg(db) : "out of memory");
+    }
+    sqlite3_close(db);
+    return nullptr;
+  }
+  sqlite3_busy_timeout(db, options.busy_timeout_ms);
+  // WAL зберігається у файлі бази, тож читачам досить його увімкнути
+  // писачем. synchronous=NORMAL у WAL не втрачає цілісність, лише
+  // останні транзакції при збої живлення — номенклатура синхронізується
+  // знову.
+  //
+  // auto_vacuum діє лише для нової бази і має передувати WAL: сторінки,
+  // що звільняє повна синхронізація (DELETE FROM nomenclatura), потім
+  // повертає Maintain у простої, а не VACUUM усієї бази. Для бази, яку
+  // вже створив sqflite, це нічого не змінює.
+  if (!read_only &&
+      (!Exec(db, "PRAGMA auto_vacuum = INCREMENTAL", error) ||
+       !Exec(db, "PRAGMA journal_mode = WAL", error) ||
+       !Exec(db, "PRAGMA synchronous = NORMAL", error))) {
+    sqlite3_close(db);
+    return nullptr;
+  }
+  return db;
+}
+
+bool Bind(sqlite3_stmt* stmt, const std::vector<SqlValue>& params) {
+  for (size_t i = 0; i < params.size(); i++) {
+    const int index = static_cast<int>(i + 1);
+    const SqlValue& value = params[i];
+    int rc = SQLITE_OK;
+    if (const auto* n = std::get_if<int64_t>(&value)) {
+      rc = sqlite3_bind_int64(stmt, index, *n);
+    } else if (const auto* d = std::get_if<double>(&value)) {
+      rc = sqlite3_bind_double(stmt, index, *d);
+    } else if (const auto* s = std::get_if<std::string>(&value)) {
+      rc = sqlite3_bind_text(stmt, index, s->data(),
+                             static_cast<int>(s->size()), SQLITE_STATIC);
+    } else {
+      rc = sqlite3_bind_null(stmt, index);
+    }
+    if (rc != SQLITE_OK) return false;
+  }
+  return true;
+}
+
+SqlValue Column(sqlite3_stmt* stmt, int i) {
+  switch (sqlite3_column_type(stmt, i)) {
+    case SQLITE_INTEGER:
+      return static_cast<int64_t>(sqlite3_column_int64(stmt, i));
+    case SQLITE_FLOAT:
+      return sqlite3_column_double(stmt, i);
+    case SQLITE_NULL:
+      return std::monostate();
+    default: {
+      const auto* text =
+          reinterpret_cast<const char*>(sqlite3_column_text(stmt, i));
+      return std::string(text ? text : "",
+                         static_cast<size_t>(sqlite3_column_bytes(stmt, i)));
+    }
+  }
+}
+
+SqlResult Failure(std::string error) {
+  SqlResult result;
+  result.ok = false;
+  result.error = std::move(error);
+  return result;
+}
+
+}  // namespace
+
+SqliteStore::Connection::Connection(sqlite3* db, size_t cache_size)
+    : db_(db), cache_size_(cache_size ? cache_size : 1) {}
+
+SqliteStore::Connection::~Connection() {
+  for (auto& entry : lru_) sqlite3_finalize(entry.second);
+  sqlite3_close(db_);
+}
+
+sqlite3_stmt* SqliteStore::Connection::Prepare(const std::string& sql,
+                                               std::string* error) {
+  auto it = cache_.find(sql);
+  if (it != cache_.end()) {
+    lru_.splice(lru_.begin(), lru_, it->second);
+    sqlite3_stmt* stmt = it->second->second;
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    return stmt;
+  }
+  sqlite3_stmt* stmt = nullptr;
+  if (sqlite3_prepare_v3(db_, sql.c_str(), static_cast<int>(sql.size()),
+                         SQLITE_PREPARE_PERSISTENT, &stmt,
+                         nullptr) != SQLITE_OK) {
+    if (error) *error = sqlite3_errmsg(db_);
+    return nullptr;
+  }
+  if (!stmt) {
+    if (error) *error = "empty statement";
+    return nullptr;
+  }
+  if (lru_.size() >= cache_size_) {
+    sqlite3_finalize(lru_.back().second);
+    cache_.erase(lru_.back().first);
+    lru_.pop_back();
+  }
+  lru_.emplace_front(sql, stmt);
+  cache_[sql] = lru_.begin();
+  return stmt;
+}
+
+SqliteStore::Worker::Worker(
+    std::vector<std::unique_ptr<Connection>> connections)
+    : connections_(std::move(connections)) {
+  for (auto& connection : connections_) {
+    threads_.emplace_back(&Worker::Run, this, connection.get());
+  }
+}
+
+SqliteStore::Worker::~Worker() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  for (std::thread& thread : threads_) thread.join();
+}
+
+void SqliteStore::Worker::Post(Task task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(std::move(task));
+  }
+  wake_.notify_one();
+}
+
+void SqliteStore::Worker::Run(Connection* connection) {
+  for (;;) {
+    Task task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+      // Черга дочищається і при зупинці: кожен колбек має отримати
+      // відповідь.
+      if (queue_.empty()) return;
+      task = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    task(connection);
+  }
+}
+
+SqliteStore::SqliteStore() = default;
+
+SqliteStore::~SqliteStore() { Close(); }
+
+bool SqliteStore::Open(const std::string& path, SqliteStoreOptions options,
+                       std::string* error) {
+  Close();
+  sqlite3* writer_db = OpenConnection(path, false, options, error);
+  if (!writer_db) return false;
+  if (!MigrateSchema(writer_db, error)) {
+    sqlite3_close(writer_db);
+    return false;
+  }
+
+  std::vector<std::unique_ptr<Connection>> writer;
+  writer.push_back(
+      std::make_unique<Connection>(writer_db, options.statement_cache));
+  std::vector<std::unique_ptr<Connection>> readers;
+  for (int i = 0; i < options.readers; i++) {
+    sqlite3* db = OpenConnection(path, true, options, error);
+    if (!db) return false;
+    readers.push_back(
+        std::make_unique<Connection>(db, options.statement_cache));
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  writer_ = std::make_shared<Worker>(std::move(writer));
+  if (!readers.empty()) {
+    readers_ = std::make_shared<Worker>(std::move(readers));
+  }
+  reader_count_ = options.readers;
+  return true;
+}
+
+void SqliteStore::Close() {
+  std::shared_ptr<Worker> writer;
+  std::shared_ptr<Worker> readers;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    writer = std::move(writer_);
+    readers = std::move(readers_);
+    reader_count_ = 0;
+  }
+  // Потоки зупиняються поза м'ютексом: колбеки черги можуть звертатися до
+  // сховища.
+  readers.reset();
+  writer.reset();
+}
+
+void SqliteStore::Read(std::string sql, std::vector<SqlValue> params,
+                       SqlCallback done) {
+  std::shared_ptr<Worker> worker;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    worker = readers_ ? readers_ : writer_;
+  }
+  if (!worker) {
+    done(Failure("Store is not open"));
+    return;
+  }
+  worker->Post([sql = std::move(sql), params = std::move(params),
+                done = std::move(done)](Connection* connection) {
+    done(Query(connection, sql, params));
+  });
+}
+
+void SqliteStore::Write(std::vector<SqlBatch> batches, SqlCallback done) {
+  std::shared_ptr<Worker> worker;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    worker = writer_;
+  }
+  if (!worker) {
+    done(Failure("Store is not open"));
+    return;
+  }
+  worker->Post([batches = std::move(batches),
+                done = std::move(done)](Connection* connection) {
+    done(Apply(connection, batches));
+  });
+}
+
+void SqliteStore::Maintain(int vacuum_pages, SqlCallback done) {
+  std::shared_ptr<Worker> worker;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    worker = writer_;
+  }
+  if (!worker) {
+    done(Failure("Store is not open"));
+    return;
+  }
+  worker->Post([vacuum_pages, done = std::move(done)](Connection* connection) {
+    done(Checkpoint(connection, vacuum_pages));
+  });
+}
+
+SqlResult SqliteStore::ReadSync(std::string sql,
+                                std::vector<SqlValue> params) {
+  std::promise<SqlResult> promise;
+  Read(std::move(sql), std::move(params),
+       [&promise](SqlResult result) { promise.set_value(std::move(result)); });
+  return promise.get_future().get();
+}
+
+SqlResult SqliteStore::WriteSync(std::vector<SqlBatch> batches) {
+  std::promise<SqlResult> promise;
+  Write(std::move(batches),
+        [&promise](SqlResult result) { promise.set_value(std::move(result)); });
+  return promise.get_future().get();
+}
+
+SqlResult SqliteStore::Query(Connection* connection, const std::string& sql,
+                             const std::vector<SqlValue>& params) {
+  std::string error;
+  sqlite3_stmt* stmt = connection->Prepare(sql, &error);
+  if (!stmt) return Failure(error);
+  if (!Bind(stmt, params)) return Failure(sqlite3_errmsg(connection->db()));
+
+  SqlResult result;
+  const int columns = sqlite3_column_count(stmt);
+  result.columns.reserve(columns);
+  for (int i = 0; i < columns; i++) {
+    result.columns.emplace_back(sqlite3_column_name(stmt, i));
+  }
+  int rc;
+  while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+    std::vector<SqlValue>& row = result.rows.emplace_back();
+    row.reserve(columns);
+    for (int i = 0; i < columns; i++) row.push_back(Column(stmt, i));
+  }
+  if (rc != SQLITE_DONE) {
+    result = Failure(sqlite3_errmsg(connection->db()));
+  } else {
+    result.changes = sqlite3_changes(connection->db());
+  }
+  // Скинутий оператор не тримає знімок WAL відкритим до наступного
+  // запиту.
+  sqlite3_reset(stmt);
+  return result;
+}
+
+SqlResult SqliteStore::Apply(Connection* connection,
+                             const std::vector<SqlBatch>& batches) {
+  sqlite3* db = connection->db();
+  std::string error;
+  if (!Exec(db, "BEGIN IMMEDIATE", &error)) return Failure(error);
+
+  SqlResult result;
+  static const std::vector<std::vector<SqlValue>> kNoParams(1);
+  for (const SqlBatch& batch : batches) {
+    sqlite3_stmt* stmt = connection->Prepare(batch.sql, &error);
+    if (!stmt) {
+      result = Failure(error);
+      break;
+    }
+    const auto& rows = batch.rows.empty() ? kNoParams : batch.rows;
+    for (const std::vector<SqlValue>& params : rows) {
+      sqlite3_reset(stmt);
+      sqlite3_clear_bindings(stmt);
+      if (!Bind(stmt, params)) {
+        result = Failure(sqlite3_errmsg(db));
+        break;
+      }
+      int rc;
+      while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+      }
+      if (rc != SQLITE_DONE) {
+        result = Failure(sqlite3_errmsg(db));
+        break;
+      }
+      result.changes += sqlite3_changes(db);
+    }
+    sqlite3_reset(stmt);
+    if (!result.ok) break;
+  }
+
+  if (!result.ok) {
+    Exec(db, "ROLLBACK", nullptr);
+    return result;
+  }
+  if (!Exec(db, "COMMIT", &error)) {
+    Exec(db, "ROLLBACK", nullptr);
+    return Failure(error);
+  }
+  return result;
+}
+
+SqlResult SqliteStore::Checkpoint(Connection* connection, int vacuum_pages) {
+  sqlite3* db = connection->db();
+  // PASSIVE не чекає на читачів: кадри, які ще хтось бачить, перенесе
+  // наступний виклик.
+  int wal_frames = 0;
+  int checkpointed = 0;
+  if (sqlite3_wal_checkpoint_v2(db, nullptr, SQLITE_CHECKPOINT_PASSIVE,
+                                &wal_frames, &checkpointed) != SQLITE_OK) {
+    return Failure(sqlite3_errmsg(db));
+  }
+  std::string error;
+  // auto_vacuum = 2 (INCREMENTAL); у старій базі від sqflite — 0, там
+  // сторінки лише перевикористовуються.
+  if (vacuum_pages > 0 && PragmaInt(db, "PRAGMA auto_vacuum") == 2) {
+    const std::string sql =
+        "PRAGMA incremental_vacuum(" + std::to_string(vacuum_pages) + ")";
+    if (!Exec(db, sql.c_str(), &error)) return Failure(error);
+  }
+  if (!Exec(db, "PRAGMA optimize", &error)) return Failure(error);
+
+  SqlResult result;
+  result.columns = {"wal_frames", "checkpointed_frames", "freelist_pages"};
+  result.rows.push_back({static_cast<int64_t>(wal_frames),
+                         static_cast<int64_t>(checkpointed),
+                         PragmaInt(db, "PRAGMA freelist_count")});
+  return result;
+}
+
+}  // namespace virok
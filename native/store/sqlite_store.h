@@ -0,0 +1,158 @@
+#ifndef NATIVE_STORE_SQLITE_STORE_H_
+#define NATIVE_STORE_SQLITE_STORE_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+namespace virok {
+
+// Значення параметра або колонки: NULL, INTEGER, REAL, TEXT.
+using SqlValue = std::variant<std::monostate, int64_t, double, std::string>;
+
+struct SqlResult {
+  bool ok = true;
+  std::string error;
+  std::vector<std::string> columns;
+  std::vector<std::vector<SqlValue>> rows;
+  // Змінених рядків (для запису — сумарно по пакету).
+  int64_t changes = 0;
+};
+
+// Один оператор запису з кількома наборами параметрів (INSERT пакетом).
+// Порожній |rows| — виконати один раз без параметрів.
+struct SqlBatch {
+  std::string sql;
+  std::vector<std::vector<SqlValue>> rows;
+};
+
+using SqlCallback = std::function<void(SqlResult result)>;
+
+struct SqliteStoreOptions {
+  // Читачів (з'єднань лише для читання, кожне у своєму потоці). 0 — усі
+  // запити йдуть через з'єднання писача, як у sqflite з одним з'єднанням.
+  int readers = 3;
+  // Підготовлених операторів на з'єднання (LRU).
+  size_t statement_cache = 32;
+  // Скільки чекати на блокування файлу іншим процесом.
+  int busy_timeout_ms = 5000;
+};
+
+// Доступ до nomenclatura.db без черги за синхронізацією.
+//
+// База працює в режимі WAL: запис іде в окремий журнал, а читачі бачать
+// останній зафіксований стан, тож довга транзакція синхронізації не
+// блокує пошук. Усі записи виконує один потік-писач (SQLite допускає лише
+// одного писача), кожен пакет — одна транзакція. Читання розподіляються
+// між пулом з'єднань лише для читання, у кожного свій кеш підготовлених
+// операторів.
+//
+// Колбеки викликаються з потоків сховища; передача результату в UI —
+// справа викликача. Потокобезпечний.
+class SqliteStore {
+ public:
+  SqliteStore();
+  // Закриває сховище: поставлені в чергу запити ще виконуються.
+  ~SqliteStore();
+
+  SqliteStore(const SqliteStore&) = delete;
+  SqliteStore& operator=(const SqliteStore&) = delete;
+
+  // Відкриває (створює) базу, вмикає WAL і створює схему номенклатури,
+  // якщо її ще немає (та сама, що в NomenclaturaLocalDataSourceImpl).
+  bool Open(const std::string& path, SqliteStoreOptions options,
+            std::string* error);
+  void Close();
+
+  // SELECT через пул читачів.
+  void Read(std::string sql, std::vector<SqlValue> params, SqlCallback done);
+  // Пакет операторів в одній транзакції потоком-писачем. При помилці
+  // транзакція відкочується цілком.
+  void Write(std::vector<SqlBatch> batches, SqlCallback done);
+  // Обслуговування у простої каси (див. maintenance/idle_scheduler):
+  // PASSIVE checkpoint журналу WAL, до |vacuum_pages| вільних сторінок
+  // через incremental_vacuum і PRAGMA optimize. Потоком-писачем між
+  // пакетами запису, без читачів не чекає. Результат — один рядок
+  // {wal_frames, checkpointed_frames, freelist_pages}.
+  void Maintain(int vacuum_pages, SqlCallback done);
+
+  // Синхронні обгортки (бенчмарк, тести).
+  SqlResult ReadSync(std::string sql, std::vector<SqlValue> params);
+  SqlResult WriteSync(std::vector<SqlBatch> batches);
+
+  int readers() const { return reader_count_; }
+
+ private:
+  // З'єднання з кешем підготовлених операторів.
+  class Connection {
+   public:
+    Connection(sqlite3* db, size_t cache_size);
+    ~Connection();
+
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    sqlite3* db() const { return db_; }
+    // Підготовлений оператор з кешу (скинутий, без параметрів) або nullptr.
+    sqlite3_stmt* Prepare(const std::string& sql, std::string* error);
+
+   private:
+    sqlite3* db_;
+    const size_t cache_size_;
+    // Найновіші спереду.
+    std::list<std::pair<std::string, sqlite3_stmt*>> lru_;
+    std::unordered_map<std::string,
+                       std::list<std::pair<std::string, sqlite3_stmt*>>::
+                           iterator>
+        cache_;
+  };
+
+  // Черга задач з одним або кількома потоками-виконавцями, кожен зі своїм
+  // з'єднанням.
+  class Worker {
+   public:
+    using Task = std::function<void(Connection* connection)>;
+
+    explicit Worker(std::vector<std::unique_ptr<Connection>> connections);
+    ~Worker();
+
+    void Post(Task task);
+
+   private:
+    void Run(Connection* connection);
+
+    std::vector<std::unique_ptr<Connection>> connections_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<Task> queue_;
+    bool stopping_ = false;
+    std::vector<std::thread> threads_;
+  };
+
+  static SqlResult Query(Connection* connection, const std::string& sql,
+                         const std::vector<SqlValue>& params);
+  static SqlResult Apply(Connection* connection,
+                         const std::vector<SqlBatch>& batches);
+  static SqlResult Checkpoint(Connection* connection, int vacuum_pages);
+
+  std::mutex mutex_;
+  std::shared_ptr<Worker> writer_;
+  std::shared_ptr<Worker> readers_;
+  int reader_count_ = 0;
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_STORE_SQLITE_STORE_H_
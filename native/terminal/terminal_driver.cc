@@ -0,0 +1,422 @@
+#include "terminal/terminal_driver.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "metrics/metrics.h"
+#include "printing/escpos.h"
+
+namespace virok {
+
+namespace {
+
+// Найдовше очікування в Read: стільки щонайбільше триває Stop, і з такою
+// точністю спрацьовують тайм-аути запитів.
+constexpr int kMaxReadWaitMs = 100;
+
+// Стани, з яких починається робота з карткою: від них рахується "tap".
+constexpr const char* kCardStates[] = {"cardTapped", "cardInserted",
+                                       "cardSwiped", "cardRead"};
+
+int64_t Micros(TerminalDriver::Clock::duration d) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+}
+
+int64_t Nanos(TerminalDriver::Clock::time_point t) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             t.time_since_epoch())
+      .count();
+}
+
+bool IsCardState(const std::string& state) {
+  return std::any_of(std::begin(kCardStates), std::end(kCardStates),
+                     [&](const char* s) { return state == s; });
+}
+
+std::string Param(const TerminalParams& params, const char* key) {
+  auto it = params.find(key);
+  return it == params.end() ? std::string() : it->second;
+}
+
+// Без error і з кодом відповіді банку "0000"/"00" (або без нього —
+// PingDevice, Interrupt).
+bool IsApproved(const TerminalMessage& message) {
+  if (message.error) return false;
+  const std::string code = Param(message.params, "responseCode");
+  return code.empty() || code == "0000" || code == "00";
+}
+
+bool IsPayment(const std::string& method) {
+  return method == kTerminalPurchase || method == kTerminalRefund;
+}
+
+void CountResult(const char* result) {
+  MetricsRegistry::Get()
+      .GetCounter("virok_terminal_results_total",
+                  "Payment terminal requests by outcome",
+                  MetricLabel("result", result))
+      ->Add();
+}
+
+}  // namespace
+
+const char* TerminalEventName(TerminalEvent::Type type) {
+  switch (type) {
+    case TerminalEvent::Type::kConnected:
+      return "connected";
+    case TerminalEvent::Type::kDisconnected:
+      return "disconnected";
+    case TerminalEvent::Type::kState:
+      return "state";
+    case TerminalEvent::Type::kResult:
+      return "result";
+    case TerminalEvent::Type::kSlip:
+      return "slip";
+  }
+  return "";
+}
+
+TerminalDriver::TerminalDriver(TerminalListener listener)
+    : listener_(std::move(listener)) {}
+
+TerminalDriver::~TerminalDriver() { Stop(); }
+
+bool TerminalDriver::Start(const TerminalOptions& options,
+                           std::string* error) {
+  Stop();
+  options_ = options;
+  if (options_.host.empty()) {
+    if (error) *error = "terminal host is not set";
+    return false;
+  }
+  if (!stream_.Connect(options_.host, options_.port,
+                       static_cast<int>(options_.connect_timeout.count()),
+                       error)) {
+    return false;
+  }
+  stop_ = false;
+  connected_ = true;
+  last_traffic_ns_ = Nanos(Clock::now());
+  thread_ = std::thread(&TerminalDriver::Run, this);
+  printer_ = std::thread(&TerminalDriver::RunPrinter, this);
+  return true;
+}
+
+void TerminalDriver::Stop() {
+  if (!thread_.joinable()) return;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  thread_.join();
+  printer_.join();
+  {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    stream_.Close();
+    connected_ = false;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    slips_.clear();
+  }
+  FailAll("stopped");
+}
+
+int64_t TerminalDriver::Submit(const std::string& method,
+                               TerminalParams params,
+                               std::chrono::milliseconds timeout,
+                               std::string* error) {
+  return Send(method, std::move(params), timeout, false, error);
+}
+
+bool TerminalDriver::Cancel(int64_t request, std::string* error) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pending_.count(request) == 0) {
+      if (error) *error = "no such request";
+      return false;
+    }
+  }
+  TerminalParams params;
+  params["requestId"] = std::to_string(request);
+  return Send(kTerminalInterrupt, std::move(params), options_.ping_timeout,
+              true, error) != 0;
+}
+
+int64_t TerminalDriver::Send(const std::string& method,
+                             TerminalParams params,
+                             std::chrono::milliseconds timeout, bool internal,
+                             std::string* error) {
+  if (!connected_) {
+    if (error) *error = "terminal is not connected";
+    return 0;
+  }
+  const Clock::time_point now = Clock::now();
+  TerminalMessage message;
+  message.id = next_id_++;
+  message.method = method;
+  message.params = std::move(params);
+  {
+    // До запису: відповідь може прийти раніше, ніж Write поверне керування.
+    std::lock_guard<std::mutex> lock(mutex_);
+    Pending& pending = pending_[message.id];
+    pending.method = method;
+    pending.submitted = now;
+    pending.deadline = now + timeout;
+    pending.internal = internal;
+  }
+  const std::string frame = EncodeTerminalMessage(message);
+  bool written = false;
+  {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    written = stream_.is_open() && stream_.Write(frame, error);
+  }
+  if (!written) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.erase(message.id);
+    if (error && error->empty()) *error = "terminal is not connected";
+    return 0;
+  }
+  last_traffic_ns_ = Nanos(now);
+  return message.id;
+}
+
+bool TerminalDriver::Sleep(std::chrono::milliseconds delay) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return !wake_.wait_for(lock, delay, [this] { return stop_.load(); });
+}
+
+void TerminalDriver::Run() {
+  {
+    TerminalEvent event;
+    event.type = TerminalEvent::Type::kConnected;
+    listener_(event);
+  }
+  TerminalFrameParser parser;
+  std::vector<TerminalMessage> messages;
+  char buf[4096];
+
+  while (!stop_) {
+    std::string error;
+    if (!connected_) {
+      if (!Sleep(options_.reconnect_delay)) break;
+      bool ok = false;
+      {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        ok = stream_.Connect(
+            options_.host, options_.port,
+            static_cast<int>(options_.connect_timeout.count()), &error);
+      }
+      if (!ok) continue;
+      parser.Reset();
+      last_traffic_ns_ = Nanos(Clock::now());
+      connected_ = true;
+      TerminalEvent event;
+      event.type = TerminalEvent::Type::kConnected;
+      listener_(event);
+      continue;
+    }
+
+    const int n = stream_.Read(buf, sizeof(buf), kMaxReadWaitMs, &error);
+    if (n < 0) {
+      Disconnect(error);
+      continue;
+    }
+    const Clock::time_point now = Clock::now();
+    if (n > 0) {
+      last_traffic_ns_ = Nanos(now);
+      messages.clear();
+      parser.Feed(std::string_view(buf, static_cast<size_t>(n)), &messages);
+      for (const TerminalMessage& message : messages) Dispatch(message);
+    }
+    ExpireRequests(now);
+    if (connected_ &&
+        Nanos(now) - last_traffic_ns_ >=
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                options_.keepalive_interval)
+                .count()) {
+      if (Send(kTerminalPing, {}, options_.ping_timeout, true, &error) == 0) {
+        Disconnect(error);
+      }
+    }
+  }
+}
+
+void TerminalDriver::Dispatch(const TerminalMessage& message) {
+  const Clock::time_point now = Clock::now();
+  const bool is_state = message.method == kTerminalServiceMessage;
+  const std::string state = Param(message.params, "msgType");
+  Pending pending;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = pending_.find(message.id);
+    // Повідомлення без запиту (стан самого термінала) не цікавлять касу.
+    if (it == pending_.end()) return;
+    if (is_state && !it->second.has_tap && IsCardState(state)) {
+      it->second.tapped = now;
+      it->second.has_tap = true;
+    }
+    pending = it->second;
+    if (!is_state) pending_.erase(it);
+  }
+  if (pending.internal) return;
+
+  TerminalEvent event;
+  event.request = message.id;
+  event.method = pending.method;
+  event.params = message.params;
+  if (is_state) {
+    event.type = TerminalEvent::Type::kState;
+    event.state = state;
+    listener_(event);
+    return;
+  }
+
+  event.type = TerminalEvent::Type::kResult;
+  event.approved = IsApproved(message);
+  event.error = message.error_description;
+  if (!event.approved && event.error.empty()) {
+    event.error = "declined: " + Param(message.params, "responseCode");
+  }
+  event.elapsed_us = Micros(now - pending.submitted);
+  const Clock::time_point tapped =
+      pending.has_tap ? pending.tapped : pending.submitted;
+  if (event.approved && IsPayment(pending.method)) {
+    event.tap_to_approval_us = Micros(now - tapped);
+    MetricsRegistry::Get()
+        .GetHistogram("virok_terminal_tap_to_approval_microseconds",
+                      "Time from the card reaching the terminal to approval",
+                      MetricLabel("method", pending.method))
+        ->Record(event.tap_to_approval_us);
+    const std::string receipt = Param(message.params, "receipt");
+    if (!receipt.empty() && !options_.printer_host.empty()) {
+      // Сліп друкується паралельно з тим, як каса обробляє результат.
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        slips_.push_back({message.id, receipt, tapped});
+      }
+      wake_.notify_all();
+    }
+  }
+  CountResult(event.approved ? "approved" : "declined");
+  listener_(event);
+}
+
+void TerminalDriver::ExpireRequests(Clock::time_point now) {
+  std::vector<std::pair<int64_t, Pending>> expired;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = pending_.begin(); it != pending_.end();) {
+      if (now < it->second.deadline) {
+        ++it;
+        continue;
+      }
+      expired.emplace_back(it->first, std::move(it->second));
+      it = pending_.erase(it);
+    }
+  }
+  bool dead = false;
+  for (const auto& [id, pending] : expired) {
+    if (pending.internal) {
+      // Термінал не відповів навіть на пінг: з'єднання мертве.
+      dead = dead || pending.method == kTerminalPing;
+      continue;
+    }
+    CountResult("failed");
+    TerminalEvent event;
+    event.type = TerminalEvent::Type::kResult;
+    event.request = id;
+    event.method = pending.method;
+    event.error = "timeout";
+    event.elapsed_us = Micros(now - pending.submitted);
+    listener_(event);
+  }
+  if (dead) Disconnect("keepalive timeout");
+}
+
+void TerminalDriver::Disconnect(const std::string& error) {
+  {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    stream_.Close();
+    connected_ = false;
+  }
+  FailAll("connection lost: " + error);
+  TerminalEvent event;
+  event.type = TerminalEvent::Type::kDisconnected;
+  event.error = error;
+  listener_(event);
+}
+
+void TerminalDriver::FailAll(const std::string& error) {
+  std::map<int64_t, Pending> failed;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    failed.swap(pending_);
+  }
+  const Clock::time_point now = Clock::now();
+  for (const auto& [id, pending] : failed) {
+    if (pending.internal) continue;
+    CountResult("failed");
+    TerminalEvent event;
+    event.type = TerminalEvent::Type::kResult;
+    event.request = id;
+    event.method = pending.method;
+    event.error = error;
+    event.elapsed_us = Micros(now - pending.submitted);
+    listener_(event);
+  }
+}
+
+void TerminalDriver::RunPrinter() {
+  while (true) {
+    SlipJob job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.wait(lock, [this] { return stop_ || !slips_.empty(); });
+      if (stop_) return;
+      job = std::move(slips_.front());
+      slips_.pop_front();
+    }
+    std::string document(kEscPosInit);
+    Utf8ToCp1251(job.text, &document);
+    document += kEscPosFeedCut;
+
+    TerminalEvent event;
+    event.type = TerminalEvent::Type::kSlip;
+    event.request = job.request;
+    const int copies = std::max(1, options_.slip_copies);
+    for (int copy = 0; copy < copies; copy++) {
+      if (copy > 0 && !Sleep(options_.slip_copy_pause)) break;
+      if (!PrintSlip(document, &event.error)) break;
+      if (copy == 0) {
+        event.tap_to_slip_us = Micros(Clock::now() - job.tapped);
+        MetricsRegistry::Get()
+            .GetHistogram("virok_terminal_tap_to_slip_microseconds",
+                          "Time from the card reaching the terminal to the "
+                          "printed bank slip")
+            ->Record(event.tap_to_slip_us);
+      }
+    }
+    if (!event.error.empty()) {
+      MetricsRegistry::Get()
+          .GetCounter("virok_print_failures_total",
+                      "Failed raw prints to the receipt printer",
+                      MetricLabel("kind", "bankSlip"))
+          ->Add();
+    }
+    listener_(event);
+  }
+}
+
+bool TerminalDriver::PrintSlip(const std::string& document,
+                               std::string* error) {
+  TcpStream printer;
+  return printer.Connect(options_.printer_host, options_.printer_port,
+                         static_cast<int>(options_.connect_timeout.count()),
+                         error) &&
+         printer.Write(document, error);
+}
+
+}  // namespace virok
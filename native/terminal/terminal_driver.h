@@ -0,0 +1,168 @@
+#ifndef NATIVE_TERMINAL_TERMINAL_DRIVER_H_
+#define NATIVE_TERMINAL_TERMINAL_DRIVER_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "net/tcp_stream.h"
+#include "terminal/terminal_protocol.h"
+
+namespace virok {
+
+struct TerminalOptions {
+  std::string host;
+  uint16_t port = 2000;
+  std::chrono::milliseconds connect_timeout = std::chrono::seconds(3);
+  // Пауза перед повторним з'єднанням, якщо термінал зник.
+  std::chrono::milliseconds reconnect_delay = std::chrono::seconds(2);
+  // Без обміну довше за цей час драйвер шле PingDevice; без відповіді за
+  // ping_timeout з'єднання вважається мертвим.
+  std::chrono::milliseconds keepalive_interval = std::chrono::seconds(30);
+  std::chrono::milliseconds ping_timeout = std::chrono::seconds(5);
+  // Принтер банківського сліпа (RAW 9100); порожній host — сліп не
+  // друкується, текст іде лише в подію результату.
+  std::string printer_host;
+  uint16_t printer_port = 9100;
+  // Копії сліпа (клієнт, мерчант) і пауза між ними, щоб відірвати першу.
+  int slip_copies = 2;
+  std::chrono::milliseconds slip_copy_pause = std::chrono::seconds(2);
+};
+
+struct TerminalEvent {
+  enum class Type {
+    kConnected,
+    kDisconnected,
+    // Проміжний стан запиту (|state| — msgType: cardTapped, pinEntry...).
+    kState,
+    // Відповідь на запит: |approved|, поля |params|, опис у |error|.
+    kResult,
+    // Сліп схваленої оплати надруковано (або ні — тоді |error|).
+    kSlip,
+  };
+  Type type = Type::kState;
+  int64_t request = 0;
+  std::string method;
+  std::string state;
+  bool approved = false;
+  TerminalParams params;
+  std::string error;
+  // Для kResult: від Submit до відповіді, мкс.
+  int64_t elapsed_us = 0;
+  // Від першого стану з карткою (прикладено, вставлено) до схвалення і
+  // до надрукованої першої копії сліпа; без такого стану — від Submit.
+  int64_t tap_to_approval_us = 0;
+  int64_t tap_to_slip_us = 0;
+};
+
+const char* TerminalEventName(TerminalEvent::Type type);
+
+// Викликається з потоку вводу-виводу термінала або з потоку друку сліпів.
+using TerminalListener = std::function<void(const TerminalEvent& event)>;
+
+// Драйвер банківського термінала за ECR-протоколом (див.
+// terminal_protocol.h).
+//
+// Одне з'єднання на весь час роботи каси: окремий потік читає його і
+// розводить повідомлення за id запиту, тож проміжні стани (картку
+// прикладено, PIN, авторизація) приходять слухачу одразу, а не разом з
+// результатом. Запити надсилаються з потоку викликача, не чекаючи на
+// відповіді попередніх.
+//
+// Щойно оплату схвалено, сліп з відповіді (params.receipt) іде на
+// принтер в окремому потоці — ще до того, як каса отримає результат.
+// Час від картки до схвалення і до сліпа пишеться в гістограми
+// virok_terminal_tap_to_approval_microseconds і
+// virok_terminal_tap_to_slip_microseconds.
+//
+// Якщо з'єднання обірвалося, запити в дорозі завершуються з помилкою
+// (результат оплати слід перевірити на терміналі), а драйвер
+// з'єднується знову кожні reconnect_delay.
+class TerminalDriver {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit TerminalDriver(TerminalListener listener);
+  ~TerminalDriver();
+
+  TerminalDriver(const TerminalDriver&) = delete;
+  TerminalDriver& operator=(const TerminalDriver&) = delete;
+
+  // З'єднується з терміналом і запускає потоки. Драйвер, що вже працює,
+  // спершу зупиняється.
+  bool Start(const TerminalOptions& options, std::string* error);
+  // Запити в дорозі завершуються kResult з помилкою "stopped".
+  void Stop();
+  bool running() const { return thread_.joinable(); }
+  bool connected() const { return connected_; }
+
+  // Надсилає запит |method| і повертає його id (> 0). Відповідь без
+  // |timeout| завершує запит з помилкою "timeout". 0 — термінал не
+  // з'єднано або запис не вдався (причина в |error|).
+  int64_t Submit(const std::string& method, TerminalParams params,
+                 std::chrono::milliseconds timeout, std::string* error);
+
+  // Просить термінал перервати запит |request| (Interrupt). Перерваний
+  // запит отримає свій kResult.
+  bool Cancel(int64_t request, std::string* error);
+
+ private:
+  struct Pending {
+    std::string method;
+    Clock::time_point submitted;
+    Clock::time_point deadline;
+    Clock::time_point tapped;
+    bool has_tap = false;
+    // Службовий запит драйвера (keepalive, Interrupt): слухач його не бачить.
+    bool internal = false;
+  };
+  struct SlipJob {
+    int64_t request = 0;
+    std::string text;
+    Clock::time_point tapped;
+  };
+
+  int64_t Send(const std::string& method, TerminalParams params,
+               std::chrono::milliseconds timeout, bool internal,
+               std::string* error);
+  void Run();
+  void RunPrinter();
+  void Dispatch(const TerminalMessage& message);
+  void ExpireRequests(Clock::time_point now);
+  // Закриває з'єднання і завершує всі запити в дорозі помилкою |error|.
+  void Disconnect(const std::string& error);
+  void FailAll(const std::string& error);
+  // Чекає |delay| або зупинки; false — драйвер зупиняють.
+  bool Sleep(std::chrono::milliseconds delay);
+  bool PrintSlip(const std::string& document, std::string* error);
+
+  const TerminalListener listener_;
+  TerminalOptions options_;
+  TcpStream stream_;
+  std::atomic<bool> connected_{false};
+  std::atomic<int64_t> next_id_{1};
+  std::atomic<int64_t> last_traffic_ns_{0};
+
+  // Запис у з'єднання і його закриття (потік вводу-виводу читає без
+  // блокування: recv і send на одному сокеті з різних потоків безпечні).
+  std::mutex write_mutex_;
+
+  std::mutex mutex_;  // pending_, slips_, stop_
+  std::condition_variable wake_;
+  std::map<int64_t, Pending> pending_;
+  std::deque<SlipJob> slips_;
+  std::atomic<bool> stop_{false};
+  std::thread thread_;
+  std::thread printer_;
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_TERMINAL_TERMINAL_DRIVER_H_
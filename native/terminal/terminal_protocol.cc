@@ -0,0 +1,169 @@
+#include "terminal/terminal_protocol.h"
+
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+#include "json/json_reader.h"
+
+namespace virok {
+
+namespace {
+
+using Token = JsonReader::Token;
+
+void AppendString(std::string_view s, std::string* out) {
+  out->push_back('"');
+  for (char c : s) {
+    switch (c) {
+      case '"':
+        *out += "\\\"";
+        break;
+      case '\\':
+        *out += "\\\\";
+        break;
+      case '\n':
+        *out += "\\n";
+        break;
+      case '\r':
+        *out += "\\r";
+        break;
+      case '\t':
+        *out += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char buf[8];
+          std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+          *out += buf;
+        } else {
+          out->push_back(c);
+        }
+    }
+  }
+  out->push_back('"');
+}
+
+// Значення params як текст; вкладені об'єкти й масиви пропускаються.
+bool ReadParams(JsonReader& reader, TerminalParams* params) {
+  Token t = reader.Next();
+  if (t == Token::kNull) return true;
+  if (t != Token::kBeginObject) return false;
+  while (true) {
+    t = reader.Next();
+    if (t == Token::kEndObject) return true;
+    if (t != Token::kKey) return false;
+    const std::string key(reader.text());
+    t = reader.Next();
+    if (t == Token::kString || t == Token::kNumber) {
+      (*params)[key] = std::string(reader.text());
+    } else if (t == Token::kBool) {
+      (*params)[key] = reader.boolean() ? "true" : "false";
+    } else if (t != Token::kNull && !reader.Skip()) {
+      return false;
+    }
+  }
+}
+
+}  // namespace
+
+std::string EncodeTerminalMessage(const TerminalMessage& message) {
+  std::string out = "{\"id\":" + std::to_string(message.id) + ",\"method\":";
+  AppendString(message.method, &out);
+  if (message.error || !message.error_description.empty()) {
+    out += message.error ? ",\"error\":true" : ",\"error\":false";
+    out += ",\"errorDescription\":";
+    AppendString(message.error_description, &out);
+  }
+  out += ",\"params\":{";
+  bool first = true;
+  for (const auto& [key, value] : message.params) {
+    if (!first) out.push_back(',');
+    first = false;
+    AppendString(key, &out);
+    out.push_back(':');
+    AppendString(value, &out);
+  }
+  out += "}}";
+  out.push_back('\0');
+  return out;
+}
+
+bool ParseTerminalMessage(std::string_view json, TerminalMessage* out,
+                          std::string* error) {
+  *out = TerminalMessage();
+  JsonReader reader(json);
+  auto fail = [&](const char* what) {
+    if (error) {
+      *error = reader.error().empty() ? what : reader.error();
+    }
+    return false;
+  };
+  if (reader.Next() != Token::kBeginObject) return fail("expected object");
+  while (true) {
+    Token t = reader.Next();
+    if (t == Token::kEndObject) break;
+    if (t != Token::kKey) return fail("expected key");
+    const std::string key(reader.text());
+    if (key == "params") {
+      if (!ReadParams(reader, &out->params)) return fail("bad params");
+      continue;
+    }
+    t = reader.Next();
+    if (key == "id" && t == Token::kNumber) {
+      out->id = reader.integer();
+    } else if (key == "method" && t == Token::kString) {
+      out->method = std::string(reader.text());
+    } else if (key == "error" && t == Token::kBool) {
+      out->error = reader.boolean();
+    } else if (key == "errorDescription" && t == Token::kString) {
+      out->error_description = std::string(reader.text());
+    } else if (!reader.Skip()) {
+      return fail("bad value");
+    }
+  }
+  if (out->method.empty()) return fail("no method");
+  return true;
+}
+
+void TerminalFrameParser::Feed(std::string_view data,
+                               std::vector<TerminalMessage>* out) {
+  while (!data.empty()) {
+    const void* nul = std::memchr(data.data(), '\0', data.size());
+    const size_t take =
+        nul ? static_cast<size_t>(static_cast<const char*>(nul) -
+                                  data.data())
+            : data.size();
+    if (!skipping_) {
+      buffer_.append(data.data(), take);
+      if (buffer_.size() > kMaxFrame) {
+        buffer_.clear();
+        skipping_ = true;
+        dropped_++;
+      }
+    }
+    if (!nul) return;
+    data.remove_prefix(take + 1);
+    if (skipping_) {
+      skipping_ = false;
+      continue;
+    }
+    // Порожні кадри (NUL-заповнення між повідомленнями) — не помилка.
+    if (buffer_.find_first_not_of(" \t\r\n") != std::string::npos) {
+      TerminalMessage message;
+      if (ParseTerminalMessage(buffer_, &message, nullptr)) {
+        out->push_back(std::move(message));
+      } else {
+        dropped_++;
+      }
+    }
+    buffer_.clear();
+  }
+}
+
+void TerminalFrameParser::Reset() {
+  buffer_.clear();
+  skipping_ = false;
+}
+
+}  // namespace virok
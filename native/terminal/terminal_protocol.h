@@ -0,0 +1,79 @@
+#ifndef NATIVE_TERMINAL_TERMINAL_PROTOCOL_H_
+#define NATIVE_TERMINAL_TERMINAL_PROTOCOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace virok {
+
+// Поля params повідомлення термінала. Протокол плоский: рядки, а числа й
+// булеві значення — у своєму текстовому вигляді ("12.50", "true").
+using TerminalParams = std::map<std::string, std::string>;
+
+// Повідомлення ECR-протоколу термінала (JSON поверх TCP, як PrivatBank
+// JSON): кожне — один JSON-об'єкт, завершений байтом NUL.
+//
+//   каса:     {"id":7,"method":"Purchase","params":{"amount":"12.50"}}
+//   термінал: {"id":7,"method":"ServiceMessage",
+//              "params":{"msgType":"cardTapped"}}
+//   термінал: {"id":7,"method":"Purchase","error":false,
+//              "errorDescription":"","params":{"responseCode":"0000",...}}
+//
+// |id| призначає каса, і всі відповіді та проміжні стани запиту несуть
+// його ж — тому одним з'єднанням ідуть кілька запитів одночасно (оплата,
+// що чекає на картку, і пінг або переривання).
+struct TerminalMessage {
+  int64_t id = 0;
+  std::string method;
+  // Лише у відповіді: false — операцію виконано (чи схвалено).
+  bool error = false;
+  std::string error_description;
+  TerminalParams params;
+};
+
+// Методи протоколу.
+constexpr char kTerminalPurchase[] = "Purchase";
+constexpr char kTerminalRefund[] = "Refund";
+constexpr char kTerminalPing[] = "PingDevice";
+// params.requestId — id запиту, який слід перервати (картку ще не
+// прикладено); перерваний запит отримує відповідь з error = true.
+constexpr char kTerminalInterrupt[] = "Interrupt";
+// Проміжний стан запиту: params.msgType (cardTapped, pinEntry, online...).
+constexpr char kTerminalServiceMessage[] = "ServiceMessage";
+
+// Кадр для відправки: JSON-об'єкт і завершальний NUL. Поля error і
+// errorDescription пишуться лише для відповіді (error або непорожній
+// опис) — каса їх не надсилає.
+std::string EncodeTerminalMessage(const TerminalMessage& message);
+
+// Розбирає один JSON-об'єкт (без NUL). Невідомі поля й вкладені
+// значення в params пропускаються.
+bool ParseTerminalMessage(std::string_view json, TerminalMessage* out,
+                          std::string* error);
+
+// Розбирає потік з TCP на повідомлення: кадр може прийти частинами або
+// кілька в одному читанні. Кадри, що не розбираються, відкидаються.
+class TerminalFrameParser {
+ public:
+  // Кадр без NUL, довший за це, вважається сміттям і відкидається.
+  static constexpr size_t kMaxFrame = 256 * 1024;
+
+  void Feed(std::string_view data, std::vector<TerminalMessage>* out);
+  void Reset();
+
+  // Відкинуті кадри (помилка JSON або задовгий кадр).
+  size_t dropped() const { return dropped_; }
+
+ private:
+  std::string buffer_;
+  bool skipping_ = false;
+  size_t dropped_ = 0;
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_TERMINAL_TERMINAL_PROTOCOL_H_
@@ -0,0 +1,262 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "archive/crc32.h"
+#include "catalogue/catalogue_codec.h"
+
+namespace virok {
+namespace {
+
+CatalogueRecord Item(const std::string& guid, const std::string& name) {
+  CatalogueRecord record;
+  record.guid = guid;
+  record.name = name;
+  record.created_at_us = 1709280900000000LL;
+  record.unit_name = "шт";
+  record.unit_guid = "b1e1b2a4-0000-4000-8000-000000000001";
+  return record;
+}
+
+// Кожне поле з кожним варіантом кодування: канонічні й неканонічні
+// GUID, ціни в копійках і з частками копійки, коди з нулями попереду.
+std::vector<CatalogueRecord> Records() {
+  std::vector<CatalogueRecord> records;
+  CatalogueRecord milk =
+      Item("0a1b2c3d-0000-4000-8000-00000000000a", "Молоко Галичина 2.5%");
+  milk.article = "0001";
+  milk.barcodes = "0482000000017,4820000000024,0000000000000000001";
+  milk.price = 42.9;
+  milk.has_parent = true;
+  milk.parent_guid = "f0000000-0000-4000-8000-000000000001";
+  records.push_back(milk);
+
+  CatalogueRecord milk2 =
+      Item("0a1b2c3d-0000-4000-8000-00000000000b", "Молоко Галичина 3.2%");
+  milk2.barcodes = "A-17,00012,,48200000000240000000";
+  milk2.price = -45.5;
+  milk2.created_at_us = 1709280900000001LL;
+  milk2.has_parent = true;
+  milk2.parent_guid = milk.parent_guid;
+  milk2.has_description = true;
+  milk2.description = "";
+  records.push_back(milk2);
+
+  CatalogueRecord folder =
+      Item("f0000000-0000-4000-8000-000000000001", "Молочні продукти");
+  folder.is_folder = true;
+  folder.created_at_us = -86400000000LL;
+  folder.has_description = true;
+  folder.description = "Охолоджені";
+  records.push_back(folder);
+
+  CatalogueRecord cheese = Item("CHEESE-1", "Сир кисломолочний");
+  cheese.unit_name = "кг";
+  cheese.unit_guid = "B1E1B2A4-0000-4000-8000-000000000002";
+  cheese.price = 189.995;
+  cheese.created_at_utc = false;
+  records.push_back(cheese);
+  return records;
+}
+
+void ExpectSame(const CatalogueRecord& a, const CatalogueRecord& b) {
+  EXPECT_EQ(a.guid, b.guid);
+  EXPECT_EQ(a.created_at_us, b.created_at_us);
+  EXPECT_EQ(a.created_at_utc, b.created_at_utc);
+  EXPECT_EQ(a.name, b.name);
+  EXPECT_EQ(a.article, b.article);
+  EXPECT_EQ(a.unit_name, b.unit_name);
+  EXPECT_EQ(a.unit_guid, b.unit_guid);
+  EXPECT_EQ(a.is_folder, b.is_folder);
+  EXPECT_EQ(a.has_parent, b.has_parent);
+  EXPECT_EQ(a.parent_guid, b.parent_guid);
+  EXPECT_EQ(a.has_description, b.has_description);
+  EXPECT_EQ(a.description, b.description);
+  EXPECT_EQ(a.barcodes, b.barcodes);
+  EXPECT_EQ(a.price, b.price);
+}
+
+// Каталог, схожий на справжній: блоки досить великі, щоб їх стиснув LZ.
+std::vector<CatalogueRecord> LargeCatalogue(size_t count) {
+  std::vector<CatalogueRecord> records;
+  for (size_t i = 0; i < count; i++) {
+    char guid[40];
+    std::snprintf(guid, sizeof(guid), "%08zx-1111-4000-8000-%012zx",
+                  i * 2654435761u % 0xFFFFFFFF, i);
+    CatalogueRecord r = Item(guid, "Товар " + std::to_string(i % 97) +
+                                       " фасування " + std::to_string(i));
+    r.article = std::to_string(100000 + i);
+    r.barcodes = "482" + std::to_string(1000000000 + i * 7);
+    r.price = static_cast<double>(i % 5000) / 100 + 1;
+    r.created_at_us += static_cast<int64_t>(i % 13) * 1000003 - 6000000;
+    r.has_parent = i % 3 != 0;
+    if (r.has_parent) {
+      r.parent_guid =
+          "f0000000-0000-4000-8000-00000000000" + std::to_string(i % 7);
+    }
+    records.push_back(r);
+  }
+  return records;
+}
+
+// Записи в порядку відображення (name, guid), як їх віддає декодер.
+std::vector<CatalogueRecord> InNameOrder(std::vector<CatalogueRecord> records) {
+  std::sort(records.begin(), records.end(),
+            [](const CatalogueRecord& a, const CatalogueRecord& b) {
+              return a.name != b.name ? a.name < b.name : a.guid < b.guid;
+            });
+  return records;
+}
+
+// Тіло пакета з новою контрольною сумою: перевіряє розбір далі за CRC.
+std::string Reseal(std::string body) {
+  const uint32_t crc = Crc32(body.data(), body.size());
+  for (int i = 0; i < 4; i++) body.push_back(static_cast<char>(crc >> (8 * i)));
+  return body;
+}
+
+TEST(CatalogueCodecTest, RoundTripsEveryField) {
+  const std::vector<CatalogueRecord> records = Records();
+  std::string pack;
+  EncodeCatalogue(records, &pack);
+  EXPECT_EQ(pack.substr(0, 4), "VKC1");
+
+  std::vector<CatalogueRecord> decoded;
+  std::string error;
+  ASSERT_TRUE(DecodeCatalogue(pack, &decoded, &error)) << error;
+  const std::vector<CatalogueRecord> expected = InNameOrder(records);
+  ASSERT_EQ(decoded.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    SCOPED_TRACE(expected[i].name);
+    ExpectSame(decoded[i], expected[i]);
+  }
+}
+
+TEST(CatalogueCodecTest, RoundTripsCompressedBlocks) {
+  const std::vector<CatalogueRecord> records = LargeCatalogue(5000);
+  std::string pack;
+  EncodeCatalogue(records, &pack);
+  size_t raw = 0;
+  for (const CatalogueRecord& r : records) {
+    raw += r.guid.size() + r.name.size() + r.article.size() +
+           r.barcodes.size() + r.parent_guid.size() + 8;
+  }
+  EXPECT_LT(pack.size(), raw / 3);
+
+  // Декодер дописує після наявних записів.
+  std::vector<CatalogueRecord> decoded = {Item("keep", "keep")};
+  std::string error;
+  ASSERT_TRUE(DecodeCatalogue(pack, &decoded, &error)) << error;
+  ASSERT_EQ(decoded.size(), records.size() + 1);
+  EXPECT_EQ(decoded[0].guid, "keep");
+  const std::vector<CatalogueRecord> expected = InNameOrder(records);
+  for (size_t i = 0; i < expected.size(); i++) {
+    ExpectSame(decoded[i + 1], expected[i]);
+    if (HasFailure()) FAIL() << "row " << i;
+  }
+
+  // Порожній каталог — теж коректний пакет.
+  pack.clear();
+  EncodeCatalogue({}, &pack);
+  std::vector<CatalogueRecord> none;
+  ASSERT_TRUE(DecodeCatalogue(pack, &none, &error)) << error;
+  EXPECT_TRUE(none.empty());
+}
+
+TEST(CatalogueCodecTest, RejectsTruncatedPack) {
+  std::string pack;
+  EncodeCatalogue(Records(), &pack);
+  std::vector<CatalogueRecord> decoded = {Item("keep", "keep")};
+  std::string error;
+  for (size_t size = 0; size < pack.size(); size++) {
+    EXPECT_FALSE(DecodeCatalogue(pack.substr(0, size), &decoded, &error))
+        << size;
+  }
+  // Обрізане тіло з правильною сумою (пакет зрізав сервер, а не мережа):
+  // розбір блоків не виходить за межі і нічого не дописує.
+  const std::string body = pack.substr(0, pack.size() - 4);
+  for (size_t size = 5; size < body.size(); size++) {
+    error.clear();
+    EXPECT_FALSE(DecodeCatalogue(Reseal(body.substr(0, size)), &decoded,
+                                 &error))
+        << size;
+    EXPECT_FALSE(error.empty()) << size;
+  }
+  ASSERT_EQ(decoded.size(), 1u);
+  EXPECT_EQ(decoded[0].guid, "keep");
+}
+
+TEST(CatalogueCodecTest, RejectsBadChecksum) {
+  std::string pack;
+  EncodeCatalogue(LargeCatalogue(300), &pack);
+  std::vector<CatalogueRecord> decoded;
+  std::string error;
+  for (size_t pos = 0; pos < pack.size(); pos += 7) {
+    std::string bad = pack;
+    bad[pos] ^= 0x10;
+    EXPECT_FALSE(DecodeCatalogue(bad, &decoded, &error)) << pos;
+  }
+  std::string bad = pack;
+  bad[pack.size() / 2] ^= 1;
+  ASSERT_FALSE(DecodeCatalogue(bad, &decoded, &error));
+  EXPECT_EQ(error, "Catalogue pack checksum mismatch");
+  EXPECT_TRUE(decoded.empty());
+
+  bad = pack;
+  bad[0] = 'X';
+  ASSERT_FALSE(DecodeCatalogue(bad, &decoded, &error));
+  EXPECT_EQ(error, "Not a catalogue pack");
+}
+
+TEST(CatalogueCodecTest, SkipsUnknownBlocks) {
+  const std::vector<CatalogueRecord> records = Records();
+  std::string pack;
+  EncodeCatalogue(records, &pack);
+  // Заголовок: "VKC1", версія, рядки (varint, 1 байт), блоки (1 байт).
+  std::string body = pack.substr(0, pack.size() - 4);
+  ASSERT_EQ(body[6], 10);
+  body[6] = 11;
+  body += std::string("\x63\x00\x03xyz", 6);
+  std::vector<CatalogueRecord> decoded;
+  std::string error;
+  ASSERT_TRUE(DecodeCatalogue(Reseal(body), &decoded, &error)) << error;
+  ASSERT_EQ(decoded.size(), records.size());
+  ExpectSame(decoded[0], InNameOrder(records)[0]);
+
+  // Зайві байти після блоків — помилка.
+  body[6] = 10;
+  ASSERT_FALSE(DecodeCatalogue(Reseal(body), &decoded, &error));
+  EXPECT_EQ(error, "Trailing data in catalogue pack");
+  EXPECT_EQ(decoded.size(), records.size());
+}
+
+TEST(CatalogueCodecTest, FormatsAndParsesTime) {
+  int64_t us = 0;
+  bool utc = false;
+  ASSERT_TRUE(ParseCatalogueTime("2024-03-01T08:15:00.000Z", &us, &utc));
+  EXPECT_EQ(us, 1709280900000000LL);
+  EXPECT_TRUE(utc);
+  EXPECT_EQ(FormatCatalogueTime(us, utc), "2024-03-01T08:15:00.000Z");
+
+  ASSERT_TRUE(ParseCatalogueTime("2024-03-01 10:15:00.1234567+02:00", &us,
+                                 &utc));
+  EXPECT_EQ(us, 1709280900123456LL);
+  EXPECT_EQ(FormatCatalogueTime(us, true), "2024-03-01T08:15:00.123456Z");
+
+  ASSERT_TRUE(ParseCatalogueTime("1969-12-31", &us, &utc));
+  EXPECT_FALSE(utc);
+  EXPECT_EQ(us, -86400000000LL);
+  EXPECT_EQ(FormatCatalogueTime(us, false), "1969-12-31T00:00:00.000");
+
+  for (const char* bad : {"2024-3-01", "2024-13-01", "2024-03-01T8:15",
+                          "2024-03-01T08:15:00.", "2024-03-01Q"}) {
+    EXPECT_FALSE(ParseCatalogueTime(bad, &us, &utc)) << bad;
+  }
+}
+
+}  // namespace
+}  // namespace virok
@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "catalogue/catalogue_codec.h"
+#include "catalogue/compact_catalogue.h"
+
+namespace virok {
+namespace {
+
+CatalogueRecord Item(const std::string& guid, const std::string& name) {
+  CatalogueRecord record;
+  record.guid = guid;
+  record.name = name;
+  record.created_at_us = 1709280900000000LL;
+  record.unit_name = "шт";
+  record.unit_guid = "b1e1b2a4-0000-4000-8000-000000000001";
+  return record;
+}
+
+std::vector<CatalogueRecord> Records() {
+  std::vector<CatalogueRecord> records;
+  CatalogueRecord milk =
+      Item("0a1b2c3d-0000-4000-8000-00000000000a", "Молоко Галичина 2.5%");
+  milk.article = "0001";
+  milk.barcodes = "0482000000017,4820000000024";
+  milk.price = 42.9;
+  milk.has_parent = true;
+  milk.parent_guid = "f0000000-0000-4000-8000-000000000001";
+  records.push_back(milk);
+
+  CatalogueRecord milk2 =
+      Item("0a1b2c3d-0000-4000-8000-00000000000b", "Молоко Галичина 3.2%");
+  milk2.barcodes = "A-17,00012";
+  milk2.price = 45.5;
+  milk2.has_parent = true;
+  milk2.parent_guid = milk.parent_guid;
+  milk2.has_description = true;
+  milk2.description = "";
+  records.push_back(milk2);
+
+  CatalogueRecord folder =
+      Item("f0000000-0000-4000-8000-000000000001", "Молочні продукти");
+  folder.is_folder = true;
+  folder.has_description = true;
+  folder.description = "Охолоджені";
+  records.push_back(folder);
+
+  // Неканонічний GUID і ціна з частками копійки лежать окремо.
+  CatalogueRecord cheese = Item("CHEESE-1", "Сир кисломолочний");
+  cheese.unit_name = "кг";
+  cheese.unit_guid = "b1e1b2a4-0000-4000-8000-000000000002";
+  cheese.price = 189.995;
+  cheese.created_at_utc = false;
+  records.push_back(cheese);
+  return records;
+}
+
+void ExpectSame(const CatalogueRecord& a, const CatalogueRecord& b) {
+  EXPECT_EQ(a.guid, b.guid);
+  EXPECT_EQ(a.created_at_us, b.created_at_us);
+  EXPECT_EQ(a.created_at_utc, b.created_at_utc);
+  EXPECT_EQ(a.name, b.name);
+  EXPECT_EQ(a.article, b.article);
+  EXPECT_EQ(a.unit_name, b.unit_name);
+  EXPECT_EQ(a.unit_guid, b.unit_guid);
+  EXPECT_EQ(a.is_folder, b.is_folder);
+  EXPECT_EQ(a.has_parent, b.has_parent);
+  EXPECT_EQ(a.parent_guid, b.parent_guid);
+  EXPECT_EQ(a.has_description, b.has_description);
+  EXPECT_EQ(a.description, b.description);
+  EXPECT_EQ(a.barcodes, b.barcodes);
+  EXPECT_EQ(a.price, b.price);
+}
+
+TEST(CompactCatalogueTest, KeepsEveryFieldInNameOrder) {
+  const std::vector<CatalogueRecord> records = Records();
+  CompactCatalogue::Builder builder;
+  for (const CatalogueRecord& record : records) {
+    ASSERT_TRUE(builder.Add(record));
+  }
+  const std::unique_ptr<CompactCatalogue> catalogue = builder.Finish();
+  ASSERT_EQ(catalogue->size(), 4u);
+
+  // ORDER BY name: Молоко 2.5%, Молоко 3.2%, Молочні, Сир.
+  ExpectSame(catalogue->Record(0), records[0]);
+  ExpectSame(catalogue->Record(1), records[1]);
+  ExpectSame(catalogue->Record(2), records[2]);
+  ExpectSame(catalogue->Record(3), records[3]);
+
+  EXPECT_EQ(catalogue->name(1), "Молоко Галичина 3.2%");
+  EXPECT_EQ(catalogue->barcodes(1), "A-17,00012");
+  std::string_view text;
+  EXPECT_TRUE(catalogue->description(1, &text));
+  EXPECT_TRUE(text.empty());
+  EXPECT_FALSE(catalogue->description(0, &text));
+  EXPECT_FALSE(catalogue->parent_guid(2, &text));
+  EXPECT_EQ(catalogue->unit_name(3), "кг");
+  EXPECT_EQ(catalogue->search_name(0), CatalogueSearchName(records[0]));
+
+  const CompactCatalogueStats stats = catalogue->stats();
+  EXPECT_EQ(stats.units, 2u);
+  EXPECT_EQ(stats.parents, 1u);
+  EXPECT_EQ(stats.text_guids, 1u);
+}
+
+TEST(CompactCatalogueTest, FindsByGuid) {
+  CompactCatalogue::Builder builder;
+  for (const CatalogueRecord& record : Records()) builder.Add(record);
+  // Справжній нульовий GUID поруч із неканонічним (той теж 16 нулів).
+  builder.Add(Item("00000000-0000-0000-0000-000000000000", "Аааа"));
+  const std::unique_ptr<CompactCatalogue> catalogue = builder.Finish();
+
+  EXPECT_EQ(catalogue->FindByGuid("0a1b2c3d-0000-4000-8000-00000000000b"),
+            2u);
+  EXPECT_EQ(catalogue->FindByGuid("CHEESE-1"), 4u);
+  EXPECT_EQ(catalogue->FindByGuid("00000000-0000-0000-0000-000000000000"),
+            0u);
+  EXPECT_EQ(catalogue->FindByGuid("0a1b2c3d-0000-4000-8000-00000000000c"),
+            CompactCatalogue::kNoRow);
+  EXPECT_EQ(catalogue->FindByGuid("cheese-1"), CompactCatalogue::kNoRow);
+}
+
+TEST(CompactCatalogueTest, DecodesNamesAcrossBlocks) {
+  CompactCatalogue::Builder builder;
+  std::vector<std::string> names;
+  for (int i = 0; i < 100; i++) {
+    char guid[37];
+    std::snprintf(guid, sizeof(guid), "00000000-0000-4000-8000-%012d", i);
+    names.push_back("Товар " + std::to_string(1000 + i * 7 % 100));
+    builder.Add(Item(guid, names.back()));
+  }
+  const std::unique_ptr<CompactCatalogue> catalogue = builder.Finish();
+  std::sort(names.begin(), names.end());
+  for (uint32_t row = 0; row < catalogue->size(); row++) {
+    EXPECT_EQ(catalogue->name(row), names[row]) << row;
+  }
+}
+
+}  // namespace
+}  // namespace virok
@@ -0,0 +1,231 @@
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "fiscal/fiscal_host.h"
+
+namespace virok {
+namespace {
+
+namespace fs = std::filesystem;
+
+const char kFiscalNum[] = "4000000001";
+
+// Хост — fiscal_host_test_host; його пристрій пише кожен виклик у журнал,
+// тож тест бачить, скільки разів запит дійшов до "DLL" через перезапуски.
+class FiscalHostTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir_ = fs::temp_directory_path() /
+           ("virok_fiscal_host_test_" +
+            std::string(::testing::UnitTest::GetInstance()
+                            ->current_test_info()
+                            ->name()));
+    std::error_code ec;
+    fs::remove_all(dir_, ec);
+    fs::create_directories(dir_);
+  }
+
+  void TearDown() override {
+    std::error_code ec;
+    fs::remove_all(dir_, ec);
+  }
+
+  FiscalHostOptions Options() const {
+    FiscalHostOptions options;
+    options.executable = VIROK_TEST_FISCAL_HOST;
+    options.extra_args = {(dir_ / "device.log").string()};
+    return options;
+  }
+
+  // Виклики, що дійшли до пристрою: "<метод> <tag>".
+  std::vector<std::string> Journal() const {
+    std::ifstream in(dir_ / "device.log");
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(in, line);) lines.push_back(line);
+    return lines;
+  }
+
+  fs::path dir_;
+};
+
+// Відповіді конвеєра в порядку надходження.
+struct Replies {
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<std::pair<int, FiscalReply>> got;
+
+  FiscalCallback Collect(int n) {
+    return [this, n](FiscalReply reply) {
+      std::lock_guard<std::mutex> lock(mutex);
+      got.emplace_back(n, std::move(reply));
+      cv.notify_all();
+    };
+  }
+
+  bool WaitFor(size_t count) {
+    std::unique_lock<std::mutex> lock(mutex);
+    return cv.wait_for(lock, std::chrono::seconds(30),
+                       [&] { return got.size() >= count; });
+  }
+};
+
+TEST_F(FiscalHostTest, FramesArgumentsAndErrors) {
+  FiscalHostOptions options = Options();
+  options.ring_capacity = 64 << 10;
+  FiscalHostClient client(kFiscalNum, options);
+  ASSERT_TRUE(client.Start());
+
+  const std::string binary =
+      std::string("jsonGoods\0", 10) + "{\"Name\":\"Хліб\"}\xFF";
+  FiscalReply reply = client.Call(
+      "fiscalizeCheck",
+      {{"echo", binary}, {"", "empty key"}, {"empty", ""}, {"tag", "a"}});
+  EXPECT_TRUE(reply.success);
+  EXPECT_EQ(reply.json_val, binary);
+  EXPECT_TRUE(reply.error.empty());
+
+  reply = client.Call("printXReport", {{"fail", "Зміну не відкрито"}});
+  EXPECT_FALSE(reply.success);
+  EXPECT_EQ(reply.error, "Зміну не відкрито");
+
+  // Більше половини кільця не вміщується: помилка без виклику пристрою,
+  // хост живий.
+  reply = client.Call("fiscalizeCheck",
+                      {{"echo", std::string(40 << 10, 'x')}, {"tag", "big"}});
+  EXPECT_FALSE(reply.success);
+  EXPECT_NE(reply.error.find("too large"), std::string::npos);
+  reply = client.Call("getVersion", {{"echo", std::string(30 << 10, 'y')}});
+  EXPECT_TRUE(reply.success);
+  EXPECT_EQ(reply.json_val.size(), size_t{30 << 10});
+
+  // Помилку розміру колбек отримує поза м'ютексом клієнта: з нього можна
+  // одразу надіслати наступний запит.
+  Replies replies;
+  client.Submit("fiscalizeCheck", {{"echo", std::string(40 << 10, 'x')}},
+                [&](FiscalReply r) {
+                  replies.Collect(0)(std::move(r));
+                  client.Submit("getVersion", {}, replies.Collect(1));
+                });
+  ASSERT_TRUE(replies.WaitFor(2));
+  EXPECT_FALSE(replies.got[0].second.success);
+  EXPECT_TRUE(replies.got[1].second.success);
+
+  EXPECT_EQ(Journal(),
+            (std::vector<std::string>{"fiscalizeCheck a", "printXReport ",
+                                      "getVersion ", "getVersion "}));
+  EXPECT_EQ(client.restarts(), 0);
+}
+
+TEST_F(FiscalHostTest, PipelinesCallsInOrder) {
+  FiscalHostOptions options = Options();
+  // Кільце на кілька запитів: решту допише сторож, коли хост звільнить
+  // місце.
+  options.ring_capacity = 4 << 10;
+  FiscalHostClient client(kFiscalNum, options);
+  ASSERT_TRUE(client.Start());
+
+  constexpr int kCalls = 300;
+  Replies replies;
+  for (int i = 0; i < kCalls; i++) {
+    client.Submit("getCurrentStatus",
+                  {{"tag", std::to_string(i)}, {"echo", std::to_string(i)}},
+                  replies.Collect(i));
+  }
+  ASSERT_TRUE(replies.WaitFor(kCalls));
+  const std::vector<std::string> journal = Journal();
+  ASSERT_EQ(journal.size(), size_t{kCalls});
+  for (int i = 0; i < kCalls; i++) {
+    EXPECT_EQ(replies.got[i].first, i);
+    EXPECT_EQ(replies.got[i].second.json_val, std::to_string(i));
+    EXPECT_EQ(journal[i], "getCurrentStatus " + std::to_string(i));
+  }
+}
+
+TEST_F(FiscalHostTest, ReplaysUnstartedAndSafeCallsAfterCrash) {
+  FiscalHostOptions options = Options();
+  options.startup_calls = [] {
+    return std::vector<std::pair<std::string, FiscalArgs>>{
+        {"setParameter", {{"tag", "startup"}}}};
+  };
+  FiscalHostClient client(kFiscalNum, options);
+  ASSERT_TRUE(client.Start());
+
+  // Хост падає посеред getCurrentStatus (його можна повторити); чек за ним
+  // ще в кільці — пристрій його не бачив.
+  Replies replies;
+  client.Submit("getCurrentStatus", {{"tag", "status"}, {"crash", "once"}},
+                replies.Collect(0));
+  client.Submit("fiscalizeCheck", {{"tag", "check"}}, replies.Collect(1));
+  ASSERT_TRUE(replies.WaitFor(2));
+
+  ASSERT_EQ(replies.got.size(), 2u);
+  EXPECT_EQ(replies.got[0].first, 0);
+  EXPECT_TRUE(replies.got[0].second.success) << replies.got[0].second.error;
+  EXPECT_EQ(replies.got[1].first, 1);
+  EXPECT_TRUE(replies.got[1].second.success) << replies.got[1].second.error;
+  EXPECT_EQ(client.restarts(), 1);
+  // Налаштування — першими після перезапуску; чек — рівно один раз.
+  EXPECT_EQ(Journal(), (std::vector<std::string>{
+                           "setParameter startup", "getCurrentStatus status",
+                           "setParameter startup", "getCurrentStatus status",
+                           "fiscalizeCheck check"}));
+}
+
+TEST_F(FiscalHostTest, DoesNotReplayStartedFiscalization) {
+  FiscalHostClient client(kFiscalNum, Options());
+  ASSERT_TRUE(client.Start());
+
+  // Перший чек хост встигає провести; другий падає всередині DLL — чек
+  // міг бути фіскалізований, повтор дав би дубль.
+  Replies replies;
+  client.Submit("fiscalizeCheck", {{"tag", "first"}}, replies.Collect(0));
+  client.Submit("fiscalizeCheck", {{"tag", "second"}, {"crash", "always"}},
+                replies.Collect(1));
+  ASSERT_TRUE(replies.WaitFor(2));
+
+  EXPECT_TRUE(replies.got[0].second.success);
+  EXPECT_FALSE(replies.got[1].second.success);
+  EXPECT_NE(replies.got[1].second.error.find("check device state"),
+            std::string::npos)
+      << replies.got[1].second.error;
+
+  // Новий хост працює; жоден чек не пройшов двічі.
+  const FiscalReply status = client.Call("getCurrentStatus", {{"tag", "s"}});
+  EXPECT_TRUE(status.success) << status.error;
+  EXPECT_EQ(client.restarts(), 1);
+  EXPECT_EQ(Journal(), (std::vector<std::string>{"fiscalizeCheck first",
+                                                 "fiscalizeCheck second",
+                                                 "getCurrentStatus s"}));
+}
+
+TEST_F(FiscalHostTest, RestartsHostStuckInCall) {
+  FiscalHostOptions options = Options();
+  options.call_timeout = std::chrono::milliseconds(300);
+  FiscalHostClient client(kFiscalNum, options);
+  ASSERT_TRUE(client.Start());
+  const int first_pid = client.host_pid();
+
+  const auto start = std::chrono::steady_clock::now();
+  const FiscalReply stuck = client.Call(
+      "payByPaymentCard", {{"tag", "card"}, {"sleep_ms", "60000"}});
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(30));
+  EXPECT_FALSE(stuck.success);
+  EXPECT_NE(stuck.error.find("timed out"), std::string::npos) << stuck.error;
+
+  const FiscalReply status = client.Call("getCurrentStatus", {{"tag", "s"}});
+  EXPECT_TRUE(status.success) << status.error;
+  EXPECT_NE(client.host_pid(), first_pid);
+  EXPECT_EQ(Journal(), (std::vector<std::string>{"payByPaymentCard card",
+                                                 "getCurrentStatus s"}));
+}
+
+}  // namespace
+}  // namespace virok
@@ -0,0 +1,80 @@
+// Процес-хост для fiscal_host_test: пристрій пише кожен виклик у журнал
+// (щоб тест бачив, скільки разів виклик дійшов до "DLL") і на вимогу
+// падає посеред виклику, як DLL постачальника.
+//
+//   fiscal_host_test_host --fiscal-host <область> <номер> <журнал>
+//
+// Аргументи виклику:
+//   tag      — мітка рядка журналу;
+//   sleep_ms — затримка виклику;
+//   crash    — "always": процес завершується після запису в журнал,
+//              "once": лише перший раз (мітка — файл <журнал>.crashed);
+//   echo     — повертається як jsonVal (перевірка кодування);
+//   fail     — повертається як помилка.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "fiscal/fiscal_device.h"
+#include "fiscal/fiscal_host.h"
+
+namespace {
+
+std::string g_log;
+
+std::string Arg(const virok::FiscalArgs& args, const char* key) {
+  const auto it = args.find(key);
+  return it == args.end() ? std::string() : it->second;
+}
+
+class JournalDevice : public virok::FiscalDevice {
+ public:
+  virok::FiscalReply Call(const std::string& method,
+                          const virok::FiscalArgs& args) override {
+    if (FILE* log = std::fopen(g_log.c_str(), "a")) {
+      std::fprintf(log, "%s %s\n", method.c_str(), Arg(args, "tag").c_str());
+      std::fclose(log);
+    }
+    const std::string sleep_ms = Arg(args, "sleep_ms");
+    if (!sleep_ms.empty()) {
+      std::this_thread::sleep_for(
+          std::chrono::milliseconds(std::atoi(sleep_ms.c_str())));
+    }
+    const std::string crash = Arg(args, "crash");
+    if (crash == "always") std::_Exit(3);
+    if (crash == "once") {
+      const std::string marker = g_log + ".crashed";
+      if (FILE* f = std::fopen(marker.c_str(), "r")) {
+        std::fclose(f);
+      } else if (FILE* created = std::fopen(marker.c_str(), "w")) {
+        std::fclose(created);
+        std::_Exit(3);
+      }
+    }
+
+    virok::FiscalReply reply;
+    reply.error = Arg(args, "fail");
+    reply.success = reply.error.empty();
+    reply.json_val = args.count("echo") ? Arg(args, "echo") : method;
+    return reply;
+  }
+};
+
+std::unique_ptr<virok::FiscalDevice> MakeDevice(const std::string&) {
+  return std::make_unique<JournalDevice>();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 5 || std::strcmp(argv[1], virok::kFiscalHostFlag) != 0) {
+    return 64;
+  }
+  g_log = argv[4];
+  return virok::RunFiscalHost(argv[2], argv[3], MakeDevice);
+}
@@ -0,0 +1,377 @@
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "fiscal/fiscal_session_pool.h"
+#include "fiscal/simulated_fiscal_device.h"
+
+namespace virok {
+namespace {
+
+using std::chrono::milliseconds;
+
+constexpr char kGoods[] =
+    "{\"ReceiptLst\":[{\"Name\":\"Молоко 2,5%\",\"Quantity\":1,"
+    "\"Price\":\"42,50\",\"Amount\":\"42,50\"}]}";
+
+// Пристрій, що записує, в якому потоці й у якому порядку його викликали,
+// і ловить паралельні виклики одного пристрою.
+class RecordingDevice : public FiscalDevice {
+ public:
+  struct Shared {
+    std::atomic<int> created{0};
+    std::atomic<int> destroyed{0};
+    std::atomic<int> overlaps{0};
+  };
+
+  RecordingDevice(Shared* shared, milliseconds delay)
+      : shared_(shared), delay_(delay), owner_(std::this_thread::get_id()) {
+    shared_->created++;
+  }
+  ~RecordingDevice() override {
+    EXPECT_EQ(owner_, std::this_thread::get_id());
+    shared_->destroyed++;
+  }
+
+  FiscalReply Call(const std::string& method,
+                   const FiscalArgs& args) override {
+    EXPECT_EQ(owner_, std::this_thread::get_id());
+    if (busy_.exchange(true)) shared_->overlaps++;
+    std::this_thread::sleep_for(delay_);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      const auto seq = args.find("seq");
+      if (seq != args.end()) order_.push_back(std::stoi(seq->second));
+    }
+    busy_ = false;
+    FiscalReply reply;
+    reply.success = true;
+    reply.json_val = method;
+    return reply;
+  }
+
+  std::vector<int> order() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return order_;
+  }
+
+ private:
+  Shared* shared_;
+  const milliseconds delay_;
+  const std::thread::id owner_;
+  std::atomic<bool> busy_{false};
+  std::mutex mutex_;
+  std::vector<int> order_;
+};
+
+// Лічильник відповідей, на який можна чекати з тесту.
+class Replies {
+ public:
+  FiscalCallback Add(std::vector<std::string>* log = nullptr,
+                     std::string tag = std::string()) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_++;
+    return [this, log, tag](FiscalReply reply) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (reply.success) ok_++;
+      if (!reply.error.empty()) errors_.push_back(reply.error);
+      if (log) log->push_back(tag);
+      pending_--;
+      done_.notify_all();
+    };
+  }
+
+  void Wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return pending_ == 0; });
+  }
+
+  int ok() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return ok_;
+  }
+  std::vector<std::string> errors() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return errors_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable done_;
+  int pending_ = 0;
+  int ok_ = 0;
+  std::vector<std::string> errors_;
+};
+
+TEST(FiscalSessionPoolTest, DevicesRunInParallel) {
+  constexpr int kDevices = 4;
+  constexpr int kCalls = 5;
+  SimulatedFiscalDevice::Options device_options;
+  device_options.fiscal.base_ms = 20;
+  device_options.fiscal.jitter = 0;
+  device_options.fiscal.tail_rate = 0;
+
+  FiscalSessionPool pool([&](const std::string&) {
+    return std::make_unique<SimulatedFiscalDevice>(device_options);
+  });
+
+  Replies replies;
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kCalls; i++) {
+    for (int d = 0; d < kDevices; d++) {
+      ASSERT_TRUE(pool.Submit("400000000" + std::to_string(d),
+                              "fiscalizeCheck", {{"jsonGoods", kGoods}},
+                              replies.Add()));
+    }
+  }
+  replies.Wait();
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  EXPECT_EQ(replies.ok(), kDevices * kCalls);
+  EXPECT_EQ(pool.Sessions().size(), static_cast<size_t>(kDevices));
+  // Послідовно це 4 * 5 * 20 мс = 400 мс; паралельно — близько 100 мс.
+  EXPECT_LT(elapsed, milliseconds(kDevices * kCalls * 20 / 2));
+}
+
+TEST(FiscalSessionPoolTest, KeepsOrderAndThreadPerDevice) {
+  RecordingDevice::Shared shared;
+  std::mutex devices_mutex;
+  std::map<std::string, RecordingDevice*> devices;
+
+  FiscalSessionOptions options;
+  options.idle_timeout = std::chrono::minutes(1);
+  options.max_queue = 1000;
+  {
+    FiscalSessionPool pool(
+        [&](const std::string& num) {
+          auto device =
+              std::make_unique<RecordingDevice>(&shared, milliseconds(0));
+          std::lock_guard<std::mutex> lock(devices_mutex);
+          devices[num] = device.get();
+          return device;
+        },
+        options);
+
+    // Кілька потоків пишуть у ті самі сесії; кожен потік — власна
+    // послідовність номерів, тож порядок перевіряється в межах потоку.
+    Replies replies;
+    std::vector<std::thread> submitters;
+    for (int t = 0; t < 4; t++) {
+      submitters.emplace_back([&, t] {
+        for (int i = 0; i < 100; i++) {
+          pool.Submit("fn" + std::to_string(i % 3), "getCurrentStatus",
+                      {{"seq", std::to_string(t * 1000 + i)}}, replies.Add());
+        }
+      });
+    }
+    for (auto& thread : submitters) thread.join();
+    replies.Wait();
+    EXPECT_EQ(replies.ok(), 400);
+
+    for (const auto& entry : devices) {
+      int last[4] = {-1, -1, -1, -1};
+      for (int seq : entry.second->order()) {
+        EXPECT_GT(seq % 1000, last[seq / 1000]) << entry.first;
+        last[seq / 1000] = seq % 1000;
+      }
+    }
+  }
+  EXPECT_EQ(shared.created.load(), 3);
+  EXPECT_EQ(shared.destroyed.load(), 3);
+  EXPECT_EQ(shared.overlaps.load(), 0);
+}
+
+TEST(FiscalSessionPoolTest, FairGateDoesNotStarveQuietDevice) {
+  RecordingDevice::Shared shared;
+  FiscalSessionOptions options;
+  options.max_concurrent = 1;
+  FiscalSessionPool pool(
+      [&](const std::string&) {
+        return std::make_unique<RecordingDevice>(&shared, milliseconds(5));
+      },
+      options);
+
+  Replies replies;
+  std::vector<std::string> log;
+  for (int i = 0; i < 20; i++) {
+    pool.Submit("busy", "fiscalizeCheck", {}, replies.Add(&log, "busy"));
+  }
+  std::this_thread::sleep_for(milliseconds(12));
+  pool.Submit("quiet", "printXReport", {}, replies.Add(&log, "quiet"));
+  replies.Wait();
+
+  // Без черги квитків "busy" захоплював би слот знову й знову.
+  size_t position = 0;
+  while (position < log.size() && log[position] != "quiet") position++;
+  EXPECT_LE(position, 5u);
+}
+
+TEST(FiscalSessionPoolTest, EvictsIdleSession) {
+  RecordingDevice::Shared shared;
+  std::atomic<int> thread_starts{0};
+  std::atomic<int> thread_exits{0};
+  FiscalSessionOptions options;
+  options.idle_timeout = milliseconds(30);
+  options.on_thread_start = [&] { thread_starts++; };
+  options.on_thread_exit = [&] {
+    // Пристрій уже знищено — CoUninitialize після Release.
+    EXPECT_EQ(shared.destroyed.load(), thread_starts.load());
+    thread_exits++;
+  };
+  FiscalSessionPool pool(
+      [&](const std::string&) {
+        return std::make_unique<RecordingDevice>(&shared, milliseconds(0));
+      },
+      options);
+
+  EXPECT_TRUE(pool.Call("fn1", "getCurrentStatus", {}).success);
+  EXPECT_EQ(pool.Sessions(), std::vector<std::string>{"fn1"});
+
+  for (int i = 0; i < 200 && !pool.Sessions().empty(); i++) {
+    std::this_thread::sleep_for(milliseconds(5));
+  }
+  EXPECT_TRUE(pool.Sessions().empty());
+  for (int i = 0; i < 200 && thread_exits.load() == 0; i++) {
+    std::this_thread::sleep_for(milliseconds(5));
+  }
+  EXPECT_EQ(shared.destroyed.load(), 1);
+
+  // Наступний виклик відкриває сесію заново з новим пристроєм.
+  EXPECT_TRUE(pool.Call("fn1", "getCurrentStatus", {}).success);
+  EXPECT_EQ(shared.created.load(), 2);
+  EXPECT_EQ(thread_starts.load(), 2);
+}
+
+// Пристрій, що тримає виклик, доки тест не відпустить.
+class BlockingDevice : public FiscalDevice {
+ public:
+  explicit BlockingDevice(std::atomic<bool>* release,
+                          std::atomic<int>* entered = nullptr)
+      : release_(release), entered_(entered) {}
+
+  FiscalReply Call(const std::string&, const FiscalArgs&) override {
+    if (entered_) (*entered_)++;
+    while (!release_->load()) std::this_thread::sleep_for(milliseconds(1));
+    FiscalReply reply;
+    reply.success = true;
+    return reply;
+  }
+
+ private:
+  std::atomic<bool>* release_;
+  std::atomic<int>* entered_;
+};
+
+TEST(FiscalSessionPoolTest, RejectsWhenQueueIsFull) {
+  std::atomic<bool> release{false};
+  std::atomic<int> entered{0};
+  FiscalSessionOptions options;
+  options.max_queue = 2;
+  FiscalSessionPool pool(
+      [&](const std::string&) {
+        return std::make_unique<BlockingDevice>(&release, &entered);
+      },
+      options);
+
+  Replies replies;
+  EXPECT_TRUE(pool.Submit("fn1", "a", {}, replies.Add()));
+  while (entered.load() == 0) std::this_thread::sleep_for(milliseconds(1));
+  // "a" виконується, у черзі лишається місце на два.
+  EXPECT_TRUE(pool.Submit("fn1", "b", {}, replies.Add()));
+  EXPECT_TRUE(pool.Submit("fn1", "c", {}, replies.Add()));
+  EXPECT_FALSE(pool.Submit("fn1", "d", {}, replies.Add()));
+  // Інший пристрій має власну чергу.
+  EXPECT_TRUE(pool.Submit("fn2", "a", {}, replies.Add()));
+
+  release = true;
+  replies.Wait();
+  EXPECT_EQ(replies.ok(), 4);
+  EXPECT_EQ(replies.errors(), std::vector<std::string>{
+                                  "Fiscal device queue is full"});
+}
+
+TEST(FiscalSessionPoolTest, ClosingCancelsQueuedCalls) {
+  std::atomic<bool> release{false};
+  std::atomic<int> entered{0};
+  Replies replies;
+  std::thread releaser;
+  {
+    FiscalSessionPool pool([&](const std::string&) {
+      return std::make_unique<BlockingDevice>(&release, &entered);
+    });
+    for (int i = 0; i < 5; i++) pool.Submit("fn1", "a", {}, replies.Add());
+    while (entered.load() == 0) std::this_thread::sleep_for(milliseconds(1));
+    releaser = std::thread([&] {
+      std::this_thread::sleep_for(milliseconds(20));
+      release = true;
+    });
+    // Деструктор чекає поточний виклик і скасовує решту черги.
+  }
+  releaser.join();
+  replies.Wait();
+  EXPECT_EQ(replies.ok(), 1);
+  EXPECT_EQ(replies.errors(),
+            std::vector<std::string>(4, "Fiscal session is closed"));
+}
+
+// Кілька симульованих ПРРО, кілька потоків-кас і коротке вікно простою,
+// щоб сесії закривалися й відкривалися просто під навантаженням.
+TEST(FiscalSessionPoolTest, StressWithSimulatedDevices) {
+  constexpr int kDevices = 6;
+  constexpr int kLanes = 4;
+  constexpr int kCallsPerLane = 150;
+  static const char* const kMethods[] = {"fiscalizeCheck", "getCurrentStatus",
+                                         "printXReport", "payByPaymentCard"};
+
+  std::atomic<int> created{0};
+  FiscalSessionOptions options;
+  options.idle_timeout = milliseconds(2);
+  options.max_queue = kLanes * kCallsPerLane;
+  options.max_concurrent = kDevices / 2;
+
+  Replies replies;
+  {
+    FiscalSessionPool pool(
+        [&](const std::string& num) {
+          SimulatedFiscalDevice::Options device_options;
+          device_options.fiscal.base_ms = 0.2;
+          device_options.card.base_ms = 0.3;
+          device_options.seed = std::hash<std::string>()(num) + created++;
+          return std::make_unique<SimulatedFiscalDevice>(device_options);
+        },
+        options);
+
+    std::vector<std::thread> lanes;
+    for (int lane = 0; lane < kLanes; lane++) {
+      lanes.emplace_back([&, lane] {
+        uint32_t state = 7919u * (lane + 1);
+        for (int i = 0; i < kCallsPerLane; i++) {
+          state = state * 1103515245 + 12345;
+          const int device = (state >> 16) % kDevices;
+          const char* method = kMethods[(state >> 8) % 4];
+          pool.Submit("fn" + std::to_string(device), method,
+                      {{"jsonGoods", kGoods}, {"amount", "42,50"}},
+                      replies.Add());
+          if (i % 25 == 0) std::this_thread::sleep_for(milliseconds(3));
+        }
+      });
+    }
+    for (auto& lane : lanes) lane.join();
+    replies.Wait();
+  }
+
+  EXPECT_TRUE(replies.errors().empty());
+  EXPECT_EQ(replies.ok(), kLanes * kCallsPerLane);
+  EXPECT_GE(created.load(), kDevices);
+}
+
+}  // namespace
+}  // namespace virok
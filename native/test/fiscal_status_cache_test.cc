@@ -0,0 +1,206 @@
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "fiscal/fiscal_status_cache.h"
+
+namespace virok {
+namespace {
+
+const char kFiscalNum[] = "4000000001";
+
+FiscalReply Reply(const std::string& json) {
+  FiscalReply reply;
+  reply.success = true;
+  reply.json_val = json;
+  return reply;
+}
+
+FiscalReply DeviceError(const std::string& error) {
+  FiscalReply reply;
+  reply.error = error;
+  return reply;
+}
+
+// getCurrentStatus, на який тест відповідає сам, коли захоче: так видно,
+// скільки запитів кеш відправив і що з ними в польоті.
+struct Device {
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<FiscalCallback> pending;
+  int calls = 0;
+
+  FiscalStatusFetch Fetch() {
+    return [this](const std::string&, FiscalCallback done) {
+      std::lock_guard<std::mutex> lock(mutex);
+      pending.push_back(std::move(done));
+      calls++;
+      cv.notify_all();
+    };
+  }
+
+  bool WaitCalls(int count) {
+    std::unique_lock<std::mutex> lock(mutex);
+    return cv.wait_for(lock, std::chrono::seconds(10),
+                       [&] { return calls >= count; });
+  }
+
+  int Calls() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return calls;
+  }
+
+  // Відповідає на найстаріший запит у польоті.
+  void Answer(const FiscalReply& reply) {
+    FiscalCallback done;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      ASSERT_FALSE(pending.empty());
+      done = std::move(pending.front());
+      pending.erase(pending.begin());
+    }
+    done(reply);
+  }
+};
+
+// Події слухача.
+struct Events {
+  std::mutex mutex;
+  std::vector<FiscalStatus> got;
+
+  FiscalStatusListener Listener() {
+    return [this](const std::string&, const FiscalStatus& status) {
+      std::lock_guard<std::mutex> lock(mutex);
+      got.push_back(status);
+    };
+  }
+
+  FiscalStatus Last() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return got.empty() ? FiscalStatus() : got.back();
+  }
+
+  size_t Count() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return got.size();
+  }
+};
+
+// Фонове оновлення за таймером не заважає: лише за інвалідацією.
+FiscalStatusOptions Options() {
+  FiscalStatusOptions options;
+  options.refresh_interval = std::chrono::hours(1);
+  return options;
+}
+
+// Чек змінює стан ПРРО: кеш одразу перестає його віддавати, слухач
+// дізнається про це, а свіжий стан запитується без чекання таймера.
+TEST(FiscalStatusCacheTest, InvalidatesAfterFiscalWrite) {
+  Device device;
+  Events events;
+  FiscalStatusCache cache(device.Fetch(), events.Listener(), Options());
+
+  cache.Store(kFiscalNum, Reply("{\"checks\":0}"));
+  FiscalStatus status;
+  ASSERT_TRUE(cache.Get(kFiscalNum, &status));
+  EXPECT_EQ(status.reply.json_val, "{\"checks\":0}");
+  EXPECT_EQ(events.Count(), 1u);
+
+  // Звіт стан не змінює.
+  cache.Observe(kFiscalNum, "printXReport");
+  EXPECT_TRUE(cache.Get(kFiscalNum, &status));
+
+  cache.Observe(kFiscalNum, "fiscalizeCheck");
+  EXPECT_FALSE(cache.Get(kFiscalNum, &status));
+  EXPECT_EQ(events.Count(), 2u);
+  EXPECT_TRUE(events.Last().stale);
+
+  ASSERT_TRUE(device.WaitCalls(1));
+  device.Answer(Reply("{\"checks\":1}"));
+  ASSERT_TRUE(cache.Get(kFiscalNum, &status));
+  EXPECT_EQ(status.reply.json_val, "{\"checks\":1}");
+  EXPECT_FALSE(status.stale);
+  EXPECT_FALSE(events.Last().stale);
+  EXPECT_EQ(events.Last().reply.json_val, "{\"checks\":1}");
+  EXPECT_EQ(device.Calls(), 1);
+}
+
+// Поки оновлення в польоті, інвалідації і звернення з інших потоків не
+// множать запити: відповідь, що пішла до них, стара — тож рівно ще один.
+TEST(FiscalStatusCacheTest, SharesInFlightRefresh) {
+  Device device;
+  Events events;
+  FiscalStatusCache cache(device.Fetch(), events.Listener(), Options());
+
+  cache.Store(kFiscalNum, Reply("{\"checks\":0}"));
+  cache.Invalidate(kFiscalNum);
+  ASSERT_TRUE(device.WaitCalls(1));
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; t++) {
+    threads.emplace_back([&cache] {
+      FiscalStatus status;
+      for (int i = 0; i < 50; i++) {
+        cache.Observe(kFiscalNum, "fiscalizeCheck");
+        cache.Invalidate(kFiscalNum);
+        EXPECT_FALSE(cache.Get(kFiscalNum, &status));
+      }
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+  EXPECT_EQ(device.Calls(), 1);
+
+  device.Answer(Reply("{\"checks\":1}"));
+  FiscalStatus status;
+  EXPECT_FALSE(cache.Get(kFiscalNum, &status));
+  ASSERT_TRUE(device.WaitCalls(2));
+  device.Answer(Reply("{\"checks\":9}"));
+  ASSERT_TRUE(cache.Get(kFiscalNum, &status));
+  EXPECT_EQ(status.reply.json_val, "{\"checks\":9}");
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(device.Calls(), 2);
+}
+
+// Помилка пристрою не затирає успішний стан: без змін стану він
+// віддається далі. Застарілий лишається застарілим, а без успішного
+// стану слухач бачить саму помилку.
+TEST(FiscalStatusCacheTest, ServesLastGoodStatusAfterDeviceError) {
+  Device device;
+  Events events;
+  FiscalStatusCache cache(device.Fetch(), events.Listener(), Options());
+
+  cache.Store(kFiscalNum, Reply("{\"checks\":3}"));
+  cache.Store(kFiscalNum, DeviceError("COM port is busy"));
+  FiscalStatus status;
+  ASSERT_TRUE(cache.Get(kFiscalNum, &status));
+  EXPECT_EQ(status.reply.json_val, "{\"checks\":3}");
+  EXPECT_EQ(events.Count(), 1u);
+
+  cache.Invalidate(kFiscalNum);
+  ASSERT_TRUE(device.WaitCalls(1));
+  device.Answer(DeviceError("No connection to the fiscal device"));
+  EXPECT_FALSE(cache.Get(kFiscalNum, &status));
+  EXPECT_TRUE(events.Last().stale);
+  EXPECT_EQ(events.Last().reply.json_val, "{\"checks\":3}");
+
+  cache.Invalidate(kFiscalNum);
+  ASSERT_TRUE(device.WaitCalls(2));
+  device.Answer(Reply("{\"checks\":4}"));
+  ASSERT_TRUE(cache.Get(kFiscalNum, &status));
+  EXPECT_EQ(status.reply.json_val, "{\"checks\":4}");
+
+  const char kOther[] = "4000000002";
+  cache.Store(kOther, DeviceError("COM port is busy"));
+  EXPECT_FALSE(cache.Get(kOther, &status));
+  EXPECT_EQ(events.Last().reply.error, "COM port is busy");
+}
+
+}  // namespace
+}  // namespace virok
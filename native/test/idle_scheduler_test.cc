@@ -0,0 +1,286 @@
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "maintenance/idle_scheduler.h"
+
+namespace virok {
+namespace {
+
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+using Clock = IdleScheduler::Clock;
+
+// Задача з |slices| кроків; пише кожен крок у журнал.
+struct SlicedJob {
+  std::string name;
+  int slices = 0;
+  int position = 0;
+  int preempts = 0;
+  std::vector<std::string>* log = nullptr;
+
+  MaintenanceJob Make(milliseconds interval) {
+    MaintenanceJob job;
+    job.name = name;
+    job.interval = interval;
+    job.step = [this](const MaintenanceYield&) {
+      log->push_back(name + ":" + std::to_string(position));
+      if (++position < slices) return MaintenanceStep::kMore;
+      position = 0;
+      return MaintenanceStep::kDone;
+    };
+    job.preempt = [this] {
+      preempts++;
+      log->push_back(name + ":preempt");
+    };
+    return job;
+  }
+};
+
+IdleSchedulerOptions Options() {
+  IdleSchedulerOptions options;
+  options.idle_after = seconds(30);
+  options.retry_after = seconds(60);
+  options.wait_poll = seconds(1);
+  return options;
+}
+
+// Хронологія каси: клавіші й скани в модельному часі, між ними планувальник
+// опитується так, як його опитував би власний потік.
+class Timeline {
+ public:
+  explicit Timeline(IdleScheduler* scheduler)
+      : scheduler_(scheduler), t0_(Clock::now()) {}
+
+  Clock::time_point at(milliseconds offset) const { return t0_ + offset; }
+
+  void Input(milliseconds offset) { scheduler_->OnInput(at(offset)); }
+
+  // Опитує з |from| до |to|: кожен крок триває |step_cost|, сон — до
+  // часу, який повернув Poll.
+  void Run(milliseconds from, milliseconds to,
+           milliseconds step_cost = milliseconds(2)) {
+    Clock::time_point now = at(from);
+    while (now < at(to)) {
+      const Clock::time_point next = scheduler_->Poll(now);
+      now = next <= now ? now + step_cost : std::min(next, at(to));
+    }
+  }
+
+ private:
+  IdleScheduler* scheduler_;
+  const Clock::time_point t0_;
+};
+
+TEST(IdleSchedulerTest, RunsOnlyAfterInputGoesQuiet) {
+  IdleScheduler scheduler(Options());
+  std::vector<std::string> log;
+  SlicedJob compact{"compact", 3, 0, 0, &log};
+  Timeline timeline(&scheduler);
+  scheduler.AddJob(compact.Make(seconds(3600)), timeline.at(seconds(0)));
+
+  // Продаж: клавіші кожні кілька секунд.
+  for (int s = 0; s <= 20; s += 4) timeline.Input(seconds(s));
+  timeline.Run(seconds(0), seconds(49));
+  EXPECT_TRUE(log.empty());
+
+  // 30 с тиші після останньої клавіші (20 с).
+  timeline.Run(seconds(49), seconds(51));
+  EXPECT_EQ(log, (std::vector<std::string>{"compact:0", "compact:1",
+                                           "compact:2"}));
+  // Інтервал ще не минув.
+  timeline.Run(seconds(51), seconds(600));
+  EXPECT_EQ(log.size(), 3u);
+  IdleSchedulerStatus status = scheduler.status(timeline.at(seconds(600)));
+  EXPECT_TRUE(status.idle);
+  ASSERT_EQ(status.jobs.size(), 1u);
+  EXPECT_EQ(status.jobs[0].runs, 1u);
+}
+
+TEST(IdleSchedulerTest, ScanPreemptsAndJobResumesInNextWindow) {
+  IdleScheduler scheduler(Options());
+  std::vector<std::string> log;
+  SlicedJob compact{"compact", 5, 0, 0, &log};
+  Timeline timeline(&scheduler);
+  scheduler.AddJob(compact.Make(seconds(3600)), timeline.at(seconds(0)));
+  timeline.Input(seconds(0));
+
+  // Два кроки у вікні простою, потім скан.
+  Clock::time_point now = timeline.at(seconds(30));
+  scheduler.Poll(now);
+  scheduler.Poll(now + milliseconds(2));
+  timeline.Input(seconds(30) + milliseconds(3));
+  const Clock::time_point next = scheduler.Poll(now + milliseconds(4));
+  EXPECT_EQ(next, timeline.at(seconds(60) + milliseconds(3)));
+  EXPECT_EQ(log, (std::vector<std::string>{"compact:0", "compact:1",
+                                           "compact:preempt"}));
+  EXPECT_EQ(scheduler.status(now).active, "compact");
+
+  // Ще одне введення: preempt вже надіслано.
+  timeline.Input(seconds(40));
+  timeline.Run(seconds(40), seconds(69));
+  EXPECT_EQ(compact.preempts, 1);
+  EXPECT_EQ(log.size(), 3u);
+
+  // Продовжує з третього кроку, а не спочатку.
+  timeline.Run(seconds(70), seconds(71));
+  EXPECT_EQ(log, (std::vector<std::string>{
+                     "compact:0", "compact:1", "compact:preempt",
+                     "compact:2", "compact:3", "compact:4"}));
+  EXPECT_EQ(scheduler.status(timeline.at(seconds(71))).preemptions, 1u);
+}
+
+TEST(IdleSchedulerTest, OpenCartBlocksMaintenance) {
+  IdleScheduler scheduler(Options());
+  std::vector<std::string> log;
+  SlicedJob sync{"sync", 1, 0, 0, &log};
+  Timeline timeline(&scheduler);
+  scheduler.AddJob(sync.Make(seconds(600)), timeline.at(seconds(0)));
+  timeline.Input(seconds(0));
+
+  // Касир відійшов з відкритим чеком.
+  scheduler.SetCartOpen(true);
+  timeline.Run(seconds(0), seconds(300));
+  EXPECT_TRUE(log.empty());
+  EXPECT_FALSE(scheduler.status(timeline.at(seconds(300))).idle);
+
+  scheduler.SetCartOpen(false);
+  timeline.Run(seconds(300), seconds(301));
+  EXPECT_EQ(log, std::vector<std::string>{"sync:0"});
+}
+
+TEST(IdleSchedulerTest, MostOverdueJobFirstAndIntervalsRespected) {
+  IdleScheduler scheduler(Options());
+  std::vector<std::string> log;
+  SlicedJob sync{"sync", 1, 0, 0, &log};
+  SlicedJob index{"index", 2, 0, 0, &log};
+  Timeline timeline(&scheduler);
+  scheduler.AddJob(sync.Make(seconds(60)), timeline.at(seconds(10)));
+  scheduler.AddJob(index.Make(seconds(3600)), timeline.at(seconds(0)));
+  timeline.Input(seconds(0));
+
+  timeline.Run(seconds(0), seconds(31));
+  EXPECT_EQ(log, (std::vector<std::string>{"index:0", "index:1",
+                                           "sync:0"}));
+  // sync кожні 60 с простою, index — раз на годину.
+  log.clear();
+  timeline.Run(seconds(31), seconds(300));
+  EXPECT_EQ(log, (std::vector<std::string>{"sync:0", "sync:0", "sync:0",
+                                           "sync:0"}));
+}
+
+TEST(IdleSchedulerTest, FailedJobRetriesLater) {
+  IdleScheduler scheduler(Options());
+  int attempts = 0;
+  MaintenanceJob job;
+  job.name = "checkpoint";
+  job.step = [&](const MaintenanceYield&) {
+    return ++attempts < 3 ? MaintenanceStep::kFailed : MaintenanceStep::kDone;
+  };
+  Timeline timeline(&scheduler);
+  scheduler.AddJob(job, timeline.at(seconds(0)));
+  timeline.Input(seconds(0));
+
+  timeline.Run(seconds(0), seconds(31));
+  EXPECT_EQ(attempts, 1);
+  timeline.Run(seconds(31), seconds(151));
+  EXPECT_EQ(attempts, 3);
+  const IdleSchedulerStatus status =
+      scheduler.status(timeline.at(seconds(151)));
+  EXPECT_EQ(status.jobs[0].failures, 2u);
+  EXPECT_EQ(status.jobs[0].runs, 1u);
+}
+
+// Задача, що виконується поза планувальником (у Dart): kWait до Wake().
+TEST(IdleSchedulerTest, ExternalJobWaitsForWake) {
+  IdleScheduler scheduler(Options());
+  enum class State { kIdle, kRunning, kFinished } state = State::kIdle;
+  int started = 0;
+  int preempted = 0;
+  MaintenanceJob job;
+  job.name = "deltaSync";
+  job.step = [&](const MaintenanceYield&) {
+    switch (state) {
+      case State::kIdle:
+        started++;
+        state = State::kRunning;
+        return MaintenanceStep::kWait;
+      case State::kRunning:
+        return MaintenanceStep::kWait;
+      case State::kFinished:
+        state = State::kIdle;
+        return MaintenanceStep::kDone;
+    }
+    return MaintenanceStep::kFailed;
+  };
+  job.preempt = [&] { preempted++; };
+  Timeline timeline(&scheduler);
+  scheduler.AddJob(job, timeline.at(seconds(0)));
+  timeline.Input(seconds(0));
+
+  Clock::time_point now = timeline.at(seconds(30));
+  EXPECT_EQ(scheduler.Poll(now), now);
+  // Чекає wait_poll, потім опитує знову.
+  EXPECT_EQ(scheduler.Poll(now), now + seconds(1));
+  EXPECT_EQ(scheduler.Poll(now + seconds(1)), now + seconds(1));
+  EXPECT_EQ(started, 1);
+
+  // Скан посеред синхронізації.
+  timeline.Input(seconds(32));
+  scheduler.Poll(timeline.at(seconds(32)));
+  EXPECT_EQ(preempted, 1);
+
+  state = State::kFinished;
+  scheduler.Wake();
+  now = timeline.at(seconds(62));
+  EXPECT_EQ(scheduler.Poll(now), now);
+  EXPECT_EQ(scheduler.status(now).jobs[0].runs, 1u);
+  EXPECT_EQ(started, 1);
+}
+
+// Справжній потік: крок, що перевіряє ShouldYield, повертається за
+// мілісекунди після введення.
+TEST(IdleSchedulerTest, InputInterruptsRunningStepPromptly) {
+  IdleSchedulerOptions options;
+  options.idle_after = milliseconds(20);
+  IdleScheduler scheduler(options);
+  std::atomic<bool> in_step{false};
+  std::atomic<int64_t> returned_ns{0};
+  MaintenanceJob job;
+  job.name = "vacuum";
+  job.step = [&](const MaintenanceYield& yield) {
+    in_step = true;
+    // Дрібні одиниці роботи, як сторінки vacuum.
+    while (!yield.ShouldYield()) {
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    returned_ns = Clock::now().time_since_epoch().count();
+    return MaintenanceStep::kMore;
+  };
+  scheduler.AddJob(job, Clock::now());
+  scheduler.Start();
+
+  const Clock::time_point deadline = Clock::now() + seconds(5);
+  while (!in_step && Clock::now() < deadline) {
+    std::this_thread::sleep_for(milliseconds(1));
+  }
+  ASSERT_TRUE(in_step);
+  const Clock::time_point input = Clock::now();
+  scheduler.OnInput(input);
+  while (returned_ns == 0 && Clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+  ASSERT_NE(returned_ns, 0);
+  const auto latency =
+      Clock::time_point(Clock::duration(returned_ns.load())) - input;
+  // Кілька мс із запасом на завантажену машину збірки.
+  EXPECT_LT(latency, milliseconds(50));
+  scheduler.Stop();
+}
+
+}  // namespace
+}  // namespace virok
@@ -0,0 +1,155 @@
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "json/json_reader.h"
+
+namespace virok {
+namespace {
+
+using Token = JsonReader::Token;
+
+// Рядок єдиного значення-рядка документа (або "<error>").
+std::string StringValue(std::string_view json) {
+  JsonReader reader(json);
+  if (reader.Next() != Token::kString) return "<error>";
+  std::string text(reader.text());
+  if (reader.Next() != Token::kEnd) return "<error>";
+  return text;
+}
+
+// Токени документа до kEnd або kError включно.
+std::vector<Token> Tokens(std::string_view json,
+                          std::string* error = nullptr) {
+  JsonReader reader(json);
+  std::vector<Token> tokens;
+  for (;;) {
+    tokens.push_back(reader.Next());
+    if (tokens.back() == Token::kEnd || tokens.back() == Token::kError) break;
+  }
+  if (error) *error = reader.error();
+  return tokens;
+}
+
+TEST(JsonReaderTest, WalksNestedDocument) {
+  JsonReader reader(
+      R"({"a": [1, -2.5e1, true, null], "b": {}, "c": [], "d": "x"})");
+  EXPECT_EQ(reader.Next(), Token::kBeginObject);
+  EXPECT_EQ(reader.Next(), Token::kKey);
+  EXPECT_EQ(reader.text(), "a");
+  EXPECT_EQ(reader.Next(), Token::kBeginArray);
+  EXPECT_EQ(reader.depth(), 2);
+  EXPECT_EQ(reader.Next(), Token::kNumber);
+  EXPECT_EQ(reader.integer(), 1);
+  EXPECT_EQ(reader.Next(), Token::kNumber);
+  EXPECT_EQ(reader.number_text(), "-2.5e1");
+  EXPECT_DOUBLE_EQ(reader.number(), -25.0);
+  EXPECT_EQ(reader.integer(), -25);
+  EXPECT_EQ(reader.Next(), Token::kBool);
+  EXPECT_TRUE(reader.boolean());
+  EXPECT_EQ(reader.Next(), Token::kNull);
+  EXPECT_EQ(reader.Next(), Token::kEndArray);
+  EXPECT_EQ(reader.Next(), Token::kKey);
+  EXPECT_EQ(reader.Next(), Token::kBeginObject);
+  EXPECT_EQ(reader.Next(), Token::kEndObject);
+  EXPECT_EQ(reader.Next(), Token::kKey);
+  EXPECT_EQ(reader.Next(), Token::kBeginArray);
+  EXPECT_EQ(reader.Next(), Token::kEndArray);
+  EXPECT_EQ(reader.Next(), Token::kKey);
+  EXPECT_EQ(reader.Next(), Token::kString);
+  EXPECT_EQ(reader.text(), "x");
+  EXPECT_EQ(reader.Next(), Token::kEndObject);
+  EXPECT_EQ(reader.depth(), 0);
+  EXPECT_EQ(reader.Next(), Token::kEnd);
+  EXPECT_EQ(reader.Next(), Token::kEnd);
+}
+
+TEST(JsonReaderTest, UnescapesStrings) {
+  EXPECT_EQ(StringValue(R"("plain")"), "plain");
+  EXPECT_EQ(StringValue(R"("a\"b\\c\/d")"), "a\"b\\c/d");
+  EXPECT_EQ(StringValue(R"("\b\f\n\r\t")"), "\b\f\n\r\t");
+  EXPECT_EQ(StringValue(R"("\u0041\u00e9")"), "A\xC3\xA9");
+  // Кирилиця escape-послідовностями (так її віддає Cashalot) і як є.
+  EXPECT_EQ(StringValue(R"("\u0417\u0432\u0456\u0442")"), "Звіт");
+  EXPECT_EQ(StringValue(R"("Звіт \"Z\"")"), "Звіт \"Z\"");
+}
+
+TEST(JsonReaderTest, JoinsSurrogatePairs) {
+  // U+1F600 як пара UTF-16.
+  EXPECT_EQ(StringValue(R"("\ud83d\ude00")"), "\xF0\x9F\x98\x80");
+  EXPECT_EQ(StringValue(R"("x\uD83D\uDE00y")"), "x\xF0\x9F\x98\x80y");
+  // Непарні сурогати — U+FFFD, решта рядка не губиться.
+  EXPECT_EQ(StringValue(R"("\ud83dz")"), "\xEF\xBF\xBDz");
+  EXPECT_EQ(StringValue(R"("\ude00")"), "\xEF\xBF\xBD");
+  EXPECT_EQ(StringValue(R"("\ud83dA")"), "\xEF\xBF\xBD" "A");
+}
+
+TEST(JsonReaderTest, RejectsMalformedInput) {
+  const char* const kBad[] = {
+      "",
+      "{",
+      "[1,]",
+      "[1 2]",
+      R"({"a" 1})",
+      R"({"a":1,})",
+      R"({1:2})",
+      R"(["abc)",
+      R"(["\x"])",
+      R"(["\u12g4"])",
+      R"(["\u12"])",
+      "[01x]",
+      "[-]",
+      "[1.]",
+      "[1e]",
+      "[tru]",
+      "[nul]",
+      "{} {}",
+      "[1]]",
+      "[}",
+  };
+  for (const char* json : kBad) {
+    std::string error;
+    const std::vector<Token> tokens = Tokens(json, &error);
+    EXPECT_EQ(tokens.back(), Token::kError) << json;
+    EXPECT_NE(error.find("at offset"), std::string::npos) << json;
+  }
+
+  // Після помилки читач стоїть на ній.
+  JsonReader reader("[1,,2]");
+  EXPECT_EQ(reader.Next(), Token::kBeginArray);
+  EXPECT_EQ(reader.Next(), Token::kNumber);
+  EXPECT_EQ(reader.Next(), Token::kError);
+  EXPECT_EQ(reader.Next(), Token::kError);
+}
+
+TEST(JsonReaderTest, LimitsNesting) {
+  EXPECT_EQ(Tokens(std::string(64, '[') + std::string(64, ']')).back(),
+            Token::kEnd);
+  std::string error;
+  EXPECT_EQ(Tokens(std::string(65, '[') + std::string(65, ']'), &error).back(),
+            Token::kError);
+  EXPECT_NE(error.find("Nesting"), std::string::npos);
+}
+
+TEST(JsonReaderTest, SkipsValues) {
+  JsonReader reader(
+      R"({"skip": {"a": [1, {"b": "A"}], "c": {}}, "keep": 7})");
+  EXPECT_EQ(reader.Next(), Token::kBeginObject);
+  EXPECT_EQ(reader.Next(), Token::kKey);
+  EXPECT_TRUE(reader.Skip());
+  EXPECT_EQ(reader.depth(), 1);
+  EXPECT_EQ(reader.Next(), Token::kKey);
+  EXPECT_EQ(reader.text(), "keep");
+  EXPECT_EQ(reader.Next(), Token::kNumber);
+  EXPECT_EQ(reader.integer(), 7);
+
+  JsonReader broken(R"({"skip": [1, {"a": }]})");
+  EXPECT_EQ(broken.Next(), Token::kBeginObject);
+  EXPECT_EQ(broken.Next(), Token::kKey);
+  EXPECT_FALSE(broken.Skip());
+}
+
+}  // namespace
+}  // namespace virok
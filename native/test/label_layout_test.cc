@@ -0,0 +1,149 @@
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "printing/escpos.h"
+#include "printing/label_batch.h"
+#include "printing/label_layout.h"
+
+namespace virok {
+namespace {
+
+PriceLabel Label(const std::string& name, double price,
+                 const std::string& barcode) {
+  PriceLabel label;
+  label.name = name;
+  label.price = price;
+  label.barcode = barcode;
+  label.unit_name = "шт";
+  return label;
+}
+
+std::string Cp1251(std::string_view utf8) {
+  std::string out;
+  Utf8ToCp1251(utf8, &out);
+  return out;
+}
+
+TEST(LabelLayoutTest, ParsesPackSizeFromName) {
+  double amount = 0;
+  const char* unit = nullptr;
+  ASSERT_TRUE(ParsePackSize("Молоко Галичина 2.5% 900г", &amount, &unit));
+  EXPECT_DOUBLE_EQ(amount, 0.9);
+  EXPECT_STREQ(unit, "кг");
+  ASSERT_TRUE(ParsePackSize("Сік Садочок 1,5 л", &amount, &unit));
+  EXPECT_DOUBLE_EQ(amount, 1.5);
+  EXPECT_STREQ(unit, "л");
+  ASSERT_TRUE(ParsePackSize("Сир 200гр фасований", &amount, &unit));
+  EXPECT_DOUBLE_EQ(amount, 0.2);
+  ASSERT_TRUE(ParsePackSize("Вода 500 мл", &amount, &unit));
+  EXPECT_DOUBLE_EQ(amount, 0.5);
+  EXPECT_STREQ(unit, "л");
+  EXPECT_FALSE(ParsePackSize("Батарейка АА 2 шт", &amount, &unit));
+  EXPECT_FALSE(ParsePackSize("Зарядка 1 година", &amount, &unit));
+}
+
+TEST(LabelLayoutTest, ChecksEanDigit) {
+  EXPECT_TRUE(IsValidEan("4820000000024"));
+  EXPECT_TRUE(IsValidEan("96385074"));
+  EXPECT_FALSE(IsValidEan("4820000000025"));
+  EXPECT_FALSE(IsValidEan("482000000002"));
+  EXPECT_FALSE(IsValidEan("A820000000024"));
+}
+
+TEST(LabelLayoutTest, LaysOutPriceUnitPriceAndBarcode) {
+  LabelTemplate tmpl;
+  std::string out;
+  AppendPriceLabel(Label("Молоко Галичина 2.5% 900г", 42.9, "4820000000024"),
+                   tmpl, &out);
+  EXPECT_NE(out.find(Cp1251("Молоко Галичина 2.5% 900г\n")),
+            std::string::npos);
+  EXPECT_NE(out.find("\x1D\x21\x11" "42.90"), std::string::npos);
+  EXPECT_NE(out.find(Cp1251("Ціна за 1 кг: 47.67 грн")), std::string::npos);
+  EXPECT_NE(out.find(std::string("\x1Dk\x43\x0D") + "4820000000024"),
+            std::string::npos);
+  EXPECT_EQ(out.compare(out.size() - kEscPosFeedCut.size(),
+                        kEscPosFeedCut.size(), kEscPosFeedCut),
+            0);
+
+  // Не EAN — CODE128 набору B; кирилиця — лише текстом.
+  out.clear();
+  AppendPriceLabel(Label("Хліб", 25, "A-17"), tmpl, &out);
+  EXPECT_NE(out.find("\x1Dk\x49\x06{BA-17"), std::string::npos);
+  out.clear();
+  AppendPriceLabel(Label("Хліб", 25, "ВАГА-1"), tmpl, &out);
+  EXPECT_EQ(out.find("\x1Dk"), std::string::npos);
+  EXPECT_NE(out.find(Cp1251("ВАГА-1\n")), std::string::npos);
+
+  // Довга назва — два рядки, решта обрізається.
+  out.clear();
+  tmpl.width = 16;
+  AppendPriceLabel(
+      Label("Печиво вівсяне з шоколадом та горіхами Домашнє", 30, ""), tmpl,
+      &out);
+  EXPECT_NE(out.find(Cp1251("Печиво вівсяне з\nшоколадом та\x85\n")),
+            std::string::npos);
+}
+
+TEST(LabelLayoutTest, BatchMatchesSequentialLayout) {
+  std::vector<PriceLabel> labels;
+  for (int i = 0; i < 500; i++) {
+    labels.push_back(Label("Товар " + std::to_string(i) + " 250г",
+                           10 + i * 0.5, "4820000000024"));
+  }
+  LabelTemplate tmpl;
+  tmpl.copies = 2;
+  std::string expected(kEscPosInit);
+  for (const PriceLabel& label : labels) {
+    AppendPriceLabel(label, tmpl, &expected);
+  }
+
+  for (int threads : {1, 4}) {
+    LabelBatchOptions options;
+    options.threads = threads;
+    options.chunk = 7;
+    options.window = 2;
+    std::string got;
+    int writes = 0;
+    LabelBatchStats stats;
+    std::string error;
+    ASSERT_TRUE(PrintLabelBatch(
+        labels, tmpl, options,
+        [&](std::string_view data, std::string*) {
+          got.append(data);
+          writes++;
+          return true;
+        },
+        &stats, &error))
+        << error;
+    EXPECT_EQ(got, expected) << threads;
+    EXPECT_EQ(writes, 1 + (499 + 6) / 7);
+    EXPECT_EQ(stats.labels, 500u);
+    EXPECT_EQ(stats.bytes, expected.size());
+    EXPECT_GT(stats.first_label_us, 0);
+  }
+}
+
+TEST(LabelLayoutTest, BatchStopsOnSinkError) {
+  std::vector<PriceLabel> labels(100, Label("Товар", 1, ""));
+  LabelBatchOptions options;
+  options.threads = 3;
+  options.chunk = 1;
+  int writes = 0;
+  std::string error;
+  EXPECT_FALSE(PrintLabelBatch(
+      labels, LabelTemplate(), options,
+      [&](std::string_view, std::string* e) {
+        if (++writes < 3) return true;
+        *e = "printer offline";
+        return false;
+      },
+      nullptr, &error));
+  EXPECT_EQ(writes, 3);
+  EXPECT_EQ(error, "printer offline");
+}
+
+}  // namespace
+}  // namespace virok
@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "metrics/histogram.h"
+#include "metrics/metrics.h"
+#include "metrics/metrics_exporter.h"
+
+namespace virok {
+namespace {
+
+constexpr double kRelativeError = 1.0 / Histogram::kSubBuckets;
+
+// Детермінований "довгий хвіст": більшість значень сотні мкс, рідкі — секунди.
+int64_t SampleValue(uint64_t i) {
+  const uint64_t h = i * 0x9E3779B97F4A7C15ull;
+  const int64_t base = static_cast<int64_t>((h >> 20) % 900) + 100;
+  return (h >> 60) == 0 ? base * 5000 : base;
+}
+
+TEST(HistogramTest, BucketsCoverValueWithBoundedWidth) {
+  for (int64_t v = 0; v < 2'000'000; v += (v < 1000 ? 1 : 997)) {
+    const size_t index = Histogram::BucketIndex(v);
+    ASSERT_LT(index, Histogram::kBucketCount);
+    const int64_t lower = Histogram::BucketLowerBound(index);
+    const int64_t upper = Histogram::BucketUpperBound(index);
+    ASSERT_LE(lower, v);
+    ASSERT_GE(upper, v);
+    ASSERT_LE(static_cast<double>(upper - lower),
+              kRelativeError * static_cast<double>(std::max<int64_t>(v, 1)));
+  }
+}
+
+TEST(HistogramTest, ValuesBeyondRangeGoToLastBucket) {
+  EXPECT_EQ(Histogram::BucketIndex(int64_t{1} << 50),
+            Histogram::kBucketCount - 1);
+  EXPECT_EQ(Histogram::BucketIndex(-5), 0u);
+}
+
+TEST(HistogramTest, ConcurrentWritersKeepExactCountSumAndMax) {
+  constexpr int kThreads = 8;
+  constexpr uint64_t kPerThread = 200'000;
+
+  Histogram histogram;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&histogram, t] {
+      for (uint64_t i = 0; i < kPerThread; i++) {
+        histogram.Record(SampleValue(t * kPerThread + i));
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  std::vector<int64_t> all;
+  all.reserve(kThreads * kPerThread);
+  for (uint64_t i = 0; i < kThreads * kPerThread; i++) {
+    all.push_back(SampleValue(i));
+  }
+  int64_t sum = 0;
+  for (int64_t v : all) sum += v;
+
+  const HistogramSnapshot s = histogram.Snapshot();
+  EXPECT_EQ(s.count, all.size());
+  EXPECT_EQ(s.sum, sum);
+  EXPECT_EQ(s.max, *std::max_element(all.begin(), all.end()));
+
+  std::sort(all.begin(), all.end());
+  for (double q : {0.5, 0.9, 0.99, 0.999, 1.0}) {
+    const size_t rank = static_cast<size_t>(std::ceil(q * all.size())) - 1;
+    const double exact = static_cast<double>(all[rank]);
+    const double got = static_cast<double>(s.Percentile(q));
+    EXPECT_GE(got, exact) << "q=" << q;
+    EXPECT_LE(got, exact * (1 + kRelativeError)) << "q=" << q;
+  }
+}
+
+TEST(HistogramTest, EmptySnapshot) {
+  Histogram histogram;
+  const HistogramSnapshot s = histogram.Snapshot();
+  EXPECT_EQ(s.count, 0u);
+  EXPECT_EQ(s.Percentile(0.99), 0);
+}
+
+TEST(MetricsRegistryTest, CountersAreExactUnderContention) {
+  Counter* counter = MetricsRegistry::Get().GetCounter(
+      "virok_test_contended_total", "Test counter");
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; t++) {
+    threads.emplace_back([counter] {
+      for (int i = 0; i < 100'000; i++) counter->Add();
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(counter->value(), 800'000u);
+}
+
+TEST(MetricsRegistryTest, SameNameAndLabelsReturnSameSeries) {
+  MetricsRegistry& registry = MetricsRegistry::Get();
+  const std::string labels = MetricLabel("method", "OpenShift");
+  EXPECT_EQ(registry.GetHistogram("virok_test_same_microseconds", "h", labels),
+            registry.GetHistogram("virok_test_same_microseconds", "h", labels));
+  EXPECT_NE(registry.GetHistogram("virok_test_same_microseconds", "h", labels),
+            registry.GetHistogram("virok_test_same_microseconds", "h"));
+}
+
+TEST(MetricsRegistryTest, WritesPrometheusText) {
+  MetricsRegistry& registry = MetricsRegistry::Get();
+  registry.SetConstLabels(MetricLabel("lane", "kasa-1"));
+  registry
+      .GetCounter("virok_test_print_failures_total", "Print failures",
+                  MetricLabel("printer", "10.0.0.5"))
+      ->Add(3);
+  registry.GetGauge("virok_test_queue_depth", "Queue depth")->Set(7);
+  Histogram* h = registry.GetHistogram("virok_test_call_microseconds",
+                                       "Call latency",
+                                       MetricLabel("method", "Fiscal\"ize"));
+  for (int i = 1; i <= 100; i++) h->Record(i);
+  // Інший тип під тим самим ім'ям не ламає експорт.
+  registry.GetCounter("virok_test_queue_depth", "conflict")->Add();
+
+  std::string text;
+  registry.WritePrometheus(&text);
+  registry.SetConstLabels(std::string());
+
+  EXPECT_NE(text.find("# TYPE virok_test_print_failures_total counter\n"
+                      "virok_test_print_failures_total{lane=\"kasa-1\","
+                      "printer=\"10.0.0.5\"} 3\n"),
+            std::string::npos)
+      << text;
+  EXPECT_NE(text.find("# TYPE virok_test_queue_depth gauge\n"
+                      "virok_test_queue_depth{lane=\"kasa-1\"} 7\n"),
+            std::string::npos)
+      << text;
+  EXPECT_NE(text.find("virok_test_call_microseconds{lane=\"kasa-1\","
+                      "method=\"Fiscal\\\"ize\",quantile=\"0.5\"} 50\n"),
+            std::string::npos)
+      << text;
+  EXPECT_NE(text.find("virok_test_call_microseconds_count{lane=\"kasa-1\","
+                      "method=\"Fiscal\\\"ize\"} 100\n"),
+            std::string::npos)
+      << text;
+  EXPECT_NE(text.find("virok_test_call_microseconds_max{lane=\"kasa-1\","
+                      "method=\"Fiscal\\\"ize\"} 100\n"),
+            std::string::npos)
+      << text;
+}
+
+TEST(MetricsFileExporterTest, WritesSnapshotFile) {
+  const std::string path = ::testing::TempDir() + "virok_metrics_test.prom";
+  MetricsRegistry::Get()
+      .GetCounter("virok_test_exported_total", "Exported")
+      ->Add(42);
+
+  MetricsFileExporter exporter;
+  ASSERT_TRUE(exporter.Start(path, std::chrono::milliseconds(10)));
+  std::this_thread::sleep_for(std::chrono::milliseconds(30));
+  exporter.Stop();
+
+  std::ifstream file(path);
+  std::stringstream text;
+  text << file.rdbuf();
+  EXPECT_NE(text.str().find("virok_test_exported_total 42\n"),
+            std::string::npos);
+  std::remove(path.c_str());
+}
+
+}  // namespace
+}  // namespace virok
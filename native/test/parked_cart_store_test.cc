@@ -0,0 +1,232 @@
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "parking/parked_cart.h"
+#include "parking/parked_cart_store.h"
+
+namespace virok {
+namespace {
+
+namespace fs = std::filesystem;
+
+class ParkedCartStoreTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir_ = fs::temp_directory_path() /
+           ("virok_parked_test_" +
+            std::string(::testing::UnitTest::GetInstance()
+                            ->current_test_info()
+                            ->name()));
+    std::error_code ec;
+    fs::remove_all(dir_, ec);
+  }
+
+  void TearDown() override {
+    std::error_code ec;
+    fs::remove_all(dir_, ec);
+  }
+
+  std::string dir() const { return dir_.u8string(); }
+  fs::path log() const { return dir_ / "parked.log"; }
+
+  static ParkedCart Cart(const std::string& cashier, int64_t parked_ms) {
+    ParkedCart cart;
+    cart.cashier = cashier;
+    cart.payment_form = "Готівка";
+    cart.parked_ms = parked_ms;
+    ParkedLine bread;
+    bread.guid = "g-bread";
+    bread.name = "Хліб";
+    bread.price = 3250;
+    bread.quantity = 2;
+    ParkedLine cheese;
+    cheese.guid = "g-cheese";
+    cheese.name = "Сир";
+    cheese.price = 42000;
+    cheese.weight_g = 355;
+    cheese.discount = 500;
+    cart.lines = {bread, cheese};
+    for (const ParkedLine& line : cart.lines) {
+      cart.total += ParkedLineTotal(line);
+    }
+    return cart;
+  }
+
+  fs::path dir_;
+};
+
+TEST(ParkedCartTest, ParsesJsonInKopecksAndGrams) {
+  ParkedCart cart;
+  std::string error;
+  ASSERT_TRUE(ParseParkedCart(
+      R"({"cashier": "Олена", "paymentForm": "Картка", "parkedMs": 1000,
+          "lines": [{"guid": "a", "name": "Хліб", "price": 32.5,
+                     "quantity": 2, "weight": 0, "discount": 0},
+                    {"guid": "b", "name": "Сир", "price": 420,
+                     "quantity": 1, "weight": 0.355, "discount": 5}]})",
+      &cart, &error))
+      << error;
+  ASSERT_EQ(cart.lines.size(), 2u);
+  EXPECT_EQ(cart.lines[0].price, 3250);
+  EXPECT_EQ(cart.lines[1].weight_g, 355);
+  // 32.50 × 2 + 420 × 0.355 − 5 = 65 + 149.10 − 5
+  EXPECT_EQ(cart.total, 20910);
+
+  EXPECT_FALSE(ParseParkedCart(R"({"cashier": "Олена", "lines": []})", &cart,
+                               &error));
+}
+
+TEST(ParkedCartTest, EncodingRoundTrips) {
+  ParkedCart cart;
+  std::string error;
+  ASSERT_TRUE(ParseParkedCart(
+      R"({"cashier": "Олена", "parkedMs": 1700000000000,
+          "lines": [{"guid": "a", "name": "Хліб", "article": "0001",
+                     "category": "c", "price": 32.5, "quantity": 3}]})",
+      &cart, &error));
+  cart.id = 77;
+  std::string encoded;
+  EncodeParkedCart(cart, &encoded);
+  ParkedCart decoded;
+  ASSERT_TRUE(DecodeParkedCart(encoded, &decoded));
+  EXPECT_EQ(decoded.id, 77u);
+  EXPECT_EQ(decoded.parked_ms, cart.parked_ms);
+  EXPECT_EQ(decoded.cashier, "Олена");
+  ASSERT_EQ(decoded.lines.size(), 1u);
+  EXPECT_EQ(decoded.lines[0].article, "0001");
+  EXPECT_EQ(decoded.lines[0].quantity, 3);
+  EXPECT_EQ(decoded.total, 9750);
+
+  EXPECT_FALSE(DecodeParkedCart(encoded.substr(0, encoded.size() - 1),
+                                &decoded));
+}
+
+TEST_F(ParkedCartStoreTest, ListsByCashierNewestFirstAndTakesOnce) {
+  ParkedCartStore store;
+  std::string error;
+  ASSERT_TRUE(store.Open(dir(), &error)) << error;
+  ParkedCart a = Cart("Олена", 1000);
+  ParkedCart b = Cart("Петро", 2000);
+  ParkedCart c = Cart("Олена", 3000);
+  ASSERT_TRUE(store.Park(&a, &error));
+  ASSERT_TRUE(store.Park(&b, &error));
+  ASSERT_TRUE(store.Park(&c, &error));
+  EXPECT_NE(a.id, c.id);
+
+  const std::vector<ParkedCartSummary> all = store.List("");
+  ASSERT_EQ(all.size(), 3u);
+  EXPECT_EQ(all[0].id, c.id);
+  EXPECT_EQ(all[2].id, a.id);
+  const std::vector<ParkedCartSummary> olena = store.List("Олена");
+  ASSERT_EQ(olena.size(), 2u);
+  EXPECT_EQ(olena[0].id, c.id);
+  EXPECT_EQ(olena[0].lines, 2u);
+  EXPECT_EQ(olena[0].total, a.total);
+  EXPECT_TRUE(store.List("Ірина").empty());
+
+  // Get не прибирає кошик: відновлення забирає його після перенесення.
+  ParkedCart peeked;
+  ASSERT_TRUE(store.Get(a.id, &peeked, &error));
+  EXPECT_EQ(peeked.lines.size(), 2u);
+  EXPECT_EQ(store.List("Олена").size(), 2u);
+
+  ParkedCart taken;
+  ASSERT_TRUE(store.Take(a.id, &taken, &error));
+  EXPECT_EQ(taken.lines.size(), 2u);
+  EXPECT_EQ(taken.lines[1].weight_g, 355);
+  error.clear();
+  EXPECT_FALSE(store.Take(a.id, &taken, &error));
+  EXPECT_TRUE(error.empty());
+  EXPECT_FALSE(store.Get(a.id, &peeked, &error));
+  EXPECT_TRUE(error.empty());
+  EXPECT_EQ(store.List("Олена").size(), 1u);
+}
+
+TEST_F(ParkedCartStoreTest, SurvivesReopen) {
+  std::string error;
+  uint64_t kept;
+  {
+    ParkedCartStore store;
+    ASSERT_TRUE(store.Open(dir(), &error)) << error;
+    ParkedCart a = Cart("Олена", 1000);
+    ParkedCart b = Cart("Олена", 2000);
+    ASSERT_TRUE(store.Park(&a, &error));
+    ASSERT_TRUE(store.Park(&b, &error));
+    ParkedCart taken;
+    ASSERT_TRUE(store.Take(a.id, &taken, &error));
+    kept = b.id;
+  }
+  ParkedCartStore store;
+  ASSERT_TRUE(store.Open(dir(), &error)) << error;
+  const std::vector<ParkedCartSummary> list = store.List("Олена");
+  ASSERT_EQ(list.size(), 1u);
+  EXPECT_EQ(list[0].id, kept);
+
+  // Новий кошик не отримує id забраного.
+  ParkedCart c = Cart("Олена", 3000);
+  ASSERT_TRUE(store.Park(&c, &error));
+  EXPECT_GT(c.id, kept);
+}
+
+TEST_F(ParkedCartStoreTest, TruncatesTornTail) {
+  std::string error;
+  {
+    ParkedCartStore store;
+    ASSERT_TRUE(store.Open(dir(), &error)) << error;
+    ParkedCart a = Cart("Олена", 1000);
+    ParkedCart b = Cart("Олена", 2000);
+    ASSERT_TRUE(store.Park(&a, &error));
+    ASSERT_TRUE(store.Park(&b, &error));
+  }
+  // Збій живлення посеред запису другого кошика.
+  const uintmax_t size = fs::file_size(log());
+  fs::resize_file(log(), size - 7);
+
+  ParkedCartStore store;
+  ASSERT_TRUE(store.Open(dir(), &error)) << error;
+  ASSERT_EQ(store.List("").size(), 1u);
+  EXPECT_LT(fs::file_size(log()), size - 7);
+
+  // Після обрізання запис продовжується з цілого місця.
+  ParkedCart c = Cart("Олена", 3000);
+  ASSERT_TRUE(store.Park(&c, &error));
+  store.Close();
+  ASSERT_TRUE(store.Open(dir(), &error)) << error;
+  EXPECT_EQ(store.List("").size(), 2u);
+}
+
+TEST_F(ParkedCartStoreTest, RewritesMostlyDeadLog) {
+  ParkedCartStore store;
+  std::string error;
+  ASSERT_TRUE(store.Open(dir(), &error)) << error;
+  ParkedCart kept = Cart("Петро", 1);
+  ASSERT_TRUE(store.Park(&kept, &error));
+  uint64_t last = 0;
+  for (int i = 0; i < 1000; i++) {
+    ParkedCart cart = Cart("Олена", 1000 + i);
+    ASSERT_TRUE(store.Park(&cart, &error));
+    ParkedCart taken;
+    ASSERT_TRUE(store.Take(cart.id, &taken, &error));
+    last = cart.id;
+  }
+  const ParkedCartStoreStats stats = store.stats();
+  EXPECT_EQ(stats.carts, 1u);
+  EXPECT_LT(stats.bytes, 64u << 10);
+  EXPECT_EQ(fs::file_size(log()), stats.bytes);
+
+  store.Close();
+  ASSERT_TRUE(store.Open(dir(), &error)) << error;
+  ASSERT_EQ(store.List("").size(), 1u);
+  EXPECT_EQ(store.List("")[0].id, kept.id);
+  ParkedCart next = Cart("Олена", 5000);
+  ASSERT_TRUE(store.Park(&next, &error));
+  EXPECT_GT(next.id, last);
+}
+
+}  // namespace
+}  // namespace virok
@@ -0,0 +1,337 @@
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "promo/promo_engine.h"
+#include "promo/promo_rules.h"
+
+namespace virok {
+namespace {
+
+// Понеділок, 10:00.
+PromoTime Monday(int minute = 10 * 60) {
+  PromoTime t;
+  t.date = 20261019;
+  t.weekday = 0;
+  t.minute = minute;
+  return t;
+}
+
+PromoRule Percent(const std::string& id, int64_t percent_bp) {
+  PromoRule rule;
+  rule.id = id;
+  rule.kind = PromoKind::kPercent;
+  rule.percent_bp = percent_bp;
+  return rule;
+}
+
+PromoRule Rule(const std::string& id, PromoKind kind, int64_t price,
+               int64_t qty = 0, int64_t free_qty = 0) {
+  PromoRule rule;
+  rule.id = id;
+  rule.kind = kind;
+  rule.price = price;
+  rule.qty = qty;
+  rule.free_qty = free_qty;
+  return rule;
+}
+
+// Кошик з фіксованим часом; updates_ — остання знижка кожного рядка з
+// усіх повідомлень changed.
+class PromoCartTest : public ::testing::Test {
+ protected:
+  void Load(std::vector<PromoRule> rules) {
+    rules_ = std::make_shared<const PromoRuleSet>(std::move(rules));
+    cart_ = std::make_unique<PromoCart>(rules_);
+    Apply([&](auto* changed) { cart_->SetTime(Monday(), changed); });
+  }
+
+  void Set(const std::string& item, const std::string& category,
+           int64_t price, int64_t qty_milli) {
+    Apply([&](auto* changed) {
+      cart_->SetLine(item, category, price, qty_milli, changed);
+    });
+  }
+
+  void Remove(const std::string& item) {
+    Apply([&](auto* changed) { cart_->RemoveLine(item, changed); });
+  }
+
+  template <typename F>
+  void Apply(F&& change) {
+    changed_.clear();
+    change(&changed_);
+    for (const PromoLineDiscount& line : changed_) {
+      updates_[line.item] = line.discount;
+    }
+  }
+
+  std::shared_ptr<const PromoRuleSet> rules_;
+  std::unique_ptr<PromoCart> cart_;
+  std::vector<PromoLineDiscount> changed_;
+  std::map<std::string, int64_t> updates_;
+};
+
+TEST(PromoRulesTest, ParsesRules) {
+  std::vector<PromoRule> rules;
+  std::string error;
+  ASSERT_TRUE(ParsePromoRules(
+      R"([{"id": "p1", "kind": "bundle", "items": ["a", "b"], "qty": 3,)"
+      R"( "price": "99,90", "days": [1, 7], "from": "22:00", "to": "06:00",)"
+      R"( "validFrom": "2026-10-01", "comment": {"x": [1]}},)"
+      R"( {"id": "p2", "kind": "percent", "percent": 12.5,)"
+      R"( "categories": ["dairy"], "minQty": 2, "stackable": true}])",
+      &rules, &error))
+      << error;
+  ASSERT_EQ(rules.size(), 2u);
+  EXPECT_EQ(rules[0].kind, PromoKind::kBundle);
+  EXPECT_EQ(rules[0].items, (std::vector<std::string>{"a", "b"}));
+  EXPECT_EQ(rules[0].price, 9990);
+  EXPECT_EQ(rules[0].qty, 3);
+  EXPECT_EQ(rules[0].schedule.weekdays, 0x41);
+  EXPECT_EQ(rules[0].schedule.from_minute, 22 * 60);
+  EXPECT_EQ(rules[0].schedule.to_minute, 6 * 60);
+  EXPECT_EQ(rules[0].schedule.from_date, 20261001);
+  EXPECT_EQ(rules[1].percent_bp, 1250);
+  EXPECT_EQ(rules[1].min_qty, 2);
+  EXPECT_TRUE(rules[1].stackable);
+
+  // Комплект без кількості — помилка, і жодного правила.
+  EXPECT_FALSE(ParsePromoRules(
+      R"([{"id": "p1", "kind": "percent", "percent": 5},)"
+      R"( {"id": "p2", "kind": "bundle", "price": 10}])",
+      &rules, &error));
+  EXPECT_TRUE(rules.empty());
+  EXPECT_FALSE(error.empty());
+}
+
+TEST(PromoRulesTest, ScheduleCrossesMidnight) {
+  PromoSchedule night;
+  night.from_minute = 22 * 60;
+  night.to_minute = 6 * 60;
+  EXPECT_TRUE(night.ActiveAt(Monday(23 * 60)));
+  EXPECT_TRUE(night.ActiveAt(Monday(5 * 60 + 59)));
+  EXPECT_FALSE(night.ActiveAt(Monday(6 * 60)));
+  EXPECT_FALSE(night.ActiveAt(Monday(12 * 60)));
+}
+
+TEST_F(PromoCartTest, RoundsPercentToKopeck) {
+  Load({Percent("p", 1000)});
+  // 19.99 × 1.5 = 29.985 → 29.99; 10% = 2.999 → 3.00.
+  Set("milk", "", 1999, 1500);
+  EXPECT_EQ(cart_->Discount("milk"), 300);
+  // 45.50 × 0.333 = 15.1515 → 15.15; 10% = 1.515 → 1.52 (половина вгору).
+  Set("cheese", "", 4550, 333);
+  EXPECT_EQ(cart_->Discount("cheese"), 152);
+  EXPECT_EQ(cart_->total_discount(), 452);
+  ASSERT_EQ(changed_.size(), 1u);
+  EXPECT_EQ(changed_[0].item, "cheese");
+}
+
+TEST_F(PromoCartTest, UnitPriceNeverRaisesPrice) {
+  PromoRule price = Rule("hh", PromoKind::kUnitPrice, 1500);
+  price.items = {"beer", "wine"};
+  Load({price});
+  // (20.00 − 15.00) × 2.5.
+  Set("beer", "", 2000, 2500);
+  EXPECT_EQ(cart_->Discount("beer"), 1250);
+  Set("wine", "", 1200, 1000);
+  EXPECT_EQ(cart_->Discount("wine"), 0);
+  EXPECT_TRUE(changed_.empty());
+}
+
+TEST_F(PromoCartTest, AllocatesBundleDiscountProRata) {
+  PromoRule bundle = Rule("3for100", PromoKind::kBundle, 10000, 3);
+  bundle.items = {"a", "b"};
+  Load({bundle});
+  Set("a", "", 4000, 2000);
+  EXPECT_EQ(cart_->total_discount(), 0);
+  // Комплект — дві a і одна b: 80.00 + 33.33 − 100.00 = 13.33. Частки
+  // 9.4097 і 3.9203 — залишок копійки отримує найдорожчий рядок.
+  Set("b", "", 3333, 2000);
+  EXPECT_EQ(cart_->Discount("a"), 941);
+  EXPECT_EQ(cart_->Discount("b"), 392);
+  EXPECT_EQ(cart_->total_discount(), 1333);
+
+  // Одна a і дві b: 40.00 + 66.66 − 100.00 = 6.66 = 2.4977 + 4.1623.
+  Set("a", "", 4000, 1000);
+  EXPECT_EQ(cart_->Discount("a"), 250);
+  EXPECT_EQ(cart_->Discount("b"), 416);
+  EXPECT_EQ(cart_->total_discount(), 666);
+
+  // Дробова кількість у комплект не йде.
+  Set("a", "", 4000, 900);
+  EXPECT_EQ(cart_->total_discount(), 0);
+  EXPECT_EQ(updates_["a"], 0);
+  EXPECT_EQ(updates_["b"], 0);
+}
+
+TEST_F(PromoCartTest, GiftsCheapestUnits) {
+  Load({Rule("2plus1", PromoKind::kGift, 0, 2, 1)});
+  Set("x", "", 500, 1000);
+  Set("y", "", 300, 1000);
+  EXPECT_EQ(cart_->total_discount(), 0);
+  Set("z", "", 100, 2000);
+  EXPECT_EQ(cart_->Discount("z"), 100);
+  EXPECT_EQ(cart_->total_discount(), 100);
+  // Шість одиниць — дві найдешевші.
+  Set("y", "", 300, 3000);
+  EXPECT_EQ(cart_->Discount("z"), 200);
+  EXPECT_EQ(cart_->Discount("y"), 0);
+  // Найдешевший рядок пішов — дарується наступний.
+  Remove("z");
+  EXPECT_EQ(updates_["z"], 0);
+  EXPECT_EQ(cart_->Discount("y"), 300);
+  EXPECT_EQ(cart_->total_discount(), 300);
+}
+
+TEST_F(PromoCartTest, TakesBestOfExclusiveAndSumOfStackable) {
+  PromoRule stack = Rule("stack", PromoKind::kUnitPrice, 9500);
+  stack.stackable = true;
+  PromoRule all = Rule("all", PromoKind::kUnitPrice, 0);
+  all.items = {"gift"};
+  all.stackable = true;
+  Load({Percent("p10", 1000), Percent("p20", 2000), stack, all});
+  // Найбільша з нескладних (20%) плюс складна (5.00).
+  Set("tea", "", 10000, 1000);
+  EXPECT_EQ(cart_->Discount("tea"), 2500);
+  // Сума знижок — не більше вартості рядка.
+  Set("gift", "", 10000, 1000);
+  EXPECT_EQ(cart_->Discount("gift"), 10000);
+  EXPECT_EQ(cart_->total_discount(), 12500);
+}
+
+TEST_F(PromoCartTest, ReevaluatesMinQtyAcrossLines) {
+  PromoRule dairy = Percent("dairy", 500);
+  dairy.categories = {"dairy"};
+  dairy.min_qty = 3;
+  Load({dairy});
+  Set("milk", "dairy", 2000, 1000);
+  Set("kefir", "dairy", 3000, 1000);
+  EXPECT_EQ(cart_->total_discount(), 0);
+
+  // Третя одиниця кваліфікує правило для всіх рядків.
+  Set("yogurt", "dairy", 1000, 1000);
+  EXPECT_EQ(changed_.size(), 3u);
+  EXPECT_EQ(cart_->Discount("milk"), 100);
+  EXPECT_EQ(cart_->Discount("kefir"), 150);
+  EXPECT_EQ(cart_->Discount("yogurt"), 50);
+
+  // Поки кваліфікація не змінилася, перераховується лише змінений рядок.
+  Set("milk", "dairy", 2000, 2000);
+  ASSERT_EQ(changed_.size(), 1u);
+  EXPECT_EQ(cart_->Discount("milk"), 200);
+
+  // Рядок перейшов в іншу категорію: лишилось дві одиниці.
+  Set("milk", "bakery", 2000, 2000);
+  Remove("kefir");
+  EXPECT_EQ(cart_->total_discount(), 0);
+  EXPECT_EQ(updates_["milk"], 0);
+  EXPECT_EQ(updates_["yogurt"], 0);
+}
+
+TEST_F(PromoCartTest, EvaluatesOnlyRulesOfChangedLine) {
+  std::vector<PromoRule> rules;
+  for (int i = 0; i < 100; i++) {
+    PromoRule rule = Percent("p" + std::to_string(i), 100 + i);
+    rule.items = {"item" + std::to_string(i)};
+    rules.push_back(rule);
+  }
+  rules.push_back(Percent("global", 100));
+  Load(rules);
+  for (int i = 0; i < 100; i++) {
+    Set("item" + std::to_string(i), "", 1000, 1000);
+  }
+  Set("item42", "", 2000, 1000);
+  EXPECT_EQ(cart_->last_evaluated(), 2u);
+  EXPECT_EQ(cart_->Discount("item42"), 2000 * 142 / 10000);
+  EXPECT_EQ(cart_->size(), 100u);
+}
+
+TEST_F(PromoCartTest, FollowsSchedule) {
+  PromoRule morning = Percent("morning", 1000);
+  morning.schedule.weekdays = 0x1F;
+  morning.schedule.from_minute = 9 * 60;
+  morning.schedule.to_minute = 12 * 60;
+  Load({morning});
+  Set("bread", "", 1500, 1000);
+  EXPECT_EQ(cart_->Discount("bread"), 150);
+
+  Apply([&](auto* changed) { cart_->SetTime(Monday(12 * 60), changed); });
+  EXPECT_EQ(cart_->Discount("bread"), 0);
+  ASSERT_EQ(changed_.size(), 1u);
+  EXPECT_EQ(changed_[0].discount, 0);
+
+  PromoTime saturday = Monday();
+  saturday.weekday = 5;
+  Apply([&](auto* changed) { cart_->SetTime(saturday, changed); });
+  EXPECT_EQ(cart_->total_discount(), 0);
+  Apply([&](auto* changed) { cart_->SetTime(Monday(), changed); });
+  EXPECT_EQ(cart_->Discount("bread"), 150);
+}
+
+// Інкрементальний розрахунок після довільних змін збігається з кошиком,
+// зібраним з нуля, і повідомлення changed відтворюють усі знижки.
+TEST_F(PromoCartTest, IncrementalMatchesFullEvaluation) {
+  const std::vector<std::string> categories = {"dairy", "bakery", "drinks"};
+  PromoRule dairy = Percent("dairy", 700);
+  dairy.categories = {"dairy"};
+  dairy.min_qty = 4;
+  PromoRule drinks = Rule("drinks", PromoKind::kUnitPrice, 2500);
+  drinks.categories = {"drinks"};
+  drinks.stackable = true;
+  PromoRule bundle = Rule("bundle", PromoKind::kBundle, 9000, 3);
+  bundle.items = {"i0", "i1", "i2", "i3", "i4"};
+  PromoRule gift = Rule("gift", PromoKind::kGift, 0, 3, 1);
+  gift.categories = {"bakery"};
+  PromoRule global = Percent("global", 300);
+  global.min_qty = 10;
+  Load({dairy, drinks, bundle, gift, global, Percent("i7", 1500)});
+
+  struct State {
+    std::string category;
+    int64_t price;
+    int64_t qty;
+  };
+  std::map<std::string, State> lines;
+  std::mt19937 random(20261018);
+  for (int step = 0; step < 2000; step++) {
+    const std::string item = "i" + std::to_string(random() % 12);
+    if (random() % 5 == 0) {
+      Remove(item);
+      lines.erase(item);
+    } else {
+      const State line{categories[random() % 3],
+                       static_cast<int64_t>(500 + random() % 5000),
+                       static_cast<int64_t>(random() % 4 == 0
+                                                ? 250 + random() % 2000
+                                                : 1000 * (1 + random() % 3))};
+      Set(item, line.category, line.price, line.qty);
+      lines[item] = line;
+    }
+
+    PromoCart full(rules_);
+    std::vector<PromoLineDiscount> ignored;
+    full.SetTime(Monday(), &ignored);
+    for (const auto& entry : lines) {
+      full.SetLine(entry.first, entry.second.category, entry.second.price,
+                   entry.second.qty, &ignored);
+    }
+    ASSERT_EQ(cart_->total_discount(), full.total_discount()) << step;
+    int64_t reported = 0;
+    for (const auto& entry : lines) {
+      ASSERT_EQ(cart_->Discount(entry.first), full.Discount(entry.first))
+          << step << " " << entry.first;
+      reported += updates_[entry.first];
+    }
+    ASSERT_EQ(reported, cart_->total_discount()) << step;
+  }
+}
+
+}  // namespace
+}  // namespace virok
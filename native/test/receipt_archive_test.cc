@@ -0,0 +1,296 @@
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "archive/archived_receipt.h"
+#include "archive/crc32.h"
+#include "archive/receipt_archive.h"
+
+namespace virok {
+namespace {
+
+namespace fs = std::filesystem;
+
+class ReceiptArchiveTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir_ = fs::temp_directory_path() /
+           ("virok_archive_test_" +
+            std::string(::testing::UnitTest::GetInstance()
+                            ->current_test_info()
+                            ->name()));
+    std::error_code ec;
+    fs::remove_all(dir_, ec);
+  }
+
+  void TearDown() override {
+    std::error_code ec;
+    fs::remove_all(dir_, ec);
+  }
+
+  std::string dir() const { return dir_.u8string(); }
+  fs::path segment(int id) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "receipts-%06d.log", id);
+    return dir_ / name;
+  }
+
+  std::vector<fs::path> Segments() const {
+    std::vector<fs::path> out;
+    for (int id = 1; id < 1000; id++) {
+      if (fs::exists(segment(id))) out.push_back(segment(id));
+    }
+    return out;
+  }
+
+  static std::string ReadFile(const fs::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), {});
+  }
+
+  static ArchivedReceipt Receipt(const std::string& fiscal_number,
+                                 int32_t date, int64_t created_ms) {
+    ArchivedReceipt r;
+    r.fiscal_number = fiscal_number;
+    r.rrn = "rrn-" + fiscal_number;
+    r.created_ms = created_ms;
+    r.date = date;
+    r.doc_type = "sale";
+    r.cashier = "Олена";
+    ArchivedLine line;
+    line.guid = "g-bread";
+    line.code = "1001";
+    line.name = "Хліб";
+    line.barcodes = {"4820000000011", "4820000000011"};
+    line.qty_milli = 2000;
+    line.price = 3250;
+    r.lines.push_back(line);
+    r.total = 6500;
+    r.payments.push_back({"Готівка", 6500});
+    r.visualization = "ЧЕК " + fiscal_number + "\n" + std::string(300, '=');
+    return r;
+  }
+
+  static std::vector<std::string> Numbers(
+      const std::vector<ArchivedReceipt>& receipts) {
+    std::vector<std::string> out;
+    for (const ArchivedReceipt& r : receipts) out.push_back(r.fiscal_number);
+    return out;
+  }
+
+  fs::path dir_;
+};
+
+uint32_t U32(const std::string& data, size_t offset) {
+  uint32_t v = 0;
+  for (int i = 0; i < 4; i++) {
+    v |= static_cast<uint32_t>(static_cast<uint8_t>(data[offset + i]))
+         << (8 * i);
+  }
+  return v;
+}
+
+TEST_F(ReceiptArchiveTest, FindsReceiptsByEveryIndex) {
+  ReceiptArchive archive;
+  std::string error;
+  ASSERT_TRUE(archive.Open(dir(), &error)) << error;
+  ASSERT_TRUE(archive.Put(Receipt("100", 20261016, 1000), &error)) << error;
+  ASSERT_TRUE(archive.Put(Receipt("101", 20261017, 2000), &error));
+  ArchivedReceipt other = Receipt("102", 20261018, 3000);
+  other.rrn.clear();
+  other.lines[0].barcodes = {"4820000000028"};
+  ASSERT_TRUE(archive.Put(other, &error));
+
+  ArchivedReceipt got;
+  ASSERT_TRUE(archive.ByFiscalNumber("101", &got));
+  EXPECT_EQ(got.rrn, "rrn-101");
+  EXPECT_EQ(got.cashier, "Олена");
+  ASSERT_EQ(got.lines.size(), 1u);
+  EXPECT_EQ(got.lines[0].qty_milli, 2000);
+  EXPECT_EQ(got.visualization, Receipt("101", 0, 0).visualization);
+  EXPECT_FALSE(archive.ByFiscalNumber("999", &got));
+
+  EXPECT_EQ(Numbers(archive.ByRrn("rrn-100", 10)),
+            std::vector<std::string>{"100"});
+  // Новіші першими; списки — без візуалізації.
+  const std::vector<ArchivedReceipt> by_date =
+      archive.ByDate(20261016, 20261017, 10);
+  EXPECT_EQ(Numbers(by_date), (std::vector<std::string>{"101", "100"}));
+  EXPECT_TRUE(by_date[0].visualization.empty());
+  EXPECT_EQ(Numbers(archive.ByDate(20261016, 20261018, 2)),
+            (std::vector<std::string>{"102", "101"}));
+  // Штрихкод, повторений у чеку, — один запис.
+  EXPECT_EQ(Numbers(archive.ByBarcode("4820000000011", 10)),
+            (std::vector<std::string>{"101", "100"}));
+
+  // Повторний запис номера замінює попередній.
+  ArchivedReceipt fixed = Receipt("100", 20261016, 1500);
+  fixed.cashier = "Петро";
+  ASSERT_TRUE(archive.Put(fixed, &error));
+  ASSERT_TRUE(archive.ByFiscalNumber("100", &got));
+  EXPECT_EQ(got.cashier, "Петро");
+  EXPECT_EQ(archive.ByRrn("rrn-100", 10).size(), 1u);
+  const ReceiptArchiveStats stats = archive.stats();
+  EXPECT_EQ(stats.receipts, 3u);
+  EXPECT_GT(stats.dead_bytes, 0u);
+
+  // Після перевідкриття — ті самі індекси.
+  archive.Close();
+  ReceiptArchive reopened;
+  ASSERT_TRUE(reopened.Open(dir(), &error)) << error;
+  ASSERT_TRUE(reopened.ByFiscalNumber("100", &got));
+  EXPECT_EQ(got.cashier, "Петро");
+  EXPECT_EQ(reopened.stats().dead_bytes, stats.dead_bytes);
+  EXPECT_EQ(Numbers(reopened.ByBarcode("4820000000011", 10)),
+            (std::vector<std::string>{"101", "100"}));
+}
+
+TEST_F(ReceiptArchiveTest, WritesDocumentedSegmentFormat) {
+  ReceiptArchive archive;
+  std::string error;
+  ASSERT_TRUE(archive.Open(dir(), &error)) << error;
+  const ArchivedReceipt receipt = Receipt("100", 20261018, 1000);
+  ASSERT_TRUE(archive.Put(receipt, &error)) << error;
+
+  // {magic "VRA1", довжина ключів, довжина тіла, CRC-32 ключів і тіла}.
+  const std::string data = ReadFile(segment(1));
+  ASSERT_GE(data.size(), 16u);
+  EXPECT_EQ(data.substr(0, 4), "VRA1");
+  std::string keys;
+  std::string body;
+  EncodeReceiptKeys(receipt, &keys);
+  EncodeReceiptBody(receipt, &body);
+  EXPECT_EQ(U32(data, 4), keys.size());
+  EXPECT_EQ(U32(data, 8), body.size());
+  EXPECT_EQ(data.size(), 16 + keys.size() + body.size());
+  EXPECT_EQ(data.substr(16, keys.size()), keys);
+  EXPECT_EQ(data.substr(16 + keys.size()), body);
+  EXPECT_EQ(U32(data, 12), Crc32(data.data() + 16, data.size() - 16));
+  EXPECT_EQ(archive.stats().bytes, data.size());
+}
+
+TEST_F(ReceiptArchiveTest, TruncatesTornTail) {
+  std::string error;
+  uint64_t whole = 0;
+  {
+    ReceiptArchive archive;
+    ASSERT_TRUE(archive.Open(dir(), &error)) << error;
+    for (int i = 0; i < 3; i++) {
+      ASSERT_TRUE(archive.Put(Receipt(std::to_string(100 + i), 20261018, i),
+                              &error));
+    }
+    whole = archive.stats().bytes;
+  }
+  const std::string data = ReadFile(segment(1));
+  ASSERT_EQ(data.size(), whole);
+  const size_t record = U32(data, 4) + U32(data, 8) + 16;
+
+  // Збій живлення посеред четвертого запису: половина запису в кінці.
+  {
+    std::ofstream out(segment(1), std::ios::binary | std::ios::app);
+    out.write(data.data(), record / 2);
+  }
+  {
+    ReceiptArchive archive;
+    ASSERT_TRUE(archive.Open(dir(), &error)) << error;
+    EXPECT_EQ(archive.stats().receipts, 3u);
+    EXPECT_EQ(fs::file_size(segment(1)), whole);
+    // Нові записи — одразу після останнього цілого.
+    ASSERT_TRUE(archive.Put(Receipt("200", 20261018, 10), &error));
+  }
+
+  // Цілий за довжиною, але зіпсований запис теж відрізається.
+  std::string torn = ReadFile(segment(1));
+  torn[torn.size() - 1] ^= 0x5A;
+  {
+    std::ofstream out(segment(1), std::ios::binary | std::ios::trunc);
+    out.write(torn.data(), torn.size());
+  }
+  ReceiptArchive archive;
+  ASSERT_TRUE(archive.Open(dir(), &error)) << error;
+  ArchivedReceipt got;
+  EXPECT_FALSE(archive.ByFiscalNumber("200", &got));
+  EXPECT_TRUE(archive.ByFiscalNumber("102", &got));
+  EXPECT_EQ(archive.stats().receipts, 3u);
+  EXPECT_EQ(fs::file_size(segment(1)), whole);
+}
+
+TEST_F(ReceiptArchiveTest, CompactsExpiredAndSparseSegments) {
+  ReceiptArchiveOptions options;
+  options.segment_bytes = 1;  // запис на сегмент
+  options.retention_days = 30;
+  std::string error;
+  ReceiptArchive archive(options);
+  ASSERT_TRUE(archive.Open(dir(), &error)) << error;
+  // Сегменти 1-2 — прострочені, 3-6 — свіжі; 3 і 4 перезаписуються в 7-8
+  // (мертві), 5 і 6 — живі.
+  ASSERT_TRUE(archive.Put(Receipt("1", 20260101, 1), &error));
+  ASSERT_TRUE(archive.Put(Receipt("2", 20260102, 2), &error));
+  for (int i = 3; i <= 6; i++) {
+    ASSERT_TRUE(archive.Put(Receipt(std::to_string(i), 20261010, i), &error));
+  }
+  ArchivedReceipt three = Receipt("3", 20261010, 3);
+  three.cashier = "Петро";
+  ASSERT_TRUE(archive.Put(three, &error));
+  ASSERT_TRUE(archive.Put(Receipt("4", 20261011, 4), &error));
+  ASSERT_EQ(Segments().size(), 8u);
+
+  // За крок — один сегмент; решта чекає наступного виклику.
+  ReceiptArchiveCompaction result;
+  ASSERT_TRUE(archive.Compact(20261018, &result, 1));
+  EXPECT_EQ(result.expired_segments, 1u);
+  EXPECT_EQ(result.pending_segments, 3u);
+  EXPECT_FALSE(fs::exists(segment(1)));
+
+  ASSERT_TRUE(archive.Compact(20261018, &result));
+  EXPECT_EQ(result.expired_segments, 1u);
+  EXPECT_EQ(result.rewritten_segments, 2u);
+  EXPECT_EQ(result.pending_segments, 0u);
+  EXPECT_GT(result.reclaimed_bytes, 0u);
+  EXPECT_EQ(Segments(), (std::vector<fs::path>{segment(5), segment(6),
+                                               segment(7), segment(8)}));
+
+  // Індекси після перенумерації — ті самі, що й після перевідкриття.
+  auto check = [&](ReceiptArchive* a) {
+    ArchivedReceipt got;
+    EXPECT_FALSE(a->ByFiscalNumber("1", &got));
+    EXPECT_FALSE(a->ByFiscalNumber("2", &got));
+    ASSERT_TRUE(a->ByFiscalNumber("3", &got));
+    EXPECT_EQ(got.cashier, "Петро");
+    EXPECT_EQ(got.visualization, three.visualization);
+    for (const char* n : {"4", "5", "6"}) {
+      EXPECT_TRUE(a->ByFiscalNumber(n, &got)) << n;
+    }
+    EXPECT_TRUE(a->ByRrn("rrn-1", 10).empty());
+    EXPECT_EQ(Numbers(a->ByRrn("rrn-4", 10)), std::vector<std::string>{"4"});
+    EXPECT_TRUE(a->ByDate(20260101, 20260131, 10).empty());
+    EXPECT_EQ(Numbers(a->ByDate(20261010, 20261011, 10)),
+              (std::vector<std::string>{"6", "5", "4", "3"}));
+    EXPECT_EQ(a->ByBarcode("4820000000011", 10).size(), 4u);
+    const ReceiptArchiveStats stats = a->stats();
+    EXPECT_EQ(stats.receipts, 4u);
+    EXPECT_EQ(stats.segments, 4u);
+    EXPECT_EQ(stats.dead_bytes, 0u);
+  };
+  check(&archive);
+  archive.Close();
+
+  ReceiptArchive reopened(options);
+  ASSERT_TRUE(reopened.Open(dir(), &error)) << error;
+  check(&reopened);
+  ASSERT_TRUE(reopened.Compact(20261018, &result));
+  EXPECT_EQ(result.expired_segments + result.rewritten_segments, 0u);
+  ASSERT_TRUE(reopened.Put(Receipt("9", 20261018, 9), &error)) << error;
+  ArchivedReceipt got;
+  EXPECT_TRUE(reopened.ByFiscalNumber("9", &got));
+  EXPECT_EQ(reopened.stats().segments, 5u);
+}
+
+}  // namespace
+}  // namespace virok
@@ -0,0 +1,159 @@
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "printing/escpos.h"
+#include "report/report.h"
+#include "report/report_decoder.h"
+
+namespace virok {
+namespace {
+
+// Відповіді пристроїв із test/data/report.
+std::string Fixture(const std::string& name) {
+  std::ifstream in(std::string(VIROK_TEST_DATA_DIR) + "/report/" + name);
+  std::stringstream text;
+  text << in.rdbuf();
+  EXPECT_FALSE(text.str().empty()) << name;
+  return text.str();
+}
+
+std::string Cp1251(const std::string& utf8) {
+  std::string out;
+  Utf8ToCp1251(utf8, &out);
+  return out;
+}
+
+TEST(ReportDecoderTest, DecodesVchasnoZReport) {
+  Report r;
+  std::string error;
+  ASSERT_TRUE(DecodeReport(Fixture("vchasno_z.json"), &r, &error)) << error;
+
+  EXPECT_EQ(r.res, 0);
+  EXPECT_EQ(r.task, 11);
+  EXPECT_TRUE(r.is_z_rep);
+  EXPECT_EQ(r.dt, "20261017213512");
+  EXPECT_EQ(r.fisid, "4000123456");
+  EXPECT_EQ(r.cashier, "Іваненко Петро");
+  EXPECT_DOUBLE_EQ(r.safe, 312.6);
+  EXPECT_DOUBLE_EQ(r.safe_start_shift, 500);
+  EXPECT_FALSE(r.is_offline);
+  EXPECT_EQ(r.shift_link, 57);
+  EXPECT_EQ(r.shift_prev_link, 56);
+  EXPECT_EQ(r.vacant_off_nums, 1980);
+  EXPECT_TRUE(std::isnan(r.service_input));
+
+  ASSERT_TRUE(r.has_receipt);
+  EXPECT_EQ(r.receipt.last_docno_p, 2811);
+  EXPECT_EQ(r.receipt.count_p, 94);
+  EXPECT_EQ(r.receipt.count_m, 2);
+  ASSERT_TRUE(r.has_summary);
+  EXPECT_DOUBLE_EQ(r.summary.base_p, 1737.4);
+  EXPECT_DOUBLE_EQ(r.summary.disc_p, 42.1);
+  EXPECT_DOUBLE_EQ(r.summary.calc_m, 85.5);
+
+  ASSERT_EQ(r.taxes.size(), 2u);
+  EXPECT_EQ(r.taxes[0].gr_code, 1);
+  EXPECT_EQ(r.taxes[0].tax_lit, "А");
+  EXPECT_DOUBLE_EQ(r.taxes[0].tax_percent, 20);
+  EXPECT_DOUBLE_EQ(r.taxes[0].tax_sum_p, 253.9);
+  EXPECT_EQ(r.taxes[1].tax_name, "Без ПДВ");
+
+  ASSERT_EQ(r.pays.size(), 2u);
+  EXPECT_EQ(r.pays[1].type, 2);
+  EXPECT_EQ(r.pays[1].name, "Картка");
+  EXPECT_DOUBLE_EQ(r.pays[0].sum_p + r.pays[1].sum_p, r.summary.base_p);
+  ASSERT_EQ(r.money.size(), 1u);
+  ASSERT_EQ(r.cash.size(), 1u);
+  EXPECT_DOUBLE_EQ(r.cash[0].sum_p, 0);
+  EXPECT_DOUBLE_EQ(r.cash[0].sum_m, 714.3);
+
+  ASSERT_TRUE(r.has_last_check);
+  EXPECT_EQ(r.last_check.fisnum, "4000123456/2811");
+  ASSERT_EQ(r.warnings.size(), 1u);
+  EXPECT_EQ(r.warnings[0].code, 3);
+  ASSERT_TRUE(r.has_billing);
+  EXPECT_EQ(r.billing.paid_date_to, "2026-12-31");
+  ASSERT_TRUE(r.has_print_header);
+  EXPECT_EQ(r.print_header.shopname, "Магазин №1");
+  EXPECT_EQ(r.print_header.name, "ТОВ \"ВІРОК\"");
+
+  // Візуалізація Vchasno — UTF-8; на принтер іде CP1251.
+  std::string text;
+  ASSERT_TRUE(Base64Decode(r.visualization, &text));
+  EXPECT_EQ(r.print_data, std::string(kEscPosInit) + Cp1251(text) +
+                              std::string(kEscPosFeedCut));
+  EXPECT_NE(r.print_data.find(Cp1251("Z-ЗВІТ № 57")), std::string::npos);
+}
+
+TEST(ReportDecoderTest, DecodesCashalotXReport) {
+  Report r;
+  std::string error;
+  ASSERT_TRUE(DecodeReport(Fixture("cashalot_x.json"), &r, &error)) << error;
+
+  EXPECT_EQ(r.res, -1);
+  EXPECT_FALSE(r.is_z_rep);
+  // Запасні поля кореня.
+  EXPECT_EQ(r.dt, "2026-10-17T18:20:05");
+  EXPECT_EQ(r.fisid, "4000654321");
+  EXPECT_TRUE(r.is_offline);
+  EXPECT_EQ(r.shift_opened, "2026-10-17T08:01:44");
+  // Сума рядком і з комою.
+  EXPECT_DOUBLE_EQ(r.service_input, 150.5);
+  EXPECT_DOUBLE_EQ(r.service_output, 75);
+  EXPECT_FALSE(r.has_summary);
+  EXPECT_TRUE(r.taxes.empty());
+
+  // Cashalot віддає текст уже в CP1251 — друкується як є.
+  std::string text;
+  ASSERT_TRUE(Base64Decode(r.visualization, &text));
+  EXPECT_EQ(text.substr(0, 4), Cp1251("ПРРО"));
+  EXPECT_EQ(r.print_data, std::string(kEscPosInit) + text +
+                              std::string(kEscPosFeedCut));
+}
+
+TEST(ReportDecoderTest, ToleratesLooseTypes) {
+  Report r;
+  std::string error;
+  ASSERT_TRUE(DecodeReport(
+      R"({"info": {"task": "11", "safe": "1 0", "isoffline": 1,)"
+      R"( "shift_link": 4.0, "receipt": [], "pays": [1, {"sum_p": "2,5"}],)"
+      R"( "unknown": {"deep": [{}]}}, "Visualization": "@@@"})",
+      &r, &error))
+      << error;
+  EXPECT_EQ(r.task, 11);
+  EXPECT_TRUE(r.is_z_rep);
+  // Рядок, що не є числом, лишає значення за замовчуванням.
+  EXPECT_DOUBLE_EQ(r.safe, 0);
+  EXPECT_TRUE(r.is_offline);
+  EXPECT_EQ(r.shift_link, 4);
+  ASSERT_EQ(r.pays.size(), 1u);
+  EXPECT_DOUBLE_EQ(r.pays[0].sum_p, 2.5);
+  // Некоректний base64 — нічого друкувати.
+  EXPECT_EQ(r.visualization, "@@@");
+  EXPECT_TRUE(r.print_data.empty());
+}
+
+TEST(ReportDecoderTest, RejectsMalformedJson) {
+  Report r;
+  std::string error;
+  EXPECT_FALSE(DecodeReport("[]", &r, &error));
+  EXPECT_FALSE(error.empty());
+
+  // Обрізана відповідь (обірване з'єднання).
+  const std::string z = Fixture("vchasno_z.json");
+  error.clear();
+  EXPECT_FALSE(DecodeReport(z.substr(0, z.size() / 2), &r, &error));
+  EXPECT_NE(error.find("offset"), std::string::npos) << error;
+
+  error.clear();
+  EXPECT_FALSE(DecodeReport(R"({"info": {"task": 11,}})", &r, &error));
+  EXPECT_FALSE(error.empty());
+  EXPECT_FALSE(DecodeReport(R"({"res": 0} trailing)", &r, nullptr));
+}
+
+}  // namespace
+}  // namespace virok
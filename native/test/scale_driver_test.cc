@@ -0,0 +1,407 @@
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "scale/scale_driver.h"
+#include "scale/scale_protocol.h"
+#include "scale/stable_weight_detector.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+namespace virok {
+namespace {
+
+using std::chrono::milliseconds;
+using Clock = StableWeightDetector::Clock;
+using Kind = StableWeightResult::Kind;
+
+std::vector<ScaleReading> Parse(ScaleProtocol protocol,
+                                const std::vector<std::string>& chunks) {
+  ScaleFrameParser parser(protocol);
+  std::vector<ScaleReading> out;
+  for (const std::string& chunk : chunks) parser.Feed(chunk, &out);
+  return out;
+}
+
+ScaleReading Grams(int64_t grams, bool device_stable = false) {
+  ScaleReading r;
+  r.grams = grams;
+  r.has_weight = true;
+  r.device_stable = device_stable;
+  return r;
+}
+
+TEST(ScaleFrameParserTest, CasFramesSplitAcrossReads) {
+  const auto out = Parse(ScaleProtocol::kCasAscii,
+                         {"US,GS,+  0.8", "40kg\r\nST,GS,+  1.234kg\r\n",
+                          "\x05garbage\r\nOL,GS,+  -.---kg\r\nST,NT,01,+ 120 g",
+                          "\r\n"});
+  ASSERT_EQ(out.size(), 4u);
+  EXPECT_EQ(out[0].grams, 840);
+  EXPECT_FALSE(out[0].device_stable);
+  EXPECT_EQ(out[1].grams, 1234);
+  EXPECT_TRUE(out[1].device_stable);
+  EXPECT_TRUE(out[2].out_of_range);
+  EXPECT_FALSE(out[2].has_weight);
+  EXPECT_EQ(out[3].grams, 120);
+}
+
+TEST(ScaleFrameParserTest, MtSicsReplies) {
+  const auto out = Parse(ScaleProtocol::kMtSics,
+                         {"S D      0.498 kg\r\nS S      0.512 kg\r\n",
+                          "S I\r\nES\r\nS +\r\nS S    -0.004 kg\r\n"});
+  ASSERT_EQ(out.size(), 4u);
+  EXPECT_EQ(out[0].grams, 498);
+  EXPECT_FALSE(out[0].device_stable);
+  EXPECT_EQ(out[1].grams, 512);
+  EXPECT_TRUE(out[1].device_stable);
+  EXPECT_TRUE(out[2].out_of_range);
+  EXPECT_TRUE(out[3].out_of_range);
+  EXPECT_EQ(ScaleFrameParser(ScaleProtocol::kMtSics).PollCommand(), "SI\r\n");
+}
+
+TEST(ScaleFrameParserTest, Toledo8217WeightAndMotion) {
+  const auto out = Parse(ScaleProtocol::kToledo8217,
+                         {"\r\x02" "01.2", "05\r\x02?A\r\x02?\x20\r"});
+  ASSERT_EQ(out.size(), 3u);
+  EXPECT_EQ(out[0].grams, 1205);
+  EXPECT_TRUE(out[0].has_weight);
+  EXPECT_FALSE(out[1].has_weight);
+  EXPECT_FALSE(out[1].out_of_range);
+  EXPECT_TRUE(out[2].out_of_range);
+}
+
+TEST(StableWeightDetectorTest, ReportsOncePerPlateauAfterSettle) {
+  StableWeightOptions options;
+  options.settle = milliseconds(200);
+  options.trust_device_flag = false;
+  StableWeightDetector detector(options);
+  Clock::time_point t = Clock::now();
+  const Clock::time_point loaded = t;
+
+  // Товар кладуть: показання стрибають, потім тримаються 1234 ± 1.
+  for (int64_t g : {350, 900, 1310, 1180, 1250}) {
+    EXPECT_EQ(detector.Add(Grams(g), t).kind, Kind::kNone);
+    t += milliseconds(50);
+  }
+  const Clock::time_point plateau = t;
+  std::vector<StableWeightResult> stable;
+  for (int i = 0; i < 20; i++) {
+    const StableWeightResult r = detector.Add(Grams(1233 + i % 3), t);
+    if (r.kind != Kind::kNone) stable.push_back(r);
+    t += milliseconds(50);
+  }
+  ASSERT_EQ(stable.size(), 1u);
+  EXPECT_EQ(stable[0].kind, Kind::kStable);
+  EXPECT_NEAR(stable[0].grams, 1234, 1);
+  EXPECT_EQ(stable[0].settle_latency_us, 200000);
+  EXPECT_EQ(stable[0].load_latency_us,
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                plateau - loaded + milliseconds(200))
+                .count());
+
+  // Мить у русі тієї ж маси не додає товар удруге.
+  EXPECT_EQ(detector.Add(ScaleReading(), t).kind, Kind::kNone);
+  for (int i = 0; i < 10; i++) {
+    t += milliseconds(50);
+    EXPECT_EQ(detector.Add(Grams(1234), t).kind, Kind::kNone);
+  }
+
+  // Платформу звільнили, а потім зважують наступний товар.
+  t += milliseconds(50);
+  EXPECT_EQ(detector.Add(Grams(0), t).kind, Kind::kRemoved);
+  EXPECT_FALSE(detector.settled());
+  StableWeightResult next;
+  for (int i = 0; i < 10 && next.kind == Kind::kNone; i++) {
+    t += milliseconds(50);
+    next = detector.Add(Grams(640), t);
+  }
+  EXPECT_EQ(next.kind, Kind::kStable);
+  EXPECT_EQ(next.grams, 640);
+}
+
+TEST(StableWeightDetectorTest, AddedGoodsReportNewWeight) {
+  StableWeightOptions options;
+  options.settle = milliseconds(100);
+  StableWeightDetector detector(options);
+  Clock::time_point t = Clock::now();
+  std::vector<int64_t> reported;
+  for (int64_t g : {500, 500, 500, 500, 820, 820, 820, 820}) {
+    const StableWeightResult r = detector.Add(Grams(g), t);
+    if (r.kind == Kind::kStable) reported.push_back(r.grams);
+    t += milliseconds(50);
+  }
+  EXPECT_EQ(reported, (std::vector<int64_t>{500, 820}));
+}
+
+TEST(StableWeightDetectorTest, DeviceFlagConfirmsEarly) {
+  StableWeightOptions options;
+  options.settle = milliseconds(500);
+  StableWeightDetector detector(options);
+  Clock::time_point t = Clock::now();
+  EXPECT_EQ(detector.Add(Grams(750, true), t).kind, Kind::kNone);
+  t += milliseconds(50);
+  const StableWeightResult r = detector.Add(Grams(751, true), t);
+  EXPECT_EQ(r.kind, Kind::kStable);
+  EXPECT_EQ(r.settle_latency_us, 50000);
+
+  // Без прапорця — лише після settle.
+  options.trust_device_flag = false;
+  StableWeightDetector strict(options);
+  EXPECT_EQ(strict.Add(Grams(750, true), t).kind, Kind::kNone);
+  EXPECT_EQ(strict.Add(Grams(751, true), t + milliseconds(50)).kind,
+            Kind::kNone);
+}
+
+TEST(StableWeightDetectorTest, EmptyPlatformAndNoiseNeverSettle) {
+  StableWeightDetector detector;
+  Clock::time_point t = Clock::now();
+  for (int i = 0; i < 100; i++) {
+    // Порожня платформа з дрейфом нуля і вантаж, що гойдається.
+    const int64_t g = i < 50 ? i % 5 : 400 + (i % 2) * 30;
+    EXPECT_EQ(detector.Add(Grams(g), t).kind, Kind::kNone);
+    t += milliseconds(50);
+  }
+}
+
+#ifndef _WIN32
+
+// Симулятор ваг на псевдотерміналі: драйвер відкриває підлеглий кінець як
+// звичайний послідовний порт, а тест пише й читає головний.
+class PtyScale {
+ public:
+  PtyScale() {
+    master_ = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master_ < 0 || grantpt(master_) != 0 || unlockpt(master_) != 0) {
+      return;
+    }
+    path_ = ptsname(master_);
+    // Тримаємо підлеглий кінець відкритим і без ехо ще до драйвера, щоб
+    // байти симулятора не поверталися в головний.
+    slave_ = open(path_.c_str(), O_RDWR | O_NOCTTY);
+    termios tio = {};
+    tcgetattr(slave_, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(slave_, TCSANOW, &tio);
+  }
+  ~PtyScale() {
+    CloseMaster();
+    if (slave_ >= 0) close(slave_);
+  }
+
+  bool ok() const { return master_ >= 0 && slave_ >= 0; }
+  const std::string& path() const { return path_; }
+
+  void Send(const std::string& bytes) {
+    ASSERT_EQ(write(master_, bytes.data(), bytes.size()),
+              static_cast<ssize_t>(bytes.size()));
+  }
+
+  // Наступний запит драйвера (до '\n') або порожній рядок за тайм-аутом.
+  std::string ReadRequest(int timeout_ms) {
+    std::string line;
+    char c;
+    pollfd pfd = {master_, POLLIN, 0};
+    while (poll(&pfd, 1, timeout_ms) > 0 && read(master_, &c, 1) == 1) {
+      line.push_back(c);
+      if (c == '\n') return line;
+    }
+    return {};
+  }
+
+  void CloseMaster() {
+    if (master_ >= 0) close(master_);
+    master_ = -1;
+  }
+
+ private:
+  int master_ = -1;
+  int slave_ = -1;
+  std::string path_;
+};
+
+// Події драйвера з потоку вводу-виводу.
+class EventLog {
+ public:
+  ScaleListener listener() {
+    return [this](const ScaleEvent& event) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      events_.push_back({event, Clock::now()});
+      cv_.notify_all();
+    };
+  }
+
+  // Перша подія |type| після вже повернутих; false за тайм-аутом.
+  bool Wait(ScaleEvent::Type type, milliseconds timeout, ScaleEvent* out,
+            Clock::time_point* at = nullptr) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const bool found = cv_.wait_for(lock, timeout, [&] {
+      for (; next_ < events_.size(); next_++) {
+        if (events_[next_].first.type == type) return true;
+      }
+      return false;
+    });
+    if (!found) return false;
+    *out = events_[next_].first;
+    if (at) *at = events_[next_].second;
+    next_++;
+    return true;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<std::pair<ScaleEvent, Clock::time_point>> events_;
+  size_t next_ = 0;
+};
+
+std::string CasFrame(int64_t grams, bool stable) {
+  char buf[64];
+  std::snprintf(buf, sizeof(buf), "%s,GS,+%3lld.%03lldkg\r\n",
+                stable ? "ST" : "US", static_cast<long long>(grams / 1000),
+                static_cast<long long>(grams % 1000));
+  return buf;
+}
+
+TEST(ScaleDriverTest, CasStreamOverPseudoTerminal) {
+  PtyScale scale;
+  ASSERT_TRUE(scale.ok());
+  EventLog log;
+  ScaleDriver driver(log.listener());
+  ScaleOptions options;
+  options.port = scale.path();
+  options.protocol = ScaleProtocol::kCasAscii;
+  options.stable.settle = milliseconds(200);
+  options.stable.trust_device_flag = false;
+  std::string error;
+  ASSERT_TRUE(driver.Start(options, &error)) << error;
+  ScaleEvent event;
+  ASSERT_TRUE(log.Wait(ScaleEvent::Type::kConnected, milliseconds(1000),
+                       &event));
+  EXPECT_EQ(driver.stable_grams(), -1);
+
+  // Ваги шлють кадр кожні 20 мс: порожньо, товар кладуть, маса тримається.
+  const auto frame = milliseconds(20);
+  for (int i = 0; i < 5; i++) {
+    scale.Send(CasFrame(0, true));
+    std::this_thread::sleep_for(frame);
+  }
+  for (int64_t g : {310, 880, 1290, 1195, 1241}) {
+    scale.Send(CasFrame(g, false));
+    std::this_thread::sleep_for(frame);
+  }
+  const Clock::time_point plateau = Clock::now();
+  std::thread stream([&] {
+    for (int i = 0; i < 25; i++) {
+      scale.Send(CasFrame(1233 + i % 3, i > 5));
+      std::this_thread::sleep_for(frame);
+    }
+  });
+  Clock::time_point detected;
+  ASSERT_TRUE(log.Wait(ScaleEvent::Type::kStable, milliseconds(2000), &event,
+                       &detected));
+  stream.join();
+  EXPECT_NEAR(event.grams, 1234, 1);
+  // Маса лишається на платформі: її видно й без нової події.
+  EXPECT_EQ(driver.stable_grams(), event.grams);
+  EXPECT_GE(event.settle_latency_us, 200000);
+  const auto observed = std::chrono::duration_cast<std::chrono::microseconds>(
+      detected - plateau);
+  std::printf("cas: settle latency %lld us (driver), %lld us (observed), "
+              "load latency %lld us\n",
+              static_cast<long long>(event.settle_latency_us),
+              static_cast<long long>(observed.count()),
+              static_cast<long long>(event.load_latency_us));
+  // Кадр читається й розбирається одразу, а не за опитуванням UI.
+  EXPECT_LT(observed.count(), 200000 + 150000);
+
+  for (int i = 0; i < 3; i++) scale.Send(CasFrame(0, true));
+  ASSERT_TRUE(log.Wait(ScaleEvent::Type::kRemoved, milliseconds(1000),
+                       &event));
+  EXPECT_EQ(driver.stable_grams(), -1);
+  driver.Stop();
+}
+
+TEST(ScaleDriverTest, MtSicsPolledOverPseudoTerminal) {
+  PtyScale scale;
+  ASSERT_TRUE(scale.ok());
+  EventLog log;
+  ScaleDriver driver(log.listener());
+  ScaleOptions options;
+  options.port = scale.path();
+  options.protocol = ScaleProtocol::kMtSics;
+  options.poll_interval = milliseconds(20);
+  std::string error;
+  ASSERT_TRUE(driver.Start(options, &error)) << error;
+
+  // Відповідаємо на кожен SI: спершу в русі, потім стабільно 0.512 кг.
+  int requests = 0;
+  std::thread responder([&] {
+    for (int i = 0; i < 20; i++) {
+      const std::string request = scale.ReadRequest(1000);
+      if (request != "SI\r\n") break;
+      requests++;
+      scale.Send(i < 4 ? "S D      0.47" + std::to_string(i) + " kg\r\n"
+                       : std::string("S S      0.512 kg\r\n"));
+    }
+  });
+  ScaleEvent event;
+  ASSERT_TRUE(log.Wait(ScaleEvent::Type::kStable, milliseconds(2000),
+                       &event));
+  EXPECT_EQ(event.grams, 512);
+  // Прапорець ваг підтверджує вже друге стабільне показання.
+  EXPECT_LT(event.settle_latency_us, 100000);
+  std::printf("mt-sics: settle latency %lld us\n",
+              static_cast<long long>(event.settle_latency_us));
+  responder.join();
+  EXPECT_GE(requests, 6);
+  driver.Stop();
+}
+
+TEST(ScaleDriverTest, ReportsLostPort) {
+  PtyScale scale;
+  ASSERT_TRUE(scale.ok());
+  EventLog log;
+  ScaleDriver driver(log.listener());
+  ScaleOptions options;
+  options.port = scale.path();
+  options.reconnect_delay = milliseconds(50);
+  std::string error;
+  ASSERT_TRUE(driver.Start(options, &error)) << error;
+  scale.CloseMaster();
+  ScaleEvent event;
+  ASSERT_TRUE(log.Wait(ScaleEvent::Type::kDisconnected, milliseconds(2000),
+                       &event));
+  EXPECT_FALSE(event.error.empty());
+  // Повторні спроби відкрити зниклий порт не заважають зупинці.
+  std::this_thread::sleep_for(milliseconds(120));
+  driver.Stop();
+  EXPECT_FALSE(driver.running());
+}
+
+#endif  // _WIN32
+
+TEST(ScaleDriverTest, StartFailsOnMissingPort) {
+  ScaleDriver driver([](const ScaleEvent&) {});
+  ScaleOptions options;
+  options.port = "/nonexistent/virok-scale";
+  std::string error;
+  EXPECT_FALSE(driver.Start(options, &error));
+  EXPECT_FALSE(error.empty());
+  EXPECT_FALSE(driver.running());
+}
+
+}  // namespace
+}  // namespace virok
@@ -0,0 +1,247 @@
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "scanner/scanner_key_filter.h"
+
+namespace virok {
+namespace {
+
+using std::chrono::milliseconds;
+using Clock = ScannerKeyFilter::Clock;
+using Type = ScannerKey::Type;
+
+// Що отримав би застосунок, якби раннер відтворював запис.
+struct Replay {
+  std::vector<ScannerKey> keys;
+  // Події, доставлені застосунку, у порядку доставки.
+  std::vector<uint64_t> delivered;
+  std::vector<uint64_t> dropped;
+  std::vector<std::string> barcodes;
+  std::vector<int64_t> burst_us;
+
+  // Текст, який надрукували б доставлені натискання.
+  std::string Typed() const {
+    std::string text;
+    for (uint64_t token : delivered) {
+      const ScannerKey& key = keys[token];
+      if (key.type == Type::kDown && key.ch >= 0x20 && key.ch < 0x80) {
+        text.push_back(static_cast<char>(key.ch));
+      } else if (key.type == Type::kDown && key.ch == U'\r') {
+        text += "<enter>";
+      }
+    }
+    return text;
+  }
+};
+
+std::vector<ScannerKey> Load(const std::string& name, Clock::time_point t0) {
+  std::ifstream in(std::string(VIROK_TEST_DATA_DIR) + "/scanner/" + name +
+                   ".keys");
+  std::stringstream text;
+  text << in.rdbuf();
+  std::vector<ScannerKey> keys;
+  std::string error;
+  EXPECT_TRUE(ParseScannerRecording(text.str(), t0, &keys, &error)) << error;
+  EXPECT_FALSE(keys.empty()) << name;
+  return keys;
+}
+
+void Collect(ScannerOutput* out, Replay* replay) {
+  for (uint64_t token : out->release) replay->delivered.push_back(token);
+  for (uint64_t token : out->drop) replay->dropped.push_back(token);
+  if (!out->barcode.empty()) {
+    replay->barcodes.push_back(out->barcode);
+    replay->burst_us.push_back(out->burst_us);
+  }
+  out->Clear();
+}
+
+// Відтворює запис так, як це робить раннер: таймер спрацьовує через 1 мс
+// після deadline(), якщо наступна подія не прийшла раніше.
+Replay ReplayRecording(const std::string& name,
+                       const ScannerOptions& options = {}) {
+  const Clock::time_point t0 = Clock::now();
+  Replay replay;
+  replay.keys = Load(name, t0);
+  ScannerKeyFilter filter(options);
+  ScannerOutput out;
+  for (const ScannerKey& key : replay.keys) {
+    if (filter.holding() && key.time > filter.deadline() + milliseconds(1)) {
+      filter.Expire(filter.deadline() + milliseconds(1), &out);
+      Collect(&out, &replay);
+    }
+    const bool taken = filter.Filter(key, &out);
+    Collect(&out, &replay);
+    if (!taken) replay.delivered.push_back(key.token);
+  }
+  filter.Expire(replay.keys.back().time + milliseconds(1000), &out);
+  Collect(&out, &replay);
+  EXPECT_FALSE(filter.holding());
+  return replay;
+}
+
+// Кожна подія або доставлена, або поглинута, рівно один раз; доставлені
+// натискання мають пару-відпускання і навпаки (інакше Flutter вважатиме
+// клавішу затиснутою).
+void ExpectConsistent(const Replay& replay) {
+  std::vector<int> seen(replay.keys.size(), 0);
+  for (uint64_t token : replay.delivered) ++seen[token];
+  for (uint64_t token : replay.dropped) ++seen[token];
+  for (size_t i = 0; i < seen.size(); ++i) {
+    EXPECT_EQ(seen[i], 1) << "event " << i;
+  }
+  std::map<uint32_t, int> down;
+  for (uint64_t token : replay.delivered) {
+    const ScannerKey& key = replay.keys[token];
+    if (key.type == Type::kDown) {
+      down[key.code] = 1;
+    } else {
+      EXPECT_EQ(down[key.code], 1) << "stray key-up, event " << token;
+      down[key.code] = 0;
+    }
+  }
+  for (const auto& [code, pressed] : down) {
+    EXPECT_EQ(pressed, 0) << "key " << code << " left pressed";
+  }
+}
+
+TEST(ScannerKeyFilterTest, Ean13BurstBecomesOneBarcode) {
+  const Replay replay = ReplayRecording("ean13");
+  ASSERT_EQ(replay.barcodes.size(), 1u);
+  EXPECT_EQ(replay.barcodes[0], "4820000123457");
+  EXPECT_TRUE(replay.delivered.empty());
+  // 13 символів по ~4 мс.
+  EXPECT_GT(replay.burst_us[0], 40000);
+  EXPECT_LT(replay.burst_us[0], 60000);
+  ExpectConsistent(replay);
+}
+
+TEST(ScannerKeyFilterTest, HumanTypingPassesThroughInOrder) {
+  const Replay replay = ReplayRecording("human");
+  EXPECT_TRUE(replay.barcodes.empty());
+  EXPECT_TRUE(replay.dropped.empty());
+  EXPECT_EQ(replay.Typed(), "milk 2<enter>");
+  // Порядок подій не змінено, лише відкладено.
+  for (size_t i = 0; i < replay.delivered.size(); ++i) {
+    EXPECT_EQ(replay.delivered[i], i);
+  }
+  ExpectConsistent(replay);
+}
+
+TEST(ScannerKeyFilterTest, ShiftedCharactersStayInTheBurst) {
+  const Replay replay = ReplayRecording("code128");
+  ASSERT_EQ(replay.barcodes.size(), 1u);
+  EXPECT_EQ(replay.barcodes[0], "AB-1234");
+  ExpectConsistent(replay);
+}
+
+TEST(ScannerKeyFilterTest, ScanBetweenTypedKeysDoesNotInterleave) {
+  const Replay replay = ReplayRecording("mixed");
+  ASSERT_EQ(replay.barcodes.size(), 1u);
+  EXPECT_EQ(replay.barcodes[0], "5901234123457");
+  EXPECT_EQ(replay.Typed(), "123");
+  ExpectConsistent(replay);
+}
+
+TEST(ScannerKeyFilterTest, AutorepeatIsNotAScan) {
+  const Replay replay = ReplayRecording("repeat");
+  EXPECT_TRUE(replay.barcodes.empty());
+  EXPECT_EQ(replay.Typed(), "555555555<enter>");
+  ExpectConsistent(replay);
+}
+
+TEST(ScannerKeyFilterTest, ShortFastBurstIsReleased) {
+  const Replay replay = ReplayRecording("short");
+  EXPECT_TRUE(replay.barcodes.empty());
+  EXPECT_EQ(replay.Typed(), "ok<enter>");
+  ExpectConsistent(replay);
+}
+
+TEST(ScannerKeyFilterTest, PrefixAllowsSlowScanner) {
+  // Без префікса темп бездротового сканера не відрізнити від людини.
+  const Replay typed = ReplayRecording("prefixed");
+  EXPECT_TRUE(typed.barcodes.empty());
+  EXPECT_EQ(typed.Typed(), "~4820000123457<enter>");
+  ExpectConsistent(typed);
+
+  ScannerOptions options;
+  options.prefix = U'~';
+  const Replay scanned = ReplayRecording("prefixed", options);
+  ASSERT_EQ(scanned.barcodes.size(), 1u);
+  EXPECT_EQ(scanned.barcodes[0], "4820000123457");
+  EXPECT_EQ(scanned.Typed(), "");
+  ExpectConsistent(scanned);
+}
+
+TEST(ScannerKeyFilterTest, CodeWithoutSuffixEndsOnPause) {
+  ScannerOptions options;
+  options.suffix = 0;
+  const Replay replay = ReplayRecording("nosuffix", options);
+  ASSERT_EQ(replay.barcodes.size(), 1u);
+  EXPECT_EQ(replay.barcodes[0], "4820000123457");
+  ExpectConsistent(replay);
+}
+
+TEST(ScannerKeyFilterTest, LateKeyReleasesHeldBeforeItself) {
+  // Таймер не спрацював вчасно (зайнятий цикл): наступна клавіша сама
+  // з'ясовує, що утримане — не сканер.
+  const Clock::time_point t0 = Clock::now();
+  ScannerKeyFilter filter;
+  ScannerOutput out;
+  ScannerKey a;
+  a.code = 38;
+  a.ch = U'a';
+  a.time = t0;
+  a.token = 1;
+  EXPECT_TRUE(filter.Filter(a, &out));
+  ScannerKey s = a;
+  s.code = 39;
+  s.ch = U's';
+  s.time = t0 + milliseconds(200);
+  s.token = 2;
+  EXPECT_TRUE(filter.Filter(s, &out));
+  EXPECT_EQ(out.release, std::vector<uint64_t>{1});
+  EXPECT_TRUE(filter.holding());
+
+  out.Clear();
+  filter.Flush(&out);
+  EXPECT_EQ(out.release, std::vector<uint64_t>{2});
+  EXPECT_FALSE(filter.holding());
+}
+
+TEST(ScannerKeyFilterTest, RecordingRoundTrip) {
+  const Clock::time_point t0 = Clock::now();
+  ScannerKey key;
+  key.type = Type::kUp;
+  key.code = 50;
+  key.modifier = true;
+  key.time = t0 + std::chrono::microseconds(12500);
+  std::string text = FormatScannerKey(key, t0) + "\n";
+  key.type = Type::kDown;
+  key.code = 43;
+  key.ch = U'ж';
+  key.modifier = false;
+  text += FormatScannerKey(key, t0) + "  # коментар\n";
+
+  std::vector<ScannerKey> keys;
+  std::string error;
+  ASSERT_TRUE(ParseScannerRecording(text, t0, &keys, &error)) << error;
+  ASSERT_EQ(keys.size(), 2u);
+  EXPECT_EQ(keys[0].type, Type::kUp);
+  EXPECT_TRUE(keys[0].modifier);
+  EXPECT_EQ(keys[0].ch, 0u);
+  EXPECT_EQ(keys[1].ch, U'ж');
+  EXPECT_EQ(keys[1].time - t0, std::chrono::microseconds(12500));
+
+  EXPECT_FALSE(ParseScannerRecording("1.0 x 5 -\n", t0, &keys, &error));
+  EXPECT_NE(error.find("line 1"), std::string::npos);
+}
+
+}  // namespace
+}  // namespace virok
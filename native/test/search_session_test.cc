@@ -0,0 +1,127 @@
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "search/search_index.h"
+#include "search/search_session.h"
+
+namespace virok {
+namespace {
+
+// Ключі в порядку відображення, з повторами підрядків між товарами.
+std::shared_ptr<const SearchIndex> MakeIndex(int count) {
+  const char* const kWords[] = {"молоко", "молочний", "кефір", "сир",
+                                "сирок", "хліб", "кава"};
+  std::vector<std::string> ids, keys;
+  for (int i = 0; i < count; i++) {
+    ids.push_back("id-" + std::to_string(i));
+    keys.push_back(std::to_string(4820000 + i * 37 % 1000) + " " +
+                   kWords[i * 5 % 7] + " " + std::to_string(i % 17));
+  }
+  return std::make_shared<const SearchIndex>(ids, keys);
+}
+
+// Повний прохід по індексу, як LIKE '%q%' у SQLite.
+std::vector<uint32_t> BruteForce(const SearchIndex& index,
+                                 const std::string& query) {
+  std::vector<uint32_t> rows;
+  for (uint32_t row = 0; row < index.size(); row++) {
+    if (index.key(row).find(query) != std::string_view::npos) {
+      rows.push_back(row);
+    }
+  }
+  return rows;
+}
+
+// Усі сторінки запиту: Update і далі More, доки сесія не вичерпається.
+// Перевіряє ліміт сторінок і total на останній.
+std::vector<uint32_t> AllPages(SearchSession* session,
+                               const std::string& query, size_t limit) {
+  SearchPage page = session->Update(query, limit);
+  std::vector<uint32_t> rows;
+  for (int pages = 0;; pages++) {
+    EXPECT_LE(page.rows.size(), limit) << query;
+    if (!page.exhausted) {
+      EXPECT_EQ(page.rows.size(), limit) << query;
+    }
+    rows.insert(rows.end(), page.rows.begin(), page.rows.end());
+    if (page.exhausted || pages > 10000) break;
+    page = session->More(limit);
+  }
+  if (page.total >= 0) {
+    EXPECT_EQ(page.total, static_cast<int64_t>(rows.size())) << query;
+  }
+  return rows;
+}
+
+// Набір по символу, Backspace, інший запит — видача щоразу та сама, що й
+// у повного проходу.
+TEST(SearchSessionTest, MatchesBruteForceWhileTyping) {
+  const auto index = MakeIndex(2000);
+  const std::vector<std::string> queries = {
+      "м", "мо", "мол", "моло", "молок", "молоко",  // дописування
+      "молок", "мол", "моло", "молоч",              // Backspace і далі
+      "сир", "сир 1", "сир 12", "кава", "4820",     // інші запити
+      "немає", "", "48203"};
+  for (size_t limit : {1u, 7u, 100u, 5000u}) {
+    SearchSession session(index);
+    for (const std::string& query : queries) {
+      const std::vector<uint32_t> want = BruteForce(*index, query);
+      if (query.empty()) {
+        const SearchPage page = session.Update(query, limit);
+        EXPECT_TRUE(page.rows.empty());
+        EXPECT_TRUE(page.exhausted);
+        continue;
+      }
+      EXPECT_EQ(AllPages(&session, query, limit), want)
+          << query << " " << limit;
+    }
+  }
+}
+
+// Перша сторінка не доходить до кінця індексу, а наступний символ
+// звужує частково пораховані рівні; після Backspace повна видача
+// дораховується з того місця.
+TEST(SearchSessionTest, RefinesPartiallyScannedLevels) {
+  const auto index = MakeIndex(2000);
+  SearchSession session(index);
+  for (const std::string query : {"с", "си", "сир", "сиро", "сирок"}) {
+    const SearchPage page = session.Update(query, 3);
+    const std::vector<uint32_t> want = BruteForce(*index, query);
+    ASSERT_GE(want.size(), 3u) << query;
+    EXPECT_EQ(page.rows, std::vector<uint32_t>(want.begin(),
+                                               want.begin() + 3))
+        << query;
+    EXPECT_FALSE(page.exhausted);
+    EXPECT_EQ(page.total, -1);
+  }
+  EXPECT_EQ(session.depth(), 5u);
+
+  EXPECT_EQ(AllPages(&session, "си", 50), BruteForce(*index, "си"));
+  EXPECT_EQ(session.depth(), 2u);
+  EXPECT_EQ(AllPages(&session, "сирок", 50), BruteForce(*index, "сирок"));
+}
+
+TEST(SearchSessionTest, ResetDropsCachedLevels) {
+  SearchSession session(MakeIndex(500));
+  session.Update("мол", 10);
+  ASSERT_EQ(session.depth(), 1u);
+
+  const auto other = MakeIndex(50);
+  session.Reset(other);
+  EXPECT_EQ(session.depth(), 0u);
+  EXPECT_EQ(AllPages(&session, "мол", 10), BruteForce(*other, "мол"));
+
+  // Без індексу — порожня видача, а не падіння.
+  session.Reset(nullptr);
+  const SearchPage page = session.Update("мол", 10);
+  EXPECT_TRUE(page.rows.empty());
+  EXPECT_TRUE(page.exhausted);
+  EXPECT_TRUE(session.More(10).rows.empty());
+}
+
+}  // namespace
+}  // namespace virok
@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "search/search_index.h"
+#include "search/sharded_index.h"
+
+namespace virok {
+namespace {
+
+struct Catalogue {
+  std::vector<std::string> ids;
+  std::vector<std::string> keys;
+  std::vector<std::string> groups;
+};
+
+// Ключі в порядку відображення; групи різного розміру.
+Catalogue MakeCatalogue(int count) {
+  const char* const kWords[] = {"молоко", "кефір", "сир", "хліб", "кава"};
+  Catalogue c;
+  for (int i = 0; i < count; i++) {
+    c.ids.push_back("id-" + std::to_string(i));
+    c.keys.push_back(std::to_string(4820000 + i * 37 % 1000) + " " +
+                     kWords[i * 7 % 5] + " " + std::to_string(i % 13));
+    c.groups.push_back(i % 10 < 6 ? "g0" : "c" + std::to_string(i % 4));
+  }
+  return c;
+}
+
+std::vector<std::string> Expected(const Catalogue& c, const std::string& q,
+                                  size_t limit, size_t* total) {
+  const SearchIndex index(c.ids, c.keys);
+  std::vector<std::string> ids;
+  *total = 0;
+  for (uint32_t row = 0; row < index.size(); row++) {
+    if (!index.Contains(row, q)) continue;
+    if (ids.size() < limit) ids.emplace_back(index.id(row));
+    (*total)++;
+  }
+  return ids;
+}
+
+TEST(ShardedIndexTest, MergesShardsInRankOrder) {
+  const Catalogue c = MakeCatalogue(3000);
+  for (ShardPartition partition :
+       {ShardPartition::kHash, ShardPartition::kCategory}) {
+    for (int threads : {1, 3}) {
+      ShardedIndexOptions options;
+      options.threads = threads;
+      options.shards = 5;
+      options.partition = partition;
+      ShardedIndex::Builder builder(options);
+      for (size_t i = 0; i < c.ids.size(); i++) {
+        builder.Add(c.ids[i], c.keys[i], c.groups[i]);
+      }
+      const std::unique_ptr<ShardedIndex> index = builder.Finish();
+      ASSERT_EQ(index->size(), 3000u);
+      ASSERT_EQ(index->shards(), 5);
+      uint32_t rows = 0;
+      for (int s = 0; s < index->shards(); s++) rows += index->shard_size(s);
+      EXPECT_EQ(rows, 3000u);
+
+      for (const char* query : {"сир 1", "48200", "кава", "немає"}) {
+        size_t want_total;
+        const std::vector<std::string> want =
+            Expected(c, query, 50, &want_total);
+        size_t total = 0;
+        const std::vector<ShardedHit> hits = index->Search(query, 50, &total);
+        ASSERT_EQ(hits.size(), want.size()) << query;
+        for (size_t i = 0; i < hits.size(); i++) {
+          EXPECT_EQ(hits[i].id, want[i]) << query << " " << i;
+          EXPECT_EQ(c.ids[hits[i].rank], want[i]);
+        }
+        EXPECT_EQ(total, want_total) << query;
+        EXPECT_EQ(index->Search(query, 50).size(), want.size());
+      }
+    }
+  }
+}
+
+// Сторінки курсора разом дають ту саму видачу, що й один SearchIndex,
+// і останньою сторінкою знають, що збігів більше немає.
+TEST(ShardedIndexTest, PagesCursorWithoutRescanning) {
+  const Catalogue c = MakeCatalogue(3000);
+  ShardedIndexOptions options;
+  options.threads = 3;
+  options.shards = 5;
+  ShardedIndex::Builder builder(options);
+  for (size_t i = 0; i < c.ids.size(); i++) builder.Add(c.ids[i], c.keys[i]);
+  const std::unique_ptr<ShardedIndex> index = builder.Finish();
+
+  for (const char* query : {"сир 1", "48200", "кава", "немає"}) {
+    for (size_t limit : {1u, 7u, 50u, 5000u}) {
+      size_t want_total;
+      const std::vector<std::string> want =
+          Expected(c, query, c.ids.size(), &want_total);
+      ShardedIndex::Cursor cursor(query);
+      std::vector<std::string> got;
+      for (int page = 0; !cursor.exhausted(); page++) {
+        ASSERT_LE(page, 3000) << query;
+        const std::vector<ShardedHit> hits = index->Next(&cursor, limit);
+        ASSERT_LE(hits.size(), limit);
+        if (!cursor.exhausted()) {
+          ASSERT_EQ(hits.size(), limit) << query;
+        }
+        for (const ShardedHit& hit : hits) {
+          got.emplace_back(hit.id);
+          EXPECT_EQ(c.ids[hit.rank], hit.id);
+        }
+      }
+      EXPECT_EQ(got, want) << query << " " << limit;
+      EXPECT_EQ(cursor.delivered(), want_total);
+      EXPECT_TRUE(index->Next(&cursor, limit).empty());
+    }
+  }
+}
+
+// Дописаний запит звужує вже знайдені збіги курсора, а не шукає заново;
+// видача та сама, що й для свіжого курсора. Інший запит — з нуля.
+TEST(ShardedIndexTest, RequeryRefinesExtendedQuery) {
+  const Catalogue c = MakeCatalogue(3000);
+  ShardedIndexOptions options;
+  options.threads = 3;
+  options.shards = 5;
+  ShardedIndex::Builder builder(options);
+  for (size_t i = 0; i < c.ids.size(); i++) builder.Add(c.ids[i], c.keys[i]);
+  const std::unique_ptr<ShardedIndex> index = builder.Finish();
+
+  ShardedIndex::Cursor cursor;
+  for (const char* query :
+       {"4", "48", "482", "4820", "кава", "кава 1", "сир", "с", "немає"}) {
+    index->Requery(&cursor, query);
+    EXPECT_EQ(cursor.query(), query);
+    size_t want_total;
+    const std::vector<std::string> want =
+        Expected(c, query, c.ids.size(), &want_total);
+    std::vector<std::string> got;
+    // Перша сторінка коротка: дописування з частково пройденими шардами.
+    for (size_t limit = 3; !cursor.exhausted(); limit = 400) {
+      for (const ShardedHit& hit : index->Next(&cursor, limit)) {
+        got.emplace_back(hit.id);
+        EXPECT_EQ(c.ids[hit.rank], hit.id);
+      }
+      if (got.size() >= 3 && std::string(query).size() < 4) break;
+    }
+    if (cursor.exhausted()) {
+      EXPECT_EQ(got, want) << query;
+      EXPECT_EQ(cursor.delivered(), want_total) << query;
+    } else {
+      ASSERT_LE(got.size(), want.size()) << query;
+      EXPECT_EQ(got, std::vector<std::string>(want.begin(),
+                                              want.begin() + got.size()))
+          << query;
+    }
+  }
+}
+
+TEST(ShardedIndexTest, KeepsCategoryInOneShard) {
+  const Catalogue c = MakeCatalogue(1000);
+  ShardedIndexOptions options;
+  options.threads = 2;
+  options.shards = 4;
+  options.partition = ShardPartition::kCategory;
+  ShardedIndex::Builder builder(options);
+  for (size_t i = 0; i < c.ids.size(); i++) {
+    builder.Add(c.ids[i], c.keys[i], c.groups[i]);
+  }
+  const std::unique_ptr<ShardedIndex> index = builder.Finish();
+  // g0 — 60% каталогу — цілком в одному шарді, решта груп — в інших.
+  uint32_t largest = 0;
+  for (int s = 0; s < index->shards(); s++) {
+    largest = std::max(largest, index->shard_size(s));
+  }
+  EXPECT_EQ(largest, 600u);
+}
+
+}  // namespace
+}  // namespace virok
@@ -0,0 +1,209 @@
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "catalogue/shared_catalogue.h"
+#include "ipc/shared_memory.h"
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+namespace virok {
+namespace {
+
+// Області з іменем на процес і тест: паралельні прогони не заважають
+// одне одному, а TearDown прибирає все, що лишилося.
+class SharedCatalogueTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    name_ = "virok-sc-test-" + std::to_string(getpid()) + "-" +
+            ::testing::UnitTest::GetInstance()->current_test_info()->name();
+  }
+
+  void TearDown() override {
+    for (int g = 1; g <= 200; g++) SharedMemory::Unlink(Segment(g));
+    SharedMemory::Unlink(name_);
+  }
+
+  std::string Segment(uint64_t generation) const {
+    return name_ + "-g" + std::to_string(generation);
+  }
+
+  bool SegmentExists(uint64_t generation) const {
+    SharedMemory memory;
+    return memory.OpenReadOnly(Segment(generation));
+  }
+
+  // Каталог версії |version|: рядок i — GUID "g<count - i>" (GUID у
+  // зворотному порядку), ключ "v<version> <i>".
+  static void Rows(uint64_t version, size_t count,
+                   std::vector<std::string>* guids,
+                   std::vector<std::string>* keys) {
+    guids->clear();
+    keys->clear();
+    for (size_t i = 0; i < count; i++) {
+      guids->push_back("g" + std::to_string(count - i));
+      keys->push_back("v" + std::to_string(version) + " " + std::to_string(i));
+    }
+  }
+
+  static bool Publish(SharedCatalogue* catalogue, uint64_t version,
+                      size_t count = 5) {
+    std::vector<std::string> guids;
+    std::vector<std::string> keys;
+    Rows(version, count, &guids, &keys);
+    bool published = false;
+    std::string error;
+    EXPECT_TRUE(catalogue->Publish(guids, keys, version, &published, &error))
+        << error;
+    return published;
+  }
+
+  std::string name_;
+};
+
+TEST_F(SharedCatalogueTest, PublishesGeneration) {
+  SharedCatalogue catalogue(name_);
+  std::string error;
+  ASSERT_TRUE(catalogue.Open(&error)) << error;
+  EXPECT_EQ(catalogue.Current(), nullptr);
+
+  ASSERT_TRUE(Publish(&catalogue, 100));
+  const std::shared_ptr<const CatalogueGeneration> g = catalogue.Current();
+  ASSERT_NE(g, nullptr);
+  EXPECT_EQ(g->generation(), 1u);
+  EXPECT_EQ(g->version(), 100u);
+  ASSERT_EQ(g->size(), 5u);
+  EXPECT_EQ(g->guid(0), "g5");
+  EXPECT_EQ(g->search_key(4), "v100 4");
+  // Пошук за GUID — через перестановку, не за порядком рядків.
+  EXPECT_EQ(g->FindByGuid("g5"), 0u);
+  EXPECT_EQ(g->FindByGuid("g1"), 4u);
+  EXPECT_EQ(g->FindByGuid("g0"), CatalogueGeneration::kNoRow);
+  EXPECT_EQ(g->FindByGuid("g55"), CatalogueGeneration::kNoRow);
+  const SearchIndexView view = g->search_view();
+  EXPECT_EQ(view.count, 5u);
+  EXPECT_EQ(std::string(view.keys + view.key_offsets[1],
+                        view.key_offsets[2] - view.key_offsets[1]),
+            "v100 1");
+
+  // Та сама чи старша версія не публікується.
+  EXPECT_FALSE(Publish(&catalogue, 100));
+  EXPECT_FALSE(Publish(&catalogue, 99));
+  EXPECT_EQ(catalogue.Current(), g);
+
+  // Порожній каталог — теж генерація.
+  ASSERT_TRUE(Publish(&catalogue, 101, 0));
+  EXPECT_EQ(catalogue.Current()->size(), 0u);
+  EXPECT_EQ(catalogue.Current()->FindByGuid("g1"),
+            CatalogueGeneration::kNoRow);
+}
+
+TEST_F(SharedCatalogueTest, ReadersSwapToNewerGeneration) {
+  SharedCatalogue publisher(name_);
+  SharedCatalogue reader(name_);
+  std::string error;
+  ASSERT_TRUE(publisher.Open(&error)) << error;
+  ASSERT_TRUE(reader.Open(&error)) << error;
+  ASSERT_TRUE(Publish(&publisher, 1));
+
+  const std::shared_ptr<const CatalogueGeneration> old = reader.Current();
+  ASSERT_NE(old, nullptr);
+  EXPECT_EQ(old->version(), 1u);
+  // Без нової публікації — той самий об'єкт, без повторного відображення.
+  EXPECT_EQ(reader.Current(), old);
+
+  ASSERT_TRUE(Publish(&publisher, 2, 1000));
+  const std::shared_ptr<const CatalogueGeneration> now = reader.Current();
+  ASSERT_NE(now, nullptr);
+  EXPECT_EQ(now->version(), 2u);
+  EXPECT_EQ(now->size(), 1000u);
+  // Замінену область видалено за іменем, але її відображення живе.
+  EXPECT_FALSE(SegmentExists(old->generation()));
+  EXPECT_TRUE(SegmentExists(now->generation()));
+  EXPECT_EQ(old->search_key(3), "v1 3");
+
+  // Читач не публікує старішу версію поверх новішої.
+  EXPECT_FALSE(Publish(&reader, 1));
+  EXPECT_EQ(publisher.Current()->version(), 2u);
+
+  // Зіпсована область (CRC) не відображається: читач лишається на
+  // попередній генерації.
+  ASSERT_TRUE(Publish(&publisher, 3));
+  const std::shared_ptr<const CatalogueGeneration> bad = publisher.Current();
+  {
+    SharedMemory memory;
+    ASSERT_TRUE(memory.Open(Segment(bad->generation()), bad->bytes()));
+    static_cast<char*>(memory.data())[bad->bytes() - 1] ^= 1;
+  }
+  EXPECT_EQ(reader.Current(), now);
+}
+
+// Кілька кас публікують одночасно, поки інші потоки читають: перемагає
+// найновіша версія, читачі ніколи не повертаються до старішої, а від
+// програлих генерацій не лишається областей.
+TEST_F(SharedCatalogueTest, ConcurrentPublishersKeepNewestVersion) {
+  constexpr int kPublishers = 4;
+  constexpr int kRounds = 10;
+  std::vector<std::unique_ptr<SharedCatalogue>> tills;
+  std::string error;
+  for (int i = 0; i < kPublishers + 1; i++) {
+    tills.push_back(std::make_unique<SharedCatalogue>(name_));
+    ASSERT_TRUE(tills.back()->Open(&error)) << error;
+  }
+
+  std::atomic<bool> done{false};
+  std::atomic<int> regressions{0};
+  std::atomic<int> torn{0};
+  std::vector<std::thread> readers;
+  for (int r = 0; r < 2; r++) {
+    readers.emplace_back([&] {
+      uint64_t seen = 0;
+      SharedCatalogue& reader = *tills.back();
+      while (!done.load()) {
+        const std::shared_ptr<const CatalogueGeneration> g = reader.Current();
+        if (!g) continue;
+        if (g->version() < seen) regressions++;
+        seen = g->version();
+        if (g->search_key(0) != "v" + std::to_string(seen) + " 0") torn++;
+      }
+    });
+  }
+
+  std::vector<std::thread> publishers;
+  for (int p = 0; p < kPublishers; p++) {
+    publishers.emplace_back([&, p] {
+      for (int round = 1; round <= kRounds; round++) {
+        Publish(tills[p].get(), round * kPublishers + p, 200);
+      }
+    });
+  }
+  for (std::thread& t : publishers) t.join();
+  done = true;
+  for (std::thread& t : readers) t.join();
+
+  EXPECT_EQ(regressions.load(), 0);
+  EXPECT_EQ(torn.load(), 0);
+  const uint64_t newest = kRounds * kPublishers + kPublishers - 1;
+  uint64_t generation = 0;
+  for (const auto& till : tills) {
+    const std::shared_ptr<const CatalogueGeneration> g = till->Current();
+    ASSERT_NE(g, nullptr);
+    EXPECT_EQ(g->version(), newest);
+    generation = g->generation();
+  }
+  for (uint64_t g = 1; g <= kRounds * kPublishers; g++) {
+    EXPECT_EQ(SegmentExists(g), g == generation) << g;
+  }
+}
+
+}  // namespace
+}  // namespace virok
@@ -0,0 +1,259 @@
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "archive/archived_receipt.h"
+#include "reconcile/shift_reconciler.h"
+#include "report/report.h"
+
+namespace virok {
+namespace {
+
+ReconcileCheck Check(const std::string& number, int64_t amount,
+                     const std::string& form = "Готівка",
+                     const std::string& rrn = "", bool refund = false) {
+  ReconcileCheck check;
+  check.number = number;
+  check.amount = amount;
+  check.payment_form = form;
+  check.rrn = rrn;
+  check.refund = refund;
+  return check;
+}
+
+// X-звіт, що сходиться з |checks|: обороти за формами, лічильники чеків,
+// готівка в сейфі.
+Report DeviceReport(const std::vector<ReconcileCheck>& checks) {
+  Report report;
+  report.has_receipt = true;
+  for (const ReconcileCheck& check : checks) {
+    auto it = std::find_if(
+        report.pays.begin(), report.pays.end(),
+        [&](const ReportPay& pay) { return pay.name == check.payment_form; });
+    if (it == report.pays.end()) {
+      report.pays.push_back(ReportPay());
+      it = report.pays.end() - 1;
+      it->name = check.payment_form;
+    }
+    (check.refund ? it->sum_m : it->sum_p) += check.amount / 100.0;
+    ++(check.refund ? report.receipt.count_m : report.receipt.count_p);
+    if (check.payment_form == "Готівка") {
+      report.safe += (check.refund ? -check.amount : check.amount) / 100.0;
+    }
+  }
+  return report;
+}
+
+ReconcileSources Sources(const Report& device,
+                         const std::vector<ReconcileCheck>& server,
+                         const std::vector<ReconcileCheck>& till) {
+  ReconcileSources sources;
+  sources.device = [device](Report* out, std::string*) {
+    *out = device;
+    return true;
+  };
+  sources.server = [server](std::vector<ReconcileCheck>* out, std::string*) {
+    *out = server;
+    return true;
+  };
+  sources.till = [till](std::vector<ReconcileCheck>* out, std::string*) {
+    *out = till;
+    return true;
+  };
+  return sources;
+}
+
+std::vector<ReconcileCheck> Shift() {
+  return {Check("4000000001", 4290), Check("4000000002", 12550, "Картка",
+                                           "600000000001"),
+          Check("4000000003", 1999), Check("4000000004", 4290, "Готівка", "",
+                                           true)};
+}
+
+const ReconcileFormTotals* Form(const ReconcileReport& report,
+                                const std::string& form) {
+  for (const ReconcileFormTotals& row : report.forms) {
+    if (row.form == form) return &row;
+  }
+  return nullptr;
+}
+
+TEST(ShiftReconcilerTest, BalancesMatchingShift) {
+  const std::vector<ReconcileCheck> checks = Shift();
+  ReconcileSources sources = Sources(DeviceReport(checks), checks, checks);
+  sources.drawer_counted = 4290 + 1999 - 4290;
+  ReconcileReport report;
+  std::string error;
+  ASSERT_TRUE(ReconcileShift(sources, &report, &error)) << error;
+
+  EXPECT_TRUE(report.balanced());
+  EXPECT_TRUE(report.checks.empty());
+  ASSERT_EQ(report.forms.size(), 2u);
+  const ReconcileFormTotals* cash = Form(report, "Готівка");
+  ASSERT_NE(cash, nullptr);
+  EXPECT_EQ(cash->device, 1999);
+  EXPECT_TRUE(cash->matches());
+  EXPECT_EQ(report.device_sales, 3);
+  EXPECT_EQ(report.till_refunds, 1);
+  EXPECT_EQ(report.cash_expected, 1999);
+
+  // Нестача в шухляді — зміна не зведена, хоч чеки збігаються.
+  sources.drawer_counted = 1949;
+  ASSERT_TRUE(ReconcileShift(sources, &report, &error)) << error;
+  EXPECT_FALSE(report.balanced());
+  EXPECT_TRUE(report.checks.empty());
+}
+
+TEST(ShiftReconcilerTest, ReportsMissingAndExtraChecks) {
+  const std::vector<ReconcileCheck> till = Shift();
+  std::vector<ReconcileCheck> server = till;
+  // Чек 3 не дійшов до сервера; на сервері є чек, якого каса не знає.
+  server.erase(server.begin() + 2);
+  server.push_back(Check("4000000099", 700));
+  // Картковий чек на сервері без фіскального номера — з'єднується за RRN.
+  server[1].number.clear();
+
+  ReconcileReport report;
+  std::string error;
+  ASSERT_TRUE(ReconcileShift(Sources(DeviceReport(till), server, till),
+                             &report, &error))
+      << error;
+  EXPECT_FALSE(report.balanced());
+  ASSERT_EQ(report.checks.size(), 2u);
+  const ReconcileCheckIssue& extra = report.checks[0];
+  EXPECT_EQ(extra.kind, CheckDiscrepancy::kMissingInArchive);
+  EXPECT_EQ(extra.number, "4000000099");
+  EXPECT_EQ(extra.server_amount, 700);
+  EXPECT_EQ(extra.till_amount, 0);
+  const ReconcileCheckIssue& missing = report.checks[1];
+  EXPECT_EQ(missing.kind, CheckDiscrepancy::kMissingOnServer);
+  EXPECT_EQ(missing.number, "4000000003");
+  EXPECT_EQ(missing.till_amount, 1999);
+  EXPECT_STREQ(CheckDiscrepancyName(missing.kind), "missingOnServer");
+
+  const ReconcileFormTotals* cash = Form(report, "Готівка");
+  ASSERT_NE(cash, nullptr);
+  EXPECT_EQ(cash->till - cash->server, 1999 - 700);
+  EXPECT_EQ(report.server_sales, report.till_sales);
+}
+
+TEST(ShiftReconcilerTest, ReportsAmountFormAndRrnMismatch) {
+  const std::vector<ReconcileCheck> till = Shift();
+  std::vector<ReconcileCheck> server = till;
+  server[0].amount = 4200;
+  server[1].payment_form = "картка";  // регістр форми не розбіжність
+  server[2].payment_form = "Картка";
+  server[3].rrn = "600000000077";
+
+  ReconcileReport report;
+  std::string error;
+  ASSERT_TRUE(ReconcileShift(Sources(DeviceReport(till), server, till),
+                             &report, &error))
+      << error;
+  ASSERT_EQ(report.checks.size(), 3u);
+  EXPECT_EQ(report.checks[0].kind, CheckDiscrepancy::kAmountMismatch);
+  EXPECT_EQ(report.checks[0].number, "4000000001");
+  EXPECT_EQ(report.checks[0].server_amount, 4200);
+  EXPECT_EQ(report.checks[0].till_amount, 4290);
+  EXPECT_EQ(report.checks[1].kind, CheckDiscrepancy::kFormMismatch);
+  EXPECT_EQ(report.checks[1].server_form, "Картка");
+  EXPECT_EQ(report.checks[1].till_form, "Готівка");
+  // Повернення — зі знаком мінус.
+  EXPECT_EQ(report.checks[2].kind, CheckDiscrepancy::kRrnMismatch);
+  EXPECT_EQ(report.checks[2].till_amount, -4290);
+
+  const ReconcileFormTotals* card = Form(report, "Картка");
+  ASSERT_NE(card, nullptr);
+  EXPECT_EQ(card->server, 12550 + 1999);
+  EXPECT_FALSE(card->matches());
+}
+
+TEST(ShiftReconcilerTest, ReportsDuplicates) {
+  std::vector<ReconcileCheck> till = Shift();
+  std::vector<ReconcileCheck> server = till;
+  server.push_back(server[0]);
+  till.push_back(Check("4000000005", 800, "Картка", "600000000001"));
+
+  ReconcileReport report;
+  std::string error;
+  ASSERT_TRUE(ReconcileShift(Sources(DeviceReport(till), server, till),
+                             &report, &error))
+      << error;
+  std::vector<CheckDiscrepancy> kinds;
+  for (const ReconcileCheckIssue& issue : report.checks) {
+    kinds.push_back(issue.kind);
+  }
+  EXPECT_EQ(kinds, (std::vector<CheckDiscrepancy>{
+                       CheckDiscrepancy::kDuplicateRrn,
+                       CheckDiscrepancy::kDuplicateNumber,
+                       CheckDiscrepancy::kMissingOnServer}));
+}
+
+TEST(ShiftReconcilerTest, StopsOnSourceError) {
+  const std::vector<ReconcileCheck> checks = Shift();
+  ReconcileSources sources = Sources(DeviceReport(checks), checks, checks);
+  sources.server = [](std::vector<ReconcileCheck>*, std::string* error) {
+    *error = "kkm_checks: 503";
+    return false;
+  };
+  ReconcileReport report;
+  std::string error;
+  EXPECT_FALSE(ReconcileShift(sources, &report, &error));
+  EXPECT_EQ(error, "kkm_checks: 503");
+
+  sources = Sources(DeviceReport(checks), checks, checks);
+  sources.till = nullptr;
+  EXPECT_FALSE(ReconcileShift(sources, &report, &error));
+  EXPECT_EQ(error, "till source is not set");
+}
+
+TEST(ShiftReconcilerTest, ParsesServerChecks) {
+  const std::string json = R"([
+    {"document_number": "4000000001", "amount": 42.9, "payment_form": "Готівка",
+     "status": "Фіскалізовано", "RRN": null, "document_type": "Продаж",
+     "taxes": {"А": 35.75}, "kkm_check_number": 17},
+    {"document_number": null, "amount": 125.5, "payment_form": "Картка",
+     "RRN": "600000000001", "document_type": "Продаж", "taxes": null},
+    {"document_number": "4000000004", "amount": -42.9,
+     "payment_form": "Готівка", "document_type": "Повернення"},
+    {"document_number": "", "amount": 10, "status": "Чек відкладений"}
+  ])";
+  std::vector<ReconcileCheck> checks;
+  std::string error;
+  ASSERT_TRUE(ParseServerChecks(json, &checks, &error)) << error;
+  ASSERT_EQ(checks.size(), 3u);
+  EXPECT_EQ(checks[0].number, "4000000001");
+  EXPECT_EQ(checks[0].amount, 4290);
+  EXPECT_FALSE(checks[0].refund);
+  ASSERT_EQ(checks[0].taxes.size(), 1u);
+  EXPECT_EQ(checks[0].taxes[0].second, 3575);
+  EXPECT_TRUE(checks[1].number.empty());
+  EXPECT_EQ(checks[1].rrn, "600000000001");
+  EXPECT_TRUE(checks[2].refund);
+  EXPECT_EQ(checks[2].amount, 4290);
+
+  EXPECT_FALSE(ParseServerChecks("{}", &checks, &error));
+  EXPECT_FALSE(ParseServerChecks("[{\"amount\": \"x\"}]", &checks, &error));
+}
+
+TEST(ShiftReconcilerTest, ConvertsArchivedReceipt) {
+  ArchivedReceipt receipt;
+  receipt.fiscal_number = "4000000004";
+  receipt.rrn = "600000000001";
+  receipt.doc_type = "return";
+  receipt.total = -4290;
+  receipt.payments.push_back(ArchivedPayment());
+  receipt.payments.back().form = "Картка";
+  const ReconcileCheck check = CheckFromArchive(receipt);
+  EXPECT_EQ(check.number, "4000000004");
+  EXPECT_EQ(check.rrn, "600000000001");
+  EXPECT_EQ(check.payment_form, "Картка");
+  EXPECT_TRUE(check.refund);
+  EXPECT_EQ(check.amount, 4290);
+}
+
+}  // namespace
+}  // namespace virok
@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "ipc/spsc_ring.h"
+
+namespace virok {
+namespace {
+
+// Вирівняна область з виробником (Init) і споживачем (Attach), як у двох
+// процесах.
+class SpscRingTest : public ::testing::Test {
+ protected:
+  void Open(size_t capacity) {
+    memory_.assign(SpscRing::RegionSize(capacity) / 8 + 8, 0);
+    ASSERT_TRUE(producer_.Init(memory_.data(), capacity, "spsc-ring-test"));
+    ASSERT_TRUE(consumer_.Attach(memory_.data(), "spsc-ring-test"));
+  }
+
+  bool Write(const std::string& message) {
+    return producer_.TryWrite(message.data(), message.size());
+  }
+
+  static std::string Message(int n, size_t size) {
+    std::string message(size, static_cast<char>('a' + n % 26));
+    const std::string tag = std::to_string(n) + ":";
+    message.replace(0, std::min(tag.size(), size), tag, 0,
+                    std::min(tag.size(), size));
+    return message;
+  }
+
+  std::vector<uint64_t> memory_;
+  SpscRing producer_;
+  SpscRing consumer_;
+};
+
+TEST_F(SpscRingTest, EmptyAndFull) {
+  Open(256);
+  EXPECT_EQ(producer_.capacity(), 256u);
+  std::string out;
+  EXPECT_TRUE(consumer_.Empty());
+  EXPECT_FALSE(consumer_.TryRead(&out));
+
+  // Запис 28 байтів займає 32 з довжиною: рівно 8 у кільці.
+  int written = 0;
+  while (Write(Message(written, 28))) written++;
+  EXPECT_EQ(written, 8);
+  EXPECT_FALSE(consumer_.Empty());
+
+  // Одне прочитане звільняє місце рівно під один запис.
+  ASSERT_TRUE(consumer_.TryRead(&out));
+  EXPECT_EQ(out, Message(0, 28));
+  EXPECT_TRUE(Write(Message(written++, 28)));
+  EXPECT_FALSE(Write(Message(written, 28)));
+
+  for (int i = 1; i < written; i++) {
+    ASSERT_TRUE(consumer_.TryRead(&out));
+    EXPECT_EQ(out, Message(i, 28));
+  }
+  EXPECT_FALSE(consumer_.TryRead(&out));
+  EXPECT_TRUE(consumer_.Empty());
+}
+
+TEST_F(SpscRingTest, FramesMessagesOfAnySize) {
+  Open(1024);
+  std::string out = "stale";
+  // Порожнє повідомлення — теж повідомлення.
+  ASSERT_TRUE(Write(""));
+  ASSERT_TRUE(consumer_.TryRead(&out));
+  EXPECT_EQ(out, "");
+
+  // Двійкові дані з нулями не обрізаються.
+  const std::string binary("\0\xFF\0\x01", 4);
+  ASSERT_TRUE(Write(binary));
+  ASSERT_TRUE(consumer_.TryRead(&out));
+  EXPECT_EQ(out, binary);
+
+  // Не більше половини ємності.
+  EXPECT_TRUE(Write(std::string(512, 'x')));
+  EXPECT_FALSE(Write(std::string(513, 'x')));
+  ASSERT_TRUE(consumer_.TryRead(&out));
+  EXPECT_EQ(out.size(), 512u);
+}
+
+TEST_F(SpscRingTest, WrapsAroundTheEnd) {
+  Open(256);
+  // Розміри, що не діляться на ємність: мітка переходу стоїть щоразу в
+  // іншому місці буфера.
+  const size_t kSizes[] = {3, 60, 17, 100, 4, 124, 41, 9, 0, 77};
+  std::string out;
+  int next_write = 0, next_read = 0;
+  for (int round = 0; round < 2000; round++) {
+    const size_t size = kSizes[round % 10];
+    if (!Write(Message(next_write, size))) {
+      ASSERT_TRUE(consumer_.TryRead(&out)) << round;
+      ASSERT_EQ(out, Message(next_read, kSizes[next_read % 10])) << round;
+      next_read++;
+      round--;
+      continue;
+    }
+    next_write++;
+    // Споживач відстає на кілька повідомлень.
+    if (round % 3 == 0 && consumer_.TryRead(&out)) {
+      ASSERT_EQ(out, Message(next_read, kSizes[next_read % 10])) << round;
+      next_read++;
+    }
+  }
+  while (consumer_.TryRead(&out)) {
+    ASSERT_EQ(out, Message(next_read, kSizes[next_read % 10]));
+    next_read++;
+  }
+  EXPECT_EQ(next_read, next_write);
+  EXPECT_TRUE(consumer_.Empty());
+}
+
+TEST_F(SpscRingTest, ResetDropsUnreadMessages) {
+  Open(256);
+  ASSERT_TRUE(Write("a"));
+  ASSERT_TRUE(Write("b"));
+  producer_.Reset();
+  std::string out;
+  EXPECT_TRUE(consumer_.Empty());
+  EXPECT_FALSE(consumer_.TryRead(&out));
+  ASSERT_TRUE(Write("c"));
+  ASSERT_TRUE(consumer_.TryRead(&out));
+  EXPECT_EQ(out, "c");
+}
+
+TEST_F(SpscRingTest, WaitReturnsOnTimeoutAndRing) {
+  Open(256);
+  EXPECT_FALSE(consumer_.Wait(std::chrono::milliseconds(30)));
+
+  std::thread ringer([this] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    producer_.Ring();
+  });
+  // Ring будить сплячого споживача задовго до тайм-ауту.
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_FALSE(consumer_.Wait(std::chrono::seconds(10)));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+  ringer.join();
+}
+
+TEST_F(SpscRingTest, StreamsBetweenThreads) {
+  Open(4096);
+  constexpr int kMessages = 100000;
+  std::thread producer([this] {
+    for (int i = 0; i < kMessages; i++) {
+      const std::string message = Message(i, i % 97);
+      while (!Write(message)) std::this_thread::yield();
+    }
+  });
+  std::string out;
+  int received = 0;
+  while (received < kMessages) {
+    if (!consumer_.TryRead(&out)) {
+      consumer_.Wait(std::chrono::milliseconds(100));
+      continue;
+    }
+    ASSERT_EQ(out, Message(received, received % 97));
+    received++;
+  }
+  producer.join();
+  EXPECT_TRUE(consumer_.Empty());
+}
+
+}  // namespace
+}  // namespace virok
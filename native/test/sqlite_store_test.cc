@@ -0,0 +1,216 @@
+#include <sqlite3.h>
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <variant>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "store/sqlite_store.h"
+
+namespace virok {
+namespace {
+
+namespace fs = std::filesystem;
+
+class SqliteStoreTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir_ = fs::temp_directory_path() /
+           ("virok_sqlite_store_test_" +
+            std::string(::testing::UnitTest::GetInstance()
+                            ->current_test_info()
+                            ->name()));
+    std::error_code ec;
+    fs::remove_all(dir_, ec);
+    fs::create_directories(dir_);
+    path_ = (dir_ / "nomenclatura.db").string();
+  }
+
+  void TearDown() override {
+    std::error_code ec;
+    fs::remove_all(dir_, ec);
+  }
+
+  void Open(SqliteStore* store) {
+    SqliteStoreOptions options;
+    options.readers = 2;
+    std::string error;
+    ASSERT_TRUE(store->Open(path_, options, &error)) << error;
+  }
+
+  fs::path dir_;
+  std::string path_;
+};
+
+// Товар з усіма обов'язковими колонками схеми.
+SqlBatch Insert(const std::vector<std::string>& guids) {
+  SqlBatch batch;
+  batch.sql =
+      "INSERT INTO nomenclatura (guid, created_at, name, article, unit_name,"
+      " unit_guid, is_folder, search_name) VALUES (?, '2026-01-01', ?, ?,"
+      " 'шт', 'u1', 0, ?)";
+  for (const std::string& guid : guids) {
+    batch.rows.push_back({guid, "Товар " + guid, "A-" + guid, guid});
+  }
+  return batch;
+}
+
+int64_t Int(const SqlResult& result) {
+  if (result.rows.empty() || result.rows[0].empty()) return -1;
+  const int64_t* value = std::get_if<int64_t>(&result.rows[0][0]);
+  return value ? *value : -1;
+}
+
+int64_t Count(SqliteStore* store) {
+  return Int(store->ReadSync("SELECT COUNT(*) FROM nomenclatura", {}));
+}
+
+std::vector<std::string> Guids(int count) {
+  std::vector<std::string> guids;
+  for (int i = 0; i < count; i++) guids.push_back("g" + std::to_string(i));
+  return guids;
+}
+
+// Порожній файл (user_version 0) отримує всю схему версії 3, яку чекає
+// sqflite, плюс індекс parent_guid.
+TEST_F(SqliteStoreTest, CreatesSchemaFromVersionZero) {
+  SqliteStore store;
+  Open(&store);
+  EXPECT_EQ(Int(store.ReadSync("PRAGMA user_version", {})), 3);
+  const SqlResult indexes = store.ReadSync(
+      "SELECT name FROM sqlite_master WHERE type = 'index'"
+      " AND name LIKE 'idx_nomenclatura_%' ORDER BY name",
+      {});
+  ASSERT_TRUE(indexes.ok) << indexes.error;
+  std::vector<std::string> names;
+  for (const auto& row : indexes.rows) {
+    names.push_back(std::get<std::string>(row[0]));
+  }
+  EXPECT_EQ(names, (std::vector<std::string>{
+                       "idx_nomenclatura_article", "idx_nomenclatura_name",
+                       "idx_nomenclatura_parent_guid",
+                       "idx_nomenclatura_search_name"}));
+
+  SqlBatch batch = Insert({"g1"});
+  batch.sql =
+      "INSERT INTO nomenclatura (guid, created_at, name, article, unit_name,"
+      " unit_guid, is_folder, parent_guid, barcodes, price, search_name)"
+      " VALUES (?, '2026-01-01', ?, ?, 'шт', 'u1', 0, 'c1', '482', 12.5, ?)";
+  const SqlResult write = store.WriteSync({batch});
+  ASSERT_TRUE(write.ok) << write.error;
+  EXPECT_EQ(Count(&store), 1);
+  store.Close();
+
+  // Повторне відкриття нічого не мігрує і даних не чіпає.
+  Open(&store);
+  EXPECT_EQ(Int(store.ReadSync("PRAGMA user_version", {})), 3);
+  EXPECT_EQ(Count(&store), 1);
+}
+
+// База sqflite версії 1 (без barcodes, price, search_name) доводиться до
+// версії 3: нові колонки, без таблиці barcodes, дані на місці.
+TEST_F(SqliteStoreTest, UpgradesVersionOneDatabase) {
+  sqlite3* db = nullptr;
+  ASSERT_EQ(sqlite3_open(path_.c_str(), &db), SQLITE_OK);
+  ASSERT_EQ(sqlite3_exec(db,
+                         "CREATE TABLE nomenclatura (guid TEXT PRIMARY KEY,"
+                         " created_at TEXT NOT NULL, name TEXT NOT NULL,"
+                         " article TEXT NOT NULL, unit_name TEXT NOT NULL,"
+                         " unit_guid TEXT NOT NULL,"
+                         " is_folder INTEGER NOT NULL, parent_guid TEXT,"
+                         " description TEXT);"
+                         "CREATE TABLE barcodes (guid TEXT, barcode TEXT);"
+                         "INSERT INTO nomenclatura VALUES ('g1', '2026',"
+                         " 'Kefir', 'A1', 'pc', 'u1', 0, NULL, NULL);"
+                         "PRAGMA user_version = 1;",
+                         nullptr, nullptr, nullptr),
+            SQLITE_OK);
+  sqlite3_close(db);
+
+  SqliteStore store;
+  Open(&store);
+  EXPECT_EQ(Int(store.ReadSync("PRAGMA user_version", {})), 3);
+  EXPECT_EQ(Int(store.ReadSync("SELECT COUNT(*) FROM sqlite_master"
+                               " WHERE name = 'barcodes'",
+                               {})),
+            0);
+  const SqlResult row = store.ReadSync(
+      "SELECT name, barcodes, price, search_name FROM nomenclatura", {});
+  ASSERT_TRUE(row.ok) << row.error;
+  ASSERT_EQ(row.rows.size(), 1u);
+  EXPECT_EQ(std::get<std::string>(row.rows[0][0]), "Kefir");
+  // Нові колонки порожні; LOWER(article || barcodes || name) при NULL
+  // barcodes — теж NULL, як і в _onUpgrade.
+  for (size_t i = 1; i < row.rows[0].size(); i++) {
+    EXPECT_TRUE(std::holds_alternative<std::monostate>(row.rows[0][i]))
+        << row.columns[i];
+  }
+  EXPECT_EQ(Count(&store), 1);
+}
+
+// Помилка будь-якого оператора пакета відкочує весь пакет.
+TEST_F(SqliteStoreTest, RollsBackWriteOnError) {
+  SqliteStore store;
+  Open(&store);
+  ASSERT_TRUE(store.WriteSync({Insert({"g1"})}).ok);
+
+  // Другий рядок порушує PRIMARY KEY: перший теж не має лишитися.
+  SqlResult result = store.WriteSync({Insert({"g2", "g1"})});
+  EXPECT_FALSE(result.ok);
+  EXPECT_FALSE(result.error.empty());
+  EXPECT_EQ(Count(&store), 1);
+
+  // Синтаксична помилка в наступному операторі відкочує попередній.
+  result = store.WriteSync(
+      {Insert({"g3", "g4"}), {"UPDATE nomenclatura SET nope = 1", {}}});
+  EXPECT_FALSE(result.ok);
+  EXPECT_EQ(Count(&store), 1);
+
+  // Після відкату писач працює далі.
+  result = store.WriteSync({Insert({"g5"})});
+  ASSERT_TRUE(result.ok) << result.error;
+  EXPECT_EQ(result.changes, 1);
+  EXPECT_EQ(Count(&store), 2);
+}
+
+// Читачі бачать останній зафіксований стан: незафіксований запис іншого
+// процесу не видно, а довгий пакет писача з'являється цілком або ніяк.
+TEST_F(SqliteStoreTest, ReadersSeeCommittedSnapshot) {
+  SqliteStore store;
+  Open(&store);
+  ASSERT_TRUE(store.WriteSync({Insert({"g0"})}).ok);
+
+  sqlite3* other = nullptr;
+  ASSERT_EQ(sqlite3_open(path_.c_str(), &other), SQLITE_OK);
+  ASSERT_EQ(sqlite3_exec(other,
+                         "BEGIN IMMEDIATE;"
+                         "DELETE FROM nomenclatura;",
+                         nullptr, nullptr, nullptr),
+            SQLITE_OK);
+  for (int i = 0; i < 4; i++) EXPECT_EQ(Count(&store), 1);
+  ASSERT_EQ(sqlite3_exec(other, "COMMIT", nullptr, nullptr, nullptr),
+            SQLITE_OK);
+  sqlite3_close(other);
+  EXPECT_EQ(Count(&store), 0);
+
+  constexpr int kRows = 20000;
+  std::atomic<bool> done{false};
+  store.Write({Insert(Guids(kRows))}, [&done](SqlResult result) {
+    EXPECT_TRUE(result.ok) << result.error;
+    done = true;
+  });
+  std::vector<int64_t> seen;
+  while (!done) seen.push_back(Count(&store));
+  for (int64_t count : seen) {
+    EXPECT_TRUE(count == 0 || count == kRows) << count;
+  }
+  EXPECT_EQ(Count(&store), kRows);
+}
+
+}  // namespace
+}  // namespace virok
@@ -0,0 +1,261 @@
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "trace/trace.h"
+#include "watchdog/rotating_file.h"
+#include "watchdog/stall_watchdog.h"
+
+namespace virok {
+namespace {
+
+namespace fs = std::filesystem;
+using std::chrono::milliseconds;
+using Clock = StallWatchdog::Clock;
+
+class StallWatchdogTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir_ = fs::temp_directory_path() /
+           ("virok_watchdog_test_" +
+            std::string(::testing::UnitTest::GetInstance()
+                            ->current_test_info()
+                            ->name()));
+    std::error_code ec;
+    fs::remove_all(dir_, ec);
+    fs::create_directories(dir_);
+  }
+
+  void TearDown() override {
+    std::error_code ec;
+    fs::remove_all(dir_, ec);
+  }
+
+  std::string path(const char* name) const { return (dir_ / name).string(); }
+
+  static std::vector<std::string> Lines(const std::string& path) {
+    std::vector<std::string> lines;
+    std::ifstream in(path);
+    for (std::string line; std::getline(in, line);) lines.push_back(line);
+    return lines;
+  }
+
+ private:
+  fs::path dir_;
+};
+
+// Цикл подій на окремому потоці, як головний цикл GTK: задачі з черги
+// по одній; пульс сторожа — звичайна задача.
+class FakeLoop {
+ public:
+  explicit FakeLoop(StallWatchdog** watchdog) {
+    thread_ = std::thread([this, watchdog] {
+      (*watchdog)->AttachLoopThread();
+      attached_ = true;
+      std::unique_lock<std::mutex> lock(mutex_);
+      while (true) {
+        cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+        if (tasks_.empty()) return;
+        std::function<void()> task = std::move(tasks_.front());
+        tasks_.pop_front();
+        lock.unlock();
+        task();
+        lock.lock();
+      }
+    });
+    while (!attached_) std::this_thread::yield();
+  }
+
+  ~FakeLoop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+  }
+
+  void Post(std::function<void()> task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      tasks_.push_back(std::move(task));
+    }
+    cv_.notify_all();
+  }
+
+  // Чекає, поки виконаються всі задачі, поставлені до виклику.
+  void Drain() {
+    std::atomic<bool> done{false};
+    Post([&done] { done = true; });
+    while (!done) std::this_thread::sleep_for(milliseconds(1));
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> tasks_;
+  bool stop_ = false;
+  std::atomic<bool> attached_{false};
+  std::thread thread_;
+};
+
+TEST_F(StallWatchdogTest, ReportsSpanAndStackOfStalledLoop) {
+  // Цикл — сам тест: пульси лише запам'ятовуються, Beat викликається
+  // вручну в модельному часі.
+  std::vector<uint64_t> posted;
+  StallWatchdogOptions options;
+  options.budget = milliseconds(250);
+  options.interval = milliseconds(100);
+  options.path = path("stalls.log");
+  StallWatchdog watchdog([&](uint64_t seq) { posted.push_back(seq); },
+                         options);
+  watchdog.AttachLoopThread();
+
+  const Clock::time_point t0 = Clock::now();
+  EXPECT_EQ(watchdog.Poll(t0), t0 + milliseconds(100));
+  ASSERT_EQ(posted.size(), 1u);
+  watchdog.Beat(posted.back(), t0 + milliseconds(2));
+  EXPECT_EQ(watchdog.Poll(t0 + milliseconds(5)), t0 + milliseconds(102));
+
+  EXPECT_EQ(watchdog.Poll(t0 + milliseconds(102)), t0 + milliseconds(202));
+  ASSERT_EQ(posted.size(), 2u);
+  {
+    TraceScope channel("com", "fiscalizeCheck");
+    // До бюджету — ще не зависання.
+    watchdog.Poll(t0 + milliseconds(300));
+    EXPECT_FALSE(watchdog.status().stalled);
+    watchdog.Poll(t0 + milliseconds(352));
+    const StallWatchdogStatus status = watchdog.status();
+    ASSERT_TRUE(status.stalled);
+    EXPECT_EQ(status.stalls, 1u);
+    EXPECT_EQ(status.last.duration_ms, 250);
+    ASSERT_EQ(status.last.spans.size(), 1u);
+    EXPECT_EQ(status.last.spans[0].category, "com");
+    EXPECT_EQ(status.last.spans[0].name, "fiscalizeCheck");
+    EXPECT_FALSE(status.last.stack.empty()) << status.last.stack_error;
+  }
+  // Пульс не повторюється, поки попередній без відповіді.
+  watchdog.Poll(t0 + milliseconds(800));
+  EXPECT_EQ(posted.size(), 2u);
+
+  watchdog.Beat(posted.back(), t0 + milliseconds(1302));
+  watchdog.Poll(t0 + milliseconds(1310));
+  StallWatchdogStatus status = watchdog.status();
+  EXPECT_FALSE(status.stalled);
+  EXPECT_TRUE(status.last.recovered);
+  EXPECT_EQ(status.last.duration_ms, 1200);
+  EXPECT_EQ(status.longest_ms, 1200);
+  EXPECT_EQ(status.beats, 2u);
+
+  const std::vector<std::string> lines = Lines(options.path);
+  ASSERT_EQ(lines.size(), 2u);
+  EXPECT_NE(lines[0].find("\"event\":\"stall\",\"id\":1,"), std::string::npos);
+  EXPECT_NE(lines[0].find("\"name\":\"fiscalizeCheck\""), std::string::npos);
+  EXPECT_NE(lines[0].find("\"stack\":[\""), std::string::npos);
+  EXPECT_NE(lines[1].find("\"event\":\"recovered\",\"id\":1,"),
+            std::string::npos);
+  EXPECT_NE(lines[1].find("\"durationMs\":1200"), std::string::npos);
+  EXPECT_EQ(lines[1].find("\"stack\""), std::string::npos);
+}
+
+TEST_F(StallWatchdogTest, DetectsInjectedStallsOnLoopThread) {
+  StallWatchdogOptions options;
+  options.budget = milliseconds(60);
+  options.interval = milliseconds(10);
+  options.path = path("stalls.log");
+  StallWatchdog* watchdog_ptr = nullptr;
+  FakeLoop* loop_ptr = nullptr;
+  StallWatchdog watchdog(
+      [&](uint64_t seq) {
+        loop_ptr->Post([&watchdog_ptr, seq] { watchdog_ptr->Beat(seq); });
+      },
+      options);
+  watchdog_ptr = &watchdog;
+  FakeLoop loop(&watchdog_ptr);
+  loop_ptr = &loop;
+  watchdog.Start();
+
+  // Короткі затримки, як звичайні кадри й виклики каналів, — не
+  // зависання.
+  for (int i = 0; i < 20; i++) {
+    loop.Post([] { std::this_thread::sleep_for(milliseconds(5)); });
+    std::this_thread::sleep_for(milliseconds(7));
+  }
+  loop.Drain();
+  std::this_thread::sleep_for(milliseconds(50));
+  EXPECT_EQ(watchdog.status().stalls, 0u);
+
+  const int injected_ms[] = {200, 450};
+  for (int stall_ms : injected_ms) {
+    loop.Post([stall_ms] {
+      TraceScope channel("scale", "readWeight");
+      VIROK_TRACE_SCOPE("serial", "Read");
+      std::this_thread::sleep_for(milliseconds(stall_ms));
+    });
+    loop.Drain();
+    // Сторож має побачити відповідь.
+    std::this_thread::sleep_for(milliseconds(60));
+
+    const StallWatchdogStatus status = watchdog.status();
+    ASSERT_FALSE(status.stalled);
+    ASSERT_TRUE(status.last.recovered);
+    // Тривалість — від пульсу: занижена не більше ніж на 2×interval
+    // (плюс запас на завантажену машину збірки).
+    EXPECT_LE(status.last.duration_ms, stall_ms + 5);
+    EXPECT_GE(status.last.duration_ms, stall_ms - 2 * 10 - 15);
+    ASSERT_EQ(status.last.spans.size(), 2u);
+    EXPECT_EQ(status.last.spans[0].name, "readWeight");
+    EXPECT_EQ(status.last.spans[1].name, "Read");
+    EXPECT_GE(status.last.spans[0].age_ms, 60 - 5);
+  }
+  watchdog.Stop();
+
+  const StallWatchdogStatus status = watchdog.status();
+  EXPECT_EQ(status.stalls, 2u);
+  EXPECT_GT(status.beats, 20u);
+  EXPECT_TRUE(status.error.empty()) << status.error;
+  const std::vector<std::string> lines = Lines(options.path);
+  ASSERT_EQ(lines.size(), 4u);
+  EXPECT_NE(lines[2].find("\"event\":\"stall\",\"id\":2,"), std::string::npos);
+  EXPECT_NE(lines[2].find("\"name\":\"readWeight\""), std::string::npos);
+}
+
+TEST_F(StallWatchdogTest, RotatingFileKeepsNewestFiles) {
+  const std::string log = path("stalls.log");
+  RotatingFile file(log, 100, 2);
+  const std::string line(39, 'x');  // 40 байтів з перенесенням
+  std::string error;
+  for (int i = 0; i < 7; i++) {
+    ASSERT_TRUE(file.Append(std::to_string(i) + line.substr(1), &error))
+        << error;
+  }
+  // Файли по два рядки: 6 — у stalls.log, 4 і 5 — у .1, 2 і 3 — у .2,
+  // 0 і 1 видалено.
+  ASSERT_EQ(Lines(log).size(), 1u);
+  EXPECT_EQ(Lines(log)[0][0], '6');
+  ASSERT_EQ(Lines(log + ".1").size(), 2u);
+  EXPECT_EQ(Lines(log + ".1")[0][0], '4');
+  ASSERT_EQ(Lines(log + ".2").size(), 2u);
+  EXPECT_EQ(Lines(log + ".2")[0][0], '2');
+  EXPECT_FALSE(fs::exists(log + ".3"));
+
+  // Новий об'єкт дописує існуючий файл і враховує його розмір.
+  RotatingFile reopened(log, 100, 2);
+  ASSERT_TRUE(reopened.Append("7" + line.substr(1), &error));
+  ASSERT_TRUE(reopened.Append("8" + line.substr(1), &error));
+  EXPECT_EQ(Lines(log)[0][0], '8');
+  EXPECT_EQ(Lines(log + ".1")[0][0], '6');
+}
+
+}  // namespace
+}  // namespace virok
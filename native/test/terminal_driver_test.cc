@@ -0,0 +1,528 @@
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "printing/escpos.h"
+#include "terminal/terminal_driver.h"
+#include "terminal/terminal_protocol.h"
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace virok {
+namespace {
+
+using std::chrono::milliseconds;
+using Clock = TerminalDriver::Clock;
+using Type = TerminalEvent::Type;
+
+TerminalMessage Message(int64_t id, std::string method,
+                        TerminalParams params = {}) {
+  TerminalMessage m;
+  m.id = id;
+  m.method = std::move(method);
+  m.params = std::move(params);
+  return m;
+}
+
+TEST(TerminalProtocolTest, RoundTripsThroughSplitFrames) {
+  TerminalMessage reply = Message(
+      42, kTerminalPurchase,
+      {{"responseCode", "0000"},
+       {"receipt", "ПриватБанк\n\"Сума\": 12.50\tгрн"}});
+  reply.error_description = "OK";
+  const std::string stream =
+      EncodeTerminalMessage(Message(7, kTerminalServiceMessage,
+                                    {{"msgType", "cardTapped"}})) +
+      EncodeTerminalMessage(reply);
+
+  // По три байти: кадри ріжуться посеред UTF-8 і escape-послідовностей.
+  TerminalFrameParser parser;
+  std::vector<TerminalMessage> out;
+  for (size_t i = 0; i < stream.size(); i += 3) {
+    parser.Feed(std::string_view(stream).substr(i, 3), &out);
+  }
+  ASSERT_EQ(out.size(), 2u);
+  EXPECT_EQ(out[0].id, 7);
+  EXPECT_EQ(out[0].method, kTerminalServiceMessage);
+  EXPECT_EQ(out[0].params.at("msgType"), "cardTapped");
+  EXPECT_EQ(out[1].id, 42);
+  EXPECT_FALSE(out[1].error);
+  EXPECT_EQ(out[1].error_description, "OK");
+  EXPECT_EQ(out[1].params, reply.params);
+  EXPECT_EQ(parser.dropped(), 0u);
+}
+
+TEST(TerminalProtocolTest, ReadsForeignFieldsAndDropsBrokenFrames) {
+  const std::string frames =
+      std::string("{\"id\":3,\"method\":\"Purchase\",\"error\":true,"
+                  "\"errorDescription\":\"Card declined\",\"params\":"
+                  "{\"amount\":12.5,\"signature\":false,\"emv\":{\"a\":1},"
+                  "\"rrn\":null},\"extra\":[1,2]}") +
+      '\0' + std::string("\0\0", 2) + "{\"id\":4,\"method\":" + '\0' +
+      "{\"id\":5}" + '\0' + std::string(TerminalFrameParser::kMaxFrame + 1,
+                                        'x') +
+      '\0' + "{\"id\":6,\"method\":\"PingDevice\"}" + '\0';
+  TerminalFrameParser parser;
+  std::vector<TerminalMessage> out;
+  parser.Feed(frames, &out);
+  ASSERT_EQ(out.size(), 2u);
+  EXPECT_TRUE(out[0].error);
+  EXPECT_EQ(out[0].error_description, "Card declined");
+  EXPECT_EQ(out[0].params.at("amount"), "12.5");
+  EXPECT_EQ(out[0].params.at("signature"), "false");
+  EXPECT_EQ(out[0].params.count("emv"), 0u);
+  EXPECT_EQ(out[0].params.count("rrn"), 0u);
+  EXPECT_EQ(out[1].id, 6);
+  // Обірваний JSON, кадр без method і задовгий кадр.
+  EXPECT_EQ(parser.dropped(), 3u);
+}
+
+// Події драйвера з його потоків.
+class EventLog {
+ public:
+  TerminalListener listener() {
+    return [this](const TerminalEvent& event) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      events_.push_back(event);
+      cv_.notify_all();
+    };
+  }
+
+  // Перша подія |type| (для |request|, якщо він не 0) після вже
+  // повернутих; false за тайм-аутом.
+  bool Wait(Type type, int64_t request, milliseconds timeout,
+            TerminalEvent* out = nullptr) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    size_t found = 0;
+    const bool ok = cv_.wait_for(lock, timeout, [&] {
+      for (size_t i = 0; i < events_.size(); i++) {
+        if (used_.count(i) || events_[i].type != type) continue;
+        if (request != 0 && events_[i].request != request) continue;
+        found = i;
+        return true;
+      }
+      return false;
+    });
+    if (!ok) return false;
+    used_[found] = true;
+    if (out) *out = events_[found];
+    return true;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<TerminalEvent> events_;
+  std::map<size_t, bool> used_;
+};
+
+TEST(TerminalDriverTest, StartFailsWhenTerminalIsDown) {
+  EventLog log;
+  TerminalDriver driver(log.listener());
+  TerminalOptions options;
+  options.host = "127.0.0.1";
+  options.port = 1;  // нікого немає
+  options.connect_timeout = milliseconds(500);
+  std::string error;
+  EXPECT_FALSE(driver.Start(options, &error));
+  EXPECT_FALSE(error.empty());
+  EXPECT_FALSE(driver.running());
+  EXPECT_EQ(driver.Submit(kTerminalPing, {}, milliseconds(100), &error), 0);
+}
+
+#ifndef _WIN32
+
+int Listen(uint16_t* port) {
+  const int fd = socket(AF_INET, SOCK_STREAM, 0);
+  const int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t len = sizeof(addr);
+  if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+      listen(fd, 4) != 0 ||
+      getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+    close(fd);
+    return -1;
+  }
+  *port = ntohs(addr.sin_port);
+  return fd;
+}
+
+// Симулятор термінала на 127.0.0.1: на кожен запит відтворює сценарій
+// його методу — відповіді з заданими затримками від моменту запиту.
+// Запити різних id обслуговуються вперемішку, як на справжньому
+// терміналі, що відповідає на пінг посеред оплати.
+class TerminalSimulator {
+ public:
+  struct Step {
+    milliseconds delay;
+    TerminalMessage reply;  // id підставляється з запиту
+  };
+
+  TerminalSimulator() { listen_fd_ = Listen(&port_); }
+  ~TerminalSimulator() {
+    stop_ = true;
+    if (thread_.joinable()) thread_.join();
+    if (listen_fd_ >= 0) close(listen_fd_);
+  }
+
+  // До Start().
+  void Script(const std::string& method, std::vector<Step> steps) {
+    scripts_[method] = std::move(steps);
+  }
+
+  bool Start() {
+    if (listen_fd_ < 0) return false;
+    thread_ = std::thread(&TerminalSimulator::Run, this);
+    return true;
+  }
+
+  // Обриває поточне з'єднання (термінал перезавантажився).
+  void Drop() { drop_ = true; }
+
+  uint16_t port() const { return port_; }
+
+  int connections() const { return connections_; }
+
+ private:
+  struct Scheduled {
+    Clock::time_point at;
+    TerminalMessage message;
+  };
+
+  void Run() {
+    while (!stop_) {
+      pollfd pfd = {listen_fd_, POLLIN, 0};
+      if (poll(&pfd, 1, 20) <= 0) continue;
+      const int fd = accept(listen_fd_, nullptr, nullptr);
+      if (fd < 0) continue;
+      connections_++;
+      Serve(fd);
+      close(fd);
+    }
+  }
+
+  void Serve(int fd) {
+    TerminalFrameParser parser;
+    std::vector<TerminalMessage> requests;
+    std::vector<Scheduled> scheduled;
+    std::map<int64_t, std::string> methods;
+    char buf[4096];
+    drop_ = false;
+    while (!stop_ && !drop_) {
+      const Clock::time_point now = Clock::now();
+      for (auto it = scheduled.begin(); it != scheduled.end();) {
+        if (it->at > now) {
+          ++it;
+          continue;
+        }
+        Send(fd, it->message);
+        it = scheduled.erase(it);
+      }
+      pollfd pfd = {fd, POLLIN, 0};
+      if (poll(&pfd, 1, 5) <= 0) continue;
+      const ssize_t n = read(fd, buf, sizeof(buf));
+      if (n <= 0) return;
+      requests.clear();
+      parser.Feed(std::string_view(buf, static_cast<size_t>(n)), &requests);
+      for (const TerminalMessage& request : requests) {
+        const Clock::time_point at = Clock::now();
+        methods[request.id] = request.method;
+        if (request.method == kTerminalInterrupt) {
+          const int64_t target = std::stoll(request.params.at("requestId"));
+          for (auto it = scheduled.begin(); it != scheduled.end();) {
+            it = it->message.id == target ? scheduled.erase(it) : it + 1;
+          }
+          TerminalMessage interrupted = Message(target, methods[target]);
+          interrupted.error = true;
+          interrupted.error_description = "Interrupted";
+          Send(fd, interrupted);
+          Send(fd, Message(request.id, kTerminalInterrupt));
+          continue;
+        }
+        auto script = scripts_.find(request.method);
+        if (script == scripts_.end()) {
+          Send(fd, Message(request.id, request.method));
+          continue;
+        }
+        for (const Step& step : script->second) {
+          Scheduled s{at + step.delay, step.reply};
+          s.message.id = request.id;
+          scheduled.push_back(std::move(s));
+        }
+      }
+    }
+  }
+
+  static void Send(int fd, const TerminalMessage& message) {
+    const std::string frame = EncodeTerminalMessage(message);
+    ASSERT_EQ(send(fd, frame.data(), frame.size(), MSG_NOSIGNAL),
+              static_cast<ssize_t>(frame.size()));
+  }
+
+  int listen_fd_ = -1;
+  uint16_t port_ = 0;
+  std::map<std::string, std::vector<Step>> scripts_;
+  std::thread thread_;
+  std::atomic<bool> stop_{false};
+  std::atomic<bool> drop_{false};
+  std::atomic<int> connections_{0};
+};
+
+// Мережевий принтер сліпів: документ — усе до закриття з'єднання.
+class PrinterSink {
+ public:
+  PrinterSink() {
+    listen_fd_ = Listen(&port_);
+    thread_ = std::thread([this] {
+      while (!stop_) {
+        pollfd pfd = {listen_fd_, POLLIN, 0};
+        if (poll(&pfd, 1, 20) <= 0) continue;
+        const int fd = accept(listen_fd_, nullptr, nullptr);
+        if (fd < 0) continue;
+        std::string document;
+        char buf[4096];
+        ssize_t n;
+        while ((n = read(fd, buf, sizeof(buf))) > 0) document.append(buf, n);
+        close(fd);
+        std::lock_guard<std::mutex> lock(mutex_);
+        documents_.push_back(std::move(document));
+      }
+    });
+  }
+  ~PrinterSink() {
+    stop_ = true;
+    thread_.join();
+    close(listen_fd_);
+  }
+
+  uint16_t port() const { return port_; }
+
+  std::vector<std::string> documents() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return documents_;
+  }
+
+ private:
+  int listen_fd_ = -1;
+  uint16_t port_ = 0;
+  std::thread thread_;
+  std::atomic<bool> stop_{false};
+  std::mutex mutex_;
+  std::vector<std::string> documents_;
+};
+
+TerminalMessage State(const char* msg_type) {
+  return Message(0, kTerminalServiceMessage, {{"msgType", msg_type}});
+}
+
+TerminalMessage Approved(const std::string& receipt) {
+  return Message(0, kTerminalPurchase,
+                 {{"responseCode", "0000"},
+                  {"approvalCode", "654321"},
+                  {"rrn", "000123456789"},
+                  {"pan", "438752******7008"},
+                  {"receipt", receipt}});
+}
+
+TerminalOptions Options(uint16_t port) {
+  TerminalOptions options;
+  options.host = "127.0.0.1";
+  options.port = port;
+  options.reconnect_delay = milliseconds(50);
+  options.slip_copies = 1;
+  return options;
+}
+
+TEST(TerminalDriverTest, PurchaseStreamsStatesAndPrintsSlipOnApproval) {
+  TerminalSimulator terminal;
+  // Картку прикладено через 40 мс, PIN — 80 мс, схвалення — 200 мс.
+  terminal.Script(kTerminalPurchase,
+                  {{milliseconds(10), State("waitingCard")},
+                   {milliseconds(40), State("cardTapped")},
+                   {milliseconds(80), State("pinEntry")},
+                   {milliseconds(120), State("online")},
+                   {milliseconds(200), Approved("ПриватБанк\nСУМА 12.50")}});
+  ASSERT_TRUE(terminal.Start());
+  PrinterSink printer;
+  TerminalOptions options = Options(terminal.port());
+  options.printer_host = "127.0.0.1";
+  options.printer_port = printer.port();
+
+  EventLog log;
+  TerminalDriver driver(log.listener());
+  std::string error;
+  ASSERT_TRUE(driver.Start(options, &error)) << error;
+  ASSERT_TRUE(log.Wait(Type::kConnected, 0, milliseconds(1000)));
+
+  const int64_t id = driver.Submit(kTerminalPurchase, {{"amount", "12.50"}},
+                                   milliseconds(5000), &error);
+  ASSERT_GT(id, 0) << error;
+
+  TerminalEvent event;
+  std::vector<std::string> states;
+  for (int i = 0; i < 4; i++) {
+    ASSERT_TRUE(log.Wait(Type::kState, id, milliseconds(1000), &event));
+    states.push_back(event.state);
+  }
+  EXPECT_EQ(states, (std::vector<std::string>{"waitingCard", "cardTapped",
+                                              "pinEntry", "online"}));
+
+  TerminalEvent result;
+  ASSERT_TRUE(log.Wait(Type::kResult, id, milliseconds(1000), &result));
+  EXPECT_TRUE(result.approved) << result.error;
+  EXPECT_EQ(result.method, kTerminalPurchase);
+  EXPECT_EQ(result.params.at("rrn"), "000123456789");
+  // Від cardTapped (40 мс) до схвалення (200 мс).
+  EXPECT_GE(result.tap_to_approval_us, 150000);
+  EXPECT_LT(result.tap_to_approval_us, 1000000);
+  EXPECT_GE(result.elapsed_us, result.tap_to_approval_us);
+
+  TerminalEvent slip;
+  ASSERT_TRUE(log.Wait(Type::kSlip, id, milliseconds(2000), &slip));
+  EXPECT_TRUE(slip.error.empty()) << slip.error;
+  EXPECT_GE(slip.tap_to_slip_us, result.tap_to_approval_us);
+  std::printf("tap to approval %.1f ms, tap to slip %.1f ms\n",
+              result.tap_to_approval_us / 1000.0,
+              slip.tap_to_slip_us / 1000.0);
+
+  driver.Stop();
+  std::string expected(kEscPosInit);
+  ASSERT_TRUE(Utf8ToCp1251("ПриватБанк\nСУМА 12.50", &expected));
+  expected += kEscPosFeedCut;
+  for (int i = 0; i < 100 && printer.documents().empty(); i++) {
+    std::this_thread::sleep_for(milliseconds(10));
+  }
+  ASSERT_EQ(printer.documents().size(), 1u);
+  EXPECT_EQ(printer.documents()[0], expected);
+}
+
+TEST(TerminalDriverTest, PingAnsweredWhilePurchaseWaitsForCard) {
+  TerminalSimulator terminal;
+  terminal.Script(kTerminalPurchase,
+                  {{milliseconds(300), State("cardInserted")},
+                   {milliseconds(350), Approved("")}});
+  ASSERT_TRUE(terminal.Start());
+  EventLog log;
+  TerminalDriver driver(log.listener());
+  std::string error;
+  ASSERT_TRUE(driver.Start(Options(terminal.port()), &error)) << error;
+
+  const Clock::time_point start = Clock::now();
+  const int64_t purchase = driver.Submit(
+      kTerminalPurchase, {{"amount", "1.00"}}, milliseconds(5000), &error);
+  const int64_t ping =
+      driver.Submit(kTerminalPing, {}, milliseconds(5000), &error);
+  ASSERT_GT(purchase, 0);
+  ASSERT_GT(ping, purchase);
+
+  TerminalEvent event;
+  ASSERT_TRUE(log.Wait(Type::kResult, ping, milliseconds(1000), &event));
+  EXPECT_TRUE(event.approved);
+  // Пінг не чекає, доки покупець прикладе картку.
+  EXPECT_LT(Clock::now() - start, milliseconds(250));
+  ASSERT_TRUE(log.Wait(Type::kResult, purchase, milliseconds(2000), &event));
+  EXPECT_TRUE(event.approved);
+  // Без принтера сліп не друкується.
+  EXPECT_FALSE(log.Wait(Type::kSlip, purchase, milliseconds(100)));
+  EXPECT_EQ(terminal.connections(), 1);
+}
+
+TEST(TerminalDriverTest, CancelAndDeclineEndWithoutSlip) {
+  TerminalSimulator terminal;
+  terminal.Script(kTerminalPurchase, {{milliseconds(10000), Approved("x")}});
+  TerminalMessage declined = Message(0, kTerminalRefund,
+                                     {{"responseCode", "0051"},
+                                      {"receipt", "ВІДМОВА"}});
+  terminal.Script(kTerminalRefund,
+                  {{milliseconds(20), State("cardTapped")},
+                   {milliseconds(50), declined}});
+  ASSERT_TRUE(terminal.Start());
+  PrinterSink printer;
+  TerminalOptions options = Options(terminal.port());
+  options.printer_host = "127.0.0.1";
+  options.printer_port = printer.port();
+  EventLog log;
+  TerminalDriver driver(log.listener());
+  std::string error;
+  ASSERT_TRUE(driver.Start(options, &error)) << error;
+
+  const int64_t purchase = driver.Submit(
+      kTerminalPurchase, {{"amount", "5.00"}}, milliseconds(5000), &error);
+  ASSERT_GT(purchase, 0);
+  EXPECT_TRUE(driver.Cancel(purchase, &error)) << error;
+  TerminalEvent event;
+  ASSERT_TRUE(log.Wait(Type::kResult, purchase, milliseconds(1000), &event));
+  EXPECT_FALSE(event.approved);
+  EXPECT_EQ(event.error, "Interrupted");
+  EXPECT_FALSE(driver.Cancel(purchase, &error));
+
+  const int64_t refund = driver.Submit(kTerminalRefund, {{"amount", "5.00"}},
+                                       milliseconds(5000), &error);
+  ASSERT_TRUE(log.Wait(Type::kResult, refund, milliseconds(1000), &event));
+  EXPECT_FALSE(event.approved);
+  EXPECT_EQ(event.error, "declined: 0051");
+  EXPECT_EQ(event.tap_to_approval_us, 0);
+  EXPECT_FALSE(log.Wait(Type::kSlip, 0, milliseconds(200)));
+  EXPECT_TRUE(printer.documents().empty());
+}
+
+TEST(TerminalDriverTest, LostConnectionFailsPendingAndReconnects) {
+  TerminalSimulator terminal;
+  terminal.Script(kTerminalPurchase, {{milliseconds(10000), Approved("")}});
+  terminal.Script("Timeout", {});
+  ASSERT_TRUE(terminal.Start());
+  EventLog log;
+  TerminalDriver driver(log.listener());
+  std::string error;
+  ASSERT_TRUE(driver.Start(Options(terminal.port()), &error)) << error;
+  ASSERT_TRUE(log.Wait(Type::kConnected, 0, milliseconds(1000)));
+
+  // Запит без відповіді завершується за своїм тайм-аутом.
+  const int64_t silent =
+      driver.Submit("Timeout", {}, milliseconds(150), &error);
+  TerminalEvent event;
+  ASSERT_TRUE(log.Wait(Type::kResult, silent, milliseconds(1000), &event));
+  EXPECT_EQ(event.error, "timeout");
+  EXPECT_GE(event.elapsed_us, 150000);
+
+  const int64_t purchase = driver.Submit(
+      kTerminalPurchase, {{"amount", "9.99"}}, milliseconds(5000), &error);
+  ASSERT_GT(purchase, 0);
+  terminal.Drop();
+  ASSERT_TRUE(log.Wait(Type::kResult, purchase, milliseconds(1000), &event));
+  EXPECT_FALSE(event.approved);
+  EXPECT_EQ(event.error.rfind("connection lost", 0), 0u) << event.error;
+  ASSERT_TRUE(log.Wait(Type::kDisconnected, 0, milliseconds(1000)));
+  EXPECT_FALSE(driver.connected());
+
+  ASSERT_TRUE(log.Wait(Type::kConnected, 0, milliseconds(2000)));
+  EXPECT_TRUE(driver.connected());
+  EXPECT_EQ(terminal.connections(), 2);
+  const int64_t ping =
+      driver.Submit(kTerminalPing, {}, milliseconds(1000), &error);
+  ASSERT_TRUE(log.Wait(Type::kResult, ping, milliseconds(1000), &event));
+  EXPECT_TRUE(event.approved);
+}
+
+#endif  // _WIN32
+
+}  // namespace
+}  // namespace virok
@@ -0,0 +1,322 @@
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "text/utf.h"
+
+namespace virok {
+namespace {
+
+// Еталон, написаний прямо за специфікацією (таблиця 3-7 Unicode і
+// "максимальна некоректна частина" для заміни), без жодних швидких шляхів.
+
+void AppendUtf8(uint32_t cp, std::string* out) {
+  if (cp < 0x80) {
+    out->push_back(static_cast<char>(cp));
+  } else if (cp < 0x800) {
+    out->push_back(static_cast<char>(0xC0 | (cp >> 6)));
+    out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  } else if (cp < 0x10000) {
+    out->push_back(static_cast<char>(0xE0 | (cp >> 12)));
+    out->push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  } else {
+    out->push_back(static_cast<char>(0xF0 | (cp >> 18)));
+    out->push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  }
+}
+
+void AppendUtf16(uint32_t cp, std::u16string* out) {
+  if (cp < 0x10000) {
+    out->push_back(static_cast<char16_t>(cp));
+  } else {
+    out->push_back(static_cast<char16_t>(0xD800 + ((cp - 0x10000) >> 10)));
+    out->push_back(static_cast<char16_t>(0xDC00 + ((cp - 0x10000) & 0x3FF)));
+  }
+}
+
+struct WellFormedRow {
+  uint8_t lead_lo, lead_hi;
+  int length;
+  uint8_t ranges[3][2];  // допустимі значення 2-го..4-го байта
+};
+
+const WellFormedRow kRows[] = {
+    {0x00, 0x7F, 1, {}},
+    {0xC2, 0xDF, 2, {{0x80, 0xBF}}},
+    {0xE0, 0xE0, 3, {{0xA0, 0xBF}, {0x80, 0xBF}}},
+    {0xE1, 0xEC, 3, {{0x80, 0xBF}, {0x80, 0xBF}}},
+    {0xED, 0xED, 3, {{0x80, 0x9F}, {0x80, 0xBF}}},
+    {0xEE, 0xEF, 3, {{0x80, 0xBF}, {0x80, 0xBF}}},
+    {0xF0, 0xF0, 4, {{0x90, 0xBF}, {0x80, 0xBF}, {0x80, 0xBF}}},
+    {0xF1, 0xF3, 4, {{0x80, 0xBF}, {0x80, 0xBF}, {0x80, 0xBF}}},
+    {0xF4, 0xF4, 4, {{0x80, 0x8F}, {0x80, 0xBF}, {0x80, 0xBF}}},
+};
+
+std::u16string ReferenceDecode(const std::string& in, bool* valid) {
+  std::u16string out;
+  *valid = true;
+  size_t i = 0;
+  while (i < in.size()) {
+    const uint8_t lead = static_cast<uint8_t>(in[i]);
+    const WellFormedRow* row = nullptr;
+    for (const auto& r : kRows) {
+      if (lead >= r.lead_lo && lead <= r.lead_hi) row = &r;
+    }
+    if (!row) {
+      out.push_back(0xFFFD);
+      *valid = false;
+      i++;
+      continue;
+    }
+    int matched = 0;
+    while (matched < row->length - 1 && i + 1 + matched < in.size()) {
+      const uint8_t b = static_cast<uint8_t>(in[i + 1 + matched]);
+      if (b < row->ranges[matched][0] || b > row->ranges[matched][1]) break;
+      matched++;
+    }
+    if (matched < row->length - 1) {
+      out.push_back(0xFFFD);
+      *valid = false;
+      i += 1 + matched;
+      continue;
+    }
+    static const uint8_t kLeadMask[] = {0, 0x7F, 0x1F, 0x0F, 0x07};
+    uint32_t cp = lead & kLeadMask[row->length];
+    for (int k = 1; k < row->length; k++) {
+      cp = (cp << 6) | (static_cast<uint8_t>(in[i + k]) & 0x3F);
+    }
+    AppendUtf16(cp, &out);
+    i += row->length;
+  }
+  return out;
+}
+
+std::string ReferenceEncode(const std::u16string& in, bool* valid) {
+  std::string out;
+  *valid = true;
+  for (size_t i = 0; i < in.size(); i++) {
+    uint32_t cp = in[i];
+    const bool high = cp >= 0xD800 && cp <= 0xDBFF;
+    const bool low = cp >= 0xDC00 && cp <= 0xDFFF;
+    if (high && i + 1 < in.size() && in[i + 1] >= 0xDC00 &&
+        in[i + 1] <= 0xDFFF) {
+      cp = 0x10000 + ((cp - 0xD800) << 10) + (in[i + 1] - 0xDC00);
+      i++;
+    } else if (high || low) {
+      cp = 0xFFFD;
+      *valid = false;
+    }
+    AppendUtf8(cp, &out);
+  }
+  return out;
+}
+
+void ExpectDecodesLikeReference(const std::string& in) {
+  bool expected_valid;
+  const std::u16string expected = ReferenceDecode(in, &expected_valid);
+  bool valid;
+  const std::u16string_view actual = Utf8ToUtf16Scratch(in, &valid);
+  ASSERT_EQ(std::u16string(actual), expected);
+  ASSERT_EQ(valid, expected_valid);
+}
+
+void ExpectEncodesLikeReference(const std::u16string& in) {
+  bool expected_valid;
+  const std::string expected = ReferenceEncode(in, &expected_valid);
+  bool valid;
+  const std::string_view actual = Utf16ToUtf8Scratch(in, &valid);
+  ASSERT_EQ(std::string(actual), expected);
+  ASSERT_EQ(valid, expected_valid);
+}
+
+struct TestRandom {
+  uint32_t state = 12345;
+  uint32_t Below(uint32_t n) {
+    state = state * 1103515245 + 12345;
+    return (state >> 16) % n;
+  }
+};
+
+bool IsSurrogate(uint32_t cp) { return cp >= 0xD800 && cp <= 0xDFFF; }
+
+TEST(UtfTest, EveryScalarValueRoundTrips) {
+  for (uint32_t cp = 0; cp <= 0x10FFFF; cp++) {
+    if (IsSurrogate(cp)) continue;
+    std::string utf8;
+    std::u16string utf16;
+    AppendUtf8(cp, &utf8);
+    AppendUtf16(cp, &utf16);
+
+    bool valid = false;
+    ASSERT_EQ(std::u16string(Utf8ToUtf16Scratch(utf8, &valid)), utf16) << cp;
+    ASSERT_TRUE(valid) << cp;
+    ASSERT_EQ(std::string(Utf16ToUtf8Scratch(utf16, &valid)), utf8) << cp;
+    ASSERT_TRUE(valid) << cp;
+  }
+}
+
+TEST(UtfTest, AllScalarValuesInOneBufferRoundTrip) {
+  // Один довгий рядок проходить через блокові (SSE2) шляхи на будь-якому
+  // вирівнюванні межі символу.
+  std::string utf8;
+  std::u16string utf16;
+  for (uint32_t cp = 0; cp <= 0x10FFFF; cp++) {
+    if (IsSurrogate(cp)) continue;
+    AppendUtf8(cp, &utf8);
+    AppendUtf16(cp, &utf16);
+  }
+  std::u16string decoded;
+  std::string encoded;
+  EXPECT_TRUE(Utf8ToUtf16(utf8, &decoded));
+  EXPECT_TRUE(decoded == utf16);
+  EXPECT_TRUE(Utf16ToUtf8(utf16, &encoded));
+  EXPECT_TRUE(encoded == utf8);
+}
+
+TEST(UtfTest, EveryOneTwoAndThreeByteInputMatchesReference) {
+  std::string in;
+  for (uint32_t a = 0; a < 0x100; a++) {
+    in.assign(1, static_cast<char>(a));
+    ExpectDecodesLikeReference(in);
+    for (uint32_t b = 0; b < 0x100; b++) {
+      in.assign({static_cast<char>(a), static_cast<char>(b)});
+      ExpectDecodesLikeReference(in);
+    }
+  }
+  for (uint32_t a = 0xC0; a < 0x100; a++) {
+    for (uint32_t b = 0; b < 0x100; b++) {
+      for (uint32_t c = 0; c < 0x100; c++) {
+        in.assign({static_cast<char>(a), static_cast<char>(b),
+                   static_cast<char>(c)});
+        ExpectDecodesLikeReference(in);
+      }
+    }
+  }
+}
+
+TEST(UtfTest, FourByteInputsMatchReference) {
+  // Другий байт — повний перебір, третій і четвертий — межі діапазонів.
+  const uint8_t kEdges[] = {0x00, 0x41, 0x7F, 0x80, 0x8F, 0x90,
+                            0x9F, 0xA0, 0xBF, 0xC0, 0xD0, 0xFF};
+  std::string in;
+  for (uint32_t a = 0xF0; a < 0x100; a++) {
+    for (uint32_t b = 0; b < 0x100; b++) {
+      for (uint8_t c : kEdges) {
+        for (uint8_t d : kEdges) {
+          in.assign({static_cast<char>(a), static_cast<char>(b),
+                     static_cast<char>(c), static_cast<char>(d)});
+          ExpectDecodesLikeReference(in);
+        }
+      }
+    }
+  }
+}
+
+TEST(UtfTest, EveryUtf16UnitAndSurrogatePairMatchesReference) {
+  std::u16string in;
+  for (uint32_t u = 0; u < 0x10000; u++) {
+    in.assign(1, static_cast<char16_t>(u));
+    ExpectEncodesLikeReference(in);
+    // Непарний сурогат перед/після звичайного символу.
+    in.assign({static_cast<char16_t>(u), u'Ж'});
+    ExpectEncodesLikeReference(in);
+    in.assign({u'Ж', static_cast<char16_t>(u)});
+    ExpectEncodesLikeReference(in);
+  }
+  for (uint32_t hi = 0xD800; hi <= 0xDBFF; hi++) {
+    for (uint32_t lo = 0xDC00; lo <= 0xDFFF; lo++) {
+      in.assign({static_cast<char16_t>(hi), static_cast<char16_t>(lo)});
+      ExpectEncodesLikeReference(in);
+    }
+  }
+}
+
+TEST(UtfTest, SequencesAtEveryBlockOffsetMatchReference) {
+  // Некоректні та багатобайтові послідовності на кожній позиції блоків
+  // ASCII і суцільної кирилиці — межі швидких шляхів.
+  const std::string kFills[] = {"a", "ж", "Ї", "ж ", "1ж", "ab\xC3\xA9"};
+  const std::string kProbes[] = {
+      "\xC3\xA9",         "\xE2\x82\xAC",     "\xF0\x9F\x98\x80",
+      "\x80",             "\xC0\xAF",         "\xE0\x80\xAF",
+      "\xED\xA0\x80",     "\xF4\x90\x80\x80", "\xD0",
+      "\xE2\x82",         "\xFF",             "\xD0\xD0\x96",
+  };
+  for (const auto& fill : kFills) {
+    for (const auto& probe : kProbes) {
+      for (int before = 0; before < 40; before++) {
+        std::string in;
+        for (int i = 0; i < before; i++) in += fill;
+        in += probe;
+        for (int i = 0; i < 40; i++) in += fill;
+        ExpectDecodesLikeReference(in);
+        // Обрізаний кінець: блок не повний.
+        ExpectDecodesLikeReference(in.substr(0, in.size() - 1));
+
+        bool valid;
+        const std::u16string utf16 = ReferenceDecode(in, &valid);
+        for (size_t cut = 0; cut <= utf16.size(); cut += 7) {
+          ExpectEncodesLikeReference(utf16.substr(cut));
+        }
+      }
+    }
+  }
+}
+
+TEST(UtfTest, RawConversionStaysWithinBound) {
+  // Буфер рівно за межею: блокові шляхи пишуть наперед, але не за неї
+  // (під AddressSanitizer вихід за межу — помилка).
+  const std::string kPieces[] = {"a", "ж", " ", "€", "😀", "\xFF", "1,50"};
+  TestRandom rnd;
+  for (int round = 0; round < 2000; round++) {
+    std::string in;
+    const int pieces = rnd.Below(40);
+    for (int i = 0; i < pieces; i++) in += kPieces[rnd.Below(7)];
+
+    std::unique_ptr<char16_t[]> utf16(new char16_t[Utf16Bound(in.size())]);
+    const size_t units =
+        Utf8ToUtf16(in.data(), in.size(), utf16.get(), nullptr);
+    ASSERT_LE(units, Utf16Bound(in.size()));
+
+    std::unique_ptr<char[]> utf8(new char[Utf8Bound(units)]);
+    ASSERT_LE(Utf16ToUtf8(utf16.get(), units, utf8.get(), nullptr),
+              Utf8Bound(units));
+  }
+}
+
+TEST(UtfTest, ReceiptTextRoundTrips) {
+  const std::string receipt =
+      "{\"ReceiptLst\":[{\"VendorCode\":\"4820001234567\",\"Name\":"
+      "\"Молоко Галичина 2.5% 900г\",\"Quantity\":\"1,000\",\"Price\":"
+      "\"42,90\",\"UnitType\":\"шт\"}],\"Comment\":\"Чек з Flutter App — "
+      "дякуємо за покупку! Ґанок, Їжак, Єнот, ІІІ\"}";
+  std::u16string utf16;
+  std::string utf8;
+  ASSERT_TRUE(Utf8ToUtf16(receipt, &utf16));
+  ASSERT_TRUE(Utf16ToUtf8(utf16, &utf8));
+  EXPECT_EQ(utf8, receipt);
+  EXPECT_NE(utf16.find(u"Молоко Галичина 2.5% 900г"), std::u16string::npos);
+}
+
+TEST(UtfTest, ScratchIsNullTerminatedAndReused) {
+  const std::u16string_view first = Utf8ToUtf16Scratch(std::string(100, 'x'));
+  const char16_t* data = first.data();
+  EXPECT_EQ(first.data()[first.size()], 0);
+
+  const std::u16string_view second = Utf8ToUtf16Scratch("Каса");
+  EXPECT_EQ(second.data(), data);  // той самий буфер, без алокації
+  EXPECT_EQ(std::u16string(second), u"Каса");
+  EXPECT_EQ(second.data()[second.size()], 0);
+
+  const std::string_view back = Utf16ToUtf8Scratch(u"");
+  EXPECT_TRUE(back.empty());
+  EXPECT_EQ(back.data()[0], 0);
+}
+
+}  // namespace
+}  // namespace virok
@@ -0,0 +1,102 @@
+#include "text/lower_case.h"
+
+#include <cstdint>
+
+namespace virok {
+
+namespace {
+
+// Мала літера для |c| або сам |c|. Таблиця простих відображень Unicode
+// для блоків 0000-052F; 0130 (İ) обробляється окремо.
+char32_t LowerCodePoint(char32_t c) {
+  if (c < 0x80) return c >= 'A' && c <= 'Z' ? c + 32 : c;
+  if (c < 0x100) {
+    return c >= 0xC0 && c <= 0xDE && c != 0xD7 ? c + 32 : c;
+  }
+  if (c < 0x180) {
+    // Latin Extended-A: пари (велика, мала), зсув парності у 0139-0148
+    // і 0179-017E.
+    if (c == 0x178) return 0xFF;
+    if ((c >= 0x139 && c <= 0x148) || (c >= 0x179 && c <= 0x17E)) {
+      return c & 1 ? c + 1 : c;
+    }
+    if (c == 0x131 || c == 0x138 || c == 0x149 || c == 0x17F) return c;
+    return c & 1 ? c : c + 1;
+  }
+  if (c >= 0x370 && c < 0x400) {
+    if (c == 0x386) return 0x3AC;
+    if (c >= 0x388 && c <= 0x38A) return c + 37;
+    if (c == 0x38C) return 0x3CC;
+    if (c == 0x38E || c == 0x38F) return c + 63;
+    if (c >= 0x391 && c <= 0x3AB && c != 0x3A2) return c + 32;
+    return c;
+  }
+  if (c >= 0x400 && c < 0x530) {
+    if (c < 0x410) return c + 80;   // Ѐ..Џ (Є, І, Ї, Ў)
+    if (c < 0x430) return c + 32;   // А..Я
+    if (c < 0x460) return c;        // а..я, ѐ..џ
+    if (c == 0x4C0) return 0x4CF;
+    if (c >= 0x4C1 && c <= 0x4CE) return c & 1 ? c + 1 : c;
+    if ((c >= 0x460 && c <= 0x481) || (c >= 0x48A && c <= 0x4BF) ||
+        c >= 0x4D0) {
+      return c & 1 ? c : c + 1;     // Ѡ..ԯ парами (Ґ/ґ = 0490/0491)
+    }
+    return c;
+  }
+  return c;
+}
+
+void AppendCodePoint(char32_t c, std::string* out) {
+  if (c < 0x80) {
+    out->push_back(static_cast<char>(c));
+  } else if (c < 0x800) {
+    out->push_back(static_cast<char>(0xC0 | (c >> 6)));
+    out->push_back(static_cast<char>(0x80 | (c & 0x3F)));
+  } else {
+    // Відображення не виходять за межі BMP.
+    out->push_back(static_cast<char>(0xE0 | (c >> 12)));
+    out->push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | (c & 0x3F)));
+  }
+}
+
+}  // namespace
+
+void AppendUtf8Lower(std::string_view in, std::string* out) {
+  out->reserve(out->size() + in.size() + 1);
+  size_t i = 0;
+  while (i < in.size()) {
+    const uint8_t b = static_cast<uint8_t>(in[i]);
+    if (b < 0x80) {
+      out->push_back(b >= 'A' && b <= 'Z' ? static_cast<char>(b + 32)
+                                          : static_cast<char>(b));
+      i++;
+      continue;
+    }
+    // Таблиця покриває лише двобайтові послідовності (U+0080-U+07FF);
+    // довші й некоректні копіюються як є.
+    if ((b & 0xE0) != 0xC0 || i + 1 >= in.size() ||
+        (static_cast<uint8_t>(in[i + 1]) & 0xC0) != 0x80) {
+      out->push_back(in[i]);
+      i++;
+      continue;
+    }
+    const char32_t c = static_cast<char32_t>(
+        ((b & 0x1F) << 6) | (static_cast<uint8_t>(in[i + 1]) & 0x3F));
+    i += 2;
+    if (c == 0x130) {
+      // İ -> i + U+0307, як у повному відображенні Unicode.
+      out->append("i\xCC\x87");
+      continue;
+    }
+    AppendCodePoint(LowerCodePoint(c), out);
+  }
+}
+
+std::string Utf8ToLower(std::string_view in) {
+  std::string out;
+  AppendUtf8Lower(in, &out);
+  return out;
+}
+
+}  // namespace virok
@@ -0,0 +1,21 @@
+#ifndef NATIVE_TEXT_LOWER_CASE_H_
+#define NATIVE_TEXT_LOWER_CASE_H_
+
+#include <string>
+#include <string_view>
+
+namespace virok {
+
+// Нижній регістр UTF-8 так само, як String.toLowerCase у Dart, для
+// символів, що трапляються в номенклатурі: ASCII, Latin-1, Latin
+// Extended-A, грецька і кирилиця (з розширеною). Решта символів і
+// некоректні байти копіюються без змін.
+//
+// Потрібен там, де search_name рахується на нативному боці: він має
+// збігатися з тим, що пише NomenclaturaModel.fromSupabaseJson.
+std::string Utf8ToLower(std::string_view in);
+void AppendUtf8Lower(std::string_view in, std::string* out);
+
+}  // namespace virok
+
+#endif  // NATIVE_TEXT_LOWER_CASE_H_
@@ -0,0 +1,386 @@
+#include "text/utf.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VIROK_UTF_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace virok {
+
+namespace {
+
+constexpr char16_t kReplacement = 0xFFFD;
+
+#if VIROK_UTF_SSE2
+int CountTrailingZeros(uint32_t mask) {
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return static_cast<int>(index);
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+
+// 16 байтів = 8 двобайтових послідовностей (кирилиця, латиниця з
+// діакритикою): ведучі на парних позиціях у [C2, DF], продовження на
+// непарних у [80, BF]. Інакше false і нічого не пише.
+bool DecodeTwoByteBlock(__m128i block, char16_t* out) {
+  const __m128i lead = _mm_and_si128(block, _mm_set1_epi16(0x00FF));
+  const __m128i cont = _mm_srli_epi16(block, 8);
+  const __m128i ok = _mm_and_si128(
+      _mm_and_si128(_mm_cmpgt_epi16(lead, _mm_set1_epi16(0xC1)),
+                    _mm_cmplt_epi16(lead, _mm_set1_epi16(0xE0))),
+      _mm_cmplt_epi16(cont, _mm_set1_epi16(0xC0)));
+  if (_mm_movemask_epi8(ok) != 0xFFFF) return false;
+  // Продовження >= 0x80 уже гарантовано: увесь блок не-ASCII.
+  const __m128i chars = _mm_or_si128(
+      _mm_slli_epi16(_mm_and_si128(lead, _mm_set1_epi16(0x1F)), 6),
+      _mm_and_si128(cont, _mm_set1_epi16(0x3F)));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(out), chars);
+  return true;
+}
+
+// Блок з ASCII і двобайтових послідовностей упереміш (слова через пробіли,
+// ціни, артикули). Символи рахуються в 16-бітних лініях для кожної
+// позиції, а байти продовження потім викидаються без розгалужень.
+// Повертає кількість спожитих байтів (15, якщо блок закінчується ведучим
+// байтом) або 0, якщо в блоці є три-/чотирибайтові чи некоректні
+// послідовності.
+int DecodeMixedBlock(__m128i block, uint32_t high, char16_t** out) {
+  const __m128i top2 = _mm_and_si128(block, _mm_set1_epi8(-64));  // 0xC0
+  const __m128i top3 = _mm_and_si128(block, _mm_set1_epi8(-32));  // 0xE0
+  const __m128i lead_bytes = _mm_cmpeq_epi8(top2, _mm_set1_epi8(-64));
+  if (_mm_movemask_epi8(_mm_cmpeq_epi8(top3, _mm_set1_epi8(-32))) != 0) {
+    return 0;
+  }
+  // C0/C1 — надлишкове кодування ASCII.
+  if (_mm_movemask_epi8(
+          _mm_cmpeq_epi8(_mm_and_si128(block, _mm_set1_epi8(-2)),
+                         _mm_set1_epi8(-64))) != 0) {
+    return 0;
+  }
+  const uint32_t cont = static_cast<uint32_t>(
+      _mm_movemask_epi8(_mm_cmpeq_epi8(top2, _mm_set1_epi8(-128))));
+  uint32_t lead = high & ~cont;
+  int consumed = 16;
+  if (lead & 0x8000) {
+    lead &= 0x7FFF;
+    consumed = 15;
+  }
+  if (cont != ((lead << 1) & 0xFFFF)) return 0;
+
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i next = _mm_srli_si128(block, 1);
+  alignas(16) char16_t chars[16];
+  for (int half = 0; half < 2; half++) {
+    const __m128i b = half ? _mm_unpackhi_epi8(block, zero)
+                           : _mm_unpacklo_epi8(block, zero);
+    const __m128i n = half ? _mm_unpackhi_epi8(next, zero)
+                           : _mm_unpacklo_epi8(next, zero);
+    const __m128i m = half ? _mm_unpackhi_epi8(lead_bytes, lead_bytes)
+                           : _mm_unpacklo_epi8(lead_bytes, lead_bytes);
+    const __m128i two = _mm_or_si128(
+        _mm_slli_epi16(_mm_and_si128(b, _mm_set1_epi16(0x1F)), 6),
+        _mm_and_si128(n, _mm_set1_epi16(0x3F)));
+    _mm_store_si128(reinterpret_cast<__m128i*>(chars + half * 8),
+                    _mm_or_si128(_mm_and_si128(m, two),
+                                 _mm_andnot_si128(m, b)));
+  }
+
+  // Запис на місце викинутого байта перезаписується наступним символом і
+  // не виходить за межу: символів у блоці менше, ніж байтів.
+  char16_t* o = *out;
+  for (int i = 0; i < consumed; i++) {
+    *o = chars[i];
+    o += ((cont >> i) & 1) ^ 1;
+  }
+  *out = o;
+  return consumed;
+}
+
+// Вісім одиниць UTF-16 < 0x800 (ASCII і кирилиця впереміш) -> 8..16 байтів.
+// False, якщо є одиниці >= 0x800.
+bool EncodeMixedBlock(__m128i units, uint8_t** out) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i above_two =
+      _mm_and_si128(units, _mm_set1_epi16(static_cast<short>(0xF800)));
+  if (_mm_movemask_epi8(_mm_cmpeq_epi16(above_two, zero)) != 0xFFFF) {
+    return false;
+  }
+  const __m128i ascii = _mm_cmpeq_epi16(
+      _mm_and_si128(units, _mm_set1_epi16(static_cast<short>(0xFF80))), zero);
+  const __m128i lead =
+      _mm_or_si128(_mm_srli_epi16(units, 6), _mm_set1_epi16(0xC0));
+  const __m128i cont = _mm_or_si128(
+      _mm_and_si128(units, _mm_set1_epi16(0x3F)), _mm_set1_epi16(0x80));
+  const __m128i two = _mm_or_si128(lead, _mm_slli_epi16(cont, 8));
+  alignas(16) uint16_t pairs[8];
+  _mm_store_si128(reinterpret_cast<__m128i*>(pairs),
+                  _mm_or_si128(_mm_and_si128(ascii, units),
+                               _mm_andnot_si128(ascii, two)));
+
+  // Завжди пишемо два байти (little-endian), просуваємось на 1 або 2.
+  const uint32_t ascii_mask =
+      static_cast<uint32_t>(_mm_movemask_epi8(ascii));
+  uint8_t* o = *out;
+  for (int i = 0; i < 8; i++) {
+    std::memcpy(o, &pairs[i], 2);
+    o += 2 - ((ascii_mask >> (2 * i)) & 1);
+  }
+  *out = o;
+  return true;
+}
+#endif
+
+// Декодує послідовність з не-ASCII байтом |p[0]| (таблиця 3-7 Unicode).
+// Повертає кількість спожитих байтів; некоректна частина дає один U+FFFD.
+size_t DecodeSequence(const uint8_t* p, const uint8_t* end, char16_t** out,
+                      bool* ok) {
+  const uint8_t lead = p[0];
+  size_t need;
+  uint32_t cp;
+  uint8_t lo = 0x80;
+  uint8_t hi = 0xBF;
+  if (lead >= 0xC2 && lead <= 0xDF) {
+    need = 1;
+    cp = lead & 0x1F;
+  } else if (lead >= 0xE0 && lead <= 0xEF) {
+    need = 2;
+    cp = lead & 0x0F;
+    if (lead == 0xE0) lo = 0xA0;  // надлишкове кодування
+    if (lead == 0xED) hi = 0x9F;  // сурогати
+  } else if (lead >= 0xF0 && lead <= 0xF4) {
+    need = 3;
+    cp = lead & 0x07;
+    if (lead == 0xF0) lo = 0x90;
+    if (lead == 0xF4) hi = 0x8F;  // > U+10FFFF
+  } else {
+    *(*out)++ = kReplacement;
+    *ok = false;
+    return 1;
+  }
+
+  size_t i = 1;
+  for (; i <= need && p + i < end; i++) {
+    const uint8_t b = p[i];
+    if (b < lo || b > hi) break;
+    lo = 0x80;
+    hi = 0xBF;
+    cp = (cp << 6) | (b & 0x3F);
+  }
+  if (i <= need) {
+    *(*out)++ = kReplacement;
+    *ok = false;
+    return i;
+  }
+
+  if (cp >= 0x10000) {
+    cp -= 0x10000;
+    *(*out)++ = static_cast<char16_t>(0xD800 | (cp >> 10));
+    *(*out)++ = static_cast<char16_t>(0xDC00 | (cp & 0x3FF));
+  } else {
+    *(*out)++ = static_cast<char16_t>(cp);
+  }
+  return need + 1;
+}
+
+// Один символ з |p|: ASCII і коректні двобайтові послідовності без виклику
+// повного декодера. Повертає наступну позицію.
+inline const uint8_t* DecodeUnit(const uint8_t* p, const uint8_t* end,
+                                 char16_t** out, bool* ok) {
+  const uint8_t c = p[0];
+  if (c < 0x80) {
+    *(*out)++ = c;
+    return p + 1;
+  }
+  if (c >= 0xC2 && c <= 0xDF && p + 1 < end && (p[1] & 0xC0) == 0x80) {
+    *(*out)++ = static_cast<char16_t>(((c & 0x1F) << 6) | (p[1] & 0x3F));
+    return p + 2;
+  }
+  return p + DecodeSequence(p, end, out, ok);
+}
+
+// Кодує одну одиницю (або сурогатну пару) з |p|; повертає наступну позицію.
+const char16_t* EncodeUnit(const char16_t* p, const char16_t* end,
+                           uint8_t** out, bool* ok) {
+  uint8_t* o = *out;
+  const uint32_t u = *p++;
+  if (u < 0x80) {
+    *o++ = static_cast<uint8_t>(u);
+  } else if (u < 0x800) {
+    *o++ = static_cast<uint8_t>(0xC0 | (u >> 6));
+    *o++ = static_cast<uint8_t>(0x80 | (u & 0x3F));
+  } else if (u >= 0xD800 && u <= 0xDBFF && p < end && *p >= 0xDC00 &&
+             *p <= 0xDFFF) {
+    const uint32_t cp = 0x10000 + ((u - 0xD800) << 10) + (*p++ - 0xDC00);
+    *o++ = static_cast<uint8_t>(0xF0 | (cp >> 18));
+    *o++ = static_cast<uint8_t>(0x80 | ((cp >> 12) & 0x3F));
+    *o++ = static_cast<uint8_t>(0x80 | ((cp >> 6) & 0x3F));
+    *o++ = static_cast<uint8_t>(0x80 | (cp & 0x3F));
+  } else {
+    uint32_t cp = u;
+    if (u >= 0xD800 && u <= 0xDFFF) {  // непарний сурогат
+      cp = kReplacement;
+      *ok = false;
+    }
+    *o++ = static_cast<uint8_t>(0xE0 | (cp >> 12));
+    *o++ = static_cast<uint8_t>(0x80 | ((cp >> 6) & 0x3F));
+    *o++ = static_cast<uint8_t>(0x80 | (cp & 0x3F));
+  }
+  *out = o;
+  return p;
+}
+
+template <typename T>
+T* ScratchBuffer(std::vector<T>* buffer, size_t size) {
+  if (buffer->size() < size) buffer->resize(size);
+  return buffer->data();
+}
+
+}  // namespace
+
+size_t Utf8ToUtf16(const char* in, size_t size, char16_t* out, bool* valid) {
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(in);
+  const uint8_t* const end = p + size;
+  char16_t* o = out;
+  bool ok = true;
+
+  while (p < end) {
+#if VIROK_UTF_SSE2
+    if (end - p >= 16) {
+      const __m128i block =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+      const uint32_t high = static_cast<uint32_t>(_mm_movemask_epi8(block));
+      if (high == 0) {
+        const __m128i zero = _mm_setzero_si128();
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(o),
+                         _mm_unpacklo_epi8(block, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(o + 8),
+                         _mm_unpackhi_epi8(block, zero));
+        p += 16;
+        o += 16;
+        continue;
+      }
+      if (high == 0xFFFF && DecodeTwoByteBlock(block, o)) {
+        p += 16;
+        o += 8;
+        continue;
+      }
+      if (const int consumed = DecodeMixedBlock(block, high, &o)) {
+        p += consumed;
+        continue;
+      }
+      // Три-/чотирибайтові або некоректні: ASCII до першого не-ASCII байта
+      // блоку, далі решта блоку скалярно, потім знову блоки.
+      const uint8_t* const stop = p + 16;
+      for (int n = CountTrailingZeros(high); n > 0; n--) *o++ = *p++;
+      while (p < stop) p = DecodeUnit(p, end, &o, &ok);
+      continue;
+    }
+#endif
+    p = DecodeUnit(p, end, &o, &ok);
+  }
+
+  if (valid) *valid = ok;
+  return static_cast<size_t>(o - out);
+}
+
+size_t Utf16ToUtf8(const char16_t* in, size_t size, char* out, bool* valid) {
+  const char16_t* p = in;
+  const char16_t* const end = in + size;
+  uint8_t* o = reinterpret_cast<uint8_t*>(out);
+  bool ok = true;
+
+  while (p < end) {
+#if VIROK_UTF_SSE2
+    if (end - p >= 8) {
+      const __m128i units =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+      const __m128i zero = _mm_setzero_si128();
+      const __m128i above_ascii =
+          _mm_and_si128(units, _mm_set1_epi16(static_cast<short>(0xFF80)));
+      if (_mm_movemask_epi8(_mm_cmpeq_epi16(above_ascii, zero)) == 0xFFFF) {
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(o),
+                         _mm_packus_epi16(units, units));
+        p += 8;
+        o += 8;
+        continue;
+      }
+      // Усі вісім у [0x80, 0x7FF]: кожна одиниця — рівно два байти, тож
+      // 16-бітна лінія (little-endian) = ведучий | продовження << 8.
+      const __m128i above_two =
+          _mm_and_si128(units, _mm_set1_epi16(static_cast<short>(0xF800)));
+      const __m128i two_byte = _mm_andnot_si128(
+          _mm_cmpeq_epi16(above_ascii, zero), _mm_cmpeq_epi16(above_two, zero));
+      if (_mm_movemask_epi8(two_byte) == 0xFFFF) {
+        const __m128i lead = _mm_or_si128(_mm_srli_epi16(units, 6),
+                                          _mm_set1_epi16(0xC0));
+        const __m128i cont =
+            _mm_or_si128(_mm_and_si128(units, _mm_set1_epi16(0x3F)),
+                         _mm_set1_epi16(0x80));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(o),
+                         _mm_or_si128(lead, _mm_slli_epi16(cont, 8)));
+        p += 8;
+        o += 16;
+        continue;
+      }
+      if (EncodeMixedBlock(units, &o)) {
+        p += 8;
+        continue;
+      }
+      // Є одиниці >= 0x800 (символи, сурогати): вісім одиниць скалярно,
+      // щоб не перевіряти той самий блок знову на кожній одиниці.
+      for (const char16_t* stop = p + 8; p < stop;) {
+        p = EncodeUnit(p, end, &o, &ok);
+      }
+      continue;
+    }
+#endif
+    p = EncodeUnit(p, end, &o, &ok);
+  }
+
+  if (valid) *valid = ok;
+  return static_cast<size_t>(reinterpret_cast<char*>(o) - out);
+}
+
+std::u16string_view Utf8ToUtf16Scratch(std::string_view in, bool* valid) {
+  thread_local std::vector<char16_t> buffer;
+  char16_t* out = ScratchBuffer(&buffer, Utf16Bound(in.size()) + 1);
+  const size_t n = Utf8ToUtf16(in.data(), in.size(), out, valid);
+  out[n] = 0;
+  return std::u16string_view(out, n);
+}
+
+std::string_view Utf16ToUtf8Scratch(std::u16string_view in, bool* valid) {
+  thread_local std::vector<char> buffer;
+  char* out = ScratchBuffer(&buffer, Utf8Bound(in.size()) + 1);
+  const size_t n = Utf16ToUtf8(in.data(), in.size(), out, valid);
+  out[n] = 0;
+  return std::string_view(out, n);
+}
+
+bool Utf8ToUtf16(std::string_view in, std::u16string* out) {
+  bool valid = true;
+  const std::u16string_view s = Utf8ToUtf16Scratch(in, &valid);
+  out->assign(s.data(), s.size());
+  return valid;
+}
+
+bool Utf16ToUtf8(std::u16string_view in, std::string* out) {
+  bool valid = true;
+  const std::string_view s = Utf16ToUtf8Scratch(in, &valid);
+  out->assign(s.data(), s.size());
+  return valid;
+}
+
+}  // namespace virok
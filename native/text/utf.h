@@ -0,0 +1,43 @@
+#ifndef NATIVE_TEXT_UTF_H_
+#define NATIVE_TEXT_UTF_H_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace virok {
+
+// Перекодування UTF-8 <-> UTF-16 для мосту з COM (BSTR) і Flutter (UTF-8).
+//
+// Один прохід замість двох (розмір + перетворення у Win32 API): результат
+// пишеться в буфер за верхньою межею розміру. Блоки з ASCII і з суцільної
+// кирилиці (двобайтові послідовності) обробляються по 16 байтів через SSE2,
+// решта — скалярно. Некоректні послідовності замінюються на U+FFFD так
+// само, як MultiByteToWideChar/WideCharToMultiByte без прапорців (одна
+// заміна на максимальну некоректну частину), а |valid| стає false.
+
+// Верхні межі розміру результату (без завершального нуля).
+constexpr size_t Utf16Bound(size_t utf8_bytes) { return utf8_bytes; }
+constexpr size_t Utf8Bound(size_t utf16_units) { return utf16_units * 3; }
+
+// Пишуть у |out| місткістю не менше за межу; повертають кількість
+// записаних одиниць. |valid| може бути nullptr.
+size_t Utf8ToUtf16(const char* in, size_t size, char16_t* out, bool* valid);
+size_t Utf16ToUtf8(const char16_t* in, size_t size, char* out, bool* valid);
+
+// Перетворення в потоколокальний буфер без алокацій (після прогріву).
+// Результат завершується нулем і дійсний до наступного виклику *Scratch
+// того ж напрямку в цьому потоці.
+std::u16string_view Utf8ToUtf16Scratch(std::string_view in,
+                                       bool* valid = nullptr);
+std::string_view Utf16ToUtf8Scratch(std::u16string_view in,
+                                    bool* valid = nullptr);
+
+// Власний рядок з однією алокацією точного розміру. False, якщо вхід
+// містив некоректні послідовності (результат усе одно заповнено).
+bool Utf8ToUtf16(std::string_view in, std::u16string* out);
+bool Utf16ToUtf8(std::u16string_view in, std::string* out);
+
+}  // namespace virok
+
+#endif  // NATIVE_TEXT_UTF_H_
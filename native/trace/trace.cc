@@ -0,0 +1,104 @@
+#include "trace/trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace virok {
+
+namespace {
+
+const std::chrono::steady_clock::time_point kProcessStart =
+    std::chrono::steady_clock::now();
+
+}  // namespace
+
+Tracer& Tracer::Get() {
+  // Навмисно не руйнується: спани можуть писатися з потоків, що
+  // завершуються після main().
+  static Tracer* tracer = new Tracer();
+  return *tracer;
+}
+
+int64_t Tracer::NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - kProcessStart)
+      .count();
+}
+
+const char* Tracer::Intern(std::string_view name) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return names_.emplace(name).first->c_str();
+}
+
+void Tracer::SetThreadName(std::string name) {
+  TraceBuffer* buffer = ThreadBuffer();
+  std::lock_guard<std::mutex> lock(mutex_);
+  buffer->name_ = std::move(name);
+}
+
+std::vector<Tracer::Track> Tracer::Tracks() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<Track> tracks;
+  tracks.reserve(buffers_.size());
+  for (const auto& buffer : buffers_) {
+    tracks.push_back({buffer.get(), buffer->name_});
+  }
+  return tracks;
+}
+
+TraceBuffer* Tracer::CreateTrack(std::string name) {
+  return Register(std::move(name));
+}
+
+TraceBuffer* Tracer::Register(std::string name) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const uint32_t tid = next_tid_++;
+  if (name.empty()) name = "thread-" + std::to_string(tid);
+  buffers_.push_back(std::make_unique<TraceBuffer>(tid, std::move(name)));
+  return buffers_.back().get();
+}
+
+thread_local ActiveSpans* ActiveSpans::current_ = nullptr;
+
+ActiveSpans* ActiveSpans::AttachCurrentThread() {
+  // Навмисно не руйнується, як і буфери Tracer.
+  if (current_ == nullptr) current_ = new ActiveSpans();
+  return current_;
+}
+
+void ActiveSpans::Push(const char* category, std::string_view name) {
+  const int64_t now = Tracer::NowNs();
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (depth_ < kMaxDepth) {
+    Slot& slot = slots_[depth_];
+    size_t size = std::min(name.size(), kMaxName - 1);
+    // Не розрізати символ UTF-8 (назви бувають кирилицею).
+    while (size < name.size() && size > 0 &&
+           (static_cast<unsigned char>(name[size]) & 0xC0) == 0x80) {
+      size--;
+    }
+    std::memcpy(slot.name, name.data(), size);
+    slot.name[size] = '\0';
+    slot.category = category;
+    slot.start_ns = now;
+  }
+  depth_++;
+}
+
+void ActiveSpans::Pop() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (depth_ > 0) depth_--;
+}
+
+std::vector<ActiveSpans::Span> ActiveSpans::Snapshot() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<Span> spans;
+  spans.reserve(std::min(depth_, kMaxDepth));
+  for (size_t i = 0; i < depth_ && i < kMaxDepth; i++) {
+    spans.push_back({slots_[i].category, slots_[i].name, slots_[i].start_ns});
+  }
+  return spans;
+}
+
+}  // namespace virok
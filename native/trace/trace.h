@@ -0,0 +1,244 @@
+#ifndef NATIVE_TRACE_TRACE_H_
+#define NATIVE_TRACE_TRACE_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace virok {
+
+// Один завершений спан. Імена — стабільні вказівники: рядкові літерали
+// або результат Tracer::Intern.
+struct TraceEvent {
+  static constexpr int64_t kNoArg = std::numeric_limits<int64_t>::min();
+
+  const char* category;
+  const char* name;
+  int64_t start_ns;
+  int64_t duration_ns;
+  int64_t arg;  // довільне число (розмір, код помилки) або kNoArg
+};
+
+// Кільцевий буфер спанів одного потоку (одна доріжка в Chrome trace).
+// Пише лише потік-власник, читає лише писач — тому без м'ютексів:
+// дві атомарні позиції з acquire/release. Якщо писач не встигає, нові
+// спани відкидаються й рахуються в dropped().
+class TraceBuffer {
+ public:
+  static constexpr size_t kCapacity = 4096;
+
+  TraceBuffer(uint32_t tid, std::string name)
+      : tid_(tid), name_(std::move(name)) {}
+
+  TraceBuffer(const TraceBuffer&) = delete;
+  TraceBuffer& operator=(const TraceBuffer&) = delete;
+
+  bool Push(const TraceEvent& event) {
+    const uint64_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) >= kCapacity) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    events_[head & (kCapacity - 1)] = event;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Викликає |fn| для кожного накопиченого спану і звільняє місце.
+  template <typename Fn>
+  size_t Drain(Fn fn) {
+    const uint64_t tail = tail_.load(std::memory_order_relaxed);
+    const uint64_t head = head_.load(std::memory_order_acquire);
+    for (uint64_t i = tail; i != head; i++) fn(events_[i & (kCapacity - 1)]);
+    tail_.store(head, std::memory_order_release);
+    return static_cast<size_t>(head - tail);
+  }
+
+  uint32_t tid() const { return tid_; }
+  uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  friend class Tracer;
+
+  const uint32_t tid_;
+  std::string name_;  // змінюється лише під м'ютексом Tracer
+
+  std::array<TraceEvent, kCapacity> events_;
+  // Позиції на різних кеш-лініях, щоб писач і потік не заважали один одному.
+  alignas(64) std::atomic<uint64_t> head_{0};
+  alignas(64) std::atomic<uint64_t> tail_{0};
+  std::atomic<uint64_t> dropped_{0};
+};
+
+// Глобальний трасувальник. Поки вимкнений, TraceScope коштує одне
+// relaxed-читання атомарного прапорця.
+class Tracer {
+ public:
+  static Tracer& Get();
+
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+  void SetEnabled(bool enabled) {
+    enabled_.store(enabled, std::memory_order_relaxed);
+  }
+
+  // Монотонний час у наносекундах від старту процесу.
+  static int64_t NowNs();
+
+  // Записує спан у буфер поточного потоку.
+  void Record(const char* category, const char* name, int64_t start_ns,
+              int64_t end_ns, int64_t arg = TraceEvent::kNoArg) {
+    ThreadBuffer()->Push({category, name, start_ns, end_ns - start_ns, arg});
+  }
+
+  // Стабільна копія динамічного імені (назва методу каналу, спан з Dart).
+  // Бере м'ютекс — для гарячих місць краще рядкові літерали.
+  const char* Intern(std::string_view name);
+
+  // Назва доріжки поточного потоку в Chrome trace ("platform", "com", ...).
+  void SetThreadName(std::string name);
+
+  // Окрема доріжка, яку наповнює один потік від імені іншого джерела
+  // (спани Dart, що приходять через канал). Живе до кінця процесу.
+  TraceBuffer* CreateTrack(std::string name);
+
+  struct Track {
+    TraceBuffer* buffer;
+    std::string name;
+  };
+
+  // Знімок усіх доріжок для писача; самі буфери він читає вже без м'ютекса.
+  std::vector<Track> Tracks();
+
+ private:
+  Tracer() = default;
+
+  TraceBuffer* ThreadBuffer() {
+    thread_local TraceBuffer* buffer = nullptr;
+    if (!buffer) buffer = Register(std::string());
+    return buffer;
+  }
+
+  TraceBuffer* Register(std::string name);
+
+  std::atomic<bool> enabled_{false};
+
+  std::mutex mutex_;
+  // Буфери живуть до кінця процесу: потік може завершитися раніше, ніж
+  // писач забере його спани.
+  std::vector<std::unique_ptr<TraceBuffer>> buffers_;
+  std::unordered_set<std::string> names_;
+  uint32_t next_tid_ = 1;
+};
+
+// Незавершені спани одного потоку, видимі з інших потоків: що саме
+// виконується в потоці платформи, поки він не відповідає (див.
+// watchdog/stall_watchdog.h).
+//
+// TraceScope приєднаного потоку записує сюди свій спан незалежно від
+// того, чи ввімкнене трасування: це м'ютекс без конкуренції і копія
+// імені, тож приєднувати варто лише потоки циклів подій. У неприєднаних
+// потоках TraceScope коштує, як і раніше, одне читання thread_local.
+class ActiveSpans {
+ public:
+  // Глибші спани лише рахуються; імена обрізаються.
+  static constexpr size_t kMaxDepth = 16;
+  static constexpr size_t kMaxName = 64;
+
+  struct Span {
+    const char* category;
+    std::string name;
+    int64_t start_ns;  // Tracer::NowNs()
+  };
+
+  // Реєстр поточного потоку; створюється при першому виклику і живе до
+  // кінця процесу (його читає інший потік).
+  static ActiveSpans* AttachCurrentThread();
+  // nullptr — потік не приєднаний.
+  static ActiveSpans* Current() { return current_; }
+
+  ActiveSpans() = default;
+  ActiveSpans(const ActiveSpans&) = delete;
+  ActiveSpans& operator=(const ActiveSpans&) = delete;
+
+  void Push(const char* category, std::string_view name);
+  void Pop();
+
+  // Від зовнішнього спану до найглибшого.
+  std::vector<Span> Snapshot() const;
+
+ private:
+  struct Slot {
+    const char* category;
+    char name[kMaxName];
+    int64_t start_ns;
+  };
+
+  static thread_local ActiveSpans* current_;
+
+  mutable std::mutex mutex_;
+  std::array<Slot, kMaxDepth> slots_;
+  size_t depth_ = 0;
+};
+
+// RAII-спан: міряє час від конструктора до деструктора.
+class TraceScope {
+ public:
+  TraceScope(const char* category, const char* name)
+      : category_(category), name_(name) {
+    if ((active_ = ActiveSpans::Current()) != nullptr) {
+      active_->Push(category, name);
+    }
+    if (Tracer::Get().enabled()) start_ns_ = Tracer::NowNs();
+  }
+
+  // Динамічне ім'я інтернується лише коли трасування увімкнене.
+  TraceScope(const char* category, std::string_view name)
+      : category_(category) {
+    if ((active_ = ActiveSpans::Current()) != nullptr) {
+      active_->Push(category, name);
+    }
+    Tracer& tracer = Tracer::Get();
+    if (tracer.enabled()) {
+      name_ = tracer.Intern(name);
+      start_ns_ = Tracer::NowNs();
+    }
+  }
+
+  ~TraceScope() {
+    if (start_ns_ >= 0) {
+      Tracer::Get().Record(category_, name_, start_ns_, Tracer::NowNs(), arg_);
+    }
+    if (active_ != nullptr) active_->Pop();
+  }
+
+  TraceScope(const TraceScope&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+
+  void set_arg(int64_t arg) { arg_ = arg; }
+
+ private:
+  const char* category_;
+  const char* name_ = "";
+  int64_t start_ns_ = -1;
+  int64_t arg_ = TraceEvent::kNoArg;
+  ActiveSpans* active_ = nullptr;
+};
+
+}  // namespace virok
+
+#define VIROK_TRACE_CONCAT_INNER(a, b) a##b
+#define VIROK_TRACE_CONCAT(a, b) VIROK_TRACE_CONCAT_INNER(a, b)
+
+// VIROK_TRACE_SCOPE("com", "FiscalizeCheck"); — спан до кінця блоку.
+#define VIROK_TRACE_SCOPE(category, name) \
+  ::virok::TraceScope VIROK_TRACE_CONCAT(virok_trace_scope_, __LINE__)( \
+      category, name)
+
+#endif  // NATIVE_TRACE_TRACE_H_
@@ -0,0 +1,149 @@
+#include "trace/trace_writer.h"
+
+#include <cinttypes>
+#include <vector>
+
+namespace virok {
+
+namespace {
+
+void AppendEscaped(std::string* out, const char* text) {
+  for (const char* p = text; *p; p++) {
+    const char c = *p;
+    if (c == '"' || c == '\\') {
+      out->push_back('\\');
+      out->push_back(c);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char buf[8];
+      std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+      out->append(buf);
+    } else {
+      out->push_back(c);
+    }
+  }
+}
+
+// Chrome trace рахує час у мікросекундах; дробова частина зберігає нс.
+void AppendMicros(std::string* out, int64_t ns) {
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), "%" PRId64 ".%03" PRId64, ns / 1000,
+                ns % 1000);
+  out->append(buf);
+}
+
+}  // namespace
+
+ChromeTraceWriter::~ChromeTraceWriter() { Stop(); }
+
+bool ChromeTraceWriter::Start(const std::string& path,
+                              std::chrono::milliseconds interval) {
+  Stop();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) return false;
+    std::fputs("[\n", file_);
+    named_tids_.clear();
+    written_ = 0;
+    stop_ = false;
+  }
+  // Спани, що накопичилися до старту, належать попередній трасі.
+  for (const auto& track : Tracer::Get().Tracks()) {
+    track.buffer->Drain([](const TraceEvent&) {});
+  }
+  Tracer::Get().SetEnabled(true);
+  thread_ = std::thread([this, interval] { Loop(interval); });
+  return true;
+}
+
+void ChromeTraceWriter::Stop() {
+  if (!thread_.joinable()) return;
+  Tracer::Get().SetEnabled(false);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  thread_.join();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  DrainLocked();
+  // Остання подія без коми і ']' — акуратно зупинена траса є валідним JSON.
+  std::fputs(
+      "{\"ph\":\"M\",\"pid\":1,\"name\":\"process_name\","
+      "\"args\":{\"name\":\"virok_cashier\"}}\n]\n",
+      file_);
+  std::fclose(file_);
+  file_ = nullptr;
+}
+
+void ChromeTraceWriter::Flush() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  DrainLocked();
+}
+
+void ChromeTraceWriter::Loop(std::chrono::milliseconds interval) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stop_) {
+    wake_.wait_for(lock, interval, [this] { return stop_; });
+    DrainLocked();
+  }
+}
+
+void ChromeTraceWriter::DrainLocked() {
+  if (!file_) return;
+
+  uint64_t dropped = 0;
+  for (const auto& track : Tracer::Get().Tracks()) {
+    TraceBuffer* buffer = track.buffer;
+    dropped += buffer->dropped();
+
+    line_.clear();
+    const uint32_t tid = buffer->tid();
+    const size_t count = buffer->Drain([this, tid](const TraceEvent& e) {
+      line_.append("{\"ph\":\"X\",\"pid\":1,\"tid\":");
+      line_.append(std::to_string(tid));
+      line_.append(",\"cat\":\"");
+      AppendEscaped(&line_, e.category);
+      line_.append("\",\"name\":\"");
+      AppendEscaped(&line_, e.name);
+      line_.append("\",\"ts\":");
+      AppendMicros(&line_, e.start_ns);
+      line_.append(",\"dur\":");
+      AppendMicros(&line_, e.duration_ns);
+      if (e.arg != TraceEvent::kNoArg) {
+        line_.append(",\"args\":{\"value\":");
+        line_.append(std::to_string(e.arg));
+        line_.push_back('}');
+      }
+      line_.append("},\n");
+    });
+    if (count == 0) continue;
+
+    if (named_tids_.insert(tid).second) {
+      std::string meta =
+          "{\"ph\":\"M\",\"pid\":1,\"tid\":" + std::to_string(tid) +
+          ",\"name\":\"thread_name\",\"args\":{\"name\":\"";
+      AppendEscaped(&meta, track.name.c_str());
+      meta.append("\"}},\n");
+      std::fwrite(meta.data(), 1, meta.size(), file_);
+    }
+    std::fwrite(line_.data(), 1, line_.size(), file_);
+    written_ += count;
+  }
+
+  // Втрати видно прямо на трасі як миттєву подію.
+  if (dropped > reported_dropped_) {
+    line_.assign("{\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,");
+    line_.append("\"name\":\"trace buffer overflow\",\"ts\":");
+    AppendMicros(&line_, Tracer::NowNs());
+    line_.append(",\"args\":{\"dropped\":");
+    line_.append(std::to_string(dropped - reported_dropped_));
+    line_.append("}},\n");
+    std::fwrite(line_.data(), 1, line_.size(), file_);
+    reported_dropped_ = dropped;
+  }
+  std::fflush(file_);
+}
+
+}  // namespace virok
@@ -0,0 +1,63 @@
+#ifndef NATIVE_TRACE_TRACE_WRITER_H_
+#define NATIVE_TRACE_TRACE_WRITER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+#include "trace/trace.h"
+
+namespace virok {
+
+// Фоновий писач спанів у форматі Chrome trace (JSON Array Format):
+// файл відкривається в chrome://tracing або ui.perfetto.dev.
+//
+// Файл починається з '[' і закривається лише в Stop(): формат дозволяє
+// відсутню ']' в кінці, тож трасу можна відкрити й після аварійного
+// завершення.
+class ChromeTraceWriter {
+ public:
+  ChromeTraceWriter() = default;
+  ~ChromeTraceWriter();
+
+  ChromeTraceWriter(const ChromeTraceWriter&) = delete;
+  ChromeTraceWriter& operator=(const ChromeTraceWriter&) = delete;
+
+  // Відкриває |path| (перезаписує), вмикає Tracer і запускає фоновий потік,
+  // що скидає буфери кожні |interval|. False, якщо файл не відкрився.
+  bool Start(const std::string& path,
+             std::chrono::milliseconds interval = std::chrono::seconds(1));
+
+  // Вимикає Tracer, дописує залишок і закриває файл.
+  void Stop();
+
+  // Синхронно скидає всі буфери у файл (тести, завершення зміни).
+  void Flush();
+
+  bool running() const { return file_ != nullptr; }
+  uint64_t written() const { return written_; }
+
+ private:
+  void Loop(std::chrono::milliseconds interval);
+  void DrainLocked();
+
+  // Захищає file_ і стан писача; потоки, що пишуть спани, його не беруть.
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::thread thread_;
+  bool stop_ = false;
+
+  std::FILE* file_ = nullptr;
+  std::string line_;
+  std::set<uint32_t> named_tids_;
+  uint64_t written_ = 0;
+  uint64_t reported_dropped_ = 0;
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_TRACE_TRACE_WRITER_H_
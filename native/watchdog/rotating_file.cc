@@ -0,0 +1,91 @@
+#include "watchdog/rotating_file.h"
+
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+#include <utility>
+
+#ifdef _WIN32
+#include <share.h>
+#endif
+
+namespace virok {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+std::FILE* OpenForAppend(const std::string& path) {
+#ifdef _WIN32
+  // Без блокування: звіт можна читати, поки каса працює.
+  return _wfsopen(fs::u8path(path).c_str(), L"ab", _SH_DENYNO);
+#else
+  return std::fopen(path.c_str(), "ab");
+#endif
+}
+
+std::string Numbered(const std::string& path, int n) {
+  return path + "." + std::to_string(n);
+}
+
+}  // namespace
+
+RotatingFile::RotatingFile(std::string path, uint64_t max_bytes, int keep)
+    : path_(std::move(path)), max_bytes_(max_bytes), keep_(keep) {}
+
+RotatingFile::~RotatingFile() {
+  if (file_ != nullptr) std::fclose(file_);
+}
+
+bool RotatingFile::Append(std::string_view line, std::string* error) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (file_ == nullptr && !OpenLocked(error)) return false;
+  // Порожній файл не ротується, навіть якщо рядок довший за ліміт.
+  if (size_ > 0 && size_ + line.size() + 1 > max_bytes_) {
+    RotateLocked();
+    if (!OpenLocked(error)) return false;
+  }
+  if (std::fwrite(line.data(), 1, line.size(), file_) != line.size() ||
+      std::fputc('\n', file_) == EOF || std::fflush(file_) != 0) {
+    if (error) *error = "write " + path_ + ": " + std::strerror(errno);
+    // Наступний запис відкриє файл заново.
+    std::fclose(file_);
+    file_ = nullptr;
+    return false;
+  }
+  size_ += line.size() + 1;
+  return true;
+}
+
+bool RotatingFile::OpenLocked(std::string* error) {
+  file_ = OpenForAppend(path_);
+  if (file_ == nullptr) {
+    if (error) *error = "open " + path_ + ": " + std::strerror(errno);
+    return false;
+  }
+  std::error_code ec;
+  const uintmax_t size = fs::file_size(fs::u8path(path_), ec);
+  size_ = ec ? 0 : static_cast<uint64_t>(size);
+  return true;
+}
+
+void RotatingFile::RotateLocked() {
+  std::fclose(file_);
+  file_ = nullptr;
+  // Помилки ігноруються: у гіршому разі файл дописується далі або
+  // перезаписується старий номер.
+  std::error_code ec;
+  if (keep_ <= 0) {
+    fs::remove(fs::u8path(path_), ec);
+    return;
+  }
+  fs::remove(fs::u8path(Numbered(path_, keep_)), ec);
+  for (int n = keep_ - 1; n >= 1; n--) {
+    fs::rename(fs::u8path(Numbered(path_, n)),
+               fs::u8path(Numbered(path_, n + 1)), ec);
+  }
+  fs::rename(fs::u8path(path_), fs::u8path(Numbered(path_, 1)), ec);
+}
+
+}  // namespace virok
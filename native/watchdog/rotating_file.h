@@ -0,0 +1,45 @@
+#ifndef NATIVE_WATCHDOG_ROTATING_FILE_H_
+#define NATIVE_WATCHDOG_ROTATING_FILE_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace virok {
+
+// Журнал рядків з обмеженим розміром: коли |path| переросте max_bytes,
+// він стає path.1, попередній path.1 — path.2 і так до path.<keep>;
+// найстаріший видаляється. Кожен рядок одразу скидається на диск, тож
+// запис переживає аварійне завершення процесу. Потокобезпечний.
+class RotatingFile {
+ public:
+  RotatingFile(std::string path, uint64_t max_bytes, int keep);
+  ~RotatingFile();
+
+  RotatingFile(const RotatingFile&) = delete;
+  RotatingFile& operator=(const RotatingFile&) = delete;
+
+  // Дописує |line| і перенесення рядка. False і текст помилки в |error|,
+  // якщо файл не відкрився або запис не вдався.
+  bool Append(std::string_view line, std::string* error);
+
+  const std::string& path() const { return path_; }
+
+ private:
+  bool OpenLocked(std::string* error);
+  void RotateLocked();
+
+  const std::string path_;
+  const uint64_t max_bytes_;
+  const int keep_;
+
+  std::mutex mutex_;
+  FILE* file_ = nullptr;
+  uint64_t size_ = 0;
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_WATCHDOG_ROTATING_FILE_H_
@@ -0,0 +1,305 @@
+#include "watchdog/stack_sampler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <signal.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <thread>
+#endif
+
+namespace virok {
+
+namespace {
+
+std::string Hex(uintptr_t value) {
+  char buf[24];
+  std::snprintf(buf, sizeof(buf), "0x%llx",
+                static_cast<unsigned long long>(value));
+  return buf;
+}
+
+#if defined(__linux__) || defined(_WIN32)
+
+// Один знімок за раз: буфер обробника сигналу і копія стеку спільні.
+std::mutex& SampleMutex() {
+  static std::mutex* mutex = new std::mutex();
+  return *mutex;
+}
+
+std::string BaseName(const char* path) {
+  const char* name = path;
+  for (const char* p = path; *p; p++) {
+    if (*p == '/' || *p == '\\') name = p + 1;
+  }
+  return name;
+}
+
+#endif
+
+#if defined(__linux__)
+
+// Обробник (OnSampleSignal) і сигнальний трамплін ядра.
+constexpr int kHandlerFrames = 2;
+constexpr int kBufferFrames = StackSampler::kMaxFrames + kHandlerFrames;
+constexpr auto kSignalTimeout = std::chrono::milliseconds(200);
+
+void* sample_frames[kBufferFrames];
+std::atomic<int> sample_depth{-1};
+
+int SampleSignal() { return SIGRTMIN + 4; }
+
+void OnSampleSignal(int) {
+  const int saved_errno = errno;
+  sample_depth.store(backtrace(sample_frames, kBufferFrames),
+                     std::memory_order_release);
+  errno = saved_errno;
+}
+
+bool InstallSignalHandler() {
+  static const bool installed = [] {
+    // Перший backtrace() завантажує libgcc_s (dlopen, malloc) — це має
+    // статися тут, а не в обробнику сигналу.
+    void* warm_up[4];
+    backtrace(warm_up, 4);
+    struct sigaction action {};
+    action.sa_handler = OnSampleSignal;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    return sigaction(SampleSignal(), &action, nullptr) == 0;
+  }();
+  return installed;
+}
+
+#elif defined(_WIN32) && defined(_M_X64)
+
+// Копіюється не більше стільки стеку від вершини; запас після копії
+// дозволяє розкрутці останнього кадру прочитати збережені регістри, не
+// виходячи за буфер.
+constexpr size_t kMaxStackCopy = 512 << 10;
+constexpr size_t kStackCopySlack = 64 << 10;
+
+#endif
+
+}  // namespace
+
+#if defined(__linux__)
+
+StackSampler::~StackSampler() = default;
+
+bool StackSampler::AttachCurrentThread(std::string* error) {
+  if (!InstallSignalHandler()) {
+    if (error) *error = std::string("sigaction: ") + std::strerror(errno);
+    return false;
+  }
+  thread_ = pthread_self();
+  attached_ = true;
+  return true;
+}
+
+bool StackSampler::Sample(std::vector<std::string>* frames,
+                          std::string* error) {
+  if (!attached_) {
+    if (error) *error = "no thread attached";
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(SampleMutex());
+  sample_depth.store(-1, std::memory_order_relaxed);
+  const int rc = pthread_kill(thread_, SampleSignal());
+  if (rc != 0) {
+    if (error) *error = std::string("pthread_kill: ") + std::strerror(rc);
+    return false;
+  }
+  const auto deadline = std::chrono::steady_clock::now() + kSignalTimeout;
+  int depth;
+  while ((depth = sample_depth.load(std::memory_order_acquire)) < 0) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      // Сигнал заблокований або потік у незупинному стані ядра.
+      if (error) *error = "thread did not handle the sample signal";
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+  }
+  frames->clear();
+  for (int i = kHandlerFrames; i < depth; i++) {
+    frames->push_back(
+        DescribeCodeAddress(reinterpret_cast<uintptr_t>(sample_frames[i])));
+  }
+  return true;
+}
+
+std::string DescribeCodeAddress(uintptr_t pc) {
+  Dl_info info;
+  if (dladdr(reinterpret_cast<void*>(pc), &info) == 0 ||
+      info.dli_fname == nullptr) {
+    return Hex(pc);
+  }
+  std::string out = BaseName(info.dli_fname) + "+" +
+                    Hex(pc - reinterpret_cast<uintptr_t>(info.dli_fbase));
+  if (info.dli_sname != nullptr) {
+    int status = 0;
+    char* demangled =
+        abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+    out += " (";
+    out += status == 0 && demangled ? demangled : info.dli_sname;
+    out += "+" + Hex(pc - reinterpret_cast<uintptr_t>(info.dli_saddr)) + ")";
+    std::free(demangled);
+  }
+  return out;
+}
+
+#elif defined(_WIN32)
+
+StackSampler::~StackSampler() {
+  if (thread_ != nullptr) ::CloseHandle(thread_);
+}
+
+bool StackSampler::AttachCurrentThread(std::string* error) {
+  HANDLE thread = nullptr;
+  if (!::DuplicateHandle(::GetCurrentProcess(), ::GetCurrentThread(),
+                         ::GetCurrentProcess(), &thread,
+                         THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT |
+                             THREAD_QUERY_INFORMATION,
+                         FALSE, 0)) {
+    if (error) {
+      *error = "DuplicateHandle: " + std::to_string(::GetLastError());
+    }
+    return false;
+  }
+  ULONG_PTR low = 0;
+  ULONG_PTR high = 0;
+  ::GetCurrentThreadStackLimits(&low, &high);
+  if (thread_ != nullptr) ::CloseHandle(thread_);
+  thread_ = thread;
+  stack_high_ = high;
+#ifdef _M_X64
+  stack_copy_.resize(kMaxStackCopy + kStackCopySlack);
+#endif
+  attached_ = true;
+  return true;
+}
+
+bool StackSampler::Sample(std::vector<std::string>* frames,
+                          std::string* error) {
+#ifdef _M_X64
+  if (!attached_) {
+    if (error) *error = "no thread attached";
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(SampleMutex());
+  HANDLE thread = static_cast<HANDLE>(thread_);
+  CONTEXT context{};
+  context.ContextFlags = CONTEXT_FULL;
+  uintptr_t rsp = 0;
+  size_t copied = 0;
+
+  // Поки потік стоїть — лише memcpy: ні купи, ні завантажувача.
+  if (::SuspendThread(thread) == static_cast<DWORD>(-1)) {
+    if (error) *error = "SuspendThread: " + std::to_string(::GetLastError());
+    return false;
+  }
+  const bool got_context = ::GetThreadContext(thread, &context) != 0;
+  if (got_context) {
+    rsp = static_cast<uintptr_t>(context.Rsp);
+    if (rsp < stack_high_) {
+      copied = std::min<size_t>(stack_high_ - rsp, kMaxStackCopy);
+      std::memcpy(stack_copy_.data(), reinterpret_cast<const void*>(rsp),
+                  copied);
+    }
+  }
+  ::ResumeThread(thread);
+  if (!got_context) {
+    if (error) {
+      *error = "GetThreadContext: " + std::to_string(::GetLastError());
+    }
+    return false;
+  }
+
+  // Вказівники всередину скопійованого стеку (збережені rbp, вершина
+  // стеку в регістрах) переносяться в копію. Адреси повернення вказують
+  // на код і не змінюються.
+  const uintptr_t copy = reinterpret_cast<uintptr_t>(stack_copy_.data());
+  auto relocate = [&](DWORD64* value) {
+    if (*value >= rsp && *value < rsp + copied) *value = *value - rsp + copy;
+  };
+  for (size_t offset = 0; offset + 8 <= copied; offset += 8) {
+    relocate(reinterpret_cast<DWORD64*>(stack_copy_.data() + offset));
+  }
+  for (DWORD64* reg : {&context.Rsp, &context.Rbp, &context.Rbx,
+                       &context.Rsi, &context.Rdi, &context.R12,
+                       &context.R13, &context.R14, &context.R15}) {
+    relocate(reg);
+  }
+
+  frames->clear();
+  for (int i = 0; i < kMaxFrames && context.Rip != 0; i++) {
+    frames->push_back(DescribeCodeAddress(context.Rip));
+    if (context.Rsp < copy || context.Rsp + 8 > copy + copied) break;
+    DWORD64 image_base = 0;
+    PRUNTIME_FUNCTION function =
+        ::RtlLookupFunctionEntry(context.Rip, &image_base, nullptr);
+    if (function == nullptr) {
+      // Листова функція: адреса повернення на вершині стеку.
+      context.Rip = *reinterpret_cast<const DWORD64*>(context.Rsp);
+      context.Rsp += 8;
+    } else {
+      void* handler_data = nullptr;
+      DWORD64 establisher_frame = 0;
+      ::RtlVirtualUnwind(UNW_FLAG_NHANDLER, image_base, context.Rip, function,
+                         &context, &handler_data, &establisher_frame,
+                         nullptr);
+    }
+  }
+  return true;
+#else
+  if (error) *error = "stack sampling needs x64";
+  return false;
+#endif
+}
+
+std::string DescribeCodeAddress(uintptr_t pc) {
+  HMODULE module = nullptr;
+  if (!::GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS |
+                                GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                            reinterpret_cast<LPCWSTR>(pc), &module)) {
+    return Hex(pc);
+  }
+  char path[MAX_PATH];
+  const DWORD size = ::GetModuleFileNameA(module, path, MAX_PATH);
+  if (size == 0 || size >= MAX_PATH) return Hex(pc);
+  return BaseName(path) + "+" + Hex(pc - reinterpret_cast<uintptr_t>(module));
+}
+
+#else
+
+StackSampler::~StackSampler() = default;
+
+bool StackSampler::AttachCurrentThread(std::string* error) {
+  thread_ = pthread_self();
+  attached_ = true;
+  return true;
+}
+
+bool StackSampler::Sample(std::vector<std::string>* frames,
+                          std::string* error) {
+  if (error) *error = "stack sampling is not supported on this platform";
+  return false;
+}
+
+std::string DescribeCodeAddress(uintptr_t pc) { return Hex(pc); }
+
+#endif
+
+}  // namespace virok
@@ -0,0 +1,60 @@
+#ifndef NATIVE_WATCHDOG_STACK_SAMPLER_H_
+#define NATIVE_WATCHDOG_STACK_SAMPLER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+namespace virok {
+
+// Знімок стеку іншого потоку, поки той працює (або висить).
+//
+// Linux: потоку надсилається сигнал реального часу, обробник пише
+// backtrace() у статичний буфер. Windows x64: потік призупиняється лише
+// на копіювання контексту і стеку, а розкрутка (RtlVirtualUnwind) йде по
+// копії вже після ResumeThread — щоб не взяти блокування завантажувача
+// чи купи, яке міг тримати призупинений потік. На інших платформах
+// Sample повертає false.
+class StackSampler {
+ public:
+  static constexpr int kMaxFrames = 48;
+
+  StackSampler() = default;
+  ~StackSampler();
+
+  StackSampler(const StackSampler&) = delete;
+  StackSampler& operator=(const StackSampler&) = delete;
+
+  // Запам'ятовує потік, що викликає, як ціль знімків.
+  bool AttachCurrentThread(std::string* error);
+  bool attached() const { return attached_; }
+
+  // Кадри від найглибшого, див. DescribeCodeAddress. Викликати з іншого
+  // потоку; одночасно в процесі знімається лише один стек.
+  bool Sample(std::vector<std::string>* frames, std::string* error);
+
+ private:
+  bool attached_ = false;
+#ifdef _WIN32
+  void* thread_ = nullptr;
+  uintptr_t stack_high_ = 0;
+  // Копія стеку: виділена заздалегідь, бо призупинений потік міг
+  // тримати блокування купи.
+  std::vector<char> stack_copy_;
+#else
+  pthread_t thread_{};
+#endif
+};
+
+// "модуль+0xзсув" для адреси коду, плюс " (символ+0xзсув)", коли ім'я
+// відоме (Linux, експортовані символи). Зсув у модулі придатний для
+// addr2line чи символів PDB і без імен.
+std::string DescribeCodeAddress(uintptr_t pc);
+
+}  // namespace virok
+
+#endif  // NATIVE_WATCHDOG_STACK_SAMPLER_H_
@@ -0,0 +1,281 @@
+#include "watchdog/stall_watchdog.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <utility>
+
+#include "metrics/metrics.h"
+
+namespace virok {
+
+namespace {
+
+int64_t ToMs(StallWatchdog::Clock::duration d) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(d).count();
+}
+
+int64_t UnixNowMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+void AppendEscaped(std::string* out, const std::string& text) {
+  for (const char c : text) {
+    if (c == '"' || c == '\\') {
+      out->push_back('\\');
+      out->push_back(c);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char buf[8];
+      std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+      out->append(buf);
+    } else {
+      out->push_back(c);
+    }
+  }
+}
+
+void AppendString(std::string* out, const std::string& text) {
+  out->push_back('"');
+  AppendEscaped(out, text);
+  out->push_back('"');
+}
+
+void AppendInt(std::string* out, int64_t value) {
+  char buf[24];
+  std::snprintf(buf, sizeof(buf), "%" PRId64, value);
+  out->append(buf);
+}
+
+// {"event":"stall","id":3,"startedMs":...,"durationMs":250,
+//  "spans":[{"cat":"com","name":"fiscalize","ageMs":240}],
+//  "stack":["libflutter_linux_gtk.so+0x1c2a0", ...]}
+std::string ReportJson(const StallReport& report, const char* event,
+                       bool with_stack) {
+  std::string out = "{\"event\":\"";
+  out += event;
+  out += "\",\"id\":";
+  AppendInt(&out, static_cast<int64_t>(report.id));
+  out += ",\"startedMs\":";
+  AppendInt(&out, report.started_unix_ms);
+  out += ",\"durationMs\":";
+  AppendInt(&out, report.duration_ms);
+  out += ",\"spans\":[";
+  for (size_t i = 0; i < report.spans.size(); i++) {
+    if (i > 0) out += ',';
+    out += "{\"cat\":";
+    AppendString(&out, report.spans[i].category);
+    out += ",\"name\":";
+    AppendString(&out, report.spans[i].name);
+    out += ",\"ageMs\":";
+    AppendInt(&out, report.spans[i].age_ms);
+    out += '}';
+  }
+  out += ']';
+  if (with_stack) {
+    out += ",\"stack\":[";
+    for (size_t i = 0; i < report.stack.size(); i++) {
+      if (i > 0) out += ',';
+      AppendString(&out, report.stack[i]);
+    }
+    out += ']';
+    if (!report.stack_error.empty()) {
+      out += ",\"stackError\":";
+      AppendString(&out, report.stack_error);
+    }
+  }
+  out += '}';
+  return out;
+}
+
+}  // namespace
+
+StallWatchdog::StallWatchdog(PostHeartbeat post_heartbeat,
+                             StallWatchdogOptions options)
+    : post_heartbeat_(std::move(post_heartbeat)) {
+  set_options(options);
+}
+
+StallWatchdog::~StallWatchdog() { Stop(); }
+
+void StallWatchdog::AttachLoopThread() {
+  loop_spans_ = ActiveSpans::AttachCurrentThread();
+  std::string error;
+  if (!sampler_.AttachCurrentThread(&error)) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    error_ = error;
+  }
+}
+
+void StallWatchdog::set_options(const StallWatchdogOptions& options) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!file_ || file_->path() != options.path ||
+      options.max_file_bytes != options_.max_file_bytes ||
+      options.keep_files != options_.keep_files) {
+    file_ = options.path.empty()
+                ? nullptr
+                : std::make_shared<RotatingFile>(
+                      options.path, options.max_file_bytes, options.keep_files);
+  }
+  options_ = options;
+}
+
+void StallWatchdog::Beat(uint64_t seq, Clock::time_point now) {
+  beat_time_.store(now.time_since_epoch().count(), std::memory_order_relaxed);
+  beat_seq_.store(seq, std::memory_order_release);
+}
+
+StallWatchdog::Clock::time_point StallWatchdog::Poll(Clock::time_point now) {
+  StallWatchdogOptions options;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    options = options_;
+  }
+
+  if (pending_) {
+    if (beat_seq_.load(std::memory_order_acquire) == sent_seq_) {
+      const Clock::time_point beat(
+          Clock::duration(beat_time_.load(std::memory_order_relaxed)));
+      pending_ = false;
+      next_beat_ = std::max(beat, sent_at_) + options.interval;
+      static Histogram* const latency = MetricsRegistry::Get().GetHistogram(
+          "virok_platform_loop_microseconds",
+          "Time for the platform event loop to answer a watchdog heartbeat");
+      latency->Record(std::chrono::duration_cast<std::chrono::microseconds>(
+                          beat - sent_at_)
+                          .count());
+
+      bool recovered = false;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        beats_++;
+        if (stalled_) {
+          stalled_ = false;
+          recovered = true;
+          current_.duration_ms = ToMs(beat - sent_at_);
+          current_.recovered = true;
+          longest_ms_ = std::max(longest_ms_, current_.duration_ms);
+          last_ = current_;
+        }
+      }
+      if (recovered) Write(current_, "recovered");
+    } else if (!current_.recovered && current_.id != 0) {
+      // Зависання триває: лише чекаємо на відповідь.
+      return now + options.interval;
+    } else if (now - sent_at_ >= options.budget) {
+      current_ = Capture(now);
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stalled_ = true;
+        current_.id = ++stalls_;
+        longest_ms_ = std::max(longest_ms_, current_.duration_ms);
+        last_ = current_;
+      }
+      static Counter* const stalls = MetricsRegistry::Get().GetCounter(
+          "virok_platform_stalls_total",
+          "Platform event loop stalls longer than the watchdog budget");
+      stalls->Add();
+      Write(current_, "stall");
+      return now + options.interval;
+    } else {
+      // Відповідь помічається не пізніше ніж за interval, тож пульси
+      // йдуть приблизно раз на interval і при коротших за budget
+      // відповідях.
+      return std::min(sent_at_ + options.budget, now + options.interval);
+    }
+  }
+
+  if (now < next_beat_) return next_beat_;
+  pending_ = true;
+  sent_at_ = now;
+  post_heartbeat_(++sent_seq_);
+  // Відповідь могла прийти одразу (тести, пульс з потоку циклу).
+  if (beat_seq_.load(std::memory_order_acquire) == sent_seq_) return now;
+  return now + std::min(options.budget, options.interval);
+}
+
+StallReport StallWatchdog::Capture(Clock::time_point now) {
+  StallReport report;
+  report.duration_ms = ToMs(now - sent_at_);
+  report.started_unix_ms = UnixNowMs() - report.duration_ms;
+  if (loop_spans_ != nullptr) {
+    const int64_t now_ns = Tracer::NowNs();
+    for (const ActiveSpans::Span& span : loop_spans_->Snapshot()) {
+      report.spans.push_back({span.category, span.name,
+                              (now_ns - span.start_ns) / 1000000});
+    }
+  }
+  bool sample_stack;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sample_stack = options_.sample_stack;
+  }
+  if (sample_stack && sampler_.attached() &&
+      !sampler_.Sample(&report.stack, &report.stack_error)) {
+    report.stack.clear();
+  }
+  return report;
+}
+
+void StallWatchdog::Write(const StallReport& report, const char* event) {
+  std::shared_ptr<RotatingFile> file;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    file = file_;
+  }
+  if (!file) return;
+  std::string error;
+  // Стек знято на початку зависання; у "recovered" він не повторюється.
+  if (!file->Append(ReportJson(report, event, !report.recovered), &error)) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    error_ = std::move(error);
+  }
+}
+
+void StallWatchdog::Start() {
+  Stop();
+  pending_ = false;
+  current_ = StallReport();
+  next_beat_ = Clock::now();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = false;
+    stalled_ = false;
+  }
+  thread_ = std::thread(&StallWatchdog::Run, this);
+}
+
+void StallWatchdog::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+    wake_.notify_all();
+  }
+  if (thread_.joinable()) thread_.join();
+}
+
+void StallWatchdog::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stop_) {
+    lock.unlock();
+    const Clock::time_point next = Poll(Clock::now());
+    lock.lock();
+    wake_.wait_until(lock, next, [this] { return stop_; });
+  }
+}
+
+StallWatchdogStatus StallWatchdog::status() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  StallWatchdogStatus status;
+  status.running = thread_.joinable();
+  status.stalled = stalled_;
+  status.beats = beats_;
+  status.stalls = stalls_;
+  status.longest_ms = longest_ms_;
+  status.last = last_;
+  status.error = error_;
+  return status;
+}
+
+}  // namespace virok
@@ -0,0 +1,164 @@
+#ifndef NATIVE_WATCHDOG_STALL_WATCHDOG_H_
+#define NATIVE_WATCHDOG_STALL_WATCHDOG_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "trace/trace.h"
+#include "watchdog/rotating_file.h"
+#include "watchdog/stack_sampler.h"
+
+namespace virok {
+
+struct StallWatchdogOptions {
+  // Скільки цикл подій може не відповідати на пульс, поки це ще не
+  // зависання.
+  std::chrono::milliseconds budget = std::chrono::milliseconds(250);
+  // Проміжок між відповіддю на пульс і наступним пульсом.
+  std::chrono::milliseconds interval = std::chrono::milliseconds(100);
+  // Журнал зависань (JSON-рядок на подію); порожній — лише status().
+  std::string path;
+  uint64_t max_file_bytes = 1 << 20;
+  // Скільки попередніх журналів тримати (path.1 ... path.N).
+  int keep_files = 3;
+  bool sample_stack = true;
+};
+
+// Одне зависання циклу подій.
+struct StallReport {
+  uint64_t id = 0;
+  // Коли пульс не дістав відповіді (системний час, мс від епохи).
+  int64_t started_unix_ms = 0;
+  // Від відправки пульсу до відповіді; поки цикл висить — до моменту
+  // виявлення.
+  int64_t duration_ms = 0;
+  bool recovered = false;
+  // Незавершені спани потоку циклу на момент виявлення (канал, метод,
+  // нативна операція) і скільки кожен уже тривав.
+  struct Span {
+    std::string category;
+    std::string name;
+    int64_t age_ms;
+  };
+  std::vector<Span> spans;
+  // Стек потоку циклу на момент виявлення (див. StackSampler).
+  std::vector<std::string> stack;
+  std::string stack_error;
+};
+
+struct StallWatchdogStatus {
+  bool running = false;
+  bool stalled = false;
+  uint64_t beats = 0;
+  uint64_t stalls = 0;
+  int64_t longest_ms = 0;
+  // Останнє зависання (id == 0 — ще не було).
+  StallReport last;
+  // Остання помилка запису журналу.
+  std::string error;
+};
+
+// Сторожовий потік для циклу подій потоку платформи (цикл повідомлень
+// Win32, головний контекст GLib): виявляє, коли цикл не відповідає, і
+// записує, що в ньому виконувалося.
+//
+// Сторож надсилає пульс через |post_heartbeat| (PostMessage,
+// g_main_context_invoke) — у ту саму чергу, що й введення та виклики
+// каналів, — а обробник у циклі викликає Beat(seq). Якщо відповіді немає
+// довше за budget, сторож знімає незавершені спани (ActiveSpans —
+// TraceScope обробників каналів і нативних операцій) і стек потоку
+// циклу та пише подію "stall"; коли відповідь приходить — подію
+// "recovered" з повною тривалістю. Тож і зависання, після якого касу
+// вбили, лишається в журналі.
+//
+// Пульси йдуть приблизно раз на interval (відповідь сторож помічає не
+// пізніше ніж за interval), тож зависання, довше за budget + 2×interval,
+// виявляється завжди, а коротші — залежно від того, коли в них потрапив
+// пульс. Тривалість рахується від пульсу і занижена не більше ніж на
+// 2×interval. Затримка відповіді на
+// кожен пульс пишеться в гістограму virok_platform_loop_microseconds.
+//
+// Poll детермінований щодо переданого часу (тести) і викликається з
+// одного потоку; Start() запускає власний потік, що його викликає. Решта
+// методів — з будь-якого потоку.
+class StallWatchdog {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using PostHeartbeat = std::function<void(uint64_t seq)>;
+
+  explicit StallWatchdog(PostHeartbeat post_heartbeat,
+                         StallWatchdogOptions options = {});
+  ~StallWatchdog();
+
+  StallWatchdog(const StallWatchdog&) = delete;
+  StallWatchdog& operator=(const StallWatchdog&) = delete;
+
+  // Викликати з потоку циклу до Start(): його спани і стек потраплять у
+  // звіти.
+  void AttachLoopThread();
+
+  // Нові пороги діють з наступного пульсу.
+  void set_options(const StallWatchdogOptions& options);
+
+  // Пульс |seq| дійшов до циклу. Два атомарні записи — безпечно
+  // викликати прямо з обробника повідомлень.
+  void Beat(uint64_t seq) { Beat(seq, Clock::now()); }
+  void Beat(uint64_t seq, Clock::time_point now);
+
+  // Один крок сторожа: надсилає пульс, виявляє або завершує зависання.
+  // Повертає, коли викликати знову.
+  Clock::time_point Poll(Clock::time_point now);
+
+  void Start();
+  // Зависання, що триває, лишається в журналі як "stall" без
+  // "recovered".
+  void Stop();
+  bool running() const { return thread_.joinable(); }
+
+  StallWatchdogStatus status() const;
+
+ private:
+  void Run();
+  // Знімок спанів і стеку потоку циклу для нового зависання.
+  StallReport Capture(Clock::time_point now);
+  void Write(const StallReport& report, const char* event);
+
+  PostHeartbeat post_heartbeat_;
+  ActiveSpans* loop_spans_ = nullptr;
+  StackSampler sampler_;
+
+  std::atomic<Clock::rep> beat_time_{0};
+  std::atomic<uint64_t> beat_seq_{0};
+
+  // Стан Poll: належить потоку, що його викликає.
+  uint64_t sent_seq_ = 0;
+  bool pending_ = false;
+  Clock::time_point sent_at_;
+  Clock::time_point next_beat_;
+  StallReport current_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  StallWatchdogOptions options_;
+  std::shared_ptr<RotatingFile> file_;
+  bool stalled_ = false;
+  uint64_t beats_ = 0;
+  uint64_t stalls_ = 0;
+  int64_t longest_ms_ = 0;
+  StallReport last_;
+  std::string error_;
+  bool stop_ = false;
+  std::thread thread_;
+};
+
+}  // namespace virok
+
+#endif  // NATIVE_WATCHDOG_STALL_WATCHDOG_H_
@@ -0,0 +1,222 @@
+#include "archive_channel.h"
+
+#include <flutter/encodable_value.h>
+#include <flutter/method_channel.h>
+#include <flutter/standard_method_codec.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "archive/archived_receipt.h"
+#include "archive/receipt_archive.h"
+#include "channel_args.h"
+#include "metrics/metrics.h"
+#include "trace/trace.h"
+
+namespace {
+
+using flutter::EncodableList;
+using flutter::EncodableMap;
+using flutter::EncodableValue;
+
+constexpr int64_t kDefaultLimit = 50;
+
+std::unique_ptr<flutter::MethodChannel<>> archive_channel;
+virok::ReceiptArchive receipt_archive;
+
+// Чек у формі, яку чекає Dart (суми — в гривнях, кількість — дробова).
+EncodableValue ReceiptToValue(const virok::ArchivedReceipt& r) {
+  EncodableList lines;
+  for (const virok::ArchivedLine& line : r.lines) {
+    EncodableList barcodes;
+    for (const std::string& barcode : line.barcodes) {
+      barcodes.push_back(EncodableValue(barcode));
+    }
+    EncodableMap map;
+    map[EncodableValue("guid")] = EncodableValue(line.guid);
+    map[EncodableValue("code")] = EncodableValue(line.code);
+    map[EncodableValue("name")] = EncodableValue(line.name);
+    map[EncodableValue("barcodes")] = EncodableValue(std::move(barcodes));
+    map[EncodableValue("quantity")] = EncodableValue(line.qty_milli / 1000.0);
+    map[EncodableValue("price")] = EncodableValue(line.price / 100.0);
+    map[EncodableValue("discount")] = EncodableValue(line.discount / 100.0);
+    lines.push_back(EncodableValue(std::move(map)));
+  }
+  EncodableList payments;
+  for (const virok::ArchivedPayment& payment : r.payments) {
+    EncodableMap map;
+    map[EncodableValue("form")] = EncodableValue(payment.form);
+    map[EncodableValue("amount")] = EncodableValue(payment.amount / 100.0);
+    payments.push_back(EncodableValue(std::move(map)));
+  }
+  EncodableMap map;
+  map[EncodableValue("fiscalNumber")] = EncodableValue(r.fiscal_number);
+  map[EncodableValue("rrn")] = EncodableValue(r.rrn);
+  map[EncodableValue("createdMs")] = EncodableValue(r.created_ms);
+  map[EncodableValue("date")] = EncodableValue(r.date);
+  map[EncodableValue("docType")] = EncodableValue(r.doc_type);
+  map[EncodableValue("cashier")] = EncodableValue(r.cashier);
+  map[EncodableValue("total")] = EncodableValue(r.total / 100.0);
+  map[EncodableValue("lines")] = EncodableValue(std::move(lines));
+  map[EncodableValue("payments")] = EncodableValue(std::move(payments));
+  if (!r.visualization.empty()) {
+    map[EncodableValue("visualization")] = EncodableValue(r.visualization);
+  }
+  return EncodableValue(std::move(map));
+}
+
+EncodableValue ReceiptsToValue(
+    const std::vector<virok::ArchivedReceipt>& receipts) {
+  EncodableList list;
+  list.reserve(receipts.size());
+  for (const virok::ArchivedReceipt& r : receipts) {
+    list.push_back(ReceiptToValue(r));
+  }
+  return EncodableValue(std::move(list));
+}
+
+EncodableValue StatsToValue(const virok::ReceiptArchiveStats& stats) {
+  EncodableMap map;
+  map[EncodableValue("receipts")] =
+      EncodableValue(static_cast<int64_t>(stats.receipts));
+  map[EncodableValue("segments")] =
+      EncodableValue(static_cast<int64_t>(stats.segments));
+  map[EncodableValue("bytes")] =
+      EncodableValue(static_cast<int64_t>(stats.bytes));
+  map[EncodableValue("deadBytes")] =
+      EncodableValue(static_cast<int64_t>(stats.dead_bytes));
+  return EncodableValue(std::move(map));
+}
+
+int32_t Today() {
+  return virok::LocalDate(
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count());
+}
+
+virok::Histogram* LookupLatency(const char* query) {
+  return virok::MetricsRegistry::Get().GetHistogram(
+      "virok_archive_lookup_microseconds",
+      "Local receipt archive lookup time",
+      virok::MetricLabel("query", query));
+}
+
+void HandleArchiveCall(const flutter::MethodCall<>& call,
+                       std::unique_ptr<flutter::MethodResult<>> result) {
+  const auto* args = std::get_if<EncodableMap>(call.arguments());
+  const std::string& method = call.method_name();
+  virok::TraceScope trace_scope("archive", method);
+  const size_t limit =
+      static_cast<size_t>(IntArg(args, "limit", kDefaultLimit));
+
+  if (method == "open") {
+    std::string error;
+    if (!receipt_archive.Open(StringArg(args, "path"), &error)) {
+      result->Error("OPEN_FAILED", error);
+      return;
+    }
+    result->Success(StatsToValue(receipt_archive.stats()));
+  } else if (method == "put") {
+    static virok::Histogram* const latency =
+        virok::MetricsRegistry::Get().GetHistogram(
+            "virok_archive_put_microseconds",
+            "Local receipt archive write time");
+    virok::LatencyTimer timer(latency);
+    virok::ArchivedReceipt receipt;
+    std::string error;
+    if (!virok::ParseArchivedReceipt(StringArg(args, "json"), &receipt,
+                                     &error)) {
+      result->Error("INVALID_RECEIPT", error);
+      return;
+    }
+    if (!receipt_archive.Put(receipt, &error)) {
+      result->Error("WRITE_FAILED", error);
+      return;
+    }
+    result->Success(EncodableValue(true));
+  } else if (method == "byFiscalNumber") {
+    static virok::Histogram* const latency = LookupLatency("fiscal_number");
+    virok::LatencyTimer timer(latency);
+    virok::ArchivedReceipt receipt;
+    if (receipt_archive.ByFiscalNumber(StringArg(args, "fiscalNumber"),
+                                       &receipt)) {
+      result->Success(ReceiptToValue(receipt));
+    } else {
+      result->Success();
+    }
+  } else if (method == "byRrn") {
+    static virok::Histogram* const latency = LookupLatency("rrn");
+    virok::LatencyTimer timer(latency);
+    result->Success(
+        ReceiptsToValue(receipt_archive.ByRrn(StringArg(args, "rrn"), limit)));
+  } else if (method == "byBarcode") {
+    static virok::Histogram* const latency = LookupLatency("barcode");
+    virok::LatencyTimer timer(latency);
+    result->Success(ReceiptsToValue(
+        receipt_archive.ByBarcode(StringArg(args, "barcode"), limit)));
+  } else if (method == "byDate") {
+    static virok::Histogram* const latency = LookupLatency("date");
+    virok::LatencyTimer timer(latency);
+    const int32_t from = static_cast<int32_t>(IntArg(args, "from"));
+    const int32_t to = static_cast<int32_t>(IntArg(args, "to", from));
+    result->Success(
+        ReceiptsToValue(receipt_archive.ByDate(from, to, limit)));
+  } else if (method == "compact") {
+    virok::ReceiptArchiveCompaction compaction;
+    if (!receipt_archive.Compact(
+            static_cast<int32_t>(IntArg(args, "today", Today())),
+            &compaction)) {
+      result->Error("COMPACT_FAILED", "Receipt archive compaction failed");
+      return;
+    }
+    EncodableMap map;
+    map[EncodableValue("expiredSegments")] =
+        EncodableValue(static_cast<int64_t>(compaction.expired_segments));
+    map[EncodableValue("rewrittenSegments")] =
+        EncodableValue(static_cast<int64_t>(compaction.rewritten_segments));
+    map[EncodableValue("reclaimedBytes")] =
+        EncodableValue(static_cast<int64_t>(compaction.reclaimed_bytes));
+    result->Success(EncodableValue(std::move(map)));
+  } else if (method == "stats") {
+    result->Success(StatsToValue(receipt_archive.stats()));
+  } else {
+    result->NotImplemented();
+  }
+}
+
+}  // namespace
+
+virok::MaintenanceStep CompactArchiveStep() {
+  if (!receipt_archive.is_open()) return virok::MaintenanceStep::kDone;
+  virok::ReceiptArchiveCompaction compaction;
+  if (!receipt_archive.Compact(Today(), &compaction, 1)) {
+    return virok::MaintenanceStep::kFailed;
+  }
+  return compaction.pending_segments ? virok::MaintenanceStep::kMore
+                                     : virok::MaintenanceStep::kDone;
+}
+
+bool ArchiveShiftChecks(int64_t from_ms,
+                        std::vector<virok::ReconcileCheck>* checks) {
+  if (!receipt_archive.is_open()) return false;
+  const std::vector<virok::ArchivedReceipt> receipts =
+      receipt_archive.ByDate(virok::LocalDate(from_ms), Today(), SIZE_MAX);
+  checks->reserve(receipts.size());
+  for (const virok::ArchivedReceipt& receipt : receipts) {
+    if (receipt.created_ms >= from_ms) {
+      checks->push_back(virok::CheckFromArchive(receipt));
+    }
+  }
+  return true;
+}
+
+void RegisterArchiveChannel(flutter::BinaryMessenger* messenger) {
+  archive_channel = std::make_unique<flutter::MethodChannel<>>(
+      messenger, "com.virok/archive",
+      &flutter::StandardMethodCodec::GetInstance());
+  archive_channel->SetMethodCallHandler(HandleArchiveCall);
+}
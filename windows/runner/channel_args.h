@@ -0,0 +1,69 @@
+#ifndef RUNNER_CHANNEL_ARGS_H_
+#define RUNNER_CHANNEL_ARGS_H_
+
+#include <flutter/encodable_value.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Допоміжні функції для читання аргументів MethodChannel (мапа з Dart).
+// Відсутній аргумент або аргумент іншого типу повертає |fallback|.
+
+inline const flutter::EncodableValue* FindArg(const flutter::EncodableMap* args,
+                                              const char* key) {
+  if (!args) return nullptr;
+  auto it = args->find(flutter::EncodableValue(key));
+  return it == args->end() ? nullptr : &it->second;
+}
+
+inline int64_t IntArg(const flutter::EncodableMap* args, const char* key,
+                      int64_t fallback = 0) {
+  const flutter::EncodableValue* v = FindArg(args, key);
+  if (v && (std::holds_alternative<int32_t>(*v) ||
+            std::holds_alternative<int64_t>(*v))) {
+    return v->LongValue();
+  }
+  return fallback;
+}
+
+inline double DoubleArg(const flutter::EncodableMap* args, const char* key,
+                        double fallback = 0) {
+  const flutter::EncodableValue* v = FindArg(args, key);
+  if (!v) return fallback;
+  if (const auto* d = std::get_if<double>(v)) return *d;
+  if (std::holds_alternative<int32_t>(*v) || std::holds_alternative<int64_t>(*v)) {
+    return static_cast<double>(v->LongValue());
+  }
+  return fallback;
+}
+
+inline bool BoolArg(const flutter::EncodableMap* args, const char* key,
+                    bool fallback = false) {
+  const flutter::EncodableValue* v = FindArg(args, key);
+  const auto* b = v ? std::get_if<bool>(v) : nullptr;
+  return b ? *b : fallback;
+}
+
+inline std::string StringArg(const flutter::EncodableMap* args, const char* key,
+                             const std::string& fallback = std::string()) {
+  const flutter::EncodableValue* v = FindArg(args, key);
+  const auto* s = v ? std::get_if<std::string>(v) : nullptr;
+  return s ? *s : fallback;
+}
+
+inline std::vector<std::string> StringListArg(const flutter::EncodableMap* args,
+                                              const char* key) {
+  std::vector<std::string> out;
+  const flutter::EncodableValue* v = FindArg(args, key);
+  const auto* list = v ? std::get_if<flutter::EncodableList>(v) : nullptr;
+  if (!list) return out;
+  out.reserve(list->size());
+  for (const auto& item : *list) {
+    const auto* s = std::get_if<std::string>(&item);
+    out.push_back(s ? *s : std::string());
+  }
+  return out;
+}
+
+#endif  // RUNNER_CHANNEL_ARGS_H_
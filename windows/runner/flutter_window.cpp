@@ -2,6 +2,8 @@
 #include <optional>
 #include "flutter/generated_plugin_registrant.h"
 
+#include <flutter/event_channel.h>
+#include <flutter/event_stream_handler_functions.h>
 #include <flutter/method_channel.h>
 #include <flutter/standard_method_codec.h>
 #include <flutter/encodable_value.h>
@@ -9,49 +11,88 @@
 #include <string>
 #include <stdio.h> 
 #include <vector> 
+#include <algorithm>
 #include <iomanip>
 #include <sstream>
-#include <mutex> // Додано для Thread Safety
+#include <mutex>
+
+#include "archive_channel.h"
+#include "maintenance_channel.h"
+#include "report_channel.h"
+#include "report/report_decoder.h"
+#include "scale_channel.h"
+#include "scanner_channel.h"
+#include "search_channel.h"
+#include "promo_channel.h"
+#include "fiscal/fiscal_host.h"
+#include "fiscal/fiscal_session_pool.h"
+#include "fiscal/fiscal_status_cache.h"
+#include "metrics_channel.h"
+#include "metrics/metrics.h"
+#include "parked_channel.h"
+#include "startup_channel.h"
+#include "startup/startup_timeline.h"
+#include "terminal_channel.h"
+#include "text/utf.h"
+#include "trace_channel.h"
+#include "trace/trace.h"
 
 // Підключення згенерованого заголовку (вже без #import)
 #include "cashalotapi64.tlh" 
 // using namespace CashaLotApi; 
 
-ICashaLotApiAddinPtr gsCashaLotApi = NULL;
-// Глобальний м'ютекс для захисту COM викликів
-std::mutex apiMutex;
-
 const CLSID CLSID_CashalotActual = {0x910038E1,0x38F5,0x449D,{0x87,0xF4,0x53,0xC2,0x8D,0x93,0x94,0x5E}};
-std::string lastComError = "";
 
 // --- ДОПОМІЖНІ ФУНКЦІЇ ---
 #include <string>
 #include <windows.h>
 
-// Конвертація UTF-8 (від Flutter) -> Wide String (для Windows COM)
-std::wstring Utf8ToWide(const std::string& str) {
-    if (str.empty()) return std::wstring();
-    int size_needed = MultiByteToWideChar(CP_UTF8, 0, &str[0], (int)str.size(), NULL, 0);
-    std::wstring wstrTo(size_needed, 0);
-    MultiByteToWideChar(CP_UTF8, 0, &str[0], (int)str.size(), &wstrTo[0], size_needed);
-    return wstrTo;
+// Перекодування для COM (native/text/utf.h): один прохід у потоколокальний
+// буфер і одна алокація самого BSTR/std::string, без проміжного wstring.
+static_assert(sizeof(OLECHAR) == sizeof(char16_t), "BSTR is UTF-16");
+
+// Конвертація UTF-8 (від Flutter) -> BSTR (для Windows COM)
+_bstr_t Utf8ToBstr(const std::string& str) {
+    std::u16string_view w = virok::Utf8ToUtf16Scratch(str);
+    return _bstr_t(SysAllocStringLen(reinterpret_cast<const OLECHAR*>(w.data()), (UINT)w.size()), false);
+}
+
+// Аргумент COM-методу (VT_BSTR) з UTF-8
+_variant_t Utf8ToVariant(const std::string& str) {
+    std::u16string_view w = virok::Utf8ToUtf16Scratch(str);
+    VARIANT v;
+    v.vt = VT_BSTR;
+    v.bstrVal = SysAllocStringLen(reinterpret_cast<const OLECHAR*>(w.data()), (UINT)w.size());
+    return _variant_t(v, false);  // без копії: _variant_t забирає BSTR
+}
+
+std::string WideToUtf8(const wchar_t* str, size_t len) {
+    std::string out;
+    virok::Utf16ToUtf8(std::u16string_view(reinterpret_cast<const char16_t*>(str), len), &out);
+    return out;
+}
+
+std::string WideToUtf8(const std::wstring& str) {
+    return WideToUtf8(str.data(), str.size());
 }
 
 // Конвертація BSTR (від Windows) -> UTF-8 (для Flutter)
 std::string BstrToUtf8(BSTR bstr) {
     if (!bstr) return "";
-    int len = (int)SysStringLen(bstr);
-    int size_needed = WideCharToMultiByte(CP_UTF8, 0, bstr, len, NULL, 0, NULL, NULL);
-    if (size_needed <= 0) return "";
-    std::string strTo(size_needed, 0);
-    WideCharToMultiByte(CP_UTF8, 0, bstr, len, &strTo[0], size_needed, NULL, NULL);
-    return strTo;
+    return WideToUtf8(bstr, SysStringLen(bstr));
 }
 
 std::string BstrToUtf8(_bstr_t bstrWrapper) {
     return BstrToUtf8(bstrWrapper.GetBSTR());
 }
 
+// Рядковий результат COM: VT_BSTR читаємо напряму, без копії в _bstr_t
+// (JsonVal чека — десятки КБ).
+std::string VariantToUtf8(const _variant_t& v) {
+    if (v.vt == VT_BSTR) return BstrToUtf8(v.bstrVal);
+    return BstrToUtf8(_bstr_t(v));
+}
+
 // Конвертація double -> String ("15,65") - З КОМОЮ!
 std::string DoubleToCurrencyString(double value) {
     std::ostringstream out;
@@ -62,13 +103,25 @@ std::string DoubleToCurrencyString(double value) {
     return s;
 }
 
-// Функція ініціалізації API
-bool InitCashalot() {
-    if (gsCashaLotApi != NULL) return true;
-    HRESULT hr = gsCashaLotApi.CreateInstance(CLSID_CashalotActual);
+// Параметри Cashalot з Dart (setParameter). Кожна сесія отримує їх при
+// створенні свого COM-об'єкта, тож нові ПРРО налаштовуються так само.
+std::mutex paramsMutex;
+std::vector<std::pair<std::string, std::string>> cashalotParams;
+
+// Прогрів під час запуску (з потоку StartPrewarm, ще до Flutter).
+// Самі об'єкти створюються пізніше в потоках сесій (CashalotDevice), тут
+// лише завантажуємо сервер: DLL та її залежності лишаються в процесі, і
+// перший виклик з Dart не чекає диска.
+bool PrewarmCashalotServer(std::string* error) {
+    HRESULT hr = CoInitializeEx(NULL, COINIT_MULTITHREADED);
+    const bool uninit = SUCCEEDED(hr);
+    IClassFactory* factory = NULL;
+    hr = CoGetClassObject(CLSID_CashalotActual, CLSCTX_ALL, NULL, IID_IClassFactory, (void**)&factory);
+    if (SUCCEEDED(hr)) factory->Release();
+    if (uninit) CoUninitialize();
     if (FAILED(hr)) {
-        char buf[256]; sprintf_s(buf, "HRESULT Error: 0x%08X", hr);
-        lastComError = std::string(buf);
+        char buf[64]; sprintf_s(buf, "HRESULT Error: 0x%08X", hr);
+        *error = buf;
         return false;
     }
     return true;
@@ -81,64 +134,270 @@ struct ComResult {
     std::string error;
 };
 
-ComResult InvokeDispatchMethod(std::wstring methodName, std::vector<_variant_t> args) {
-    // 1. БЛОКУВАННЯ ПОТОКУ (Thread Safety)
-    std::lock_guard<std::mutex> lock(apiMutex);
+// Додатковий останній аргумент COM-методу, якого немає в Dart.
+enum class ExtraArg { kNone, kShortReport, kEmptyParams };
+
+// Методи каналу com.cashalot/api, що йдуть у COM через IDispatch:
+// аргументи Dart у порядку параметрів COM.
+struct CashalotMethod {
+    const char* name;
+    const wchar_t* comName;
+    std::vector<const char*> args;
+    ExtraArg extra;
+    bool report;  // відповідь містить X/Z-звіт (AttachReport)
+};
+
+const std::vector<CashalotMethod> kCashalotMethods = {
+    {"getCurrentStatus", L"GetCurrentStatus", {"fiscalNum"}, ExtraArg::kNone, false},
+    {"openShift", L"OpenShift", {"fiscalNum"}, ExtraArg::kNone, false},
+    {"closeShift", L"CloseShift", {"fiscalNum"}, ExtraArg::kNone, true},
+    // GetXReport має другий параметр IsShort (bool), передаємо false
+    {"printXReport", L"GetXReport", {"fiscalNum"}, ExtraArg::kShortReport, true},
+    {"fiscalizeCheck", L"FiscalizeCheck", {"fiscalNum", "jsonGoods", "jsonPay"}, ExtraArg::kNone, false},
+    {"serviceInput", L"ServiceInput", {"fiscalNum", "amount"}, ExtraArg::kNone, false},
+    {"serviceOutput", L"ServiceOutput", {"fiscalNum", "amount"}, ExtraArg::kNone, false},
+    // PayByPaymentCard(FiscalNum, Amount, OtherParams)
+    {"payByPaymentCard", L"PayByPaymentCard", {"fiscalNum", "amount"}, ExtraArg::kEmptyParams, false},
+    {"getPOSTerminalList", L"GetPOSTerminalList", {"fiscalNum"}, ExtraArg::kNone, false},
+    {"returnPaymentByCard", L"ReturnPaymentByPaymentCard", {"fiscalNum", "amount", "rrn"}, ExtraArg::kEmptyParams, false},
+    {"cancelPaymentByCard", L"CancelPaymentByPaymentCard", {"fiscalNum", "amount", "invoiceNum"}, ExtraArg::kEmptyParams, false},
+    {"fiscalizeReturnCheck", L"FiscalizeReturnCheck", {"fiscalNum", "jsonGoods", "jsonPay", "returnReceiptFiscalNum"}, ExtraArg::kNone, false},
+};
+
+const CashalotMethod* FindCashalotMethod(const std::string& name) {
+    for (const CashalotMethod& m : kCashalotMethods) {
+        if (name == m.name) return &m;
+    }
+    return nullptr;
+}
+
+// Окремий COM-об'єкт Cashalot для одного ПРРО. Створюється, викликається
+// і звільняється лише в потоці своєї сесії (STA, див. FiscalSessionPool),
+// тож власний м'ютекс йому не потрібен.
+class CashalotDevice : public virok::FiscalDevice {
+public:
+    explicit CashalotDevice(std::string fiscalNum) : fiscalNum_(std::move(fiscalNum)) {}
 
-    if (gsCashaLotApi == NULL) {
-         if (!InitCashalot()) return {false, "", "API is null and failed to re-init"};
+    ~CashalotDevice() override {
+        if (api_ != NULL) api_.Release();
     }
 
-    IDispatchPtr spDispatch;
-    HRESULT hr = gsCashaLotApi->QueryInterface(IID_IDispatch, (void**)&spDispatch);
-    if (FAILED(hr) || spDispatch == NULL) return {false, "", "Failed to get IDispatch"};
-
-    DISPID dispid;
-    LPOLESTR pMethodName = (LPOLESTR)methodName.c_str();
-    hr = spDispatch->GetIDsOfNames(IID_NULL, &pMethodName, 1, LOCALE_USER_DEFAULT, &dispid);
-    if (FAILED(hr)) return {false, "", "Method not found: " + BstrToUtf8(_bstr_t(methodName.c_str()))};
-
-    DISPPARAMS params = { NULL, NULL, 0, 0 };
-    std::vector<VARIANT> reversedArgs;
-    int argCount = static_cast<int>(args.size());
-    if (argCount > 0) {
-        params.cArgs = (UINT)argCount;
-        // Аргументи передаються в зворотному порядку для Invoke
-        for (int i = argCount - 1; i >= 0; i--) reversedArgs.push_back(args[i]);
-        params.rgvarg = reversedArgs.data();
+    virok::FiscalReply Call(const std::string& method, const virok::FiscalArgs& args) override {
+        ComResult res;
+        try {
+            res = CallLocked(method, args);
+        } catch (_com_error& e) {
+            char buf[64]; sprintf_s(buf, "HRESULT: 0x%08X", e.Error());
+            res = {false, "", buf};
+        } catch (...) {
+            res = {false, "", "Crash inside C++ handler"};
+        }
+        if (!res.error.empty()) {
+            virok::MetricsRegistry::Get()
+                .GetCounter("virok_com_failures_total", "Failed Cashalot COM calls",
+                            virok::MetricLabel("method", method))
+                ->Add();
+        }
+        virok::FiscalReply reply;
+        reply.success = res.success;
+        reply.json_val = std::move(res.jsonVal);
+        reply.error = std::move(res.error);
+        return reply;
     }
 
-    _variant_t resultVar;
-    // Використовуємо try/catch для захисту від Access Violation всередині DLL
-    try {
-        hr = spDispatch->Invoke(dispid, IID_NULL, LOCALE_USER_DEFAULT, DISPATCH_METHOD, &params, &resultVar, NULL, NULL);
-    } catch (...) {
-        return {false, "", "CRITICAL: Exception inside Cashalot DLL"};
+private:
+    // Об'єкт створюється при першому виклику (і знову після невдачі) та
+    // отримує всі параметри, задані з Dart.
+    bool Init(std::string* error) {
+        if (api_ != NULL) return true;
+        HRESULT hr = api_.CreateInstance(CLSID_CashalotActual);
+        if (FAILED(hr)) {
+            char buf[256]; sprintf_s(buf, "Init Failed: HRESULT Error: 0x%08X", hr);
+            *error = buf;
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(paramsMutex);
+        for (const auto& param : cashalotParams) ApplyParameter(param.first, param.second);
+        return true;
     }
 
-    if (FAILED(hr)) {
-        char buf[256]; sprintf_s(buf, "Invoke Failed: 0x%08X", hr);
-        return {false, "", std::string(buf)};
+    void ApplyParameter(const std::string& name, const std::string& value) {
+        // Сесія обслуговує рівно свій ПРРО, хоч би який номер налаштовував Dart.
+        const bool ownDevice = name == "DeviceIDFnRRO" && !fiscalNum_.empty();
+        api_->SetParameter(Utf8ToBstr(name), Utf8ToBstr(ownDevice ? fiscalNum_ : value));
     }
 
-    // Розбір результату (CashalotApiRetVal)
-    if (resultVar.vt == VT_DISPATCH && resultVar.pdispVal != NULL) {
-        IDispatchPtr pResultObj = resultVar.pdispVal;
-        
-        auto GetProp = [&](std::wstring p) -> _variant_t {
-            DISPID id; LPOLESTR pn = (LPOLESTR)p.c_str();
-            pResultObj->GetIDsOfNames(IID_NULL, &pn, 1, LOCALE_USER_DEFAULT, &id);
-            _variant_t r; DISPPARAMS n = {NULL, NULL, 0, 0};
-            pResultObj->Invoke(id, IID_NULL, LOCALE_USER_DEFAULT, DISPATCH_PROPERTYGET, &n, &r, NULL, NULL);
-            return r;
-        };
-        return {(bool)GetProp(L"Return"), BstrToUtf8(_bstr_t(GetProp(L"JsonVal"))), ""};
-    } 
-    else if (resultVar.vt == VT_BOOL) {
-        bool s = (bool)resultVar;
-        return {s, s ? "{\"Ret\":true}" : "{\"Ret\":false}", ""};
+    ComResult CallLocked(const std::string& method, const virok::FiscalArgs& args) {
+        std::string error;
+        if (!Init(&error)) return {false, "", error};
+
+        if (method == "setParameter") {
+            ApplyParameter(args.at("name"), args.at("value"));
+            return {true, "", ""};
+        }
+        if (method == "getVersion") {
+            _variant_t varVer = api_->GetVersion();
+            return {true, VariantToUtf8(varVer), ""};
+        }
+
+        const CashalotMethod* m = FindCashalotMethod(method);
+        if (!m) return {false, "", "Method not found: " + method};
+        std::vector<_variant_t> comArgs;
+        for (const char* key : m->args) {
+            auto it = args.find(key);
+            comArgs.push_back(Utf8ToVariant(it != args.end() ? it->second : std::string()));
+        }
+        if (m->extra == ExtraArg::kShortReport) comArgs.push_back(_variant_t(false));
+        if (m->extra == ExtraArg::kEmptyParams) comArgs.push_back(_variant_t(L""));
+        return Invoke(m->comName, std::move(comArgs));
+    }
+
+    ComResult Invoke(const std::wstring& methodName, std::vector<_variant_t> args) {
+        IDispatchPtr spDispatch;
+        HRESULT hr = api_->QueryInterface(IID_IDispatch, (void**)&spDispatch);
+        if (FAILED(hr) || spDispatch == NULL) return {false, "", "Failed to get IDispatch"};
+
+        DISPID dispid;
+        LPOLESTR pMethodName = (LPOLESTR)methodName.c_str();
+        hr = spDispatch->GetIDsOfNames(IID_NULL, &pMethodName, 1, LOCALE_USER_DEFAULT, &dispid);
+        if (FAILED(hr)) return {false, "", "Method not found: " + WideToUtf8(methodName)};
+
+        DISPPARAMS params = { NULL, NULL, 0, 0 };
+        std::vector<VARIANT> reversedArgs;
+        int argCount = static_cast<int>(args.size());
+        if (argCount > 0) {
+            params.cArgs = (UINT)argCount;
+            // Аргументи передаються в зворотному порядку для Invoke
+            for (int i = argCount - 1; i >= 0; i--) reversedArgs.push_back(args[i]);
+            params.rgvarg = reversedArgs.data();
+        }
+
+        _variant_t resultVar;
+        // Використовуємо try/catch для захисту від Access Violation всередині DLL
+        try {
+            VIROK_TRACE_SCOPE("com", "Invoke");
+            hr = spDispatch->Invoke(dispid, IID_NULL, LOCALE_USER_DEFAULT, DISPATCH_METHOD, &params, &resultVar, NULL, NULL);
+        } catch (...) {
+            return {false, "", "CRITICAL: Exception inside Cashalot DLL"};
+        }
+
+        if (FAILED(hr)) {
+            char buf[256]; sprintf_s(buf, "Invoke Failed: 0x%08X", hr);
+            return {false, "", std::string(buf)};
+        }
+
+        // Розбір результату (CashalotApiRetVal)
+        if (resultVar.vt == VT_DISPATCH && resultVar.pdispVal != NULL) {
+            IDispatchPtr pResultObj = resultVar.pdispVal;
+
+            auto GetProp = [&](std::wstring p) -> _variant_t {
+                DISPID id; LPOLESTR pn = (LPOLESTR)p.c_str();
+                pResultObj->GetIDsOfNames(IID_NULL, &pn, 1, LOCALE_USER_DEFAULT, &id);
+                _variant_t r; DISPPARAMS n = {NULL, NULL, 0, 0};
+                pResultObj->Invoke(id, IID_NULL, LOCALE_USER_DEFAULT, DISPATCH_PROPERTYGET, &n, &r, NULL, NULL);
+                return r;
+            };
+            return {(bool)GetProp(L"Return"), VariantToUtf8(GetProp(L"JsonVal")), ""};
+        }
+        else if (resultVar.vt == VT_BOOL) {
+            bool s = (bool)resultVar;
+            return {s, s ? "{\"Ret\":true}" : "{\"Ret\":false}", ""};
+        }
+        return {false, "", "Unknown return type from COM"};
+    }
+
+    const std::string fiscalNum_;
+    ICashaLotApiAddinPtr api_;
+};
+
+// Сесії ПРРО за фіскальним номером: кожен ПРРО має свій COM-об'єкт і потік,
+// тож X-звіт на одній касі не чекає фіскалізації чека на іншій.
+std::unique_ptr<virok::FiscalSessionPool> fiscalSessions;
+
+std::unique_ptr<virok::FiscalSessionPool> CreateFiscalSessions() {
+    virok::FiscalSessionOptions options;
+    // Скільки COM-викликів одночасно на всі ПРРО: сервер податкової і
+    // мережа спільні, черга квитків ділить їх між ПРРО порівну.
+    options.max_concurrent = 4;
+    options.on_thread_start = [] { CoInitializeEx(NULL, COINIT_APARTMENTTHREADED); };
+    options.on_thread_exit = [] { CoUninitialize(); };
+    return std::make_unique<virok::FiscalSessionPool>(
+        [](const std::string& fiscalNum) -> std::unique_ptr<virok::FiscalDevice> {
+            virok::FiscalHostOptions hostOptions;
+            // Новий хост не пам'ятає setParameter попереднього.
+            hostOptions.startup_calls = [] {
+                std::vector<std::pair<std::string, virok::FiscalArgs>> calls;
+                std::lock_guard<std::mutex> lock(paramsMutex);
+                for (const auto& param : cashalotParams) {
+                    calls.emplace_back("setParameter",
+                                       virok::FiscalArgs{{"name", param.first}, {"value", param.second}});
+                }
+                return calls;
+            };
+            auto host = std::make_unique<virok::FiscalHostClient>(fiscalNum, std::move(hostOptions));
+            if (host->Start()) return host;
+            // Хост не запустився (політика, антивірус) — COM у процесі каси.
+            return std::make_unique<CashalotDevice>(fiscalNum);
+        },
+        std::move(options));
+}
+
+// Стан ПРРО для діалогів зміни: getCurrentStatus відповідає з кешу, а зміни
+// стану йдуть у Dart подіями com.cashalot/status. Кеш закривається раніше
+// за fiscalSessions, через які оновлюється.
+std::unique_ptr<virok::FiscalStatusCache> statusCache;
+std::unique_ptr<flutter::EventChannel<>> statusChannel;
+std::unique_ptr<flutter::EventSink<>> statusSink;  // лише в потоці платформи
+
+flutter::EncodableMap StatusToMap(const virok::FiscalStatus& status) {
+    flutter::EncodableMap r;
+    r[flutter::EncodableValue("success")] = status.reply.success;
+    r[flutter::EncodableValue("jsonVal")] = status.reply.json_val;
+    if (!status.reply.error.empty()) r[flutter::EncodableValue("error")] = status.reply.error;
+    r[flutter::EncodableValue("updatedAt")] = flutter::EncodableValue(status.updated_ms);
+    if (status.stale) r[flutter::EncodableValue("stale")] = true;
+    return r;
+}
+
+int RunCashalotHost(const std::string& region, const std::string& fiscalNum) {
+    // Потік хоста вже в STA (wWinMain), пристрій живе в ньому.
+    return virok::RunFiscalHost(region, fiscalNum, [](const std::string& num) {
+        return std::make_unique<CashalotDevice>(num);
+    });
+}
+
+// Аргументи каналу -> FiscalArgs. Суми з Dart бувають double (serviceInput)
+// або вже рядком "15,65" (payByPaymentCard).
+virok::FiscalArgs ToFiscalArgs(const flutter::EncodableMap* args) {
+    virok::FiscalArgs out;
+    if (!args) return out;
+    for (const auto& entry : *args) {
+        const auto* key = std::get_if<std::string>(&entry.first);
+        if (!key) continue;
+        if (const auto* s = std::get_if<std::string>(&entry.second)) {
+            out[*key] = *s;
+        } else if (const auto* d = std::get_if<double>(&entry.second)) {
+            out[*key] = DoubleToCurrencyString(*d);
+        } else if (const auto* b = std::get_if<bool>(&entry.second)) {
+            out[*key] = *b ? "true" : "false";
+        } else if (std::holds_alternative<int32_t>(entry.second) ||
+                   std::holds_alternative<int64_t>(entry.second)) {
+            out[*key] = std::to_string(entry.second.LongValue());
+        }
+    }
+    return out;
+}
+
+// Звіти (X/Z) розбираємо тут же, щоб Dart не парсив великий JSON і не
+// декодував візуалізацію вдруге для друку. jsonVal лишається для сумісності;
+// відповідь з помилкою (Ret=false) візуалізації не має і звіту не отримує.
+void AttachReport(flutter::EncodableMap& r, const virok::FiscalReply& res) {
+    if (!res.success || res.json_val.empty()) return;
+    virok::Report report;
+    if (virok::DecodeReport(res.json_val, &report, nullptr) &&
+        !report.visualization.empty()) {
+        r[flutter::EncodableValue("report")] = ReportToValue(report);
     }
-    return {false, "", "Unknown return type from COM"};
 }
 
 
@@ -155,297 +414,197 @@ bool FlutterWindow::OnCreate() {
   flutter_controller_ = std::make_unique<flutter::FlutterViewController>(
       frame.right - frame.left, frame.bottom - frame.top, project_);
   if (!flutter_controller_->engine() || !flutter_controller_->view()) return false;
+  virok::StartupTimeline::Get().Mark("engine");
 
   flutter::MethodChannel<> channel(
       flutter_controller_->engine()->messenger(), "com.cashalot/api",
       &flutter::StandardMethodCodec::GetInstance());
 
-  channel.SetMethodCallHandler([&](const flutter::MethodCall<>& call, std::unique_ptr<flutter::MethodResult<>> result) {
-        // Захист від падіння всього додатку
-        try {
-            if (!InitCashalot()) { 
-                result->Error("INIT_ERROR", "Init Failed: " + lastComError); 
-                return; 
-            }
-
-            const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
-
-            // 1. setParameter
-            if (call.method_name() == "setParameter") {
-                auto name = std::get<std::string>(args->at(flutter::EncodableValue("name")));
-                auto value = std::get<std::string>(args->at(flutter::EncodableValue("value")));
-                
-                // Використовуємо Utf8ToWide для коректного шляху/значення
-                _variant_t res = gsCashaLotApi->SetParameter(
-                    _bstr_t(Utf8ToWide(name).c_str()), 
-                    _bstr_t(Utf8ToWide(value).c_str())
-                );
-                result->Success(flutter::EncodableValue(BstrToUtf8(_bstr_t(res)))); 
-            } 
-            
-            // 2. getCurrentStatus
-            else if (call.method_name() == "getCurrentStatus") {
-                 auto fNum = std::get<std::string>(args->at(flutter::EncodableValue("fiscalNum")));
-                 // Використовуємо InvokeDispatchMethod для безпеки
-                 ComResult res = InvokeDispatchMethod(L"GetCurrentStatus", { _variant_t(Utf8ToWide(fNum).c_str()) });
-                 
-                 if (!res.error.empty()) { result->Error("COM_ERROR", res.error); return; }
-                 flutter::EncodableMap r;
-                 r[flutter::EncodableValue("success")] = res.success;
-                 r[flutter::EncodableValue("jsonVal")] = res.jsonVal;
-                 result->Success(r);
-            }
-
-            // 3. openShift
-            else if (call.method_name() == "openShift") {
-                 auto fNum = std::get<std::string>(args->at(flutter::EncodableValue("fiscalNum")));
-                 ComResult res = InvokeDispatchMethod(L"OpenShift", { _variant_t(Utf8ToWide(fNum).c_str()) });
-                 
-                 if (!res.error.empty()) { result->Error("COM_ERROR", res.error); return; }
-                 flutter::EncodableMap r;
-                 r[flutter::EncodableValue("success")] = res.success;
-                 r[flutter::EncodableValue("jsonVal")] = res.jsonVal;
-                 result->Success(r);
-            }
-
-            // 4. closeShift
-            else if (call.method_name() == "closeShift") {
-                 auto fNum = std::get<std::string>(args->at(flutter::EncodableValue("fiscalNum")));
-                 if (fNum.empty()) { result->Error("INVALID_ARGS", "FiscalNum is empty"); return; }
-                 
-                 ComResult res = InvokeDispatchMethod(L"CloseShift", { _variant_t(Utf8ToWide(fNum).c_str()) });
-                 
-                 if (!res.error.empty()) { result->Error("COM_ERROR", res.error); return; }
-                 flutter::EncodableMap r;
-                 r[flutter::EncodableValue("success")] = res.success;
-                 r[flutter::EncodableValue("jsonVal")] = res.jsonVal;
-                 result->Success(r);
-            }
-            
-            // 5. printXReport
-            else if (call.method_name() == "printXReport") {
-                 auto fNum = std::get<std::string>(args->at(flutter::EncodableValue("fiscalNum")));
-                 // GetXReport має другий параметр IsShort (bool), передаємо false
-                 ComResult res = InvokeDispatchMethod(L"GetXReport", { 
-                     _variant_t(Utf8ToWide(fNum).c_str()), 
-                     _variant_t(false) 
-                 });
-
-                 if (!res.error.empty()) { result->Error("COM_ERROR", res.error); return; }
-                 flutter::EncodableMap r;
-                 r[flutter::EncodableValue("success")] = res.success;
-                 r[flutter::EncodableValue("jsonVal")] = res.jsonVal;
-                 result->Success(r);
-            }
-
-            // 6. fiscalizeCheck (ВАЖЛИВО: Конвертація JSON з кирилицею)
-            else if (call.method_name() == "fiscalizeCheck") {
-                auto fNum = std::get<std::string>(args->at(flutter::EncodableValue("fiscalNum")));
-                auto goods = std::get<std::string>(args->at(flutter::EncodableValue("jsonGoods")));
-                auto pay = std::get<std::string>(args->at(flutter::EncodableValue("jsonPay")));
-                
-                ComResult res = InvokeDispatchMethod(L"FiscalizeCheck", { 
-                    _variant_t(Utf8ToWide(fNum).c_str()), 
-                    _variant_t(Utf8ToWide(goods).c_str()), 
-                    _variant_t(Utf8ToWide(pay).c_str())
-                });
-                
-                if (!res.error.empty()) { result->Error("COM_ERROR", res.error); return; }
-                flutter::EncodableMap r;
-                r[flutter::EncodableValue("success")] = res.success;
-                r[flutter::EncodableValue("jsonVal")] = res.jsonVal;
-                result->Success(r);
-            }
-
-            // 7. serviceInput
-            else if (call.method_name() == "serviceInput") {
-                 auto fNum = std::get<std::string>(args->at(flutter::EncodableValue("fiscalNum")));
-                 double amount = std::get<double>(args->at(flutter::EncodableValue("amount")));
-                 std::string amountStr = DoubleToCurrencyString(amount);
-                 
-                 // Можна додати касира, якщо є в аргументах, але тут базовий виклик
-                 // Якщо треба касир: додайте _variant_t(Utf8ToWide(cashier).c_str()) другим параметром
-                 ComResult res = InvokeDispatchMethod(L"ServiceInput", { 
-                     _variant_t(Utf8ToWide(fNum).c_str()), 
-                     _variant_t(Utf8ToWide(amountStr).c_str()) 
-                 });
-
-                 if (!res.error.empty()) { result->Error("COM_ERROR", res.error); return; }
-                 flutter::EncodableMap r;
-                 r[flutter::EncodableValue("success")] = res.success;
-                 r[flutter::EncodableValue("jsonVal")] = res.jsonVal;
-                 result->Success(r);
-            }
-
-            // 8. serviceOutput
-            else if (call.method_name() == "serviceOutput") {
-                 auto fNum = std::get<std::string>(args->at(flutter::EncodableValue("fiscalNum")));
-                 double amount = std::get<double>(args->at(flutter::EncodableValue("amount")));
-                 std::string amountStr = DoubleToCurrencyString(amount);
-
-                 ComResult res = InvokeDispatchMethod(L"ServiceOutput", { 
-                     _variant_t(Utf8ToWide(fNum).c_str()), 
-                     _variant_t(Utf8ToWide(amountStr).c_str()) 
-                 });
-
-                 if (!res.error.empty()) { result->Error("COM_ERROR", res.error); return; }
-                 flutter::EncodableMap r;
-                 r[flutter::EncodableValue("success")] = res.success;
-                 r[flutter::EncodableValue("jsonVal")] = res.jsonVal;
-                 result->Success(r);
+  fiscalSessions = CreateFiscalSessions();
+  statusCache = std::make_unique<virok::FiscalStatusCache>(
+      [](const std::string& fiscalNum, virok::FiscalCallback done) {
+          fiscalSessions->Submit(fiscalNum, "getCurrentStatus", {{"fiscalNum", fiscalNum}},
+                                 std::move(done));
+      },
+      [this](const std::string& fiscalNum, const virok::FiscalStatus& status) {
+          flutter::EncodableMap event = StatusToMap(status);
+          event[flutter::EncodableValue("fiscalNum")] = fiscalNum;
+          flutter::EncodableValue value(std::move(event));
+          PostTask([value] {
+              if (statusSink) statusSink->Success(value);
+          });
+      });
+  statusChannel = std::make_unique<flutter::EventChannel<>>(
+      flutter_controller_->engine()->messenger(), "com.cashalot/status",
+      &flutter::StandardMethodCodec::GetInstance());
+  statusChannel->SetStreamHandler(std::make_unique<flutter::StreamHandlerFunctions<>>(
+      [](const flutter::EncodableValue*, std::unique_ptr<flutter::EventSink<>>&& events)
+          -> std::unique_ptr<flutter::StreamHandlerError<>> {
+          statusSink = std::move(events);
+          return nullptr;
+      },
+      [](const flutter::EncodableValue*) -> std::unique_ptr<flutter::StreamHandlerError<>> {
+          statusSink.reset();
+          return nullptr;
+      }));
+
+  channel.SetMethodCallHandler([this](const flutter::MethodCall<>& call, std::unique_ptr<flutter::MethodResult<>> result) {
+        const std::string& method = call.method_name();
+        virok::FiscalArgs args = ToFiscalArgs(std::get_if<flutter::EncodableMap>(call.arguments()));
+
+        // 1. setParameter — для всіх ПРРО: нові сесії отримають його при
+        // створенні об'єкта, відкриті — у своїй черзі після поточних викликів.
+        if (method == "setParameter") {
+            if (!args.count("name") || !args.count("value")) {
+                result->Error("INVALID_ARGS", "Expected name and value");
+                return;
             }
-
-            // --- payByPaymentCard (Оплата карткою) ---
-            else if (call.method_name() == "payByPaymentCard") {
-                 auto fiscal_it = args->find(flutter::EncodableValue("fiscalNum"));
-                 auto amount_it = args->find(flutter::EncodableValue("amount"));
-
-                 if (fiscal_it != args->end() && amount_it != args->end()) {
-                     std::string fiscalNum = std::get<std::string>(fiscal_it->second);
-                     std::string amountStr = std::get<std::string>(amount_it->second);
-
-                     // PayByPaymentCard(FiscalNum, Amount, OtherParams)
-                     ComResult res = InvokeDispatchMethod(L"PayByPaymentCard", { 
-                         _variant_t(Utf8ToWide(fiscalNum).c_str()), 
-                         _variant_t(Utf8ToWide(amountStr).c_str()),
-                         _variant_t(L"") 
-                     });
-
-                     if (!res.error.empty()) { result->Error("COM_ERROR", res.error); return; }
-                     flutter::EncodableMap response;
-                     response[flutter::EncodableValue("success")] = res.success;
-                     response[flutter::EncodableValue("jsonVal")] = res.jsonVal;
-                     result->Success(response);
-                 } else { result->Error("INVALID_ARGS", "Expected fiscalNum and amount"); }
+            {
+                std::lock_guard<std::mutex> lock(paramsMutex);
+                auto it = std::find_if(cashalotParams.begin(), cashalotParams.end(),
+                                       [&](const auto& p) { return p.first == args["name"]; });
+                if (it != cashalotParams.end()) it->second = args["value"];
+                else cashalotParams.emplace_back(args["name"], args["value"]);
             }
-            
-            // --- getPOSTerminalList (Список терміналів) ---
-            else if (call.method_name() == "getPOSTerminalList") {
-                 auto fiscal_it = args->find(flutter::EncodableValue("fiscalNum"));
-
-                 if (fiscal_it != args->end()) {
-                     std::string fiscalNum = std::get<std::string>(fiscal_it->second);
-
-                     // Використовуємо InvokeDispatchMethod для безпеки
-                     ComResult res = InvokeDispatchMethod(L"GetPOSTerminalList", { 
-                         _variant_t(Utf8ToWide(fiscalNum).c_str()) 
-                     });
-
-                     if (!res.error.empty()) { result->Error("COM_ERROR", res.error); return; }
-                     flutter::EncodableMap response;
-                     response[flutter::EncodableValue("success")] = res.success;
-                     response[flutter::EncodableValue("jsonVal")] = res.jsonVal;
-                     result->Success(response);
-                 } else { result->Error("INVALID_ARGS", "Expected fiscalNum"); }
+            for (const std::string& fiscalNum : fiscalSessions->Sessions()) {
+                fiscalSessions->Submit(fiscalNum, method, args, [](virok::FiscalReply) {});
             }
-
-            // --- returnPaymentByCard (Повернення на терміналі) ---
-            else if (call.method_name() == "returnPaymentByCard") {
-                 auto fiscal_it = args->find(flutter::EncodableValue("fiscalNum"));
-                 auto amount_it = args->find(flutter::EncodableValue("amount"));
-                 auto rrn_it = args->find(flutter::EncodableValue("rrn"));
-
-                 if (fiscal_it != args->end() && amount_it != args->end() && rrn_it != args->end()) {
-                     std::string fiscalNum = std::get<std::string>(fiscal_it->second);
-                     std::string amountStr = std::get<std::string>(amount_it->second);
-                     std::string rrnStr = std::get<std::string>(rrn_it->second);
-
-                     ComResult res = InvokeDispatchMethod(L"ReturnPaymentByPaymentCard", { 
-                         _variant_t(Utf8ToWide(fiscalNum).c_str()), 
-                         _variant_t(Utf8ToWide(amountStr).c_str()),
-                         _variant_t(Utf8ToWide(rrnStr).c_str()),
-                         _variant_t(L"") 
-                     });
-
-                     if (!res.error.empty()) { result->Error("COM_ERROR", res.error); return; }
-                     flutter::EncodableMap response;
-                     response[flutter::EncodableValue("success")] = res.success;
-                     response[flutter::EncodableValue("jsonVal")] = res.jsonVal;
-                     result->Success(response);
-                 } else { result->Error("INVALID_ARGS", "Expected fiscalNum, amount, rrn"); }
+            result->Success();
+            return;
+        }
+
+        // 2. Методи ПРРО: черга сесії свого фіскального номера.
+        // getVersion не прив'язаний до ПРРО і йде в сесію без номера.
+        const CashalotMethod* m = FindCashalotMethod(method);
+        std::string fiscalNum;
+        if (m) {
+            std::string expected;
+            bool missing = false;
+            for (const char* key : m->args) {
+                expected += expected.empty() ? key : std::string(", ") + key;
+                missing = missing || !args.count(key);
             }
-
-            // --- cancelPaymentByCard (Скасування транзакції) ---
-            else if (call.method_name() == "cancelPaymentByCard") {
-                 auto fiscal_it = args->find(flutter::EncodableValue("fiscalNum"));
-                 auto amount_it = args->find(flutter::EncodableValue("amount"));
-                 auto invoice_it = args->find(flutter::EncodableValue("invoiceNum"));
-
-                 if (fiscal_it != args->end() && amount_it != args->end() && invoice_it != args->end()) {
-                     std::string fiscalNum = std::get<std::string>(fiscal_it->second);
-                     std::string amountStr = std::get<std::string>(amount_it->second);
-                     std::string invoiceStr = std::get<std::string>(invoice_it->second);
-
-                     ComResult res = InvokeDispatchMethod(L"CancelPaymentByPaymentCard", { 
-                         _variant_t(Utf8ToWide(fiscalNum).c_str()), 
-                         _variant_t(Utf8ToWide(amountStr).c_str()),
-                         _variant_t(Utf8ToWide(invoiceStr).c_str()),
-                         _variant_t(L"") 
-                     });
-
-                     if (!res.error.empty()) { result->Error("COM_ERROR", res.error); return; }
-                     flutter::EncodableMap response;
-                     response[flutter::EncodableValue("success")] = res.success;
-                     response[flutter::EncodableValue("jsonVal")] = res.jsonVal;
-                     result->Success(response);
-                 } else { result->Error("INVALID_ARGS", "Expected fiscalNum, amount, invoiceNum"); }
-            }
-
-            // --- fiscalizeReturnCheck (Фіскалізація повернення) ---
-            else if (call.method_name() == "fiscalizeReturnCheck") {
-                auto fiscal_it = args->find(flutter::EncodableValue("fiscalNum"));
-                auto goods_it = args->find(flutter::EncodableValue("jsonGoods"));
-                auto pay_it = args->find(flutter::EncodableValue("jsonPay"));
-                auto return_receipt_it = args->find(flutter::EncodableValue("returnReceiptFiscalNum"));
-
-                if (fiscal_it != args->end()) {
-                    std::string fiscalNum = std::get<std::string>(fiscal_it->second);
-                    std::string goods = std::get<std::string>(goods_it->second);
-                    std::string pay = std::get<std::string>(pay_it->second);
-                    std::string returnReceiptNum = std::get<std::string>(return_receipt_it->second);
-
-                    ComResult res = InvokeDispatchMethod(L"FiscalizeReturnCheck", { 
-                        _variant_t(Utf8ToWide(fiscalNum).c_str()),
-                        _variant_t(Utf8ToWide(goods).c_str()),
-                        _variant_t(Utf8ToWide(pay).c_str()),
-                        _variant_t(Utf8ToWide(returnReceiptNum).c_str())
+            if (missing) { result->Error("INVALID_ARGS", "Expected " + expected); return; }
+            fiscalNum = args["fiscalNum"];
+            if (fiscalNum.empty()) { result->Error("INVALID_ARGS", "FiscalNum is empty"); return; }
+        } else if (method != "getVersion") {
+            result->NotImplemented();
+            return;
+        }
+
+        // Стан ПРРО з кешу, якщо після нього нічого не змінювало зміну.
+        virok::FiscalStatus cached;
+        if (method == "getCurrentStatus" && statusCache->Get(fiscalNum, &cached)) {
+            flutter::EncodableMap r = StatusToMap(cached);
+            r[flutter::EncodableValue("cached")] = true;
+            result->Success(flutter::EncodableValue(std::move(r)));
+            return;
+        }
+
+        // Затримка кожного методу разом з очікуванням у черзі (p50/p99 у файлі метрик)
+        virok::Histogram* latency = virok::MetricsRegistry::Get().GetHistogram(
+            "virok_fiscal_call_microseconds", "Duration of com.cashalot/api calls",
+            virok::MetricLabel("method", method));
+        const int64_t startNs = virok::Tracer::NowNs();
+        const bool report = m && m->report;
+        const bool plainValue = m == nullptr;  // getVersion повертає рядок
+        std::shared_ptr<flutter::MethodResult<>> reply(std::move(result));
+
+        // Відповідь збирається в потоці сесії (там же розбирається звіт),
+        // а віддається в Dart у потоці платформи.
+        fiscalSessions->Submit(fiscalNum, method, std::move(args),
+            [this, reply, latency, startNs, report, plainValue, method, fiscalNum](virok::FiscalReply res) {
+                latency->Record((virok::Tracer::NowNs() - startNs) / 1000);
+                if (!fiscalNum.empty()) {
+                    if (method == "getCurrentStatus") statusCache->Store(fiscalNum, res);
+                    else statusCache->Observe(fiscalNum, method);
+                }
+                if (!res.error.empty()) {
+                    const bool initFailed = res.error.rfind("Init Failed", 0) == 0;
+                    std::string error = std::move(res.error);
+                    PostTask([reply, initFailed, error] {
+                        reply->Error(initFailed ? "INIT_ERROR" : "COM_ERROR", error);
                     });
-
-                    if (!res.error.empty()) { result->Error("COM_ERROR", res.error); return; }
-                    flutter::EncodableMap response;
-                    response[flutter::EncodableValue("success")] = res.success;
-                    response[flutter::EncodableValue("jsonVal")] = res.jsonVal;
-                    result->Success(response);
-                } else { result->Error("INVALID_ARGS", "Args missing"); }
-            }
-
-            else if (call.method_name() == "getVersion") {
-                _variant_t varVer = gsCashaLotApi->GetVersion();
-                result->Success(flutter::EncodableValue(BstrToUtf8(_bstr_t(varVer))));
-            }
-            else { result->NotImplemented(); }
-
-        } catch (_com_error& e) {
-             char buf[1024]; sprintf_s(buf, "HRESULT: 0x%08X", e.Error());
-             result->Error("COM_ERROR", buf);
-        } catch (...) { result->Error("UNKNOWN_ERROR", "Crash inside C++ handler"); }
+                    return;
+                }
+                flutter::EncodableValue value;
+                if (plainValue) {
+                    value = flutter::EncodableValue(std::move(res.json_val));
+                } else {
+                    flutter::EncodableMap r;
+                    r[flutter::EncodableValue("success")] = res.success;
+                    if (report) AttachReport(r, res);
+                    r[flutter::EncodableValue("jsonVal")] = std::move(res.json_val);
+                    value = flutter::EncodableValue(std::move(r));
+                }
+                PostTask([reply, value] { reply->Success(value); });
+            });
   });
 
+  // Інкрементальний пошук по каталогу (native/search)
+  RegisterSearchChannel(flutter_controller_->engine()->messenger());
+  // Розбір X/Z-звітів (native/report)
+  RegisterReportChannel(flutter_controller_->engine()->messenger());
+  // Трасування нативних операцій і сторож зависань циклу повідомлень
+  // (native/trace, native/watchdog)
+  RegisterTraceChannel(flutter_controller_->engine()->messenger(),
+                       [this](std::function<void()> task) {
+                         PostTask(std::move(task));
+                       });
+  // Метрики каси у файлі Prometheus (native/metrics)
+  RegisterMetricsChannel(flutter_controller_->engine()->messenger());
+  // Хронологія запуску і результати прогріву (native/startup)
+  RegisterStartupChannel(flutter_controller_->engine()->messenger());
+  // Акції та знижки чека (native/promo)
+  RegisterPromoChannel(flutter_controller_->engine()->messenger());
+  // Локальний архів чеків для повернень і повторного друку (native/archive)
+  RegisterArchiveChannel(flutter_controller_->engine()->messenger());
+  // Відкладені кошики, що переживають перезапуск (native/parking)
+  RegisterParkedChannel(flutter_controller_->engine()->messenger());
+  // Торгові ваги: встановлена маса подіями (native/scale)
+  RegisterScaleChannel(flutter_controller_->engine()->messenger(),
+                       [this](std::function<void()> task) {
+                         PostTask(std::move(task));
+                       });
+  // Банківський термінал: стани оплати подіями, сліп одразу (native/terminal)
+  RegisterTerminalChannel(flutter_controller_->engine()->messenger(),
+                          [this](std::function<void()> task) {
+                            PostTask(std::move(task));
+                          });
+  // Обслуговування у простої каси (native/maintenance)
+  RegisterMaintenanceChannel(flutter_controller_->engine()->messenger(),
+                             [this](std::function<void()> task) {
+                               PostTask(std::move(task));
+                             });
+  // Сканер штрихкодів: код однією подією замість клавіш (native/scanner)
+  RegisterScannerChannel(flutter_controller_->engine()->messenger(),
+                         GetHandle());
+
   RegisterPlugins(flutter_controller_->engine());
   SetChildContent(flutter_controller_->view()->GetNativeWindow());
-  flutter_controller_->engine()->SetNextFrameCallback([&]() { this->Show(); });
+  flutter_controller_->engine()->SetNextFrameCallback([&]() {
+    virok::StartupTimeline::Get().Mark("firstFrame");
+    this->Show();
+  });
   flutter_controller_->ForceRedraw();
   return true;
 }
 
 
 void FlutterWindow::OnDestroy() {
-  // Звільняємо ресурси при закритті вікна
-  std::lock_guard<std::mutex> lock(apiMutex);
-  if (gsCashaLotApi != NULL) {
-      gsCashaLotApi.Release();
-      gsCashaLotApi = NULL;
-  }
+  // Звільняємо ресурси при закритті вікна: сесії дочікуються поточних
+  // викликів COM і скасовують решту черги, а відповіді на них віддаємо,
+  // поки двигун ще живий.
+  statusCache.reset();
+  fiscalSessions.reset();
+  ShutdownScaleChannel();
+  ShutdownTerminalChannel();
+  ShutdownMaintenanceChannel();
+  ShutdownScannerChannel();
+  ShutdownTraceChannel();
+  RunTasks();
+  statusSink.reset();
+  statusChannel.reset();
   CoUninitialize();
 
   if (flutter_controller_) {
@@ -455,10 +614,46 @@ void FlutterWindow::OnDestroy() {
   Win32Window::OnDestroy();
 }
 
+bool FlutterWindow::PreTranslateMessage(const MSG& msg) {
+  if (!flutter_controller_) return false;
+  // Скан теж введення: до фільтра, який його поглинає.
+  NotifyMaintenanceInput(msg);
+  return FilterScannerMessage(msg);
+}
+
+void FlutterWindow::PostTask(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(tasks_mutex_);
+    tasks_.push_back(std::move(task));
+  }
+  PostMessage(GetHandle(), kRunTasksMessage, 0, 0);
+}
+
+void FlutterWindow::RunTasks() {
+  std::vector<std::function<void()>> tasks;
+  {
+    std::lock_guard<std::mutex> lock(tasks_mutex_);
+    tasks.swap(tasks_);
+  }
+  for (auto& task : tasks) task();
+}
+
 LRESULT
 FlutterWindow::MessageHandler(HWND hwnd, UINT const message,
                               WPARAM const wparam,
                               LPARAM const lparam) noexcept {
+  if (message == kRunTasksMessage) {
+    RunTasks();
+    return 0;
+  }
+  if (message == WM_TIMER && wparam == kScannerTimerId) {
+    OnScannerTimer();
+    return 0;
+  }
+  if (message == WM_ACTIVATE && LOWORD(wparam) == WA_INACTIVE) {
+    FlushScannerKeys();
+  }
+
   if (flutter_controller_) {
     std::optional<LRESULT> result =
         flutter_controller_->HandleTopLevelWindowProc(hwnd, message, wparam,
@@ -4,10 +4,22 @@
 #include <flutter/dart_project.h>
 #include <flutter/flutter_view_controller.h>
 
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
 #include "win32_window.h"
 
+// Завантажує COM-сервер Cashalot без створення об'єкта (прогрів запуску,
+// див. startup_channel.cpp). False і текст HRESULT у |error| при помилці.
+bool PrewarmCashalotServer(std::string* error);
+
+// Тіло процесу-хоста ПРРО (exe з --fiscal-host, див. fiscal/fiscal_host.h):
+// COM-об'єкт Cashalot для |fiscalNum| живе тут, а не в процесі каси.
+int RunCashalotHost(const std::string& region, const std::string& fiscalNum);
+
 // A window that does nothing but host a Flutter view.
 class FlutterWindow : public Win32Window {
  public:
@@ -15,6 +27,10 @@ class FlutterWindow : public Win32Window {
   explicit FlutterWindow(const flutter::DartProject& project);
   virtual ~FlutterWindow();
 
+  // Викликається з циклу повідомлень до TranslateMessage. True —
+  // повідомлення забрав фільтр сканера штрихкодів (див. scanner_channel.h).
+  bool PreTranslateMessage(const MSG& msg);
+
  protected:
   // Win32Window:
   bool OnCreate() override;
@@ -23,6 +39,17 @@ class FlutterWindow : public Win32Window {
                          LPARAM const lparam) noexcept override;
 
  private:
+  // Повідомлення, за яким потік платформи виконує відкладені задачі.
+  static constexpr UINT kRunTasksMessage = WM_APP + 1;
+
+  // Виконує |task| у потоці платформи: відповіді каналів приходять з
+  // потоків сесій ПРРО, а MethodResult можна викликати лише звідси.
+  void PostTask(std::function<void()> task);
+  void RunTasks();
+
+  std::mutex tasks_mutex_;
+  std::vector<std::function<void()>> tasks_;
+
   // The project to run.
   flutter::DartProject project_;
 
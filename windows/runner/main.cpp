@@ -2,7 +2,9 @@
 #include <flutter/flutter_view_controller.h>
 #include <windows.h>
 
+#include "fiscal/fiscal_host.h"
 #include "flutter_window.h"
+#include "startup_channel.h"
 #include "utils.h"
 
 int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
@@ -17,12 +19,25 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
   // plugins.
   ::CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
 
-  flutter::DartProject project(L"data");
-  // Win32Window::CreateAndShow(L"Virok Каса", origin, size);
-
   std::vector<std::string> command_line_arguments =
       GetCommandLineArguments();
 
+  // Той самий exe працює процесом-хостом ПРРО: без вікна і двигуна.
+  if (command_line_arguments.size() >= 3 &&
+      command_line_arguments[0] == virok::kFiscalHostFlag) {
+    const int code = RunCashalotHost(command_line_arguments[1],
+                                     command_line_arguments[2]);
+    ::CoUninitialize();
+    return code;
+  }
+
+  // Каталог, налаштування і COM-сервер готуються паралельно зі стартом
+  // двигуна Flutter.
+  StartPrewarm();
+
+  flutter::DartProject project(L"data");
+  // Win32Window::CreateAndShow(L"Virok Каса", origin, size);
+
   project.set_dart_entrypoint_arguments(std::move(command_line_arguments));
 
   FlutterWindow window(project);
@@ -35,6 +50,7 @@ int APIENTRY wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE prev,
 
   ::MSG msg;
   while (::GetMessage(&msg, nullptr, 0, 0)) {
+    if (window.PreTranslateMessage(msg)) continue;
     ::TranslateMessage(&msg);
     ::DispatchMessage(&msg);
   }
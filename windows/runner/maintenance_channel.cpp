@@ -0,0 +1,266 @@
+#include "maintenance_channel.h"
+
+#include <flutter/encodable_value.h>
+#include <flutter/event_channel.h>
+#include <flutter/event_stream_handler_functions.h>
+#include <flutter/method_channel.h>
+#include <flutter/standard_method_codec.h>
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "archive_channel.h"
+#include "channel_args.h"
+#include "maintenance/idle_scheduler.h"
+#include "trace/trace.h"
+
+namespace {
+
+using flutter::EncodableList;
+using flutter::EncodableMap;
+using flutter::EncodableValue;
+using Clock = virok::IdleScheduler::Clock;
+
+// Єдина задача, що виконується в runner; решту назв виконує Dart.
+constexpr char kArchiveJob[] = "archiveCompact";
+
+// Задача Dart: крок лише надсилає "run" і чекає на finished.
+struct DartJob {
+  enum State { kIdle, kRunning, kFinished, kAborted, kFailed };
+
+  std::string name;
+  std::atomic<int> state{kIdle};
+};
+
+std::unique_ptr<flutter::MethodChannel<>> maintenance_channel;
+std::unique_ptr<flutter::EventChannel<>> maintenance_events;
+std::unique_ptr<flutter::EventSink<>> maintenance_sink;  // потік платформи
+std::function<void(std::function<void()>)> post_to_platform;
+std::unique_ptr<virok::IdleScheduler> scheduler;
+// Зареєстровані задачі (лише в потоці платформи); Dart-задачі спільні з
+// кроками планувальника.
+std::map<std::string, std::shared_ptr<DartJob>> dart_jobs;
+bool has_archive_job = false;
+
+void SendEvent(const std::string& job, const char* action) {
+  EncodableMap map;
+  map[EncodableValue("job")] = EncodableValue(job);
+  map[EncodableValue("action")] = EncodableValue(action);
+  EncodableValue value(std::move(map));
+  post_to_platform([value] {
+    if (maintenance_sink) maintenance_sink->Success(value);
+  });
+}
+
+virok::MaintenanceJob MakeDartJob(std::shared_ptr<DartJob> dart,
+                                  std::chrono::milliseconds interval) {
+  virok::MaintenanceJob job;
+  job.name = dart->name;
+  job.interval = interval;
+  job.step = [dart](const virok::MaintenanceYield&) {
+    switch (dart->state.load()) {
+      case DartJob::kIdle:
+        dart->state = DartJob::kRunning;
+        SendEvent(dart->name, "run");
+        return virok::MaintenanceStep::kWait;
+      case DartJob::kRunning:
+        return virok::MaintenanceStep::kWait;
+      case DartJob::kFinished:
+        dart->state = DartJob::kIdle;
+        return virok::MaintenanceStep::kDone;
+      case DartJob::kFailed:
+        dart->state = DartJob::kIdle;
+        return virok::MaintenanceStep::kFailed;
+      default:
+        // Перервана: у наступному вікні простою — знову "run".
+        dart->state = DartJob::kIdle;
+        return virok::MaintenanceStep::kMore;
+    }
+  };
+  job.preempt = [dart] {
+    if (dart->state.load() == DartJob::kRunning) {
+      SendEvent(dart->name, "preempt");
+    }
+  };
+  return job;
+}
+
+virok::MaintenanceJob MakeArchiveJob(std::chrono::milliseconds interval) {
+  virok::MaintenanceJob job;
+  job.name = kArchiveJob;
+  job.interval = interval;
+  job.step = [](const virok::MaintenanceYield&) {
+    return CompactArchiveStep();
+  };
+  return job;
+}
+
+// Перезапуск Dart (hot restart, нова підписка) обриває задачі, що
+// виконувалися: finished для них уже не прийде.
+void AbortRunningDartJobs() {
+  for (auto& [name, dart] : dart_jobs) {
+    int running = DartJob::kRunning;
+    dart->state.compare_exchange_strong(running, DartJob::kAborted);
+  }
+  if (scheduler) scheduler->Wake();
+}
+
+EncodableValue StatusToValue(const virok::IdleSchedulerStatus& status) {
+  EncodableList jobs;
+  for (const virok::MaintenanceJobStatus& job : status.jobs) {
+    EncodableMap map;
+    map[EncodableValue("name")] = EncodableValue(job.name);
+    map[EncodableValue("runs")] =
+        EncodableValue(static_cast<int64_t>(job.runs));
+    map[EncodableValue("failures")] =
+        EncodableValue(static_cast<int64_t>(job.failures));
+    map[EncodableValue("dueInMs")] = EncodableValue(job.due_in_ms);
+    jobs.push_back(EncodableValue(std::move(map)));
+  }
+  EncodableMap map;
+  map[EncodableValue("running")] = EncodableValue(scheduler->running());
+  map[EncodableValue("idle")] = EncodableValue(status.idle);
+  map[EncodableValue("cartOpen")] = EncodableValue(status.cart_open);
+  map[EncodableValue("active")] = EncodableValue(status.active);
+  map[EncodableValue("slices")] =
+      EncodableValue(static_cast<int64_t>(status.slices));
+  map[EncodableValue("preemptions")] =
+      EncodableValue(static_cast<int64_t>(status.preemptions));
+  map[EncodableValue("jobs")] = EncodableValue(std::move(jobs));
+  return EncodableValue(std::move(map));
+}
+
+void HandleMaintenanceCall(const flutter::MethodCall<>& call,
+                           std::unique_ptr<flutter::MethodResult<>> result) {
+  const auto* args = std::get_if<EncodableMap>(call.arguments());
+  const std::string& method = call.method_name();
+  virok::TraceScope trace_scope("maintenance", method);
+
+  if (method == "configure") {
+    // jobs: {назва: інтервал у мс}. Задачі додаються лише раз; повторний
+    // configure змінює тільки пороги простою.
+    virok::IdleSchedulerOptions options;
+    options.idle_after = std::chrono::milliseconds(
+        IntArg(args, "idleAfterMs", options.idle_after.count()));
+    options.retry_after = std::chrono::milliseconds(
+        IntArg(args, "retryAfterMs", options.retry_after.count()));
+    scheduler->set_options(options);
+    const EncodableValue* jobs = FindArg(args, "jobs");
+    const auto* map = jobs ? std::get_if<EncodableMap>(jobs) : nullptr;
+    if (map) {
+      const Clock::time_point now = Clock::now();
+      for (const auto& [key, value] : *map) {
+        const auto* name = std::get_if<std::string>(&key);
+        const bool has_interval = std::holds_alternative<int32_t>(value) ||
+                                  std::holds_alternative<int64_t>(value);
+        if (!name || name->empty() || !has_interval ||
+            dart_jobs.count(*name) ||
+            (*name == kArchiveJob && has_archive_job)) {
+          continue;
+        }
+        const std::chrono::milliseconds interval(value.LongValue());
+        if (*name == kArchiveJob) {
+          has_archive_job = true;
+          scheduler->AddJob(MakeArchiveJob(interval), now);
+          continue;
+        }
+        auto dart = std::make_shared<DartJob>();
+        dart->name = *name;
+        dart_jobs[*name] = dart;
+        scheduler->AddJob(MakeDartJob(dart, interval), now);
+      }
+    }
+    if (BoolArg(args, "enabled", true)) {
+      if (!scheduler->running()) scheduler->Start();
+    } else {
+      scheduler->Stop();
+    }
+    result->Success();
+  } else if (method == "setCartOpen") {
+    scheduler->SetCartOpen(BoolArg(args, "open"));
+    result->Success();
+  } else if (method == "finished") {
+    auto it = dart_jobs.find(StringArg(args, "job"));
+    if (it == dart_jobs.end()) {
+      result->Error("UNKNOWN_JOB", "Unknown maintenance job");
+      return;
+    }
+    // "done", "aborted" (preempt) або "failed".
+    const std::string outcome = StringArg(args, "result", "done");
+    int running = DartJob::kRunning;
+    it->second->state.compare_exchange_strong(
+        running, outcome == "done"      ? DartJob::kFinished
+                 : outcome == "aborted" ? DartJob::kAborted
+                                        : DartJob::kFailed);
+    scheduler->Wake();
+    result->Success();
+  } else if (method == "status") {
+    result->Success(StatusToValue(scheduler->status(Clock::now())));
+  } else {
+    result->NotImplemented();
+  }
+}
+
+}  // namespace
+
+void RegisterMaintenanceChannel(
+    flutter::BinaryMessenger* messenger,
+    std::function<void(std::function<void()>)> post_task) {
+  post_to_platform = std::move(post_task);
+  // Планувальник стежить за введенням з самого запуску, а потік
+  // запускає configure з Dart.
+  scheduler = std::make_unique<virok::IdleScheduler>();
+  maintenance_channel = std::make_unique<flutter::MethodChannel<>>(
+      messenger, "com.virok/maintenance",
+      &flutter::StandardMethodCodec::GetInstance());
+  maintenance_channel->SetMethodCallHandler(HandleMaintenanceCall);
+  maintenance_events = std::make_unique<flutter::EventChannel<>>(
+      messenger, "com.virok/maintenance/events",
+      &flutter::StandardMethodCodec::GetInstance());
+  maintenance_events->SetStreamHandler(
+      std::make_unique<flutter::StreamHandlerFunctions<>>(
+          [](const EncodableValue*,
+             std::unique_ptr<flutter::EventSink<>>&& events)
+              -> std::unique_ptr<flutter::StreamHandlerError<>> {
+            maintenance_sink = std::move(events);
+            AbortRunningDartJobs();
+            return nullptr;
+          },
+          [](const EncodableValue*)
+              -> std::unique_ptr<flutter::StreamHandlerError<>> {
+            maintenance_sink.reset();
+            AbortRunningDartJobs();
+            return nullptr;
+          }));
+}
+
+void NotifyMaintenanceInput(const MSG& msg) {
+  if (!scheduler) return;
+  switch (msg.message) {
+    case WM_KEYDOWN:
+    case WM_SYSKEYDOWN:
+    case WM_LBUTTONDOWN:
+    case WM_RBUTTONDOWN:
+    case WM_MBUTTONDOWN:
+    case WM_MOUSEWHEEL:
+    case WM_POINTERDOWN:
+    case WM_TOUCH:
+      scheduler->OnInput(Clock::now());
+      break;
+    default:
+      break;
+  }
+}
+
+void ShutdownMaintenanceChannel() {
+  if (scheduler) scheduler->Stop();
+  scheduler.reset();
+  dart_jobs.clear();
+  maintenance_sink.reset();
+  maintenance_events.reset();
+  maintenance_channel.reset();
+}
@@ -0,0 +1,30 @@
+#ifndef RUNNER_MAINTENANCE_CHANNEL_H_
+#define RUNNER_MAINTENANCE_CHANNEL_H_
+
+#include <flutter/binary_messenger.h>
+#include <windows.h>
+
+#include <functional>
+
+// Реєструє канал com.virok/maintenance (configure, setCartOpen, finished,
+// status) і потік подій com.virok/maintenance/events: фонове
+// обслуговування у простої каси (див. native/maintenance).
+//
+// Ущільнення архіву чеків виконується тут же, кроками по сегменту. Задачі
+// Dart (дельта-синхронізація, індекс пошуку, обслуговування бази)
+// отримують подію {job, action: "run"} і звітують finished; {job, action:
+// "preempt"} — каса ожила, задачу слід перервати на найближчій межі.
+// Події з потоку планувальника передаються в потік платформи через
+// |post_task|. Викликати один раз після створення движка.
+void RegisterMaintenanceChannel(
+    flutter::BinaryMessenger* messenger,
+    std::function<void(std::function<void()>)> post_task);
+
+// Введення від касира (клавіша, клік, дотик) до фільтра сканера: кожне
+// відкладає обслуговування і витісняє задачу, що виконується.
+void NotifyMaintenanceInput(const MSG& msg);
+
+// Зупиняє планувальник до того, як движок буде знищено.
+void ShutdownMaintenanceChannel();
+
+#endif  // RUNNER_MAINTENANCE_CHANNEL_H_
@@ -0,0 +1,88 @@
+#include "metrics_channel.h"
+
+#include <flutter/method_channel.h>
+#include <flutter/standard_method_codec.h>
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "channel_args.h"
+#include "metrics/metrics.h"
+#include "metrics/metrics_exporter.h"
+
+namespace {
+
+std::unique_ptr<flutter::MethodChannel<>> metrics_channel;
+virok::MetricsFileExporter metrics_exporter;
+
+// Мапа міток з Dart ({'payment': 'card'}) у текст міток Prometheus.
+// std::map дає стабільний порядок, тож однакові мітки — одна серія.
+std::string LabelsArg(const flutter::EncodableMap* args) {
+  const flutter::EncodableValue* v = FindArg(args, "labels");
+  const auto* map = v ? std::get_if<flutter::EncodableMap>(v) : nullptr;
+  if (!map) return std::string();
+
+  std::map<std::string, std::string> sorted;
+  for (const auto& [key, value] : *map) {
+    const auto* k = std::get_if<std::string>(&key);
+    const auto* s = std::get_if<std::string>(&value);
+    if (k && s) sorted[*k] = *s;
+  }
+  std::string labels;
+  for (const auto& [key, value] : sorted) {
+    if (!labels.empty()) labels.push_back(',');
+    labels.append(virok::MetricLabel(key, value));
+  }
+  return labels;
+}
+
+void HandleMetricsCall(const flutter::MethodCall<>& call,
+                       std::unique_ptr<flutter::MethodResult<>> result) {
+  const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+  const std::string& method = call.method_name();
+  virok::MetricsRegistry& registry = virok::MetricsRegistry::Get();
+
+  if (method == "start") {
+    const std::string lane = StringArg(args, "lane");
+    registry.SetConstLabels(lane.empty() ? std::string()
+                                         : virok::MetricLabel("lane", lane));
+    const auto interval =
+        std::chrono::milliseconds(IntArg(args, "intervalMs", 15000));
+    result->Success(flutter::EncodableValue(
+        metrics_exporter.Start(StringArg(args, "path"), interval)));
+  } else if (method == "stop") {
+    metrics_exporter.Stop();
+    result->Success();
+  } else if (method == "observe") {
+    registry
+        .GetHistogram(StringArg(args, "name"), StringArg(args, "help"),
+                      LabelsArg(args))
+        ->Record(IntArg(args, "valueUs"));
+    result->Success();
+  } else if (method == "count") {
+    registry
+        .GetCounter(StringArg(args, "name"), StringArg(args, "help"),
+                    LabelsArg(args))
+        ->Add(static_cast<uint64_t>(IntArg(args, "delta", 1)));
+    result->Success();
+  } else if (method == "gauge") {
+    registry
+        .GetGauge(StringArg(args, "name"), StringArg(args, "help"),
+                  LabelsArg(args))
+        ->Set(IntArg(args, "value"));
+    result->Success();
+  } else {
+    result->NotImplemented();
+  }
+}
+
+}  // namespace
+
+void RegisterMetricsChannel(flutter::BinaryMessenger* messenger) {
+  metrics_channel = std::make_unique<flutter::MethodChannel<>>(
+      messenger, "com.virok/metrics",
+      &flutter::StandardMethodCodec::GetInstance());
+  metrics_channel->SetMethodCallHandler(HandleMetricsCall);
+}
@@ -0,0 +1,11 @@
+#ifndef RUNNER_METRICS_CHANNEL_H_
+#define RUNNER_METRICS_CHANNEL_H_
+
+#include <flutter/binary_messenger.h>
+
+// Реєструє канал com.virok/metrics: запуск експорту знімків у файл
+// Prometheus (start/stop) і метрики, які рахує Dart (observe/count/gauge),
+// у тому ж реєстрі, що й нативні (див. native/metrics).
+void RegisterMetricsChannel(flutter::BinaryMessenger* messenger);
+
+#endif  // RUNNER_METRICS_CHANNEL_H_
@@ -0,0 +1,152 @@
+#include "parked_channel.h"
+
+#include <flutter/encodable_value.h>
+#include <flutter/method_channel.h>
+#include <flutter/standard_method_codec.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "channel_args.h"
+#include "metrics/metrics.h"
+#include "parking/parked_cart.h"
+#include "parking/parked_cart_store.h"
+#include "trace/trace.h"
+
+namespace {
+
+using flutter::EncodableList;
+using flutter::EncodableMap;
+using flutter::EncodableValue;
+
+std::unique_ptr<flutter::MethodChannel<>> parked_channel;
+virok::ParkedCartStore parked_store;
+
+// Кошик у формі, яку чекає Dart (суми — в гривнях, маса — в кг).
+EncodableValue CartToValue(const virok::ParkedCart& cart) {
+  EncodableList lines;
+  for (const virok::ParkedLine& line : cart.lines) {
+    EncodableMap map;
+    map[EncodableValue("guid")] = EncodableValue(line.guid);
+    map[EncodableValue("name")] = EncodableValue(line.name);
+    map[EncodableValue("article")] = EncodableValue(line.article);
+    map[EncodableValue("category")] = EncodableValue(line.category);
+    map[EncodableValue("price")] = EncodableValue(line.price / 100.0);
+    map[EncodableValue("quantity")] = EncodableValue(line.quantity);
+    map[EncodableValue("weight")] = EncodableValue(line.weight_g / 1000.0);
+    map[EncodableValue("discount")] = EncodableValue(line.discount / 100.0);
+    lines.push_back(EncodableValue(std::move(map)));
+  }
+  EncodableMap map;
+  map[EncodableValue("id")] = EncodableValue(static_cast<int64_t>(cart.id));
+  map[EncodableValue("parkedMs")] = EncodableValue(cart.parked_ms);
+  map[EncodableValue("cashier")] = EncodableValue(cart.cashier);
+  map[EncodableValue("paymentForm")] = EncodableValue(cart.payment_form);
+  map[EncodableValue("total")] = EncodableValue(cart.total / 100.0);
+  map[EncodableValue("lines")] = EncodableValue(std::move(lines));
+  return EncodableValue(std::move(map));
+}
+
+EncodableValue SummaryToValue(const virok::ParkedCartSummary& summary) {
+  EncodableMap map;
+  map[EncodableValue("id")] = EncodableValue(static_cast<int64_t>(summary.id));
+  map[EncodableValue("parkedMs")] = EncodableValue(summary.parked_ms);
+  map[EncodableValue("cashier")] = EncodableValue(summary.cashier);
+  map[EncodableValue("paymentForm")] = EncodableValue(summary.payment_form);
+  map[EncodableValue("total")] = EncodableValue(summary.total / 100.0);
+  map[EncodableValue("lines")] =
+      EncodableValue(static_cast<int64_t>(summary.lines));
+  return EncodableValue(std::move(map));
+}
+
+EncodableValue StatsToValue(const virok::ParkedCartStoreStats& stats) {
+  EncodableMap map;
+  map[EncodableValue("carts")] =
+      EncodableValue(static_cast<int64_t>(stats.carts));
+  map[EncodableValue("bytes")] =
+      EncodableValue(static_cast<int64_t>(stats.bytes));
+  map[EncodableValue("deadBytes")] =
+      EncodableValue(static_cast<int64_t>(stats.dead_bytes));
+  return EncodableValue(std::move(map));
+}
+
+void HandleParkedCall(const flutter::MethodCall<>& call,
+                      std::unique_ptr<flutter::MethodResult<>> result) {
+  const auto* args = std::get_if<EncodableMap>(call.arguments());
+  const std::string& method = call.method_name();
+  virok::TraceScope trace_scope("parked", method);
+
+  if (method == "open") {
+    std::string error;
+    if (!parked_store.Open(StringArg(args, "path"), &error)) {
+      result->Error("OPEN_FAILED", error);
+      return;
+    }
+    result->Success(StatsToValue(parked_store.stats()));
+  } else if (method == "park") {
+    static virok::Histogram* const latency =
+        virok::MetricsRegistry::Get().GetHistogram(
+            "virok_parked_park_microseconds",
+            "Parked cart write time (to disk)");
+    virok::LatencyTimer timer(latency);
+    virok::ParkedCart cart;
+    std::string error;
+    if (!virok::ParseParkedCart(StringArg(args, "json"), &cart, &error)) {
+      result->Error("INVALID_CART", error);
+      return;
+    }
+    if (!parked_store.Park(&cart, &error)) {
+      result->Error("WRITE_FAILED", error);
+      return;
+    }
+    result->Success(EncodableValue(static_cast<int64_t>(cart.id)));
+  } else if (method == "list") {
+    EncodableList list;
+    for (const virok::ParkedCartSummary& summary :
+         parked_store.List(StringArg(args, "cashier"))) {
+      list.push_back(SummaryToValue(summary));
+    }
+    result->Success(EncodableValue(std::move(list)));
+  } else if (method == "get") {
+    virok::ParkedCart cart;
+    std::string error;
+    if (parked_store.Get(static_cast<uint64_t>(IntArg(args, "id")), &cart,
+                         &error)) {
+      result->Success(CartToValue(cart));
+    } else if (!error.empty()) {
+      result->Error("READ_FAILED", error);
+    } else {
+      result->Success();
+    }
+  } else if (method == "take") {
+    static virok::Histogram* const latency =
+        virok::MetricsRegistry::Get().GetHistogram(
+            "virok_parked_take_microseconds", "Parked cart resume time");
+    virok::LatencyTimer timer(latency);
+    virok::ParkedCart cart;
+    std::string error;
+    if (parked_store.Take(static_cast<uint64_t>(IntArg(args, "id")), &cart,
+                          &error)) {
+      result->Success(CartToValue(cart));
+    } else if (!error.empty()) {
+      result->Error("WRITE_FAILED", error);
+    } else {
+      result->Success();
+    }
+  } else if (method == "stats") {
+    result->Success(StatsToValue(parked_store.stats()));
+  } else {
+    result->NotImplemented();
+  }
+}
+
+}  // namespace
+
+void RegisterParkedChannel(flutter::BinaryMessenger* messenger) {
+  parked_channel = std::make_unique<flutter::MethodChannel<>>(
+      messenger, "com.virok/parked",
+      &flutter::StandardMethodCodec::GetInstance());
+  parked_channel->SetMethodCallHandler(HandleParkedCall);
+}
@@ -0,0 +1,11 @@
+#ifndef RUNNER_PARKED_CHANNEL_H_
+#define RUNNER_PARKED_CHANNEL_H_
+
+#include <flutter/binary_messenger.h>
+
+// Реєструє канал com.virok/parked: відкладені кошики каси, що переживають
+// перезапуск (див. native/parking). Викликати один раз після створення
+// движка.
+void RegisterParkedChannel(flutter::BinaryMessenger* messenger);
+
+#endif  // RUNNER_PARKED_CHANNEL_H_
@@ -0,0 +1,88 @@
+#include "promo_channel.h"
+
+#include <flutter/encodable_value.h>
+#include <flutter/method_channel.h>
+#include <flutter/standard_method_codec.h>
+
+#include <cmath>
+#include <memory>
+#include <string>
+
+#include "channel_args.h"
+#include "metrics/metrics.h"
+#include "promo/promo_service.h"
+#include "trace/trace.h"
+
+namespace {
+
+std::unique_ptr<flutter::MethodChannel<>> promo_channel;
+virok::PromoService promo_service;
+
+// Знижки рядків, що змінилися: {guid: знижка в гривнях}.
+flutter::EncodableValue UpdateToValue(const virok::PromoUpdate& u) {
+  flutter::EncodableMap changed;
+  for (const auto& line : u.changed) {
+    changed[flutter::EncodableValue(line.item)] =
+        flutter::EncodableValue(line.discount / 100.0);
+  }
+  flutter::EncodableMap map;
+  map[flutter::EncodableValue("changed")] = flutter::EncodableValue(std::move(changed));
+  map[flutter::EncodableValue("total")] =
+      flutter::EncodableValue(u.total_discount / 100.0);
+  map[flutter::EncodableValue("elapsedUs")] = flutter::EncodableValue(u.elapsed_us);
+  return flutter::EncodableValue(std::move(map));
+}
+
+void RecordLatency(const virok::PromoUpdate& u) {
+  static virok::Histogram* const latency =
+      virok::MetricsRegistry::Get().GetHistogram(
+          "virok_promo_update_microseconds",
+          "Native promotion re-evaluation time per cart change");
+  latency->Record(u.elapsed_us);
+}
+
+void HandlePromoCall(const flutter::MethodCall<>& call,
+                     std::unique_ptr<flutter::MethodResult<>> result) {
+  const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+  const std::string& method = call.method_name();
+  virok::TraceScope trace_scope("promo", method);
+
+  if (method == "loadRules") {
+    virok::PromoUpdate u;
+    std::string error;
+    if (!promo_service.LoadRules(StringArg(args, "json"), &u, &error)) {
+      result->Error("INVALID_RULES", error);
+      return;
+    }
+    flutter::EncodableValue value = UpdateToValue(u);
+    std::get<flutter::EncodableMap>(value)[flutter::EncodableValue("rules")] =
+        flutter::EncodableValue(static_cast<int64_t>(promo_service.rule_count()));
+    result->Success(value);
+  } else if (method == "setLine" || method == "removeLine") {
+    virok::PromoUpdate u;
+    if (method == "setLine") {
+      promo_service.SetLine(
+          StringArg(args, "guid"), StringArg(args, "category"),
+          std::llround(DoubleArg(args, "price") * 100),
+          std::llround(DoubleArg(args, "quantity") * 1000), &u);
+    } else {
+      promo_service.RemoveLine(StringArg(args, "guid"), &u);
+    }
+    RecordLatency(u);
+    result->Success(UpdateToValue(u));
+  } else if (method == "clear") {
+    promo_service.Clear();
+    result->Success();
+  } else {
+    result->NotImplemented();
+  }
+}
+
+}  // namespace
+
+void RegisterPromoChannel(flutter::BinaryMessenger* messenger) {
+  promo_channel = std::make_unique<flutter::MethodChannel<>>(
+      messenger, "com.virok/promo",
+      &flutter::StandardMethodCodec::GetInstance());
+  promo_channel->SetMethodCallHandler(HandlePromoCall);
+}
@@ -0,0 +1,11 @@
+#ifndef RUNNER_PROMO_CHANNEL_H_
+#define RUNNER_PROMO_CHANNEL_H_
+
+#include <flutter/binary_messenger.h>
+
+// Реєструє канал com.virok/promo: акції й знижки поточного чека з
+// інкрементальним перерахунком на кожне сканування (див. native/promo).
+// Викликати один раз після створення движка.
+void RegisterPromoChannel(flutter::BinaryMessenger* messenger);
+
+#endif  // RUNNER_PROMO_CHANNEL_H_
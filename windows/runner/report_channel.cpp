@@ -0,0 +1,317 @@
+#include "report_channel.h"
+
+#include <flutter/method_channel.h>
+#include <flutter/standard_method_codec.h>
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "archive_channel.h"
+#include "channel_args.h"
+#include "metrics/metrics.h"
+#include "reconcile/shift_reconciler.h"
+#include "report/report_decoder.h"
+#include "trace/trace.h"
+
+namespace {
+
+std::unique_ptr<flutter::MethodChannel<>> report_channel;
+
+using flutter::EncodableList;
+using flutter::EncodableMap;
+using flutter::EncodableValue;
+
+void Put(EncodableMap& map, const char* key, EncodableValue value) {
+  map[EncodableValue(key)] = std::move(value);
+}
+
+// -1 / NaN / "" означають "немає" і в Dart стають null.
+void PutOptional(EncodableMap& map, const char* key, int64_t value) {
+  if (value >= 0) Put(map, key, EncodableValue(value));
+}
+
+void PutOptional(EncodableMap& map, const char* key, double value) {
+  if (!std::isnan(value)) Put(map, key, EncodableValue(value));
+}
+
+void PutOptional(EncodableMap& map, const char* key, const std::string& value) {
+  if (!value.empty()) Put(map, key, EncodableValue(value));
+}
+
+EncodableValue PaysToValue(const std::vector<virok::ReportPay>& pays) {
+  EncodableList list;
+  list.reserve(pays.size());
+  for (const auto& p : pays) {
+    EncodableMap m;
+    Put(m, "type", EncodableValue(p.type));
+    Put(m, "name", EncodableValue(p.name));
+    Put(m, "sumP", EncodableValue(p.sum_p));
+    Put(m, "sumM", EncodableValue(p.sum_m));
+    list.emplace_back(std::move(m));
+  }
+  return EncodableValue(std::move(list));
+}
+
+// Елементи списку |key| з мапи |args|, що самі є мапами.
+std::vector<const EncodableMap*> MapListArg(const EncodableMap* args,
+                                            const char* key) {
+  std::vector<const EncodableMap*> out;
+  const EncodableValue* value = FindArg(args, key);
+  const auto* list = value ? std::get_if<EncodableList>(value) : nullptr;
+  if (!list) return out;
+  for (const auto& item : *list) {
+    if (const auto* map = std::get_if<EncodableMap>(&item)) out.push_back(map);
+  }
+  return out;
+}
+
+// Підсумки X-звіту, які Dart уже має в XReportData:
+//   {"safe", "countP", "countM", "pays": [{"name", "sumP", "sumM"}],
+//    "taxes": [{"grCode", "taxLit", "baseSumP", "baseSumM"}]}
+virok::Report ReportFromValue(const EncodableMap* value) {
+  virok::Report report;
+  report.safe = DoubleArg(value, "safe");
+  report.has_receipt = true;
+  report.receipt.count_p = IntArg(value, "countP");
+  report.receipt.count_m = IntArg(value, "countM");
+  for (const EncodableMap* item : MapListArg(value, "pays")) {
+    virok::ReportPay& pay = report.pays.emplace_back();
+    pay.name = StringArg(item, "name");
+    pay.sum_p = DoubleArg(item, "sumP");
+    pay.sum_m = DoubleArg(item, "sumM");
+  }
+  for (const EncodableMap* item : MapListArg(value, "taxes")) {
+    virok::ReportTax& tax = report.taxes.emplace_back();
+    tax.gr_code = IntArg(item, "grCode");
+    tax.tax_lit = StringArg(item, "taxLit");
+    tax.base_sum_p = DoubleArg(item, "baseSumP");
+    tax.base_sum_m = DoubleArg(item, "baseSumM");
+  }
+  return report;
+}
+
+// Звіт звірки; суми — у копійках.
+EncodableValue ReconcileToValue(const virok::ReconcileReport& r) {
+  EncodableMap map;
+  Put(map, "balanced", EncodableValue(r.balanced()));
+  EncodableList forms;
+  for (const auto& f : r.forms) {
+    EncodableMap m;
+    Put(m, "form", EncodableValue(f.form));
+    Put(m, "device", EncodableValue(f.device));
+    Put(m, "server", EncodableValue(f.server));
+    Put(m, "till", EncodableValue(f.till));
+    forms.emplace_back(std::move(m));
+  }
+  Put(map, "forms", EncodableValue(std::move(forms)));
+  EncodableList taxes;
+  for (const auto& t : r.taxes) {
+    EncodableMap m;
+    Put(m, "group", EncodableValue(t.group));
+    Put(m, "device", EncodableValue(t.device));
+    Put(m, "server", EncodableValue(t.server));
+    Put(m, "serverKnown", EncodableValue(t.server_known));
+    taxes.emplace_back(std::move(m));
+  }
+  Put(map, "taxes", EncodableValue(std::move(taxes)));
+  EncodableList checks;
+  for (const auto& c : r.checks) {
+    EncodableMap m;
+    Put(m, "kind", EncodableValue(virok::CheckDiscrepancyName(c.kind)));
+    PutOptional(m, "number", c.number);
+    PutOptional(m, "rrn", c.rrn);
+    Put(m, "serverAmount", EncodableValue(c.server_amount));
+    Put(m, "tillAmount", EncodableValue(c.till_amount));
+    PutOptional(m, "serverForm", c.server_form);
+    PutOptional(m, "tillForm", c.till_form);
+    checks.emplace_back(std::move(m));
+  }
+  Put(map, "checks", EncodableValue(std::move(checks)));
+  Put(map, "deviceSales", EncodableValue(r.device_sales));
+  Put(map, "deviceRefunds", EncodableValue(r.device_refunds));
+  Put(map, "serverSales", EncodableValue(r.server_sales));
+  Put(map, "serverRefunds", EncodableValue(r.server_refunds));
+  Put(map, "tillSales", EncodableValue(r.till_sales));
+  Put(map, "tillRefunds", EncodableValue(r.till_refunds));
+  Put(map, "cashExpected", EncodableValue(r.cash_expected));
+  PutOptional(map, "cashCounted", r.cash_counted);
+  Put(map, "loadUs", EncodableValue(r.load_us));
+  Put(map, "elapsedUs", EncodableValue(r.elapsed_us));
+  return EncodableValue(std::move(map));
+}
+
+void HandleReportCall(const flutter::MethodCall<>& call,
+                      std::unique_ptr<flutter::MethodResult<>> result) {
+  const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+
+  if (call.method_name() == "decode") {
+    VIROK_TRACE_SCOPE("report", "decode");
+    static virok::Histogram* const latency =
+        virok::MetricsRegistry::Get().GetHistogram(
+            "virok_report_decode_microseconds",
+            "Native X/Z report decoding time");
+    virok::LatencyTimer timer(latency);
+    virok::Report report;
+    std::string error;
+    if (!virok::DecodeReport(StringArg(args, "json"), &report, &error)) {
+      result->Error("PARSE_ERROR", error);
+      return;
+    }
+    result->Success(ReportToValue(report));
+  } else if (call.method_name() == "reconcile") {
+    VIROK_TRACE_SCOPE("report", "reconcile");
+    static virok::Histogram* const latency =
+        virok::MetricsRegistry::Get().GetHistogram(
+            "virok_reconcile_microseconds",
+            "Shift reconciliation time before the Z-report");
+    virok::LatencyTimer timer(latency);
+    const EncodableValue* report_arg = FindArg(args, "report");
+    const virok::Report device = ReportFromValue(
+        report_arg ? std::get_if<EncodableMap>(report_arg) : nullptr);
+    const std::string checks_json = StringArg(args, "checks", "[]");
+    const int64_t shift_opened_ms = IntArg(args, "shiftOpenedMs");
+    virok::ReconcileSources sources;
+    sources.device = [&device](virok::Report* report, std::string*) {
+      *report = device;
+      return true;
+    };
+    sources.server = [&checks_json](std::vector<virok::ReconcileCheck>* out,
+                                    std::string* error) {
+      return virok::ParseServerChecks(checks_json, out, error);
+    };
+    sources.till = [shift_opened_ms](std::vector<virok::ReconcileCheck>* out,
+                                     std::string* error) {
+      if (ArchiveShiftChecks(shift_opened_ms, out)) return true;
+      *error = "Receipt archive is not open";
+      return false;
+    };
+    const double drawer = DoubleArg(args, "drawer", -1);
+    sources.drawer_counted = drawer < 0 ? -1 : std::llround(drawer * 100);
+    virok::ReconcileReport report;
+    std::string error;
+    if (!virok::ReconcileShift(sources, &report, &error)) {
+      result->Error("RECONCILE_FAILED", error);
+      return;
+    }
+    result->Success(ReconcileToValue(report));
+  } else {
+    result->NotImplemented();
+  }
+}
+
+}  // namespace
+
+flutter::EncodableValue ReportToValue(const virok::Report& r) {
+  EncodableMap map;
+  PutOptional(map, "res", r.res);
+  Put(map, "task", EncodableValue(r.task));
+  PutOptional(map, "dt", r.dt);
+  PutOptional(map, "fisid", r.fisid);
+  PutOptional(map, "cashier", r.cashier);
+  Put(map, "safe", EncodableValue(r.safe));
+  Put(map, "safeStartShift", EncodableValue(r.safe_start_shift));
+  Put(map, "isOffline", EncodableValue(r.is_offline));
+  PutOptional(map, "shiftLink", r.shift_link);
+  PutOptional(map, "shiftPrevLink", r.shift_prev_link);
+  PutOptional(map, "vacantOffNums", r.vacant_off_nums);
+  Put(map, "isZRep", EncodableValue(r.is_z_rep));
+  PutOptional(map, "shiftOpened", r.shift_opened);
+  PutOptional(map, "serviceInput", r.service_input);
+  PutOptional(map, "serviceOutput", r.service_output);
+
+  if (r.has_receipt) {
+    EncodableMap m;
+    Put(m, "lastDocnoP", EncodableValue(r.receipt.last_docno_p));
+    Put(m, "lastDocnoM", EncodableValue(r.receipt.last_docno_m));
+    Put(m, "count14", EncodableValue(r.receipt.count_14));
+    Put(m, "countP", EncodableValue(r.receipt.count_p));
+    Put(m, "countM", EncodableValue(r.receipt.count_m));
+    Put(map, "receipt", EncodableValue(std::move(m)));
+  }
+  if (r.has_summary) {
+    // Суми підсумків пласким списком у порядку полів SummaryData.
+    const auto& s = r.summary;
+    Put(map, "summary",
+        EncodableValue(std::vector<double>{s.base_p, s.base_m, s.taxex_p,
+                                           s.taxex_m, s.disc_p, s.disc_m,
+                                           s.calc_p, s.calc_m}));
+  }
+
+  EncodableList taxes;
+  taxes.reserve(r.taxes.size());
+  for (const auto& t : r.taxes) {
+    EncodableMap m;
+    Put(m, "grCode", EncodableValue(t.gr_code));
+    Put(m, "baseSumP", EncodableValue(t.base_sum_p));
+    Put(m, "baseSumM", EncodableValue(t.base_sum_m));
+    Put(m, "taxName", EncodableValue(t.tax_name));
+    Put(m, "taxFname", EncodableValue(t.tax_fname));
+    Put(m, "taxLit", EncodableValue(t.tax_lit));
+    Put(m, "taxPercent", EncodableValue(t.tax_percent));
+    Put(m, "taxSumP", EncodableValue(t.tax_sum_p));
+    Put(m, "taxSumM", EncodableValue(t.tax_sum_m));
+    taxes.emplace_back(std::move(m));
+  }
+  Put(map, "taxes", EncodableValue(std::move(taxes)));
+  Put(map, "pays", PaysToValue(r.pays));
+  Put(map, "money", PaysToValue(r.money));
+  Put(map, "cash", PaysToValue(r.cash));
+
+  if (r.has_last_check) {
+    EncodableMap m;
+    Put(m, "packnum", EncodableValue(r.last_check.packnum));
+    Put(m, "docnum", EncodableValue(r.last_check.docnum));
+    Put(m, "fisnum", EncodableValue(r.last_check.fisnum));
+    Put(m, "packtype", EncodableValue(r.last_check.packtype));
+    Put(map, "lastCheck", EncodableValue(std::move(m)));
+  }
+
+  EncodableList warnings;
+  warnings.reserve(r.warnings.size());
+  for (const auto& w : r.warnings) {
+    EncodableMap m;
+    Put(m, "code", EncodableValue(w.code));
+    Put(m, "wtxt", EncodableValue(w.wtxt));
+    warnings.emplace_back(std::move(m));
+  }
+  Put(map, "warnings", EncodableValue(std::move(warnings)));
+
+  if (r.has_billing) {
+    EncodableMap m;
+    Put(m, "paidDateTo", EncodableValue(r.billing.paid_date_to));
+    Put(m, "enoughToRenewSubscription",
+        EncodableValue(r.billing.enough_to_renew_subscription));
+    Put(map, "billing", EncodableValue(std::move(m)));
+  }
+  if (r.has_print_header) {
+    const auto& h = r.print_header;
+    EncodableMap m;
+    PutOptional(m, "name", h.name);
+    PutOptional(m, "shopname", h.shopname);
+    PutOptional(m, "shopad", h.shopad);
+    PutOptional(m, "vatCode", h.vat_code);
+    PutOptional(m, "fisCode", h.fis_code);
+    PutOptional(m, "dt", h.dt);
+    Put(m, "isOffline", EncodableValue(h.is_offline));
+    PutOptional(m, "fisid", h.fisid);
+    PutOptional(m, "cashier", h.cashier);
+    Put(map, "printHeader", EncodableValue(std::move(m)));
+  }
+
+  PutOptional(map, "visualization", r.visualization);
+  if (!r.print_data.empty()) {
+    Put(map, "printData",
+        EncodableValue(std::vector<uint8_t>(r.print_data.begin(),
+                                            r.print_data.end())));
+  }
+  return EncodableValue(std::move(map));
+}
+
+void RegisterReportChannel(flutter::BinaryMessenger* messenger) {
+  report_channel = std::make_unique<flutter::MethodChannel<>>(
+      messenger, "com.virok/report",
+      &flutter::StandardMethodCodec::GetInstance());
+  report_channel->SetMethodCallHandler(HandleReportCall);
+}
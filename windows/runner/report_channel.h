@@ -0,0 +1,18 @@
+#ifndef RUNNER_REPORT_CHANNEL_H_
+#define RUNNER_REPORT_CHANNEL_H_
+
+#include <flutter/binary_messenger.h>
+#include <flutter/encodable_value.h>
+
+#include "report/report.h"
+
+// Розібраний звіт у формі, яку читає XReportData.fromNative. Байти для
+// принтера йдуть як Uint8List (printData), без перекодування в Dart.
+flutter::EncodableValue ReportToValue(const virok::Report& report);
+
+// Реєструє канал com.virok/report: розбір JSON X/Z-звітів (decode) для
+// відповідей, що приходять не через COM (Vchasno), і звірка зміни перед
+// Z-звітом (reconcile, див. native/reconcile).
+void RegisterReportChannel(flutter::BinaryMessenger* messenger);
+
+#endif  // RUNNER_REPORT_CHANNEL_H_
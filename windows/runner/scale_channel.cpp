@@ -0,0 +1,136 @@
+#include "scale_channel.h"
+
+#include <flutter/encodable_value.h>
+#include <flutter/event_channel.h>
+#include <flutter/event_stream_handler_functions.h>
+#include <flutter/method_channel.h>
+#include <flutter/standard_method_codec.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "channel_args.h"
+#include "scale/scale_driver.h"
+#include "trace/trace.h"
+
+namespace {
+
+using flutter::EncodableMap;
+using flutter::EncodableValue;
+
+std::unique_ptr<flutter::MethodChannel<>> scale_channel;
+std::unique_ptr<flutter::EventChannel<>> scale_events;
+std::unique_ptr<flutter::EventSink<>> scale_sink;  // лише в потоці платформи
+std::unique_ptr<virok::ScaleDriver> scale_driver;
+std::function<void(std::function<void()>)> post_to_platform;
+std::string scale_port;
+
+EncodableValue EventToValue(const virok::ScaleEvent& event) {
+  EncodableMap map;
+  map[EncodableValue("type")] =
+      EncodableValue(virok::ScaleEventName(event.type));
+  map[EncodableValue("grams")] = EncodableValue(event.grams);
+  if (event.type == virok::ScaleEvent::Type::kStable) {
+    map[EncodableValue("settleUs")] = EncodableValue(event.settle_latency_us);
+    map[EncodableValue("loadUs")] = EncodableValue(event.load_latency_us);
+  }
+  if (!event.error.empty()) {
+    map[EncodableValue("error")] = EncodableValue(event.error);
+  }
+  return EncodableValue(std::move(map));
+}
+
+void OnScaleEvent(const virok::ScaleEvent& event) {
+  EncodableValue value = EventToValue(event);
+  post_to_platform([value] {
+    if (scale_sink) scale_sink->Success(value);
+  });
+}
+
+void HandleScaleCall(const flutter::MethodCall<>& call,
+                     std::unique_ptr<flutter::MethodResult<>> result) {
+  const auto* args = std::get_if<EncodableMap>(call.arguments());
+  const std::string& method = call.method_name();
+  virok::TraceScope trace_scope("scale", method);
+
+  if (method == "start") {
+    virok::ScaleOptions options;
+    options.port = StringArg(args, "port");
+    options.baud = static_cast<int>(IntArg(args, "baud", 9600));
+    if (!virok::ParseScaleProtocol(StringArg(args, "protocol", "cas"),
+                                   &options.protocol)) {
+      result->Error("UNKNOWN_PROTOCOL", "Unknown scale protocol");
+      return;
+    }
+    options.stable.settle = std::chrono::milliseconds(
+        IntArg(args, "settleMs", options.stable.settle.count()));
+    options.stable.tolerance_grams =
+        IntArg(args, "toleranceGrams", options.stable.tolerance_grams);
+    options.stable.min_grams =
+        IntArg(args, "minGrams", options.stable.min_grams);
+    std::string error;
+    if (!scale_driver->Start(options, &error)) {
+      scale_port.clear();
+      result->Error("OPEN_FAILED", error);
+      return;
+    }
+    scale_port = options.port;
+    result->Success(EncodableValue(true));
+  } else if (method == "stop") {
+    scale_driver->Stop();
+    scale_port.clear();
+    result->Success();
+  } else if (method == "status") {
+    EncodableMap map;
+    map[EncodableValue("running")] = EncodableValue(scale_driver->running());
+    map[EncodableValue("port")] = EncodableValue(scale_port);
+    result->Success(EncodableValue(std::move(map)));
+  } else if (method == "stableWeight") {
+    const int64_t grams = scale_driver->stable_grams();
+    if (grams < 0) {
+      result->Success();
+    } else {
+      result->Success(EncodableValue(grams));
+    }
+  } else {
+    result->NotImplemented();
+  }
+}
+
+}  // namespace
+
+void RegisterScaleChannel(
+    flutter::BinaryMessenger* messenger,
+    std::function<void(std::function<void()>)> post_task) {
+  post_to_platform = std::move(post_task);
+  scale_driver = std::make_unique<virok::ScaleDriver>(OnScaleEvent);
+  scale_channel = std::make_unique<flutter::MethodChannel<>>(
+      messenger, "com.virok/scale",
+      &flutter::StandardMethodCodec::GetInstance());
+  scale_channel->SetMethodCallHandler(HandleScaleCall);
+  scale_events = std::make_unique<flutter::EventChannel<>>(
+      messenger, "com.virok/scale/events",
+      &flutter::StandardMethodCodec::GetInstance());
+  scale_events->SetStreamHandler(
+      std::make_unique<flutter::StreamHandlerFunctions<>>(
+          [](const EncodableValue*,
+             std::unique_ptr<flutter::EventSink<>>&& events)
+              -> std::unique_ptr<flutter::StreamHandlerError<>> {
+            scale_sink = std::move(events);
+            return nullptr;
+          },
+          [](const EncodableValue*)
+              -> std::unique_ptr<flutter::StreamHandlerError<>> {
+            scale_sink.reset();
+            return nullptr;
+          }));
+}
+
+void ShutdownScaleChannel() {
+  if (scale_driver) scale_driver->Stop();
+  scale_sink.reset();
+  scale_events.reset();
+  scale_channel.reset();
+}
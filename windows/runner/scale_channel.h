@@ -0,0 +1,20 @@
+#ifndef RUNNER_SCALE_CHANNEL_H_
+#define RUNNER_SCALE_CHANNEL_H_
+
+#include <flutter/binary_messenger.h>
+
+#include <functional>
+
+// Реєструє канал com.virok/scale (start, stop, status) і потік подій
+// com.virok/scale/events: маса з торгових ваг, щойно вона встановилася
+// (див. native/scale). Події приходять з потоку ваг і передаються в потік
+// платформи через |post_task|.
+// Викликати один раз після створення движка.
+void RegisterScaleChannel(
+    flutter::BinaryMessenger* messenger,
+    std::function<void(std::function<void()>)> post_task);
+
+// Зупиняє ваги до того, як движок буде знищено.
+void ShutdownScaleChannel();
+
+#endif  // RUNNER_SCALE_CHANNEL_H_
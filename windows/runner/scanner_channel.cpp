@@ -0,0 +1,305 @@
+#include "scanner_channel.h"
+
+#include <flutter/encodable_value.h>
+#include <flutter/event_channel.h>
+#include <flutter/event_stream_handler_functions.h>
+#include <flutter/method_channel.h>
+#include <flutter/standard_method_codec.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "channel_args.h"
+#include "scanner/scanner_key_filter.h"
+#include "text/utf.h"
+#include "trace/trace.h"
+
+namespace {
+
+using flutter::EncodableMap;
+using flutter::EncodableValue;
+using Clock = virok::ScannerKeyFilter::Clock;
+
+std::unique_ptr<flutter::MethodChannel<>> scanner_channel;
+std::unique_ptr<flutter::EventChannel<>> scanner_events;
+std::unique_ptr<flutter::EventSink<>> scanner_sink;
+HWND scanner_window = nullptr;
+bool scanner_enabled = true;
+virok::ScannerKeyFilter scanner_filter;
+// Копії утриманих повідомлень за токеном ScannerKey.
+std::map<uint64_t, MSG> held_messages;
+uint64_t next_token = 1;
+
+// Час клавіші — MSG::time (момент введення, а не обробки): клавіші
+// людини, що накопичилися в черзі за довгий кадр, інакше виглядали б як
+// сплеск сканера. Роздільність — такт системного таймера (10-16 мс), що
+// вдвічі менше за типовий max_key_gap.
+bool has_origin = false;
+DWORD origin_ms = 0;
+Clock::time_point origin;
+
+FILE* record_file = nullptr;
+bool record_started = false;
+Clock::time_point record_origin;
+
+Clock::time_point EventTime(DWORD ms) {
+  if (!has_origin) {
+    has_origin = true;
+    origin_ms = ms;
+    origin = Clock::now();
+  }
+  const DWORD elapsed_ms = ms - origin_ms;
+  return origin + std::chrono::milliseconds(elapsed_ms);
+}
+
+bool IsModifierKey(WPARAM vk) {
+  switch (vk) {
+    case VK_SHIFT:
+    case VK_LSHIFT:
+    case VK_RSHIFT:
+    case VK_CONTROL:
+    case VK_LCONTROL:
+    case VK_RCONTROL:
+    case VK_MENU:
+    case VK_LMENU:
+    case VK_RMENU:
+    case VK_LWIN:
+    case VK_RWIN:
+    case VK_CAPITAL:
+      return true;
+    default:
+      return false;
+  }
+}
+
+char32_t KeyChar(const MSG& msg) {
+  if (msg.message != WM_KEYDOWN) return 0;
+  if (msg.wParam == VK_RETURN) return U'\r';
+  if (msg.wParam == VK_TAB) return U'\t';
+  BYTE state[256];
+  if (!::GetKeyboardState(state)) return 0;
+  if ((state[VK_CONTROL] | state[VK_MENU] | state[VK_LWIN] |
+       state[VK_RWIN]) &
+      0x80) {
+    return 0;
+  }
+  wchar_t buf[4];
+  const UINT scan_code = (msg.lParam >> 16) & 0xFF;
+  // 0x4: не змінювати стан мертвих клавіш у ядрі, бо TranslateMessage
+  // перекладе цю ж клавішу ще раз (Windows 10 1607+).
+  const int n = ::ToUnicodeEx(static_cast<UINT>(msg.wParam), scan_code,
+                              state, buf, 4, 0x4, ::GetKeyboardLayout(0));
+  // Мертві клавіші (-1) і пари сурогатів у штрихкодах не трапляються.
+  return n == 1 ? static_cast<char32_t>(buf[0]) : 0;
+}
+
+void SendBarcode(const std::string& barcode, int64_t burst_us) {
+  if (!scanner_sink) return;
+  EncodableMap map;
+  map[EncodableValue("barcode")] = EncodableValue(barcode);
+  map[EncodableValue("burstUs")] = EncodableValue(burst_us);
+  scanner_sink->Success(EncodableValue(std::move(map)));
+}
+
+void ApplyOutput(virok::ScannerOutput* out) {
+  for (uint64_t token : out->release) {
+    auto it = held_messages.find(token);
+    if (it == held_messages.end()) continue;
+    // Повторна доставка в обхід фільтра: так, ніби цикл щойно отримав
+    // це повідомлення.
+    const MSG msg = it->second;
+    held_messages.erase(it);
+    ::TranslateMessage(&msg);
+    ::DispatchMessage(&msg);
+  }
+  for (uint64_t token : out->drop) held_messages.erase(token);
+  if (!out->barcode.empty()) SendBarcode(out->barcode, out->burst_us);
+  out->Clear();
+}
+
+// Таймер на deadline() фільтра, відрахований від останньої клавіші.
+void RescheduleExpire(Clock::time_point now) {
+  if (scanner_window == nullptr) return;
+  if (!scanner_filter.holding()) {
+    ::KillTimer(scanner_window, kScannerTimerId);
+    return;
+  }
+  const int64_t wait_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          scanner_filter.deadline() - now)
+          .count() +
+      1;
+  ::SetTimer(scanner_window, kScannerTimerId,
+             static_cast<UINT>(std::max<int64_t>(wait_ms, USER_TIMER_MINIMUM)),
+             nullptr);
+}
+
+char32_t FirstChar(const std::string& text) {
+  std::u16string wide;
+  if (text.empty() || !virok::Utf8ToUtf16(text, &wide) || wide.empty()) {
+    return 0;
+  }
+  return wide[0];
+}
+
+void HandleScannerCall(const flutter::MethodCall<>& call,
+                       std::unique_ptr<flutter::MethodResult<>> result) {
+  const auto* args = std::get_if<EncodableMap>(call.arguments());
+  const std::string& method = call.method_name();
+  virok::TraceScope trace_scope("scanner", method);
+
+  if (method == "configure") {
+    FlushScannerKeys();
+    virok::ScannerOptions options = scanner_filter.options();
+    scanner_enabled = BoolArg(args, "enabled", scanner_enabled);
+    options.max_key_gap = std::chrono::milliseconds(
+        IntArg(args, "maxGapMs", options.max_key_gap.count()));
+    options.min_length = static_cast<size_t>(IntArg(
+        args, "minLength", static_cast<int64_t>(options.min_length)));
+    options.prefix_timeout = std::chrono::milliseconds(
+        IntArg(args, "prefixTimeoutMs", options.prefix_timeout.count()));
+    if (FindArg(args, "prefix") != nullptr) {
+      options.prefix = FirstChar(StringArg(args, "prefix"));
+    }
+    if (FindArg(args, "suffix") != nullptr) {
+      options.suffix = FirstChar(StringArg(args, "suffix"));
+    }
+    scanner_filter.set_options(options);
+    result->Success();
+  } else if (method == "record") {
+    // Запис потоку клавіш для native/test/data/scanner; порожній path
+    // зупиняє запис.
+    if (record_file != nullptr) {
+      std::fclose(record_file);
+      record_file = nullptr;
+    }
+    const std::string path = StringArg(args, "path");
+    if (!path.empty()) {
+      record_file = std::fopen(path.c_str(), "w");
+      record_started = false;
+      if (record_file == nullptr) {
+        result->Error("OPEN_FAILED", "Cannot open the key recording");
+        return;
+      }
+    }
+    result->Success();
+  } else if (method == "status") {
+    EncodableMap map;
+    map[EncodableValue("enabled")] = EncodableValue(scanner_enabled);
+    map[EncodableValue("holding")] = EncodableValue(scanner_filter.holding());
+    map[EncodableValue("recording")] = EncodableValue(record_file != nullptr);
+    result->Success(EncodableValue(std::move(map)));
+  } else {
+    result->NotImplemented();
+  }
+}
+
+}  // namespace
+
+void RegisterScannerChannel(flutter::BinaryMessenger* messenger,
+                            HWND timer_window) {
+  scanner_window = timer_window;
+  scanner_channel = std::make_unique<flutter::MethodChannel<>>(
+      messenger, "com.virok/scanner",
+      &flutter::StandardMethodCodec::GetInstance());
+  scanner_channel->SetMethodCallHandler(HandleScannerCall);
+  scanner_events = std::make_unique<flutter::EventChannel<>>(
+      messenger, "com.virok/scanner/events",
+      &flutter::StandardMethodCodec::GetInstance());
+  scanner_events->SetStreamHandler(
+      std::make_unique<flutter::StreamHandlerFunctions<>>(
+          [](const EncodableValue*,
+             std::unique_ptr<flutter::EventSink<>>&& events)
+              -> std::unique_ptr<flutter::StreamHandlerError<>> {
+            scanner_sink = std::move(events);
+            return nullptr;
+          },
+          [](const EncodableValue*)
+              -> std::unique_ptr<flutter::StreamHandlerError<>> {
+            scanner_sink.reset();
+            // Сплеск, утриманий до відписки, повертається застосунку
+            // клавішами.
+            FlushScannerKeys();
+            return nullptr;
+          }));
+}
+
+bool FilterScannerMessage(const MSG& msg) {
+  // Без слухача штрихкод нікому віддати: клавіші йдуть у Flutter як є.
+  if (scanner_window == nullptr || !scanner_enabled || !scanner_sink) {
+    return false;
+  }
+  virok::ScannerKey key;
+  switch (msg.message) {
+    case WM_KEYDOWN:
+    case WM_SYSKEYDOWN:
+      key.type = virok::ScannerKey::Type::kDown;
+      break;
+    case WM_KEYUP:
+    case WM_SYSKEYUP:
+      key.type = virok::ScannerKey::Type::kUp;
+      break;
+    default:
+      return false;
+  }
+  if (msg.hwnd != scanner_window && !::IsChild(scanner_window, msg.hwnd)) {
+    return false;
+  }
+
+  // Скан-код з ознакою розширеної клавіші (правий Ctrl, Enter цифрового
+  // блоку).
+  key.code = static_cast<uint32_t>((msg.lParam >> 16) & 0x1FF);
+  key.ch = KeyChar(msg);
+  key.modifier = IsModifierKey(msg.wParam);
+  key.time = EventTime(msg.time);
+  key.token = next_token++;
+
+  if (record_file != nullptr) {
+    if (!record_started) {
+      record_started = true;
+      record_origin = key.time;
+    }
+    std::fprintf(record_file, "%s\n",
+                 virok::FormatScannerKey(key, record_origin).c_str());
+  }
+
+  virok::ScannerOutput out;
+  const bool taken = scanner_filter.Filter(key, &out);
+  if (taken) held_messages[key.token] = msg;
+  ApplyOutput(&out);
+  RescheduleExpire(key.time);
+  return taken;
+}
+
+void OnScannerTimer() {
+  virok::ScannerOutput out;
+  scanner_filter.Expire(
+      scanner_filter.deadline() + std::chrono::milliseconds(1), &out);
+  ApplyOutput(&out);
+  RescheduleExpire(Clock::now());
+}
+
+void FlushScannerKeys() {
+  virok::ScannerOutput out;
+  scanner_filter.Flush(&out);
+  ApplyOutput(&out);
+  RescheduleExpire(Clock::now());
+}
+
+void ShutdownScannerChannel() {
+  if (scanner_window != nullptr) ::KillTimer(scanner_window, kScannerTimerId);
+  scanner_window = nullptr;
+  held_messages.clear();
+  if (record_file != nullptr) {
+    std::fclose(record_file);
+    record_file = nullptr;
+  }
+  scanner_sink.reset();
+  scanner_events.reset();
+  scanner_channel.reset();
+}
@@ -0,0 +1,31 @@
+#ifndef RUNNER_SCANNER_CHANNEL_H_
+#define RUNNER_SCANNER_CHANNEL_H_
+
+#include <flutter/binary_messenger.h>
+#include <windows.h>
+
+// Таймер утримання клавіш сканера у вікні |timer_window|.
+constexpr UINT_PTR kScannerTimerId = 0x5CA7;
+
+// Реєструє канал com.virok/scanner (configure, record, status) і потік
+// подій com.virok/scanner/events: штрихкод зі сканера-клавіатури однією
+// подією {barcode, burstUs} (див. native/scanner). WM_TIMER з
+// kScannerTimerId приходить у |timer_window|.
+// Викликати один раз після створення движка.
+void RegisterScannerChannel(flutter::BinaryMessenger* messenger,
+                            HWND timer_window);
+
+// Клавіші адресовані дочірньому вікну FlutterView, тому фільтр стоїть у
+// циклі повідомлень до TranslateMessage. True — повідомлення утримане або
+// поглинуте: не перекладати й не передавати далі.
+bool FilterScannerMessage(const MSG& msg);
+
+// WM_TIMER з kScannerTimerId: утримане, що не стало кодом, віддається.
+void OnScannerTimer();
+
+// Віддає утримані клавіші (вікно втратило фокус).
+void FlushScannerKeys();
+
+void ShutdownScannerChannel();
+
+#endif  // RUNNER_SCANNER_CHANNEL_H_
@@ -0,0 +1,152 @@
+#include "search_channel.h"
+
+#include <flutter/encodable_value.h>
+#include <flutter/method_channel.h>
+#include <flutter/standard_method_codec.h>
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "catalogue/shared_catalogue.h"
+#include "channel_args.h"
+#include "metrics/metrics.h"
+#include "search/search_service.h"
+#include "trace/trace.h"
+
+namespace {
+
+std::unique_ptr<flutter::MethodChannel<>> search_channel;
+virok::SearchService search_service;
+// Каталог, спільний для кас на цій машині (див. native/catalogue).
+virok::SharedCatalogue shared_catalogue;
+bool shared_catalogue_open = false;
+// Генерація, на якій зараз індекс; 0 — власний індекс каси.
+uint64_t shared_generation = 0;
+
+// Розмір сторінки за замовчуванням (як LIMIT у SQLite-пошуку).
+constexpr int64_t kDefaultLimit = 100;
+
+flutter::EncodableValue ResultToValue(const virok::SearchResult& r) {
+  flutter::EncodableList ids;
+  ids.reserve(r.ids.size());
+  for (const auto& id : r.ids) ids.emplace_back(id);
+
+  flutter::EncodableMap map;
+  map[flutter::EncodableValue("ids")] = flutter::EncodableValue(std::move(ids));
+  map[flutter::EncodableValue("exhausted")] = flutter::EncodableValue(r.exhausted);
+  map[flutter::EncodableValue("total")] = flutter::EncodableValue(r.total);
+  map[flutter::EncodableValue("elapsedUs")] = flutter::EncodableValue(r.elapsed_us);
+  return flutter::EncodableValue(std::move(map));
+}
+
+// Переводить пошук на спільну генерацію версії не старшої за |version|;
+// -1, якщо такої немає або каталог настільки великий, що його шардують
+// (спільна генерація — один SearchIndex, див. SearchService).
+// |keep_sessions| — відкриті сесії лишаються на попередній генерації.
+int64_t AttachShared(int64_t version, bool keep_sessions = false) {
+  if (!shared_catalogue_open) return -1;
+  auto generation = shared_catalogue.Current();
+  if (!generation || generation->version() < static_cast<uint64_t>(version) ||
+      generation->search_view().count >=
+          virok::SearchService::kShardedMinItems) {
+    return -1;
+  }
+  shared_generation = generation->generation();
+  auto index = std::make_shared<const virok::SearchIndex>(
+      generation->search_view(), generation);
+  return static_cast<int64_t>(
+      keep_sessions ? search_service.LoadIndexForNewSessions(std::move(index))
+                    : search_service.LoadIndex(std::move(index)));
+}
+
+// Нова сесія — момент перейти на генерацію, яку після синхронізації
+// опублікувала інша каса. Відкриті сесії під час набору не чіпаємо: вони
+// тримають свою генерацію, доки їх не закриють.
+void FollowShared() {
+  if (shared_generation == 0) return;
+  auto generation = shared_catalogue.Current();
+  if (generation && generation->generation() != shared_generation) {
+    AttachShared(0, /*keep_sessions=*/true);
+  }
+}
+
+void HandleSearchCall(const flutter::MethodCall<>& call,
+                      std::unique_ptr<flutter::MethodResult<>> result) {
+  const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+  const std::string& method = call.method_name();
+  virok::TraceScope trace_scope("search", method);
+
+  if (method == "loadIndex") {
+    const std::vector<std::string> ids = StringListArg(args, "ids");
+    const std::vector<std::string> keys = StringListArg(args, "keys");
+    const std::vector<std::string> groups = StringListArg(args, "groups");
+    const int64_t version = IntArg(args, "version");
+    int64_t count = -1;
+    // Версія (час синхронізації) — ознака, що каталог можна віддати
+    // іншим касам; тоді й ця каса тримає його лише у спільній пам'яті.
+    if (version > 0 && shared_catalogue_open) {
+      bool published = false;
+      std::string error;
+      if (!shared_catalogue.Publish(ids, keys, static_cast<uint64_t>(version),
+                                    &published, &error)) {
+        std::fprintf(stderr, "Shared catalogue publish failed: %s\n",
+                     error.c_str());
+      }
+      count = AttachShared(version);
+    }
+    if (count < 0) {
+      shared_generation = 0;
+      count = static_cast<int64_t>(search_service.LoadIndex(ids, keys, groups));
+    }
+    result->Success(flutter::EncodableValue(count));
+  } else if (method == "attachShared") {
+    result->Success(
+        flutter::EncodableValue(AttachShared(IntArg(args, "version"))));
+  } else if (method == "openSession") {
+    FollowShared();
+    result->Success(flutter::EncodableValue(search_service.OpenSession()));
+  } else if (method == "closeSession") {
+    search_service.CloseSession(IntArg(args, "session"));
+    result->Success();
+  } else if (method == "query" || method == "more") {
+    const int64_t session = IntArg(args, "session");
+    const size_t limit =
+        static_cast<size_t>(IntArg(args, "limit", kDefaultLimit));
+    virok::SearchResult r;
+    bool found;
+    if (method == "query") {
+      found = search_service.Query(session, StringArg(args, "query"), limit,
+                                   &r);
+    } else {
+      found = search_service.More(session, limit, &r);
+    }
+    if (!found) {
+      result->Error("NO_SESSION", "Search session is closed");
+      return;
+    }
+    static virok::Histogram* const latency =
+        virok::MetricsRegistry::Get().GetHistogram(
+            "virok_search_query_microseconds",
+            "Native catalogue search time per query/more call");
+    latency->Record(r.elapsed_us);
+    result->Success(ResultToValue(r));
+  } else {
+    result->NotImplemented();
+  }
+}
+
+}  // namespace
+
+void RegisterSearchChannel(flutter::BinaryMessenger* messenger) {
+  std::string error;
+  shared_catalogue_open = shared_catalogue.Open(&error);
+  if (!shared_catalogue_open) {
+    std::fprintf(stderr, "Shared catalogue unavailable: %s\n", error.c_str());
+  }
+  search_channel = std::make_unique<flutter::MethodChannel<>>(
+      messenger, "com.virok/search",
+      &flutter::StandardMethodCodec::GetInstance());
+  search_channel->SetMethodCallHandler(HandleSearchCall);
+}
@@ -0,0 +1,12 @@
+#ifndef RUNNER_SEARCH_CHANNEL_H_
+#define RUNNER_SEARCH_CHANNEL_H_
+
+#include <flutter/binary_messenger.h>
+
+// Реєструє канал com.virok/search: інкрементальні сесії пошуку по каталогу
+// (див. native/search). Індекс з версією публікується у спільний каталог
+// (native/catalogue), а attachShared підхоплює каталог, опублікований
+// іншою касою на цій машині. Викликати один раз після створення движка.
+void RegisterSearchChannel(flutter::BinaryMessenger* messenger);
+
+#endif  // RUNNER_SEARCH_CHANNEL_H_
@@ -0,0 +1,124 @@
+#include "startup_channel.h"
+
+#include <flutter/method_channel.h>
+#include <flutter/standard_method_codec.h>
+#include <shlobj.h>
+#include <windows.h>
+
+#include <filesystem>
+#include <memory>
+#include <string>
+
+#include "channel_args.h"
+#include "flutter_window.h"
+#include "startup/prewarm.h"
+#include "startup/prewarm_tasks.h"
+#include "startup/startup_timeline.h"
+
+namespace {
+
+std::unique_ptr<flutter::MethodChannel<>> startup_channel;
+
+// Живе до кінця процесу: задачі можуть ще працювати, коли вікно закрите.
+virok::PrewarmPool* prewarm_pool = nullptr;
+
+// Той самий шлях, що й getDatabasesPath() у sqflite_common_ffi:
+// <робоча папка>\.dart_tool\sqflite_common_ffi\databases.
+std::string CatalogueDatabasePath() {
+  return (std::filesystem::current_path() / ".dart_tool" /
+          "sqflite_common_ffi" / "databases" / "nomenclatura.db")
+      .u8string();
+}
+
+// shared_preferences_windows зберігає налаштування в
+// %APPDATA%\<CompanyName>\<ProductName> (значення з Runner.rc).
+std::string PreferencesPath() {
+  PWSTR roaming = nullptr;
+  if (FAILED(::SHGetKnownFolderPath(FOLDERID_RoamingAppData, 0, nullptr,
+                                    &roaming))) {
+    return std::string();
+  }
+  const std::filesystem::path path = std::filesystem::path(roaming) /
+                                     L"com.example" / L"cash_register" /
+                                     L"shared_preferences.json";
+  ::CoTaskMemFree(roaming);
+  return path.u8string();
+}
+
+flutter::EncodableMap ResultToValue(const virok::PrewarmResult& r) {
+  flutter::EncodableMap values;
+  for (const auto& [key, value] : r.values) {
+    values[flutter::EncodableValue(key)] = flutter::EncodableValue(value);
+  }
+  flutter::EncodableMap map;
+  map[flutter::EncodableValue("state")] =
+      flutter::EncodableValue(virok::PrewarmStateName(r.state));
+  map[flutter::EncodableValue("startUs")] =
+      flutter::EncodableValue(r.start_ns / 1000);
+  map[flutter::EncodableValue("elapsedUs")] = flutter::EncodableValue(
+      r.end_ns > 0 ? (r.end_ns - r.start_ns) / 1000 : int64_t{0});
+  map[flutter::EncodableValue("values")] = flutter::EncodableValue(values);
+  if (!r.error.empty()) {
+    map[flutter::EncodableValue("error")] = flutter::EncodableValue(r.error);
+  }
+  return map;
+}
+
+void HandleStartupCall(const flutter::MethodCall<>& call,
+                       std::unique_ptr<flutter::MethodResult<>> result) {
+  const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+  const std::string& method = call.method_name();
+  virok::StartupTimeline& timeline = virok::StartupTimeline::Get();
+
+  if (method == "mark") {
+    const int64_t ns = timeline.Mark(StringArg(args, "name"));
+    result->Success(flutter::EncodableValue(ns / 1000));
+  } else if (method == "timeline") {
+    flutter::EncodableList marks;
+    for (const auto& mark : timeline.Marks()) {
+      marks.push_back(flutter::EncodableValue(flutter::EncodableMap{
+          {flutter::EncodableValue("name"), flutter::EncodableValue(mark.name)},
+          {flutter::EncodableValue("us"),
+           flutter::EncodableValue(mark.ns / 1000)},
+      }));
+    }
+    result->Success(flutter::EncodableValue(marks));
+  } else if (method == "prewarm") {
+    flutter::EncodableMap tasks;
+    if (prewarm_pool) {
+      for (const auto& r : prewarm_pool->Snapshot()) {
+        tasks[flutter::EncodableValue(r.name)] =
+            flutter::EncodableValue(ResultToValue(r));
+      }
+    }
+    result->Success(flutter::EncodableValue(tasks));
+  } else {
+    result->NotImplemented();
+  }
+}
+
+}  // namespace
+
+void StartPrewarm() {
+  virok::StartupTimeline::Get().Mark("runner");
+  prewarm_pool = new virok::PrewarmPool();
+
+  prewarm_pool->Run("catalogue", [path = CatalogueDatabasePath()](
+                                     virok::PrewarmResult* r) {
+    return virok::PageInFile(path, r);
+  });
+  prewarm_pool->Run("config", [path = PreferencesPath()](
+                                  virok::PrewarmResult* r) {
+    return virok::ReadCashalotConfig(path, r);
+  });
+  prewarm_pool->Run("fiscal", [](virok::PrewarmResult* r) {
+    return PrewarmCashalotServer(&r->error);
+  });
+}
+
+void RegisterStartupChannel(flutter::BinaryMessenger* messenger) {
+  startup_channel = std::make_unique<flutter::MethodChannel<>>(
+      messenger, "com.virok/startup",
+      &flutter::StandardMethodCodec::GetInstance());
+  startup_channel->SetMethodCallHandler(HandleStartupCall);
+}
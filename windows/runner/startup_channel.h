@@ -0,0 +1,15 @@
+#ifndef RUNNER_STARTUP_CHANNEL_H_
+#define RUNNER_STARTUP_CHANNEL_H_
+
+#include <flutter/binary_messenger.h>
+
+// Запускає паралельний прогрів (native/startup) до створення
+// FlutterViewController: читає nomenclatura.db у кеш ОС, розбирає
+// налаштування Cashalot і завантажує COM-сервер Cashalot.
+void StartPrewarm();
+
+// Реєструє канал com.virok/startup: позначки хронології запуску (mark,
+// timeline) і результати прогріву для Dart (prewarm).
+void RegisterStartupChannel(flutter::BinaryMessenger* messenger);
+
+#endif  // RUNNER_STARTUP_CHANNEL_H_
@@ -0,0 +1,170 @@
+#include "terminal_channel.h"
+
+#include <flutter/encodable_value.h>
+#include <flutter/event_channel.h>
+#include <flutter/event_stream_handler_functions.h>
+#include <flutter/method_channel.h>
+#include <flutter/standard_method_codec.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "channel_args.h"
+#include "terminal/terminal_driver.h"
+#include "trace/trace.h"
+
+namespace {
+
+using flutter::EncodableMap;
+using flutter::EncodableValue;
+
+std::unique_ptr<flutter::MethodChannel<>> terminal_channel;
+std::unique_ptr<flutter::EventChannel<>> terminal_events;
+std::unique_ptr<flutter::EventSink<>> terminal_sink;  // потік платформи
+std::unique_ptr<virok::TerminalDriver> terminal_driver;
+std::function<void(std::function<void()>)> post_to_platform;
+std::string terminal_host;
+
+EncodableValue EventToValue(const virok::TerminalEvent& event) {
+  EncodableMap map;
+  map[EncodableValue("type")] =
+      EncodableValue(virok::TerminalEventName(event.type));
+  map[EncodableValue("request")] = EncodableValue(event.request);
+  map[EncodableValue("method")] = EncodableValue(event.method);
+  if (!event.state.empty()) {
+    map[EncodableValue("state")] = EncodableValue(event.state);
+  }
+  if (event.type == virok::TerminalEvent::Type::kResult) {
+    map[EncodableValue("approved")] = EncodableValue(event.approved);
+    map[EncodableValue("elapsedUs")] = EncodableValue(event.elapsed_us);
+    map[EncodableValue("tapToApprovalUs")] =
+        EncodableValue(event.tap_to_approval_us);
+  }
+  if (event.type == virok::TerminalEvent::Type::kSlip) {
+    map[EncodableValue("tapToSlipUs")] = EncodableValue(event.tap_to_slip_us);
+  }
+  if (!event.params.empty()) {
+    EncodableMap params;
+    for (const auto& [key, value] : event.params) {
+      params[EncodableValue(key)] = EncodableValue(value);
+    }
+    map[EncodableValue("params")] = EncodableValue(std::move(params));
+  }
+  if (!event.error.empty()) {
+    map[EncodableValue("error")] = EncodableValue(event.error);
+  }
+  return EncodableValue(std::move(map));
+}
+
+void OnTerminalEvent(const virok::TerminalEvent& event) {
+  EncodableValue value = EventToValue(event);
+  post_to_platform([value] {
+    if (terminal_sink) terminal_sink->Success(value);
+  });
+}
+
+// params: {назва: рядок}; значення інших типів пропускаються.
+virok::TerminalParams ParamsArg(const EncodableMap* args) {
+  virok::TerminalParams params;
+  const EncodableValue* value = FindArg(args, "params");
+  const auto* map = value ? std::get_if<EncodableMap>(value) : nullptr;
+  if (!map) return params;
+  for (const auto& [key, item] : *map) {
+    const auto* name = std::get_if<std::string>(&key);
+    const auto* text = std::get_if<std::string>(&item);
+    if (name && text) params[*name] = *text;
+  }
+  return params;
+}
+
+void HandleTerminalCall(const flutter::MethodCall<>& call,
+                        std::unique_ptr<flutter::MethodResult<>> result) {
+  const auto* args = std::get_if<EncodableMap>(call.arguments());
+  const std::string& method = call.method_name();
+  virok::TraceScope trace_scope("terminal", method);
+
+  if (method == "start") {
+    virok::TerminalOptions options;
+    options.host = StringArg(args, "host");
+    options.port = static_cast<uint16_t>(IntArg(args, "port", options.port));
+    options.printer_host = StringArg(args, "printerHost");
+    options.printer_port = static_cast<uint16_t>(
+        IntArg(args, "printerPort", options.printer_port));
+    options.slip_copies =
+        static_cast<int>(IntArg(args, "slipCopies", options.slip_copies));
+    std::string error;
+    if (!terminal_driver->Start(options, &error)) {
+      terminal_host.clear();
+      result->Error("CONNECT_FAILED", error);
+      return;
+    }
+    terminal_host = options.host;
+    result->Success(EncodableValue(true));
+  } else if (method == "stop") {
+    terminal_driver->Stop();
+    terminal_host.clear();
+    result->Success();
+  } else if (method == "status") {
+    EncodableMap map;
+    map[EncodableValue("running")] =
+        EncodableValue(terminal_driver->running());
+    map[EncodableValue("connected")] =
+        EncodableValue(terminal_driver->connected());
+    map[EncodableValue("host")] = EncodableValue(terminal_host);
+    result->Success(EncodableValue(std::move(map)));
+  } else if (method == "submit") {
+    std::string error;
+    const int64_t request = terminal_driver->Submit(
+        StringArg(args, "method"), ParamsArg(args),
+        std::chrono::milliseconds(IntArg(args, "timeoutMs", 120000)), &error);
+    if (request <= 0) {
+      result->Error("NOT_CONNECTED", error);
+      return;
+    }
+    result->Success(EncodableValue(request));
+  } else if (method == "cancel") {
+    std::string error;
+    result->Success(EncodableValue(
+        terminal_driver->Cancel(IntArg(args, "request"), &error)));
+  } else {
+    result->NotImplemented();
+  }
+}
+
+}  // namespace
+
+void RegisterTerminalChannel(
+    flutter::BinaryMessenger* messenger,
+    std::function<void(std::function<void()>)> post_task) {
+  post_to_platform = std::move(post_task);
+  terminal_driver = std::make_unique<virok::TerminalDriver>(OnTerminalEvent);
+  terminal_channel = std::make_unique<flutter::MethodChannel<>>(
+      messenger, "com.virok/terminal",
+      &flutter::StandardMethodCodec::GetInstance());
+  terminal_channel->SetMethodCallHandler(HandleTerminalCall);
+  terminal_events = std::make_unique<flutter::EventChannel<>>(
+      messenger, "com.virok/terminal/events",
+      &flutter::StandardMethodCodec::GetInstance());
+  terminal_events->SetStreamHandler(
+      std::make_unique<flutter::StreamHandlerFunctions<>>(
+          [](const EncodableValue*,
+             std::unique_ptr<flutter::EventSink<>>&& events)
+              -> std::unique_ptr<flutter::StreamHandlerError<>> {
+            terminal_sink = std::move(events);
+            return nullptr;
+          },
+          [](const EncodableValue*)
+              -> std::unique_ptr<flutter::StreamHandlerError<>> {
+            terminal_sink.reset();
+            return nullptr;
+          }));
+}
+
+void ShutdownTerminalChannel() {
+  if (terminal_driver) terminal_driver->Stop();
+  terminal_sink.reset();
+  terminal_events.reset();
+  terminal_channel.reset();
+}
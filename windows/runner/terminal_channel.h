@@ -0,0 +1,22 @@
+#ifndef RUNNER_TERMINAL_CHANNEL_H_
+#define RUNNER_TERMINAL_CHANNEL_H_
+
+#include <flutter/binary_messenger.h>
+
+#include <functional>
+
+// Реєструє канал com.virok/terminal (start, stop, status, submit, cancel)
+// і потік подій com.virok/terminal/events: банківський термінал на одному
+// постійному з'єднанні (див. native/terminal). Проміжні стани оплати
+// (картку прикладено, PIN, авторизація) приходять подіями, а сліп
+// схваленої оплати драйвер друкує сам. Події з потоків драйвера
+// передаються в потік платформи через |post_task|.
+// Викликати один раз після створення движка.
+void RegisterTerminalChannel(
+    flutter::BinaryMessenger* messenger,
+    std::function<void(std::function<void()>)> post_task);
+
+// Зупиняє драйвер термінала до того, як движок буде знищено.
+void ShutdownTerminalChannel();
+
+#endif  // RUNNER_TERMINAL_CHANNEL_H_
@@ -0,0 +1,172 @@
+#include "trace_channel.h"
+
+#include <flutter/method_channel.h>
+#include <flutter/standard_method_codec.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "channel_args.h"
+#include "trace/trace.h"
+#include "trace/trace_writer.h"
+#include "watchdog/stall_watchdog.h"
+
+namespace {
+
+using flutter::EncodableList;
+using flutter::EncodableMap;
+using flutter::EncodableValue;
+
+std::unique_ptr<flutter::MethodChannel<>> trace_channel;
+virok::ChromeTraceWriter trace_writer;
+
+// Пише лише платформний потік (обробник каналу), як і вимагає TraceBuffer.
+virok::TraceBuffer* dart_track = nullptr;
+
+std::unique_ptr<virok::StallWatchdog> watchdog;
+
+EncodableValue ReportToValue(const virok::StallReport& report) {
+  EncodableList spans;
+  for (const virok::StallReport::Span& span : report.spans) {
+    EncodableMap map;
+    map[EncodableValue("category")] = EncodableValue(span.category);
+    map[EncodableValue("name")] = EncodableValue(span.name);
+    map[EncodableValue("ageMs")] = EncodableValue(span.age_ms);
+    spans.push_back(EncodableValue(std::move(map)));
+  }
+  EncodableList stack;
+  for (const std::string& frame : report.stack) {
+    stack.push_back(EncodableValue(frame));
+  }
+  EncodableMap map;
+  map[EncodableValue("id")] = EncodableValue(static_cast<int64_t>(report.id));
+  map[EncodableValue("startedMs")] = EncodableValue(report.started_unix_ms);
+  map[EncodableValue("durationMs")] = EncodableValue(report.duration_ms);
+  map[EncodableValue("recovered")] = EncodableValue(report.recovered);
+  map[EncodableValue("spans")] = EncodableValue(std::move(spans));
+  map[EncodableValue("stack")] = EncodableValue(std::move(stack));
+  return EncodableValue(std::move(map));
+}
+
+EncodableValue WatchdogStatusToValue(const virok::StallWatchdogStatus& status) {
+  EncodableMap map;
+  map[EncodableValue("running")] = EncodableValue(status.running);
+  map[EncodableValue("stalled")] = EncodableValue(status.stalled);
+  map[EncodableValue("beats")] =
+      EncodableValue(static_cast<int64_t>(status.beats));
+  map[EncodableValue("stalls")] =
+      EncodableValue(static_cast<int64_t>(status.stalls));
+  map[EncodableValue("longestMs")] = EncodableValue(status.longest_ms);
+  if (status.last.id != 0) {
+    map[EncodableValue("last")] = ReportToValue(status.last);
+  }
+  map[EncodableValue("error")] = EncodableValue(status.error);
+  return EncodableValue(std::move(map));
+}
+
+// path — журнал зависань; budgetMs/intervalMs — пороги сторожа;
+// enabled: false — зупинити.
+bool ConfigureWatchdog(const EncodableMap* args) {
+  if (!BoolArg(args, "enabled", true)) {
+    watchdog->Stop();
+    return true;
+  }
+  virok::StallWatchdogOptions options;
+  options.path = StringArg(args, "path");
+  options.budget = std::chrono::milliseconds(
+      IntArg(args, "budgetMs", options.budget.count()));
+  options.interval = std::chrono::milliseconds(
+      IntArg(args, "intervalMs", options.interval.count()));
+  options.sample_stack = BoolArg(args, "sampleStack", true);
+  if (options.budget.count() <= 0 || options.interval.count() <= 0) {
+    return false;
+  }
+  watchdog->set_options(options);
+  if (!watchdog->running()) watchdog->Start();
+  return true;
+}
+
+std::vector<int64_t> Int64ListArg(const flutter::EncodableMap* args,
+                                  const char* key) {
+  const flutter::EncodableValue* v = FindArg(args, key);
+  const auto* list = v ? std::get_if<std::vector<int64_t>>(v) : nullptr;
+  return list ? *list : std::vector<int64_t>();
+}
+
+// Dart надсилає тривалість і "вік" кожного спану (скільки мкс тому він
+// завершився) — так не потрібна синхронізація годинників Dart і C++.
+void RecordDartSpans(const flutter::EncodableMap* args) {
+  virok::Tracer& tracer = virok::Tracer::Get();
+  if (!tracer.enabled()) return;
+  if (!dart_track) dart_track = tracer.CreateTrack("dart");
+
+  const auto categories = StringListArg(args, "categories");
+  const auto names = StringListArg(args, "names");
+  const auto durations = Int64ListArg(args, "durationsUs");
+  const auto ages = Int64ListArg(args, "agesUs");
+  const size_t count = std::min({categories.size(), names.size(),
+                                 durations.size(), ages.size()});
+
+  const int64_t now = virok::Tracer::NowNs();
+  for (size_t i = 0; i < count; i++) {
+    const int64_t end = now - ages[i] * 1000;
+    const int64_t duration = durations[i] * 1000;
+    dart_track->Push({tracer.Intern(categories[i]), tracer.Intern(names[i]),
+                      end - duration, duration, virok::TraceEvent::kNoArg});
+  }
+}
+
+void HandleTraceCall(const flutter::MethodCall<>& call,
+                     std::unique_ptr<flutter::MethodResult<>> result) {
+  const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+  const std::string& method = call.method_name();
+
+  if (method == "watchdog") {
+    result->Success(EncodableValue(ConfigureWatchdog(args)));
+  } else if (method == "watchdogStatus") {
+    result->Success(WatchdogStatusToValue(watchdog->status()));
+  } else if (method == "start") {
+    const auto interval =
+        std::chrono::milliseconds(IntArg(args, "flushMs", 1000));
+    result->Success(flutter::EncodableValue(
+        trace_writer.Start(StringArg(args, "path"), interval)));
+  } else if (method == "stop") {
+    trace_writer.Stop();
+    result->Success();
+  } else if (method == "spans") {
+    RecordDartSpans(args);
+    result->Success();
+  } else {
+    result->NotImplemented();
+  }
+}
+
+}  // namespace
+
+void RegisterTraceChannel(
+    flutter::BinaryMessenger* messenger,
+    std::function<void(std::function<void()>)> post_task) {
+  virok::Tracer::Get().SetThreadName("platform");
+  // Сторож стежить за цим потоком (потоком платформи); запускає його Dart.
+  watchdog = std::make_unique<virok::StallWatchdog>(
+      [post_task = std::move(post_task)](uint64_t seq) {
+        post_task([seq] {
+          if (watchdog) watchdog->Beat(seq);
+        });
+      });
+  watchdog->AttachLoopThread();
+  trace_channel = std::make_unique<flutter::MethodChannel<>>(
+      messenger, "com.virok/trace",
+      &flutter::StandardMethodCodec::GetInstance());
+  trace_channel->SetMethodCallHandler(HandleTraceCall);
+}
+
+void ShutdownTraceChannel() {
+  if (watchdog) watchdog->Stop();
+}
@@ -0,0 +1,23 @@
+#ifndef RUNNER_TRACE_CHANNEL_H_
+#define RUNNER_TRACE_CHANNEL_H_
+
+#include <flutter/binary_messenger.h>
+
+#include <functional>
+
+// Реєструє канал com.virok/trace: запуск/зупинка запису траси у файл
+// Chrome trace (start/stop) і пачки спанів з Dart (spans), які лягають
+// на окрему доріжку "dart" поруч зі спанами runner'а.
+//
+// Там же сторож зависань циклу повідомлень (watchdog, watchdogStatus; див.
+// native/watchdog): пульс іде через |post_task| — PostMessage у цикл
+// wWinMain, — і відповідає на нього FlutterWindow::MessageHandler.
+// Викликати з потоку платформи: його спани і стек потрапляють у звіти.
+void RegisterTraceChannel(
+    flutter::BinaryMessenger* messenger,
+    std::function<void(std::function<void()>)> post_task);
+
+// Зупиняє сторожа до того, як вікно буде знищено.
+void ShutdownTraceChannel();
+
+#endif  // RUNNER_TRACE_CHANNEL_H_